@@ -81,6 +81,17 @@ evt_service_setup(uint32_t service_id)
 			RTE_MAX_LCORE);
 	if (core_cnt < 0)
 		return -ENOENT;
+	/* Run a multi-thread safe service, such as a sharded scheduler, on
+	 * all the service cores.
+	 */
+	if (rte_service_probe_capability(service_id,
+			RTE_SERVICE_CAP_MT_SAFE) == 1) {
+		while (core_cnt--)
+			if (rte_service_map_lcore_set(service_id,
+					core_array[core_cnt], 1))
+				return -ENOENT;
+		return 0;
+	}
 	/* Get the core which has least number of services running. */
 	while (core_cnt--) {
 		/* Reset default mapping */
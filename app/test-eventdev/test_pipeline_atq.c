@@ -44,7 +44,7 @@ static int
 pipeline_atq_worker_single_stage_fwd(void *arg)
 {
 	PIPELINE_WROKER_SINGLE_STAGE_INIT;
-	const uint8_t tx_queue = t->tx_service.queue_id;
+	const uint8_t tx_queue = t->tx_evqueue_id;
 
 	while (t->done == false) {
 		uint16_t event = rte_event_dequeue_burst(dev, port, &ev, 1, 0);
@@ -55,8 +55,7 @@ pipeline_atq_worker_single_stage_fwd(void *arg)
 		}
 
 		w->processed_pkts++;
-		ev.queue_id = tx_queue;
-		pipeline_fwd_event(&ev, RTE_SCHED_TYPE_ATOMIC);
+		pipeline_fwd_tx_event(&ev, tx_queue);
 		pipeline_event_enqueue(dev, port, &ev);
 	}
 
@@ -99,7 +98,7 @@ static int
 pipeline_atq_worker_single_stage_burst_fwd(void *arg)
 {
 	PIPELINE_WROKER_SINGLE_STAGE_BURST_INIT;
-	const uint8_t tx_queue = t->tx_service.queue_id;
+	const uint8_t tx_queue = t->tx_evqueue_id;
 
 	while (t->done == false) {
 		uint16_t nb_rx = rte_event_dequeue_burst(dev, port, ev,
@@ -112,8 +111,7 @@ pipeline_atq_worker_single_stage_burst_fwd(void *arg)
 
 		for (i = 0; i < nb_rx; i++) {
 			rte_prefetch0(ev[i + 1].mbuf);
-			ev[i].queue_id = tx_queue;
-			pipeline_fwd_event(&ev[i], RTE_SCHED_TYPE_ATOMIC);
+			pipeline_fwd_tx_event(&ev[i], tx_queue);
 			w->processed_pkts++;
 		}
 
@@ -163,7 +161,7 @@ pipeline_atq_worker_multi_stage_fwd(void *arg)
 {
 	PIPELINE_WROKER_MULTI_STAGE_INIT;
 	const uint8_t nb_stages = t->opt->nb_stages;
-	const uint8_t tx_queue = t->tx_service.queue_id;
+	const uint8_t tx_queue = t->tx_evqueue_id;
 
 	while (t->done == false) {
 		uint16_t event = rte_event_dequeue_burst(dev, port, &ev, 1, 0);
@@ -177,8 +175,7 @@ pipeline_atq_worker_multi_stage_fwd(void *arg)
 
 		if (cq_id == last_queue) {
 			w->processed_pkts++;
-			ev.queue_id = tx_queue;
-			pipeline_fwd_event(&ev, RTE_SCHED_TYPE_ATOMIC);
+			pipeline_fwd_tx_event(&ev, tx_queue);
 		} else {
 			ev.sub_event_type++;
 			pipeline_fwd_event(&ev, sched_type_list[cq_id]);
@@ -236,7 +233,7 @@ pipeline_atq_worker_multi_stage_burst_fwd(void *arg)
 {
 	PIPELINE_WROKER_MULTI_STAGE_BURST_INIT;
 	const uint8_t nb_stages = t->opt->nb_stages;
-	const uint8_t tx_queue = t->tx_service.queue_id;
+	const uint8_t tx_queue = t->tx_evqueue_id;
 
 	while (t->done == false) {
 		uint16_t nb_rx = rte_event_dequeue_burst(dev, port, ev,
@@ -253,9 +250,7 @@ pipeline_atq_worker_multi_stage_burst_fwd(void *arg)
 
 			if (cq_id == last_queue) {
 				w->processed_pkts++;
-				ev[i].queue_id = tx_queue;
-				pipeline_fwd_event(&ev[i],
-						RTE_SCHED_TYPE_ATOMIC);
+				pipeline_fwd_tx_event(&ev[i], tx_queue);
 			} else {
 				ev[i].sub_event_type++;
 				pipeline_fwd_event(&ev[i],
@@ -306,7 +301,7 @@ pipeline_atq_launch_lcores(struct evt_test *test, struct evt_options *opt)
 	struct test_pipeline *t = evt_test_priv(test);
 
 	if (t->mt_unsafe)
-		rte_service_component_runstate_set(t->tx_service.service_id, 1);
+		rte_event_eth_tx_adapter_start(TXA_INST_ID);
 	return pipeline_launch_lcores(test, opt, worker_wrapper);
 }
 
@@ -326,10 +321,9 @@ pipeline_atq_eventdev_setup(struct evt_test *test, struct evt_options *opt)
 	nb_ports = evt_nr_active_lcores(opt->wlcores);
 	nb_queues = rte_eth_dev_count_avail();
 
-	/* One extra port and queueu for Tx service */
+	/* Extra queue for Tx adapter, the adapter adds its own event port. */
 	if (t->mt_unsafe) {
 		tx_evqueue_id = nb_queues;
-		nb_ports++;
 		nb_queues++;
 	}
 
@@ -394,8 +388,9 @@ pipeline_atq_eventdev_setup(struct evt_test *test, struct evt_options *opt)
 		if (ret)
 			return ret;
 
-		ret = pipeline_event_tx_service_setup(test, opt, tx_evqueue_id,
-				nb_ports - 1, p_conf);
+		t->tx_evqueue_id = tx_evqueue_id;
+		ret = pipeline_event_tx_adapter_setup(opt, tx_evqueue_id,
+				p_conf);
 	} else
 		ret = pipeline_event_port_setup(test, opt, NULL, nb_queues,
 				p_conf);
@@ -425,7 +420,7 @@ pipeline_atq_eventdev_setup(struct evt_test *test, struct evt_options *opt)
 	 *
 	 *	event queue pipelines:
 	 *	eth0 -> q0
-	 *		  } (q3->tx) Tx service
+	 *		  } (q3->tx) Tx adapter
 	 *	eth1 -> q1
 	 *
 	 *	q0,q1 are configured as stated above.
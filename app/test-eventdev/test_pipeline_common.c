@@ -5,58 +5,6 @@
 
 #include "test_pipeline_common.h"
 
-static int32_t
-pipeline_event_tx_burst_service_func(void *args)
-{
-
-	int i;
-	struct tx_service_data *tx = args;
-	const uint8_t dev = tx->dev_id;
-	const uint8_t port = tx->port_id;
-	struct rte_event ev[BURST_SIZE + 1];
-
-	uint16_t nb_rx = rte_event_dequeue_burst(dev, port, ev, BURST_SIZE, 0);
-
-	if (!nb_rx) {
-		for (i = 0; i < tx->nb_ethports; i++)
-			rte_eth_tx_buffer_flush(i, 0, tx->tx_buf[i]);
-		return 0;
-	}
-
-	for (i = 0; i < nb_rx; i++) {
-		struct rte_mbuf *m = ev[i].mbuf;
-		rte_eth_tx_buffer(m->port, 0, tx->tx_buf[m->port], m);
-	}
-	tx->processed_pkts += nb_rx;
-
-	return 0;
-}
-
-static int32_t
-pipeline_event_tx_service_func(void *args)
-{
-
-	int i;
-	struct tx_service_data *tx = args;
-	const uint8_t dev = tx->dev_id;
-	const uint8_t port = tx->port_id;
-	struct rte_event ev;
-
-	uint16_t nb_rx = rte_event_dequeue_burst(dev, port, &ev, 1, 0);
-
-	if (!nb_rx) {
-		for (i = 0; i < tx->nb_ethports; i++)
-			rte_eth_tx_buffer_flush(i, 0, tx->tx_buf[i]);
-		return 0;
-	}
-
-	struct rte_mbuf *m = ev.mbuf;
-	rte_eth_tx_buffer(m->port, 0, tx->tx_buf[m->port], m);
-	tx->processed_pkts++;
-
-	return 0;
-}
-
 int
 pipeline_test_result(struct evt_test *test, struct evt_options *opt)
 {
@@ -97,9 +45,12 @@ processed_pkts(struct test_pipeline *t)
 	uint64_t total = 0;
 
 	rte_smp_rmb();
-	if (t->mt_unsafe)
-		total = t->tx_service.processed_pkts;
-	else
+	if (t->mt_unsafe) {
+		struct rte_event_eth_tx_adapter_stats stats;
+
+		if (!rte_event_eth_tx_adapter_stats_get(TXA_INST_ID, &stats))
+			total = stats.tx_packets;
+	} else
 		for (i = 0; i < t->nb_workers; i++)
 			total += t->worker[i].processed_pkts;
 
@@ -270,10 +221,6 @@ pipeline_ethdev_setup(struct evt_test *test, struct evt_options *opt)
 		}
 
 		t->mt_unsafe |= mt_state;
-		t->tx_service.tx_buf[i] =
-			rte_malloc(NULL, RTE_ETH_TX_BUFFER_SIZE(BURST_SIZE), 0);
-		if (t->tx_service.tx_buf[i] == NULL)
-			rte_panic("Unable to allocate Tx buffer memory.");
 		rte_eth_promiscuous_enable(i);
 	}
 
@@ -395,74 +342,79 @@ pipeline_event_rx_adapter_setup(struct evt_options *opt, uint8_t stride,
 }
 
 int
-pipeline_event_tx_service_setup(struct evt_test *test, struct evt_options *opt,
-		uint8_t tx_queue_id, uint8_t tx_port_id,
-		const struct rte_event_port_conf p_conf)
+pipeline_event_tx_adapter_setup(struct evt_options *opt, uint8_t tx_queue_id,
+		struct rte_event_port_conf port_conf)
 {
 	int ret;
-	struct rte_service_spec serv;
-	struct test_pipeline *t = evt_test_priv(test);
-	struct tx_service_data *tx = &t->tx_service;
+	uint16_t consm;
+	uint32_t cap = 0;
+	bool internal_port = false;
 
-	ret = rte_event_port_setup(opt->dev_id, tx_port_id, &p_conf);
+	ret = rte_event_eth_tx_adapter_create(TXA_INST_ID, opt->dev_id,
+			&port_conf);
 	if (ret) {
-		evt_err("failed to setup port %d", tx_port_id);
+		evt_err("failed to create tx adapter[%d]", TXA_INST_ID);
 		return ret;
 	}
 
-	if (rte_event_port_link(opt->dev_id, tx_port_id, &tx_queue_id,
-				NULL, 1) != 1) {
-		evt_err("failed to link queues to port %d", tx_port_id);
-		return -EINVAL;
-	}
+	RTE_ETH_FOREACH_DEV(consm) {
+		ret = rte_event_eth_tx_adapter_caps_get(opt->dev_id, consm,
+				&cap);
+		if (ret) {
+			evt_err("failed to get event tx adapter[%d]"
+					" capabilities", opt->dev_id);
+			return ret;
+		}
+		internal_port |= !!(cap &
+				RTE_EVENT_ETH_TX_ADAPTER_CAP_INTERNAL_PORT);
 
-	tx->dev_id = opt->dev_id;
-	tx->queue_id = tx_queue_id;
-	tx->port_id = tx_port_id;
-	tx->nb_ethports = rte_eth_dev_count_avail();
-	tx->t = t;
+		ret = rte_event_eth_tx_adapter_queue_add(TXA_INST_ID, consm,
+				-1);
+		if (ret) {
+			evt_err("failed to add tx queues to adapter[%d]",
+					TXA_INST_ID);
+			return ret;
+		}
+	}
 
-	/* Register Tx service */
-	memset(&serv, 0, sizeof(struct rte_service_spec));
-	snprintf(serv.name, sizeof(serv.name), "Tx_service");
+	if (!internal_port) {
+		uint8_t tx_port_id;
+		uint32_t service_id;
 
-	if (evt_has_burst_mode(opt->dev_id))
-		serv.callback = pipeline_event_tx_burst_service_func;
-	else
-		serv.callback = pipeline_event_tx_service_func;
+		ret = rte_event_eth_tx_adapter_event_port_get(TXA_INST_ID,
+				&tx_port_id);
+		if (ret) {
+			evt_err("failed to get tx adapter[%d] event port",
+					TXA_INST_ID);
+			return ret;
+		}
 
-	serv.callback_userdata = (void *)tx;
-	ret = rte_service_component_register(&serv, &tx->service_id);
-	if (ret) {
-		evt_err("failed to register Tx service");
-		return ret;
-	}
+		if (rte_event_port_link(opt->dev_id, tx_port_id, &tx_queue_id,
+					NULL, 1) != 1) {
+			evt_err("failed to link queues to port %d",
+					tx_port_id);
+			return -EINVAL;
+		}
 
-	ret = evt_service_setup(tx->service_id);
-	if (ret) {
-		evt_err("Failed to setup service core for Tx service\n");
-		return ret;
+		rte_event_eth_tx_adapter_service_id_get(TXA_INST_ID,
+				&service_id);
+		ret = evt_service_setup(service_id);
+		if (ret) {
+			evt_err("Failed to setup service core"
+					" for Tx adapter\n");
+			return ret;
+		}
 	}
 
-	rte_service_runstate_set(tx->service_id, 1);
-
 	return 0;
 }
 
-
 void
 pipeline_ethdev_destroy(struct evt_test *test, struct evt_options *opt)
 {
 	uint16_t i;
 	RTE_SET_USED(test);
 	RTE_SET_USED(opt);
-	struct test_pipeline *t = evt_test_priv(test);
-
-	if (t->mt_unsafe) {
-		rte_service_component_runstate_set(t->tx_service.service_id, 0);
-		rte_service_runstate_set(t->tx_service.service_id, 0);
-		rte_service_component_unregister(t->tx_service.service_id);
-	}
 
 	RTE_ETH_FOREACH_DEV(i) {
 		rte_event_eth_rx_adapter_stop(i);
@@ -474,7 +426,15 @@ pipeline_ethdev_destroy(struct evt_test *test, struct evt_options *opt)
 void
 pipeline_eventdev_destroy(struct evt_test *test, struct evt_options *opt)
 {
-	RTE_SET_USED(test);
+	uint16_t i;
+	struct test_pipeline *t = evt_test_priv(test);
+
+	if (t->mt_unsafe) {
+		rte_event_eth_tx_adapter_stop(TXA_INST_ID);
+		RTE_ETH_FOREACH_DEV(i)
+			rte_event_eth_tx_adapter_queue_del(TXA_INST_ID, i, -1);
+		rte_event_eth_tx_adapter_free(TXA_INST_ID);
+	}
 
 	rte_event_dev_stop(opt->dev_id);
 	rte_event_dev_close(opt->dev_id);
@@ -45,7 +45,7 @@ static int
 pipeline_queue_worker_single_stage_fwd(void *arg)
 {
 	PIPELINE_WROKER_SINGLE_STAGE_INIT;
-	const uint8_t tx_queue = t->tx_service.queue_id;
+	const uint8_t tx_queue = t->tx_evqueue_id;
 
 	while (t->done == false) {
 		uint16_t event = rte_event_dequeue_burst(dev, port, &ev, 1, 0);
@@ -55,8 +55,7 @@ pipeline_queue_worker_single_stage_fwd(void *arg)
 			continue;
 		}
 
-		ev.queue_id = tx_queue;
-		pipeline_fwd_event(&ev, RTE_SCHED_TYPE_ATOMIC);
+		pipeline_fwd_tx_event(&ev, tx_queue);
 		pipeline_event_enqueue(dev, port, &ev);
 		w->processed_pkts++;
 	}
@@ -102,7 +101,7 @@ static int
 pipeline_queue_worker_single_stage_burst_fwd(void *arg)
 {
 	PIPELINE_WROKER_SINGLE_STAGE_BURST_INIT;
-	const uint8_t tx_queue = t->tx_service.queue_id;
+	const uint8_t tx_queue = t->tx_evqueue_id;
 
 	while (t->done == false) {
 		uint16_t nb_rx = rte_event_dequeue_burst(dev, port, ev,
@@ -115,8 +114,7 @@ pipeline_queue_worker_single_stage_burst_fwd(void *arg)
 
 		for (i = 0; i < nb_rx; i++) {
 			rte_prefetch0(ev[i + 1].mbuf);
-			ev[i].queue_id = tx_queue;
-			pipeline_fwd_event(&ev[i], RTE_SCHED_TYPE_ATOMIC);
+			pipeline_fwd_tx_event(&ev[i], tx_queue);
 			w->processed_pkts++;
 		}
 
@@ -167,7 +165,7 @@ pipeline_queue_worker_multi_stage_fwd(void *arg)
 {
 	PIPELINE_WROKER_MULTI_STAGE_INIT;
 	const uint8_t nb_stages = t->opt->nb_stages + 1;
-	const uint8_t tx_queue = t->tx_service.queue_id;
+	const uint8_t tx_queue = t->tx_evqueue_id;
 
 	while (t->done == false) {
 		uint16_t event = rte_event_dequeue_burst(dev, port, &ev, 1, 0);
@@ -180,8 +178,7 @@ pipeline_queue_worker_multi_stage_fwd(void *arg)
 		cq_id = ev.queue_id % nb_stages;
 
 		if (cq_id == last_queue) {
-			ev.queue_id = tx_queue;
-			pipeline_fwd_event(&ev, RTE_SCHED_TYPE_ATOMIC);
+			pipeline_fwd_tx_event(&ev, tx_queue);
 			w->processed_pkts++;
 		} else {
 			ev.queue_id++;
@@ -242,7 +239,7 @@ pipeline_queue_worker_multi_stage_burst_fwd(void *arg)
 {
 	PIPELINE_WROKER_MULTI_STAGE_BURST_INIT;
 	const uint8_t nb_stages = t->opt->nb_stages + 1;
-	const uint8_t tx_queue = t->tx_service.queue_id;
+	const uint8_t tx_queue = t->tx_evqueue_id;
 
 	while (t->done == false) {
 		uint16_t nb_rx = rte_event_dequeue_burst(dev, port, ev,
@@ -258,9 +255,7 @@ pipeline_queue_worker_multi_stage_burst_fwd(void *arg)
 			cq_id = ev[i].queue_id % nb_stages;
 
 			if (cq_id == last_queue) {
-				ev[i].queue_id = tx_queue;
-				pipeline_fwd_event(&ev[i],
-						RTE_SCHED_TYPE_ATOMIC);
+				pipeline_fwd_tx_event(&ev[i], tx_queue);
 				w->processed_pkts++;
 			} else {
 				ev[i].queue_id++;
@@ -314,7 +309,7 @@ pipeline_queue_launch_lcores(struct evt_test *test, struct evt_options *opt)
 	struct test_pipeline *t = evt_test_priv(test);
 
 	if (t->mt_unsafe)
-		rte_service_component_runstate_set(t->tx_service.service_id, 1);
+		rte_event_eth_tx_adapter_start(TXA_INST_ID);
 	return pipeline_launch_lcores(test, opt, worker_wrapper);
 }
 
@@ -335,10 +330,9 @@ pipeline_queue_eventdev_setup(struct evt_test *test, struct evt_options *opt)
 	nb_ports = evt_nr_active_lcores(opt->wlcores);
 	nb_queues = rte_eth_dev_count_avail() * (nb_stages);
 
-	/* Extra port for Tx service. */
+	/* Extra queue for Tx adapter, the adapter adds its own event port. */
 	if (t->mt_unsafe) {
 		tx_evqueue_id = nb_queues;
-		nb_ports++;
 		nb_queues++;
 	} else
 		nb_queues += rte_eth_dev_count_avail();
@@ -417,8 +411,9 @@ pipeline_queue_eventdev_setup(struct evt_test *test, struct evt_options *opt)
 		if (ret)
 			return ret;
 
-		ret = pipeline_event_tx_service_setup(test, opt, tx_evqueue_id,
-				nb_ports - 1, p_conf);
+		t->tx_evqueue_id = tx_evqueue_id;
+		ret = pipeline_event_tx_adapter_setup(opt, tx_evqueue_id,
+				p_conf);
 
 	} else
 		ret = pipeline_event_port_setup(test, opt, NULL, nb_queues,
@@ -447,7 +442,7 @@ pipeline_queue_eventdev_setup(struct evt_test *test, struct evt_options *opt)
 	 *
 	 *	event queue pipelines:
 	 *	eth0 -> q0 -> q1
-	 *			} (q4->tx) Tx service
+	 *			} (q4->tx) Tx adapter
 	 *	eth1 -> q2 -> q3
 	 *
 	 *	q4 configured as SINGLE_LINK|ATOMIC
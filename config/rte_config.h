@@ -65,6 +65,8 @@
 #define RTE_EVENT_MAX_QUEUES_PER_DEV 64
 #define RTE_EVENT_TIMER_ADAPTER_NUM_MAX 32
 #define RTE_EVENT_CRYPTO_ADAPTER_MAX_INSTANCE 32
+#define RTE_EVENT_ETH_TX_ADAPTER_MAX_INSTANCE 32
+#define RTE_EVENT_ETH_INTR_RING_SIZE 1024
 
 /* rawdev defines */
 #define RTE_RAWDEV_MAX_DEVS 10
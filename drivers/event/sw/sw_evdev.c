@@ -19,6 +19,7 @@
 #define NUMA_NODE_ARG "numa_node"
 #define SCHED_QUANTA_ARG "sched_quanta"
 #define CREDIT_QUANTA_ARG "credit_quanta"
+#define SCHED_SHARDS_ARG "sched_shards"
 
 static void
 sw_info_get(struct rte_eventdev *dev, struct rte_event_dev_info *info);
@@ -116,6 +117,70 @@ sw_port_unlink(struct rte_eventdev *dev, void *port, uint8_t queues[],
 	return unlinked;
 }
 
+/* create the rings of the other shards for a port, see sw_port_setup() */
+static int
+sw_port_shards_setup(struct rte_eventdev *dev, uint8_t port_id,
+		const struct rte_event_port_conf *conf)
+{
+	struct sw_evdev *sw = sw_pmd_priv(dev);
+	char buf[RTE_RING_NAMESIZE];
+	struct rte_event_ring *existing_ring;
+	unsigned int i, s;
+
+	for (s = 1; s < sw->nb_shards; s++) {
+		struct sw_port *p = &sw->shards[s].ports[port_id];
+
+		*p = (struct sw_port){0};
+		p->id = port_id;
+		p->sw = sw;
+
+		snprintf(buf, sizeof(buf), "sw%d_p%u_s%u_rx",
+				dev->data->dev_id, port_id, s);
+		existing_ring = rte_event_ring_lookup(buf);
+		if (existing_ring)
+			rte_event_ring_free(existing_ring);
+
+		p->rx_worker_ring = rte_event_ring_create(buf,
+				MAX_SW_PROD_Q_DEPTH, dev->data->socket_id,
+				RING_F_SP_ENQ | RING_F_SC_DEQ |
+				RING_F_EXACT_SZ);
+		if (p->rx_worker_ring == NULL)
+			goto error;
+
+		snprintf(buf, sizeof(buf), "sw%d_p%u_s%u_cq",
+				dev->data->dev_id, port_id, s);
+		existing_ring = rte_event_ring_lookup(buf);
+		if (existing_ring)
+			rte_event_ring_free(existing_ring);
+
+		p->cq_worker_ring = rte_event_ring_create(buf,
+				conf->dequeue_depth, dev->data->socket_id,
+				RING_F_SP_ENQ | RING_F_SC_DEQ |
+				RING_F_EXACT_SZ);
+		if (p->cq_worker_ring == NULL)
+			goto error;
+		sw->shards[s].cq_ring_space[port_id] = conf->dequeue_depth;
+
+		for (i = 0; i < SW_PORT_HIST_LIST; i++) {
+			p->hist_list[i].fid = -1;
+			p->hist_list[i].qid = -1;
+		}
+	}
+
+	return 0;
+
+error:
+	SW_LOG_ERR("Error creating shard %u rings for port %d\n", s, port_id);
+	for (; s > 0; s--) {
+		struct sw_port *p = &sw->shards[s].ports[port_id];
+
+		rte_event_ring_free(p->rx_worker_ring);
+		rte_event_ring_free(p->cq_worker_ring);
+		memset(p, 0, sizeof(*p));
+	}
+	return -1;
+}
+
 static int
 sw_port_setup(struct rte_eventdev *dev, uint8_t port_id,
 		const struct rte_event_port_conf *conf)
@@ -123,7 +188,7 @@ sw_port_setup(struct rte_eventdev *dev, uint8_t port_id,
 	struct sw_evdev *sw = sw_pmd_priv(dev);
 	struct sw_port *p = &sw->ports[port_id];
 	char buf[RTE_RING_NAMESIZE];
-	unsigned int i;
+	unsigned int i, s;
 
 	struct rte_event_dev_info info;
 	sw_info_get(dev, &info);
@@ -135,8 +200,12 @@ sw_port_setup(struct rte_eventdev *dev, uint8_t port_id,
 		 * available in the port (p->inflight_credits). We must return
 		 * the sum to no leak credits
 		 */
-		int possible_inflights = p->inflight_credits + p->inflights;
+		int possible_inflights = p->inflight_credits;
+		for (s = 0; s < sw->nb_shards; s++)
+			possible_inflights +=
+				sw->shards[s].ports[port_id].inflights;
 		rte_atomic32_sub(&sw->inflights, possible_inflights);
+		rte_free(p->release_shard);
 	}
 
 	*p = (struct sw_port){0}; /* zero entire structure */
@@ -181,13 +250,26 @@ sw_port_setup(struct rte_eventdev *dev, uint8_t port_id,
 				port_id);
 		return -1;
 	}
-	sw->cq_ring_space[port_id] = conf->dequeue_depth;
+	sw->shards[0].cq_ring_space[port_id] = conf->dequeue_depth;
 
 	/* set hist list contents to empty */
 	for (i = 0; i < SW_PORT_HIST_LIST; i++) {
 		p->hist_list[i].fid = -1;
 		p->hist_list[i].qid = -1;
 	}
+
+	if (sw->nb_shards > 1) {
+		p->release_shard = rte_zmalloc_socket(NULL, SW_PORT_SHARD_HIST,
+				0, dev->data->socket_id);
+		if (p->release_shard == NULL ||
+				sw_port_shards_setup(dev, port_id, conf) < 0) {
+			rte_free(p->release_shard);
+			rte_event_ring_free(p->rx_worker_ring);
+			rte_event_ring_free(p->cq_worker_ring);
+			p->release_shard = NULL;
+			return -1;
+		}
+	}
 	dev->data->ports[port_id] = p;
 
 	rte_smp_wmb();
@@ -202,6 +284,20 @@ sw_port_release(void *port)
 	if (p == NULL)
 		return;
 
+	if (p->release_shard != NULL) {
+		struct sw_evdev *sw = p->sw;
+		unsigned int s;
+
+		for (s = 1; s < sw->nb_shards; s++) {
+			struct sw_port *sp = &sw->shards[s].ports[p->id];
+
+			rte_event_ring_free(sp->rx_worker_ring);
+			rte_event_ring_free(sp->cq_worker_ring);
+			memset(sp, 0, sizeof(*sp));
+		}
+		rte_free(p->release_shard);
+	}
+
 	rte_event_ring_free(p->rx_worker_ring);
 	rte_event_ring_free(p->cq_worker_ring);
 	memset(p, 0, sizeof(*p));
@@ -357,7 +453,7 @@ sw_init_qid_iqs(struct sw_evdev *sw)
 			continue;
 
 		for (j = 0; j < SW_IQS_MAX; j++)
-			iq_init(sw, &qid->iq[j]);
+			iq_init(&sw->shards[qid->shard], &qid->iq[j]);
 	}
 }
 
@@ -373,7 +469,8 @@ sw_clean_qid_iqs(struct sw_evdev *sw)
 		for (j = 0; j < SW_IQS_MAX; j++) {
 			if (!qid->iq[j].head)
 				continue;
-			iq_free_chunk_list(sw, qid->iq[j].head);
+			iq_free_chunk_list(&sw->shards[qid->shard],
+					qid->iq[j].head);
 			qid->iq[j].head = NULL;
 		}
 	}
@@ -416,6 +513,7 @@ sw_dev_configure(const struct rte_eventdev *dev)
 	const struct rte_eventdev_data *data = dev->data;
 	const struct rte_event_dev_config *conf = &data->dev_conf;
 	int num_chunks, i;
+	unsigned int s;
 
 	sw->qid_count = conf->nb_event_queues;
 	sw->port_count = conf->nb_event_ports;
@@ -428,22 +526,27 @@ sw_dev_configure(const struct rte_eventdev *dev)
 
 	/* If this is a reconfiguration, free the previous IQ allocation. All
 	 * IQ chunk references were cleaned out of the QIDs in sw_stop(), and
-	 * will be reinitialized in sw_start().
+	 * will be reinitialized in sw_start(). Any shard may own all the
+	 * inflight events, so each one gets the worst-case number of chunks.
 	 */
-	if (sw->chunks)
-		rte_free(sw->chunks);
-
-	sw->chunks = rte_malloc_socket(NULL,
-				       sizeof(struct sw_queue_chunk) *
-				       num_chunks,
-				       0,
-				       sw->data->socket_id);
-	if (!sw->chunks)
-		return -ENOMEM;
-
-	sw->chunk_list_head = NULL;
-	for (i = 0; i < num_chunks; i++)
-		iq_free_chunk(sw, &sw->chunks[i]);
+	for (s = 0; s < sw->nb_shards; s++) {
+		struct sw_shard *sh = &sw->shards[s];
+
+		if (sh->chunks)
+			rte_free(sh->chunks);
+
+		sh->chunks = rte_malloc_socket(NULL,
+					       sizeof(struct sw_queue_chunk) *
+					       num_chunks,
+					       0,
+					       sw->data->socket_id);
+		if (!sh->chunks)
+			return -ENOMEM;
+
+		sh->chunk_list_head = NULL;
+		for (i = 0; i < num_chunks; i++)
+			iq_free_chunk(sh, &sh->chunks[i]);
+	}
 
 	if (conf->event_dev_cfg & RTE_EVENT_DEV_CFG_PER_DEQUEUE_TIMEOUT)
 		return -ENOTSUP;
@@ -527,16 +630,26 @@ sw_dump(struct rte_eventdev *dev, FILE *f)
 	static const char * const q_type_strings[] = {
 			"Ordered", "Atomic", "Parallel", "Directed"
 	};
-	uint32_t i;
+	uint32_t i, s;
 	fprintf(f, "EventDev %s: ports %d, qids %d\n", "todo-fix-name",
 			sw->port_count, sw->qid_count);
 
-	fprintf(f, "\trx   %"PRIu64"\n\tdrop %"PRIu64"\n\ttx   %"PRIu64"\n",
-		sw->stats.rx_pkts, sw->stats.rx_dropped, sw->stats.tx_pkts);
-	fprintf(f, "\tsched calls: %"PRIu64"\n", sw->sched_called);
-	fprintf(f, "\tsched cq/qid call: %"PRIu64"\n", sw->sched_cq_qid_called);
-	fprintf(f, "\tsched no IQ enq: %"PRIu64"\n", sw->sched_no_iq_enqueues);
-	fprintf(f, "\tsched no CQ enq: %"PRIu64"\n", sw->sched_no_cq_enqueues);
+	for (s = 0; s < sw->nb_shards; s++) {
+		const struct sw_shard *sh = &sw->shards[s];
+
+		if (sw->nb_shards > 1)
+			fprintf(f, "  Shard %u: qids %u\n", s, sh->qid_count);
+		fprintf(f, "\trx   %"PRIu64"\n\tdrop %"PRIu64
+			"\n\ttx   %"PRIu64"\n", sh->stats.rx_pkts,
+			sh->stats.rx_dropped, sh->stats.tx_pkts);
+		fprintf(f, "\tsched calls: %"PRIu64"\n", sh->sched_called);
+		fprintf(f, "\tsched cq/qid call: %"PRIu64"\n",
+			sh->sched_cq_qid_called);
+		fprintf(f, "\tsched no IQ enq: %"PRIu64"\n",
+			sh->sched_no_iq_enqueues);
+		fprintf(f, "\tsched no CQ enq: %"PRIu64"\n",
+			sh->sched_no_cq_enqueues);
+	}
 	uint32_t inflights = rte_atomic32_read(&sw->inflights);
 	uint32_t credits = sw->nb_events_limit - inflights;
 	fprintf(f, "\tinflight %d, credits: %d\n", inflights, credits);
@@ -704,11 +817,22 @@ sw_start(struct rte_eventdev *dev)
 	 * "If two members compare as equal, their order in the sorted
 	 * array is undefined."
 	 */
+	/* Each QID is owned by a single shard, which preserves atomic and
+	 * ordered scheduling. QIDs are dealt to the shards in priority order
+	 * to spread the load.
+	 */
 	uint32_t qidx = 0;
+	for (i = 0; i < sw->nb_shards; i++)
+		sw->shards[i].qid_count = 0;
 	for (j = 0; j <= RTE_EVENT_DEV_PRIORITY_LOWEST; j++) {
 		for (i = 0; i < sw->qid_count; i++) {
 			if (sw->qids[i].priority == j) {
-				sw->qids_prioritized[qidx] = &sw->qids[i];
+				struct sw_shard *sh =
+					&sw->shards[qidx % sw->nb_shards];
+
+				sw->qids[i].shard = sh->id;
+				sh->qids_prioritized[sh->qid_count++] =
+					&sw->qids[i];
 				qidx++;
 			}
 		}
@@ -749,11 +873,15 @@ sw_close(struct rte_eventdev *dev)
 		sw_port_release(&sw->ports[i]);
 	sw->port_count = 0;
 
-	memset(&sw->stats, 0, sizeof(sw->stats));
-	sw->sched_called = 0;
-	sw->sched_no_iq_enqueues = 0;
-	sw->sched_no_cq_enqueues = 0;
-	sw->sched_cq_qid_called = 0;
+	for (i = 0; i < sw->nb_shards; i++) {
+		struct sw_shard *sh = &sw->shards[i];
+
+		memset(&sh->stats, 0, sizeof(sh->stats));
+		sh->sched_called = 0;
+		sh->sched_no_iq_enqueues = 0;
+		sh->sched_no_cq_enqueues = 0;
+		sh->sched_cq_qid_called = 0;
+	}
 
 	return 0;
 }
@@ -788,14 +916,112 @@ set_credit_quanta(const char *key __rte_unused, const char *value, void *opaque)
 	return 0;
 }
 
+static int
+set_sched_shards(const char *key __rte_unused, const char *value, void *opaque)
+{
+	int *shards = opaque;
+	*shards = atoi(value);
+	if (*shards < 1 || *shards > SW_SCHED_SHARDS_MAX)
+		return -1;
+	return 0;
+}
+
 
 static int32_t sw_sched_service_func(void *args)
 {
 	struct rte_eventdev *dev = args;
-	sw_event_schedule(dev);
+	struct sw_evdev *sw = sw_pmd_priv(dev);
+	uint32_t i, s;
+
+	if (sw->nb_shards == 1) {
+		sw_event_schedule(&sw->shards[0]);
+		return 0;
+	}
+
+	/* The service is MT safe when sharded: each core runs the shards no
+	 * other core is running, starting from a different one per core.
+	 */
+	s = rte_lcore_id() % sw->nb_shards;
+	for (i = 0; i < sw->nb_shards; i++) {
+		struct sw_shard *sh = &sw->shards[s];
+
+		if (rte_spinlock_trylock(&sh->lock)) {
+			sw_event_schedule(sh);
+			rte_spinlock_unlock(&sh->lock);
+		}
+		if (++s == sw->nb_shards)
+			s = 0;
+	}
 	return 0;
 }
 
+static void
+sw_shards_free(struct sw_evdev *sw)
+{
+	unsigned int s;
+
+	for (s = 0; s < sw->nb_shards; s++) {
+		struct sw_shard *sh = &sw->shards[s];
+
+		rte_event_ring_free(sh->handoff_ring);
+		sh->handoff_ring = NULL;
+		rte_free(sh->chunks);
+		sh->chunks = NULL;
+		if (s > 0) {
+			rte_free(sh->ports);
+			sh->ports = NULL;
+		}
+	}
+}
+
+static int
+sw_shards_init(struct sw_evdev *sw, unsigned int nb_shards)
+{
+	char buf[RTE_RING_NAMESIZE];
+	struct rte_event_ring *existing_ring;
+	unsigned int s;
+
+	sw->nb_shards = nb_shards;
+	for (s = 0; s < nb_shards; s++) {
+		struct sw_shard *sh = &sw->shards[s];
+
+		rte_spinlock_init(&sh->lock);
+		sh->id = s;
+		sh->sw = sw;
+		sh->ports = sw->ports;
+		if (nb_shards == 1)
+			break;
+
+		if (s > 0) {
+			sh->ports = rte_zmalloc_socket(NULL,
+					sizeof(struct sw_port) * SW_PORTS_MAX,
+					RTE_CACHE_LINE_SIZE,
+					sw->data->socket_id);
+			if (sh->ports == NULL)
+				goto error;
+		}
+
+		/* sized for all the inflight events, enqueue never fails */
+		snprintf(buf, sizeof(buf), "sw%d_s%u_handoff",
+				sw->data->dev_id, s);
+		existing_ring = rte_event_ring_lookup(buf);
+		if (existing_ring)
+			rte_event_ring_free(existing_ring);
+
+		sh->handoff_ring = rte_event_ring_create(buf,
+				SW_INFLIGHT_EVENTS_TOTAL, sw->data->socket_id,
+				RING_F_SC_DEQ | RING_F_EXACT_SZ);
+		if (sh->handoff_ring == NULL)
+			goto error;
+	}
+
+	return 0;
+
+error:
+	sw_shards_free(sw);
+	return -ENOMEM;
+}
+
 static int
 sw_probe(struct rte_vdev_device *vdev)
 {
@@ -834,6 +1060,7 @@ sw_probe(struct rte_vdev_device *vdev)
 		NUMA_NODE_ARG,
 		SCHED_QUANTA_ARG,
 		CREDIT_QUANTA_ARG,
+		SCHED_SHARDS_ARG,
 		NULL
 	};
 	const char *name;
@@ -843,6 +1070,7 @@ sw_probe(struct rte_vdev_device *vdev)
 	int socket_id = rte_socket_id();
 	int sched_quanta  = SW_DEFAULT_SCHED_QUANTA;
 	int credit_quanta = SW_DEFAULT_CREDIT_QUANTA;
+	int sched_shards = 1;
 
 	name = rte_vdev_device_name(vdev);
 	params = rte_vdev_device_args(vdev);
@@ -884,13 +1112,24 @@ sw_probe(struct rte_vdev_device *vdev)
 				return ret;
 			}
 
+			ret = rte_kvargs_process(kvlist, SCHED_SHARDS_ARG,
+					set_sched_shards, &sched_shards);
+			if (ret != 0) {
+				SW_LOG_ERR(
+					"%s: Error parsing sched shards parameter",
+					name);
+				rte_kvargs_free(kvlist);
+				return ret;
+			}
+
 			rte_kvargs_free(kvlist);
 		}
 	}
 
 	SW_LOG_INFO(
-			"Creating eventdev sw device %s, numa_node=%d, sched_quanta=%d, credit_quanta=%d\n",
-			name, socket_id, sched_quanta, credit_quanta);
+			"Creating eventdev sw device %s, numa_node=%d, sched_quanta=%d, credit_quanta=%d, sched_shards=%d\n",
+			name, socket_id, sched_quanta, credit_quanta,
+			sched_shards);
 
 	dev = rte_event_pmd_vdev_init(name,
 			sizeof(struct sw_evdev), socket_id);
@@ -916,6 +1155,11 @@ sw_probe(struct rte_vdev_device *vdev)
 	sw->credit_update_quanta = credit_quanta;
 	sw->sched_quanta = sched_quanta;
 
+	if (sw_shards_init(sw, sched_shards) < 0) {
+		SW_LOG_ERR("shards init() failed");
+		return -ENOMEM;
+	}
+
 	/* register service with EAL */
 	struct rte_service_spec service;
 	memset(&service, 0, sizeof(struct rte_service_spec));
@@ -925,10 +1169,14 @@ sw_probe(struct rte_vdev_device *vdev)
 	service.socket_id = socket_id;
 	service.callback = sw_sched_service_func;
 	service.callback_userdata = (void *)dev;
+	/* several cores may run the shards of a sharded scheduler */
+	if (sw->nb_shards > 1)
+		service.capabilities = RTE_SERVICE_CAP_MT_SAFE;
 
 	int32_t ret = rte_service_component_register(&service, &sw->service_id);
 	if (ret) {
 		SW_LOG_ERR("service register() failed");
+		sw_shards_free(sw);
 		return -ENOEXEC;
 	}
 
@@ -941,6 +1189,7 @@ sw_probe(struct rte_vdev_device *vdev)
 static int
 sw_remove(struct rte_vdev_device *vdev)
 {
+	struct rte_eventdev *dev;
 	const char *name;
 
 	name = rte_vdev_device_name(vdev);
@@ -949,6 +1198,10 @@ sw_remove(struct rte_vdev_device *vdev)
 
 	SW_LOG_INFO("Closing eventdev sw device %s\n", name);
 
+	dev = rte_event_pmd_get_named_dev(name);
+	if (dev != NULL && rte_eal_process_type() == RTE_PROC_PRIMARY)
+		sw_shards_free(sw_pmd_priv(dev));
+
 	return rte_event_pmd_vdev_uninit(name);
 }
 
@@ -959,7 +1212,8 @@ static struct rte_vdev_driver evdev_sw_pmd_drv = {
 
 RTE_PMD_REGISTER_VDEV(EVENTDEV_NAME_SW_PMD, evdev_sw_pmd_drv);
 RTE_PMD_REGISTER_PARAM_STRING(event_sw, NUMA_NODE_ARG "=<int> "
-		SCHED_QUANTA_ARG "=<int>" CREDIT_QUANTA_ARG "=<int>");
+		SCHED_QUANTA_ARG "=<int>" CREDIT_QUANTA_ARG "=<int>"
+		SCHED_SHARDS_ARG "=<int>");
 
 /* declared extern in header, for access from other .c files */
 int eventdev_sw_log_level;
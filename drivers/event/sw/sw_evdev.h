@@ -9,6 +9,7 @@
 #include <rte_eventdev.h>
 #include <rte_eventdev_pmd_vdev.h>
 #include <rte_atomic.h>
+#include <rte_spinlock.h>
 
 #define SW_DEFAULT_CREDIT_QUANTA 32
 #define SW_DEFAULT_SCHED_QUANTA 128
@@ -21,6 +22,7 @@
 /* allow for lots of over-provisioning */
 #define MAX_SW_PROD_Q_DEPTH 4096
 #define SW_FRAGMENTS_MAX 16
+#define SW_SCHED_SHARDS_MAX 8
 
 /* Should be power-of-two minus one, to leave room for the next pointer */
 #define SW_EVS_PER_Q_CHUNK 255
@@ -32,6 +34,8 @@
 #define SCHED_DEQUEUE_BURST_SIZE 32
 
 #define SW_PORT_HIST_LIST (MAX_SW_PROD_Q_DEPTH) /* size of our history list */
+/* shards of the events not released by a port, one history list per shard */
+#define SW_PORT_SHARD_HIST (SW_PORT_HIST_LIST * SW_SCHED_SHARDS_MAX)
 #define NUM_SAMPLES 64 /* how many data points use for average stats */
 
 #define EVENTDEV_NAME_SW_PMD event_sw
@@ -127,6 +131,8 @@ struct sw_qid {
 	uint32_t window_size;          /* Used to wrap reorder_buffer_index */
 
 	uint8_t priority;
+	/* scheduler shard owning this QID, set on start */
+	uint8_t shard;
 };
 
 struct sw_hist_list_entry {
@@ -160,7 +166,13 @@ struct sw_port {
 	/** Ring and buffer for pushing packets to workers after scheduling */
 	struct rte_event_ring *cq_worker_ring;
 
-	/* hole */
+	/* sharded scheduler only: the shard of each event dequeued and not
+	 * released yet, oldest first, and the next shard to dequeue from
+	 */
+	uint8_t *release_shard;
+	uint16_t release_shard_head;
+	uint16_t release_shard_tail;
+	uint8_t deq_shard;
 
 	/* num releases yet to be completed on this port */
 	uint16_t outstanding_releases __rte_cache_aligned;
@@ -195,6 +207,45 @@ struct sw_port {
 	uint8_t num_qids_mapped;
 };
 
+/*
+ * Scheduler state of one shard. A shard schedules the QIDs it owns and has its
+ * own side of every port: rings, history list and CQ buffers. Shards run
+ * concurrently on different service cores.
+ */
+struct sw_shard {
+	/* held by the service core running this shard */
+	rte_spinlock_t lock;
+	uint8_t id;
+	struct sw_evdev *sw;
+
+	/* Scheduler side of the ports, shard 0 uses the device ports */
+	struct sw_port *ports;
+
+	/* Events sent by other shards to the QIDs of this shard */
+	struct rte_event_ring *handoff_ring;
+	/* Events for the QIDs of other shards, flushed at end of schedule */
+	uint16_t handoff_count[SW_SCHED_SHARDS_MAX];
+	struct rte_event handoff_buf[SW_SCHED_SHARDS_MAX]
+			[SCHED_DEQUEUE_BURST_SIZE];
+
+	struct sw_queue_chunk *chunk_list_head;
+	struct sw_queue_chunk *chunks;
+
+	/* Cache how many packets are in each cq */
+	uint16_t cq_ring_space[SW_PORTS_MAX] __rte_cache_aligned;
+
+	/* Array of pointers to the QIDs of this shard sorted by priority */
+	uint32_t qid_count;
+	struct sw_qid *qids_prioritized[RTE_EVENT_MAX_QUEUES_PER_DEV];
+
+	/* Stats */
+	struct sw_point_stats stats __rte_cache_aligned;
+	uint64_t sched_called;
+	uint64_t sched_no_iq_enqueues;
+	uint64_t sched_no_cq_enqueues;
+	uint64_t sched_cq_qid_called;
+} __rte_cache_aligned;
+
 struct sw_evdev {
 	struct rte_eventdev_data *data;
 
@@ -219,22 +270,12 @@ struct sw_evdev {
 
 	/* Internal queues - one per logical queue */
 	struct sw_qid qids[RTE_EVENT_MAX_QUEUES_PER_DEV] __rte_cache_aligned;
-	struct sw_queue_chunk *chunk_list_head;
-	struct sw_queue_chunk *chunks;
 
-	/* Cache how many packets are in each cq */
-	uint16_t cq_ring_space[SW_PORTS_MAX] __rte_cache_aligned;
+	/* Scheduler shards, each one owning a part of the QIDs */
+	uint32_t nb_shards;
+	struct sw_shard shards[SW_SCHED_SHARDS_MAX];
 
-	/* Array of pointers to load-balanced QIDs sorted by priority level */
-	struct sw_qid *qids_prioritized[RTE_EVENT_MAX_QUEUES_PER_DEV];
-
-	/* Stats */
-	struct sw_point_stats stats __rte_cache_aligned;
-	uint64_t sched_called;
 	int32_t sched_quanta;
-	uint64_t sched_no_iq_enqueues;
-	uint64_t sched_no_cq_enqueues;
-	uint64_t sched_cq_qid_called;
 
 	uint8_t started;
 	uint32_t credit_update_quanta;
@@ -269,7 +310,7 @@ uint16_t sw_event_enqueue_burst(void *port, const struct rte_event ev[],
 uint16_t sw_event_dequeue(void *port, struct rte_event *ev, uint64_t wait);
 uint16_t sw_event_dequeue_burst(void *port, struct rte_event *ev, uint16_t num,
 			uint64_t wait);
-void sw_event_schedule(struct rte_eventdev *dev);
+void sw_event_schedule(struct sw_shard *sh);
 int sw_xstats_init(struct sw_evdev *dev);
 int sw_xstats_uninit(struct sw_evdev *dev);
 int sw_xstats_get_names(const struct rte_eventdev *dev,
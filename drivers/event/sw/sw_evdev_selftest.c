@@ -153,9 +153,11 @@ init(struct test *t, int nb_queues, int nb_ports)
 	int ret;
 
 	void *temp = t->mbuf_pool; /* save and restore mbuf pool */
+	uint32_t service_id = t->service_id; /* and the device service */
 
 	memset(t, 0, sizeof(*t));
 	t->mbuf_pool = temp;
+	t->service_id = service_id;
 
 	ret = rte_event_dev_configure(evdev, &config);
 	if (ret < 0)
@@ -3011,6 +3013,180 @@ worker_loopback(struct test *t, uint8_t disable_implicit_release)
 	return 0;
 }
 
+/* a forward which doesn't fit in the ring of its shard must be retryable */
+static int
+sharded_release_ring_full(struct test *t)
+{
+	const int rx_enq = 0;
+	const int wrk_enq = 1;
+	struct test_event_dev_stats stats;
+	struct rte_event ev;
+	struct rte_event evs[32];
+	int err, i;
+
+	if (init(t, 2, 2) < 0 ||
+			create_ports(t, 2) < 0 ||
+			create_atomic_qids(t, 2) < 0) {
+		printf("%d: Error initializing device\n", __LINE__);
+		return -1;
+	}
+
+	/* qid 1 only puts the second shard in use */
+	err = rte_event_port_link(evdev, t->port[wrk_enq], &t->qid[0], NULL,
+			1);
+	err += rte_event_port_link(evdev, t->port[rx_enq], &t->qid[1], NULL,
+			1);
+	if (err != 2) {
+		printf("%d: error mapping lb qid\n", __LINE__);
+		cleanup(t);
+		return -1;
+	}
+
+	if (rte_event_dev_start(evdev) < 0) {
+		printf("%d: Error with start call\n", __LINE__);
+		return -1;
+	}
+
+	ev = (struct rte_event){
+		.op = RTE_EVENT_OP_NEW,
+		.queue_id = t->qid[0],
+		.flow_id = 3,
+		.priority = RTE_EVENT_DEV_PRIORITY_NORMAL,
+	};
+	if (rte_event_enqueue_burst(evdev, t->port[rx_enq], &ev, 1) != 1) {
+		printf("%d: Failed to enqueue\n", __LINE__);
+		return -1;
+	}
+	rte_service_run_iter_on_app_lcore(t->service_id, 1);
+
+	/* with nothing outstanding yet, releases are no-ops which only fill
+	 * the ring of the worker towards the shard of qid 0
+	 */
+	for (i = 0; i < (int)RTE_DIM(evs); i++) {
+		evs[i] = ev;
+		evs[i].op = RTE_EVENT_OP_RELEASE;
+	}
+	while (rte_event_enqueue_burst(evdev, t->port[wrk_enq], evs,
+			RTE_DIM(evs)) == RTE_DIM(evs))
+		;
+
+	if (rte_event_dequeue_burst(evdev, t->port[wrk_enq], &ev, 1, 0) != 1) {
+		printf("%d: Failed to deq\n", __LINE__);
+		return -1;
+	}
+
+	ev.op = RTE_EVENT_OP_FORWARD;
+	if (rte_event_enqueue_burst(evdev, t->port[wrk_enq], &ev, 1) != 0) {
+		printf("%d: Forward enqueued to a full ring\n", __LINE__);
+		return -1;
+	}
+
+	/* drain the ring and retry, the forward must complete the event */
+	for (i = 0; i < 256; i++)
+		rte_service_run_iter_on_app_lcore(t->service_id, 1);
+	if (rte_event_enqueue_burst(evdev, t->port[wrk_enq], &ev, 1) != 1) {
+		printf("%d: Failed to retry forward\n", __LINE__);
+		return -1;
+	}
+	rte_service_run_iter_on_app_lcore(t->service_id, 1);
+
+	err = test_event_dev_stats_get(evdev, &stats);
+	if (err) {
+		printf("%d: failed to get stats\n", __LINE__);
+		return -1;
+	}
+	if (stats.port_inflight[wrk_enq] != 1) {
+		printf("%d: port inflight %"PRIu64", expected 1\n", __LINE__,
+				stats.port_inflight[wrk_enq]);
+		rte_event_dev_dump(evdev, stdout);
+		return -1;
+	}
+
+	cleanup(t);
+	return 0;
+}
+
+/* run a subset of the tests on a device with two scheduler shards */
+static int
+sharded_scheduler(struct test *t)
+{
+	const char *eventdev_name = "event_sw_sharded";
+	const int default_evdev = evdev;
+	const uint32_t default_service_id = t->service_id;
+	int ret = -1;
+
+	evdev = rte_event_dev_get_dev_id(eventdev_name);
+	if (evdev < 0) {
+		if (rte_vdev_init(eventdev_name, "sched_shards=2") < 0) {
+			printf("%d: Error creating sharded eventdev\n",
+					__LINE__);
+			goto out;
+		}
+		evdev = rte_event_dev_get_dev_id(eventdev_name);
+		if (evdev < 0) {
+			printf("%d: Error finding sharded eventdev\n",
+					__LINE__);
+			goto out;
+		}
+	}
+
+	if (rte_event_dev_service_id_get(evdev, &t->service_id) < 0) {
+		printf("%d: Failed to get service ID\n", __LINE__);
+		goto out;
+	}
+	rte_service_runstate_set(t->service_id, 1);
+	rte_service_set_runstate_mapped_check(t->service_id, 0);
+
+	if (single_packet(t) != 0) {
+		printf("%d: Sharded Single Packet test FAILED\n", __LINE__);
+		goto out;
+	}
+	if (unordered_basic(t) != 0) {
+		printf("%d: Sharded Unordered Basic test FAILED\n", __LINE__);
+		goto out;
+	}
+	if (ordered_basic(t) != 0) {
+		printf("%d: Sharded Ordered Basic test FAILED\n", __LINE__);
+		goto out;
+	}
+	if (burst_packets(t) != 0) {
+		printf("%d: Sharded Burst Packets test FAILED\n", __LINE__);
+		goto out;
+	}
+	if (load_balancing(t) != 0) {
+		printf("%d: Sharded Load Balancing test FAILED\n", __LINE__);
+		goto out;
+	}
+	if (inflight_counts(t) != 0) {
+		printf("%d: Sharded Inflight Count test FAILED\n", __LINE__);
+		goto out;
+	}
+	if (sharded_release_ring_full(t) != 0) {
+		printf("%d: Sharded Release Ring Full test FAILED\n",
+				__LINE__);
+		goto out;
+	}
+	/* loops events through 8 queues, so across the two shards */
+	if (rte_lcore_count() >= 3) {
+		if (worker_loopback(t, 0) != 0) {
+			printf("%d: Sharded Worker loopback test FAILED\n",
+					__LINE__);
+			goto out;
+		}
+		if (worker_loopback(t, 1) != 0) {
+			printf("%d: Sharded Worker loopback test (implicit release disabled) FAILED\n",
+					__LINE__);
+			goto out;
+		}
+	}
+	ret = 0;
+
+out:
+	evdev = default_evdev;
+	t->service_id = default_service_id;
+	return ret;
+}
+
 static struct rte_mempool *eventdev_func_mempool;
 
 int
@@ -3229,6 +3405,12 @@ test_sw_eventdev(void)
 		printf("### Not enough cores for worker loopback tests.\n");
 		printf("### Need at least 3 cores for the tests.\n");
 	}
+	printf("*** Running Sharded Scheduler test...\n");
+	ret = sharded_scheduler(t);
+	if (ret != 0) {
+		printf("ERROR - Sharded Scheduler test FAILED.\n");
+		goto test_fail;
+	}
 
 	/*
 	 * Free test instance, leaving mempool initialized, and a pointer to it
@@ -9,6 +9,16 @@
 #include "sw_evdev.h"
 
 #define PORT_ENQUEUE_MAX_BURST_SIZE 64
+#define RELEASE_SHARD_MASK (SW_PORT_SHARD_HIST - 1)
+
+/* the rx ring of the port towards a scheduler shard */
+static inline struct rte_event_ring *
+shard_rx_ring(struct sw_port *p, uint8_t shard)
+{
+	struct sw_evdev *sw = (void *)p->sw;
+
+	return sw->shards[shard].ports[p->id].rx_worker_ring;
+}
 
 static inline void
 sw_event_release(struct sw_port *p, uint8_t index)
@@ -21,10 +31,16 @@ sw_event_release(struct sw_port *p, uint8_t index)
 
 	/* create drop message */
 	struct rte_event ev;
+	struct rte_event_ring *ring = p->rx_worker_ring;
 	ev.op = sw_qe_flag_map[RTE_EVENT_OP_RELEASE];
 
+	/* the release goes to the shard which scheduled the event */
+	if (p->release_shard != NULL)
+		ring = shard_rx_ring(p, p->release_shard[
+				p->release_shard_tail++ & RELEASE_SHARD_MASK]);
+
 	uint16_t free_count;
-	rte_event_ring_enqueue_burst(p->rx_worker_ring, &ev, 1, &free_count);
+	rte_event_ring_enqueue_burst(ring, &ev, 1, &free_count);
 
 	/* each release returns one credit */
 	p->outstanding_releases--;
@@ -49,11 +65,73 @@ enqueue_burst_with_ops(struct rte_event_ring *r, const struct rte_event *events,
 	return rte_event_ring_enqueue_burst(r, tmp_evs, n, NULL);
 }
 
+/*
+ * sharded scheduler version of enqueue_burst_with_ops(), writing each run of
+ * events for the same shard to the port ring of that shard.
+ */
+static inline unsigned int
+enqueue_burst_sharded(struct sw_port *p, const struct rte_event *events,
+		unsigned int n, uint8_t *ops, uint8_t *shards)
+{
+	struct rte_event tmp_evs[PORT_ENQUEUE_MAX_BURST_SIZE];
+	unsigned int i, start, ret, enq = 0;
+
+	memcpy(tmp_evs, events, n * sizeof(events[0]));
+	for (i = 0; i < n; i++)
+		tmp_evs[i].op = ops[i];
+
+	for (start = 0; start < n; start = i) {
+		for (i = start + 1; i < n && shards[i] == shards[start]; i++)
+			;
+		ret = rte_event_ring_enqueue_burst(
+				shard_rx_ring(p, shards[start]),
+				&tmp_evs[start], i - start, NULL);
+		enq += ret;
+		if (ret != i - start)
+			break;
+	}
+
+	return enq;
+}
+
+/*
+ * sharded scheduler dequeue, from the CQ rings of all shards in turn. The
+ * shard of each event is recorded to send its release to the same shard.
+ */
+static inline uint16_t
+dequeue_burst_sharded(struct sw_port *p, struct rte_event *ev, uint16_t num)
+{
+	struct sw_evdev *sw = (void *)p->sw;
+	uint16_t ndeq = 0;
+	uint16_t i, n;
+	uint32_t s;
+
+	for (s = 0; s < sw->nb_shards && ndeq < num; s++) {
+		struct rte_event_ring *ring =
+			sw->shards[p->deq_shard].ports[p->id].cq_worker_ring;
+
+		n = rte_event_ring_dequeue_burst(ring, &ev[ndeq], num - ndeq,
+				NULL);
+		for (i = 0; i < n; i++)
+			p->release_shard[p->release_shard_head++ &
+					RELEASE_SHARD_MASK] = p->deq_shard;
+		ndeq += n;
+
+		if (++p->deq_shard == sw->nb_shards)
+			p->deq_shard = 0;
+	}
+
+	return ndeq;
+}
+
 uint16_t
 sw_event_enqueue_burst(void *port, const struct rte_event ev[], uint16_t num)
 {
 	int32_t i;
 	uint8_t new_ops[PORT_ENQUEUE_MAX_BURST_SIZE];
+	uint8_t shards[PORT_ENQUEUE_MAX_BURST_SIZE];
+	uint8_t completes[PORT_ENQUEUE_MAX_BURST_SIZE];
+	uint16_t n_completes = 0;
 	struct sw_port *p = port;
 	struct sw_evdev *sw = (void *)p->sw;
 	uint32_t sw_inflights = rte_atomic32_read(&sw->inflights);
@@ -85,22 +163,42 @@ sw_event_enqueue_burst(void *port, const struct rte_event ev[], uint16_t num)
 
 	for (i = 0; i < num; i++) {
 		int op = ev[i].op;
-		int outstanding = p->outstanding_releases > 0;
+		int outstanding = p->outstanding_releases > n_completes;
 		const uint8_t invalid_qid = (ev[i].queue_id >= sw->qid_count);
 
 		p->inflight_credits -= (op == RTE_EVENT_OP_NEW);
-		p->inflight_credits += (op == RTE_EVENT_OP_RELEASE) *
-					outstanding;
 
 		new_ops[i] = sw_qe_flag_map[op];
 		new_ops[i] &= ~(invalid_qid << QE_FLAG_VALID_SHIFT);
 
-		/* FWD and RELEASE packets will both resolve to taken (assuming
-		 * correct usage of the API), providing very high correct
-		 * prediction rate.
-		 */
-		if ((new_ops[i] & QE_FLAG_COMPLETE) && outstanding)
-			p->outstanding_releases--;
+		if (p->release_shard == NULL) {
+			p->inflight_credits += (op == RTE_EVENT_OP_RELEASE) *
+						outstanding;
+
+			/* FWD and RELEASE packets will both resolve to taken
+			 * (assuming correct usage of the API), providing very
+			 * high correct prediction rate.
+			 */
+			if ((new_ops[i] & QE_FLAG_COMPLETE) && outstanding)
+				p->outstanding_releases--;
+		} else if ((new_ops[i] & QE_FLAG_COMPLETE) && outstanding) {
+			/* with a sharded scheduler, completions go to the
+			 * shard which scheduled the event. Only peek at the
+			 * release FIFO here: the shard rings may not take the
+			 * whole burst, so entries are consumed below once the
+			 * event is known to be enqueued.
+			 */
+			completes[i] = 1;
+			shards[i] = p->release_shard[(uint16_t)
+					(p->release_shard_tail + n_completes++) &
+					RELEASE_SHARD_MASK];
+		} else {
+			/* new events go to the shard of their QID */
+			completes[i] = 0;
+			new_ops[i] &= ~QE_FLAG_COMPLETE;
+			shards[i] = invalid_qid ? 0 :
+				sw->qids[ev[i].queue_id].shard;
+		}
 
 		/* error case: branch to avoid touching p->stats */
 		if (unlikely(invalid_qid && op != RTE_EVENT_OP_RELEASE)) {
@@ -110,7 +208,23 @@ sw_event_enqueue_burst(void *port, const struct rte_event ev[], uint16_t num)
 	}
 
 	/* returns number of events actually enqueued */
-	uint32_t enq = enqueue_burst_with_ops(p->rx_worker_ring, ev, i,
+	uint32_t enq;
+	if (p->release_shard != NULL) {
+		enq = enqueue_burst_sharded(p, ev, i, new_ops, shards);
+		/* consume release FIFO entries only for completions which
+		 * were enqueued, a retry of the rest must map to the same
+		 * shards
+		 */
+		for (i = 0; i < (int32_t)enq; i++) {
+			if (!completes[i])
+				continue;
+			p->release_shard_tail++;
+			p->outstanding_releases--;
+			p->inflight_credits +=
+				(ev[i].op == RTE_EVENT_OP_RELEASE);
+		}
+	} else
+		enq = enqueue_burst_with_ops(p->rx_worker_ring, ev, i,
 					     new_ops);
 	if (p->outstanding_releases == 0 && p->last_dequeue_burst_sz != 0) {
 		uint64_t burst_ticks = rte_get_timer_cycles() -
@@ -162,7 +276,11 @@ sw_event_dequeue_burst(void *port, struct rte_event *ev, uint16_t num,
 	}
 
 	/* returns number of events actually dequeued */
-	uint16_t ndeq = rte_event_ring_dequeue_burst(ring, ev, num, NULL);
+	uint16_t ndeq;
+	if (p->release_shard != NULL)
+		ndeq = dequeue_burst_sharded(p, ev, num);
+	else
+		ndeq = rte_event_ring_dequeue_burst(ring, ev, num, NULL);
 	if (unlikely(ndeq == 0)) {
 		p->zero_polls++;
 		p->total_polls++;
@@ -50,15 +50,24 @@ static uint64_t
 get_dev_stat(const struct sw_evdev *sw, uint16_t obj_idx __rte_unused,
 		enum xstats_type type, int extra_arg __rte_unused)
 {
-	switch (type) {
-	case rx: return sw->stats.rx_pkts;
-	case tx: return sw->stats.tx_pkts;
-	case dropped: return sw->stats.rx_dropped;
-	case calls: return sw->sched_called;
-	case no_iq_enq: return sw->sched_no_iq_enqueues;
-	case no_cq_enq: return sw->sched_no_cq_enqueues;
-	default: return -1;
+	uint64_t val = 0;
+	unsigned int s;
+
+	/* sum of the scheduler shards */
+	for (s = 0; s < sw->nb_shards; s++) {
+		const struct sw_shard *sh = &sw->shards[s];
+
+		switch (type) {
+		case rx: val += sh->stats.rx_pkts; break;
+		case tx: val += sh->stats.tx_pkts; break;
+		case dropped: val += sh->stats.rx_dropped; break;
+		case calls: val += sh->sched_called; break;
+		case no_iq_enq: val += sh->sched_no_iq_enqueues; break;
+		case no_cq_enq: val += sh->sched_no_cq_enqueues; break;
+		default: return -1;
+		}
 	}
+	return val;
 }
 
 static uint64_t
@@ -66,22 +75,43 @@ get_port_stat(const struct sw_evdev *sw, uint16_t obj_idx,
 		enum xstats_type type, int extra_arg __rte_unused)
 {
 	const struct sw_port *p = &sw->ports[obj_idx];
+	uint64_t val = 0;
+	unsigned int s;
 
+	/* worker side of the port */
 	switch (type) {
-	case rx: return p->stats.rx_pkts;
-	case tx: return p->stats.tx_pkts;
-	case dropped: return p->stats.rx_dropped;
-	case inflight: return p->inflights;
 	case pkt_cycles: return p->avg_pkt_ticks;
 	case calls: return p->total_polls;
 	case credits: return p->inflight_credits;
 	case poll_return: return p->zero_polls;
-	case rx_used: return rte_event_ring_count(p->rx_worker_ring);
-	case rx_free: return rte_event_ring_free_count(p->rx_worker_ring);
-	case tx_used: return rte_event_ring_count(p->cq_worker_ring);
-	case tx_free: return rte_event_ring_free_count(p->cq_worker_ring);
-	default: return -1;
+	default: break;
+	}
+
+	/* scheduler side, sum of the shards */
+	for (s = 0; s < sw->nb_shards; s++) {
+		p = &sw->shards[s].ports[obj_idx];
+
+		switch (type) {
+		case rx: val += p->stats.rx_pkts; break;
+		case tx: val += p->stats.tx_pkts; break;
+		case dropped: val += p->stats.rx_dropped; break;
+		case inflight: val += p->inflights; break;
+		case rx_used:
+			val += rte_event_ring_count(p->rx_worker_ring);
+			break;
+		case rx_free:
+			val += rte_event_ring_free_count(p->rx_worker_ring);
+			break;
+		case tx_used:
+			val += rte_event_ring_count(p->cq_worker_ring);
+			break;
+		case tx_free:
+			val += rte_event_ring_free_count(p->cq_worker_ring);
+			break;
+		default: return -1;
+		}
 	}
+	return val;
 }
 
 static uint64_t
@@ -3,8 +3,10 @@
  */
 
 #include <stdio.h>
+#include <rte_atomic.h>
 #include <rte_mempool.h>
 #include <rte_malloc.h>
+#include <rte_prefetch.h>
 
 struct rte_mempool_stack {
 	rte_spinlock_t sl;
@@ -116,3 +118,207 @@ static struct rte_mempool_ops ops_stack = {
 };
 
 MEMPOOL_REGISTER_OPS(ops_stack);
+
+#ifdef RTE_ARCH_X86_64
+
+/*
+ * Lock-free stack: the objects are stored in a linked list of elements,
+ * pushed and popped with a 128-bit compare-and-swap of the list head
+ * and of a modification counter, which prevents the ABA problem.
+ * The elements not holding an object are kept in a second list.
+ */
+
+struct lf_stack_elem {
+	void *data;
+	struct lf_stack_elem *next;
+};
+
+struct lf_stack_head {
+	struct lf_stack_elem *top;
+	uint64_t cnt; /* modification counter */
+};
+
+struct lf_stack_list {
+	RTE_STD_C11
+	union {
+		struct lf_stack_head head;
+		rte_int128_t head_u;
+	};
+	rte_atomic64_t len;
+};
+
+struct rte_mempool_lf_stack {
+	struct lf_stack_list used __rte_cache_aligned;
+	struct lf_stack_list free __rte_cache_aligned;
+	struct lf_stack_elem elems[] __rte_cache_aligned;
+};
+
+/* Push the chain of num elements from first to last on the list. */
+static __rte_always_inline void
+lf_stack_push(struct lf_stack_list *list, struct lf_stack_elem *first,
+	struct lf_stack_elem *last, unsigned int num)
+{
+	struct lf_stack_head old_head, new_head;
+
+	old_head = list->head;
+
+	do {
+		last->next = old_head.top;
+		new_head.top = first;
+		new_head.cnt = old_head.cnt + 1;
+
+		/* old_head is updated on failure */
+	} while (rte_atomic128_cmp_exchange(&list->head_u,
+			(rte_int128_t *)&old_head,
+			(rte_int128_t *)&new_head) == 0);
+
+	/* make the elements available to the readers once pushed. */
+	rte_atomic64_add(&list->len, num);
+}
+
+/*
+ * Pop num elements from the list, copying their objects to obj_table
+ * if not NULL. Return the first element, and the last one into *last.
+ */
+static __rte_always_inline struct lf_stack_elem *
+lf_stack_pop(struct lf_stack_list *list, unsigned int num,
+	void **obj_table, struct lf_stack_elem **last)
+{
+	struct lf_stack_head old_head, new_head;
+	struct lf_stack_elem *tmp;
+	int64_t len;
+	unsigned int i;
+
+	/* reserve num elements, if available. */
+	do {
+		len = rte_atomic64_read(&list->len);
+		if (unlikely(len < (int64_t)num))
+			return NULL;
+	} while (rte_atomic64_cmpset((volatile uint64_t *)&list->len.cnt,
+			len, len - num) == 0);
+
+	old_head = list->head;
+
+	for (;;) {
+		/*
+		 * Walk to the new head. The elements are never freed, so
+		 * reading an element popped in the meantime is safe, and
+		 * the compare-and-swap fails as the counter has changed.
+		 */
+		tmp = old_head.top;
+		for (i = 0; i != num && tmp != NULL; i++) {
+			rte_prefetch0(tmp->next);
+			if (obj_table != NULL)
+				obj_table[i] = tmp->data;
+			*last = tmp;
+			tmp = tmp->next;
+		}
+
+		/* the list was modified while walking it. */
+		if (unlikely(i != num)) {
+			old_head = list->head;
+			continue;
+		}
+
+		new_head.top = tmp;
+		new_head.cnt = old_head.cnt + 1;
+
+		/* old_head is updated on failure */
+		if (rte_atomic128_cmp_exchange(&list->head_u,
+				(rte_int128_t *)&old_head,
+				(rte_int128_t *)&new_head) != 0)
+			return old_head.top;
+	}
+}
+
+static int
+lf_stack_alloc(struct rte_mempool *mp)
+{
+	struct rte_mempool_lf_stack *s;
+	unsigned int i, n = mp->size;
+	size_t size = sizeof(*s) + n * sizeof(s->elems[0]);
+
+	if (n == 0)
+		return -EINVAL;
+
+	/* Allocate our local memory structure */
+	s = rte_zmalloc_socket("mempool-lf-stack",
+			size,
+			RTE_CACHE_LINE_SIZE,
+			mp->socket_id);
+	if (s == NULL) {
+		RTE_LOG(ERR, MEMPOOL, "Cannot allocate lock-free stack!\n");
+		return -ENOMEM;
+	}
+
+	/* all the elements go to the free list. */
+	for (i = 0; i != n - 1; i++)
+		s->elems[i].next = &s->elems[i + 1];
+	lf_stack_push(&s->free, &s->elems[0], &s->elems[n - 1], n);
+
+	mp->pool_data = s;
+
+	return 0;
+}
+
+static int
+lf_stack_enqueue(struct rte_mempool *mp, void * const *obj_table,
+		unsigned int n)
+{
+	struct rte_mempool_lf_stack *s = mp->pool_data;
+	struct lf_stack_elem *first, *last, *tmp;
+	unsigned int i;
+
+	if (unlikely(n == 0))
+		return 0;
+
+	first = lf_stack_pop(&s->free, n, NULL, &last);
+	if (unlikely(first == NULL))
+		return -ENOBUFS;
+
+	/* the last object of the table goes to the top of the stack. */
+	for (tmp = first, i = n; i != 0; tmp = tmp->next)
+		tmp->data = obj_table[--i];
+
+	lf_stack_push(&s->used, first, last, n);
+	return 0;
+}
+
+static int
+lf_stack_dequeue(struct rte_mempool *mp, void **obj_table,
+		unsigned int n)
+{
+	struct rte_mempool_lf_stack *s = mp->pool_data;
+	struct lf_stack_elem *first, *last;
+
+	if (unlikely(n == 0))
+		return 0;
+
+	first = lf_stack_pop(&s->used, n, obj_table, &last);
+	if (unlikely(first == NULL))
+		return -ENOENT;
+
+	lf_stack_push(&s->free, first, last, n);
+	return 0;
+}
+
+static unsigned int
+lf_stack_get_count(const struct rte_mempool *mp)
+{
+	struct rte_mempool_lf_stack *s = mp->pool_data;
+
+	return rte_atomic64_read(&s->used.len);
+}
+
+static struct rte_mempool_ops ops_lf_stack = {
+	.name = "lf_stack",
+	.alloc = lf_stack_alloc,
+	.free = stack_free,
+	.enqueue = lf_stack_enqueue,
+	.dequeue = lf_stack_dequeue,
+	.get_count = lf_stack_get_count
+};
+
+MEMPOOL_REGISTER_OPS(ops_lf_stack);
+
+#endif /* RTE_ARCH_X86_64 */
@@ -41,11 +41,27 @@ cfg_load_port(struct rte_cfgfile *cfg, struct rte_sched_port_params *port_params
 	if (entry)
 		port_params->n_pipes_per_subport = (uint32_t)atoi(entry);
 
+	entry = rte_cfgfile_get_entry(cfg, "port", "number of traffic classes");
+	if (entry)
+		port_params->n_traffic_classes = (uint32_t)atoi(entry);
+
+	entry = rte_cfgfile_get_entry(cfg, "port", "queues per traffic class");
+	if (entry) {
+		char *next;
+
+		for (j = 0; j < RTE_SCHED_TRAFFIC_CLASSES_MAX; j++) {
+			port_params->n_queues_per_tc[j] = (uint8_t)strtol(entry, &next, 10);
+			if (next == NULL)
+				break;
+			entry = next;
+		}
+	}
+
 	entry = rte_cfgfile_get_entry(cfg, "port", "queue sizes");
 	if (entry) {
 		char *next;
 
-		for(j = 0; j < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; j++) {
+		for (j = 0; j < (int)app_n_traffic_classes(); j++) {
 			port_params->qsize[j] = (uint16_t)strtol(entry, &next, 10);
 			if (next == NULL)
 				break;
@@ -54,7 +70,7 @@ cfg_load_port(struct rte_cfgfile *cfg, struct rte_sched_port_params *port_params
 	}
 
 #ifdef RTE_SCHED_RED
-	for (j = 0; j < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; j++) {
+	for (j = 0; j < (int)app_n_traffic_classes(); j++) {
 		char str[32];
 
 		/* Parse WRED min thresholds */
@@ -130,7 +146,7 @@ cfg_load_port(struct rte_cfgfile *cfg, struct rte_sched_port_params *port_params
 int
 cfg_load_pipe(struct rte_cfgfile *cfg, struct rte_sched_pipe_params *pipe_params)
 {
-	int i, j;
+	int i, j, k, qpos;
 	char *next;
 	const char *entry;
 	int profiles;
@@ -157,68 +173,40 @@ cfg_load_pipe(struct rte_cfgfile *cfg, struct rte_sched_pipe_params *pipe_params
 		if (entry)
 			pipe_params[j].tc_period = (uint32_t)atoi(entry);
 
-		entry = rte_cfgfile_get_entry(cfg, pipe_name, "tc 0 rate");
-		if (entry)
-			pipe_params[j].tc_rate[0] = (uint32_t)atoi(entry);
-
-		entry = rte_cfgfile_get_entry(cfg, pipe_name, "tc 1 rate");
-		if (entry)
-			pipe_params[j].tc_rate[1] = (uint32_t)atoi(entry);
-
-		entry = rte_cfgfile_get_entry(cfg, pipe_name, "tc 2 rate");
-		if (entry)
-			pipe_params[j].tc_rate[2] = (uint32_t)atoi(entry);
+		for (k = 0, qpos = 0; k < (int)app_n_traffic_classes(); k++) {
+			char name[CFG_NAME_LEN];
 
-		entry = rte_cfgfile_get_entry(cfg, pipe_name, "tc 3 rate");
-		if (entry)
-			pipe_params[j].tc_rate[3] = (uint32_t)atoi(entry);
+			snprintf(name, sizeof(name), "tc %d rate", k);
+			entry = rte_cfgfile_get_entry(cfg, pipe_name, name);
+			if (entry)
+				pipe_params[j].tc_rate[k] = (uint32_t)atoi(entry);
+
+			snprintf(name, sizeof(name), "tc %d wrr weights", k);
+			entry = rte_cfgfile_get_entry(cfg, pipe_name, name);
+			if (entry) {
+				for (i = 0; i < (int)app_n_queues_per_tc(k); i++) {
+					pipe_params[j].wrr_weights[qpos + i] =
+						(uint8_t)strtol(entry, &next, 10);
+					if (next == NULL)
+						break;
+					entry = next;
+				}
+			}
+			qpos += app_n_queues_per_tc(k);
+		}
 
 #ifdef RTE_SCHED_SUBPORT_TC_OV
-		entry = rte_cfgfile_get_entry(cfg, pipe_name, "tc 3 oversubscription weight");
-		if (entry)
-			pipe_params[j].tc_ov_weight = (uint8_t)atoi(entry);
-#endif
+		{
+			char name[CFG_NAME_LEN];
 
-		entry = rte_cfgfile_get_entry(cfg, pipe_name, "tc 0 wrr weights");
-		if (entry) {
-			for(i = 0; i < RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS; i++) {
-				pipe_params[j].wrr_weights[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE*0 + i] =
-					(uint8_t)strtol(entry, &next, 10);
-				if (next == NULL)
-					break;
-				entry = next;
-			}
-		}
-		entry = rte_cfgfile_get_entry(cfg, pipe_name, "tc 1 wrr weights");
-		if (entry) {
-			for(i = 0; i < RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS; i++) {
-				pipe_params[j].wrr_weights[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE*1 + i] =
-					(uint8_t)strtol(entry, &next, 10);
-				if (next == NULL)
-					break;
-				entry = next;
-			}
-		}
-		entry = rte_cfgfile_get_entry(cfg, pipe_name, "tc 2 wrr weights");
-		if (entry) {
-			for(i = 0; i < RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS; i++) {
-				pipe_params[j].wrr_weights[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE*2 + i] =
-					(uint8_t)strtol(entry, &next, 10);
-				if (next == NULL)
-					break;
-				entry = next;
-			}
-		}
-		entry = rte_cfgfile_get_entry(cfg, pipe_name, "tc 3 wrr weights");
-		if (entry) {
-			for(i = 0; i < RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS; i++) {
-				pipe_params[j].wrr_weights[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE*3 + i] =
-					(uint8_t)strtol(entry, &next, 10);
-				if (next == NULL)
-					break;
-				entry = next;
-			}
+			/* Only the best effort traffic class can be oversubscribed */
+			snprintf(name, sizeof(name), "tc %u oversubscription weight",
+				app_n_traffic_classes() - 1);
+			entry = rte_cfgfile_get_entry(cfg, pipe_name, name);
+			if (entry)
+				pipe_params[j].tc_ov_weight = (uint8_t)atoi(entry);
 		}
+#endif
 	}
 	return 0;
 }
@@ -251,21 +239,14 @@ cfg_load_subport(struct rte_cfgfile *cfg, struct rte_sched_subport_params *subpo
 			if (entry)
 				subport_params[i].tc_period = (uint32_t)atoi(entry);
 
-			entry = rte_cfgfile_get_entry(cfg, sec_name, "tc 0 rate");
-			if (entry)
-				subport_params[i].tc_rate[0] = (uint32_t)atoi(entry);
+			for (k = 0; k < (int)app_n_traffic_classes(); k++) {
+				char name[CFG_NAME_LEN];
 
-			entry = rte_cfgfile_get_entry(cfg, sec_name, "tc 1 rate");
-			if (entry)
-				subport_params[i].tc_rate[1] = (uint32_t)atoi(entry);
-
-			entry = rte_cfgfile_get_entry(cfg, sec_name, "tc 2 rate");
-			if (entry)
-				subport_params[i].tc_rate[2] = (uint32_t)atoi(entry);
-
-			entry = rte_cfgfile_get_entry(cfg, sec_name, "tc 3 rate");
-			if (entry)
-				subport_params[i].tc_rate[3] = (uint32_t)atoi(entry);
+				snprintf(name, sizeof(name), "tc %d rate", k);
+				entry = rte_cfgfile_get_entry(cfg, sec_name, name);
+				if (entry)
+					subport_params[i].tc_rate[k] = (uint32_t)atoi(entry);
+			}
 
 			int n_entries = rte_cfgfile_section_num_entries(cfg, sec_name);
 			struct rte_cfgfile_entry entries[n_entries];
@@ -149,6 +149,25 @@ extern struct ring_thresh tx_thresh;
 
 extern struct rte_sched_port_params port_params;
 
+/* Traffic class layout of the scheduler ports */
+static inline uint32_t
+app_n_traffic_classes(void)
+{
+	if (port_params.n_traffic_classes == 0)
+		return RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE;
+
+	return port_params.n_traffic_classes;
+}
+
+static inline uint32_t
+app_n_queues_per_tc(uint32_t tc)
+{
+	if (port_params.n_traffic_classes == 0)
+		return RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS;
+
+	return port_params.n_queues_per_tc[tc];
+}
+
 int app_parse_args(int argc, char **argv);
 int app_init(void);
 
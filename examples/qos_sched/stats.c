@@ -22,13 +22,12 @@ qavg_q(uint16_t port_id, uint32_t subport_id, uint32_t pipe_id, uint8_t tc,
                         break;
         }
         if (i == nb_pfc || subport_id >= port_params.n_subports_per_port || pipe_id >= port_params.n_pipes_per_subport
-                        || tc >= RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE || q >= RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS)
+                        || tc >= app_n_traffic_classes() || q >= app_n_queues_per_tc(tc))
                 return -1;
 
         port = qos_conf[i].sched_port;
 
-        queue_id = RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE * RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS * (subport_id * port_params.n_pipes_per_subport + pipe_id);
-        queue_id = queue_id + (tc * RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS + q);
+        queue_id = rte_sched_port_queue_id(port, subport_id, pipe_id, tc, q);
 
         average = 0;
 
@@ -60,22 +59,22 @@ qavg_tcpipe(uint16_t port_id, uint32_t subport_id, uint32_t pipe_id,
                         break;
         }
         if (i == nb_pfc || subport_id >= port_params.n_subports_per_port || pipe_id >= port_params.n_pipes_per_subport
-                        || tc >= RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE)
+                        || tc >= app_n_traffic_classes())
                 return -1;
 
         port = qos_conf[i].sched_port;
 
-        queue_id = RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE * RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS * (subport_id * port_params.n_pipes_per_subport + pipe_id);
+        queue_id = rte_sched_port_queue_id(port, subport_id, pipe_id, tc, 0);
 
         average = 0;
 
         for (count = 0; count < qavg_ntimes; count++) {
                 part_average = 0;
-                for (i = 0; i < RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS; i++) {
-                        rte_sched_queue_read_stats(port, queue_id + (tc * RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS + i), &stats, &qlen);
+                for (i = 0; i < app_n_queues_per_tc(tc); i++) {
+                        rte_sched_queue_read_stats(port, queue_id + i, &stats, &qlen);
                         part_average += qlen;
                 }
-                average += part_average / RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS;
+                average += part_average / app_n_queues_per_tc(tc);
                 usleep(qavg_period);
         }
 
@@ -92,7 +91,7 @@ qavg_pipe(uint16_t port_id, uint32_t subport_id, uint32_t pipe_id)
         struct rte_sched_queue_stats stats;
         struct rte_sched_port *port;
         uint16_t qlen;
-        uint32_t queue_id, count, i;
+        uint32_t queue_id, count, i, j, n_queues;
         uint32_t average, part_average;
 
         for (i = 0; i < nb_pfc; i++) {
@@ -104,17 +103,21 @@ qavg_pipe(uint16_t port_id, uint32_t subport_id, uint32_t pipe_id)
 
         port = qos_conf[i].sched_port;
 
-        queue_id = RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE * RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS * (subport_id * port_params.n_pipes_per_subport + pipe_id);
-
         average = 0;
 
         for (count = 0; count < qavg_ntimes; count++) {
                 part_average = 0;
-                for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE * RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS; i++) {
-                        rte_sched_queue_read_stats(port, queue_id + i, &stats, &qlen);
-                        part_average += qlen;
+                n_queues = 0;
+                for (i = 0; i < app_n_traffic_classes(); i++) {
+                        queue_id = rte_sched_port_queue_id(port, subport_id, pipe_id, i, 0);
+
+                        for (j = 0; j < app_n_queues_per_tc(i); j++) {
+                                rte_sched_queue_read_stats(port, queue_id + j, &stats, &qlen);
+                                part_average += qlen;
+                        }
+                        n_queues += app_n_queues_per_tc(i);
                 }
-                average += part_average / (RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE * RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS);
+                average += part_average / n_queues;
                 usleep(qavg_period);
         }
 
@@ -138,7 +141,7 @@ qavg_tcsubport(uint16_t port_id, uint32_t subport_id, uint8_t tc)
                 if (qos_conf[i].tx_port == port_id)
                         break;
         }
-        if (i == nb_pfc || subport_id >= port_params.n_subports_per_port || tc >= RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE)
+        if (i == nb_pfc || subport_id >= port_params.n_subports_per_port || tc >= app_n_traffic_classes())
                 return -1;
 
         port = qos_conf[i].sched_port;
@@ -148,15 +151,15 @@ qavg_tcsubport(uint16_t port_id, uint32_t subport_id, uint8_t tc)
         for (count = 0; count < qavg_ntimes; count++) {
                 part_average = 0;
                 for (i = 0; i < port_params.n_pipes_per_subport; i++) {
-                        queue_id = RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE * RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS * (subport_id * port_params.n_pipes_per_subport + i);
+                        queue_id = rte_sched_port_queue_id(port, subport_id, i, tc, 0);
 
-                        for (j = 0; j < RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS; j++) {
-                                rte_sched_queue_read_stats(port, queue_id + (tc * RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS + j), &stats, &qlen);
+                        for (j = 0; j < app_n_queues_per_tc(tc); j++) {
+                                rte_sched_queue_read_stats(port, queue_id + j, &stats, &qlen);
                                 part_average += qlen;
                         }
                 }
 
-                average += part_average / (port_params.n_pipes_per_subport * RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS);
+                average += part_average / (port_params.n_pipes_per_subport * app_n_queues_per_tc(tc));
                 usleep(qavg_period);
         }
 
@@ -173,7 +176,7 @@ qavg_subport(uint16_t port_id, uint32_t subport_id)
         struct rte_sched_queue_stats stats;
         struct rte_sched_port *port;
         uint16_t qlen;
-        uint32_t queue_id, count, i, j;
+        uint32_t queue_id, count, i, j, k, n_queues;
         uint32_t average, part_average;
 
         for (i = 0; i < nb_pfc; i++) {
@@ -189,16 +192,20 @@ qavg_subport(uint16_t port_id, uint32_t subport_id)
 
         for (count = 0; count < qavg_ntimes; count++) {
                 part_average = 0;
+                n_queues = 0;
                 for (i = 0; i < port_params.n_pipes_per_subport; i++) {
-                        queue_id = RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE * RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS * (subport_id * port_params.n_pipes_per_subport + i);
-
-                        for (j = 0; j < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE * RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS; j++) {
-                                rte_sched_queue_read_stats(port, queue_id + j, &stats, &qlen);
-                                part_average += qlen;
+                        for (j = 0; j < app_n_traffic_classes(); j++) {
+                                queue_id = rte_sched_port_queue_id(port, subport_id, i, j, 0);
+
+                                for (k = 0; k < app_n_queues_per_tc(j); k++) {
+                                        rte_sched_queue_read_stats(port, queue_id + k, &stats, &qlen);
+                                        part_average += qlen;
+                                }
+                                n_queues += app_n_queues_per_tc(j);
                         }
                 }
 
-                average += part_average / (port_params.n_pipes_per_subport * RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE * RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS);
+                average += part_average / n_queues;
                 usleep(qavg_period);
         }
 
@@ -214,7 +221,7 @@ subport_stat(uint16_t port_id, uint32_t subport_id)
 {
         struct rte_sched_subport_stats stats;
         struct rte_sched_port *port;
-        uint32_t tc_ov[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
+        uint32_t tc_ov;
         uint8_t i;
 
         for (i = 0; i < nb_pfc; i++) {
@@ -225,19 +232,21 @@ subport_stat(uint16_t port_id, uint32_t subport_id)
                 return -1;
 
         port = qos_conf[i].sched_port;
-	memset (tc_ov, 0, sizeof(tc_ov));
+        tc_ov = 0;
 
-        rte_sched_subport_read_stats(port, subport_id, &stats, tc_ov);
+        rte_sched_subport_read_stats(port, subport_id, &stats, &tc_ov);
 
         printf("\n");
         printf("+----+-------------+-------------+-------------+-------------+-------------+\n");
         printf("| TC |   Pkts OK   |Pkts Dropped |  Bytes OK   |Bytes Dropped|  OV Status  |\n");
         printf("+----+-------------+-------------+-------------+-------------+-------------+\n");
 
-        for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i++) {
-                printf("|  %d | %11" PRIu32 " | %11" PRIu32 " | %11" PRIu32 " | %11" PRIu32 " | %11" PRIu32 " |\n", i,
+        /* Only the best effort traffic class can be oversubscribed */
+        for (i = 0; i < app_n_traffic_classes(); i++) {
+                printf("| %2d | %11" PRIu32 " | %11" PRIu32 " | %11" PRIu32 " | %11" PRIu32 " | %11" PRIu32 " |\n", i,
                                 stats.n_pkts_tc[i], stats.n_pkts_tc_dropped[i],
-                                stats.n_bytes_tc[i], stats.n_bytes_tc_dropped[i], tc_ov[i]);
+                                stats.n_bytes_tc[i], stats.n_bytes_tc_dropped[i],
+                                i == app_n_traffic_classes() - 1 ? tc_ov : 0);
                 printf("+----+-------------+-------------+-------------+-------------+-------------+\n");
         }
         printf("\n");
@@ -263,23 +272,23 @@ pipe_stat(uint16_t port_id, uint32_t subport_id, uint32_t pipe_id)
 
         port = qos_conf[i].sched_port;
 
-        queue_id = RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE * RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS * (subport_id * port_params.n_pipes_per_subport + pipe_id);
-
         printf("\n");
         printf("+----+-------+-------------+-------------+-------------+-------------+-------------+\n");
         printf("| TC | Queue |   Pkts OK   |Pkts Dropped |  Bytes OK   |Bytes Dropped|    Length   |\n");
         printf("+----+-------+-------------+-------------+-------------+-------------+-------------+\n");
 
-        for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i++) {
-                for (j = 0; j < RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS; j++) {
+        for (i = 0; i < app_n_traffic_classes(); i++) {
+                queue_id = rte_sched_port_queue_id(port, subport_id, pipe_id, i, 0);
+
+                for (j = 0; j < app_n_queues_per_tc(i); j++) {
 
-                        rte_sched_queue_read_stats(port, queue_id + (i * RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS + j), &stats, &qlen);
+                        rte_sched_queue_read_stats(port, queue_id + j, &stats, &qlen);
 
-                        printf("|  %d |   %d   | %11" PRIu32 " | %11" PRIu32 " | %11" PRIu32 " | %11" PRIu32 " | %11i |\n", i, j,
+                        printf("| %2d |   %d   | %11" PRIu32 " | %11" PRIu32 " | %11" PRIu32 " | %11" PRIu32 " | %11i |\n", i, j,
                                         stats.n_pkts, stats.n_pkts_dropped, stats.n_bytes, stats.n_bytes_dropped, qlen);
                         printf("+----+-------+-------------+-------------+-------------+-------------+-------------+\n");
                 }
-                if (i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE - 1)
+                if (i < app_n_traffic_classes() - 1)
                         printf("+----+-------+-------------+-------------+-------------+-------------+-------------+\n");
         }
         printf("\n");
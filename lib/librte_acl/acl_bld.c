@@ -15,6 +15,7 @@
 /* macros for dividing rule sets heuristics */
 #define NODE_MAX	0x4000
 #define NODE_MIN	0x800
+#define NODE_LIMIT	(NODE_MAX << 6)
 
 /* TALLY are statistics per field */
 enum {
@@ -77,10 +78,15 @@ struct acl_build_context {
 	uint32_t                  src_mask;
 	uint32_t                  num_build_rules;
 	uint32_t                  num_tries;
+	uint32_t                  max_tries;
+	uint32_t                  num_groups;
+	uint32_t                  fail_rule;
 	struct tb_mem_pool        pool;
 	struct rte_acl_trie       tries[RTE_ACL_MAX_TRIES];
 	struct rte_acl_bld_trie   bld_tries[RTE_ACL_MAX_TRIES];
 	uint32_t            data_indexes[RTE_ACL_MAX_TRIES][RTE_ACL_MAX_FIELDS];
+	uint32_t                  split_rule[RTE_ACL_MAX_TRIES];
+	struct rte_acl_config     *trie_cfg[RTE_ACL_MAX_TRIES];
 
 	/* memory free lists for nodes and blocks used for node ptrs */
 	struct acl_mem_block      blocks[MEM_BLOCK_NUM];
@@ -1252,6 +1258,7 @@ build_one_trie(struct acl_build_context *context,
 	struct rte_acl_config *config;
 
 	config = rule_sets[n]->config;
+	context->trie_cfg[n] = config;
 
 	acl_rule_stats(rule_sets[n], config);
 	rule_sets[n] = sort_rules(rule_sets[n]);
@@ -1271,6 +1278,93 @@ build_one_trie(struct acl_build_context *context,
 	return last;
 }
 
+/*
+ * Split the rules into groups of rules with the same wild fields, so that
+ * the trie of each group can drop the fields wild in all its rules.
+ * The largest (num_groups - 1) groups are kept as is, the remaining ones
+ * are put together into the last group.
+ * Returns the number of groups.
+ */
+static uint32_t
+acl_build_groups(struct acl_build_context *context,
+	struct rte_acl_build_rule *head,
+	struct rte_acl_build_rule *rule_sets[RTE_ACL_MAX_TRIES])
+{
+	struct acl_build_group {
+		uint64_t wild;
+		uint32_t num;
+		struct rte_acl_build_rule *head;
+		struct rte_acl_build_rule **tail;
+	} *grp, tmp;
+	struct rte_acl_build_rule *next, *rule;
+	const struct rte_acl_config *cfg;
+	struct rte_acl_config *config;
+	uint32_t i, j, k, num;
+	uint64_t wild;
+
+	cfg = head->config;
+	grp = acl_build_alloc(context, context->num_rules, sizeof(*grp));
+
+	num = 0;
+	for (rule = head; rule != NULL; rule = next) {
+
+		next = rule->next;
+		rule->next = NULL;
+
+		/* first field is never dropped, see acl_rule_stats(). */
+		wild = 0;
+		for (i = 1; i != cfg->num_fields; i++) {
+			k = cfg->defs[i].field_index;
+			if (rule->wildness[k] == 100)
+				wild |= UINT64_C(1) << k;
+		}
+
+		for (i = 0; i != num && grp[i].wild != wild; i++)
+			;
+
+		if (i == num) {
+			grp[i].wild = wild;
+			grp[i].num = 0;
+			grp[i].head = rule;
+			num++;
+		} else
+			*grp[i].tail = rule;
+
+		grp[i].tail = &rule->next;
+		grp[i].num++;
+	}
+
+	/* sort groups by number of rules, largest first. */
+	for (i = 1; i < num; i++) {
+		tmp = grp[i];
+		for (j = i; j != 0 && grp[j - 1].num < tmp.num; j--)
+			grp[j] = grp[j - 1];
+		grp[j] = tmp;
+	}
+
+	/* put the smallest groups together. */
+	k = context->num_groups - 1;
+	for (i = context->num_groups; i < num; i++) {
+		*grp[k].tail = grp[i].head;
+		grp[k].tail = grp[i].tail;
+		grp[k].num += grp[i].num;
+	}
+	num = RTE_MIN(num, context->num_groups);
+
+	/* each group gets its own copy of config, as fields get dropped. */
+	for (i = 0; i != num; i++) {
+		config = acl_build_alloc(context, 1, sizeof(*config));
+		memcpy(config, cfg, sizeof(*config));
+
+		for (rule = grp[i].head; rule != NULL; rule = rule->next)
+			rule->config = config;
+
+		rule_sets[i] = grp[i].head;
+	}
+
+	return num;
+}
+
 static int
 acl_build_tries(struct acl_build_context *context,
 	struct rte_acl_build_rule *head)
@@ -1281,13 +1375,14 @@ acl_build_tries(struct acl_build_context *context,
 	struct rte_acl_build_rule *rule_sets[RTE_ACL_MAX_TRIES];
 
 	config = head->config;
-	rule_sets[0] = head;
 
 	/* initialize tries */
 	for (n = 0; n < RTE_DIM(context->tries); n++) {
 		context->tries[n].type = RTE_ACL_UNUSED_TRIE;
 		context->bld_tries[n].trie = NULL;
 		context->tries[n].count = 0;
+		context->split_rule[n] = 0;
+		context->trie_cfg[n] = NULL;
 	}
 
 	context->tries[0].type = RTE_ACL_FULL_TRIE;
@@ -1295,9 +1390,14 @@ acl_build_tries(struct acl_build_context *context,
 	/* calc wildness of each field of each rule */
 	acl_calc_wildness(head, config);
 
-	for (n = 0;; n = num_tries) {
+	if (context->num_groups > 1) {
+		num_tries = acl_build_groups(context, head, rule_sets);
+	} else {
+		rule_sets[0] = head;
+		num_tries = 1;
+	}
 
-		num_tries = n + 1;
+	for (n = 0; n != num_tries; n++) {
 
 		last = build_one_trie(context, rule_sets, n, context->node_max);
 		if (context->bld_tries[n].trie == NULL) {
@@ -1305,20 +1405,31 @@ acl_build_tries(struct acl_build_context *context,
 			return -ENOMEM;
 		}
 
-		/* Build of the last trie completed. */
-		if (last == NULL)
-			break;
+		/* Build of that trie completed. */
+		if (last == NULL || last->next == NULL)
+			continue;
 
-		if (num_tries == RTE_DIM(context->tries)) {
-			RTE_LOG(ERR, ACL,
-				"Exceeded max number of tries: %u\n",
-				num_tries);
-			return -ENOMEM;
+		if (num_tries == context->max_tries) {
+			context->fail_rule = last->next->f->data.userdata;
+			RTE_LOG(DEBUG, ACL,
+				"Exceeded max number of tries: %u, "
+				"rule %u doesn't fit\n",
+				num_tries, context->fail_rule);
+			context->num_tries = num_tries;
+			return -E2BIG;
 		}
 
-		/* Trie is getting too big, split remaining rule set. */
-		rule_sets[num_tries] = last->next;
+		/*
+		 * Trie is getting too big, split remaining rule set,
+		 * and build it right after the current one.
+		 */
+		memmove(rule_sets + n + 2, rule_sets + n + 1,
+			(num_tries - n - 1) * sizeof(rule_sets[0]));
+		num_tries++;
+
+		rule_sets[n + 1] = last->next;
 		last->next = NULL;
+		context->split_rule[n] = rule_sets[n + 1]->f->data.userdata;
 		acl_free_node(context, context->bld_tries[n].trie);
 
 		/* Create a new copy of config for remaining rules. */
@@ -1326,7 +1437,7 @@ acl_build_tries(struct acl_build_context *context,
 		memcpy(config, rule_sets[n]->config, sizeof(*config));
 
 		/* Make remaining rules use new config. */
-		for (head = rule_sets[num_tries]; head != NULL;
+		for (head = rule_sets[n + 1]; head != NULL;
 				head = head->next)
 			head->config = config;
 
@@ -1339,7 +1450,6 @@ acl_build_tries(struct acl_build_context *context,
 			RTE_LOG(ERR, ACL, "Build of %u-th trie failed\n", n);
 			return -ENOMEM;
 		}
-
 	}
 
 	context->num_tries = num_tries;
@@ -1435,7 +1545,8 @@ acl_set_data_indexes(struct rte_acl_ctx *ctx)
  */
 static int
 acl_bld(struct acl_build_context *bcx, struct rte_acl_ctx *ctx,
-	const struct rte_acl_config *cfg, uint32_t node_max)
+	const struct rte_acl_config *cfg, uint32_t node_max,
+	uint32_t max_tries, uint32_t num_groups)
 {
 	int32_t rc;
 
@@ -1448,6 +1559,8 @@ acl_bld(struct acl_build_context *bcx, struct rte_acl_ctx *ctx,
 	bcx->category_mask = RTE_LEN2MASK(bcx->cfg.num_categories,
 		typeof(bcx->category_mask));
 	bcx->node_max = node_max;
+	bcx->max_tries = max_tries;
+	bcx->num_groups = num_groups;
 
 	rc = sigsetjmp(bcx->pool.fail, 0);
 
@@ -1517,13 +1630,108 @@ acl_check_bld_param(struct rte_acl_ctx *ctx, const struct rte_acl_config *cfg)
 	return 0;
 }
 
+/*
+ * Fill the build report from the build context of the last attempt.
+ */
+static void
+acl_build_report(const struct acl_build_context *bcx,
+	struct rte_acl_build_report *report)
+{
+	uint32_t i, n;
+	uint64_t fields;
+	const struct rte_acl_config *cfg;
+	struct rte_acl_trie_report *rpt;
+
+	fields = 0;
+	for (i = 0; i != bcx->cfg.num_fields; i++)
+		fields |= UINT64_C(1) << bcx->cfg.defs[i].field_index;
+
+	report->num_rules = bcx->num_rules;
+	report->num_tries = bcx->num_tries;
+	report->node_max = bcx->node_max;
+	report->fail_rule = bcx->fail_rule;
+	report->num_transitions = 0;
+
+	for (n = 0; n != bcx->num_tries; n++) {
+
+		/* trie not built yet, when running out of tries. */
+		cfg = bcx->trie_cfg[n];
+		if (cfg == NULL)
+			continue;
+
+		rpt = report->trie + n;
+		rpt->num_rules = bcx->tries[n].count;
+		rpt->split_rule = bcx->split_rule[n];
+		rpt->num_fields = cfg->num_fields;
+		rpt->wild_fields = fields;
+		rpt->num_transitions = 0;
+
+		for (i = 0; i != cfg->num_fields; i++) {
+			rpt->wild_fields &=
+				~(UINT64_C(1) << cfg->defs[i].field_index);
+			rpt->num_transitions += cfg->defs[i].size;
+		}
+
+		report->num_transitions += rpt->num_transitions;
+	}
+}
+
+/*
+ * Perform one build attempt of the context, with the given node limit
+ * for its tries.
+ */
+static int
+acl_build_once(struct rte_acl_ctx *ctx, const struct rte_acl_config *cfg,
+	uint32_t node_max, uint32_t max_tries, uint32_t num_groups,
+	struct rte_acl_build_report *report)
+{
+	int32_t rc;
+	uint32_t num_builds;
+	size_t max_size;
+	struct acl_build_context bcx;
+
+	max_size = (cfg->max_size == 0) ? SIZE_MAX : cfg->max_size;
+
+	if (report != NULL) {
+		num_builds = report->num_builds;
+		memset(report, 0, sizeof(*report));
+		report->num_builds = num_builds + 1;
+	}
+
+	/* perform build phase. */
+	rc = acl_bld(&bcx, ctx, cfg, node_max, max_tries, num_groups);
+
+	if (rc == 0) {
+		/* allocate and fill run-time  structures. */
+		rc = rte_acl_gen(ctx, bcx.tries, bcx.bld_tries,
+			bcx.num_tries, bcx.cfg.num_categories,
+			RTE_ACL_MAX_FIELDS * RTE_DIM(bcx.tries) *
+			sizeof(ctx->data_indexes[0]), max_size, report);
+		if (rc == 0) {
+			/* set data indexes. */
+			acl_set_data_indexes(ctx);
+
+			/* copy in build config. */
+			ctx->config = *cfg;
+		}
+	}
+
+	if (report != NULL)
+		acl_build_report(&bcx, report);
+
+	acl_build_log(&bcx);
+
+	/* cleanup after build. */
+	tb_free_pool(&bcx.pool);
+
+	return rc;
+}
+
 int
 rte_acl_build(struct rte_acl_ctx *ctx, const struct rte_acl_config *cfg)
 {
 	int32_t rc;
 	uint32_t n;
-	size_t max_size;
-	struct acl_build_context bcx;
 
 	rc = acl_check_bld_param(ctx, cfg);
 	if (rc != 0)
@@ -1531,38 +1739,80 @@ rte_acl_build(struct rte_acl_ctx *ctx, const struct rte_acl_config *cfg)
 
 	acl_build_reset(ctx);
 
-	if (cfg->max_size == 0) {
+	if (cfg->max_size == 0)
 		n = NODE_MIN;
-		max_size = SIZE_MAX;
-	} else {
+	else
 		n = NODE_MAX;
-		max_size = cfg->max_size;
+
+	for (rc = -ERANGE; n >= NODE_MIN && rc == -ERANGE; n /= 2)
+		rc = acl_build_once(ctx, cfg, n, RTE_ACL_MAX_TRIES, 1, NULL);
+
+	/* running out of tries */
+	if (rc == -E2BIG) {
+		RTE_LOG(ERR, ACL,
+			"ACL context: %s, exceeded max number of tries: %u\n",
+			ctx->name, RTE_ACL_MAX_TRIES);
+		rc = -ENOMEM;
 	}
 
-	for (rc = -ERANGE; n >= NODE_MIN && rc == -ERANGE; n /= 2) {
+	return rc;
+}
 
-		/* perform build phase. */
-		rc = acl_bld(&bcx, ctx, cfg, n);
+int __rte_experimental
+rte_acl_build_budget(struct rte_acl_ctx *ctx, const struct rte_acl_config *cfg,
+	const struct rte_acl_build_param *param,
+	struct rte_acl_build_report *report)
+{
+	int32_t rc;
+	uint32_t max_tries, n, num_groups;
 
-		if (rc == 0) {
-			/* allocate and fill run-time  structures. */
-			rc = rte_acl_gen(ctx, bcx.tries, bcx.bld_tries,
-				bcx.num_tries, bcx.cfg.num_categories,
-				RTE_ACL_MAX_FIELDS * RTE_DIM(bcx.tries) *
-				sizeof(ctx->data_indexes[0]), max_size);
-			if (rc == 0) {
-				/* set data indexes. */
-				acl_set_data_indexes(ctx);
-
-				/* copy in build config. */
-				ctx->config = *cfg;
-			}
-		}
+	rc = acl_check_bld_param(ctx, cfg);
+	if (rc != 0)
+		return rc;
 
-		acl_build_log(&bcx);
+	if (param == NULL || param->max_tries > RTE_ACL_MAX_TRIES ||
+			(param->flags & ~RTE_ACL_BUILD_F_GROUP_WILDCARD) != 0)
+		return -EINVAL;
 
-		/* cleanup after build. */
-		tb_free_pool(&bcx.pool);
+	max_tries = (param->max_tries == 0) ?
+		RTE_ACL_MAX_TRIES : param->max_tries;
+	num_groups = (param->flags & RTE_ACL_BUILD_F_GROUP_WILDCARD) ?
+		max_tries : 1;
+
+	if (report != NULL)
+		memset(report, 0, sizeof(*report));
+
+	acl_build_reset(ctx);
+
+	/*
+	 * Smaller tries take less memory, but more of them have to be
+	 * traversed per lookup: shrink the tries while they exceed the
+	 * memory budget, grow them while they exceed max_tries.
+	 * If it is not enough, use fewer groups of rules, leaving more
+	 * room to split the tries.
+	 */
+	do {
+		n = NODE_MAX;
+		rc = acl_build_once(ctx, cfg, n, max_tries, num_groups,
+			report);
+
+		while (rc == -ERANGE && (n /= 2) >= NODE_MIN)
+			rc = acl_build_once(ctx, cfg, n, max_tries, num_groups,
+				report);
+
+		while (rc == -E2BIG && (n *= 2) <= NODE_LIMIT)
+			rc = acl_build_once(ctx, cfg, n, max_tries, num_groups,
+				report);
+
+		num_groups /= 2;
+	} while (rc == -E2BIG && num_groups != 0);
+
+	/* running out of tries */
+	if (rc == -E2BIG) {
+		RTE_LOG(ERR, ACL,
+			"ACL context: %s, exceeded max number of tries: %u\n",
+			ctx->name, max_tries);
+		rc = -ENOMEM;
 	}
 
 	return rc;
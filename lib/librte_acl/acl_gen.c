@@ -414,21 +414,44 @@ acl_gen_node(struct rte_acl_node *node, uint64_t *node_array,
 	}
 }
 
+/*
+ * Report the nodes of a trie, counted between prev and counts.
+ */
+static void
+acl_trie_report(const struct acl_node_counters *counts,
+	const struct acl_node_counters *prev, struct rte_acl_trie_report *rpt)
+{
+	int32_t match;
+
+	match = counts->match - prev->match;
+	rpt->num_nodes = match + counts->single - prev->single +
+		counts->quad - prev->quad + counts->dfa - prev->dfa;
+	rpt->mem_sz = (counts->single - prev->single +
+		counts->quad_vectors - prev->quad_vectors +
+		(counts->dfa_gr64 - prev->dfa_gr64) * RTE_ACL_DFA_GR64_SIZE) *
+		sizeof(uint64_t) +
+		match * sizeof(struct rte_acl_match_results);
+}
+
 static void
 acl_calc_counts_indices(struct acl_node_counters *counts,
 	struct rte_acl_indices *indices,
 	struct rte_acl_bld_trie *node_bld_trie, uint32_t num_tries,
-	uint64_t no_match)
+	uint64_t no_match, struct rte_acl_build_report *report)
 {
 	uint32_t n;
+	struct acl_node_counters prev;
 
 	memset(indices, 0, sizeof(*indices));
 	memset(counts, 0, sizeof(*counts));
 
 	/* Get stats on nodes */
 	for (n = 0; n < num_tries; n++) {
+		prev = *counts;
 		acl_count_trie_types(counts, node_bld_trie[n].trie,
 			no_match, 1);
+		if (report != NULL)
+			acl_trie_report(counts, &prev, report->trie + n);
 	}
 
 	indices->dfa_index = RTE_ACL_DFA_SIZE + 1;
@@ -447,7 +470,8 @@ acl_calc_counts_indices(struct acl_node_counters *counts,
 int
 rte_acl_gen(struct rte_acl_ctx *ctx, struct rte_acl_trie *trie,
 	struct rte_acl_bld_trie *node_bld_trie, uint32_t num_tries,
-	uint32_t num_categories, uint32_t data_index_sz, size_t max_size)
+	uint32_t num_categories, uint32_t data_index_sz, size_t max_size,
+	struct rte_acl_build_report *report)
 {
 	void *mem;
 	size_t total_size;
@@ -461,7 +485,7 @@ rte_acl_gen(struct rte_acl_ctx *ctx, struct rte_acl_trie *trie,
 
 	/* Fill counts and indices arrays from the nodes. */
 	acl_calc_counts_indices(&counts, &indices,
-		node_bld_trie, num_tries, no_match);
+		node_bld_trie, num_tries, no_match, report);
 
 	/* Allocate runtime memory (align to cache boundary) */
 	total_size = RTE_ALIGN(data_index_sz, RTE_CACHE_LINE_SIZE) +
@@ -469,6 +493,9 @@ rte_acl_gen(struct rte_acl_ctx *ctx, struct rte_acl_trie *trie,
 		(counts.match + 1) * sizeof(struct rte_acl_match_results) +
 		XMM_SIZE;
 
+	if (report != NULL)
+		report->mem_sz = total_size;
+
 	if (total_size > max_size) {
 		RTE_LOG(DEBUG, ACL,
 			"Gen phase for ACL ctx \"%s\" exceeds max_size limit, "
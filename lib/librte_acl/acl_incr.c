@@ -0,0 +1,944 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2018 Intel Corporation
+ */
+
+#include <rte_atomic.h>
+#include <rte_spinlock.h>
+
+#include <rte_acl.h>
+#include "rte_acl_incr.h"
+#include "acl.h"
+
+/* number of inputs classified at once against each trie */
+#define ACL_INCR_BURST	64
+
+#define	ACL_INCR_BITMAP_WORDS(n)	(((n) + 63) / 64)
+
+enum {
+	ACL_INCR_RULE_FREE,
+	ACL_INCR_RULE_LIVE,    /* in the main trie of its trie slot */
+	ACL_INCR_RULE_DELETED, /* still in the main trie, masked by the patch */
+	ACL_INCR_RULE_RETIRED, /* out of all the tries, freed on reclaim */
+};
+
+struct acl_incr_rule {
+	int32_t  priority;
+	uint32_t userdata;
+	uint32_t category_mask;
+	uint8_t  trie;     /* slot of the trie holding the rule */
+	uint8_t  state;
+	uint8_t  in_patch; /* in the patch trie of its slot */
+	uint8_t  in_merge; /* in the merge in progress */
+};
+
+/* ACL context of a trie, linked into the retired list once replaced. */
+struct acl_incr_ctx {
+	struct rte_acl_ctx  *ctx;
+	struct acl_incr_ctx *next;
+};
+
+struct acl_incr_trie {
+	struct acl_incr_ctx *main;  /* live and deleted rules of the slot */
+	struct acl_incr_ctx *patch; /* live rules overlapping deleted ones */
+	uint32_t num_rules;         /* live and deleted rules in main */
+	uint32_t num_deleted;
+	uint32_t num_patch;
+};
+
+/*
+ * Tries and deleted rules seen by the classification. It is never
+ * modified once published, an update publishes a new one.
+ */
+struct acl_incr_view {
+	struct acl_incr_view *next; /* retired list link */
+	uint32_t num_tries;
+	struct {
+		const struct rte_acl_ctx *main;
+		const struct rte_acl_ctx *patch;
+	} trie[RTE_ACL_INCR_MAX_TRIES];
+	uint64_t deleted[0];        /* bitmap of the deleted rules */
+};
+
+struct rte_acl_incr {
+	char                  name[RTE_ACL_NAMESIZE];
+	int32_t               socket_id;
+	uint32_t              rule_sz;
+	uint32_t              max_rules;
+	uint32_t              delta_max;
+	uint32_t              num_rules; /* live rules */
+	uint32_t              num_used;  /* rule slots not free */
+	uint32_t              free_idx;  /* where to look for a free slot */
+	uint32_t              id;        /* to name the ACL contexts */
+	uint32_t              seq;
+	uint32_t              delta;     /* slot of the delta trie */
+	uint32_t              merging;   /* mask of the slots being merged */
+	rte_spinlock_t        lock;
+	struct rte_acl_config cfg;
+	struct acl_incr_view *view;      /* published with release order */
+	struct acl_incr_trie  trie[RTE_ACL_INCR_MAX_TRIES];
+	struct acl_incr_ctx  *retired_ctx;
+	struct acl_incr_view *retired_view;
+	uint64_t             *deleted;
+	uint8_t              *rules;
+	struct acl_incr_rule *meta;
+	uint32_t             *ids;       /* scratch array of rule indexes */
+};
+
+static rte_atomic32_t acl_incr_num = RTE_ATOMIC32_INIT(0);
+
+static inline const struct rte_acl_rule *
+acl_incr_rule(const struct rte_acl_incr *incr, uint32_t idx)
+{
+	return (const struct rte_acl_rule *)
+		(incr->rules + (size_t)idx * incr->rule_sz);
+}
+
+static inline int
+acl_incr_is_deleted(const uint64_t *bitmap, uint32_t idx)
+{
+	return (bitmap[idx / 64] & (UINT64_C(1) << (idx % 64))) != 0;
+}
+
+static inline void
+acl_incr_set_deleted(struct rte_acl_incr *incr, uint32_t idx, int set)
+{
+	if (set)
+		incr->deleted[idx / 64] |= UINT64_C(1) << (idx % 64);
+	else
+		incr->deleted[idx / 64] &= ~(UINT64_C(1) << (idx % 64));
+}
+
+static uint64_t
+acl_incr_len2mask(uint32_t len, uint32_t bits)
+{
+	uint64_t msk = RTE_LEN2MASK(bits, uint64_t);
+
+	if (len == 0)
+		return 0;
+	if (len >= bits)
+		return msk;
+	return (msk << (bits - len)) & msk;
+}
+
+/* Check if some input can match the field of both rules. */
+static int
+acl_incr_field_overlap(const struct rte_acl_field_def *def,
+	const struct rte_acl_field *f1, const struct rte_acl_field *f2)
+{
+	uint32_t bits = def->size * CHAR_BIT;
+	uint64_t msk = RTE_LEN2MASK(bits, uint64_t);
+	uint64_t m1, m2;
+
+	switch (def->type) {
+	case RTE_ACL_FIELD_TYPE_RANGE:
+		return (f1->value.u64 & msk) <= (f2->mask_range.u64 & msk) &&
+			(f2->value.u64 & msk) <= (f1->mask_range.u64 & msk);
+	case RTE_ACL_FIELD_TYPE_MASK:
+		m1 = acl_incr_len2mask(f1->mask_range.u32, bits);
+		m2 = acl_incr_len2mask(f2->mask_range.u32, bits);
+		break;
+	default:
+		m1 = f1->mask_range.u64;
+		m2 = f2->mask_range.u64;
+		break;
+	}
+	return ((f1->value.u64 ^ f2->value.u64) & m1 & m2 & msk) == 0;
+}
+
+/*
+ * Check if some input can match both rules in a same category, i.e.
+ * if the second rule may be the best match for an input when the first
+ * one is deleted.
+ */
+static int
+acl_incr_overlap(const struct rte_acl_incr *incr, uint32_t a, uint32_t b)
+{
+	const struct rte_acl_rule *ra, *rb;
+	const struct rte_acl_field_def *def;
+	uint32_t n;
+
+	if ((incr->meta[a].category_mask & incr->meta[b].category_mask) == 0)
+		return 0;
+
+	ra = acl_incr_rule(incr, a);
+	rb = acl_incr_rule(incr, b);
+	for (n = 0; n != incr->cfg.num_fields; n++) {
+		def = incr->cfg.defs + n;
+		if (!acl_incr_field_overlap(def, ra->field + def->field_index,
+				rb->field + def->field_index))
+			return 0;
+	}
+	return 1;
+}
+
+static void
+acl_incr_ctx_free(struct acl_incr_ctx *ic)
+{
+	if (ic == NULL)
+		return;
+	rte_acl_free(ic->ctx);
+	rte_free(ic);
+}
+
+/* Keep a replaced context until the classifications are done with it. */
+static void
+acl_incr_retire(struct rte_acl_incr *incr, struct acl_incr_ctx *ic)
+{
+	if (ic == NULL)
+		return;
+	ic->next = incr->retired_ctx;
+	incr->retired_ctx = ic;
+}
+
+static void
+acl_incr_ctx_name(struct rte_acl_incr *incr, char *name, size_t sz)
+{
+	snprintf(name, sz, "ACLI%u_%u", incr->id, incr->seq++);
+}
+
+/*
+ * Build an ACL context from a set of rules. The userdata of each rule
+ * is replaced by its index plus one, to get its priority from the results.
+ */
+static int
+acl_incr_build(struct rte_acl_incr *incr, const char *name,
+	const uint32_t *ids, uint32_t num, struct acl_incr_ctx **res)
+{
+	struct rte_acl_param prm;
+	struct rte_acl_ctx *ctx;
+	struct acl_incr_ctx *ic;
+	struct rte_acl_rule *rule;
+	uint32_t i;
+	int32_t rc;
+
+	*res = NULL;
+	if (num == 0)
+		return 0;
+
+	ic = rte_zmalloc_socket("ACL_INCR_CTX", sizeof(*ic), 0,
+		incr->socket_id);
+	if (ic == NULL)
+		return -ENOMEM;
+
+	prm.name = name;
+	prm.socket_id = incr->socket_id;
+	prm.rule_size = incr->rule_sz;
+	prm.max_rule_num = num;
+	ctx = rte_acl_create(&prm);
+	if (ctx == NULL) {
+		rte_free(ic);
+		return -ENOMEM;
+	}
+
+	for (i = 0; i != num; i++) {
+		rc = rte_acl_add_rules(ctx, acl_incr_rule(incr, ids[i]), 1);
+		if (rc != 0)
+			goto err;
+		rule = (struct rte_acl_rule *)
+			((uintptr_t)ctx->rules + i * ctx->rule_sz);
+		rule->data.userdata = ids[i] + 1;
+	}
+
+	rc = rte_acl_build(ctx, &incr->cfg);
+	if (rc != 0)
+		goto err;
+
+	ic->ctx = ctx;
+	*res = ic;
+	return 0;
+
+err:
+	RTE_LOG(ERR, ACL, "%s(%s): build of %u rules failed: %d\n",
+		__func__, incr->name, num, rc);
+	rte_acl_free(ctx);
+	rte_free(ic);
+	return rc;
+}
+
+static struct acl_incr_view *
+acl_incr_view_alloc(struct rte_acl_incr *incr)
+{
+	return rte_zmalloc_socket("ACL_INCR_VIEW", sizeof(struct acl_incr_view) +
+		ACL_INCR_BITMAP_WORDS(incr->max_rules) * sizeof(uint64_t),
+		RTE_CACHE_LINE_SIZE, incr->socket_id);
+}
+
+/* Make the current tries visible to the classification. */
+static void
+acl_incr_publish(struct rte_acl_incr *incr, struct acl_incr_view *view)
+{
+	struct acl_incr_view *old;
+	uint32_t i, n;
+
+	n = 0;
+	for (i = 0; i != RTE_DIM(incr->trie); i++) {
+		if (incr->trie[i].main == NULL)
+			continue;
+		view->trie[n].main = incr->trie[i].main->ctx;
+		view->trie[n].patch = (incr->trie[i].patch == NULL) ? NULL :
+			incr->trie[i].patch->ctx;
+		n++;
+	}
+	view->num_tries = n;
+	memcpy(view->deleted, incr->deleted,
+		ACL_INCR_BITMAP_WORDS(incr->max_rules) * sizeof(uint64_t));
+
+	/*
+	 * The release store makes the view complete before it can be seen
+	 * by rte_acl_incr_classify(), which loads it with acquire order.
+	 * The old view may still be in use by the classifications started
+	 * before this store: it is retired, and only freed by
+	 * rte_acl_incr_reclaim() once these classifications are done.
+	 */
+	old = incr->view;
+	__atomic_store_n(&incr->view, view, __ATOMIC_RELEASE);
+
+	if (old != NULL) {
+		old->next = incr->retired_view;
+		incr->retired_view = old;
+	}
+}
+
+/* Get the live rules of a slot. */
+static uint32_t
+acl_incr_collect(const struct rte_acl_incr *incr, uint32_t t, uint32_t *ids)
+{
+	uint32_t i, n;
+
+	n = 0;
+	for (i = 0; i != incr->max_rules; i++) {
+		if (incr->meta[i].state == ACL_INCR_RULE_LIVE &&
+				incr->meta[i].trie == t)
+			ids[n++] = i;
+	}
+	return n;
+}
+
+/*
+ * Rebuild the main trie of a slot with its live rules only.
+ * Its deleted rules are retired and it no longer needs a patch.
+ */
+static int
+acl_incr_rebuild(struct rte_acl_incr *incr, uint32_t t)
+{
+	char name[RTE_ACL_NAMESIZE];
+	struct acl_incr_trie *trie;
+	struct acl_incr_ctx *ic;
+	uint32_t i, n;
+	int32_t rc;
+
+	trie = incr->trie + t;
+	n = acl_incr_collect(incr, t, incr->ids);
+	acl_incr_ctx_name(incr, name, sizeof(name));
+	rc = acl_incr_build(incr, name, incr->ids, n, &ic);
+	if (rc != 0)
+		return rc;
+
+	for (i = 0; i != incr->max_rules; i++) {
+		if (incr->meta[i].trie != t)
+			continue;
+		if (incr->meta[i].state == ACL_INCR_RULE_DELETED) {
+			incr->meta[i].state = ACL_INCR_RULE_RETIRED;
+			acl_incr_set_deleted(incr, i, 0);
+		}
+		incr->meta[i].in_patch = 0;
+	}
+
+	acl_incr_retire(incr, trie->main);
+	acl_incr_retire(incr, trie->patch);
+	trie->main = ic;
+	trie->patch = NULL;
+	trie->num_rules = n;
+	trie->num_deleted = 0;
+	trie->num_patch = 0;
+	return 0;
+}
+
+/*
+ * Mark a rule as deleted without rebuilding the main trie of its slot:
+ * the live rules overlapping it join the patch trie, which resolves the
+ * inputs matching it.
+ */
+static int
+acl_incr_tombstone(struct rte_acl_incr *incr, uint32_t idx)
+{
+	char name[RTE_ACL_NAMESIZE];
+	struct acl_incr_trie *trie;
+	struct acl_incr_ctx *ic;
+	uint32_t i, n, t;
+	int32_t rc;
+
+	t = incr->meta[idx].trie;
+	trie = incr->trie + t;
+
+	n = 0;
+	for (i = 0; i != incr->max_rules; i++) {
+		if (i == idx || incr->meta[i].state != ACL_INCR_RULE_LIVE ||
+				incr->meta[i].trie != t)
+			continue;
+		if (incr->meta[i].in_patch || acl_incr_overlap(incr, idx, i))
+			incr->ids[n++] = i;
+	}
+
+	acl_incr_ctx_name(incr, name, sizeof(name));
+	rc = acl_incr_build(incr, name, incr->ids, n, &ic);
+	if (rc != 0)
+		return rc;
+
+	for (i = 0; i != n; i++)
+		incr->meta[incr->ids[i]].in_patch = 1;
+	incr->meta[idx].state = ACL_INCR_RULE_DELETED;
+	incr->meta[idx].in_patch = 0;
+	acl_incr_set_deleted(incr, idx, 1);
+
+	acl_incr_retire(incr, trie->patch);
+	trie->patch = ic;
+	trie->num_patch = n;
+	trie->num_deleted++;
+	return 0;
+}
+
+/* Start a new delta trie in a free slot once the current one is full. */
+static void
+acl_incr_seal(struct rte_acl_incr *incr)
+{
+	uint32_t i;
+
+	if (incr->trie[incr->delta].num_rules < incr->delta_max)
+		return;
+
+	for (i = 0; i != RTE_DIM(incr->trie); i++) {
+		if (incr->trie[i].main == NULL &&
+				(incr->merging & (1 << i)) == 0) {
+			incr->delta = i;
+			return;
+		}
+	}
+}
+
+struct rte_acl_incr * __rte_experimental
+rte_acl_incr_create(const struct rte_acl_incr_param *param,
+	const struct rte_acl_config *cfg)
+{
+	struct rte_acl_incr *incr;
+	struct acl_incr_view *view;
+	size_t sz, bitmap_sz;
+
+	if (param == NULL || param->name == NULL || cfg == NULL ||
+			param->max_rule_num == 0 ||
+			cfg->num_categories == 0 ||
+			cfg->num_categories > RTE_ACL_MAX_CATEGORIES ||
+			cfg->num_fields == 0 ||
+			cfg->num_fields > RTE_ACL_MAX_FIELDS ||
+			param->rule_size < RTE_ACL_RULE_SZ(cfg->num_fields)) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	/* the deleted rules bitmap, then the rules and their metadata */
+	bitmap_sz = ACL_INCR_BITMAP_WORDS(param->max_rule_num) *
+		sizeof(uint64_t);
+	sz = sizeof(*incr) + bitmap_sz +
+		(size_t)param->max_rule_num * param->rule_size +
+		(size_t)param->max_rule_num * sizeof(incr->meta[0]) +
+		(size_t)param->max_rule_num * sizeof(incr->ids[0]);
+
+	incr = rte_zmalloc_socket("ACL_INCR", sz, RTE_CACHE_LINE_SIZE,
+		param->socket_id);
+	if (incr == NULL) {
+		RTE_LOG(ERR, ACL,
+			"allocation of %zu bytes on socket %d for %s failed\n",
+			sz, param->socket_id, param->name);
+		rte_errno = ENOMEM;
+		return NULL;
+	}
+
+	incr->deleted = (uint64_t *)(incr + 1);
+	incr->rules = (uint8_t *)incr->deleted + bitmap_sz;
+	incr->meta = (struct acl_incr_rule *)(incr->rules +
+		(size_t)param->max_rule_num * param->rule_size);
+	incr->ids = (uint32_t *)(incr->meta + param->max_rule_num);
+
+	snprintf(incr->name, sizeof(incr->name), "%s", param->name);
+	incr->socket_id = param->socket_id;
+	incr->rule_sz = param->rule_size;
+	incr->max_rules = param->max_rule_num;
+	incr->delta_max = (param->delta_rule_num == 0) ?
+		RTE_ACL_INCR_DELTA_RULE_NUM : param->delta_rule_num;
+	incr->id = rte_atomic32_add_return(&acl_incr_num, 1);
+	incr->cfg = *cfg;
+	rte_spinlock_init(&incr->lock);
+
+	view = acl_incr_view_alloc(incr);
+	if (view == NULL) {
+		rte_free(incr);
+		rte_errno = ENOMEM;
+		return NULL;
+	}
+	acl_incr_publish(incr, view);
+
+	return incr;
+}
+
+void __rte_experimental
+rte_acl_incr_free(struct rte_acl_incr *incr)
+{
+	uint32_t i;
+
+	if (incr == NULL)
+		return;
+
+	rte_acl_incr_reclaim(incr);
+	for (i = 0; i != RTE_DIM(incr->trie); i++) {
+		acl_incr_ctx_free(incr->trie[i].main);
+		acl_incr_ctx_free(incr->trie[i].patch);
+	}
+	rte_free(incr->view);
+	rte_free(incr);
+}
+
+int __rte_experimental
+rte_acl_incr_add_rules(struct rte_acl_incr *incr,
+	const struct rte_acl_rule *rules, uint32_t num, uint32_t *rule_ids)
+{
+	const struct rte_acl_rule *rv;
+	struct acl_incr_view *view;
+	struct acl_incr_rule *meta;
+	uint32_t i, idx, cat_mask;
+	int32_t rc;
+
+	if (incr == NULL || rules == NULL || rule_ids == NULL)
+		return -EINVAL;
+
+	cat_mask = RTE_LEN2MASK(incr->cfg.num_categories, uint32_t);
+	for (i = 0; i != num; i++) {
+		rv = (const struct rte_acl_rule *)
+			((uintptr_t)rules + i * incr->rule_sz);
+		if ((rv->data.category_mask & cat_mask) == 0 ||
+				rv->data.userdata == 0 ||
+				rv->data.priority > RTE_ACL_MAX_PRIORITY ||
+				rv->data.priority < RTE_ACL_MIN_PRIORITY) {
+			RTE_LOG(ERR, ACL, "%s(%s): rule #%u is invalid\n",
+				__func__, incr->name, i + 1);
+			return -EINVAL;
+		}
+	}
+
+	rte_spinlock_lock(&incr->lock);
+
+	if (num > incr->max_rules - incr->num_used) {
+		rte_spinlock_unlock(&incr->lock);
+		return -ENOMEM;
+	}
+
+	view = acl_incr_view_alloc(incr);
+	if (view == NULL) {
+		rte_spinlock_unlock(&incr->lock);
+		return -ENOMEM;
+	}
+
+	/* store the new rules in free slots, in the delta trie */
+	idx = incr->free_idx;
+	for (i = 0; i != num; i++) {
+		while (incr->meta[idx].state != ACL_INCR_RULE_FREE)
+			idx = (idx + 1) % incr->max_rules;
+
+		rv = (const struct rte_acl_rule *)
+			((uintptr_t)rules + i * incr->rule_sz);
+		memcpy(incr->rules + (size_t)idx * incr->rule_sz, rv,
+			incr->rule_sz);
+		meta = incr->meta + idx;
+		meta->priority = rv->data.priority;
+		meta->userdata = rv->data.userdata;
+		meta->category_mask = rv->data.category_mask;
+		meta->trie = incr->delta;
+		meta->state = ACL_INCR_RULE_LIVE;
+		meta->in_patch = 0;
+		meta->in_merge = 0;
+		rule_ids[i] = idx;
+	}
+
+	rc = acl_incr_rebuild(incr, incr->delta);
+	if (rc != 0) {
+		for (i = 0; i != num; i++)
+			incr->meta[rule_ids[i]].state = ACL_INCR_RULE_FREE;
+		rte_spinlock_unlock(&incr->lock);
+		rte_free(view);
+		return rc;
+	}
+
+	incr->free_idx = idx;
+	incr->num_rules += num;
+	incr->num_used += num;
+	acl_incr_seal(incr);
+	acl_incr_publish(incr, view);
+
+	rte_spinlock_unlock(&incr->lock);
+	return 0;
+}
+
+int __rte_experimental
+rte_acl_incr_del_rule(struct rte_acl_incr *incr, uint32_t rule_id)
+{
+	struct acl_incr_view *view;
+	struct acl_incr_rule *meta;
+	uint32_t t;
+	int32_t rc;
+
+	if (incr == NULL)
+		return -EINVAL;
+
+	rte_spinlock_lock(&incr->lock);
+
+	if (rule_id >= incr->max_rules ||
+			incr->meta[rule_id].state != ACL_INCR_RULE_LIVE) {
+		rte_spinlock_unlock(&incr->lock);
+		return -ENOENT;
+	}
+
+	view = acl_incr_view_alloc(incr);
+	if (view == NULL) {
+		rte_spinlock_unlock(&incr->lock);
+		return -ENOMEM;
+	}
+
+	meta = incr->meta + rule_id;
+	t = meta->trie;
+	if ((incr->merging & (1 << t)) == 0 &&
+			incr->trie[t].num_rules <= incr->delta_max) {
+		/* small trie, rebuild it without the rule */
+		meta->state = ACL_INCR_RULE_RETIRED;
+		rc = acl_incr_rebuild(incr, t);
+		if (rc != 0)
+			meta->state = ACL_INCR_RULE_LIVE;
+	} else
+		rc = acl_incr_tombstone(incr, rule_id);
+
+	if (rc != 0) {
+		rte_spinlock_unlock(&incr->lock);
+		rte_free(view);
+		return rc;
+	}
+
+	incr->num_rules--;
+	acl_incr_publish(incr, view);
+
+	rte_spinlock_unlock(&incr->lock);
+	return 0;
+}
+
+int __rte_experimental
+rte_acl_incr_merge(struct rte_acl_incr *incr)
+{
+	char name[RTE_ACL_NAMESIZE];
+	struct acl_incr_view *view;
+	struct acl_incr_ctx *ic, *patch;
+	struct acl_incr_rule *meta;
+	struct acl_incr_trie *trie;
+	uint32_t *ids;
+	uint32_t i, j, n, np, t, dst, mask, num_deleted;
+	int32_t rc;
+
+	if (incr == NULL)
+		return -EINVAL;
+
+	ids = rte_malloc_socket("ACL_INCR_MERGE",
+		incr->max_rules * sizeof(ids[0]), 0, incr->socket_id);
+	if (ids == NULL)
+		return -ENOMEM;
+
+	rte_spinlock_lock(&incr->lock);
+
+	if (incr->merging != 0) {
+		rte_spinlock_unlock(&incr->lock);
+		rte_free(ids);
+		return -EBUSY;
+	}
+
+	/* merge all the sealed tries, or compact the only one */
+	mask = 0;
+	num_deleted = 0;
+	for (t = 0; t != RTE_DIM(incr->trie); t++) {
+		if (t != incr->delta && incr->trie[t].main != NULL) {
+			mask |= 1 << t;
+			num_deleted += incr->trie[t].num_deleted;
+		}
+	}
+	if (mask == 0 || (__builtin_popcount(mask) == 1 && num_deleted == 0)) {
+		rte_spinlock_unlock(&incr->lock);
+		rte_free(ids);
+		return 0;
+	}
+
+	n = 0;
+	for (i = 0; i != incr->max_rules; i++) {
+		meta = incr->meta + i;
+		if (meta->state == ACL_INCR_RULE_LIVE &&
+				(mask & (1 << meta->trie)) != 0) {
+			meta->in_merge = 1;
+			ids[n++] = i;
+		}
+	}
+	incr->merging = mask;
+	acl_incr_ctx_name(incr, name, sizeof(name));
+
+	rte_spinlock_unlock(&incr->lock);
+
+	/* the rules being merged are not freed until the merge is over */
+	rc = acl_incr_build(incr, name, ids, n, &ic);
+
+	rte_spinlock_lock(&incr->lock);
+
+	view = NULL;
+	patch = NULL;
+	np = 0;
+	if (rc == 0) {
+		/* rules deleted during the build need a patch trie */
+		for (i = 0; i != n; i++) {
+			if (incr->meta[ids[i]].state != ACL_INCR_RULE_LIVE)
+				continue;
+			for (j = 0; j != n; j++) {
+				if (incr->meta[ids[j]].state ==
+						ACL_INCR_RULE_DELETED &&
+						acl_incr_overlap(incr,
+						ids[j], ids[i])) {
+					incr->ids[np++] = ids[i];
+					break;
+				}
+			}
+		}
+		acl_incr_ctx_name(incr, name, sizeof(name));
+		rc = acl_incr_build(incr, name, incr->ids, np, &patch);
+		if (rc == 0) {
+			view = acl_incr_view_alloc(incr);
+			if (view == NULL)
+				rc = -ENOMEM;
+		}
+		if (rc != 0) {
+			acl_incr_ctx_free(ic);
+			acl_incr_ctx_free(patch);
+		}
+	}
+
+	if (rc != 0) {
+		for (i = 0; i != n; i++)
+			incr->meta[ids[i]].in_merge = 0;
+		incr->merging = 0;
+		rte_spinlock_unlock(&incr->lock);
+		rte_free(ids);
+		return rc;
+	}
+
+	/* replace the merged tries with the new one */
+	dst = __builtin_ctz(mask);
+	for (t = 0; t != RTE_DIM(incr->trie); t++) {
+		if ((mask & (1 << t)) == 0)
+			continue;
+		trie = incr->trie + t;
+		acl_incr_retire(incr, trie->main);
+		acl_incr_retire(incr, trie->patch);
+		memset(trie, 0, sizeof(*trie));
+	}
+
+	trie = incr->trie + dst;
+	for (i = 0; i != incr->max_rules; i++) {
+		meta = incr->meta + i;
+		if ((mask & (1 << meta->trie)) == 0 ||
+				meta->state == ACL_INCR_RULE_FREE ||
+				meta->state == ACL_INCR_RULE_RETIRED)
+			continue;
+		meta->in_patch = 0;
+		if (meta->in_merge) {
+			meta->in_merge = 0;
+			meta->trie = dst;
+			if (meta->state == ACL_INCR_RULE_DELETED)
+				trie->num_deleted++;
+		} else {
+			/* deleted before the merge started */
+			meta->state = ACL_INCR_RULE_RETIRED;
+			acl_incr_set_deleted(incr, i, 0);
+		}
+	}
+	for (i = 0; i != np; i++)
+		incr->meta[incr->ids[i]].in_patch = 1;
+
+	trie->main = ic;
+	trie->patch = patch;
+	trie->num_rules = n;
+	trie->num_patch = np;
+	incr->merging = 0;
+	acl_incr_seal(incr);
+	acl_incr_publish(incr, view);
+
+	rte_spinlock_unlock(&incr->lock);
+	rte_free(ids);
+	return 0;
+}
+
+void __rte_experimental
+rte_acl_incr_reclaim(struct rte_acl_incr *incr)
+{
+	struct acl_incr_ctx *ic;
+	struct acl_incr_view *view;
+	uint32_t i;
+
+	if (incr == NULL)
+		return;
+
+	rte_spinlock_lock(&incr->lock);
+
+	while (incr->retired_ctx != NULL) {
+		ic = incr->retired_ctx;
+		incr->retired_ctx = ic->next;
+		acl_incr_ctx_free(ic);
+	}
+	while (incr->retired_view != NULL) {
+		view = incr->retired_view;
+		incr->retired_view = view->next;
+		rte_free(view);
+	}
+
+	for (i = 0; i != incr->max_rules; i++) {
+		if (incr->meta[i].state == ACL_INCR_RULE_RETIRED) {
+			incr->meta[i].state = ACL_INCR_RULE_FREE;
+			incr->num_used--;
+		}
+	}
+
+	rte_spinlock_unlock(&incr->lock);
+}
+
+/*
+ * Keep the result of a trie if it is a better match than the previous
+ * ones. Return 1 if it is a deleted rule, to be resolved by the patch.
+ */
+static inline int
+acl_incr_result(const struct rte_acl_incr *incr,
+	const struct acl_incr_view *view, uint32_t *best, uint32_t res)
+{
+	uint32_t idx;
+
+	if (res == 0)
+		return 0;
+
+	idx = res - 1;
+	if (acl_incr_is_deleted(view->deleted, idx))
+		return 1;
+
+	if (*best == 0 ||
+			incr->meta[idx].priority > incr->meta[*best - 1].priority)
+		*best = res;
+	return 0;
+}
+
+static int
+acl_incr_classify_burst(const struct rte_acl_incr *incr,
+	const struct acl_incr_view *view, const uint8_t **data,
+	uint32_t *results, uint32_t num, uint32_t categories)
+{
+	uint32_t res[ACL_INCR_BURST * RTE_ACL_MAX_CATEGORIES];
+	uint32_t best[ACL_INCR_BURST * RTE_ACL_MAX_CATEGORIES];
+	const uint8_t *pdata[ACL_INCR_BURST];
+	uint32_t pidx[ACL_INCR_BURST];
+	uint32_t c, i, j, k, t, np;
+	int32_t masked, rc;
+
+	memset(best, 0, num * categories * sizeof(best[0]));
+
+	for (t = 0; t != view->num_tries; t++) {
+		rc = rte_acl_classify(view->trie[t].main, data, res, num,
+			categories);
+		if (rc != 0)
+			return rc;
+
+		/* gather the inputs matching a deleted rule */
+		np = 0;
+		for (i = 0; i != num; i++) {
+			masked = 0;
+			for (c = 0; c != categories; c++) {
+				k = i * categories + c;
+				masked |= acl_incr_result(incr, view, best + k,
+					res[k]);
+			}
+			if (masked != 0) {
+				pdata[np] = data[i];
+				pidx[np++] = i;
+			}
+		}
+
+		if (np == 0 || view->trie[t].patch == NULL)
+			continue;
+
+		rc = rte_acl_classify(view->trie[t].patch, pdata, res, np,
+			categories);
+		if (rc != 0)
+			return rc;
+
+		for (j = 0; j != np; j++) {
+			for (c = 0; c != categories; c++)
+				acl_incr_result(incr, view,
+					best + pidx[j] * categories + c,
+					res[j * categories + c]);
+		}
+	}
+
+	for (k = 0; k != num * categories; k++)
+		results[k] = (best[k] == 0) ? 0 :
+			incr->meta[best[k] - 1].userdata;
+	return 0;
+}
+
+int __rte_experimental
+rte_acl_incr_classify(const struct rte_acl_incr *incr, const uint8_t **data,
+	uint32_t *results, uint32_t num, uint32_t categories)
+{
+	const struct acl_incr_view *view;
+	uint32_t i, n;
+	int32_t rc;
+
+	if (incr == NULL || data == NULL || results == NULL ||
+			categories == 0 || categories > RTE_ACL_MAX_CATEGORIES)
+		return -EINVAL;
+
+	/* the same view is used for the whole call */
+	view = __atomic_load_n(&incr->view, __ATOMIC_ACQUIRE);
+	for (i = 0; i < num; i += n) {
+		n = RTE_MIN(num - i, (uint32_t)ACL_INCR_BURST);
+		rc = acl_incr_classify_burst(incr, view, data + i,
+			results + i * categories, n, categories);
+		if (rc != 0)
+			return rc;
+	}
+	return 0;
+}
+
+void __rte_experimental
+rte_acl_incr_dump(struct rte_acl_incr *incr)
+{
+	const struct acl_incr_trie *trie;
+	uint32_t t;
+
+	if (incr == NULL)
+		return;
+
+	rte_spinlock_lock(&incr->lock);
+
+	printf("acl incremental context <%s>@%p\n", incr->name, incr);
+	printf("  socket_id=%"PRId32"\n", incr->socket_id);
+	printf("  max_rules=%"PRIu32"\n", incr->max_rules);
+	printf("  rule_size=%"PRIu32"\n", incr->rule_sz);
+	printf("  num_rules=%"PRIu32"\n", incr->num_rules);
+	printf("  delta_rules=%"PRIu32"\n", incr->delta_max);
+	printf("  merging=%#"PRIx32"\n", incr->merging);
+	for (t = 0; t != RTE_DIM(incr->trie); t++) {
+		trie = incr->trie + t;
+		if (trie->main == NULL)
+			continue;
+		printf("  trie %"PRIu32"%s: rules=%"PRIu32", deleted=%"PRIu32
+			", patch rules=%"PRIu32"\n", t,
+			(t == incr->delta) ? " (delta)" : "",
+			trie->num_rules, trie->num_deleted, trie->num_patch);
+	}
+
+	rte_spinlock_unlock(&incr->lock);
+}
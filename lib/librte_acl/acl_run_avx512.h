@@ -0,0 +1,269 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2018 Intel Corporation
+ */
+
+#include "acl_run_sse.h"
+
+/* number of flows processed by one pair of ZMM registers. */
+#define ZMM_FLOWS	(ZMM_SIZE / sizeof(uint32_t))
+
+static const rte_zmm_t zmm_match_mask = {
+	.u32 = {
+		RTE_ACL_NODE_MATCH, RTE_ACL_NODE_MATCH,
+		RTE_ACL_NODE_MATCH, RTE_ACL_NODE_MATCH,
+		RTE_ACL_NODE_MATCH, RTE_ACL_NODE_MATCH,
+		RTE_ACL_NODE_MATCH, RTE_ACL_NODE_MATCH,
+		RTE_ACL_NODE_MATCH, RTE_ACL_NODE_MATCH,
+		RTE_ACL_NODE_MATCH, RTE_ACL_NODE_MATCH,
+		RTE_ACL_NODE_MATCH, RTE_ACL_NODE_MATCH,
+		RTE_ACL_NODE_MATCH, RTE_ACL_NODE_MATCH,
+	},
+};
+
+static const rte_zmm_t zmm_index_mask = {
+	.u32 = {
+		RTE_ACL_NODE_INDEX, RTE_ACL_NODE_INDEX,
+		RTE_ACL_NODE_INDEX, RTE_ACL_NODE_INDEX,
+		RTE_ACL_NODE_INDEX, RTE_ACL_NODE_INDEX,
+		RTE_ACL_NODE_INDEX, RTE_ACL_NODE_INDEX,
+		RTE_ACL_NODE_INDEX, RTE_ACL_NODE_INDEX,
+		RTE_ACL_NODE_INDEX, RTE_ACL_NODE_INDEX,
+		RTE_ACL_NODE_INDEX, RTE_ACL_NODE_INDEX,
+		RTE_ACL_NODE_INDEX, RTE_ACL_NODE_INDEX,
+	},
+};
+
+static const rte_zmm_t zmm_shuffle_input = {
+	.u32 = {
+		0x00000000, 0x04040404, 0x08080808, 0x0c0c0c0c,
+		0x00000000, 0x04040404, 0x08080808, 0x0c0c0c0c,
+		0x00000000, 0x04040404, 0x08080808, 0x0c0c0c0c,
+		0x00000000, 0x04040404, 0x08080808, 0x0c0c0c0c,
+	},
+};
+
+static const rte_zmm_t zmm_ones_16 = {
+	.u16 = {
+		1, 1, 1, 1, 1, 1, 1, 1,
+		1, 1, 1, 1, 1, 1, 1, 1,
+		1, 1, 1, 1, 1, 1, 1, 1,
+		1, 1, 1, 1, 1, 1, 1, 1,
+	},
+};
+
+static const rte_zmm_t zmm_range_base = {
+	.u32 = {
+		0xffffff00, 0xffffff04, 0xffffff08, 0xffffff0c,
+		0xffffff00, 0xffffff04, 0xffffff08, 0xffffff0c,
+		0xffffff00, 0xffffff04, 0xffffff08, 0xffffff0c,
+		0xffffff00, 0xffffff04, 0xffffff08, 0xffffff0c,
+	},
+};
+
+/*
+ * Calculate the address of the next transition for 16 flows,
+ * same as ACL_TR_CALC_ADDR() does, but with mask registers instead
+ * of the byte blend and sign instructions missing in AVX512.
+ */
+static __rte_always_inline zmm_t
+calc_addr16(zmm_t next_input, zmm_t tr_lo, zmm_t tr_hi)
+{
+	zmm_t addr, in, node_type, r, t, dfa_ofs, quad_ofs;
+	__mmask16 dfa_msk;
+	__mmask64 gt_msk;
+
+	in = _mm512_shuffle_epi8(next_input, zmm_shuffle_input.z);
+
+	/* Calc node type and node addr */
+	node_type = _mm512_andnot_si512(zmm_index_mask.z, tr_lo);
+	addr = _mm512_and_si512(zmm_index_mask.z, tr_lo);
+
+	/* mask for DFA type(0) nodes */
+	dfa_msk = _mm512_testn_epi32_mask(node_type, node_type);
+
+	/* DFA calculations. */
+	r = _mm512_srli_epi32(in, 30);
+	r = _mm512_add_epi8(r, zmm_range_base.z);
+	t = _mm512_srli_epi32(in, 24);
+	r = _mm512_shuffle_epi8(tr_hi, r);
+
+	dfa_ofs = _mm512_sub_epi32(t, r);
+
+	/* QUAD/SINGLE calculations: count range boundaries below input. */
+	gt_msk = _mm512_cmpgt_epi8_mask(in, tr_hi);
+	t = _mm512_maskz_mov_epi8(gt_msk, _mm512_set1_epi8(1));
+	t = _mm512_maddubs_epi16(t, t);
+	quad_ofs = _mm512_madd_epi16(t, zmm_ones_16.z);
+
+	/* blend DFA and QUAD/SINGLE. */
+	t = _mm512_mask_mov_epi32(quad_ofs, dfa_msk, dfa_ofs);
+
+	/* calculate address for next transitions. */
+	return _mm512_add_epi32(addr, t);
+}
+
+/*
+ * Process 16 transitions in parallel.
+ * tr_lo contains low 32 bits for 16 transitions.
+ * tr_hi contains high 32 bits for 16 transitions.
+ * next_input contains up to 4 input bytes for 16 flows.
+ */
+static __rte_always_inline zmm_t
+transition16(zmm_t next_input, const uint64_t *trans, zmm_t *tr_lo,
+	zmm_t *tr_hi)
+{
+	const int32_t *tr;
+	zmm_t addr;
+
+	tr = (const int32_t *)(uintptr_t)trans;
+
+	/* Calculate the address (array index) for all 16 transitions. */
+	addr = calc_addr16(next_input, *tr_lo, *tr_hi);
+
+	/* load lower 32 bits of 16 transactions at once. */
+	*tr_lo = _mm512_i32gather_epi32(addr, tr, sizeof(trans[0]));
+
+	next_input = _mm512_srli_epi32(next_input, CHAR_BIT);
+
+	/* load high 32 bits of 16 transactions at once. */
+	*tr_hi = _mm512_i32gather_epi32(addr, tr + 1, sizeof(trans[0]));
+
+	return next_input;
+}
+
+/*
+ * Process the matches found in 16 flows, selected by msk,
+ * and put their next transitions back into tr_lo and tr_hi.
+ */
+static inline void
+acl_process_matches_avx512x16(const struct rte_acl_ctx *ctx,
+	struct parms *parms, struct acl_flow_data *flows, uint32_t slot,
+	__mmask16 msk, zmm_t *tr_lo, zmm_t *tr_hi)
+{
+	uint32_t i, m;
+	uint64_t tr;
+	uint32_t lo[ZMM_FLOWS], hi[ZMM_FLOWS];
+
+	_mm512_storeu_si512(lo, *tr_lo);
+	_mm512_storeu_si512(hi, *tr_hi);
+
+	for (m = msk; m != 0; m &= m - 1) {
+		i = __builtin_ctz(m);
+		tr = (uint64_t)hi[i] << 32 | lo[i];
+		tr = acl_match_check(tr, slot + i, ctx, parms, flows,
+			resolve_priority_sse);
+		lo[i] = (uint32_t)tr;
+		hi[i] = (uint32_t)(tr >> 32);
+	}
+
+	/* Keep transitions with NOMATCH intact. */
+	*tr_lo = _mm512_mask_loadu_epi32(*tr_lo, msk, lo);
+	*tr_hi = _mm512_mask_loadu_epi32(*tr_hi, msk, hi);
+}
+
+static inline void
+acl_match_check_avx512x16(const struct rte_acl_ctx *ctx, struct parms *parms,
+	struct acl_flow_data *flows, uint32_t slot,
+	zmm_t *tr_lo, zmm_t *tr_hi)
+{
+	__mmask16 msk;
+
+	/* test for match node */
+	msk = _mm512_test_epi32_mask(*tr_lo, zmm_match_mask.z);
+
+	while (msk != 0) {
+		acl_process_matches_avx512x16(ctx, parms, flows, slot, msk,
+			tr_lo, tr_hi);
+		msk = _mm512_test_epi32_mask(*tr_lo, zmm_match_mask.z);
+	}
+}
+
+/*
+ * Gather 4 bytes of input data for 16 flows.
+ */
+static __rte_always_inline zmm_t
+get_next_4bytes_avx512x16(struct parms *parms, uint32_t slot)
+{
+	uint32_t i;
+	int32_t in[ZMM_FLOWS];
+
+	for (i = 0; i != RTE_DIM(in); i++)
+		in[i] = GET_NEXT_4BYTES(parms, slot + i);
+
+	return _mm512_loadu_si512(in);
+}
+
+/*
+ * Execute trie traversal for num * 16 flows in parallel,
+ * with num pairs of ZMM registers interleaved to hide gather latency.
+ */
+static __rte_always_inline int
+search_avx512xn(const struct rte_acl_ctx *ctx, const uint8_t **data,
+	uint32_t *results, uint32_t total_packets, uint32_t categories,
+	uint32_t num)
+{
+	uint32_t i, n;
+	struct acl_flow_data flows;
+	uint32_t lo[MAX_SEARCHES_AVX32], hi[MAX_SEARCHES_AVX32];
+	struct completion cmplt[MAX_SEARCHES_AVX32];
+	struct parms parms[MAX_SEARCHES_AVX32];
+	zmm_t input[MAX_SEARCHES_AVX32 / ZMM_FLOWS];
+	zmm_t tr_lo[MAX_SEARCHES_AVX32 / ZMM_FLOWS];
+	zmm_t tr_hi[MAX_SEARCHES_AVX32 / ZMM_FLOWS];
+	uint64_t tr;
+
+	acl_set_flow(&flows, cmplt, num * ZMM_FLOWS, data, results,
+		total_packets, categories, ctx->trans_table);
+
+	for (n = 0; n != num * ZMM_FLOWS; n++) {
+		cmplt[n].count = 0;
+		tr = acl_start_next_trie(&flows, parms, n, ctx);
+		lo[n] = (uint32_t)tr;
+		hi[n] = (uint32_t)(tr >> 32);
+	}
+
+	for (i = 0; i != num; i++) {
+		tr_lo[i] = _mm512_loadu_si512(lo + i * ZMM_FLOWS);
+		tr_hi[i] = _mm512_loadu_si512(hi + i * ZMM_FLOWS);
+
+		/* Check for any matches. */
+		acl_match_check_avx512x16(ctx, parms, &flows, i * ZMM_FLOWS,
+			tr_lo + i, tr_hi + i);
+	}
+
+	while (flows.started > 0) {
+
+		for (i = 0; i != num; i++)
+			input[i] = get_next_4bytes_avx512x16(parms,
+				i * ZMM_FLOWS);
+
+		for (n = 0; n != sizeof(uint32_t); n++) {
+			for (i = 0; i != num; i++)
+				input[i] = transition16(input[i], flows.trans,
+					tr_lo + i, tr_hi + i);
+		}
+
+		/* Check for any matches. */
+		for (i = 0; i != num; i++)
+			acl_match_check_avx512x16(ctx, parms, &flows,
+				i * ZMM_FLOWS, tr_lo + i, tr_hi + i);
+	}
+
+	return 0;
+}
+
+static inline int
+search_avx512x16(const struct rte_acl_ctx *ctx, const uint8_t **data,
+	uint32_t *results, uint32_t total_packets, uint32_t categories)
+{
+	return search_avx512xn(ctx, data, results, total_packets, categories,
+		MAX_SEARCHES_AVX16 / ZMM_FLOWS);
+}
+
+static inline int
+search_avx512x32(const struct rte_acl_ctx *ctx, const uint8_t **data,
+	uint32_t *results, uint32_t total_packets, uint32_t categories)
+{
+	return search_avx512xn(ctx, data, results, total_packets, categories,
+		MAX_SEARCHES_AVX32 / ZMM_FLOWS);
+}
@@ -11,6 +11,7 @@
  * RTE Classifier.
  */
 
+#include <rte_compat.h>
 #include <rte_acl_osdep.h>
 
 #ifdef __cplusplus
@@ -24,6 +25,9 @@ extern "C" {
 #define RTE_ACL_MAX_LEVELS 64
 #define RTE_ACL_MAX_FIELDS 64
 
+/** MAX number of tries per one ACL context.*/
+#define RTE_ACL_MAX_TRIES	8
+
 union rte_acl_field_types {
 	uint8_t  u8;
 	uint16_t u16;
@@ -220,6 +224,97 @@ rte_acl_reset_rules(struct rte_acl_ctx *ctx);
 int
 rte_acl_build(struct rte_acl_ctx *ctx, const struct rte_acl_config *cfg);
 
+/**
+ * Group the rules by the fields they leave wild before splitting them
+ * into tries, so that each trie skips the fields wild in all its rules.
+ */
+#define RTE_ACL_BUILD_F_GROUP_WILDCARD	0x1
+
+/**
+ * Parameters of a budgeted build.
+ */
+struct rte_acl_build_param {
+	uint32_t max_tries;
+	/**<
+	 * Max number of tries, each one being traversed once per lookup.
+	 * Zero for RTE_ACL_MAX_TRIES.
+	 */
+	uint32_t flags; /**< RTE_ACL_BUILD_F_* flags. */
+};
+
+/**
+ * Build results of one trie.
+ */
+struct rte_acl_trie_report {
+	uint32_t num_rules;       /**< Number of rules in the trie. */
+	uint32_t num_fields;      /**< Number of fields looked up. */
+	uint64_t wild_fields;
+	/**< Bit n set if the field of index n is wild in all the rules. */
+	uint32_t num_transitions; /**< Transitions per lookup, one per byte. */
+	uint32_t num_nodes;       /**< Number of run-time nodes. */
+	size_t mem_sz;            /**< Size of the run-time nodes. */
+	uint32_t split_rule;
+	/**<
+	 * Userdata of the rule that made the trie exceed its node limit,
+	 * the first rule of the next trie. Zero if the trie was not split.
+	 */
+};
+
+/**
+ * Build results of an ACL context, for the last build attempt.
+ */
+struct rte_acl_build_report {
+	uint32_t num_builds;      /**< Number of build attempts. */
+	uint32_t num_rules;       /**< Number of rules built. */
+	uint32_t num_tries;       /**< Number of tries. */
+	uint32_t node_max;        /**< Node limit above which a trie is split. */
+	uint32_t num_transitions; /**< Transitions per lookup, all tries. */
+	uint32_t fail_rule;
+	/**<
+	 * Userdata of the first rule that did not fit in max_tries tries,
+	 * zero if they all fit.
+	 */
+	size_t mem_sz;            /**< Size of the run-time structures. */
+	struct rte_acl_trie_report trie[RTE_ACL_MAX_TRIES];
+	/**< Build results of each trie. */
+};
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Analyze set of rules and build required internal run-time structures,
+ * within a memory budget and a number of tries.
+ * Large rule sets with many wild fields can make a trie explode, which
+ * is avoided by splitting the rules into more tries, at the cost of one
+ * more traversal per lookup. This build shrinks the tries while they
+ * exceed the cfg->max_size memory budget, and grows them while the rules
+ * don't fit into param->max_tries tries, optionally grouping the rules by
+ * their wild fields, and reports what it built, or why it failed.
+ * This function is not multi-thread safe.
+ *
+ * @param ctx
+ *   ACL context to build.
+ * @param cfg
+ *   Pointer to struct rte_acl_config - defines build parameters.
+ *   Its max_size is the memory budget, zero for none.
+ * @param param
+ *   Pointer to struct rte_acl_build_param - defines the trie limits.
+ * @param report
+ *   Pointer to the build report to fill, can be NULL.
+ * @return
+ *   - -ERANGE if the rules could not fit in the memory budget.
+ *   - -ENOMEM if the rules could not fit in max_tries tries, or
+ *     couldn't allocate enough memory.
+ *   - -EINVAL if the parameters are invalid.
+ *   - Negative error code if operation failed.
+ *   - Zero if operation completed successfully.
+ */
+int __rte_experimental
+rte_acl_build_budget(struct rte_acl_ctx *ctx, const struct rte_acl_config *cfg,
+	const struct rte_acl_build_param *param,
+	struct rte_acl_build_report *report);
+
 /**
  * Delete all rules from the ACL context and
  * destroy all internal run-time structures.
@@ -241,6 +336,10 @@ enum rte_acl_classify_alg {
 	RTE_ACL_CLASSIFY_AVX2 = 3,    /**< requires AVX2 support. */
 	RTE_ACL_CLASSIFY_NEON = 4,    /**< requires NEON support. */
 	RTE_ACL_CLASSIFY_ALTIVEC = 5,    /**< requires ALTIVEC support. */
+	RTE_ACL_CLASSIFY_AVX512X16 = 6,
+	/**< requires AVX512F and AVX512BW support, 16 flows in parallel. */
+	RTE_ACL_CLASSIFY_AVX512X32 = 7,
+	/**< requires AVX512F and AVX512BW support, 32 flows in parallel. */
 	RTE_ACL_CLASSIFY_NUM          /* should always be the last one. */
 };
 
@@ -0,0 +1,203 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2018 Intel Corporation
+ */
+
+#ifndef _RTE_ACL_INCR_H_
+#define _RTE_ACL_INCR_H_
+
+/**
+ * @file
+ *
+ * RTE ACL incremental classifier.
+ *
+ * An incremental ACL keeps its rules in a few ACL tries instead of one,
+ * so that a rule can be added or deleted without rebuilding all of them:
+ *  - new rules go to a small delta trie, rebuilt on each addition and
+ *    sealed once it holds delta_rule_num rules;
+ *  - a rule deleted from a small trie causes that trie to be rebuilt;
+ *  - a rule deleted from a large trie is only marked as deleted, and the
+ *    rules of that trie overlapping it are built into a small patch trie,
+ *    used for the inputs whose best match is a deleted rule.
+ * rte_acl_incr_merge() rebuilds the sealed tries into a single one, from
+ * a control thread, while additions and deletions go on.
+ *
+ * Each update builds new tries on the side and then publishes them at
+ * once, so that a concurrent classification sees either the rules before
+ * or after the update. A classification reads the published tries once,
+ * when it starts, and uses them until it returns. So the tries replaced
+ * by an update can only be freed, by rte_acl_incr_reclaim(), when all
+ * the classifications started before the update have returned, e.g.
+ * once every classifying lcore has gone through a quiescent state.
+ *
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ */
+
+#include <rte_compat.h>
+#include <rte_acl.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Max number of tries of an incremental ACL, the delta one included. */
+#define RTE_ACL_INCR_MAX_TRIES	8
+
+/** Default number of rules above which the delta trie is sealed. */
+#define RTE_ACL_INCR_DELTA_RULE_NUM	1024
+
+struct rte_acl_incr;
+
+/**
+ * Parameters used when creating an incremental ACL.
+ */
+struct rte_acl_incr_param {
+	const char *name;         /**< Name of the incremental ACL. */
+	int         socket_id;    /**< Socket ID to allocate memory for. */
+	uint32_t    rule_size;    /**< Size of each rule. */
+	uint32_t    max_rule_num; /**< Maximum number of rules. */
+	uint32_t    delta_rule_num;
+	/**<
+	 * Number of rules above which the delta trie is sealed, and below
+	 * which a trie is rebuilt on deletion. It bounds the update latency.
+	 * Zero for RTE_ACL_INCR_DELTA_RULE_NUM.
+	 */
+};
+
+/**
+ * Create an incremental ACL.
+ *
+ * @param param
+ *   Parameters used to create the incremental ACL.
+ * @param cfg
+ *   Build configuration of all the tries: fields and number of categories.
+ * @return
+ *   Pointer to the incremental ACL, or NULL on error, with error code set
+ *   in rte_errno. Possible rte_errno errors include:
+ *   - EINVAL - invalid parameter passed to function
+ *   - ENOMEM - no appropriate memory area found
+ */
+struct rte_acl_incr * __rte_experimental
+rte_acl_incr_create(const struct rte_acl_incr_param *param,
+	const struct rte_acl_config *cfg);
+
+/**
+ * De-allocate all memory used by an incremental ACL.
+ * No classification may be running on it.
+ *
+ * @param incr
+ *   Incremental ACL to free.
+ */
+void __rte_experimental
+rte_acl_incr_free(struct rte_acl_incr *incr);
+
+/**
+ * Add rules to an incremental ACL, and make them visible to
+ * classification at once. The rules are built into the delta trie,
+ * so that adding many rules in one call is cheaper than one by one.
+ * This function is multi-thread safe with the other updates.
+ *
+ * @param incr
+ *   Incremental ACL to add rules to.
+ * @param rules
+ *   Array of rules to add, in the format of rte_acl_add_rules().
+ *   The userdata of a rule is the value returned when it matches.
+ * @param num
+ *   Number of elements in the input array of rules.
+ * @param rule_ids
+ *   Output array of num identifiers of the added rules, used to delete them.
+ * @return
+ *   - -ENOMEM if there is no space for these rules or to build them.
+ *   - -EINVAL if the parameters are invalid.
+ *   - Zero if operation completed successfully.
+ */
+int __rte_experimental
+rte_acl_incr_add_rules(struct rte_acl_incr *incr,
+	const struct rte_acl_rule *rules, uint32_t num, uint32_t *rule_ids);
+
+/**
+ * Delete a rule from an incremental ACL.
+ * This function is multi-thread safe with the other updates.
+ *
+ * @param incr
+ *   Incremental ACL to delete the rule from.
+ * @param rule_id
+ *   Identifier of the rule, as returned by rte_acl_incr_add_rules().
+ * @return
+ *   - -ENOENT if there is no such rule.
+ *   - -ENOMEM if there is no memory to rebuild the tries.
+ *   - -EINVAL if the parameters are invalid.
+ *   - Zero if operation completed successfully.
+ */
+int __rte_experimental
+rte_acl_incr_del_rule(struct rte_acl_incr *incr, uint32_t rule_id);
+
+/**
+ * Merge the sealed tries into one, dropping their deleted rules.
+ * It costs a full build of these rules and is meant to be called
+ * from a control thread, in the background of additions and deletions.
+ * This function is multi-thread safe with the other updates.
+ *
+ * @param incr
+ *   Incremental ACL to merge.
+ * @return
+ *   - -EBUSY if a merge is already in progress.
+ *   - -ENOMEM if there is no memory to build the merged trie.
+ *   - -EINVAL if the parameters are invalid.
+ *   - Zero if operation completed successfully, or nothing was to merge.
+ */
+int __rte_experimental
+rte_acl_incr_merge(struct rte_acl_incr *incr);
+
+/**
+ * Release the tries and rule identifiers no longer in use since the
+ * previous updates. It must only be called once all the classifications
+ * started before the last update have returned.
+ * This function is multi-thread safe with the other updates.
+ *
+ * @param incr
+ *   Incremental ACL to reclaim memory from.
+ */
+void __rte_experimental
+rte_acl_incr_reclaim(struct rte_acl_incr *incr);
+
+/**
+ * Perform search for a matching rule for each input data buffer,
+ * as rte_acl_classify() does, in all the tries of an incremental ACL.
+ * This function can run concurrently with the updates: it uses the
+ * tries published when it starts, which rte_acl_incr_reclaim() must not
+ * release until it returns.
+ *
+ * @param incr
+ *   Incremental ACL to search with.
+ * @param data
+ *   Array of pointers to input data buffers to perform search.
+ * @param results
+ *   Array of search results, *categories* results per each input data buffer.
+ * @param num
+ *   Number of elements in the input data buffers array.
+ * @param categories
+ *   Number of maximum possible matches for each input buffer, one possible
+ *   match per category, with the same constraints as for rte_acl_classify().
+ * @return
+ *   zero on successful completion.
+ *   -EINVAL for incorrect arguments.
+ */
+int __rte_experimental
+rte_acl_incr_classify(const struct rte_acl_incr *incr, const uint8_t **data,
+	uint32_t *results, uint32_t num, uint32_t categories);
+
+/**
+ * Dump an incremental ACL and its tries to the console.
+ *
+ * @param incr
+ *   Incremental ACL to dump.
+ */
+void __rte_experimental
+rte_acl_incr_dump(struct rte_acl_incr *incr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_ACL_INCR_H_ */
@@ -46,6 +46,7 @@
 
 #include <stdint.h>
 #include <rte_common.h>
+#include <rte_compat.h>
 #include <rte_atomic.h>
 
 /*------------------------- 64 bit atomic operations -------------------------*/
@@ -208,4 +209,63 @@ static inline void rte_atomic64_clear(rte_atomic64_t *v)
 }
 #endif
 
+/*------------------------ 128 bit atomic operations -------------------------*/
+
+/**
+ * 128-bit integer structure.
+ */
+RTE_STD_C11
+typedef struct {
+	RTE_STD_C11
+	union {
+		uint64_t val[2];
+		__extension__ __int128 int128;
+	};
+} __rte_aligned(16) rte_int128_t;
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * 128-bit atomic compare and exchange.
+ *
+ * If *dst == *exp, *src is written to *dst. Otherwise, the current value
+ * of *dst is written to *exp, so that a caller looping on a failed
+ * exchange doesn't need to read *dst again.
+ * This is a full memory barrier, as all the other x86 atomic operations.
+ *
+ * @param dst
+ *   The destination into which the value will be written, 16 bytes aligned.
+ * @param exp
+ *   Pointer to the expected value. Updated with the current value of *dst
+ *   if the exchange fails.
+ * @param src
+ *   Pointer to the new value.
+ * @return
+ *   Non-zero on success; 0 on failure.
+ */
+static inline int __rte_experimental
+rte_atomic128_cmp_exchange(rte_int128_t *dst, rte_int128_t *exp,
+	const rte_int128_t *src)
+{
+	uint8_t res;
+
+	asm volatile (
+			MPLOCKED
+			"cmpxchg16b %[dst];"
+			" sete %[res]"
+			: [dst] "=m" (dst->val[0]),
+			  "=a" (exp->val[0]),
+			  "=d" (exp->val[1]),
+			  [res] "=r" (res)
+			: "b" (src->val[0]),
+			  "c" (src->val[1]),
+			  "a" (exp->val[0]),
+			  "d" (exp->val[1]),
+			  "m" (dst->val[0])
+			: "memory");
+
+	return res;
+}
+
 #endif /* _RTE_ATOMIC_X86_64_H_ */
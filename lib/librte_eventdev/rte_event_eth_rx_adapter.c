@@ -2,6 +2,11 @@
  * Copyright(c) 2017 Intel Corporation.
  * All rights reserved.
  */
+#if defined(RTE_EXEC_ENV_LINUXAPP)
+#include <sys/epoll.h>
+#endif
+#include <unistd.h>
+
 #include <rte_cycles.h>
 #include <rte_common.h>
 #include <rte_dev.h>
@@ -9,6 +14,8 @@
 #include <rte_ethdev.h>
 #include <rte_log.h>
 #include <rte_malloc.h>
+#include <rte_interrupts.h>
+#include <rte_ring.h>
 #include <rte_service_component.h>
 #include <rte_thash.h>
 
@@ -25,6 +32,11 @@
 
 #define RSS_KEY_SIZE	40
 
+/* Empty polls after which an interrupt mode Rx queue is rearmed */
+#define INTR_IDLE_POLL_THRESHOLD	16
+/* Max epoll events processed per wakeup of the interrupt thread */
+#define INTR_EPOLL_MAX_EVENTS		BATCH_SIZE
+
 /*
  * There is an instance of this struct per polled Rx queue added to the
  * adapter
@@ -93,6 +105,22 @@ struct rte_event_eth_rx_adapter {
 	uint32_t service_id;
 	/* Adapter started flag */
 	uint8_t rxa_started;
+	/* Count of interrupt mode Rx queues */
+	uint32_t num_rx_intr;
+	/* Interrupt mode Rx queues that are currently being polled */
+	struct eth_rx_poll_entry *intr_poll;
+	/* Size of the intr_poll array */
+	uint16_t num_intr_poll;
+	/* Rx queues signalled by the interrupt thread */
+	struct rte_ring *intr_ring;
+	/* Lock to serialize interrupt arming with the interrupt thread */
+	rte_spinlock_t intr_ring_lock;
+	/* epoll fd the interrupt thread waits on */
+	int epd;
+	/* Thread that waits for Rx queue interrupts */
+	pthread_t rx_intr_thread;
+	/* Interrupt thread initialization state */
+	uint8_t intr_inited;
 } __rte_cache_aligned;
 
 /* Per eth device */
@@ -119,11 +147,12 @@ struct eth_device_info {
 struct eth_rx_queue_info {
 	int queue_enabled;	/* True if added */
 	uint16_t wt;		/* Polling weight */
-	uint8_t event_queue_id;	/* Event queue to enqueue packets to */
-	uint8_t sched_type;	/* Sched type for events */
-	uint8_t priority;	/* Event priority */
-	uint32_t flow_id;	/* App provided flow identifier */
+	uint8_t intr_mode;	/* True if the queue is interrupt driven */
+	uint8_t intr_enabled;	/* True if the queue interrupt is armed */
+	uint8_t intr_polling;	/* True if the queue is in intr_poll[] */
+	uint16_t intr_idle;	/* Consecutive empty polls in intr_poll[] */
 	uint32_t flow_id_mask;	/* Set to ~0 if app provides flow id else 0 */
+	uint64_t event;		/* Event word for packets from this queue */
 };
 
 static struct rte_event_eth_rx_adapter **event_eth_rx_adapter;
@@ -144,7 +173,7 @@ valid_id(uint8_t id)
 static inline int
 sw_rx_adapter_queue_count(struct rte_event_eth_rx_adapter *rx_adapter)
 {
-	return rx_adapter->num_rx_polled;
+	return rx_adapter->num_rx_polled + rx_adapter->num_rx_intr;
 }
 
 /* Greatest common divisor */
@@ -231,7 +260,8 @@ eth_poll_wrr_calc(struct rte_event_eth_rx_adapter *rx_adapter)
 			for (q = 0; q < nb_rx_queues; q++) {
 				struct eth_rx_queue_info *queue_info =
 					&dev_info->rx_queue[q];
-				if (queue_info->queue_enabled == 0)
+				if (queue_info->queue_enabled == 0 ||
+					queue_info->intr_mode)
 					continue;
 
 				uint16_t wt = queue_info->wt;
@@ -380,18 +410,6 @@ rx_enq_block_end_ts(struct rte_event_eth_rx_adapter *rx_adapter,
 	}
 }
 
-/* Add event to buffer, free space check is done prior to calling
- * this function
- */
-static inline void
-buf_event_enqueue(struct rte_event_eth_rx_adapter *rx_adapter,
-		  struct rte_event *ev)
-{
-	struct rte_eth_event_enqueue_buffer *buf =
-	    &rx_adapter->event_enqueue_buffer;
-	rte_memcpy(&buf->events[buf->count++], ev, sizeof(struct rte_event));
-}
-
 /* Enqueue buffered events to event device */
 static inline uint16_t
 flush_event_buffer(struct rte_event_eth_rx_adapter *rx_adapter)
@@ -420,6 +438,14 @@ flush_event_buffer(struct rte_event_eth_rx_adapter *rx_adapter)
 	return n;
 }
 
+/* Add events for the mbufs to the event buffer, free space check is done
+ * prior to calling this function
+ *
+ * The event word common to all packets from the Rx queue is precomputed when
+ * the queue is added, so each event is built with two 64 bit stores (plus
+ * the flow identifier when it is derived from the RSS hash) directly in the
+ * enqueue buffer.
+ */
 static inline void
 fill_event_buffer(struct rte_event_eth_rx_adapter *rx_adapter,
 	uint16_t eth_dev_id,
@@ -432,22 +458,13 @@ fill_event_buffer(struct rte_event_eth_rx_adapter *rx_adapter,
 					&rx_adapter->eth_devices[eth_dev_id];
 	struct eth_rx_queue_info *eth_rx_queue_info =
 					&eth_device_info->rx_queue[rx_queue_id];
-
-	int32_t qid = eth_rx_queue_info->event_queue_id;
-	uint8_t sched_type = eth_rx_queue_info->sched_type;
-	uint8_t priority = eth_rx_queue_info->priority;
-	uint32_t flow_id;
-	struct rte_event events[BATCH_SIZE];
+	struct rte_eth_event_enqueue_buffer *buf =
+					&rx_adapter->event_enqueue_buffer;
+	struct rte_event *ev = &buf->events[buf->count];
+	uint64_t event = eth_rx_queue_info->event;
 	struct rte_mbuf *m = mbufs[0];
-	uint32_t rss_mask;
-	uint32_t rss;
-	int do_rss;
 	uint64_t ts;
 
-	/* 0xffff ffff if PKT_RX_RSS_HASH is set, otherwise 0 */
-	rss_mask = ~(((m->ol_flags & PKT_RX_RSS_HASH) != 0) - 1);
-	do_rss = !rss_mask && !eth_rx_queue_info->flow_id_mask;
-
 	if ((m->ol_flags & PKT_RX_TIMESTAMP) == 0) {
 		ts = rte_get_tsc_cycles();
 		for (i = 0; i < num; i++) {
@@ -458,27 +475,28 @@ fill_event_buffer(struct rte_event_eth_rx_adapter *rx_adapter,
 		}
 	}
 
-	for (i = 0; i < num; i++) {
-		m = mbufs[i];
-		struct rte_event *ev = &events[i];
-
-		rss = do_rss ?
-			do_softrss(m, rx_adapter->rss_key_be) : m->hash.rss;
-		flow_id =
-		    eth_rx_queue_info->flow_id &
-				eth_rx_queue_info->flow_id_mask;
-		flow_id |= rss & ~eth_rx_queue_info->flow_id_mask;
-		ev->flow_id = flow_id;
-		ev->op = RTE_EVENT_OP_NEW;
-		ev->sched_type = sched_type;
-		ev->queue_id = qid;
-		ev->event_type = RTE_EVENT_TYPE_ETH_RX_ADAPTER;
-		ev->sub_event_type = 0;
-		ev->priority = priority;
-		ev->mbuf = m;
-
-		buf_event_enqueue(rx_adapter, ev);
+	if (eth_rx_queue_info->flow_id_mask) {
+		/* App provided flow id is part of the event word */
+		for (i = 0; i < num; i++) {
+			ev[i].event = event;
+			ev[i].mbuf = mbufs[i];
+		}
+	} else if (mbufs[0]->ol_flags & PKT_RX_RSS_HASH) {
+		for (i = 0; i < num; i++) {
+			ev[i].event = event;
+			ev[i].flow_id = mbufs[i]->hash.rss;
+			ev[i].mbuf = mbufs[i];
+		}
+	} else {
+		for (i = 0; i < num; i++) {
+			ev[i].event = event;
+			ev[i].flow_id = do_softrss(mbufs[i],
+						rx_adapter->rss_key_be);
+			ev[i].mbuf = mbufs[i];
+		}
 	}
+
+	buf->count += num;
 }
 
 /*
@@ -486,7 +504,8 @@ fill_event_buffer(struct rte_event_eth_rx_adapter *rx_adapter,
  * packets to the event device.
  *
  * The receive code enqueues initially to a temporary buffer, the
- * temporary buffer is drained anytime it holds >= BATCH_SIZE packets
+ * temporary buffer is drained anytime it holds >= BATCH_SIZE packets and at
+ * the end of the polling sequence
  *
  * If there isn't space available in the temporary buffer, packets from the
  * Rx queue aren't dequeued from the eth device, this back pressures the
@@ -547,10 +566,197 @@ eth_rx_poll(struct rte_event_eth_rx_adapter *rx_adapter)
 			wrr_pos = 0;
 	}
 
-	if (buf->count >= BATCH_SIZE)
+	/* Flush partial batches too, so that packets aren't held back in
+	 * the enqueue buffer when the packet rate is low
+	 */
+	if (buf->count)
 		flush_event_buffer(rx_adapter);
 }
 
+/* Encode the ethernet port and Rx queue as epoll and interrupt ring data */
+static inline void *
+eth_rx_intr_data(uint16_t eth_dev_id, uint16_t rx_queue_id)
+{
+	return (void *)(uintptr_t)((uint32_t)eth_dev_id << 16 | rx_queue_id);
+}
+
+static inline void
+eth_rx_intr_data_decode(void *data, uint16_t *eth_dev_id,
+			uint16_t *rx_queue_id)
+{
+	uint32_t v = (uint32_t)(uintptr_t)data;
+
+	*eth_dev_id = v >> 16;
+	*rx_queue_id = v & 0xffff;
+}
+
+/*
+ * Invoked by the interrupt thread for an Rx queue interrupt. The interrupt is
+ * disabled and the queue is handed over to the service function, which polls
+ * the queue until it is idle and then rearms the interrupt.
+ */
+static void
+eth_rx_intr_ring_enqueue(struct rte_event_eth_rx_adapter *rx_adapter,
+			void *data)
+{
+	struct eth_device_info *dev_info;
+	struct eth_rx_queue_info *queue_info;
+	uint16_t eth_dev_id;
+	uint16_t rx_queue_id;
+	int err;
+
+	eth_rx_intr_data_decode(data, &eth_dev_id, &rx_queue_id);
+	dev_info = &rx_adapter->eth_devices[eth_dev_id];
+
+	rte_spinlock_lock(&rx_adapter->intr_ring_lock);
+	if (dev_info->rx_queue == NULL)
+		goto unlock;
+
+	queue_info = &dev_info->rx_queue[rx_queue_id];
+	if (!queue_info->intr_enabled)
+		goto unlock;
+
+	/* The ring is larger than the number of interrupt mode queues and
+	 * a queue is enqueued only while its interrupt is armed
+	 */
+	err = rte_ring_sp_enqueue(rx_adapter->intr_ring, data);
+	if (err) {
+		RTE_EDEV_LOG_ERR("Failed to enqueue interrupt to ring"
+			" err = %d eth port %" PRIu16 " queue %" PRIu16,
+			err, eth_dev_id, rx_queue_id);
+		goto unlock;
+	}
+
+	queue_info->intr_enabled = 0;
+	rte_eth_dev_rx_intr_disable(eth_dev_id, rx_queue_id);
+
+unlock:
+	rte_spinlock_unlock(&rx_adapter->intr_ring_lock);
+}
+
+static void *
+eth_rx_intr_thread(void *arg)
+{
+	struct rte_event_eth_rx_adapter *rx_adapter = arg;
+	struct rte_epoll_event epoll_events[INTR_EPOLL_MAX_EVENTS];
+	int n;
+	int i;
+
+	while (1) {
+		n = rte_epoll_wait(rx_adapter->epd, epoll_events,
+				INTR_EPOLL_MAX_EVENTS, -1);
+		if (unlikely(n < 0)) {
+			RTE_EDEV_LOG_ERR("rte_epoll_wait returned error %d",
+					n);
+			break;
+		}
+
+		for (i = 0; i < n; i++)
+			eth_rx_intr_ring_enqueue(rx_adapter,
+					epoll_events[i].epdata.data);
+	}
+
+	return NULL;
+}
+
+/* Add the Rx queues signalled by the interrupt thread to intr_poll[] */
+static inline void
+eth_rx_intr_ring_dequeue(struct rte_event_eth_rx_adapter *rx_adapter)
+{
+	void *data[BATCH_SIZE];
+	struct eth_device_info *dev_info;
+	struct eth_rx_queue_info *queue_info;
+	struct eth_rx_poll_entry *entry;
+	unsigned int n;
+	unsigned int i;
+	uint16_t eth_dev_id;
+	uint16_t rx_queue_id;
+
+	n = rte_ring_sc_dequeue_burst(rx_adapter->intr_ring, data,
+				BATCH_SIZE, NULL);
+	for (i = 0; i < n; i++) {
+		eth_rx_intr_data_decode(data[i], &eth_dev_id, &rx_queue_id);
+		dev_info = &rx_adapter->eth_devices[eth_dev_id];
+		if (dev_info->rx_queue == NULL)
+			continue;
+
+		/* Skip queues deleted after the interrupt */
+		queue_info = &dev_info->rx_queue[rx_queue_id];
+		if (!queue_info->intr_mode || queue_info->intr_polling)
+			continue;
+
+		queue_info->intr_polling = 1;
+		queue_info->intr_idle = 0;
+		entry = &rx_adapter->intr_poll[rx_adapter->num_intr_poll++];
+		entry->eth_dev_id = eth_dev_id;
+		entry->eth_rx_qid = rx_queue_id;
+	}
+}
+
+static inline void
+eth_rx_intr_rearm(struct rte_event_eth_rx_adapter *rx_adapter,
+		uint16_t eth_dev_id,
+		uint16_t rx_queue_id)
+{
+	struct eth_rx_queue_info *queue_info =
+		&rx_adapter->eth_devices[eth_dev_id].rx_queue[rx_queue_id];
+
+	rte_spinlock_lock(&rx_adapter->intr_ring_lock);
+	queue_info->intr_polling = 0;
+	queue_info->intr_enabled = 1;
+	rte_eth_dev_rx_intr_enable(eth_dev_id, rx_queue_id);
+	rte_spinlock_unlock(&rx_adapter->intr_ring_lock);
+}
+
+/*
+ * Polls the interrupt mode Rx queues that have been signalled by the
+ * interrupt thread. A queue stays in intr_poll[] as long as it keeps
+ * receiving packets, so queues under load are polled like the queues in the
+ * WRR sequence and interrupts are only taken at low packet rates. After
+ * INTR_IDLE_POLL_THRESHOLD consecutive empty polls, the queue interrupt is
+ * rearmed and the queue is removed from intr_poll[].
+ */
+static inline void
+eth_rx_intr_poll(struct rte_event_eth_rx_adapter *rx_adapter)
+{
+	struct rte_event_eth_rx_adapter_stats *stats = &rx_adapter->stats;
+	struct rte_eth_event_enqueue_buffer *buf;
+	struct rte_mbuf *mbufs[BATCH_SIZE];
+	uint16_t i;
+	uint16_t n;
+
+	buf = &rx_adapter->event_enqueue_buffer;
+	i = 0;
+	while (i < rx_adapter->num_intr_poll) {
+		struct eth_rx_poll_entry *entry = &rx_adapter->intr_poll[i];
+		uint16_t qid = entry->eth_rx_qid;
+		uint16_t d = entry->eth_dev_id;
+		struct eth_rx_queue_info *queue_info =
+			&rx_adapter->eth_devices[d].rx_queue[qid];
+
+		if (buf->count >= BATCH_SIZE)
+			flush_event_buffer(rx_adapter);
+		if (BATCH_SIZE > (ETH_EVENT_BUFFER_SIZE - buf->count))
+			return;
+
+		stats->rx_poll_count++;
+		n = rte_eth_rx_burst(d, qid, mbufs, BATCH_SIZE);
+		if (n) {
+			stats->rx_packets += n;
+			stats->rx_intr_packets += n;
+			fill_event_buffer(rx_adapter, d, qid, mbufs, n);
+			queue_info->intr_idle = 0;
+			i++;
+		} else if (++queue_info->intr_idle < INTR_IDLE_POLL_THRESHOLD) {
+			i++;
+		} else {
+			*entry = rx_adapter->intr_poll[
+					--rx_adapter->num_intr_poll];
+			eth_rx_intr_rearm(rx_adapter, d, qid);
+		}
+	}
+}
+
 static int
 event_eth_rx_adapter_service_func(void *args)
 {
@@ -559,8 +765,12 @@ event_eth_rx_adapter_service_func(void *args)
 	if (rte_spinlock_trylock(&rx_adapter->rx_lock) == 0)
 		return 0;
 	if (!rx_adapter->rxa_started) {
-		return 0;
 		rte_spinlock_unlock(&rx_adapter->rx_lock);
+		return 0;
+	}
+	if (rx_adapter->num_rx_intr) {
+		eth_rx_intr_ring_dequeue(rx_adapter);
+		eth_rx_intr_poll(rx_adapter);
 	}
 	eth_rx_poll(rx_adapter);
 	rte_spinlock_unlock(&rx_adapter->rx_lock);
@@ -689,6 +899,196 @@ init_service(struct rte_event_eth_rx_adapter *rx_adapter, uint8_t id)
 }
 
 
+static int
+eth_rx_epoll_create1(void)
+{
+#if defined(RTE_EXEC_ENV_LINUXAPP)
+	int fd;
+
+	fd = epoll_create1(EPOLL_CLOEXEC);
+	return fd < 0 ? -errno : fd;
+#else
+	return -ENOTSUP;
+#endif
+}
+
+/* Setup the interrupt ring and the thread that waits for Rx queue
+ * interrupts, done when the first interrupt mode queue is added
+ */
+static int
+eth_rx_intr_init(struct rte_event_eth_rx_adapter *rx_adapter, uint8_t id)
+{
+	char name[ETH_RX_ADAPTER_MEM_NAME_LEN];
+	int err;
+
+	if (rx_adapter->intr_inited)
+		return 0;
+
+	snprintf(name, sizeof(name), "rxa_intr_ring_%" PRIu8, id);
+	rx_adapter->intr_ring = rte_ring_create(name,
+					RTE_EVENT_ETH_INTR_RING_SIZE,
+					rx_adapter->socket_id,
+					RING_F_SP_ENQ | RING_F_SC_DEQ);
+	if (rx_adapter->intr_ring == NULL)
+		return -rte_errno;
+
+	rx_adapter->intr_poll = rte_zmalloc_socket(rx_adapter->mem_name,
+					RTE_EVENT_ETH_INTR_RING_SIZE *
+					sizeof(*rx_adapter->intr_poll),
+					RTE_CACHE_LINE_SIZE,
+					rx_adapter->socket_id);
+	if (rx_adapter->intr_poll == NULL) {
+		err = -ENOMEM;
+		goto err_free_ring;
+	}
+
+	rx_adapter->epd = eth_rx_epoll_create1();
+	if (rx_adapter->epd < 0) {
+		err = rx_adapter->epd;
+		RTE_EDEV_LOG_ERR("failed to create epoll fd err = %d", err);
+		goto err_free_poll;
+	}
+
+	snprintf(name, sizeof(name), "rxa-intr-%" PRIu8, id);
+	err = rte_ctrl_thread_create(&rx_adapter->rx_intr_thread, name,
+				NULL, eth_rx_intr_thread, rx_adapter);
+	if (err) {
+		RTE_EDEV_LOG_ERR("failed to create interrupt thread err = %d",
+				err);
+		err = err < 0 ? err : -err;
+		goto err_close_fd;
+	}
+
+	rx_adapter->intr_inited = 1;
+	return 0;
+
+err_close_fd:
+	close(rx_adapter->epd);
+err_free_poll:
+	rte_free(rx_adapter->intr_poll);
+	rx_adapter->intr_poll = NULL;
+err_free_ring:
+	rte_ring_free(rx_adapter->intr_ring);
+	rx_adapter->intr_ring = NULL;
+	return err;
+}
+
+static void
+eth_rx_intr_uninit(struct rte_event_eth_rx_adapter *rx_adapter)
+{
+	if (!rx_adapter->intr_inited)
+		return;
+
+	pthread_cancel(rx_adapter->rx_intr_thread);
+	pthread_join(rx_adapter->rx_intr_thread, NULL);
+	close(rx_adapter->epd);
+	rte_free(rx_adapter->intr_poll);
+	rx_adapter->intr_poll = NULL;
+	rte_ring_free(rx_adapter->intr_ring);
+	rx_adapter->intr_ring = NULL;
+	rx_adapter->intr_inited = 0;
+}
+
+/* Returns true if the Rx queue shares its interrupt vector with another
+ * queue of the device, the interrupt doesn't identify the queue in this case
+ */
+static int
+eth_rx_intr_shared(struct eth_device_info *dev_info, uint16_t rx_queue_id)
+{
+	const struct rte_intr_handle *intr_handle = dev_info->dev->intr_handle;
+	uint16_t i;
+
+	if (intr_handle == NULL || intr_handle->intr_vec == NULL)
+		return 0;
+
+	for (i = 0; i < dev_info->dev->data->nb_rx_queues; i++) {
+		if (i != rx_queue_id && intr_handle->intr_vec[i] ==
+				intr_handle->intr_vec[rx_queue_id])
+			return 1;
+	}
+
+	return 0;
+}
+
+static int
+eth_rx_intr_queue_add(struct rte_event_eth_rx_adapter *rx_adapter,
+		struct eth_device_info *dev_info,
+		uint16_t rx_queue_id)
+{
+	struct eth_rx_queue_info *queue_info = &dev_info->rx_queue[rx_queue_id];
+	uint16_t eth_dev_id = dev_info->dev->data->port_id;
+	void *data = eth_rx_intr_data(eth_dev_id, rx_queue_id);
+	int err;
+
+	if (rx_adapter->num_rx_intr >= RTE_EVENT_ETH_INTR_RING_SIZE - 1)
+		return -ENOSPC;
+
+	if (eth_rx_intr_shared(dev_info, rx_queue_id))
+		return -ENOTSUP;
+
+	err = rte_eth_dev_rx_intr_ctl_q(eth_dev_id, rx_queue_id,
+					rx_adapter->epd, RTE_INTR_EVENT_ADD,
+					data);
+	if (err)
+		return err;
+
+	rte_spinlock_lock(&rx_adapter->intr_ring_lock);
+	err = rte_eth_dev_rx_intr_enable(eth_dev_id, rx_queue_id);
+	if (err == 0) {
+		queue_info->intr_mode = 1;
+		queue_info->intr_enabled = 1;
+	}
+	rte_spinlock_unlock(&rx_adapter->intr_ring_lock);
+
+	if (err) {
+		rte_eth_dev_rx_intr_ctl_q(eth_dev_id, rx_queue_id,
+					rx_adapter->epd, RTE_INTR_EVENT_DEL,
+					data);
+		return err;
+	}
+
+	rx_adapter->num_rx_intr++;
+	return 0;
+}
+
+static void
+eth_rx_intr_queue_del(struct rte_event_eth_rx_adapter *rx_adapter,
+		struct eth_device_info *dev_info,
+		uint16_t rx_queue_id)
+{
+	struct eth_rx_queue_info *queue_info = &dev_info->rx_queue[rx_queue_id];
+	uint16_t eth_dev_id = dev_info->dev->data->port_id;
+	struct eth_rx_poll_entry *entry;
+	uint16_t i;
+
+	rte_spinlock_lock(&rx_adapter->intr_ring_lock);
+	if (queue_info->intr_enabled)
+		rte_eth_dev_rx_intr_disable(eth_dev_id, rx_queue_id);
+	queue_info->intr_enabled = 0;
+	queue_info->intr_mode = 0;
+	rte_spinlock_unlock(&rx_adapter->intr_ring_lock);
+
+	rte_eth_dev_rx_intr_ctl_q(eth_dev_id, rx_queue_id, rx_adapter->epd,
+				RTE_INTR_EVENT_DEL,
+				eth_rx_intr_data(eth_dev_id, rx_queue_id));
+
+	if (queue_info->intr_polling) {
+		for (i = 0; i < rx_adapter->num_intr_poll; i++) {
+			entry = &rx_adapter->intr_poll[i];
+			if (entry->eth_dev_id == eth_dev_id &&
+				entry->eth_rx_qid == rx_queue_id) {
+				*entry = rx_adapter->intr_poll[
+						--rx_adapter->num_intr_poll];
+				break;
+			}
+		}
+		queue_info->intr_polling = 0;
+	}
+
+	rx_adapter->num_rx_intr--;
+}
+
+
 static void
 update_queue_info(struct rte_event_eth_rx_adapter *rx_adapter,
 		struct eth_device_info *dev_info,
@@ -730,7 +1130,10 @@ event_eth_rx_adapter_queue_del(struct rte_event_eth_rx_adapter *rx_adapter,
 		return 0;
 
 	queue_info = &dev_info->rx_queue[rx_queue_id];
-	rx_adapter->num_rx_polled -= queue_info->queue_enabled;
+	if (queue_info->intr_mode)
+		eth_rx_intr_queue_del(rx_adapter, dev_info, rx_queue_id);
+	else
+		rx_adapter->num_rx_polled -= queue_info->queue_enabled;
 	update_queue_info(rx_adapter, dev_info, rx_queue_id, 0);
 	return 0;
 }
@@ -744,25 +1147,46 @@ event_eth_rx_adapter_queue_add(struct rte_event_eth_rx_adapter *rx_adapter,
 {
 	struct eth_rx_queue_info *queue_info;
 	const struct rte_event *ev = &conf->ev;
+	struct rte_event qi_ev;
 
 	queue_info = &dev_info->rx_queue[rx_queue_id];
-	queue_info->event_queue_id = ev->queue_id;
-	queue_info->sched_type = ev->sched_type;
-	queue_info->priority = ev->priority;
-	queue_info->wt = conf->servicing_weight;
 
+	/* The same queue can be added more than once */
+	if (queue_info->queue_enabled)
+		event_eth_rx_adapter_queue_del(rx_adapter, dev_info,
+					rx_queue_id);
+
+	qi_ev.event = 0;
+	qi_ev.op = RTE_EVENT_OP_NEW;
+	qi_ev.event_type = RTE_EVENT_TYPE_ETH_RX_ADAPTER;
+	qi_ev.sub_event_type = 0;
+	qi_ev.sched_type = ev->sched_type;
+	qi_ev.queue_id = ev->queue_id;
+	qi_ev.priority = ev->priority;
+	queue_info->flow_id_mask = 0;
 	if (conf->rx_queue_flags &
 			RTE_EVENT_ETH_RX_ADAPTER_QUEUE_FLOW_ID_VALID) {
-		queue_info->flow_id = ev->flow_id;
+		qi_ev.flow_id = ev->flow_id;
 		queue_info->flow_id_mask = ~0;
 	}
+	queue_info->event = qi_ev.event;
+	queue_info->wt = conf->servicing_weight;
 
-	/* The same queue can be added more than once */
-	rx_adapter->num_rx_polled += !queue_info->queue_enabled;
+	/* Poll the queue if its interrupt can't be used */
+	if (queue_info->wt == 0 &&
+		eth_rx_intr_queue_add(rx_adapter, dev_info, rx_queue_id)) {
+		RTE_EDEV_LOG_DEBUG("Rx interrupt unavailable, polling eth port"
+			" %" PRIu16 " queue %" PRIu16,
+			dev_info->dev->data->port_id, rx_queue_id);
+		queue_info->wt = 1;
+	}
+
+	rx_adapter->num_rx_polled += !queue_info->intr_mode;
 	update_queue_info(rx_adapter, dev_info, rx_queue_id, 1);
 }
 
 static int add_rx_queue(struct rte_event_eth_rx_adapter *rx_adapter,
+		uint8_t id,
 		uint16_t eth_dev_id,
 		int rx_queue_id,
 		const struct rte_event_eth_rx_adapter_queue_conf *queue_conf)
@@ -776,15 +1200,16 @@ static int add_rx_queue(struct rte_event_eth_rx_adapter *rx_adapter,
 
 		struct rte_eth_dev_data *data = dev_info->dev->data;
 		if (data->dev_conf.intr_conf.rxq) {
-			RTE_EDEV_LOG_ERR("Interrupt driven queues"
-					" not supported");
-			return -ENOTSUP;
-		}
-		temp_conf = *queue_conf;
+			ret = eth_rx_intr_init(rx_adapter, id);
+			if (ret)
+				return ret;
+		} else {
+			temp_conf = *queue_conf;
 
-		/* If Rx interrupts are disabled set wt = 1 */
-		temp_conf.servicing_weight = 1;
-		queue_conf = &temp_conf;
+			/* If Rx interrupts are disabled set wt = 1 */
+			temp_conf.servicing_weight = 1;
+			queue_conf = &temp_conf;
+		}
 	}
 
 	if (dev_info->rx_queue == NULL) {
@@ -810,8 +1235,14 @@ static int add_rx_queue(struct rte_event_eth_rx_adapter *rx_adapter,
 
 	ret = eth_poll_wrr_calc(rx_adapter);
 	if (ret) {
-		event_eth_rx_adapter_queue_del(rx_adapter,
-					dev_info, rx_queue_id);
+		if (rx_queue_id == -1) {
+			for (i = 0; i < dev_info->dev->data->nb_rx_queues; i++)
+				event_eth_rx_adapter_queue_del(rx_adapter,
+							dev_info, i);
+		} else {
+			event_eth_rx_adapter_queue_del(rx_adapter, dev_info,
+						(uint16_t)rx_queue_id);
+		}
 		return ret;
 	}
 
@@ -930,6 +1361,7 @@ rte_event_eth_rx_adapter_create_ext(uint8_t id, uint8_t dev_id,
 		return -ENOMEM;
 	}
 	rte_spinlock_init(&rx_adapter->rx_lock);
+	rte_spinlock_init(&rx_adapter->intr_ring_lock);
 	RTE_ETH_FOREACH_DEV(i)
 		rx_adapter->eth_devices[i].dev = &rte_eth_devices[i];
 
@@ -979,6 +1411,7 @@ rte_event_eth_rx_adapter_free(uint8_t id)
 		return -EBUSY;
 	}
 
+	eth_rx_intr_uninit(rx_adapter);
 	if (rx_adapter->default_cb_arg)
 		rte_free(rx_adapter->conf_arg);
 	rte_free(rx_adapter->eth_devices);
@@ -1073,8 +1506,8 @@ rte_event_eth_rx_adapter_queue_add(uint8_t id,
 		dev_info->internal_event_port = 0;
 		ret = init_service(rx_adapter, id);
 		if (ret == 0)
-			ret = add_rx_queue(rx_adapter, eth_dev_id, rx_queue_id,
-					queue_conf);
+			ret = add_rx_queue(rx_adapter, id, eth_dev_id,
+					rx_queue_id, queue_conf);
 		rte_spinlock_unlock(&rx_adapter->rx_lock);
 		if (ret == 0)
 			start_service = !!sw_rx_adapter_queue_count(rx_adapter);
@@ -1158,9 +1591,12 @@ rte_event_eth_rx_adapter_queue_del(uint8_t id, uint16_t eth_dev_id,
 			RTE_EDEV_LOG_ERR("WRR recalculation failed %" PRId32,
 					rc);
 
+		/* The interrupt thread accesses rx_queue[] */
 		if (dev_info->nb_dev_queues == 0) {
+			rte_spinlock_lock(&rx_adapter->intr_ring_lock);
 			rte_free(dev_info->rx_queue);
 			dev_info->rx_queue = NULL;
+			rte_spinlock_unlock(&rx_adapter->intr_ring_lock);
 		}
 
 		rte_spinlock_unlock(&rx_adapter->rx_lock);
@@ -55,6 +55,15 @@
  * interrupt is enabled when configuring the device, the receive queue is
  * interrupt driven; else, the queue is assigned a servicing weight of one.
  *
+ * Interrupt driven queues are armed when added to the adapter and a control
+ * thread created by the adapter waits for their interrupts. When an interrupt
+ * occurs, the queue interrupt is disabled and the service function polls the
+ * queue for as long as it keeps receiving packets; the interrupt is rearmed
+ * once the queue is idle. A queue falls back to being polled with a servicing
+ * weight of one if its interrupt can't be used, for example if the ethernet
+ * device hasn't been started or the queue shares its interrupt vector with
+ * other queues.
+ *
  * The application can start/stop the adapter using the
  * rte_event_eth_rx_adapter_start() and the rte_event_eth_rx_adapter_stop()
  * functions. If the adapter uses a rte_service function, then the application
@@ -64,7 +73,7 @@
  * the service function ID of the adapter in this case.
  *
  * Note:
- * 1) Interrupt driven receive queues are currently unimplemented.
+ * 1) Interrupt driven receive queues are only supported on Linux.
  * 2) Devices created after an instance of rte_event_eth_rx_adapter_create
  *  should be added to a new instance of the rx adapter.
  */
@@ -199,6 +208,8 @@ struct rte_event_eth_rx_adapter_stats {
 	 * block cycles can be used to compute the percentage of
 	 * cycles the service is blocked by the event device.
 	 */
+	uint64_t rx_intr_packets;
+	/**< Received packet count for interrupt mode Rx queues */
 };
 
 /**
@@ -0,0 +1,895 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2018 Intel Corporation.
+ */
+
+#include <string.h>
+#include <rte_common.h>
+#include <rte_errno.h>
+#include <rte_ethdev.h>
+#include <rte_log.h>
+#include <rte_malloc.h>
+#include <rte_memzone.h>
+#include <rte_service_component.h>
+
+#include "rte_eventdev.h"
+#include "rte_eventdev_pmd.h"
+#include "rte_event_eth_tx_adapter.h"
+
+#define TXA_BATCH_SIZE		32
+#define TXA_MAX_NB_TX		128
+#define TXA_SERVICE_NAME_LEN	32
+#define TXA_MEM_NAME_LEN	32
+#define TXA_RETRY_CNT		100
+
+/* Flush an instance's Tx buffers every TXA_FLUSH_THRESHOLD invocations of
+ * the service function, in addition to flushing them whenever the adapter's
+ * event port is found empty.
+ */
+#define TXA_FLUSH_THRESHOLD	1024
+
+/* Macros to check for valid adapter */
+#define TXA_ID_VALID_OR_ERR_RET(id, retval) do { \
+	if (!txa_valid_id(id)) { \
+		RTE_EDEV_LOG_ERR("Invalid eth Tx adapter id = %d\n", id); \
+		return retval; \
+	} \
+} while (0)
+
+struct rte_event_eth_tx_adapter;
+
+/* Tx retry callback argument */
+struct txa_retry {
+	/* Adapter the Tx queue belongs to */
+	struct rte_event_eth_tx_adapter *txa;
+	/* Ethernet port identifier */
+	uint16_t port_id;
+	/* Tx queue identifier */
+	uint16_t tx_queue;
+};
+
+/* Per Tx queue information */
+struct txa_queue_info {
+	/* Set to indicate the queue has been added to the adapter */
+	uint8_t added;
+	/* Argument to the Tx buffer error callback */
+	struct txa_retry txa_retry;
+	/* Tx buffer used to aggregate mbufs into bursts, only allocated
+	 * when the queue is serviced by the adapter's service function
+	 */
+	struct rte_eth_dev_tx_buffer *tx_buf;
+};
+
+/* Per ethernet device information */
+struct txa_eth_device {
+	/* Pointer to ethernet device */
+	struct rte_eth_dev *dev;
+	/* Number of Tx queues added to the adapter */
+	uint16_t nb_queues;
+	/* Size of the queues array */
+	uint16_t nb_tx_queues;
+	/* Set if the eventdev PMD transmits on this device using an
+	 * internal port
+	 */
+	uint8_t internal_port;
+	/* Per Tx queue information */
+	struct txa_queue_info *queues;
+};
+
+struct rte_event_eth_tx_adapter {
+	/* Event device identifier */
+	uint8_t eventdev_id;
+	/* Event port identifier */
+	uint8_t event_port_id;
+	/* Max mbufs processed in any service function invocation */
+	uint32_t max_nb_tx;
+	/* Lock to serialize config updates with service function */
+	rte_spinlock_t lock;
+	/* Number of Tx queues added to the adapter */
+	uint32_t nb_queues;
+	/* Number of Tx queues serviced by the service function */
+	uint32_t nb_service_queues;
+	/* Per ethernet device structure, indexed by port identifier */
+	struct txa_eth_device *txa_ethdev;
+	/* Service function invocation counter, used to flush Tx buffers */
+	uint32_t loop_cnt;
+	/* Per instance stats structure */
+	struct rte_event_eth_tx_adapter_stats stats;
+	/* Configuration callback for rte_service configuration */
+	rte_event_eth_tx_adapter_conf_cb conf_cb;
+	/* Configuration callback argument */
+	void *conf_arg;
+	/* Set if default_cb is being used */
+	int default_cb_arg;
+	/* Service initialization state */
+	uint8_t service_inited;
+	/* Memory allocation name */
+	char mem_name[TXA_MEM_NAME_LEN];
+	/* Socket identifier cached from eventdev */
+	int socket_id;
+	/* Per adapter EAL service */
+	uint32_t service_id;
+} __rte_cache_aligned;
+
+static struct rte_event_eth_tx_adapter **event_eth_tx_adapter;
+
+static inline int
+txa_valid_id(uint8_t id)
+{
+	return id < RTE_EVENT_ETH_TX_ADAPTER_MAX_INSTANCE;
+}
+
+static int
+txa_init(void)
+{
+	const char *name = "eth_tx_adapter_array";
+	const struct rte_memzone *mz;
+	unsigned int sz;
+
+	sz = sizeof(*event_eth_tx_adapter) *
+	    RTE_EVENT_ETH_TX_ADAPTER_MAX_INSTANCE;
+	sz = RTE_ALIGN(sz, RTE_CACHE_LINE_SIZE);
+
+	mz = rte_memzone_lookup(name);
+	if (mz == NULL) {
+		mz = rte_memzone_reserve_aligned(name, sz, rte_socket_id(), 0,
+						 RTE_CACHE_LINE_SIZE);
+		if (mz == NULL) {
+			RTE_EDEV_LOG_ERR("failed to reserve memzone err = %"
+					PRId32, rte_errno);
+			return -rte_errno;
+		}
+	}
+
+	event_eth_tx_adapter = mz->addr;
+	return 0;
+}
+
+static inline struct rte_event_eth_tx_adapter *
+txa_id_to_adapter(uint8_t id)
+{
+	return event_eth_tx_adapter ?
+		event_eth_tx_adapter[id] : NULL;
+}
+
+static inline struct rte_eventdev *
+txa_evdev(struct rte_event_eth_tx_adapter *txa)
+{
+	return &rte_eventdevs[txa->eventdev_id];
+}
+
+static int
+txa_default_conf_cb(uint8_t id, uint8_t dev_id,
+		struct rte_event_eth_tx_adapter_conf *conf, void *arg)
+{
+	struct rte_event_dev_config dev_conf;
+	struct rte_eventdev *dev;
+	uint8_t port_id;
+	int started;
+	int ret;
+	struct rte_event_port_conf *port_conf = arg;
+	struct rte_event_eth_tx_adapter *txa = txa_id_to_adapter(id);
+
+	dev = txa_evdev(txa);
+	dev_conf = dev->data->dev_conf;
+
+	started = dev->data->dev_started;
+	if (started)
+		rte_event_dev_stop(dev_id);
+	port_id = dev_conf.nb_event_ports;
+	dev_conf.nb_event_ports += 1;
+	ret = rte_event_dev_configure(dev_id, &dev_conf);
+	if (ret) {
+		RTE_EDEV_LOG_ERR("failed to configure event dev %u\n", dev_id);
+		if (started) {
+			if (rte_event_dev_start(dev_id))
+				return -EIO;
+		}
+		return ret;
+	}
+
+	ret = rte_event_port_setup(dev_id, port_id, port_conf);
+	if (ret) {
+		RTE_EDEV_LOG_ERR("failed to setup event port %u\n", port_id);
+		return ret;
+	}
+
+	conf->event_port_id = port_id;
+	conf->max_nb_tx = TXA_MAX_NB_TX;
+	if (started)
+		ret = rte_event_dev_start(dev_id);
+
+	txa->default_cb_arg = 1;
+	return ret;
+}
+
+static void
+txa_service_buffer_retry(struct rte_mbuf **pkts, uint16_t unsent,
+			void *userdata)
+{
+	struct txa_retry *tr = userdata;
+	struct rte_event_eth_tx_adapter_stats *stats = &tr->txa->stats;
+	uint16_t retry = 0;
+	uint16_t sent = 0;
+	uint16_t i;
+
+	do {
+		sent += rte_eth_tx_burst(tr->port_id, tr->tx_queue,
+					&pkts[sent], unsent - sent);
+	} while (sent != unsent && retry++ < TXA_RETRY_CNT);
+
+	for (i = sent; i < unsent; i++)
+		rte_pktmbuf_free(pkts[i]);
+
+	stats->tx_retry += retry;
+	stats->tx_packets += sent;
+	stats->tx_dropped += unsent - sent;
+}
+
+static inline struct txa_queue_info *
+txa_service_queue(struct rte_event_eth_tx_adapter *txa, uint16_t port_id,
+		uint16_t tx_queue)
+{
+	struct txa_eth_device *tdi;
+
+	if (unlikely(port_id >= RTE_MAX_ETHPORTS))
+		return NULL;
+
+	tdi = &txa->txa_ethdev[port_id];
+	if (unlikely(tx_queue >= tdi->nb_tx_queues || tdi->internal_port))
+		return NULL;
+
+	return &tdi->queues[tx_queue];
+}
+
+static void
+txa_service_tx(struct rte_event_eth_tx_adapter *txa, struct rte_event *ev,
+	uint16_t n)
+{
+	struct rte_event_eth_tx_adapter_stats *stats = &txa->stats;
+	uint16_t nb_tx = 0;
+	uint16_t i;
+
+	for (i = 0; i < n; i++) {
+		struct rte_mbuf *m = ev[i].mbuf;
+		uint16_t port = m->port;
+		uint16_t queue = rte_event_eth_tx_adapter_txq_get(m);
+		struct txa_queue_info *tqi;
+
+		tqi = txa_service_queue(txa, port, queue);
+		if (unlikely(tqi == NULL || !tqi->added)) {
+			rte_pktmbuf_free(m);
+			stats->tx_dropped++;
+			continue;
+		}
+
+		nb_tx += rte_eth_tx_buffer(port, queue, tqi->tx_buf, m);
+	}
+
+	stats->tx_packets += nb_tx;
+}
+
+static void
+txa_service_flush(struct rte_event_eth_tx_adapter *txa)
+{
+	struct rte_event_eth_tx_adapter_stats *stats = &txa->stats;
+	uint16_t port;
+	uint16_t q;
+
+	for (port = 0; port < RTE_MAX_ETHPORTS; port++) {
+		struct txa_eth_device *tdi = &txa->txa_ethdev[port];
+
+		if (tdi->nb_queues == 0 || tdi->internal_port)
+			continue;
+
+		for (q = 0; q < tdi->nb_tx_queues; q++) {
+			struct txa_queue_info *tqi = &tdi->queues[q];
+
+			if (!tqi->added)
+				continue;
+
+			stats->tx_packets += rte_eth_tx_buffer_flush(port, q,
+								tqi->tx_buf);
+		}
+	}
+}
+
+static int32_t
+txa_service_func(void *args)
+{
+	struct rte_event_eth_tx_adapter *txa = args;
+	struct rte_event ev[TXA_BATCH_SIZE];
+	const uint8_t dev_id = txa->eventdev_id;
+	const uint8_t port = txa->event_port_id;
+	uint32_t nb_tx;
+	uint16_t n;
+
+	if (txa->nb_service_queues == 0)
+		return 0;
+
+	if (rte_spinlock_trylock(&txa->lock) == 0)
+		return 0;
+
+	for (nb_tx = 0; nb_tx < txa->max_nb_tx; nb_tx += n) {
+		n = rte_event_dequeue_burst(dev_id, port, ev, RTE_DIM(ev), 0);
+		if (!n)
+			break;
+		txa_service_tx(txa, ev, n);
+	}
+
+	/* An empty event port means no more mbufs are coming for now, send
+	 * out what has been buffered instead of waiting for a burst to fill.
+	 */
+	if (nb_tx == 0 ||
+	    (++txa->loop_cnt & (TXA_FLUSH_THRESHOLD - 1)) == 0)
+		txa_service_flush(txa);
+
+	rte_spinlock_unlock(&txa->lock);
+
+	return 0;
+}
+
+static int
+txa_init_service(struct rte_event_eth_tx_adapter *txa, uint8_t id)
+{
+	struct rte_event_eth_tx_adapter_conf conf;
+	struct rte_service_spec service;
+	int ret;
+
+	if (txa->service_inited)
+		return 0;
+
+	memset(&service, 0, sizeof(service));
+	snprintf(service.name, TXA_SERVICE_NAME_LEN,
+		"rte_event_eth_txa_%d", id);
+	service.socket_id = txa->socket_id;
+	service.callback = txa_service_func;
+	service.callback_userdata = txa;
+	/* Service function handles locking for queue add/del updates */
+	service.capabilities = RTE_SERVICE_CAP_MT_SAFE;
+	ret = rte_service_component_register(&service, &txa->service_id);
+	if (ret) {
+		RTE_EDEV_LOG_ERR("failed to register service %s err = %" PRId32,
+			service.name, ret);
+		return ret;
+	}
+
+	ret = txa->conf_cb(id, txa->eventdev_id, &conf, txa->conf_arg);
+	if (ret) {
+		RTE_EDEV_LOG_ERR("configuration callback failed err = %" PRId32,
+			ret);
+		rte_service_component_unregister(txa->service_id);
+		return ret;
+	}
+
+	txa->event_port_id = conf.event_port_id;
+	txa->max_nb_tx = conf.max_nb_tx;
+	txa->service_inited = 1;
+
+	return 0;
+}
+
+static int
+txa_eth_device_init(struct rte_event_eth_tx_adapter *txa,
+		struct txa_eth_device *tdi)
+{
+	uint16_t nb_tx_queues = tdi->dev->data->nb_tx_queues;
+
+	if (tdi->queues != NULL)
+		return 0;
+
+	tdi->queues = rte_zmalloc_socket(txa->mem_name,
+					nb_tx_queues *
+					sizeof(struct txa_queue_info),
+					0, txa->socket_id);
+	if (tdi->queues == NULL)
+		return -ENOMEM;
+
+	tdi->nb_tx_queues = nb_tx_queues;
+	return 0;
+}
+
+static void
+txa_eth_device_fini(struct txa_eth_device *tdi)
+{
+	if (tdi->nb_queues)
+		return;
+
+	rte_free(tdi->queues);
+	tdi->queues = NULL;
+	tdi->nb_tx_queues = 0;
+	tdi->internal_port = 0;
+}
+
+static void
+txa_update_queue_info(struct rte_event_eth_tx_adapter *txa,
+		struct txa_eth_device *tdi, uint16_t tx_queue, uint8_t add)
+{
+	struct txa_queue_info *tqi = &tdi->queues[tx_queue];
+
+	if (tqi->added == add)
+		return;
+
+	if (add) {
+		txa->nb_queues++;
+		tdi->nb_queues++;
+	} else {
+		txa->nb_queues--;
+		tdi->nb_queues--;
+	}
+	tqi->added = add;
+}
+
+static int
+txa_service_queue_add(struct rte_event_eth_tx_adapter *txa,
+		struct txa_eth_device *tdi, uint16_t port_id,
+		uint16_t tx_queue)
+{
+	struct txa_queue_info *tqi = &tdi->queues[tx_queue];
+	struct rte_eth_dev_tx_buffer *tb;
+	int ret;
+
+	if (tqi->added)
+		return 0;
+
+	tb = rte_zmalloc_socket(txa->mem_name,
+				RTE_ETH_TX_BUFFER_SIZE(TXA_BATCH_SIZE),
+				0, txa->socket_id);
+	if (tb == NULL)
+		return -ENOMEM;
+
+	ret = rte_eth_tx_buffer_init(tb, TXA_BATCH_SIZE);
+	if (ret == 0) {
+		tqi->txa_retry.txa = txa;
+		tqi->txa_retry.port_id = port_id;
+		tqi->txa_retry.tx_queue = tx_queue;
+		ret = rte_eth_tx_buffer_set_err_callback(tb,
+						txa_service_buffer_retry,
+						&tqi->txa_retry);
+	}
+	if (ret) {
+		rte_free(tb);
+		return ret;
+	}
+
+	tqi->tx_buf = tb;
+	txa->nb_service_queues++;
+	txa_update_queue_info(txa, tdi, tx_queue, 1);
+
+	return 0;
+}
+
+static void
+txa_service_queue_del(struct rte_event_eth_tx_adapter *txa,
+		struct txa_eth_device *tdi, uint16_t port_id,
+		uint16_t tx_queue)
+{
+	struct txa_queue_info *tqi = &tdi->queues[tx_queue];
+
+	if (!tqi->added)
+		return;
+
+	txa->stats.tx_packets += rte_eth_tx_buffer_flush(port_id, tx_queue,
+							tqi->tx_buf);
+	rte_free(tqi->tx_buf);
+	tqi->tx_buf = NULL;
+	txa->nb_service_queues--;
+	txa_update_queue_info(txa, tdi, tx_queue, 0);
+}
+
+int __rte_experimental
+rte_event_eth_tx_adapter_create_ext(uint8_t id, uint8_t dev_id,
+				rte_event_eth_tx_adapter_conf_cb conf_cb,
+				void *conf_arg)
+{
+	struct rte_event_eth_tx_adapter *txa;
+	char mem_name[TXA_MEM_NAME_LEN];
+	struct rte_eventdev *dev;
+	int socket_id;
+	uint16_t i;
+	int ret;
+
+	TXA_ID_VALID_OR_ERR_RET(id, -EINVAL);
+	RTE_EVENTDEV_VALID_DEVID_OR_ERR_RET(dev_id, -EINVAL);
+	if (conf_cb == NULL)
+		return -EINVAL;
+
+	if (event_eth_tx_adapter == NULL) {
+		ret = txa_init();
+		if (ret)
+			return ret;
+	}
+
+	txa = txa_id_to_adapter(id);
+	if (txa != NULL) {
+		RTE_EDEV_LOG_ERR("Eth Tx adapter id %u already exists!", id);
+		return -EEXIST;
+	}
+
+	socket_id = rte_event_dev_socket_id(dev_id);
+	snprintf(mem_name, TXA_MEM_NAME_LEN, "rte_event_eth_txa_%d", id);
+
+	txa = rte_zmalloc_socket(mem_name, sizeof(*txa),
+			RTE_CACHE_LINE_SIZE, socket_id);
+	if (txa == NULL) {
+		RTE_EDEV_LOG_ERR("Failed to get mem for eth Tx adapter!");
+		return -ENOMEM;
+	}
+
+	txa->txa_ethdev = rte_zmalloc_socket(mem_name,
+					RTE_MAX_ETHPORTS *
+					sizeof(struct txa_eth_device), 0,
+					socket_id);
+	if (txa->txa_ethdev == NULL) {
+		RTE_EDEV_LOG_ERR("Failed to get mem for eth devices\n");
+		rte_free(txa);
+		return -ENOMEM;
+	}
+
+	txa->eventdev_id = dev_id;
+	txa->socket_id = socket_id;
+	txa->conf_cb = conf_cb;
+	txa->conf_arg = conf_arg;
+	strcpy(txa->mem_name, mem_name);
+	rte_spinlock_init(&txa->lock);
+	for (i = 0; i < RTE_MAX_ETHPORTS; i++)
+		txa->txa_ethdev[i].dev = &rte_eth_devices[i];
+
+	dev = txa_evdev(txa);
+	if (dev->dev_ops->eth_tx_adapter_create) {
+		ret = (*dev->dev_ops->eth_tx_adapter_create)(id, dev);
+		if (ret) {
+			RTE_EDEV_LOG_ERR("PMD failed to create eth Tx adapter"
+					" err = %d", ret);
+			rte_free(txa->txa_ethdev);
+			rte_free(txa);
+			return ret;
+		}
+	}
+
+	event_eth_tx_adapter[id] = txa;
+
+	return 0;
+}
+
+int __rte_experimental
+rte_event_eth_tx_adapter_create(uint8_t id, uint8_t dev_id,
+				struct rte_event_port_conf *port_config)
+{
+	struct rte_event_port_conf *pc;
+	int ret;
+
+	if (port_config == NULL)
+		return -EINVAL;
+	TXA_ID_VALID_OR_ERR_RET(id, -EINVAL);
+
+	pc = rte_malloc(NULL, sizeof(*pc), 0);
+	if (pc == NULL)
+		return -ENOMEM;
+	*pc = *port_config;
+	ret = rte_event_eth_tx_adapter_create_ext(id, dev_id,
+						txa_default_conf_cb,
+						pc);
+	if (ret)
+		rte_free(pc);
+
+	return ret;
+}
+
+int __rte_experimental
+rte_event_eth_tx_adapter_free(uint8_t id)
+{
+	struct rte_event_eth_tx_adapter *txa;
+	struct rte_eventdev *dev;
+	int ret;
+
+	TXA_ID_VALID_OR_ERR_RET(id, -EINVAL);
+
+	txa = txa_id_to_adapter(id);
+	if (txa == NULL)
+		return -EINVAL;
+
+	if (txa->nb_queues) {
+		RTE_EDEV_LOG_ERR("%" PRIu32 " Tx queues not deleted",
+				txa->nb_queues);
+		return -EBUSY;
+	}
+
+	dev = txa_evdev(txa);
+	if (dev->dev_ops->eth_tx_adapter_free) {
+		ret = (*dev->dev_ops->eth_tx_adapter_free)(id, dev);
+		if (ret)
+			return ret;
+	}
+
+	if (txa->service_inited)
+		rte_service_component_unregister(txa->service_id);
+	if (txa->default_cb_arg)
+		rte_free(txa->conf_arg);
+	rte_free(txa->txa_ethdev);
+	rte_free(txa);
+	event_eth_tx_adapter[id] = NULL;
+
+	return 0;
+}
+
+int __rte_experimental
+rte_event_eth_tx_adapter_queue_add(uint8_t id,
+				uint16_t eth_dev_id,
+				int32_t queue)
+{
+	struct rte_event_eth_tx_adapter *txa;
+	struct txa_eth_device *tdi;
+	struct rte_eventdev *dev;
+	uint16_t nb_tx_queues;
+	uint32_t caps;
+	uint16_t i;
+	int ret;
+
+	TXA_ID_VALID_OR_ERR_RET(id, -EINVAL);
+	RTE_ETH_VALID_PORTID_OR_ERR_RET(eth_dev_id, -EINVAL);
+
+	txa = txa_id_to_adapter(id);
+	if (txa == NULL)
+		return -EINVAL;
+
+	tdi = &txa->txa_ethdev[eth_dev_id];
+	nb_tx_queues = tdi->dev->data->nb_tx_queues;
+	if (nb_tx_queues == 0 ||
+	    (queue != -1 && (uint16_t)queue >= nb_tx_queues)) {
+		RTE_EDEV_LOG_ERR("Invalid tx queue_id %" PRIu16,
+				(uint16_t)queue);
+		return -EINVAL;
+	}
+
+	ret = rte_event_eth_tx_adapter_caps_get(txa->eventdev_id, eth_dev_id,
+						&caps);
+	if (ret)
+		return ret;
+
+	dev = txa_evdev(txa);
+	rte_spinlock_lock(&txa->lock);
+
+	ret = txa_eth_device_init(txa, tdi);
+	if (ret)
+		goto unlock;
+
+	if (caps & RTE_EVENT_ETH_TX_ADAPTER_CAP_INTERNAL_PORT) {
+		if (dev->dev_ops->eth_tx_adapter_queue_add == NULL) {
+			ret = -ENOTSUP;
+			goto fini;
+		}
+		ret = (*dev->dev_ops->eth_tx_adapter_queue_add)(id, dev,
+								tdi->dev,
+								queue);
+		if (ret)
+			goto fini;
+
+		tdi->internal_port = 1;
+		if (queue == -1) {
+			for (i = 0; i < tdi->nb_tx_queues; i++)
+				txa_update_queue_info(txa, tdi, i, 1);
+		} else {
+			txa_update_queue_info(txa, tdi, queue, 1);
+		}
+		goto unlock;
+	}
+
+	ret = txa_init_service(txa, id);
+	if (ret)
+		goto fini;
+
+	if (queue == -1) {
+		for (i = 0; i < tdi->nb_tx_queues && ret == 0; i++)
+			ret = txa_service_queue_add(txa, tdi, eth_dev_id, i);
+	} else {
+		ret = txa_service_queue_add(txa, tdi, eth_dev_id, queue);
+	}
+
+	rte_service_component_runstate_set(txa->service_id,
+					txa->nb_service_queues != 0);
+
+fini:
+	txa_eth_device_fini(tdi);
+unlock:
+	rte_spinlock_unlock(&txa->lock);
+
+	return ret;
+}
+
+int __rte_experimental
+rte_event_eth_tx_adapter_queue_del(uint8_t id,
+				uint16_t eth_dev_id,
+				int32_t queue)
+{
+	struct rte_event_eth_tx_adapter *txa;
+	struct txa_eth_device *tdi;
+	struct rte_eventdev *dev;
+	uint16_t i;
+	int ret = 0;
+
+	TXA_ID_VALID_OR_ERR_RET(id, -EINVAL);
+	RTE_ETH_VALID_PORTID_OR_ERR_RET(eth_dev_id, -EINVAL);
+
+	txa = txa_id_to_adapter(id);
+	if (txa == NULL)
+		return -EINVAL;
+
+	tdi = &txa->txa_ethdev[eth_dev_id];
+	if (tdi->nb_queues == 0)
+		return 0;
+
+	if (queue != -1 && (uint16_t)queue >= tdi->nb_tx_queues) {
+		RTE_EDEV_LOG_ERR("Invalid tx queue_id %" PRIu16,
+				(uint16_t)queue);
+		return -EINVAL;
+	}
+
+	dev = txa_evdev(txa);
+	rte_spinlock_lock(&txa->lock);
+
+	if (tdi->internal_port) {
+		if (dev->dev_ops->eth_tx_adapter_queue_del == NULL) {
+			ret = -ENOTSUP;
+			goto unlock;
+		}
+		ret = (*dev->dev_ops->eth_tx_adapter_queue_del)(id, dev,
+								tdi->dev,
+								queue);
+		if (ret)
+			goto unlock;
+
+		if (queue == -1) {
+			for (i = 0; i < tdi->nb_tx_queues; i++)
+				txa_update_queue_info(txa, tdi, i, 0);
+		} else {
+			txa_update_queue_info(txa, tdi, queue, 0);
+		}
+	} else {
+		if (queue == -1) {
+			for (i = 0; i < tdi->nb_tx_queues; i++)
+				txa_service_queue_del(txa, tdi, eth_dev_id, i);
+		} else {
+			txa_service_queue_del(txa, tdi, eth_dev_id, queue);
+		}
+		rte_service_component_runstate_set(txa->service_id,
+						txa->nb_service_queues != 0);
+	}
+
+	txa_eth_device_fini(tdi);
+unlock:
+	rte_spinlock_unlock(&txa->lock);
+
+	return ret;
+}
+
+static int
+txa_ctrl(uint8_t id, int start)
+{
+	struct rte_event_eth_tx_adapter *txa;
+	struct rte_eventdev *dev;
+	int ret = 0;
+
+	TXA_ID_VALID_OR_ERR_RET(id, -EINVAL);
+
+	txa = txa_id_to_adapter(id);
+	if (txa == NULL)
+		return -EINVAL;
+
+	dev = txa_evdev(txa);
+	if (start && dev->dev_ops->eth_tx_adapter_start)
+		ret = (*dev->dev_ops->eth_tx_adapter_start)(id, dev);
+	else if (!start && dev->dev_ops->eth_tx_adapter_stop)
+		ret = (*dev->dev_ops->eth_tx_adapter_stop)(id, dev);
+	if (ret)
+		return ret;
+
+	if (txa->service_inited)
+		ret = rte_service_runstate_set(txa->service_id, start);
+
+	return ret;
+}
+
+int __rte_experimental
+rte_event_eth_tx_adapter_start(uint8_t id)
+{
+	return txa_ctrl(id, 1);
+}
+
+int __rte_experimental
+rte_event_eth_tx_adapter_stop(uint8_t id)
+{
+	return txa_ctrl(id, 0);
+}
+
+int __rte_experimental
+rte_event_eth_tx_adapter_stats_get(uint8_t id,
+				struct rte_event_eth_tx_adapter_stats *stats)
+{
+	struct rte_event_eth_tx_adapter_stats dev_stats;
+	struct rte_event_eth_tx_adapter *txa;
+	struct rte_eventdev *dev;
+	int ret;
+
+	TXA_ID_VALID_OR_ERR_RET(id, -EINVAL);
+
+	txa = txa_id_to_adapter(id);
+	if (txa == NULL || stats == NULL)
+		return -EINVAL;
+
+	*stats = txa->stats;
+
+	dev = txa_evdev(txa);
+	if (dev->dev_ops->eth_tx_adapter_stats_get) {
+		memset(&dev_stats, 0, sizeof(dev_stats));
+		ret = (*dev->dev_ops->eth_tx_adapter_stats_get)(id, dev,
+								&dev_stats);
+		if (ret)
+			return ret;
+
+		stats->tx_retry += dev_stats.tx_retry;
+		stats->tx_packets += dev_stats.tx_packets;
+		stats->tx_dropped += dev_stats.tx_dropped;
+	}
+
+	return 0;
+}
+
+int __rte_experimental
+rte_event_eth_tx_adapter_stats_reset(uint8_t id)
+{
+	struct rte_event_eth_tx_adapter *txa;
+	struct rte_eventdev *dev;
+	int ret;
+
+	TXA_ID_VALID_OR_ERR_RET(id, -EINVAL);
+
+	txa = txa_id_to_adapter(id);
+	if (txa == NULL)
+		return -EINVAL;
+
+	dev = txa_evdev(txa);
+	if (dev->dev_ops->eth_tx_adapter_stats_reset) {
+		ret = (*dev->dev_ops->eth_tx_adapter_stats_reset)(id, dev);
+		if (ret)
+			return ret;
+	}
+
+	memset(&txa->stats, 0, sizeof(txa->stats));
+	return 0;
+}
+
+int __rte_experimental
+rte_event_eth_tx_adapter_event_port_get(uint8_t id, uint8_t *event_port_id)
+{
+	struct rte_event_eth_tx_adapter *txa;
+
+	TXA_ID_VALID_OR_ERR_RET(id, -EINVAL);
+
+	txa = txa_id_to_adapter(id);
+	if (txa == NULL || event_port_id == NULL)
+		return -EINVAL;
+
+	if (!txa->service_inited)
+		return -ENODEV;
+
+	*event_port_id = txa->event_port_id;
+
+	return 0;
+}
+
+int __rte_experimental
+rte_event_eth_tx_adapter_service_id_get(uint8_t id, uint32_t *service_id)
+{
+	struct rte_event_eth_tx_adapter *txa;
+
+	TXA_ID_VALID_OR_ERR_RET(id, -EINVAL);
+
+	txa = txa_id_to_adapter(id);
+	if (txa == NULL || service_id == NULL)
+		return -EINVAL;
+
+	if (txa->service_inited)
+		*service_id = txa->service_id;
+
+	return txa->service_inited ? 0 : -ESRCH;
+}
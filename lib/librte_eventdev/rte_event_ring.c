@@ -56,7 +56,11 @@ rte_event_ring_create(const char *name, unsigned int count, int socket_id,
 		return NULL;
 	}
 
-	ring_size = sizeof(*r) + (count * sizeof(struct rte_event));
+	ring_size = rte_ring_get_memsize_elem(sizeof(struct rte_event), count);
+	if (ring_size < 0) {
+		rte_errno = -ring_size;
+		return NULL;
+	}
 
 	ret = snprintf(mz_name, sizeof(mz_name), "%s%s",
 		RTE_RING_MZ_PREFIX, name);
@@ -82,16 +86,19 @@ rte_event_ring_create(const char *name, unsigned int count, int socket_id,
 	mz = rte_memzone_reserve(mz_name, ring_size, socket_id, mz_flags);
 	if (mz != NULL) {
 		r = mz->addr;
-		/*
-		 * no need to check return value here, we already checked the
-		 * arguments above
-		 */
-		rte_event_ring_init(r, name, requested_count, flags);
-
-		te->data = (void *) r;
-		r->r.memzone = mz;
-
-		TAILQ_INSERT_TAIL(ring_list, te, next);
+		/* the ring library validates the sync mode flags */
+		ret = rte_event_ring_init(r, name, requested_count, flags);
+		if (ret == 0) {
+			te->data = (void *) r;
+			r->r.memzone = mz;
+
+			TAILQ_INSERT_TAIL(ring_list, te, next);
+		} else {
+			rte_memzone_free(mz);
+			rte_free(te);
+			rte_errno = -ret;
+			r = NULL;
+		}
 	} else {
 		r = NULL;
 		RTE_LOG(ERR, RING, "Cannot reserve memory\n");
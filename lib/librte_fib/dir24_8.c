@@ -0,0 +1,488 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2018 Intel Corporation
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <rte_atomic.h>
+#include <rte_debug.h>
+#include <rte_malloc.h>
+#include <rte_errno.h>
+#include <rte_memory.h>
+#include <rte_cpuflags.h>
+
+#include <rte_rib.h>
+#include "rte_fib.h"
+
+#include "dir24_8.h"
+
+#define LOOKUP_FUNC(suffix, type, nh_sz)				\
+static void								\
+dir24_8_lookup_bulk_##suffix(void *p, const uint32_t *ips,		\
+	uint64_t *next_hops, const unsigned int n)			\
+{									\
+	struct dir24_8_tbl *dp = (struct dir24_8_tbl *)p;		\
+	uint32_t i;							\
+	uint32_t prefetch_offset = RTE_MIN(15U, n);			\
+									\
+	for (i = 0; i < prefetch_offset; i++)				\
+		rte_prefetch0(get_tbl24_p(dp, ips[i], nh_sz));		\
+	for (i = 0; i < (n - prefetch_offset); i++) {			\
+		rte_prefetch0(get_tbl24_p(dp,				\
+			ips[i + prefetch_offset], nh_sz));		\
+		next_hops[i] = DIR24_8_LOOKUP_ONE(type, dp, ips[i]);	\
+	}								\
+	for (; i < n; i++)						\
+		next_hops[i] = DIR24_8_LOOKUP_ONE(type, dp, ips[i]);	\
+}
+
+LOOKUP_FUNC(1b, uint8_t, 0)
+LOOKUP_FUNC(2b, uint16_t, 1)
+LOOKUP_FUNC(4b, uint32_t, 2)
+LOOKUP_FUNC(8b, uint64_t, 3)
+
+static rte_fib_lookup_fn_t
+get_scalar_fn(enum rte_fib_dir24_8_nh_sz nh_sz)
+{
+	switch (nh_sz) {
+	case RTE_FIB_DIR24_8_1B:
+		return dir24_8_lookup_bulk_1b;
+	case RTE_FIB_DIR24_8_2B:
+		return dir24_8_lookup_bulk_2b;
+	case RTE_FIB_DIR24_8_4B:
+		return dir24_8_lookup_bulk_4b;
+	case RTE_FIB_DIR24_8_8B:
+		return dir24_8_lookup_bulk_8b;
+	default:
+		return NULL;
+	}
+}
+
+static rte_fib_lookup_fn_t
+get_vector_fn(enum rte_fib_dir24_8_nh_sz nh_sz)
+{
+#ifdef CC_AVX512_SUPPORT
+	if (!rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX512F))
+		return NULL;
+
+	switch (nh_sz) {
+	case RTE_FIB_DIR24_8_1B:
+		return dir24_8_vec_lookup_bulk_1b;
+	case RTE_FIB_DIR24_8_2B:
+		return dir24_8_vec_lookup_bulk_2b;
+	case RTE_FIB_DIR24_8_4B:
+		return dir24_8_vec_lookup_bulk_4b;
+	case RTE_FIB_DIR24_8_8B:
+		return dir24_8_vec_lookup_bulk_8b;
+	default:
+		return NULL;
+	}
+#else
+	RTE_SET_USED(nh_sz);
+	return NULL;
+#endif
+}
+
+rte_fib_lookup_fn_t
+dir24_8_get_lookup_fn(void *p, enum rte_fib_lookup_type type)
+{
+	struct dir24_8_tbl *dp = p;
+	rte_fib_lookup_fn_t fn;
+
+	if (dp == NULL)
+		return NULL;
+
+	switch (type) {
+	case RTE_FIB_LOOKUP_DEFAULT:
+		fn = get_vector_fn(dp->nh_sz);
+		return (fn != NULL) ? fn : get_scalar_fn(dp->nh_sz);
+	case RTE_FIB_LOOKUP_DIR24_8_SCALAR:
+		return get_scalar_fn(dp->nh_sz);
+	case RTE_FIB_LOOKUP_DIR24_8_VECTOR_AVX512:
+		return get_vector_fn(dp->nh_sz);
+	default:
+		return NULL;
+	}
+}
+
+static inline uint64_t
+get_tbl_val_by_idx(const void *tbl, uint32_t idx, uint8_t nh_sz)
+{
+	switch (nh_sz) {
+	case RTE_FIB_DIR24_8_1B:
+		return ((const uint8_t *)tbl)[idx];
+	case RTE_FIB_DIR24_8_2B:
+		return ((const uint16_t *)tbl)[idx];
+	case RTE_FIB_DIR24_8_4B:
+		return ((const uint32_t *)tbl)[idx];
+	default:
+		return ((const uint64_t *)tbl)[idx];
+	}
+}
+
+/* Write n consecutive entries of a table, starting at idx */
+static void
+write_to_fib(void *tbl, uint32_t idx, uint64_t val, uint8_t nh_sz,
+	uint32_t n)
+{
+	uint32_t i;
+	uint8_t *ptr8 = (uint8_t *)tbl + idx;
+	uint16_t *ptr16 = (uint16_t *)tbl + idx;
+	uint32_t *ptr32 = (uint32_t *)tbl + idx;
+	uint64_t *ptr64 = (uint64_t *)tbl + idx;
+
+	switch (nh_sz) {
+	case RTE_FIB_DIR24_8_1B:
+		memset(ptr8, (uint8_t)val, n);
+		break;
+	case RTE_FIB_DIR24_8_2B:
+		for (i = 0; i < n; i++)
+			ptr16[i] = (uint16_t)val;
+		break;
+	case RTE_FIB_DIR24_8_4B:
+		for (i = 0; i < n; i++)
+			ptr32[i] = (uint32_t)val;
+		break;
+	case RTE_FIB_DIR24_8_8B:
+		for (i = 0; i < n; i++)
+			ptr64[i] = val;
+		break;
+	}
+}
+
+static inline void *
+get_tbl8_grp(struct dir24_8_tbl *dp, uint32_t tbl8_idx)
+{
+	return (uint8_t *)dp->tbl8 +
+		(((uint64_t)tbl8_idx * DIR24_8_TBL8_GRP_NUM_ENT) << dp->nh_sz);
+}
+
+/*
+ * Take a tbl8 group from the pool, with all its entries set to the
+ * value of the tbl24 entry it is going to extend.
+ */
+static int32_t
+tbl8_alloc(struct dir24_8_tbl *dp, uint64_t val)
+{
+	uint32_t tbl8_idx;
+
+	if (dp->cur_tbl8s == dp->number_tbl8s)
+		return -ENOSPC;
+
+	tbl8_idx = dp->tbl8_pool[dp->cur_tbl8s++];
+	write_to_fib(get_tbl8_grp(dp, tbl8_idx), 0, val, dp->nh_sz,
+		DIR24_8_TBL8_GRP_NUM_ENT);
+	return tbl8_idx;
+}
+
+static void
+tbl8_free(struct dir24_8_tbl *dp, uint32_t tbl8_idx)
+{
+	dp->tbl8_pool[--dp->cur_tbl8s] = tbl8_idx;
+}
+
+/*
+ * Fold a tbl8 group back into its tbl24 entry when all its entries
+ * hold the same next hop.
+ */
+static void
+tbl8_recycle(struct dir24_8_tbl *dp, uint32_t ip, uint32_t tbl8_idx)
+{
+	uint32_t i;
+	uint64_t first;
+	void *grp = get_tbl8_grp(dp, tbl8_idx);
+
+	first = get_tbl_val_by_idx(grp, 0, dp->nh_sz);
+	for (i = 1; i < DIR24_8_TBL8_GRP_NUM_ENT; i++) {
+		if (get_tbl_val_by_idx(grp, i, dp->nh_sz) != first)
+			return;
+	}
+
+	write_to_fib(dp->tbl24, ip >> 8, first, dp->nh_sz, 1);
+	tbl8_free(dp, tbl8_idx);
+}
+
+/* Write val to the [from, to) entries of the tbl8 group extending ip */
+static int
+write_tbl8_range(struct dir24_8_tbl *dp, uint32_t ip, uint32_t from,
+	uint32_t to, uint64_t val)
+{
+	uint64_t ent;
+	int32_t tbl8_idx;
+
+	ent = get_tbl_val_by_idx(dp->tbl24, ip >> 8, dp->nh_sz);
+	if (is_entry_extended(ent))
+		tbl8_idx = ent >> 1;
+	else {
+		tbl8_idx = tbl8_alloc(dp, ent);
+		if (tbl8_idx < 0)
+			return tbl8_idx;
+		/* the group must be filled before readers can reach it */
+		rte_smp_wmb();
+		write_to_fib(dp->tbl24, ip >> 8,
+			((uint64_t)tbl8_idx << 1) | DIR24_8_EXT_ENT,
+			dp->nh_sz, 1);
+	}
+
+	write_to_fib(get_tbl8_grp(dp, tbl8_idx), from, val, dp->nh_sz,
+		to - from);
+	tbl8_recycle(dp, ip, tbl8_idx);
+	return 0;
+}
+
+/* Write val to the [from, to) tbl24 entries, releasing their tbl8 groups */
+static void
+write_tbl24_range(struct dir24_8_tbl *dp, uint32_t from, uint32_t to,
+	uint64_t val)
+{
+	uint32_t i;
+	uint64_t ent;
+
+	for (i = from; i < to; i++) {
+		ent = get_tbl_val_by_idx(dp->tbl24, i, dp->nh_sz);
+		write_to_fib(dp->tbl24, i, val, dp->nh_sz, 1);
+		if (is_entry_extended(ent))
+			tbl8_free(dp, ent >> 1);
+	}
+}
+
+/* Make the [ledge, redge) addresses range resolve to next_hop */
+static int
+install_to_fib(struct dir24_8_tbl *dp, uint64_t ledge, uint64_t redge,
+	uint64_t next_hop)
+{
+	uint64_t val = next_hop << 1;
+	uint32_t first24;
+	int ret;
+
+	if (ledge == redge)
+		return 0;
+
+	if ((ledge >> 8) == (redge >> 8))
+		return write_tbl8_range(dp, ledge, ledge & UINT8_MAX,
+			redge & UINT8_MAX, val);
+
+	first24 = ledge >> 8;
+	if (ledge & UINT8_MAX) {
+		ret = write_tbl8_range(dp, ledge, ledge & UINT8_MAX,
+			DIR24_8_TBL8_GRP_NUM_ENT, val);
+		if (ret != 0)
+			return ret;
+		first24++;
+	}
+
+	write_tbl24_range(dp, first24, redge >> 8, val);
+
+	if (redge & UINT8_MAX)
+		return write_tbl8_range(dp, redge, 0, redge & UINT8_MAX, val);
+	return 0;
+}
+
+/*
+ * Make the addresses of ip/depth resolve to next_hop, except the ones
+ * belonging to more specific routes, which are left untouched.
+ */
+static int
+modify_fib(struct dir24_8_tbl *dp, struct rte_rib *rib, uint32_t ip,
+	uint8_t depth, uint64_t next_hop)
+{
+	struct rte_rib_node *tmp = NULL;
+	uint64_t ledge, redge;
+	uint32_t tmp_ip;
+	uint8_t tmp_depth;
+	int ret;
+
+	ledge = ip;
+	while ((tmp = rte_rib_get_nxt(rib, ip, depth, tmp,
+			RTE_RIB_GET_NXT_COVER)) != NULL) {
+		rte_rib_get_ip(tmp, &tmp_ip);
+		rte_rib_get_depth(tmp, &tmp_depth);
+		redge = tmp_ip;
+		ret = install_to_fib(dp, ledge, redge, next_hop);
+		if (ret != 0)
+			return ret;
+		ledge = redge + (1ULL << (32 - tmp_depth));
+	}
+
+	redge = (uint64_t)ip + (1ULL << (32 - depth));
+	return install_to_fib(dp, ledge, redge, next_hop);
+}
+
+/* Check if the /24 of ip holds a route longer than /24 */
+static inline int
+has_tbl8_route(struct rte_rib *rib, uint32_t ip)
+{
+	return rte_rib_get_nxt(rib, ip, 24, NULL,
+		RTE_RIB_GET_NXT_COVER) != NULL;
+}
+
+int
+dir24_8_modify(struct rte_fib *fib, uint32_t ip, uint8_t depth,
+	uint64_t next_hop, int op)
+{
+	struct dir24_8_tbl *dp;
+	struct rte_rib *rib;
+	struct rte_rib_node *node, *parent;
+	uint64_t par_nh, node_nh;
+	int need_tbl8 = 0;
+	int ret = 0;
+
+	if ((fib == NULL) || (depth > RTE_FIB_MAXDEPTH))
+		return -EINVAL;
+
+	dp = rte_fib_get_dp(fib);
+	rib = rte_fib_get_rib(fib);
+	RTE_ASSERT((dp != NULL) && (rib != NULL));
+
+	if (next_hop > get_max_nh(dp->nh_sz))
+		return -EINVAL;
+
+	ip &= rte_rib_depth_to_mask(depth);
+
+	node = rte_rib_lookup_exact(rib, ip, depth);
+	switch (op) {
+	case RTE_FIB_ADD:
+		if (node != NULL) {
+			rte_rib_get_nh(node, &node_nh);
+			if (node_nh == next_hop)
+				return 0;
+			ret = modify_fib(dp, rib, ip, depth, next_hop);
+			if (ret == 0)
+				rte_rib_set_nh(node, next_hop);
+			return ret;
+		}
+		/*
+		 * A tbl8 group is reserved for each /24 holding longer
+		 * routes, so that no update can fail half way through.
+		 */
+		if (depth > 24) {
+			need_tbl8 = !has_tbl8_route(rib, ip);
+			if (need_tbl8 && (dp->rsvd_tbl8s >= dp->number_tbl8s))
+				return -ENOSPC;
+		}
+		node = rte_rib_insert(rib, ip, depth);
+		if (node == NULL)
+			return -rte_errno;
+		rte_rib_set_nh(node, next_hop);
+		parent = rte_rib_lookup_parent(node);
+		if (parent != NULL)
+			rte_rib_get_nh(parent, &par_nh);
+		else
+			par_nh = dp->def_nh;
+		if (par_nh != next_hop) {
+			ret = modify_fib(dp, rib, ip, depth, next_hop);
+			if (ret != 0) {
+				rte_rib_remove(rib, ip, depth);
+				return ret;
+			}
+		}
+		dp->rsvd_tbl8s += need_tbl8;
+		return 0;
+	case RTE_FIB_DEL:
+		if (node == NULL)
+			return -ENOENT;
+
+		parent = rte_rib_lookup_parent(node);
+		if (parent != NULL)
+			rte_rib_get_nh(parent, &par_nh);
+		else
+			par_nh = dp->def_nh;
+		rte_rib_get_nh(node, &node_nh);
+		if (par_nh != node_nh)
+			ret = modify_fib(dp, rib, ip, depth, par_nh);
+		if (ret != 0)
+			return ret;
+		rte_rib_remove(rib, ip, depth);
+		if ((depth > 24) && !has_tbl8_route(rib, ip))
+			dp->rsvd_tbl8s--;
+		return 0;
+	default:
+		return -EINVAL;
+	}
+}
+
+void *
+dir24_8_create(const char *name, int socket_id, struct rte_fib_conf *fib_conf)
+{
+	char mem_name[RTE_FIB_NAMESIZE];
+	struct dir24_8_tbl *dp;
+	uint64_t def_nh;
+	uint32_t num_tbl8;
+	uint32_t i;
+	enum rte_fib_dir24_8_nh_sz nh_sz;
+
+	if ((name == NULL) || (fib_conf == NULL) ||
+			(fib_conf->dir24_8.nh_sz < RTE_FIB_DIR24_8_1B) ||
+			(fib_conf->dir24_8.nh_sz > RTE_FIB_DIR24_8_8B) ||
+			(fib_conf->dir24_8.num_tbl8 >
+			RTE_MIN(get_max_nh(fib_conf->dir24_8.nh_sz),
+			(uint64_t)DIR24_8_TBL8_MAX_NUM_GRP)) ||
+			(fib_conf->dir24_8.num_tbl8 == 0) ||
+			(fib_conf->default_nh >
+			get_max_nh(fib_conf->dir24_8.nh_sz))) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	def_nh = fib_conf->default_nh;
+	nh_sz = fib_conf->dir24_8.nh_sz;
+	num_tbl8 = fib_conf->dir24_8.num_tbl8;
+
+	/*
+	 * The tables are padded so that the vector lookups, which gather
+	 * 32 bits wide for the smaller next hop sizes, never read past them.
+	 */
+	dp = rte_zmalloc_socket(name, sizeof(struct dir24_8_tbl) +
+		DIR24_8_TBL24_NUM_ENT * (1 << nh_sz) + sizeof(uint32_t),
+		RTE_CACHE_LINE_SIZE, socket_id);
+	if (dp == NULL) {
+		rte_errno = ENOMEM;
+		return NULL;
+	}
+
+	/* Init table with default value */
+	write_to_fib(dp->tbl24, 0, def_nh << 1, nh_sz, DIR24_8_TBL24_NUM_ENT);
+
+	snprintf(mem_name, sizeof(mem_name), "TBL8_%p", dp);
+	dp->tbl8 = rte_zmalloc_socket(mem_name, DIR24_8_TBL8_GRP_NUM_ENT *
+		((uint64_t)num_tbl8 << nh_sz) + sizeof(uint32_t),
+		RTE_CACHE_LINE_SIZE, socket_id);
+	if (dp->tbl8 == NULL) {
+		rte_errno = ENOMEM;
+		rte_free(dp);
+		return NULL;
+	}
+
+	snprintf(mem_name, sizeof(mem_name), "TBL8_idxes_%p", dp);
+	dp->tbl8_pool = rte_malloc_socket(mem_name,
+		sizeof(uint32_t) * num_tbl8, RTE_CACHE_LINE_SIZE, socket_id);
+	if (dp->tbl8_pool == NULL) {
+		rte_errno = ENOMEM;
+		rte_free(dp->tbl8);
+		rte_free(dp);
+		return NULL;
+	}
+	for (i = 0; i < num_tbl8; i++)
+		dp->tbl8_pool[i] = i;
+
+	dp->def_nh = def_nh;
+	dp->nh_sz = nh_sz;
+	dp->number_tbl8s = num_tbl8;
+
+	return dp;
+}
+
+void
+dir24_8_free(void *p)
+{
+	struct dir24_8_tbl *dp = (struct dir24_8_tbl *)p;
+
+	if (dp == NULL)
+		return;
+
+	rte_free(dp->tbl8_pool);
+	rte_free(dp->tbl8);
+	rte_free(dp);
+}
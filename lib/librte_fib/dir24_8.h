@@ -0,0 +1,97 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2018 Intel Corporation
+ */
+
+#ifndef _DIR24_8_H_
+#define _DIR24_8_H_
+
+/**
+ * @file
+ * DIR24_8 dataplane structure of the IPv4 FIB.
+ *
+ * The 24 most significant bits of an address index tbl24. An entry holds
+ * either the next hop, or with its least significant bit set the index of
+ * a tbl8 group of 256 entries, indexed by the last byte of the address.
+ */
+
+#include <rte_memory.h>
+#include <rte_prefetch.h>
+#include <rte_branch_prediction.h>
+
+#include "rte_fib.h"
+
+#define DIR24_8_TBL24_NUM_ENT		(1 << 24)
+#define DIR24_8_TBL8_GRP_NUM_ENT	256U
+/* Keeps the tbl8 entry indexes of the vector lookups on 31 bits */
+#define DIR24_8_TBL8_MAX_NUM_GRP	(1 << 22)
+#define DIR24_8_EXT_ENT			1
+#define DIR24_8_TBL24_MASK		0xffffff00
+
+struct dir24_8_tbl {
+	uint32_t	number_tbl8s;	/**< Total number of tbl8s */
+	uint32_t	rsvd_tbl8s;	/**< Number of reserved tbl8s */
+	uint32_t	cur_tbl8s;	/**< Current number of tbl8s */
+	enum rte_fib_dir24_8_nh_sz	nh_sz;	/**< Size of nexthop entry */
+	uint64_t	def_nh;		/**< Default next hop */
+	uint64_t	*tbl8;		/**< tbl8 table */
+	uint32_t	*tbl8_pool;	/**< Stack of free tbl8 indexes */
+	uint64_t	tbl24[0] __rte_cache_aligned; /**< tbl24 table */
+};
+
+static inline void *
+get_tbl24_p(struct dir24_8_tbl *dp, uint32_t ip, uint8_t nh_sz)
+{
+	return (void *)&((uint8_t *)dp->tbl24)[(ip &
+		DIR24_8_TBL24_MASK) >> (8 - nh_sz)];
+}
+
+static inline uint64_t
+get_max_nh(uint8_t nh_sz)
+{
+	return (UINT64_MAX >> (64 - (8 << nh_sz))) >> 1;
+}
+
+static inline int
+is_entry_extended(uint64_t ent)
+{
+	return (ent & DIR24_8_EXT_ENT) == DIR24_8_EXT_ENT;
+}
+
+/* Scalar lookup of one address, for a given next hop type */
+#define DIR24_8_LOOKUP_ONE(type, dp, ip) __extension__ ({		\
+	uint64_t _ent = ((type *)(dp)->tbl24)[(ip) >> 8];		\
+	if (unlikely(is_entry_extended(_ent)))				\
+		_ent = ((type *)(dp)->tbl8)[(uint8_t)(ip) +		\
+			((_ent >> 1) * DIR24_8_TBL8_GRP_NUM_ENT)];	\
+	_ent >> 1;							\
+})
+
+void *
+dir24_8_create(const char *name, int socket_id, struct rte_fib_conf *conf);
+
+void
+dir24_8_free(void *p);
+
+rte_fib_lookup_fn_t
+dir24_8_get_lookup_fn(void *p, enum rte_fib_lookup_type type);
+
+int
+dir24_8_modify(struct rte_fib *fib, uint32_t ip, uint8_t depth,
+	uint64_t next_hop, int op);
+
+#ifdef CC_AVX512_SUPPORT
+void
+dir24_8_vec_lookup_bulk_1b(void *p, const uint32_t *ips,
+	uint64_t *next_hops, const unsigned int n);
+void
+dir24_8_vec_lookup_bulk_2b(void *p, const uint32_t *ips,
+	uint64_t *next_hops, const unsigned int n);
+void
+dir24_8_vec_lookup_bulk_4b(void *p, const uint32_t *ips,
+	uint64_t *next_hops, const unsigned int n);
+void
+dir24_8_vec_lookup_bulk_8b(void *p, const uint32_t *ips,
+	uint64_t *next_hops, const unsigned int n);
+#endif
+
+#endif /* _DIR24_8_H_ */
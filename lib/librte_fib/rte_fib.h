@@ -0,0 +1,277 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2018 Intel Corporation
+ */
+
+#ifndef _RTE_FIB_H_
+#define _RTE_FIB_H_
+
+/**
+ * @file
+ * RTE FIB library: IPv4 Forwarding Information Base.
+ *
+ * The routes are kept in a RIB, which is the control plane structure,
+ * and a separate dataplane structure is updated incrementally from it
+ * on each route change. The dataplane structure is selected at creation
+ * and only holds next hops, so that lookups touch as little memory as
+ * possible.
+ *
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ */
+
+#include <stdint.h>
+
+#include <rte_common.h>
+#include <rte_compat.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct rte_fib;
+struct rte_rib;
+
+/** Maximum number of characters in FIB name. */
+#define RTE_FIB_NAMESIZE	64
+
+/** Maximum depth value possible for IPv4 FIB. */
+#define RTE_FIB_MAXDEPTH	32
+
+/** Type of FIB dataplane structure */
+enum rte_fib_type {
+	RTE_FIB_DUMMY,		/**< Lookups in the RIB itself */
+	RTE_FIB_DIR24_8,	/**< DIR24_8 tables */
+	RTE_FIB_TYPE_MAX
+};
+
+/** Size of the next hops of a DIR24_8 FIB, one bit is used internally */
+enum rte_fib_dir24_8_nh_sz {
+	RTE_FIB_DIR24_8_1B,	/**< 1 byte, next hops up to 2^7 - 1 */
+	RTE_FIB_DIR24_8_2B,	/**< 2 bytes, next hops up to 2^15 - 1 */
+	RTE_FIB_DIR24_8_4B,	/**< 4 bytes, next hops up to 2^31 - 1 */
+	RTE_FIB_DIR24_8_8B	/**< 8 bytes, next hops up to 2^63 - 1 */
+};
+
+/** Implementation of the bulk lookup function */
+enum rte_fib_lookup_type {
+	/** Fastest implementation available on the running CPU */
+	RTE_FIB_LOOKUP_DEFAULT,
+	/** Scalar DIR24_8 lookup, with software prefetch */
+	RTE_FIB_LOOKUP_DIR24_8_SCALAR,
+	/** DIR24_8 lookup using AVX512 gathers, 16 addresses at once */
+	RTE_FIB_LOOKUP_DIR24_8_VECTOR_AVX512
+};
+
+/** Operations of the modify function of the dataplane structures */
+enum {
+	RTE_FIB_ADD,	/**< Add or update a route */
+	RTE_FIB_DEL	/**< Delete a route */
+};
+
+/** Function applying a route change to the RIB and the dataplane */
+typedef int (*rte_fib_modify_fn_t)(struct rte_fib *fib, uint32_t ip,
+	uint8_t depth, uint64_t next_hop, int op);
+
+/** FIB bulk lookup function */
+typedef void (*rte_fib_lookup_fn_t)(void *fib_p, const uint32_t *ips,
+	uint64_t *next_hops, const unsigned int n);
+
+/** FIB configuration structure */
+struct rte_fib_conf {
+	enum rte_fib_type type; /**< Type of FIB dataplane structure */
+	/** Next hop returned for the addresses matching no route */
+	uint64_t default_nh;
+	int max_routes; /**< Maximum number of routes */
+	RTE_STD_C11
+	union {
+		struct {
+			enum rte_fib_dir24_8_nh_sz nh_sz;
+			/** Number of tbl8 groups, each one needed by the
+			 * /24 prefixes holding routes longer than /24
+			 */
+			uint32_t num_tbl8;
+		} dir24_8;
+	};
+};
+
+/**
+ * Create a FIB.
+ *
+ * @param name
+ *   FIB name
+ * @param socket_id
+ *   NUMA socket ID for FIB table memory allocation
+ * @param conf
+ *   Structure containing the configuration
+ * @return
+ *   Handle to the FIB object on success, NULL otherwise with rte_errno
+ *   set to:
+ *    - EINVAL - invalid parameter passed to function
+ *    - EEXIST - a FIB with the same name already exists
+ *    - ENOMEM - no appropriate memory area found
+ */
+struct rte_fib * __rte_experimental
+rte_fib_create(const char *name, int socket_id, struct rte_fib_conf *conf);
+
+/**
+ * Find an existing FIB object and return a pointer to it.
+ *
+ * @param name
+ *   Name of the FIB object as passed to rte_fib_create()
+ * @return
+ *   Pointer to FIB object, NULL otherwise with rte_errno set to ENOENT
+ */
+struct rte_fib * __rte_experimental
+rte_fib_find_existing(const char *name);
+
+/**
+ * Free a FIB object.
+ *
+ * @param fib
+ *   FIB object handle
+ */
+void __rte_experimental
+rte_fib_free(struct rte_fib *fib);
+
+/**
+ * Add a route to the FIB, or update its next hop if it exists.
+ *
+ * @param fib
+ *   FIB object handle
+ * @param ip
+ *   Prefix of the route, in host byte order
+ * @param depth
+ *   Prefix length of the route
+ * @param next_hop
+ *   Next hop of the route
+ * @return
+ *   0 on success, negative value otherwise:
+ *    - -EINVAL - invalid parameter passed to function
+ *    - -ENOSPC - no more room for the route
+ */
+int __rte_experimental
+rte_fib_add(struct rte_fib *fib, uint32_t ip, uint8_t depth,
+	uint64_t next_hop);
+
+/**
+ * Delete a route from the FIB.
+ *
+ * @param fib
+ *   FIB object handle
+ * @param ip
+ *   Prefix of the route, in host byte order
+ * @param depth
+ *   Prefix length of the route
+ * @return
+ *   0 on success, negative value otherwise:
+ *    - -EINVAL - invalid parameter passed to function
+ *    - -ENOENT - the route does not exist
+ */
+int __rte_experimental
+rte_fib_delete(struct rte_fib *fib, uint32_t ip, uint8_t depth);
+
+/**
+ * Add multiple routes to the FIB, or update their next hop if they exist.
+ *
+ * The routes are sorted by prefix, then by prefix length, and added in
+ * that order, so that each route update finds the RIB nodes and the
+ * dataplane entries of the previous one in cache. It is much faster than
+ * adding the routes one by one in random order, e.g. to load a full table.
+ * When a route is given several times, the last next hop is kept.
+ * On error, the routes sorted before the failing one are added, and the
+ * following ones are not.
+ *
+ * @param fib
+ *   FIB object handle
+ * @param ips
+ *   Array of route prefixes, in host byte order
+ * @param depths
+ *   Array of route prefix lengths
+ * @param next_hops
+ *   Array of route next hops
+ * @param n
+ *   Number of elements in ips, depths and next_hops arrays
+ * @return
+ *   0 on success, negative value otherwise:
+ *    - -EINVAL - invalid parameter passed to function
+ *    - -ENOMEM - no memory to sort the routes
+ *    - -ENOSPC - no more room for a route
+ */
+int __rte_experimental
+rte_fib_add_bulk(struct rte_fib *fib, const uint32_t *ips,
+	const uint8_t *depths, const uint64_t *next_hops, int n);
+
+/**
+ * Lookup multiple IP addresses in the FIB.
+ *
+ * @param fib
+ *   FIB object handle
+ * @param ips
+ *   Array of IPs to be looked up in the FIB, in host byte order
+ * @param next_hops
+ *   Next hop of the most specific route found for each IP,
+ *   the default next hop if there is none
+ * @param n
+ *   Number of elements in ips and next_hops arrays
+ * @return
+ *   -EINVAL for incorrect arguments, otherwise 0
+ */
+int __rte_experimental
+rte_fib_lookup_bulk(struct rte_fib *fib, uint32_t *ips,
+	uint64_t *next_hops, int n);
+
+/**
+ * Get a pointer to the dataplane structure of the FIB,
+ * to be passed to the function returned by rte_fib_get_lookup_fn().
+ *
+ * @param fib
+ *   FIB object handle
+ * @return
+ *   Pointer to the dataplane structure
+ */
+void * __rte_experimental
+rte_fib_get_dp(struct rte_fib *fib);
+
+/**
+ * Get the bulk lookup function of the FIB, which can be called directly
+ * with the pointer returned by rte_fib_get_dp().
+ *
+ * @param fib
+ *   FIB object handle
+ * @return
+ *   Bulk lookup function
+ */
+rte_fib_lookup_fn_t __rte_experimental
+rte_fib_get_lookup_fn(struct rte_fib *fib);
+
+/**
+ * Get a pointer to the RIB holding the routes of the FIB.
+ * It must not be modified directly.
+ *
+ * @param fib
+ *   FIB object handle
+ * @return
+ *   Pointer to the RIB
+ */
+struct rte_rib * __rte_experimental
+rte_fib_get_rib(struct rte_fib *fib);
+
+/**
+ * Select the implementation of the bulk lookup function.
+ *
+ * @param fib
+ *   FIB object handle
+ * @param type
+ *   Type of lookup function
+ * @return
+ *   0 on success, -EINVAL if the type is not supported by the FIB
+ *   type or by the running CPU
+ */
+int __rte_experimental
+rte_fib_select_lookup(struct rte_fib *fib, enum rte_fib_lookup_type type);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_FIB_H_ */
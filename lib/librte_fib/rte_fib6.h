@@ -0,0 +1,256 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2018 Intel Corporation
+ */
+
+#ifndef _RTE_FIB6_H_
+#define _RTE_FIB6_H_
+
+/**
+ * @file
+ * RTE FIB6 library: IPv6 Forwarding Information Base.
+ *
+ * The routes are kept in a RIB6, and a multibit trie dataplane structure
+ * is updated incrementally from it on each route change.
+ *
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ */
+
+#include <stdint.h>
+
+#include <rte_common.h>
+#include <rte_compat.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Size of an IPv6 address in bytes. */
+#define RTE_FIB6_IPV6_ADDR_SIZE		16
+/** Maximum number of characters in FIB6 name. */
+#define RTE_FIB6_NAMESIZE		64
+/** Maximum depth value possible for IPv6 FIB. */
+#define RTE_FIB6_MAXDEPTH		128
+
+struct rte_fib6;
+struct rte_rib6;
+
+/** Type of FIB6 dataplane structure */
+enum rte_fib6_type {
+	RTE_FIB6_DUMMY,		/**< Lookups in the RIB6 itself */
+	RTE_FIB6_TRIE,		/**< Multibit trie, 24 then 8 bits strides */
+	RTE_FIB6_TYPE_MAX
+};
+
+/** Operations of the modify function of the dataplane structures */
+enum {
+	RTE_FIB6_ADD,	/**< Add or update a route */
+	RTE_FIB6_DEL	/**< Delete a route */
+};
+
+/** Function applying a route change to the RIB6 and the dataplane */
+typedef int (*rte_fib6_modify_fn_t)(struct rte_fib6 *fib,
+	const uint8_t ip[RTE_FIB6_IPV6_ADDR_SIZE], uint8_t depth,
+	uint64_t next_hop, int op);
+
+/** FIB6 bulk lookup function */
+typedef void (*rte_fib6_lookup_fn_t)(void *fib_p,
+	uint8_t ips[][RTE_FIB6_IPV6_ADDR_SIZE],
+	uint64_t *next_hops, const unsigned int n);
+
+/** Size of the next hops of a trie FIB6, one bit is used internally */
+enum rte_fib_trie_nh_sz {
+	RTE_FIB6_TRIE_2B = 1,	/**< 2 bytes, next hops up to 2^15 - 1 */
+	RTE_FIB6_TRIE_4B,	/**< 4 bytes, next hops up to 2^31 - 1 */
+	RTE_FIB6_TRIE_8B	/**< 8 bytes, next hops up to 2^63 - 1 */
+};
+
+/** FIB6 configuration structure */
+struct rte_fib6_conf {
+	enum rte_fib6_type type; /**< Type of FIB6 dataplane structure */
+	/** Next hop returned for the addresses matching no route */
+	uint64_t default_nh;
+	int max_routes; /**< Maximum number of routes */
+	RTE_STD_C11
+	union {
+		struct {
+			enum rte_fib_trie_nh_sz nh_sz;
+			/** Number of tbl8 groups, a route of depth d longer
+			 * than /24 needs up to (d - 24) / 8 of them,
+			 * rounded up
+			 */
+			uint32_t num_tbl8;
+		} trie;
+	};
+};
+
+/**
+ * Create a FIB6.
+ *
+ * @param name
+ *   FIB6 name
+ * @param socket_id
+ *   NUMA socket ID for FIB6 table memory allocation
+ * @param conf
+ *   Structure containing the configuration
+ * @return
+ *   Handle to the FIB6 object on success, NULL otherwise with rte_errno
+ *   set to:
+ *    - EINVAL - invalid parameter passed to function
+ *    - EEXIST - a FIB6 with the same name already exists
+ *    - ENOMEM - no appropriate memory area found
+ */
+struct rte_fib6 * __rte_experimental
+rte_fib6_create(const char *name, int socket_id, struct rte_fib6_conf *conf);
+
+/**
+ * Find an existing FIB6 object and return a pointer to it.
+ *
+ * @param name
+ *   Name of the FIB6 object as passed to rte_fib6_create()
+ * @return
+ *   Pointer to FIB6 object, NULL otherwise with rte_errno set to ENOENT
+ */
+struct rte_fib6 * __rte_experimental
+rte_fib6_find_existing(const char *name);
+
+/**
+ * Free a FIB6 object.
+ *
+ * @param fib
+ *   FIB6 object handle
+ */
+void __rte_experimental
+rte_fib6_free(struct rte_fib6 *fib);
+
+/**
+ * Add a route to the FIB6, or update its next hop if it exists.
+ *
+ * @param fib
+ *   FIB6 object handle
+ * @param ip
+ *   Prefix of the route
+ * @param depth
+ *   Prefix length of the route
+ * @param next_hop
+ *   Next hop of the route
+ * @return
+ *   0 on success, negative value otherwise:
+ *    - -EINVAL - invalid parameter passed to function
+ *    - -ENOSPC - no more room for the route
+ */
+int __rte_experimental
+rte_fib6_add(struct rte_fib6 *fib, const uint8_t ip[RTE_FIB6_IPV6_ADDR_SIZE],
+	uint8_t depth, uint64_t next_hop);
+
+/**
+ * Delete a route from the FIB6.
+ *
+ * @param fib
+ *   FIB6 object handle
+ * @param ip
+ *   Prefix of the route
+ * @param depth
+ *   Prefix length of the route
+ * @return
+ *   0 on success, negative value otherwise:
+ *    - -EINVAL - invalid parameter passed to function
+ *    - -ENOENT - the route does not exist
+ */
+int __rte_experimental
+rte_fib6_delete(struct rte_fib6 *fib,
+	const uint8_t ip[RTE_FIB6_IPV6_ADDR_SIZE], uint8_t depth);
+
+/**
+ * Add multiple routes to the FIB6, or update their next hop if they exist.
+ *
+ * The routes are sorted by prefix, then by prefix length, and added in
+ * that order, so that each route update finds the RIB6 nodes and the
+ * tbl8 groups of the previous one in cache. It is much faster than adding
+ * the routes one by one in random order, e.g. to load a full table.
+ * When a route is given several times, the last next hop is kept.
+ * On error, the routes sorted before the failing one are added, and the
+ * following ones are not.
+ *
+ * @param fib
+ *   FIB6 object handle
+ * @param ips
+ *   Array of route prefixes
+ * @param depths
+ *   Array of route prefix lengths
+ * @param next_hops
+ *   Array of route next hops
+ * @param n
+ *   Number of elements in ips, depths and next_hops arrays
+ * @return
+ *   0 on success, negative value otherwise:
+ *    - -EINVAL - invalid parameter passed to function
+ *    - -ENOMEM - no memory to sort the routes
+ *    - -ENOSPC - no more room for a route
+ */
+int __rte_experimental
+rte_fib6_add_bulk(struct rte_fib6 *fib,
+	uint8_t ips[][RTE_FIB6_IPV6_ADDR_SIZE], const uint8_t *depths,
+	const uint64_t *next_hops, int n);
+
+/**
+ * Lookup multiple IP addresses in the FIB6.
+ *
+ * @param fib
+ *   FIB6 object handle
+ * @param ips
+ *   Array of IPv6 addresses to be looked up in the FIB6
+ * @param next_hops
+ *   Next hop of the most specific route found for each IP,
+ *   the default next hop if there is none
+ * @param n
+ *   Number of elements in ips and next_hops arrays
+ * @return
+ *   -EINVAL for incorrect arguments, otherwise 0
+ */
+int __rte_experimental
+rte_fib6_lookup_bulk(struct rte_fib6 *fib,
+	uint8_t ips[][RTE_FIB6_IPV6_ADDR_SIZE],
+	uint64_t *next_hops, int n);
+
+/**
+ * Get a pointer to the dataplane structure of the FIB6,
+ * to be passed to the function returned by rte_fib6_get_lookup_fn().
+ *
+ * @param fib
+ *   FIB6 object handle
+ * @return
+ *   Pointer to the dataplane structure
+ */
+void * __rte_experimental
+rte_fib6_get_dp(struct rte_fib6 *fib);
+
+/**
+ * Get the bulk lookup function of the FIB6, which can be called directly
+ * with the pointer returned by rte_fib6_get_dp().
+ *
+ * @param fib
+ *   FIB6 object handle
+ * @return
+ *   Bulk lookup function
+ */
+rte_fib6_lookup_fn_t __rte_experimental
+rte_fib6_get_lookup_fn(struct rte_fib6 *fib);
+
+/**
+ * Get a pointer to the RIB6 holding the routes of the FIB6.
+ * It must not be modified directly.
+ *
+ * @param fib
+ *   FIB6 object handle
+ * @return
+ *   Pointer to the RIB6
+ */
+struct rte_rib6 * __rte_experimental
+rte_fib6_get_rib(struct rte_fib6 *fib);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_FIB6_H_ */
@@ -0,0 +1,527 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2018 Intel Corporation
+ */
+
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <rte_atomic.h>
+#include <rte_debug.h>
+#include <rte_malloc.h>
+#include <rte_errno.h>
+#include <rte_memory.h>
+
+#include <rte_rib6.h>
+#include "rte_fib6.h"
+
+#include "trie.h"
+
+#define LOOKUP_FUNC(suffix, type, nh_sz)				\
+static void								\
+trie_lookup_bulk_##suffix(void *p,					\
+	uint8_t ips[][RTE_FIB6_IPV6_ADDR_SIZE],				\
+	uint64_t *next_hops, const unsigned int n)			\
+{									\
+	struct rte_trie_tbl *dp = (struct rte_trie_tbl *)p;		\
+	uint64_t tmp;							\
+	uint32_t i, j;							\
+	uint32_t prefetch_offset = RTE_MIN(15U, n);			\
+									\
+	for (i = 0; i < prefetch_offset; i++)				\
+		rte_prefetch0(get_tbl24_p(dp, ips[i], nh_sz));		\
+	for (i = 0; i < n; i++) {					\
+		if (likely(i + prefetch_offset < n))			\
+			rte_prefetch0(get_tbl24_p(dp,			\
+				ips[i + prefetch_offset], nh_sz));	\
+		tmp = ((type *)dp->tbl24)[get_tbl24_idx(ips[i])];	\
+		j = 3;							\
+		while (is_entry_extended(tmp)) {			\
+			tmp = ((type *)dp->tbl8)[ips[i][j++] +		\
+				((tmp >> 1) * TRIE_TBL8_GRP_NUM_ENT)];	\
+		}							\
+		next_hops[i] = tmp >> 1;				\
+	}								\
+}
+
+LOOKUP_FUNC(2b, uint16_t, 1)
+LOOKUP_FUNC(4b, uint32_t, 2)
+LOOKUP_FUNC(8b, uint64_t, 3)
+
+rte_fib6_lookup_fn_t
+trie_get_lookup_fn(void *p)
+{
+	struct rte_trie_tbl *dp = p;
+
+	if (dp == NULL)
+		return NULL;
+
+	switch (dp->nh_sz) {
+	case RTE_FIB6_TRIE_2B:
+		return trie_lookup_bulk_2b;
+	case RTE_FIB6_TRIE_4B:
+		return trie_lookup_bulk_4b;
+	case RTE_FIB6_TRIE_8B:
+		return trie_lookup_bulk_8b;
+	default:
+		return NULL;
+	}
+}
+
+static inline uint64_t
+get_tbl_val_by_idx(const void *tbl, uint32_t idx, uint8_t nh_sz)
+{
+	switch (nh_sz) {
+	case RTE_FIB6_TRIE_2B:
+		return ((const uint16_t *)tbl)[idx];
+	case RTE_FIB6_TRIE_4B:
+		return ((const uint32_t *)tbl)[idx];
+	default:
+		return ((const uint64_t *)tbl)[idx];
+	}
+}
+
+/* Write n consecutive entries of a table, starting at idx */
+static void
+write_to_dp(void *tbl, uint32_t idx, uint64_t val, uint8_t nh_sz,
+	uint32_t n)
+{
+	uint32_t i;
+	uint16_t *ptr16 = (uint16_t *)tbl + idx;
+	uint32_t *ptr32 = (uint32_t *)tbl + idx;
+	uint64_t *ptr64 = (uint64_t *)tbl + idx;
+
+	switch (nh_sz) {
+	case RTE_FIB6_TRIE_2B:
+		for (i = 0; i < n; i++)
+			ptr16[i] = (uint16_t)val;
+		break;
+	case RTE_FIB6_TRIE_4B:
+		for (i = 0; i < n; i++)
+			ptr32[i] = (uint32_t)val;
+		break;
+	case RTE_FIB6_TRIE_8B:
+		for (i = 0; i < n; i++)
+			ptr64[i] = val;
+		break;
+	}
+}
+
+static inline void *
+get_tbl8_grp(struct rte_trie_tbl *dp, uint32_t tbl8_idx)
+{
+	return (uint8_t *)dp->tbl8 +
+		(((uint64_t)tbl8_idx * TRIE_TBL8_GRP_NUM_ENT) << dp->nh_sz);
+}
+
+/* Index of the entry of ip in a table of the given level */
+static inline uint32_t
+get_idx(const uint8_t *ip, unsigned int level)
+{
+	return (level == 0) ? get_tbl24_idx(ip) : ip[level + 2];
+}
+
+/* Check if ip is the first address of its entry in the given level */
+static inline int
+is_aligned(const uint8_t *ip, unsigned int level)
+{
+	unsigned int i;
+
+	for (i = level + 3; i < RTE_FIB6_IPV6_ADDR_SIZE; i++) {
+		if (ip[i] != 0)
+			return 0;
+	}
+	return 1;
+}
+
+/*
+ * Take a tbl8 group from the pool, with all its entries set to the
+ * value of the entry it is going to extend.
+ */
+static int32_t
+tbl8_alloc(struct rte_trie_tbl *dp, uint64_t val)
+{
+	uint32_t tbl8_idx;
+
+	if (dp->cur_tbl8s == dp->number_tbl8s)
+		return -ENOSPC;
+
+	tbl8_idx = dp->tbl8_pool[dp->cur_tbl8s++];
+	write_to_dp(get_tbl8_grp(dp, tbl8_idx), 0, val, dp->nh_sz,
+		TRIE_TBL8_GRP_NUM_ENT);
+	return tbl8_idx;
+}
+
+static void
+tbl8_free(struct rte_trie_tbl *dp, uint32_t tbl8_idx)
+{
+	dp->tbl8_pool[--dp->cur_tbl8s] = tbl8_idx;
+}
+
+/* Release a tbl8 group and all the groups of the levels below it */
+static void
+tbl8_free_subtree(struct rte_trie_tbl *dp, uint32_t tbl8_idx)
+{
+	uint32_t i;
+	uint64_t ent;
+	void *grp = get_tbl8_grp(dp, tbl8_idx);
+
+	for (i = 0; i < TRIE_TBL8_GRP_NUM_ENT; i++) {
+		ent = get_tbl_val_by_idx(grp, i, dp->nh_sz);
+		if (is_entry_extended(ent))
+			tbl8_free_subtree(dp, ent >> 1);
+	}
+	tbl8_free(dp, tbl8_idx);
+}
+
+/*
+ * Fold a tbl8 group back into the entry extended by it when all its
+ * entries hold the same next hop.
+ */
+static void
+tbl8_recycle(struct rte_trie_tbl *dp, void *tbl, uint32_t idx,
+	uint32_t tbl8_idx)
+{
+	uint32_t i;
+	uint64_t first;
+	void *grp = get_tbl8_grp(dp, tbl8_idx);
+
+	first = get_tbl_val_by_idx(grp, 0, dp->nh_sz);
+	if (is_entry_extended(first))
+		return;
+	for (i = 1; i < TRIE_TBL8_GRP_NUM_ENT; i++) {
+		if (get_tbl_val_by_idx(grp, i, dp->nh_sz) != first)
+			return;
+	}
+
+	write_to_dp(tbl, idx, first, dp->nh_sz, 1);
+	tbl8_free(dp, tbl8_idx);
+}
+
+/* Write val to the [from, to) entries of a table, releasing their groups */
+static void
+fill_entries(struct rte_trie_tbl *dp, void *tbl, uint32_t from, uint32_t to,
+	uint64_t val)
+{
+	uint32_t i;
+	uint64_t ent;
+
+	for (i = from; i < to; i++) {
+		ent = get_tbl_val_by_idx(tbl, i, dp->nh_sz);
+		write_to_dp(tbl, i, val, dp->nh_sz, 1);
+		if (is_entry_extended(ent))
+			tbl8_free_subtree(dp, ent >> 1);
+	}
+}
+
+static int
+write_range(struct rte_trie_tbl *dp, void *tbl, unsigned int level,
+	const uint8_t *l, const uint8_t *r, uint64_t val);
+
+/*
+ * Write val to the part of the entry idx of a table covered by [l, r),
+ * in the tbl8 group extending it.
+ */
+static int
+write_edge(struct rte_trie_tbl *dp, void *tbl, unsigned int level,
+	uint32_t idx, const uint8_t *l, const uint8_t *r, uint64_t val)
+{
+	uint64_t ent;
+	int32_t tbl8_idx;
+	int ret;
+
+	ent = get_tbl_val_by_idx(tbl, idx, dp->nh_sz);
+	if (is_entry_extended(ent))
+		tbl8_idx = ent >> 1;
+	else {
+		tbl8_idx = tbl8_alloc(dp, ent);
+		if (tbl8_idx < 0)
+			return tbl8_idx;
+		/* the group must be filled before readers can reach it */
+		rte_smp_wmb();
+		write_to_dp(tbl, idx, ((uint64_t)tbl8_idx << 1) | TRIE_EXT_ENT,
+			dp->nh_sz, 1);
+	}
+
+	ret = write_range(dp, get_tbl8_grp(dp, tbl8_idx), level + 1,
+		l, r, val);
+	tbl8_recycle(dp, tbl, idx, tbl8_idx);
+	return ret;
+}
+
+/*
+ * Write val to the [l, r) addresses range of a table of the given level.
+ * NULL edges stand for the beginning and the end of the table span.
+ */
+static int
+write_range(struct rte_trie_tbl *dp, void *tbl, unsigned int level,
+	const uint8_t *l, const uint8_t *r, uint64_t val)
+{
+	uint32_t l_idx, r_idx;
+	int l_part, r_part;
+	int ret;
+
+	l_idx = (l == NULL) ? 0 : get_idx(l, level);
+	r_idx = (r == NULL) ? ((level == 0) ? TRIE_TBL24_NUM_ENT :
+		TRIE_TBL8_GRP_NUM_ENT) : get_idx(r, level);
+	l_part = (l != NULL) && !is_aligned(l, level);
+	r_part = (r != NULL) && !is_aligned(r, level);
+
+	if (l_part && r_part && (l_idx == r_idx))
+		return write_edge(dp, tbl, level, l_idx, l, r, val);
+
+	if (l_part) {
+		ret = write_edge(dp, tbl, level, l_idx, l, NULL, val);
+		if (ret != 0)
+			return ret;
+		l_idx++;
+	}
+
+	fill_entries(dp, tbl, l_idx, r_idx, val);
+
+	if (r_part)
+		return write_edge(dp, tbl, level, r_idx, NULL, r, val);
+	return 0;
+}
+
+/* Advance ip past the ip/depth prefix, returns 1 on address space wrap */
+static int
+get_nxt_net(uint8_t *ip, uint8_t depth)
+{
+	int i;
+	uint8_t inc, prev;
+
+	if (depth == 0)
+		return 1;
+
+	i = (depth - 1) / CHAR_BIT;
+	inc = 1 << (CHAR_BIT - 1 - ((depth - 1) % CHAR_BIT));
+	for (; i >= 0; i--) {
+		prev = ip[i];
+		ip[i] += inc;
+		if (ip[i] > prev)
+			return 0;
+		inc = 1;
+	}
+	return 1;
+}
+
+/*
+ * Make the addresses of ip/depth resolve to next_hop, except the ones
+ * belonging to more specific routes, which are left untouched.
+ */
+static int
+modify_dp(struct rte_trie_tbl *dp, struct rte_rib6 *rib,
+	const uint8_t ip[RTE_FIB6_IPV6_ADDR_SIZE],
+	uint8_t depth, uint64_t next_hop)
+{
+	struct rte_rib6_node *tmp = NULL;
+	uint8_t ledge[RTE_FIB6_IPV6_ADDR_SIZE];
+	uint8_t redge[RTE_FIB6_IPV6_ADDR_SIZE];
+	uint64_t val = next_hop << 1;
+	uint8_t tmp_depth;
+	int ret;
+
+	memcpy(ledge, ip, RTE_FIB6_IPV6_ADDR_SIZE);
+	while ((tmp = rte_rib6_get_nxt(rib, ip, depth, tmp,
+			RTE_RIB6_GET_NXT_COVER)) != NULL) {
+		rte_rib6_get_ip(tmp, redge);
+		rte_rib6_get_depth(tmp, &tmp_depth);
+		if (memcmp(ledge, redge, RTE_FIB6_IPV6_ADDR_SIZE) != 0) {
+			ret = write_range(dp, dp->tbl24, 0, ledge, redge, val);
+			if (ret != 0)
+				return ret;
+		}
+		memcpy(ledge, redge, RTE_FIB6_IPV6_ADDR_SIZE);
+		/* the more specific route ends the address space */
+		if (get_nxt_net(ledge, tmp_depth) != 0)
+			return 0;
+	}
+
+	memcpy(redge, ip, RTE_FIB6_IPV6_ADDR_SIZE);
+	if (get_nxt_net(redge, depth) != 0)
+		return write_range(dp, dp->tbl24, 0, ledge, NULL, val);
+	if (memcmp(ledge, redge, RTE_FIB6_IPV6_ADDR_SIZE) == 0)
+		return 0;
+	return write_range(dp, dp->tbl24, 0, ledge, redge, val);
+}
+
+/*
+ * Number of tbl8 groups reserved for a route, one per level under tbl24
+ * it reaches, so that no update can fail half way through.
+ */
+static inline uint32_t
+get_rsvd_tbl8s(uint8_t depth)
+{
+	if (depth <= 24)
+		return 0;
+	return (RTE_ALIGN_CEIL(depth, CHAR_BIT) - 24) / CHAR_BIT;
+}
+
+int
+trie_modify(struct rte_fib6 *fib, const uint8_t ip[RTE_FIB6_IPV6_ADDR_SIZE],
+	uint8_t depth, uint64_t next_hop, int op)
+{
+	struct rte_trie_tbl *dp;
+	struct rte_rib6 *rib;
+	struct rte_rib6_node *node, *parent;
+	uint8_t ip_masked[RTE_FIB6_IPV6_ADDR_SIZE];
+	uint64_t par_nh, node_nh;
+	uint32_t rsvd;
+	int i, ret = 0;
+
+	if ((fib == NULL) || (ip == NULL) || (depth > RTE_FIB6_MAXDEPTH))
+		return -EINVAL;
+
+	dp = rte_fib6_get_dp(fib);
+	rib = rte_fib6_get_rib(fib);
+	RTE_ASSERT((dp != NULL) && (rib != NULL));
+
+	if (next_hop > get_max_nh(dp->nh_sz))
+		return -EINVAL;
+
+	for (i = 0; i < RTE_FIB6_IPV6_ADDR_SIZE; i++) {
+		if (depth >= (i + 1) * CHAR_BIT)
+			ip_masked[i] = ip[i];
+		else if (depth > i * CHAR_BIT)
+			ip_masked[i] = ip[i] & (uint8_t)(UINT8_MAX <<
+				((i + 1) * CHAR_BIT - depth));
+		else
+			ip_masked[i] = 0;
+	}
+	rsvd = get_rsvd_tbl8s(depth);
+
+	node = rte_rib6_lookup_exact(rib, ip_masked, depth);
+	switch (op) {
+	case RTE_FIB6_ADD:
+		if (node != NULL) {
+			rte_rib6_get_nh(node, &node_nh);
+			if (node_nh == next_hop)
+				return 0;
+			ret = modify_dp(dp, rib, ip_masked, depth, next_hop);
+			if (ret == 0)
+				rte_rib6_set_nh(node, next_hop);
+			return ret;
+		}
+		if (dp->rsvd_tbl8s + rsvd > dp->number_tbl8s)
+			return -ENOSPC;
+
+		node = rte_rib6_insert(rib, ip_masked, depth);
+		if (node == NULL)
+			return -rte_errno;
+		rte_rib6_set_nh(node, next_hop);
+		parent = rte_rib6_lookup_parent(node);
+		if (parent != NULL)
+			rte_rib6_get_nh(parent, &par_nh);
+		else
+			par_nh = dp->def_nh;
+		if (par_nh != next_hop) {
+			ret = modify_dp(dp, rib, ip_masked, depth, next_hop);
+			if (ret != 0) {
+				rte_rib6_remove(rib, ip_masked, depth);
+				return ret;
+			}
+		}
+		dp->rsvd_tbl8s += rsvd;
+		return 0;
+	case RTE_FIB6_DEL:
+		if (node == NULL)
+			return -ENOENT;
+
+		parent = rte_rib6_lookup_parent(node);
+		if (parent != NULL)
+			rte_rib6_get_nh(parent, &par_nh);
+		else
+			par_nh = dp->def_nh;
+		rte_rib6_get_nh(node, &node_nh);
+		if (par_nh != node_nh)
+			ret = modify_dp(dp, rib, ip_masked, depth, par_nh);
+		if (ret != 0)
+			return ret;
+		rte_rib6_remove(rib, ip_masked, depth);
+		dp->rsvd_tbl8s -= rsvd;
+		return 0;
+	default:
+		return -EINVAL;
+	}
+}
+
+void *
+trie_create(const char *name, int socket_id, struct rte_fib6_conf *conf)
+{
+	char mem_name[RTE_FIB6_NAMESIZE];
+	struct rte_trie_tbl *dp;
+	uint64_t def_nh;
+	uint32_t num_tbl8;
+	uint32_t i;
+	enum rte_fib_trie_nh_sz nh_sz;
+
+	if ((name == NULL) || (conf == NULL) ||
+			(conf->trie.nh_sz < RTE_FIB6_TRIE_2B) ||
+			(conf->trie.nh_sz > RTE_FIB6_TRIE_8B) ||
+			(conf->trie.num_tbl8 >
+			get_max_nh(conf->trie.nh_sz)) ||
+			(conf->trie.num_tbl8 == 0) ||
+			(conf->default_nh >
+			get_max_nh(conf->trie.nh_sz))) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	def_nh = conf->default_nh;
+	nh_sz = conf->trie.nh_sz;
+	num_tbl8 = conf->trie.num_tbl8;
+
+	dp = rte_zmalloc_socket(name, sizeof(struct rte_trie_tbl) +
+		TRIE_TBL24_NUM_ENT * (1 << nh_sz), RTE_CACHE_LINE_SIZE,
+		socket_id);
+	if (dp == NULL) {
+		rte_errno = ENOMEM;
+		return NULL;
+	}
+
+	/* Init table with default value */
+	write_to_dp(dp->tbl24, 0, def_nh << 1, nh_sz, TRIE_TBL24_NUM_ENT);
+
+	snprintf(mem_name, sizeof(mem_name), "TBL8_%p", dp);
+	dp->tbl8 = rte_zmalloc_socket(mem_name, TRIE_TBL8_GRP_NUM_ENT *
+		((uint64_t)num_tbl8 << nh_sz), RTE_CACHE_LINE_SIZE,
+		socket_id);
+	if (dp->tbl8 == NULL) {
+		rte_errno = ENOMEM;
+		rte_free(dp);
+		return NULL;
+	}
+
+	snprintf(mem_name, sizeof(mem_name), "TBL8_idxes_%p", dp);
+	dp->tbl8_pool = rte_malloc_socket(mem_name,
+		sizeof(uint32_t) * num_tbl8, RTE_CACHE_LINE_SIZE, socket_id);
+	if (dp->tbl8_pool == NULL) {
+		rte_errno = ENOMEM;
+		rte_free(dp->tbl8);
+		rte_free(dp);
+		return NULL;
+	}
+	for (i = 0; i < num_tbl8; i++)
+		dp->tbl8_pool[i] = i;
+
+	dp->def_nh = def_nh;
+	dp->nh_sz = nh_sz;
+	dp->number_tbl8s = num_tbl8;
+
+	return dp;
+}
+
+void
+trie_free(void *p)
+{
+	struct rte_trie_tbl *dp = (struct rte_trie_tbl *)p;
+
+	if (dp == NULL)
+		return;
+
+	rte_free(dp->tbl8_pool);
+	rte_free(dp->tbl8);
+	rte_free(dp);
+}
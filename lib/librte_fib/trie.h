@@ -0,0 +1,78 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2018 Intel Corporation
+ */
+
+#ifndef _TRIE_H_
+#define _TRIE_H_
+
+/**
+ * @file
+ * Multibit trie dataplane structure of the IPv6 FIB.
+ *
+ * The 3 most significant bytes of an address index tbl24, each following
+ * byte indexes a tbl8 group of 256 entries. An entry holds either the next
+ * hop, or with its least significant bit set the index of the tbl8 group
+ * of the next level.
+ */
+
+#include <rte_memory.h>
+#include <rte_prefetch.h>
+#include <rte_branch_prediction.h>
+
+#include "rte_fib6.h"
+
+#define TRIE_TBL24_NUM_ENT		(1 << 24)
+#define TRIE_TBL8_GRP_NUM_ENT		256U
+#define TRIE_EXT_ENT			1
+/* Number of tbl8 levels under tbl24 */
+#define TRIE_TBL8_LEVELS		(RTE_FIB6_IPV6_ADDR_SIZE - 3)
+
+struct rte_trie_tbl {
+	uint32_t	number_tbl8s;	/**< Total number of tbl8s */
+	uint32_t	rsvd_tbl8s;	/**< Number of reserved tbl8s */
+	uint32_t	cur_tbl8s;	/**< Current number of tbl8s */
+	uint64_t	def_nh;		/**< Default next hop */
+	enum rte_fib_trie_nh_sz	nh_sz;	/**< Size of nexthop entry */
+	uint64_t	*tbl8;		/**< tbl8 table. */
+	uint32_t	*tbl8_pool;	/**< Stack of free tbl8 indexes */
+	uint64_t	tbl24[0] __rte_cache_aligned; /**< tbl24 table */
+};
+
+static inline uint32_t
+get_tbl24_idx(const uint8_t *ip)
+{
+	return ip[0] << 16 | ip[1] << 8 | ip[2];
+}
+
+static inline void *
+get_tbl24_p(struct rte_trie_tbl *dp, const uint8_t *ip, uint8_t nh_sz)
+{
+	return (void *)&((uint8_t *)dp->tbl24)[get_tbl24_idx(ip) << nh_sz];
+}
+
+static inline uint64_t
+get_max_nh(uint8_t nh_sz)
+{
+	return (UINT64_MAX >> (64 - (8 << nh_sz))) >> 1;
+}
+
+static inline int
+is_entry_extended(uint64_t ent)
+{
+	return (ent & TRIE_EXT_ENT) == TRIE_EXT_ENT;
+}
+
+void *
+trie_create(const char *name, int socket_id, struct rte_fib6_conf *conf);
+
+void
+trie_free(void *p);
+
+rte_fib6_lookup_fn_t
+trie_get_lookup_fn(void *p);
+
+int
+trie_modify(struct rte_fib6 *fib, const uint8_t ip[RTE_FIB6_IPV6_ADDR_SIZE],
+	uint8_t depth, uint64_t next_hop, int op);
+
+#endif /* _TRIE_H_ */
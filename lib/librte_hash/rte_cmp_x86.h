@@ -13,6 +13,17 @@ rte_hash_k16_cmp_eq(const void *key1, const void *key2, size_t key_len __rte_unu
 	return !_mm_test_all_zeros(x, x);
 }
 
+#ifdef RTE_MACHINE_CPUFLAG_AVX2
+static int
+rte_hash_k32_cmp_eq(const void *key1, const void *key2, size_t key_len __rte_unused)
+{
+	const __m256i k1 = _mm256_loadu_si256((const __m256i *) key1);
+	const __m256i k2 = _mm256_loadu_si256((const __m256i *) key2);
+	const __m256i x = _mm256_xor_si256(k1, k2);
+
+	return !_mm256_testz_si256(x, x);
+}
+#else
 static int
 rte_hash_k32_cmp_eq(const void *key1, const void *key2, size_t key_len)
 {
@@ -20,6 +31,7 @@ rte_hash_k32_cmp_eq(const void *key1, const void *key2, size_t key_len)
 		rte_hash_k16_cmp_eq((const char *) key1 + 16,
 				(const char *) key2 + 16, key_len);
 }
+#endif
 
 static int
 rte_hash_k48_cmp_eq(const void *key1, const void *key2, size_t key_len)
@@ -27,13 +27,17 @@
 #include <rte_ring.h>
 #include <rte_compat.h>
 #include <rte_pause.h>
+#include <rte_cycles.h>
 
 #include "rte_hash.h"
 #include "rte_cuckoo_hash.h"
 
-#if defined(RTE_ARCH_X86)
-#include "rte_cuckoo_hash_x86.h"
-#endif
+/* Walk a bucket and the extendable buckets chained to it */
+#define FOR_EACH_BUCKET(CURRENT_BKT, START_BUCKET)                            \
+	for (CURRENT_BKT = START_BUCKET;                                      \
+		CURRENT_BKT != NULL;                                          \
+		CURRENT_BKT = __atomic_load_n(&CURRENT_BKT->next,             \
+					__ATOMIC_ACQUIRE))
 
 TAILQ_HEAD(rte_hash_list, rte_tailq_entry);
 
@@ -88,12 +92,21 @@ rte_hash_create(const struct rte_hash_parameters *params)
 	struct rte_tailq_entry *te = NULL;
 	struct rte_hash_list *hash_list;
 	struct rte_ring *r = NULL;
+	struct rte_ring *r_ext = NULL;
 	char hash_name[RTE_HASH_NAMESIZE];
 	void *k = NULL;
 	void *buckets = NULL;
+	void *buckets_ext = NULL;
+	uint32_t *ext_bkt_to_free = NULL;
 	char ring_name[RTE_RING_NAMESIZE];
+	char ext_ring_name[RTE_RING_NAMESIZE];
 	unsigned num_key_slots;
 	unsigned hw_trans_mem_support = 0;
+	unsigned int readwrite_concur_lf_support = 0;
+	unsigned int no_free_on_del = 0;
+	unsigned int ext_table_support = 0;
+	unsigned int aging_support = 0;
+	uint32_t key_entry_size;
 	unsigned i;
 	rte_hash_function default_hash_func = (rte_hash_function)rte_jhash;
 
@@ -118,6 +131,24 @@ rte_hash_create(const struct rte_hash_parameters *params)
 	if (params->extra_flag & RTE_HASH_EXTRA_FLAGS_TRANS_MEM_SUPPORT)
 		hw_trans_mem_support = 1;
 
+	if (params->extra_flag & RTE_HASH_EXTRA_FLAGS_EXT_TABLE)
+		ext_table_support = 1;
+
+	if (params->extra_flag & RTE_HASH_EXTRA_FLAGS_NO_FREE_ON_DEL)
+		no_free_on_del = 1;
+
+	if (params->extra_flag & RTE_HASH_EXTRA_FLAGS_AGING)
+		aging_support = 1;
+
+	/*
+	 * Lock free readers may still be comparing a deleted key,
+	 * so its slot can only be reused once the application says so.
+	 */
+	if (params->extra_flag & RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY_LF) {
+		readwrite_concur_lf_support = 1;
+		no_free_on_del = 1;
+	}
+
 	/* Store all keys and leave the first entry as a dummy entry for lookup_bulk */
 	if (hw_trans_mem_support)
 		/*
@@ -131,14 +162,40 @@ rte_hash_create(const struct rte_hash_parameters *params)
 		num_key_slots = params->entries + 1;
 
 	snprintf(ring_name, sizeof(ring_name), "HT_%s", params->name);
-	/* Create ring (Dummy slot index is not enqueued) */
-	r = rte_ring_create(ring_name, rte_align32pow2(num_key_slots - 1),
+	/*
+	 * Create ring (Dummy slot index is not enqueued). A ring holds one
+	 * object less than its size, make room for all the entries.
+	 */
+	r = rte_ring_create(ring_name, rte_align32pow2(num_key_slots),
 			params->socket_id, 0);
 	if (r == NULL) {
 		RTE_LOG(ERR, HASH, "memory allocation failed\n");
 		goto err;
 	}
 
+	/* A bucket is read with a single cache line access */
+	RTE_BUILD_BUG_ON(sizeof(struct rte_hash_bucket) > RTE_CACHE_LINE_SIZE);
+
+	const uint32_t num_buckets = rte_align32pow2(params->entries)
+					/ RTE_HASH_BUCKET_ENTRIES;
+
+	/*
+	 * As many extendable buckets as main buckets, enough to hold
+	 * all the keys even if none of them fits in the main table.
+	 */
+	if (ext_table_support) {
+		snprintf(ext_ring_name, sizeof(ext_ring_name), "HT_EXT_%s",
+								params->name);
+		r_ext = rte_ring_create(ext_ring_name,
+				rte_align32pow2(num_buckets + 1),
+				params->socket_id, 0);
+		if (r_ext == NULL) {
+			RTE_LOG(ERR, HASH, "ext buckets memory allocation "
+								"failed\n");
+			goto err;
+		}
+	}
+
 	snprintf(hash_name, sizeof(hash_name), "HT_%s", params->name);
 
 	rte_rwlock_write_lock(RTE_EAL_TAILQ_RWLOCK);
@@ -171,9 +228,6 @@ rte_hash_create(const struct rte_hash_parameters *params)
 		goto err_unlock;
 	}
 
-	const uint32_t num_buckets = rte_align32pow2(params->entries)
-					/ RTE_HASH_BUCKET_ENTRIES;
-
 	buckets = rte_zmalloc_socket(NULL,
 				num_buckets * sizeof(struct rte_hash_bucket),
 				RTE_CACHE_LINE_SIZE, params->socket_id);
@@ -183,7 +237,39 @@ rte_hash_create(const struct rte_hash_parameters *params)
 		goto err_unlock;
 	}
 
-	const uint32_t key_entry_size = sizeof(struct rte_hash_key) + params->key_len;
+	if (ext_table_support) {
+		buckets_ext = rte_zmalloc_socket(NULL,
+				num_buckets * sizeof(struct rte_hash_bucket),
+				RTE_CACHE_LINE_SIZE, params->socket_id);
+		if (buckets_ext == NULL) {
+			RTE_LOG(ERR, HASH, "ext buckets memory allocation "
+							"failed\n");
+			goto err_unlock;
+		}
+		/* Populate ext bkt ring. Index zero means no bucket. */
+		for (i = 1; i <= num_buckets; i++)
+			rte_ring_sp_enqueue(r_ext, (void *)((uintptr_t) i));
+
+		/*
+		 * Lock free readers may still walk an emptied bucket, so it
+		 * is recycled with the key index of the deleted entry.
+		 */
+		if (readwrite_concur_lf_support) {
+			ext_bkt_to_free = rte_zmalloc(NULL,
+				sizeof(uint32_t) * (params->entries + 1), 0);
+			if (ext_bkt_to_free == NULL) {
+				RTE_LOG(ERR, HASH, "ext bkt to free memory "
+							"allocation failed\n");
+				goto err_unlock;
+			}
+		}
+	}
+
+	key_entry_size = sizeof(struct rte_hash_key) + params->key_len;
+	/* The timestamp is the last, naturally aligned, field of the entry */
+	if (aging_support)
+		key_entry_size = RTE_ALIGN(key_entry_size, sizeof(uint64_t)) +
+				sizeof(uint64_t);
 	const uint64_t key_tbl_size = (uint64_t) key_entry_size * num_key_slots;
 
 	k = rte_zmalloc_socket(NULL, key_tbl_size,
@@ -261,21 +347,41 @@ rte_hash_create(const struct rte_hash_parameters *params)
 	h->key_store = k;
 	h->free_slots = r;
 	h->hw_trans_mem_support = hw_trans_mem_support;
+	h->readwrite_concur_lf_support = readwrite_concur_lf_support;
+	h->no_free_on_del = no_free_on_del;
+	h->ext_table_support = ext_table_support;
+	h->buckets_ext = buckets_ext;
+	h->free_ext_bkts = r_ext;
+	h->ext_bkt_to_free = ext_bkt_to_free;
+	h->aging_support = aging_support;
 
 #if defined(RTE_ARCH_X86)
+#ifdef CC_AVX512_SUPPORT
+	if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX512BW) &&
+			rte_cpu_get_flag_enabled(RTE_CPUFLAG_BMI2))
+		h->sig_cmp_fn = RTE_HASH_COMPARE_AVX512;
+	else
+#endif
+#ifdef RTE_MACHINE_CPUFLAG_AVX2
 	if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX2))
 		h->sig_cmp_fn = RTE_HASH_COMPARE_AVX2;
-	else if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_SSE2))
+	else
+#endif
+	if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_SSE2))
 		h->sig_cmp_fn = RTE_HASH_COMPARE_SSE;
 	else
 #endif
 		h->sig_cmp_fn = RTE_HASH_COMPARE_SCALAR;
 
 	/* Turn on multi-writer only with explicit flat from user and TM
-	 * support.
+	 * support. The TM cuckoo path does not publish bucket changes to
+	 * lock free readers, nor handles extendable buckets, so use the
+	 * spinlock in these modes.
 	 */
 	if (params->extra_flag & RTE_HASH_EXTRA_FLAGS_MULTI_WRITER_ADD) {
-		if (h->hw_trans_mem_support) {
+		if (h->hw_trans_mem_support &&
+				!h->readwrite_concur_lf_support &&
+				!h->ext_table_support) {
 			h->add_key = ADD_KEY_MULTIWRITER_TM;
 		} else {
 			h->add_key = ADD_KEY_MULTIWRITER;
@@ -300,9 +406,12 @@ rte_hash_create(const struct rte_hash_parameters *params)
 	rte_rwlock_write_unlock(RTE_EAL_TAILQ_RWLOCK);
 err:
 	rte_ring_free(r);
+	rte_ring_free(r_ext);
 	rte_free(te);
 	rte_free(h);
 	rte_free(buckets);
+	rte_free(buckets_ext);
+	rte_free(ext_bkt_to_free);
 	rte_free(k);
 	return NULL;
 }
@@ -341,8 +450,11 @@ rte_hash_free(struct rte_hash *h)
 	if (h->add_key == ADD_KEY_MULTIWRITER)
 		rte_free(h->multiwriter_lock);
 	rte_ring_free(h->free_slots);
+	rte_ring_free(h->free_ext_bkts);
 	rte_free(h->key_store);
 	rte_free(h->buckets);
+	rte_free(h->buckets_ext);
+	rte_free(h->ext_bkt_to_free);
 	rte_free(h);
 	rte_free(te);
 }
@@ -354,18 +466,51 @@ rte_hash_hash(const struct rte_hash *h, const void *key)
 	return h->hash_func(key, h->key_len, h->hash_func_init_val);
 }
 
-/* Calc the secondary hash value from the primary hash value of a given key */
-static inline hash_sig_t
-rte_hash_secondary_hash(const hash_sig_t primary_hash)
+/*
+ * Buckets only store the 16 most significant bits of the hash, while the
+ * least significant bits select the primary bucket. The alternative bucket
+ * of an entry is derived from its current bucket and its short signature
+ * (partial-key cuckoo hashing), so entries can be pushed between buckets
+ * without knowing their full hash.
+ */
+static inline uint16_t
+get_short_sig(const hash_sig_t hash)
 {
-	static const unsigned all_bits_shift = 12;
-	static const unsigned alt_bits_xor = 0x5bd1e995;
+	return hash >> 16;
+}
 
-	uint32_t tag = primary_hash >> all_bits_shift;
+static inline uint32_t
+get_prim_bucket_index(const struct rte_hash *h, const hash_sig_t hash)
+{
+	return hash & h->bucket_bitmask;
+}
+
+static inline uint32_t
+get_alt_bucket_index(const struct rte_hash *h,
+			uint32_t cur_bkt_idx, uint16_t sig)
+{
+	return (cur_bkt_idx ^ sig) & h->bucket_bitmask;
+}
 
-	return primary_hash ^ ((tag + 1) * alt_bits_xor);
+/* Last access timestamp of a key, stored at the end of its key entry */
+static inline uint64_t *
+key_timestamp(const struct rte_hash *h, const struct rte_hash_key *k)
+{
+	return RTE_PTR_ADD(k, h->key_entry_size - sizeof(uint64_t));
 }
 
+static inline void
+key_touch(const struct rte_hash *h, const struct rte_hash_key *k,
+		uint64_t now)
+{
+	/* Lookups from several lcores may race, any of the values is fine */
+	__atomic_store_n(key_timestamp(h, k), now, __ATOMIC_RELAXED);
+}
+
+#if defined(RTE_ARCH_X86)
+#include "rte_cuckoo_hash_x86.h"
+#endif
+
 void
 rte_hash_reset(struct rte_hash *h)
 {
@@ -386,6 +531,23 @@ rte_hash_reset(struct rte_hash *h)
 	for (i = 1; i < h->entries + 1; i++)
 		rte_ring_sp_enqueue(h->free_slots, (void *)((uintptr_t) i));
 
+	if (h->ext_table_support) {
+		memset(h->buckets_ext, 0,
+			h->num_buckets * sizeof(struct rte_hash_bucket));
+
+		while (rte_ring_dequeue(h->free_ext_bkts, &ptr) == 0)
+			rte_pause();
+
+		/* Repopulate the free ext bkt ring. */
+		for (i = 1; i <= h->num_buckets; i++)
+			rte_ring_sp_enqueue(h->free_ext_bkts,
+						(void *)((uintptr_t) i));
+
+		if (h->ext_bkt_to_free != NULL)
+			memset(h->ext_bkt_to_free, 0,
+				sizeof(uint32_t) * (h->entries + 1));
+	}
+
 	if (h->hw_trans_mem_support) {
 		/* Reset local caches per lcore */
 		for (i = 0; i < RTE_MAX_LCORE; i++)
@@ -393,6 +555,20 @@ rte_hash_reset(struct rte_hash *h)
 	}
 }
 
+/*
+ * Signal lock free readers that an entry is about to be moved out of bkt.
+ * The entry has already been copied to its alternative bucket, so a reader
+ * that misses it in both buckets finds the change counter modified and
+ * searches again.
+ */
+static inline void
+bucket_entry_moving(struct rte_hash_bucket *bkt)
+{
+	__atomic_store_n(&bkt->chng_cnt, bkt->chng_cnt + 1, __ATOMIC_RELEASE);
+	/* The new count has to be visible before the slot is overwritten */
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
 /* Search for an entry that can be pushed to its alternative location */
 static inline int
 make_space_bucket(const struct rte_hash *h, struct rte_hash_bucket *bkt,
@@ -401,6 +577,7 @@ make_space_bucket(const struct rte_hash *h, struct rte_hash_bucket *bkt,
 	unsigned i, j;
 	int ret;
 	uint32_t next_bucket_idx;
+	uint32_t cur_bkt_idx = bkt - h->buckets;
 	struct rte_hash_bucket *next_bkt[RTE_HASH_BUCKET_ENTRIES];
 
 	/*
@@ -409,7 +586,8 @@ make_space_bucket(const struct rte_hash *h, struct rte_hash_bucket *bkt,
 	 */
 	for (i = 0; i < RTE_HASH_BUCKET_ENTRIES; i++) {
 		/* Search for space in alternative locations */
-		next_bucket_idx = bkt->sig_alt[i] & h->bucket_bitmask;
+		next_bucket_idx = get_alt_bucket_index(h, cur_bkt_idx,
+						bkt->sig_current[i]);
 		next_bkt[i] = &h->buckets[next_bucket_idx];
 		for (j = 0; j < RTE_HASH_BUCKET_ENTRIES; j++) {
 			if (next_bkt[i]->key_idx[j] == EMPTY_SLOT)
@@ -422,15 +600,16 @@ make_space_bucket(const struct rte_hash *h, struct rte_hash_bucket *bkt,
 
 	/* Alternative location has spare room (end of recursive function) */
 	if (i != RTE_HASH_BUCKET_ENTRIES) {
-		next_bkt[i]->sig_alt[j] = bkt->sig_current[i];
-		next_bkt[i]->sig_current[j] = bkt->sig_alt[i];
-		next_bkt[i]->key_idx[j] = bkt->key_idx[i];
+		next_bkt[i]->sig_current[j] = bkt->sig_current[i];
+		/* Publish the copy before the entry is overwritten in bkt */
+		__atomic_store_n(&next_bkt[i]->key_idx[j], bkt->key_idx[i],
+				__ATOMIC_RELEASE);
 		return i;
 	}
 
 	/* Pick entry that has not been pushed yet */
 	for (i = 0; i < RTE_HASH_BUCKET_ENTRIES; i++)
-		if (bkt->flag[i] == 0)
+		if (!(bkt->flag & (1 << i)))
 			break;
 
 	/* All entries have been pushed, so entry cannot be added */
@@ -438,7 +617,7 @@ make_space_bucket(const struct rte_hash *h, struct rte_hash_bucket *bkt,
 		return -ENOSPC;
 
 	/* Set flag to indicate that this entry is going to be pushed */
-	bkt->flag[i] = 1;
+	bkt->flag |= 1 << i;
 
 	/* Need room in alternative bucket to insert the pushed entry */
 	ret = make_space_bucket(h, next_bkt[i], nr_pushes);
@@ -448,11 +627,13 @@ make_space_bucket(const struct rte_hash *h, struct rte_hash_bucket *bkt,
 	 * in its alternative location if successful,
 	 * or return error
 	 */
-	bkt->flag[i] = 0;
+	bkt->flag &= ~(1 << i);
 	if (ret >= 0) {
-		next_bkt[i]->sig_alt[ret] = bkt->sig_current[i];
-		next_bkt[i]->sig_current[ret] = bkt->sig_alt[i];
-		next_bkt[i]->key_idx[ret] = bkt->key_idx[i];
+		/* Entry in slot ret was copied to its alternative bucket */
+		bucket_entry_moving(next_bkt[i]);
+		next_bkt[i]->sig_current[ret] = bkt->sig_current[i];
+		__atomic_store_n(&next_bkt[i]->key_idx[ret], bkt->key_idx[i],
+				__ATOMIC_RELEASE);
 		return i;
 	} else
 		return ret;
@@ -480,12 +661,14 @@ static inline int32_t
 __rte_hash_add_key_with_hash(const struct rte_hash *h, const void *key,
 						hash_sig_t sig, void *data)
 {
-	hash_sig_t alt_hash;
+	uint16_t short_sig;
 	uint32_t prim_bucket_idx, sec_bucket_idx;
 	unsigned i;
-	struct rte_hash_bucket *prim_bkt, *sec_bkt;
+	struct rte_hash_bucket *prim_bkt, *sec_bkt, *cur_bkt, *last_bkt;
+	struct rte_hash_bucket *new_bkt;
 	struct rte_hash_key *new_k, *k, *keys = h->key_store;
 	void *slot_id = NULL;
+	void *ext_bkt_id;
 	uint32_t new_idx;
 	int ret;
 	unsigned n_slots;
@@ -496,12 +679,12 @@ __rte_hash_add_key_with_hash(const struct rte_hash *h, const void *key,
 	if (h->add_key == ADD_KEY_MULTIWRITER)
 		rte_spinlock_lock(h->multiwriter_lock);
 
-	prim_bucket_idx = sig & h->bucket_bitmask;
+	short_sig = get_short_sig(sig);
+	prim_bucket_idx = get_prim_bucket_index(h, sig);
 	prim_bkt = &h->buckets[prim_bucket_idx];
 	rte_prefetch0(prim_bkt);
 
-	alt_hash = rte_hash_secondary_hash(sig);
-	sec_bucket_idx = alt_hash & h->bucket_bitmask;
+	sec_bucket_idx = get_alt_bucket_index(h, prim_bucket_idx, short_sig);
 	sec_bkt = &h->buckets[sec_bucket_idx];
 	rte_prefetch0(sec_bkt);
 
@@ -539,15 +722,18 @@ __rte_hash_add_key_with_hash(const struct rte_hash *h, const void *key,
 
 	/* Check if key is already inserted in primary location */
 	for (i = 0; i < RTE_HASH_BUCKET_ENTRIES; i++) {
-		if (prim_bkt->sig_current[i] == sig &&
-				prim_bkt->sig_alt[i] == alt_hash) {
+		if (prim_bkt->sig_current[i] == short_sig &&
+				prim_bkt->key_idx[i] != EMPTY_SLOT) {
 			k = (struct rte_hash_key *) ((char *)keys +
 					prim_bkt->key_idx[i] * h->key_entry_size);
 			if (rte_hash_cmp_eq(key, k->key, h) == 0) {
 				/* Enqueue index of free slot back in the ring. */
 				enqueue_slot_back(h, cached_free_slots, slot_id);
 				/* Update data */
-				k->pdata = data;
+				__atomic_store_n(&k->pdata, data,
+						__ATOMIC_RELEASE);
+				if (h->aging_support)
+					key_touch(h, k, rte_rdtsc());
 				/*
 				 * Return index where key is stored,
 				 * subtracting the first dummy index
@@ -559,47 +745,55 @@ __rte_hash_add_key_with_hash(const struct rte_hash *h, const void *key,
 	}
 
 	/* Check if key is already inserted in secondary location */
-	for (i = 0; i < RTE_HASH_BUCKET_ENTRIES; i++) {
-		if (sec_bkt->sig_alt[i] == sig &&
-				sec_bkt->sig_current[i] == alt_hash) {
-			k = (struct rte_hash_key *) ((char *)keys +
-					sec_bkt->key_idx[i] * h->key_entry_size);
-			if (rte_hash_cmp_eq(key, k->key, h) == 0) {
-				/* Enqueue index of free slot back in the ring. */
-				enqueue_slot_back(h, cached_free_slots, slot_id);
-				/* Update data */
-				k->pdata = data;
-				/*
-				 * Return index where key is stored,
-				 * subtracting the first dummy index
-				 */
-				ret = sec_bkt->key_idx[i] - 1;
-				goto failure;
+	FOR_EACH_BUCKET(cur_bkt, sec_bkt) {
+		for (i = 0; i < RTE_HASH_BUCKET_ENTRIES; i++) {
+			if (cur_bkt->sig_current[i] == short_sig &&
+					cur_bkt->key_idx[i] != EMPTY_SLOT) {
+				k = (struct rte_hash_key *) ((char *)keys +
+					cur_bkt->key_idx[i] * h->key_entry_size);
+				if (rte_hash_cmp_eq(key, k->key, h) == 0) {
+					/* Enqueue index of free slot back in the ring. */
+					enqueue_slot_back(h, cached_free_slots,
+							slot_id);
+					/* Update data */
+					__atomic_store_n(&k->pdata, data,
+							__ATOMIC_RELEASE);
+					if (h->aging_support)
+						key_touch(h, k, rte_rdtsc());
+					/*
+					 * Return index where key is stored,
+					 * subtracting the first dummy index
+					 */
+					ret = cur_bkt->key_idx[i] - 1;
+					goto failure;
+				}
 			}
 		}
 	}
 
-	/* Copy key */
+	/* Copy key, it is published to readers by the key_idx store */
 	rte_memcpy(new_k->key, key, h->key_len);
 	new_k->pdata = data;
+	if (h->aging_support)
+		key_touch(h, new_k, rte_rdtsc());
 
 #if defined(RTE_ARCH_X86) /* currently only x86 support HTM */
 	if (h->add_key == ADD_KEY_MULTIWRITER_TM) {
 		ret = rte_hash_cuckoo_insert_mw_tm(prim_bkt,
-				sig, alt_hash, new_idx);
+				short_sig, new_idx);
 		if (ret >= 0)
 			return new_idx - 1;
 
 		/* Primary bucket full, need to make space for new entry */
-		ret = rte_hash_cuckoo_make_space_mw_tm(h, prim_bkt, sig,
-							alt_hash, new_idx);
+		ret = rte_hash_cuckoo_make_space_mw_tm(h, prim_bkt, short_sig,
+							new_idx);
 
 		if (ret >= 0)
 			return new_idx - 1;
 
 		/* Also search secondary bucket to get better occupancy */
-		ret = rte_hash_cuckoo_make_space_mw_tm(h, sec_bkt, sig,
-							alt_hash, new_idx);
+		ret = rte_hash_cuckoo_make_space_mw_tm(h, sec_bkt, short_sig,
+							new_idx);
 
 		if (ret >= 0)
 			return new_idx - 1;
@@ -608,9 +802,9 @@ __rte_hash_add_key_with_hash(const struct rte_hash *h, const void *key,
 		for (i = 0; i < RTE_HASH_BUCKET_ENTRIES; i++) {
 			/* Check if slot is available */
 			if (likely(prim_bkt->key_idx[i] == EMPTY_SLOT)) {
-				prim_bkt->sig_current[i] = sig;
-				prim_bkt->sig_alt[i] = alt_hash;
-				prim_bkt->key_idx[i] = new_idx;
+				prim_bkt->sig_current[i] = short_sig;
+				__atomic_store_n(&prim_bkt->key_idx[i],
+						new_idx, __ATOMIC_RELEASE);
 				break;
 			}
 		}
@@ -629,9 +823,10 @@ __rte_hash_add_key_with_hash(const struct rte_hash *h, const void *key,
 		 */
 		ret = make_space_bucket(h, prim_bkt, &nr_pushes);
 		if (ret >= 0) {
-			prim_bkt->sig_current[ret] = sig;
-			prim_bkt->sig_alt[ret] = alt_hash;
-			prim_bkt->key_idx[ret] = new_idx;
+			bucket_entry_moving(prim_bkt);
+			prim_bkt->sig_current[ret] = short_sig;
+			__atomic_store_n(&prim_bkt->key_idx[ret], new_idx,
+					__ATOMIC_RELEASE);
 			if (h->add_key == ADD_KEY_MULTIWRITER)
 				rte_spinlock_unlock(h->multiwriter_lock);
 			return new_idx - 1;
@@ -639,6 +834,45 @@ __rte_hash_add_key_with_hash(const struct rte_hash *h, const void *key,
 #if defined(RTE_ARCH_X86)
 	}
 #endif
+
+	if (!h->ext_table_support)
+		goto failure_slot_back;
+
+	/*
+	 * No room in the main table, use the chain of extendable buckets
+	 * of the secondary bucket, in which the new key is looked up last.
+	 */
+	last_bkt = sec_bkt;
+	FOR_EACH_BUCKET(cur_bkt, sec_bkt->next) {
+		for (i = 0; i < RTE_HASH_BUCKET_ENTRIES; i++) {
+			if (cur_bkt->key_idx[i] == EMPTY_SLOT) {
+				cur_bkt->sig_current[i] = short_sig;
+				__atomic_store_n(&cur_bkt->key_idx[i], new_idx,
+						__ATOMIC_RELEASE);
+				if (h->add_key == ADD_KEY_MULTIWRITER)
+					rte_spinlock_unlock(h->multiwriter_lock);
+				return new_idx - 1;
+			}
+		}
+		last_bkt = cur_bkt;
+	}
+
+	/* All chained buckets are full, link a new one */
+	if (rte_ring_sc_dequeue(h->free_ext_bkts, &ext_bkt_id) != 0) {
+		ret = -ENOSPC;
+		goto failure_slot_back;
+	}
+	new_bkt = &h->buckets_ext[(uint32_t)((uintptr_t)ext_bkt_id) - 1];
+	new_bkt->next = NULL;
+	new_bkt->sig_current[0] = short_sig;
+	new_bkt->key_idx[0] = new_idx;
+	/* The new bucket is complete before readers can reach it */
+	__atomic_store_n(&last_bkt->next, new_bkt, __ATOMIC_RELEASE);
+	if (h->add_key == ADD_KEY_MULTIWRITER)
+		rte_spinlock_unlock(h->multiwriter_lock);
+	return new_idx - 1;
+
+failure_slot_back:
 	/* Error in addition, store new slot back in the ring and return error */
 	enqueue_slot_back(h, cached_free_slots, (void *)((uintptr_t) new_idx));
 
@@ -690,59 +924,98 @@ rte_hash_add_key_data(const struct rte_hash *h, const void *key, void *data)
 	else
 		return ret;
 }
-static inline int32_t
-__rte_hash_lookup_with_hash(const struct rte_hash *h, const void *key,
-					hash_sig_t sig, void **data)
+/*
+ * Search one bucket for a key whose short signature is sig.
+ * Returns the key index, or EMPTY_SLOT if not found.
+ */
+static inline uint32_t
+search_one_bucket(const struct rte_hash *h, const void *key, uint16_t sig,
+		const struct rte_hash_bucket *bkt, void **data)
 {
-	uint32_t bucket_idx;
-	hash_sig_t alt_hash;
-	unsigned i;
-	struct rte_hash_bucket *bkt;
+	unsigned int i;
+	uint32_t key_idx;
 	struct rte_hash_key *k, *keys = h->key_store;
 
-	bucket_idx = sig & h->bucket_bitmask;
-	bkt = &h->buckets[bucket_idx];
-
-	/* Check if key is in primary location */
 	for (i = 0; i < RTE_HASH_BUCKET_ENTRIES; i++) {
-		if (bkt->sig_current[i] == sig &&
-				bkt->key_idx[i] != EMPTY_SLOT) {
+		if (bkt->sig_current[i] == sig) {
+			/* Pairs with the writer's release of key_idx,
+			 * so the key contents are visible.
+			 */
+			key_idx = __atomic_load_n(&bkt->key_idx[i],
+					__ATOMIC_ACQUIRE);
+			if (key_idx == EMPTY_SLOT)
+				continue;
 			k = (struct rte_hash_key *) ((char *)keys +
-					bkt->key_idx[i] * h->key_entry_size);
+					key_idx * h->key_entry_size);
 			if (rte_hash_cmp_eq(key, k->key, h) == 0) {
 				if (data != NULL)
-					*data = k->pdata;
-				/*
-				 * Return index where key is stored,
-				 * subtracting the first dummy index
-				 */
-				return bkt->key_idx[i] - 1;
+					*data = __atomic_load_n(&k->pdata,
+							__ATOMIC_ACQUIRE);
+				if (h->aging_support)
+					key_touch(h, k, rte_rdtsc());
+				return key_idx;
 			}
 		}
 	}
 
-	/* Calculate secondary hash */
-	alt_hash = rte_hash_secondary_hash(sig);
-	bucket_idx = alt_hash & h->bucket_bitmask;
-	bkt = &h->buckets[bucket_idx];
+	return EMPTY_SLOT;
+}
 
-	/* Check if key is in secondary location */
-	for (i = 0; i < RTE_HASH_BUCKET_ENTRIES; i++) {
-		if (bkt->sig_current[i] == alt_hash &&
-				bkt->sig_alt[i] == sig) {
-			k = (struct rte_hash_key *) ((char *)keys +
-					bkt->key_idx[i] * h->key_entry_size);
-			if (rte_hash_cmp_eq(key, k->key, h) == 0) {
-				if (data != NULL)
-					*data = k->pdata;
-				/*
-				 * Return index where key is stored,
-				 * subtracting the first dummy index
-				 */
-				return bkt->key_idx[i] - 1;
-			}
+static inline int32_t
+__rte_hash_lookup_with_hash(const struct rte_hash *h, const void *key,
+					hash_sig_t sig, void **data)
+{
+	uint32_t prim_bucket_idx, sec_bucket_idx;
+	uint16_t short_sig;
+	struct rte_hash_bucket *prim_bkt, *sec_bkt, *cur_bkt;
+	uint32_t prim_cnt = 0, sec_cnt = 0;
+	uint32_t key_idx;
+
+	short_sig = get_short_sig(sig);
+	prim_bucket_idx = get_prim_bucket_index(h, sig);
+	sec_bucket_idx = get_alt_bucket_index(h, prim_bucket_idx, short_sig);
+	prim_bkt = &h->buckets[prim_bucket_idx];
+	sec_bkt = &h->buckets[sec_bucket_idx];
+
+	do {
+		/*
+		 * A writer making room may move the key from one bucket to
+		 * the other while it is being searched. Remember the change
+		 * counters so that a miss can be double checked.
+		 */
+		if (h->readwrite_concur_lf_support) {
+			prim_cnt = __atomic_load_n(&prim_bkt->chng_cnt,
+					__ATOMIC_ACQUIRE);
+			sec_cnt = __atomic_load_n(&sec_bkt->chng_cnt,
+					__ATOMIC_ACQUIRE);
+		}
+
+		/* Check if key is in primary location */
+		key_idx = search_one_bucket(h, key, short_sig, prim_bkt, data);
+		if (key_idx != EMPTY_SLOT)
+			/*
+			 * Return index where key is stored,
+			 * subtracting the first dummy index
+			 */
+			return key_idx - 1;
+
+		/* Check if key is in secondary location or its chain */
+		FOR_EACH_BUCKET(cur_bkt, sec_bkt) {
+			key_idx = search_one_bucket(h, key, short_sig, cur_bkt,
+					data);
+			if (key_idx != EMPTY_SLOT)
+				return key_idx - 1;
 		}
-	}
+
+		if (!h->readwrite_concur_lf_support)
+			break;
+
+		/* Order the bucket reads before reloading the counters */
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	} while (prim_cnt != __atomic_load_n(&prim_bkt->chng_cnt,
+				__ATOMIC_ACQUIRE) ||
+		 sec_cnt != __atomic_load_n(&sec_bkt->chng_cnt,
+				__ATOMIC_ACQUIRE));
 
 	return -ENOENT;
 }
@@ -777,14 +1050,13 @@ rte_hash_lookup_data(const struct rte_hash *h, const void *key, void **data)
 	return __rte_hash_lookup_with_hash(h, key, rte_hash_hash(h, key), data);
 }
 
+/* Return a key index to the free slots, through the lcore cache if any */
 static inline void
-remove_entry(const struct rte_hash *h, struct rte_hash_bucket *bkt, unsigned i)
+free_key_slot(const struct rte_hash *h, uint32_t key_idx)
 {
 	unsigned lcore_id, n_slots;
 	struct lcore_cache *cached_free_slots;
 
-	bkt->sig_current[i] = NULL_SIGNATURE;
-	bkt->sig_alt[i] = NULL_SIGNATURE;
 	if (h->hw_trans_mem_support) {
 		lcore_id = rte_lcore_id();
 		cached_free_slots = &h->local_free_slots[lcore_id];
@@ -798,31 +1070,95 @@ remove_entry(const struct rte_hash *h, struct rte_hash_bucket *bkt, unsigned i)
 		}
 		/* Put index of new free slot in cache. */
 		cached_free_slots->objs[cached_free_slots->len] =
-				(void *)((uintptr_t)bkt->key_idx[i]);
+				(void *)((uintptr_t)key_idx);
 		cached_free_slots->len++;
 	} else {
 		rte_ring_sp_enqueue(h->free_slots,
-				(void *)((uintptr_t)bkt->key_idx[i]));
+				(void *)((uintptr_t)key_idx));
+	}
+}
+
+static inline void
+remove_entry(const struct rte_hash *h, struct rte_hash_bucket *bkt, unsigned i)
+{
+	bkt->sig_current[i] = NULL_SIGNATURE;
+
+	/* Lock free readers may still use the key, see NO_FREE_ON_DEL */
+	if (!h->no_free_on_del)
+		free_key_slot(h, bkt->key_idx[i]);
+}
+
+/*
+ * Fill the slot freed in a chain of extendable buckets with the last entry
+ * of the chain, and recycle the last bucket once it is empty.
+ */
+static inline void
+compact_bucket_chain(const struct rte_hash *h, struct rte_hash_bucket *head,
+		struct rte_hash_bucket *bkt, unsigned int pos, int32_t position)
+{
+	struct rte_hash_bucket *last_bkt = head, *prev_bkt = NULL;
+	uint32_t index;
+	int i;
+
+	if (head->next == NULL)
+		return;
+
+	while (last_bkt->next != NULL) {
+		prev_bkt = last_bkt;
+		last_bkt = last_bkt->next;
+	}
+
+	if (last_bkt != bkt) {
+		for (i = RTE_HASH_BUCKET_ENTRIES - 1; i >= 0; i--) {
+			if (last_bkt->key_idx[i] == EMPTY_SLOT)
+				continue;
+			bkt->sig_current[pos] = last_bkt->sig_current[i];
+			__atomic_store_n(&bkt->key_idx[pos],
+					last_bkt->key_idx[i], __ATOMIC_RELEASE);
+			/* Entry was copied, readers of the chain must retry */
+			bucket_entry_moving(head);
+			last_bkt->sig_current[i] = NULL_SIGNATURE;
+			__atomic_store_n(&last_bkt->key_idx[i], EMPTY_SLOT,
+					__ATOMIC_RELEASE);
+			break;
+		}
 	}
+
+	for (i = 0; i < RTE_HASH_BUCKET_ENTRIES; i++)
+		if (last_bkt->key_idx[i] != EMPTY_SLOT)
+			return;
+
+	__atomic_store_n(&prev_bkt->next, NULL, __ATOMIC_RELEASE);
+	index = last_bkt - h->buckets_ext + 1;
+	/*
+	 * Lock free readers may still walk the bucket, it is recycled
+	 * when the application frees the deleted key index.
+	 */
+	if (h->readwrite_concur_lf_support)
+		h->ext_bkt_to_free[position + 1] = index;
+	else
+		rte_ring_sp_enqueue(h->free_ext_bkts,
+				(void *)((uintptr_t)index));
 }
 
+/* Remove a key from the table, with the writer lock held if any */
 static inline int32_t
-__rte_hash_del_key_with_hash(const struct rte_hash *h, const void *key,
-						hash_sig_t sig)
+search_and_remove(const struct rte_hash *h, const void *key, hash_sig_t sig)
 {
-	uint32_t bucket_idx;
-	hash_sig_t alt_hash;
+	uint32_t prim_bucket_idx, sec_bucket_idx;
+	uint16_t short_sig;
 	unsigned i;
-	struct rte_hash_bucket *bkt;
-	struct rte_hash_key *k, *keys = h->key_store;
 	int32_t ret;
+	struct rte_hash_bucket *bkt, *sec_bkt;
+	struct rte_hash_key *k, *keys = h->key_store;
 
-	bucket_idx = sig & h->bucket_bitmask;
-	bkt = &h->buckets[bucket_idx];
+	short_sig = get_short_sig(sig);
+	prim_bucket_idx = get_prim_bucket_index(h, sig);
+	bkt = &h->buckets[prim_bucket_idx];
 
 	/* Check if key is in primary location */
 	for (i = 0; i < RTE_HASH_BUCKET_ENTRIES; i++) {
-		if (bkt->sig_current[i] == sig &&
+		if (bkt->sig_current[i] == short_sig &&
 				bkt->key_idx[i] != EMPTY_SLOT) {
 			k = (struct rte_hash_key *) ((char *)keys +
 					bkt->key_idx[i] * h->key_entry_size);
@@ -834,33 +1170,39 @@ __rte_hash_del_key_with_hash(const struct rte_hash *h, const void *key,
 				 * subtracting the first dummy index
 				 */
 				ret = bkt->key_idx[i] - 1;
-				bkt->key_idx[i] = EMPTY_SLOT;
+				__atomic_store_n(&bkt->key_idx[i], EMPTY_SLOT,
+						__ATOMIC_RELEASE);
 				return ret;
 			}
 		}
 	}
 
-	/* Calculate secondary hash */
-	alt_hash = rte_hash_secondary_hash(sig);
-	bucket_idx = alt_hash & h->bucket_bitmask;
-	bkt = &h->buckets[bucket_idx];
+	/* Calculate secondary bucket */
+	sec_bucket_idx = get_alt_bucket_index(h, prim_bucket_idx, short_sig);
+	sec_bkt = &h->buckets[sec_bucket_idx];
 
-	/* Check if key is in secondary location */
-	for (i = 0; i < RTE_HASH_BUCKET_ENTRIES; i++) {
-		if (bkt->sig_current[i] == alt_hash &&
-				bkt->key_idx[i] != EMPTY_SLOT) {
-			k = (struct rte_hash_key *) ((char *)keys +
+	/* Check if key is in secondary location or its chain */
+	FOR_EACH_BUCKET(bkt, sec_bkt) {
+		for (i = 0; i < RTE_HASH_BUCKET_ENTRIES; i++) {
+			if (bkt->sig_current[i] == short_sig &&
+					bkt->key_idx[i] != EMPTY_SLOT) {
+				k = (struct rte_hash_key *) ((char *)keys +
 					bkt->key_idx[i] * h->key_entry_size);
-			if (rte_hash_cmp_eq(key, k->key, h) == 0) {
-				remove_entry(h, bkt, i);
-
-				/*
-				 * Return index where key is stored,
-				 * subtracting the first dummy index
-				 */
-				ret = bkt->key_idx[i] - 1;
-				bkt->key_idx[i] = EMPTY_SLOT;
-				return ret;
+				if (rte_hash_cmp_eq(key, k->key, h) == 0) {
+					remove_entry(h, bkt, i);
+
+					/*
+					 * Return index where key is stored,
+					 * subtracting the first dummy index
+					 */
+					ret = bkt->key_idx[i] - 1;
+					__atomic_store_n(&bkt->key_idx[i],
+						EMPTY_SLOT, __ATOMIC_RELEASE);
+					if (h->ext_table_support)
+						compact_bucket_chain(h, sec_bkt,
+							bkt, i, ret);
+					return ret;
+				}
 			}
 		}
 	}
@@ -868,6 +1210,21 @@ __rte_hash_del_key_with_hash(const struct rte_hash *h, const void *key,
 	return -ENOENT;
 }
 
+static inline int32_t
+__rte_hash_del_key_with_hash(const struct rte_hash *h, const void *key,
+						hash_sig_t sig)
+{
+	int32_t ret;
+
+	/* Deleting must not race with a cuckoo move of another writer */
+	if (h->add_key == ADD_KEY_MULTIWRITER)
+		rte_spinlock_lock(h->multiwriter_lock);
+	ret = search_and_remove(h, key, sig);
+	if (h->add_key == ADD_KEY_MULTIWRITER)
+		rte_spinlock_unlock(h->multiwriter_lock);
+	return ret;
+}
+
 int32_t
 rte_hash_del_key_with_hash(const struct rte_hash *h,
 			const void *key, hash_sig_t sig)
@@ -903,61 +1260,169 @@ rte_hash_get_key_with_position(const struct rte_hash *h, const int32_t position,
 	return 0;
 }
 
+int __rte_experimental
+rte_hash_free_key_with_position(const struct rte_hash *h,
+				const int32_t position)
+{
+	RETURN_IF_TRUE(((h == NULL) || (position < 0)), -EINVAL);
+
+	/* Out of bounds */
+	if ((uint32_t)position >= h->entries)
+		return -EINVAL;
+
+	/* Recycle the extendable bucket emptied by the delete, if any */
+	if (h->ext_bkt_to_free != NULL && h->ext_bkt_to_free[position + 1]) {
+		rte_ring_sp_enqueue(h->free_ext_bkts, (void *)(uintptr_t)
+				h->ext_bkt_to_free[position + 1]);
+		h->ext_bkt_to_free[position + 1] = 0;
+	}
+
+	/* Skip the dummy entry at index zero */
+	free_key_slot(h, position + 1);
+
+	return 0;
+}
+
+/*
+ * Compare the short signature of a key with all the entries of its two
+ * buckets. Hit masks have two bits per entry, as produced by a 16 bits
+ * comparison with a byte mask.
+ */
 static inline void
 compare_signatures(uint32_t *prim_hash_matches, uint32_t *sec_hash_matches,
 			const struct rte_hash_bucket *prim_bkt,
 			const struct rte_hash_bucket *sec_bkt,
-			hash_sig_t prim_hash, hash_sig_t sec_hash,
+			uint16_t sig,
 			enum rte_hash_sig_compare_function sig_cmp_fn)
 {
 	unsigned int i;
 
 	switch (sig_cmp_fn) {
 #ifdef RTE_MACHINE_CPUFLAG_AVX2
-	case RTE_HASH_COMPARE_AVX2:
-		*prim_hash_matches = _mm256_movemask_ps((__m256)_mm256_cmpeq_epi32(
-				_mm256_load_si256(
-					(__m256i const *)prim_bkt->sig_current),
-				_mm256_set1_epi32(prim_hash)));
-		*sec_hash_matches = _mm256_movemask_ps((__m256)_mm256_cmpeq_epi32(
-				_mm256_load_si256(
-					(__m256i const *)sec_bkt->sig_current),
-				_mm256_set1_epi32(sec_hash)));
+	case RTE_HASH_COMPARE_AVX2: {
+		/* Compare the signatures of both buckets at once */
+		uint32_t matches = _mm256_movemask_epi8(_mm256_cmpeq_epi16(
+				_mm256_inserti128_si256(_mm256_castsi128_si256(
+					_mm_load_si128((__m128i const *)
+						prim_bkt->sig_current)),
+					_mm_load_si128((__m128i const *)
+						sec_bkt->sig_current), 1),
+				_mm256_set1_epi16(sig)));
+		*prim_hash_matches = matches & 0xffff;
+		*sec_hash_matches = matches >> 16;
 		break;
+	}
 #endif
 #ifdef RTE_MACHINE_CPUFLAG_SSE2
 	case RTE_HASH_COMPARE_SSE:
-		/* Compare the first 4 signatures in the bucket */
-		*prim_hash_matches = _mm_movemask_ps((__m128)_mm_cmpeq_epi16(
+		/* Compare all signatures in the bucket */
+		*prim_hash_matches = _mm_movemask_epi8(_mm_cmpeq_epi16(
 				_mm_load_si128(
 					(__m128i const *)prim_bkt->sig_current),
-				_mm_set1_epi32(prim_hash)));
-		*prim_hash_matches |= (_mm_movemask_ps((__m128)_mm_cmpeq_epi16(
-				_mm_load_si128(
-					(__m128i const *)&prim_bkt->sig_current[4]),
-				_mm_set1_epi32(prim_hash)))) << 4;
-		/* Compare the first 4 signatures in the bucket */
-		*sec_hash_matches = _mm_movemask_ps((__m128)_mm_cmpeq_epi16(
+				_mm_set1_epi16(sig)));
+		/* Compare all signatures in the bucket */
+		*sec_hash_matches = _mm_movemask_epi8(_mm_cmpeq_epi16(
 				_mm_load_si128(
 					(__m128i const *)sec_bkt->sig_current),
-				_mm_set1_epi32(sec_hash)));
-		*sec_hash_matches |= (_mm_movemask_ps((__m128)_mm_cmpeq_epi16(
-				_mm_load_si128(
-					(__m128i const *)&sec_bkt->sig_current[4]),
-				_mm_set1_epi32(sec_hash)))) << 4;
+				_mm_set1_epi16(sig)));
 		break;
 #endif
 	default:
 		for (i = 0; i < RTE_HASH_BUCKET_ENTRIES; i++) {
 			*prim_hash_matches |=
-				((prim_hash == prim_bkt->sig_current[i]) << i);
+				((sig == prim_bkt->sig_current[i]) << (i << 1));
 			*sec_hash_matches |=
-				((sec_hash == sec_bkt->sig_current[i]) << i);
+				((sig == sec_bkt->sig_current[i]) << (i << 1));
 		}
 	}
 
 }
 
+#ifdef CC_AVX512_SUPPORT
+/*
+ * Compare the short signatures of a burst of keys with their buckets,
+ * covering the four buckets of two keys per 512 bits comparison, then
+ * gather the key indexes of the first hits of eight keys at once to
+ * prefetch their key slots. Hit masks are returned in the same two bits
+ * per entry format as compare_signatures().
+ */
+static __attribute__((target("avx512f,avx512bw,bmi2"))) void
+compare_signatures_bulk_avx512(const struct rte_hash *h, int32_t num_keys,
+			const struct rte_hash_bucket **primary_bkt,
+			const struct rte_hash_bucket **secondary_bkt,
+			const uint16_t *sig,
+			uint32_t *prim_hitmask, uint32_t *sec_hitmask)
+{
+	const __m512i entry_size = _mm512_set1_epi64(h->key_entry_size);
+	const __m512i key_store = _mm512_set1_epi64((uintptr_t)h->key_store);
+	uint64_t addr[8];
+	__mmask8 valid;
+	__m256i key_idx;
+	__m512i sigs, bkt_sigs;
+	uint32_t matches;
+	int32_t i, j;
+
+	for (i = 0; i + 1 < num_keys; i += 2) {
+		sigs = _mm512_inserti64x4(
+			_mm512_castsi256_si512(_mm256_set1_epi16(sig[i])),
+			_mm256_set1_epi16(sig[i + 1]), 1);
+		bkt_sigs = _mm512_castsi128_si512(_mm_load_si128(
+			(__m128i const *)primary_bkt[i]->sig_current));
+		bkt_sigs = _mm512_inserti32x4(bkt_sigs, _mm_load_si128(
+			(__m128i const *)secondary_bkt[i]->sig_current), 1);
+		bkt_sigs = _mm512_inserti32x4(bkt_sigs, _mm_load_si128(
+			(__m128i const *)primary_bkt[i + 1]->sig_current), 2);
+		bkt_sigs = _mm512_inserti32x4(bkt_sigs, _mm_load_si128(
+			(__m128i const *)secondary_bkt[i + 1]->sig_current), 3);
+		matches = _mm512_cmpeq_epi16_mask(bkt_sigs, sigs);
+
+		prim_hitmask[i] = _pdep_u32(matches & 0xff, 0x5555);
+		sec_hitmask[i] = _pdep_u32((matches >> 8) & 0xff, 0x5555);
+		prim_hitmask[i + 1] = _pdep_u32((matches >> 16) & 0xff, 0x5555);
+		sec_hitmask[i + 1] = _pdep_u32(matches >> 24, 0x5555);
+	}
+	if (i < num_keys)
+		compare_signatures(&prim_hitmask[i], &sec_hitmask[i],
+				primary_bkt[i], secondary_bkt[i],
+				sig[i], RTE_HASH_COMPARE_SSE);
+
+	for (i = 0; i < num_keys; i += 8) {
+		valid = 0;
+		for (j = 0; j < 8; j++) {
+			const struct rte_hash_bucket *bkt = NULL;
+			uint32_t hitmask = 0;
+
+			addr[j] = 0;
+			if (i + j >= num_keys)
+				continue;
+			if (prim_hitmask[i + j]) {
+				bkt = primary_bkt[i + j];
+				hitmask = prim_hitmask[i + j];
+			} else if (sec_hitmask[i + j]) {
+				bkt = secondary_bkt[i + j];
+				hitmask = sec_hitmask[i + j];
+			} else
+				continue;
+			addr[j] = (uintptr_t)&bkt->key_idx[
+					__builtin_ctzl(hitmask) >> 1];
+			valid |= 1 << j;
+		}
+		if (valid == 0)
+			continue;
+
+		/* Key slot address is key_store + key_idx * key_entry_size */
+		key_idx = _mm512_mask_i64gather_epi32(_mm256_setzero_si256(),
+				valid, _mm512_loadu_si512(addr), NULL, 1);
+		_mm512_storeu_si512(addr, _mm512_add_epi64(key_store,
+				_mm512_mul_epu32(_mm512_cvtepu32_epi64(key_idx),
+					entry_size)));
+		for (j = 0; j < 8; j++)
+			if (valid & (1 << j))
+				rte_prefetch0((void *)(uintptr_t)addr[j]);
+	}
+}
+#endif
+
 #define PREFETCH_OFFSET 4
 static inline void
 __rte_hash_lookup_bulk(const struct rte_hash *h, const void **keys,
@@ -967,11 +1432,16 @@ __rte_hash_lookup_bulk(const struct rte_hash *h, const void **keys,
 	uint64_t hits = 0;
 	int32_t i;
 	uint32_t prim_hash[RTE_HASH_LOOKUP_BULK_MAX];
-	uint32_t sec_hash[RTE_HASH_LOOKUP_BULK_MAX];
+	uint32_t prim_index[RTE_HASH_LOOKUP_BULK_MAX];
+	uint32_t sec_index[RTE_HASH_LOOKUP_BULK_MAX];
+	uint16_t sig[RTE_HASH_LOOKUP_BULK_MAX];
 	const struct rte_hash_bucket *primary_bkt[RTE_HASH_LOOKUP_BULK_MAX];
 	const struct rte_hash_bucket *secondary_bkt[RTE_HASH_LOOKUP_BULK_MAX];
 	uint32_t prim_hitmask[RTE_HASH_LOOKUP_BULK_MAX] = {0};
 	uint32_t sec_hitmask[RTE_HASH_LOOKUP_BULK_MAX] = {0};
+	uint32_t prim_cnt[RTE_HASH_LOOKUP_BULK_MAX];
+	uint32_t sec_cnt[RTE_HASH_LOOKUP_BULK_MAX];
+	uint64_t now = h->aging_support ? rte_rdtsc() : 0;
 
 	/* Prefetch first keys */
 	for (i = 0; i < PREFETCH_OFFSET && i < num_keys; i++)
@@ -985,10 +1455,13 @@ __rte_hash_lookup_bulk(const struct rte_hash *h, const void **keys,
 		rte_prefetch0(keys[i + PREFETCH_OFFSET]);
 
 		prim_hash[i] = rte_hash_hash(h, keys[i]);
-		sec_hash[i] = rte_hash_secondary_hash(prim_hash[i]);
 
-		primary_bkt[i] = &h->buckets[prim_hash[i] & h->bucket_bitmask];
-		secondary_bkt[i] = &h->buckets[sec_hash[i] & h->bucket_bitmask];
+		sig[i] = get_short_sig(prim_hash[i]);
+		prim_index[i] = get_prim_bucket_index(h, prim_hash[i]);
+		sec_index[i] = get_alt_bucket_index(h, prim_index[i], sig[i]);
+
+		primary_bkt[i] = &h->buckets[prim_index[i]];
+		secondary_bkt[i] = &h->buckets[sec_index[i]];
 
 		rte_prefetch0(primary_bkt[i]);
 		rte_prefetch0(secondary_bkt[i]);
@@ -997,24 +1470,47 @@ __rte_hash_lookup_bulk(const struct rte_hash *h, const void **keys,
 	/* Calculate and prefetch rest of the buckets */
 	for (; i < num_keys; i++) {
 		prim_hash[i] = rte_hash_hash(h, keys[i]);
-		sec_hash[i] = rte_hash_secondary_hash(prim_hash[i]);
 
-		primary_bkt[i] = &h->buckets[prim_hash[i] & h->bucket_bitmask];
-		secondary_bkt[i] = &h->buckets[sec_hash[i] & h->bucket_bitmask];
+		sig[i] = get_short_sig(prim_hash[i]);
+		prim_index[i] = get_prim_bucket_index(h, prim_hash[i]);
+		sec_index[i] = get_alt_bucket_index(h, prim_index[i], sig[i]);
+
+		primary_bkt[i] = &h->buckets[prim_index[i]];
+		secondary_bkt[i] = &h->buckets[sec_index[i]];
 
 		rte_prefetch0(primary_bkt[i]);
 		rte_prefetch0(secondary_bkt[i]);
 	}
 
+	/* Snapshot the change counters before reading the buckets */
+	if (h->readwrite_concur_lf_support) {
+		for (i = 0; i < num_keys; i++) {
+			prim_cnt[i] = __atomic_load_n(&primary_bkt[i]->chng_cnt,
+						__ATOMIC_ACQUIRE);
+			sec_cnt[i] = __atomic_load_n(&secondary_bkt[i]->chng_cnt,
+						__ATOMIC_ACQUIRE);
+		}
+	}
+
 	/* Compare signatures and prefetch key slot of first hit */
+#ifdef CC_AVX512_SUPPORT
+	if (h->sig_cmp_fn == RTE_HASH_COMPARE_AVX512)
+		compare_signatures_bulk_avx512(h, num_keys,
+				primary_bkt, secondary_bkt, sig,
+				prim_hitmask, sec_hitmask);
+	else
+#endif
 	for (i = 0; i < num_keys; i++) {
 		compare_signatures(&prim_hitmask[i], &sec_hitmask[i],
 				primary_bkt[i], secondary_bkt[i],
-				prim_hash[i], sec_hash[i], h->sig_cmp_fn);
+				sig[i], h->sig_cmp_fn);
 
 		if (prim_hitmask[i]) {
-			uint32_t first_hit = __builtin_ctzl(prim_hitmask[i]);
-			uint32_t key_idx = primary_bkt[i]->key_idx[first_hit];
+			uint32_t first_hit =
+					__builtin_ctzl(prim_hitmask[i]) >> 1;
+			uint32_t key_idx = __atomic_load_n(
+				&primary_bkt[i]->key_idx[first_hit],
+				__ATOMIC_ACQUIRE);
 			const struct rte_hash_key *key_slot =
 				(const struct rte_hash_key *)(
 				(const char *)h->key_store +
@@ -1024,8 +1520,11 @@ __rte_hash_lookup_bulk(const struct rte_hash *h, const void **keys,
 		}
 
 		if (sec_hitmask[i]) {
-			uint32_t first_hit = __builtin_ctzl(sec_hitmask[i]);
-			uint32_t key_idx = secondary_bkt[i]->key_idx[first_hit];
+			uint32_t first_hit =
+					__builtin_ctzl(sec_hitmask[i]) >> 1;
+			uint32_t key_idx = __atomic_load_n(
+				&secondary_bkt[i]->key_idx[first_hit],
+				__ATOMIC_ACQUIRE);
 			const struct rte_hash_key *key_slot =
 				(const struct rte_hash_key *)(
 				(const char *)h->key_store +
@@ -1038,9 +1537,12 @@ __rte_hash_lookup_bulk(const struct rte_hash *h, const void **keys,
 	for (i = 0; i < num_keys; i++) {
 		positions[i] = -ENOENT;
 		while (prim_hitmask[i]) {
-			uint32_t hit_index = __builtin_ctzl(prim_hitmask[i]);
+			uint32_t hit_index =
+					__builtin_ctzl(prim_hitmask[i]) >> 1;
 
-			uint32_t key_idx = primary_bkt[i]->key_idx[hit_index];
+			uint32_t key_idx = __atomic_load_n(
+				&primary_bkt[i]->key_idx[hit_index],
+				__ATOMIC_ACQUIRE);
 			const struct rte_hash_key *key_slot =
 				(const struct rte_hash_key *)(
 				(const char *)h->key_store +
@@ -1051,19 +1553,26 @@ __rte_hash_lookup_bulk(const struct rte_hash *h, const void **keys,
 			 */
 			if (!!key_idx & !rte_hash_cmp_eq(key_slot->key, keys[i], h)) {
 				if (data != NULL)
-					data[i] = key_slot->pdata;
+					data[i] = __atomic_load_n(
+						&key_slot->pdata,
+						__ATOMIC_ACQUIRE);
+				if (h->aging_support)
+					key_touch(h, key_slot, now);
 
 				hits |= 1ULL << i;
 				positions[i] = key_idx - 1;
 				goto next_key;
 			}
-			prim_hitmask[i] &= ~(1 << (hit_index));
+			prim_hitmask[i] &= ~(3U << (hit_index << 1));
 		}
 
 		while (sec_hitmask[i]) {
-			uint32_t hit_index = __builtin_ctzl(sec_hitmask[i]);
+			uint32_t hit_index =
+					__builtin_ctzl(sec_hitmask[i]) >> 1;
 
-			uint32_t key_idx = secondary_bkt[i]->key_idx[hit_index];
+			uint32_t key_idx = __atomic_load_n(
+				&secondary_bkt[i]->key_idx[hit_index],
+				__ATOMIC_ACQUIRE);
 			const struct rte_hash_key *key_slot =
 				(const struct rte_hash_key *)(
 				(const char *)h->key_store +
@@ -1075,13 +1584,40 @@ __rte_hash_lookup_bulk(const struct rte_hash *h, const void **keys,
 
 			if (!!key_idx & !rte_hash_cmp_eq(key_slot->key, keys[i], h)) {
 				if (data != NULL)
-					data[i] = key_slot->pdata;
+					data[i] = __atomic_load_n(
+						&key_slot->pdata,
+						__ATOMIC_ACQUIRE);
+				if (h->aging_support)
+					key_touch(h, key_slot, now);
 
 				hits |= 1ULL << i;
 				positions[i] = key_idx - 1;
 				goto next_key;
 			}
-			sec_hitmask[i] &= ~(1 << (hit_index));
+			sec_hitmask[i] &= ~(3U << (hit_index << 1));
+		}
+
+		/*
+		 * The key may be in the extendable buckets, or a writer may
+		 * have moved it between the buckets while they were searched,
+		 * look it up again in these cases.
+		 */
+		if (h->readwrite_concur_lf_support)
+			__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		if ((h->ext_table_support &&
+		     __atomic_load_n(&secondary_bkt[i]->next,
+				__ATOMIC_ACQUIRE) != NULL) ||
+		    (h->readwrite_concur_lf_support &&
+		     (prim_cnt[i] != __atomic_load_n(
+				&primary_bkt[i]->chng_cnt, __ATOMIC_ACQUIRE) ||
+		      sec_cnt[i] != __atomic_load_n(
+				&secondary_bkt[i]->chng_cnt,
+				__ATOMIC_ACQUIRE)))) {
+			positions[i] = __rte_hash_lookup_with_hash(h, keys[i],
+					prim_hash[i],
+					data != NULL ? &data[i] : NULL);
+			if (positions[i] >= 0)
+				hits |= 1ULL << i;
 		}
 
 next_key:
@@ -1125,38 +1661,133 @@ rte_hash_iterate(const struct rte_hash *h, const void **key, void **data, uint32
 {
 	uint32_t bucket_idx, idx, position;
 	struct rte_hash_key *next_key;
+	const struct rte_hash_bucket *bkt;
 
 	RETURN_IF_TRUE(((h == NULL) || (next == NULL)), -EINVAL);
 
-	const uint32_t total_entries = h->num_buckets * RTE_HASH_BUCKET_ENTRIES;
+	/* Extendable buckets are iterated after the main table */
+	const uint32_t total_entries = h->num_buckets * RTE_HASH_BUCKET_ENTRIES
+					* (h->ext_table_support ? 2 : 1);
 	/* Out of bounds */
 	if (*next >= total_entries)
 		return -ENOENT;
 
-	/* Calculate bucket and index of current iterator */
-	bucket_idx = *next / RTE_HASH_BUCKET_ENTRIES;
-	idx = *next % RTE_HASH_BUCKET_ENTRIES;
+	for (;;) {
+		/* Calculate bucket and index of current iterator */
+		bucket_idx = *next / RTE_HASH_BUCKET_ENTRIES;
+		idx = *next % RTE_HASH_BUCKET_ENTRIES;
+		if (bucket_idx < h->num_buckets)
+			bkt = &h->buckets[bucket_idx];
+		else
+			bkt = &h->buckets_ext[bucket_idx - h->num_buckets];
+
+		position = __atomic_load_n(&bkt->key_idx[idx],
+					__ATOMIC_ACQUIRE);
+		if (position != EMPTY_SLOT)
+			break;
 
-	/* If current position is empty, go to the next one */
-	while (h->buckets[bucket_idx].key_idx[idx] == EMPTY_SLOT) {
+		/* If current position is empty, go to the next one */
 		(*next)++;
 		/* End of table */
 		if (*next == total_entries)
 			return -ENOENT;
-		bucket_idx = *next / RTE_HASH_BUCKET_ENTRIES;
-		idx = *next % RTE_HASH_BUCKET_ENTRIES;
 	}
 
 	/* Get position of entry in key table */
-	position = h->buckets[bucket_idx].key_idx[idx];
 	next_key = (struct rte_hash_key *) ((char *)h->key_store +
 				position * h->key_entry_size);
 	/* Return key and data */
 	*key = next_key->key;
-	*data = next_key->pdata;
+	*data = __atomic_load_n(&next_key->pdata, __ATOMIC_ACQUIRE);
 
 	/* Increment iterator */
 	(*next)++;
 
 	return position - 1;
 }
+
+int __rte_experimental
+rte_hash_expire(const struct rte_hash *h, uint64_t expire_before,
+		uint32_t *next, uint32_t max_scan, int32_t *positions,
+		void **data, uint32_t max_expired)
+{
+	uint32_t bucket_idx, idx, key_idx, n_scan;
+	const struct rte_hash_bucket *bkt;
+	struct rte_hash_key *k;
+	uint32_t n_expired = 0;
+	void *pdata;
+	int32_t ret;
+
+	RETURN_IF_TRUE(((h == NULL) || (next == NULL) ||
+			(positions == NULL)), -EINVAL);
+
+	/* No timestamp in the key entries */
+	if (!h->aging_support)
+		return -EINVAL;
+
+	/* Extendable buckets are scanned after the main table */
+	const uint32_t total_entries = h->num_buckets * RTE_HASH_BUCKET_ENTRIES
+					* (h->ext_table_support ? 2 : 1);
+	if (*next >= total_entries)
+		*next = 0;
+
+	/* A single call makes at most one pass over the table */
+	if (max_scan > total_entries)
+		max_scan = total_entries;
+
+	for (n_scan = 0; n_scan < max_scan && n_expired < max_expired;
+			n_scan++) {
+		bucket_idx = *next / RTE_HASH_BUCKET_ENTRIES;
+		idx = *next % RTE_HASH_BUCKET_ENTRIES;
+		if (bucket_idx < h->num_buckets)
+			bkt = &h->buckets[bucket_idx];
+		else
+			bkt = &h->buckets_ext[bucket_idx - h->num_buckets];
+
+		/* Move the cursor first, wrapping around at the end */
+		if (++(*next) == total_entries)
+			*next = 0;
+
+		key_idx = __atomic_load_n(&bkt->key_idx[idx],
+					__ATOMIC_ACQUIRE);
+		if (key_idx == EMPTY_SLOT)
+			continue;
+
+		k = (struct rte_hash_key *) ((char *)h->key_store +
+				key_idx * h->key_entry_size);
+		if (__atomic_load_n(key_timestamp(h, k), __ATOMIC_RELAXED) >=
+				expire_before)
+			continue;
+
+		/*
+		 * Another writer may have deleted the entry and reused the
+		 * slot for a fresh key since the check above: check again
+		 * and delete with the writer lock held.
+		 */
+		if (h->add_key == ADD_KEY_MULTIWRITER)
+			rte_spinlock_lock(h->multiwriter_lock);
+		ret = -ENOENT;
+		key_idx = bkt->key_idx[idx];
+		if (key_idx != EMPTY_SLOT) {
+			k = (struct rte_hash_key *) ((char *)h->key_store +
+					key_idx * h->key_entry_size);
+			if (__atomic_load_n(key_timestamp(h, k),
+					__ATOMIC_RELAXED) < expire_before) {
+				pdata = k->pdata;
+				ret = search_and_remove(h, k->key,
+						rte_hash_hash(h, k->key));
+			}
+		}
+		if (h->add_key == ADD_KEY_MULTIWRITER)
+			rte_spinlock_unlock(h->multiwriter_lock);
+		if (ret < 0)
+			continue;
+
+		positions[n_expired] = ret;
+		if (data != NULL)
+			data[n_expired] = pdata;
+		n_expired++;
+	}
+
+	return n_expired;
+}
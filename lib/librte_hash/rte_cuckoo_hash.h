@@ -133,18 +133,27 @@ enum rte_hash_sig_compare_function {
 	RTE_HASH_COMPARE_SCALAR = 0,
 	RTE_HASH_COMPARE_SSE,
 	RTE_HASH_COMPARE_AVX2,
+	RTE_HASH_COMPARE_AVX512,
 	RTE_HASH_COMPARE_NUM
 };
 
-/** Bucket structure */
+/** Bucket structure, fitting in one cache line */
 struct rte_hash_bucket {
-	hash_sig_t sig_current[RTE_HASH_BUCKET_ENTRIES];
+	uint16_t sig_current[RTE_HASH_BUCKET_ENTRIES];
+	/**< Short signature of the keys, see get_short_sig() */
 
 	uint32_t key_idx[RTE_HASH_BUCKET_ENTRIES];
 
-	hash_sig_t sig_alt[RTE_HASH_BUCKET_ENTRIES];
+	uint8_t flag;
+	/**< One bit per entry, set while the entry is being pushed */
 
-	uint8_t flag[RTE_HASH_BUCKET_ENTRIES];
+	uint32_t chng_cnt;
+	/**< Incremented by the writer before an entry is moved out of this
+	 * bucket, so that lock free readers can detect they may have missed it.
+	 */
+
+	struct rte_hash_bucket *next;
+	/**< Next extendable bucket chained to this one, if any */
 } __rte_cache_aligned;
 
 /** A hash table structure. */
@@ -157,6 +166,15 @@ struct rte_hash {
 	/**< Ring that stores all indexes of the free slots in the key table */
 	uint8_t hw_trans_mem_support;
 	/**< Hardware transactional memory support */
+	uint8_t readwrite_concur_lf_support;
+	/**< Lock free reader/writer concurrency support */
+	uint8_t no_free_on_del;
+	/**< Key index is not freed by the delete functions, but by
+	 * rte_hash_free_key_with_position().
+	 */
+	uint8_t ext_table_support;     /**< Enable extendable bucket table */
+	uint8_t aging_support;
+	/**< Last access timestamp stored after the key, in each key entry */
 	struct lcore_cache *local_free_slots;
 	/**< Local cache per lcore, storing some indexes of the free slots */
 	enum add_key_case add_key; /**< Multi-writer hash add behavior */
@@ -184,6 +202,13 @@ struct rte_hash {
 	/**< Table with buckets storing all the	hash values and key indexes
 	 * to the key table.
 	 */
+	struct rte_hash_bucket *buckets_ext; /**< Extendable buckets */
+	struct rte_ring *free_ext_bkts;
+	/**< Ring that stores the indexes of the free extendable buckets */
+	uint32_t *ext_bkt_to_free;
+	/**< Extendable bucket to recycle when a key index is freed, with
+	 * lock free readers. Indexed by key index.
+	 */
 } __rte_cache_aligned;
 
 struct queue_node {
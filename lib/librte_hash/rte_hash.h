@@ -14,6 +14,8 @@
 #include <stdint.h>
 #include <stddef.h>
 
+#include <rte_compat.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -34,6 +36,40 @@ extern "C" {
 /** Default behavior of insertion, single writer/multi writer */
 #define RTE_HASH_EXTRA_FLAGS_MULTI_WRITER_ADD 0x02
 
+/**
+ * Flag to enable extendable buckets. Keys which cannot be placed in their
+ * primary or secondary bucket are stored in buckets chained to the secondary
+ * bucket, so that inserting up to the configured number of entries never
+ * fails because of hash collisions.
+ */
+#define RTE_HASH_EXTRA_FLAGS_EXT_TABLE 0x08
+
+/**
+ * Flag to disable freeing of key index on hash delete.
+ * The key index is only returned to the free list by
+ * rte_hash_free_key_with_position(), once the application knows that
+ * no reader still refers to the deleted entry.
+ */
+#define RTE_HASH_EXTRA_FLAGS_NO_FREE_ON_DEL 0x10
+
+/**
+ * Flag to support lock free reader writer concurrency. Lookups never block
+ * and stay correct while a writer inserts or deletes keys, including while
+ * keys are moved between buckets to make room.
+ * Writers still have to be serialized, either by the application or by
+ * also setting RTE_HASH_EXTRA_FLAGS_MULTI_WRITER_ADD.
+ * This flag implies RTE_HASH_EXTRA_FLAGS_NO_FREE_ON_DEL.
+ */
+#define RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY_LF 0x20
+
+/**
+ * Flag to store a last access timestamp (TSC cycles) with each key.
+ * It is set when the key is added and refreshed by every successful add
+ * or lookup of the key, so that idle keys can be removed incrementally
+ * with rte_hash_expire().
+ */
+#define RTE_HASH_EXTRA_FLAGS_AGING 0x40
+
 /** Signature of key that is stored internally. */
 typedef uint32_t hash_sig_t;
 
@@ -217,6 +253,9 @@ rte_hash_add_key_with_hash(const struct rte_hash *h, const void *key, hash_sig_t
  *   - A positive value that can be used by the caller as an offset into an
  *     array of user data. This value is unique for this key, and is the same
  *     value that was returned when the key was added.
+ *     If the hash was created with RTE_HASH_EXTRA_FLAGS_NO_FREE_ON_DEL or
+ *     RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY_LF, this position has to be freed
+ *     with rte_hash_free_key_with_position() once it is no longer referenced.
  */
 int32_t
 rte_hash_del_key(const struct rte_hash *h, const void *key);
@@ -238,6 +277,9 @@ rte_hash_del_key(const struct rte_hash *h, const void *key);
  *   - A positive value that can be used by the caller as an offset into an
  *     array of user data. This value is unique for this key, and is the same
  *     value that was returned when the key was added.
+ *     If the hash was created with RTE_HASH_EXTRA_FLAGS_NO_FREE_ON_DEL or
+ *     RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY_LF, this position has to be freed
+ *     with rte_hash_free_key_with_position() once it is no longer referenced.
  */
 int32_t
 rte_hash_del_key_with_hash(const struct rte_hash *h, const void *key, hash_sig_t sig);
@@ -261,6 +303,30 @@ int
 rte_hash_get_key_with_position(const struct rte_hash *h, const int32_t position,
 			       void **key);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Free a hash key in the hash table given the position
+ * of the key. This operation is not multi-thread safe and should
+ * only be called from one thread, like the delete functions.
+ * It is only needed if the hash was created with
+ * RTE_HASH_EXTRA_FLAGS_NO_FREE_ON_DEL or
+ * RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY_LF, after the key was deleted
+ * and all readers which could still be accessing it have moved on.
+ *
+ * @param h
+ *   Hash table to free the key from.
+ * @param position
+ *   Position returned when the key was deleted.
+ * @return
+ *   - 0 if freed successfully
+ *   - -EINVAL if the parameters are invalid.
+ */
+int __rte_experimental
+rte_hash_free_key_with_position(const struct rte_hash *h,
+				const int32_t position);
+
 /**
  * Find a key-value pair in the hash table.
  * This operation is multi-thread safe.
@@ -419,6 +485,52 @@ rte_hash_lookup_bulk(const struct rte_hash *h, const void **keys,
  */
 int32_t
 rte_hash_iterate(const struct rte_hash *h, const void **key, void **data, uint32_t *next);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Delete the keys which have not been added or looked up since a given
+ * time, scanning a bounded number of table entries from a cursor, so
+ * that aging can be spread over many calls from the data plane.
+ * The hash must have been created with RTE_HASH_EXTRA_FLAGS_AGING.
+ * When the hash uses the multi-writer lock, i.e. it was created with
+ * RTE_HASH_EXTRA_FLAGS_MULTI_WRITER_ADD but without
+ * RTE_HASH_EXTRA_FLAGS_TRANS_MEM_SUPPORT, the timestamp of a key is
+ * checked again and the key deleted with the lock held, so that a key
+ * added concurrently is never expired. Otherwise this operation is not
+ * multi-thread safe with other writers, and must be serialized with them
+ * by the application. A key accessed while it is expired may still be
+ * deleted, and a key moved by a concurrent delete may be skipped until
+ * the next pass.
+ *
+ * @param h
+ *   Hash table to expire keys from.
+ * @param expire_before
+ *   Keys whose last access timestamp, in TSC cycles, is lower are deleted.
+ * @param next
+ *   Pointer to the cursor. Should be 0 to start from the beginning of the
+ *   table. It is updated after each call and wraps around at the end of
+ *   the table.
+ * @param max_scan
+ *   Maximum number of table entries to scan in this call, at most one
+ *   pass over the table is made.
+ * @param positions
+ *   Output containing the positions of the deleted keys, as returned by
+ *   rte_hash_del_key().
+ * @param data
+ *   Output containing the data of the deleted keys. Can be NULL.
+ * @param max_expired
+ *   Size of the positions and data arrays. The scan stops when they are
+ *   full.
+ * @return
+ *   - The number of keys deleted.
+ *   - -EINVAL if the parameters are invalid.
+ */
+int __rte_experimental
+rte_hash_expire(const struct rte_hash *h, uint64_t expire_before,
+		uint32_t *next, uint32_t max_scan, int32_t *positions,
+		void **data, uint32_t max_expired);
 #ifdef __cplusplus
 }
 #endif
@@ -49,7 +49,7 @@ rte_pktmbuf_pool_init(struct rte_mempool *mp, void *opaque_arg)
 	/* if no structure is provided, assume no mbuf private area */
 	user_mbp_priv = opaque_arg;
 	if (user_mbp_priv == NULL) {
-		default_mbp_priv.mbuf_priv_size = 0;
+		memset(&default_mbp_priv, 0, sizeof(default_mbp_priv));
 		if (mp->elt_size > sizeof(struct rte_mbuf))
 			roomsz = mp->elt_size - sizeof(struct rte_mbuf);
 		else
@@ -60,7 +60,10 @@ rte_pktmbuf_pool_init(struct rte_mempool *mp, void *opaque_arg)
 
 	RTE_ASSERT(mp->elt_size >= sizeof(struct rte_mbuf) +
 		user_mbp_priv->mbuf_data_room_size +
-		user_mbp_priv->mbuf_priv_size);
+		user_mbp_priv->mbuf_priv_size ||
+		(user_mbp_priv->flags & RTE_PKTMBUF_POOL_F_PINNED_EXT_BUF));
+	RTE_ASSERT((user_mbp_priv->flags &
+		~RTE_PKTMBUF_POOL_F_PINNED_EXT_BUF) == 0);
 
 	mbp_priv = rte_mempool_get_priv(mp);
 	memcpy(mbp_priv, user_mbp_priv, sizeof(*mbp_priv));
@@ -126,6 +129,7 @@ rte_pktmbuf_pool_create_by_ops(const char *name, unsigned int n,
 	}
 	elt_size = sizeof(struct rte_mbuf) + (unsigned)priv_size +
 		(unsigned)data_room_size;
+	memset(&mbp_priv, 0, sizeof(mbp_priv));
 	mbp_priv.mbuf_data_room_size = data_room_size;
 	mbp_priv.mbuf_priv_size = priv_size;
 
@@ -157,6 +161,175 @@ rte_pktmbuf_pool_create_by_ops(const char *name, unsigned int n,
 	return mp;
 }
 
+/* state of the constructor of mbufs with pinned external buffers */
+struct rte_pktmbuf_extmem_init_ctx {
+	const struct rte_pktmbuf_extmem *ext_mem; /* current memory area */
+	unsigned int ext_num; /* number of memory areas left */
+	size_t off;           /* offset of the next buffer in the area */
+};
+
+/*
+ * Free callback of a pinned external buffer, called when the last mbuf
+ * sharing it is freed: return its own mbuf to the pool.
+ */
+static void
+rte_pktmbuf_free_pinned_extmem(void *addr, void *opaque)
+{
+	struct rte_mbuf *m = opaque;
+
+	RTE_SET_USED(addr);
+	RTE_ASSERT(RTE_MBUF_HAS_EXTBUF(m));
+	RTE_ASSERT(RTE_MBUF_HAS_PINNED_EXTBUF(m));
+	RTE_ASSERT(m->shinfo->fcb_opaque == m);
+
+	rte_mbuf_ext_refcnt_set(m->shinfo, 1);
+	m->ol_flags = EXT_ATTACHED_MBUF;
+	if (m->next != NULL) {
+		m->next = NULL;
+		m->nb_segs = 1;
+	}
+	rte_mbuf_refcnt_set(m, 1);
+	rte_mbuf_raw_free(m);
+}
+
+/*
+ * Constructor of a mbuf with a pinned external buffer, given as a
+ * callback function to rte_mempool_obj_iter(). The shared info of the
+ * buffer is stored after the mbuf private area.
+ */
+static void
+rte_pktmbuf_init_extmem(struct rte_mempool *mp, void *opaque_arg,
+	void *_m, __attribute__((unused)) unsigned int i)
+{
+	struct rte_pktmbuf_extmem_init_ctx *ctx = opaque_arg;
+	struct rte_mbuf_ext_shared_info *shinfo;
+	struct rte_mbuf *m = _m;
+	uint32_t mbuf_size, buf_len, priv_size;
+
+	priv_size = rte_pktmbuf_priv_size(mp);
+	mbuf_size = sizeof(struct rte_mbuf) + priv_size;
+	buf_len = rte_pktmbuf_data_room_size(mp);
+
+	RTE_ASSERT(RTE_ALIGN(priv_size, RTE_MBUF_PRIV_ALIGN) == priv_size);
+	RTE_ASSERT(mp->elt_size >= mbuf_size + sizeof(*shinfo));
+	RTE_ASSERT(buf_len <= UINT16_MAX);
+
+	/* go to the next area with room when this one is full */
+	while (ctx->off + ctx->ext_mem->elt_size > ctx->ext_mem->buf_len) {
+		RTE_ASSERT(ctx->ext_num > 1);
+		ctx->ext_mem++;
+		ctx->ext_num--;
+		ctx->off = 0;
+	}
+
+	memset(m, 0, mbuf_size);
+	m->priv_size = priv_size;
+	m->buf_addr = RTE_PTR_ADD(ctx->ext_mem->buf_ptr, ctx->off);
+	m->buf_iova = ctx->ext_mem->buf_iova == RTE_BAD_IOVA ?
+		RTE_BAD_IOVA : ctx->ext_mem->buf_iova + ctx->off;
+	m->buf_len = (uint16_t)buf_len;
+	ctx->off += ctx->ext_mem->elt_size;
+
+	/* keep some headroom between start of buffer and data */
+	m->data_off = RTE_MIN(RTE_PKTMBUF_HEADROOM, (uint16_t)m->buf_len);
+
+	/* init some constant fields */
+	m->pool = mp;
+	m->nb_segs = 1;
+	m->port = MBUF_INVALID_PORT;
+	m->ol_flags = EXT_ATTACHED_MBUF;
+	rte_mbuf_refcnt_set(m, 1);
+	m->next = NULL;
+
+	/* init the shared info of the pinned buffer */
+	shinfo = RTE_PTR_ADD(m, mbuf_size);
+	m->shinfo = shinfo;
+	shinfo->free_cb = rte_pktmbuf_free_pinned_extmem;
+	shinfo->fcb_opaque = m;
+	rte_mbuf_ext_refcnt_set(shinfo, 1);
+}
+
+/* Helper to create a mbuf pool with pinned external buffers */
+struct rte_mempool * __rte_experimental
+rte_pktmbuf_pool_create_extbuf(const char *name, unsigned int n,
+	unsigned int cache_size, uint16_t priv_size, uint16_t data_room_size,
+	int socket_id, const struct rte_pktmbuf_extmem *ext_mem,
+	unsigned int ext_num)
+{
+	struct rte_pktmbuf_extmem_init_ctx init_ctx;
+	struct rte_pktmbuf_pool_private mbp_priv;
+	struct rte_mempool *mp;
+	unsigned int elt_size, i;
+	size_t nb_bufs = 0;
+	int ret;
+
+	if (RTE_ALIGN(priv_size, RTE_MBUF_PRIV_ALIGN) != priv_size) {
+		RTE_LOG(ERR, MBUF, "mbuf priv_size=%u is not aligned\n",
+			priv_size);
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	/* check that the areas can hold the n buffers */
+	if (ext_mem == NULL || ext_num == 0) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+	for (i = 0; i != ext_num; i++) {
+		if (ext_mem[i].buf_ptr == NULL ||
+				ext_mem[i].elt_size < data_room_size ||
+				ext_mem[i].elt_size == 0 ||
+				ext_mem[i].buf_len < ext_mem[i].elt_size) {
+			RTE_LOG(ERR, MBUF, "invalid external memory %u\n", i);
+			rte_errno = EINVAL;
+			return NULL;
+		}
+		nb_bufs += ext_mem[i].buf_len / ext_mem[i].elt_size;
+	}
+	if (nb_bufs < n) {
+		RTE_LOG(ERR, MBUF, "external memory too small for %u mbufs\n",
+			n);
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	elt_size = sizeof(struct rte_mbuf) + (unsigned int)priv_size +
+		sizeof(struct rte_mbuf_ext_shared_info);
+	memset(&mbp_priv, 0, sizeof(mbp_priv));
+	mbp_priv.mbuf_data_room_size = data_room_size;
+	mbp_priv.mbuf_priv_size = priv_size;
+	mbp_priv.flags = RTE_PKTMBUF_POOL_F_PINNED_EXT_BUF;
+
+	mp = rte_mempool_create_empty(name, n, elt_size, cache_size,
+		 sizeof(struct rte_pktmbuf_pool_private), socket_id, 0);
+	if (mp == NULL)
+		return NULL;
+
+	ret = rte_mempool_set_ops_byname(mp, rte_mbuf_best_mempool_ops(),
+		NULL);
+	if (ret != 0) {
+		RTE_LOG(ERR, MBUF, "error setting mempool handler\n");
+		rte_mempool_free(mp);
+		rte_errno = -ret;
+		return NULL;
+	}
+	rte_pktmbuf_pool_init(mp, &mbp_priv);
+
+	ret = rte_mempool_populate_default(mp);
+	if (ret < 0) {
+		rte_mempool_free(mp);
+		rte_errno = -ret;
+		return NULL;
+	}
+
+	init_ctx.ext_mem = ext_mem;
+	init_ctx.ext_num = ext_num;
+	init_ctx.off = 0;
+	rte_mempool_obj_iter(mp, rte_pktmbuf_init_extmem, &init_ctx);
+
+	return mp;
+}
+
 /* helper to create a mbuf pool */
 struct rte_mempool *
 rte_pktmbuf_pool_create(const char *name, unsigned int n,
@@ -167,6 +340,46 @@ rte_pktmbuf_pool_create(const char *name, unsigned int n,
 			data_room_size, socket_id, NULL);
 }
 
+/* max number of segments put back to their pool at once by free_bulk */
+#define MBUF_FREE_PENDING_SZ 64
+
+/* free a bulk of packet mbufs, grouping the segments of the same pool */
+void __rte_experimental
+rte_pktmbuf_free_bulk(struct rte_mbuf **mbufs, unsigned int count)
+{
+	struct rte_mbuf *pending[MBUF_FREE_PENDING_SZ];
+	struct rte_mbuf *m, *m_next;
+	unsigned int i, nb_pending = 0;
+
+	for (i = 0; i != count; i++) {
+		m = mbufs[i];
+		if (m == NULL)
+			continue;
+
+		__rte_mbuf_sanity_check(m, 1);
+
+		do {
+			m_next = m->next;
+			m = rte_pktmbuf_prefree_seg(m);
+			if (likely(m != NULL)) {
+				if (nb_pending == RTE_DIM(pending) ||
+						(nb_pending != 0 &&
+						m->pool != pending[0]->pool)) {
+					rte_mempool_put_bulk(pending[0]->pool,
+						(void **)pending, nb_pending);
+					nb_pending = 0;
+				}
+				pending[nb_pending++] = m;
+			}
+			m = m_next;
+		} while (m != NULL);
+	}
+
+	if (nb_pending != 0)
+		rte_mempool_put_bulk(pending[0]->pool, (void **)pending,
+			nb_pending);
+}
+
 /* do some sanity checks on a mbuf: panic if it fails */
 void
 rte_mbuf_sanity_check(const struct rte_mbuf *m, int is_header)
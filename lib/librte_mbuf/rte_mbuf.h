@@ -40,6 +40,7 @@
 #include <rte_atomic.h>
 #include <rte_prefetch.h>
 #include <rte_branch_prediction.h>
+#include <rte_vect.h>
 #include <rte_mbuf_ptype.h>
 
 #ifdef __cplusplus
@@ -531,6 +532,14 @@ struct rte_mbuf {
 			uint32_t lo;
 			uint32_t hi;
 		} sched;          /**< Hierarchical scheduler */
+		struct {
+			uint32_t reserved1;
+			uint16_t reserved2;
+			uint16_t txq;
+			/**< The event eth Tx adapter uses this field to store
+			 * Tx queue id. @see rte_event_eth_tx_adapter_txq_set()
+			 */
+		} txadapter; /**< Eventdev ethdev Tx adapter */
 		uint32_t usr;	  /**< User defined tags. See rte_distributor_process() */
 	} hash;                   /**< hash information */
 
@@ -768,8 +777,43 @@ rte_mbuf_to_baddr(struct rte_mbuf *md)
 struct rte_pktmbuf_pool_private {
 	uint16_t mbuf_data_room_size; /**< Size of data space in each mbuf. */
 	uint16_t mbuf_priv_size;      /**< Size of private area in each mbuf. */
+	uint32_t flags; /**< Pool flags, RTE_PKTMBUF_POOL_F_*. */
 };
 
+/**
+ * The mbufs of the pool have pinned external buffers: each of them is
+ * attached at creation to a buffer of the memory given to
+ * rte_pktmbuf_pool_create_extbuf() and is never detached from it.
+ */
+#define RTE_PKTMBUF_POOL_F_PINNED_EXT_BUF (1 << 0)
+
+/**
+ * Get the flags of a pktmbuf pool.
+ *
+ * @param mp
+ *   The packet mbuf pool.
+ * @return
+ *   The flags of the pool, RTE_PKTMBUF_POOL_F_*.
+ */
+static inline uint32_t
+rte_pktmbuf_priv_flags(struct rte_mempool *mp)
+{
+	struct rte_pktmbuf_pool_private *mbp_priv;
+
+	mbp_priv = (struct rte_pktmbuf_pool_private *)rte_mempool_get_priv(mp);
+	return mbp_priv->flags;
+}
+
+/**
+ * Returns TRUE if given mbuf has a pinned external buffer, or FALSE
+ * otherwise. Only meaningful when RTE_MBUF_HAS_EXTBUF(mb) is TRUE.
+ *
+ * A pinned external buffer is attached to the mbuf at pool creation and
+ * is never detached from it, see rte_pktmbuf_pool_create_extbuf().
+ */
+#define RTE_MBUF_HAS_PINNED_EXTBUF(mb) \
+	(rte_pktmbuf_priv_flags((mb)->pool) & RTE_PKTMBUF_POOL_F_PINNED_EXT_BUF)
+
 #ifdef RTE_LIBRTE_MBUF_DEBUG
 
 /**  check mbuf type in debug mode */
@@ -998,9 +1042,9 @@ static inline struct rte_mbuf *rte_mbuf_raw_alloc(struct rte_mempool *mp)
 /**
  * Put mbuf back into its original mempool.
  *
- * The caller must ensure that the mbuf is direct and properly
- * reinitialized (refcnt=1, next=NULL, nb_segs=1), as done by
- * rte_pktmbuf_prefree_seg().
+ * The caller must ensure that the mbuf is direct, or has a pinned external
+ * buffer, and properly reinitialized (refcnt=1, next=NULL, nb_segs=1), as
+ * done by rte_pktmbuf_prefree_seg().
  *
  * This function should be used with care, when optimization is
  * required. For standard needs, prefer rte_pktmbuf_free() or
@@ -1012,7 +1056,8 @@ static inline struct rte_mbuf *rte_mbuf_raw_alloc(struct rte_mempool *mp)
 static __rte_always_inline void
 rte_mbuf_raw_free(struct rte_mbuf *m)
 {
-	RTE_ASSERT(RTE_MBUF_DIRECT(m));
+	RTE_ASSERT(!RTE_MBUF_CLONED(m) &&
+		(!RTE_MBUF_HAS_EXTBUF(m) || RTE_MBUF_HAS_PINNED_EXTBUF(m)));
 	RTE_ASSERT(rte_mbuf_refcnt_read(m) == 1);
 	RTE_ASSERT(m->next == NULL);
 	RTE_ASSERT(m->nb_segs == 1);
@@ -1151,6 +1196,72 @@ rte_pktmbuf_pool_create_by_ops(const char *name, unsigned int n,
 	unsigned int cache_size, uint16_t priv_size, uint16_t data_room_size,
 	int socket_id, const char *ops_name);
 
+/**
+ * A memory area holding the data buffers of a pool created by
+ * rte_pktmbuf_pool_create_extbuf().
+ */
+struct rte_pktmbuf_extmem {
+	void *buf_ptr;       /**< Start address of the area. */
+	rte_iova_t buf_iova; /**< IO address of the area, RTE_BAD_IOVA if none. */
+	size_t buf_len;      /**< Length of the area. */
+	uint16_t elt_size;   /**< Size of each buffer in the area. */
+};
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Create a mbuf pool with pinned external buffers.
+ *
+ * This function creates and initializes a packet mbuf pool whose data
+ * buffers live in memory areas given by the application, e.g. its own
+ * hugepages or a mmap'd region registered for DMA. Each mbuf is attached
+ * at creation to a buffer of these areas and stays attached to it: when
+ * the mbuf is freed, it returns to the pool with its buffer, without
+ * detach or reference counting unless the buffer has been shared with
+ * rte_pktmbuf_attach() in the meantime.
+ *
+ * The mbufs have the EXT_ATTACHED_MBUF flag set, and the pool has the
+ * RTE_PKTMBUF_POOL_F_PINNED_EXT_BUF flag set. Such mbufs can't be used as
+ * the indirect mbuf of rte_pktmbuf_attach() or rte_pktmbuf_clone().
+ *
+ * @param name
+ *   The name of the mbuf pool.
+ * @param n
+ *   The number of elements in the mbuf pool. The areas must be large
+ *   enough to hold n buffers.
+ * @param cache_size
+ *   Size of the per-core object cache. See rte_mempool_create() for
+ *   details.
+ * @param priv_size
+ *   Size of application private are between the rte_mbuf structure
+ *   and the shared info of the buffer. This value must be aligned to
+ *   RTE_MBUF_PRIV_ALIGN.
+ * @param data_room_size
+ *   Size of data buffer in each mbuf, including RTE_PKTMBUF_HEADROOM.
+ *   It must not be larger than the elt_size of the areas.
+ * @param socket_id
+ *   The socket identifier where the memory of the mbufs should be
+ *   allocated. The value can be *SOCKET_ID_ANY* if there is no NUMA
+ *   constraint for the reserved zone.
+ * @param ext_mem
+ *   Array of the memory areas holding the data buffers. Each area must
+ *   hold at least one buffer of its elt_size.
+ * @param ext_num
+ *   Number of memory areas in the array.
+ * @return
+ *   The pointer to the new allocated mempool, on success. NULL on error
+ *   with rte_errno set appropriately. Possible rte_errno values include
+ *   those of rte_pktmbuf_pool_create(), and:
+ *    - EINVAL - an area is invalid or too small for one buffer, or the
+ *      areas can't hold n buffers of data_room_size bytes.
+ */
+struct rte_mempool * __rte_experimental
+rte_pktmbuf_pool_create_extbuf(const char *name, unsigned int n,
+	unsigned int cache_size, uint16_t priv_size, uint16_t data_room_size,
+	int socket_id, const struct rte_pktmbuf_extmem *ext_mem,
+	unsigned int ext_num);
+
 /**
  * Get the data room size of mbufs stored in a pktmbuf_pool
  *
@@ -1226,7 +1337,7 @@ static inline void rte_pktmbuf_reset(struct rte_mbuf *m)
 	m->nb_segs = 1;
 	m->port = MBUF_INVALID_PORT;
 
-	m->ol_flags = 0;
+	m->ol_flags &= EXT_ATTACHED_MBUF;
 	m->packet_type = 0;
 	rte_pktmbuf_reset_headroom(m);
 
@@ -1234,6 +1345,123 @@ static inline void rte_pktmbuf_reset(struct rte_mbuf *m)
 	__rte_mbuf_sanity_check(m, 1);
 }
 
+/**
+ * @internal Get the rearm template of the packet mbufs whose buffers are
+ * buf_len bytes long: the 8 bytes at rearm_data of such a reset mbuf,
+ * i.e. its data_off, refcnt, nb_segs and port fields.
+ */
+static __rte_always_inline uint64_t
+__rte_pktmbuf_rearm_template(uint16_t buf_len)
+{
+	union {
+		RTE_STD_C11
+		struct {
+			uint16_t data_off;
+			uint16_t refcnt;
+			uint16_t nb_segs;
+			uint16_t port;
+		};
+		uint64_t u64;
+	} tmpl;
+
+	RTE_BUILD_BUG_ON(offsetof(struct rte_mbuf, data_off) !=
+		offsetof(struct rte_mbuf, rearm_data));
+	RTE_BUILD_BUG_ON(offsetof(struct rte_mbuf, refcnt) !=
+		offsetof(struct rte_mbuf, rearm_data) + 2);
+	RTE_BUILD_BUG_ON(offsetof(struct rte_mbuf, nb_segs) !=
+		offsetof(struct rte_mbuf, rearm_data) + 4);
+	RTE_BUILD_BUG_ON(offsetof(struct rte_mbuf, port) !=
+		offsetof(struct rte_mbuf, rearm_data) + 6);
+
+	tmpl.data_off = (uint16_t)RTE_MIN((uint16_t)RTE_PKTMBUF_HEADROOM,
+		buf_len);
+	tmpl.refcnt = 1;
+	tmpl.nb_segs = 1;
+	tmpl.port = MBUF_INVALID_PORT;
+
+	return tmpl.u64;
+}
+
+/**
+ * @internal Reset the fields of packet mbufs taken from the same mempool,
+ * like rte_pktmbuf_reset() does.
+ *
+ * The mbufs must come from the mempool, so that their next and nb_segs
+ * fields already have their default values, and all their buffers have
+ * the same length and are pinned external buffers or not. The data_off
+ * to port and ol_flags fields, which are followed by the
+ * rx_descriptor_fields1 ones, are written from a template with one
+ * 32-byte store when AVX2 is available, or two 16-byte stores.
+ */
+static __rte_always_inline void
+__rte_pktmbuf_reset_bulk(struct rte_mbuf **mbufs, unsigned int count)
+{
+	struct rte_mbuf *m;
+	uint64_t rearm, ol_flags;
+	unsigned int i;
+
+	if (count == 0)
+		return;
+
+	rearm = __rte_pktmbuf_rearm_template(mbufs[0]->buf_len);
+	/* set in all the mbufs of a pool with pinned external buffers */
+	ol_flags = mbufs[0]->ol_flags & EXT_ATTACHED_MBUF;
+
+#if defined(RTE_ARCH_X86) && defined(RTE_MACHINE_CPUFLAG_AVX2)
+	const __m256i tmpl = _mm256_set_epi64x(0, 0, ol_flags, rearm);
+#elif defined(RTE_ARCH_X86)
+	const __m128i tmpl = _mm_set_epi64x(ol_flags, rearm);
+	const __m128i zero = _mm_setzero_si128();
+#endif
+
+	for (i = 0; i != count; i++) {
+		m = mbufs[i];
+
+		/* rearm_data, ol_flags, packet_type, pkt_len, data_len and
+		 * vlan_tci are contiguous, followed by the hash
+		 */
+#if defined(RTE_ARCH_X86) && defined(RTE_MACHINE_CPUFLAG_AVX2)
+		_mm256_storeu_si256((__m256i *)&m->rearm_data, tmpl);
+#elif defined(RTE_ARCH_X86)
+		_mm_storeu_si128((__m128i *)&m->rearm_data, tmpl);
+		_mm_storeu_si128((__m128i *)&m->rx_descriptor_fields1, zero);
+#else
+		*(uint64_t *)(uintptr_t)&m->data_off = rearm;
+		m->ol_flags = ol_flags;
+		m->packet_type = 0;
+		m->pkt_len = 0;
+		m->data_len = 0;
+		m->vlan_tci = 0;
+#endif
+		m->vlan_tci_outer = 0;
+		m->tx_offload = 0;
+		__rte_mbuf_sanity_check(m, 1);
+	}
+}
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Reset the fields of packet mbufs allocated from the same mempool to
+ * their default values.
+ *
+ * This is the bulk version of rte_pktmbuf_reset(), for mbufs just taken
+ * from their mempool, e.g. by rte_mempool_get_bulk() when refilling a
+ * Rx ring: their next and nb_segs fields are not written, and the other
+ * fields are written from a template with vector stores when possible.
+ *
+ * @param mbufs
+ *   Array of pointers to mbufs allocated from the same mempool.
+ * @param count
+ *   Array size.
+ */
+static inline void __rte_experimental
+rte_pktmbuf_reset_bulk(struct rte_mbuf **mbufs, unsigned int count)
+{
+	__rte_pktmbuf_reset_bulk(mbufs, count);
+}
+
 /**
  * Allocate a new mbuf from a mempool.
  *
@@ -1272,42 +1500,17 @@ static inline struct rte_mbuf *rte_pktmbuf_alloc(struct rte_mempool *mp)
 static inline int rte_pktmbuf_alloc_bulk(struct rte_mempool *pool,
 	 struct rte_mbuf **mbufs, unsigned count)
 {
-	unsigned idx = 0;
+	unsigned idx;
 	int rc;
 
 	rc = rte_mempool_get_bulk(pool, (void **)mbufs, count);
 	if (unlikely(rc))
 		return rc;
 
-	/* To understand duff's device on loop unwinding optimization, see
-	 * https://en.wikipedia.org/wiki/Duff's_device.
-	 * Here while() loop is used rather than do() while{} to avoid extra
-	 * check if count is zero.
-	 */
-	switch (count % 4) {
-	case 0:
-		while (idx != count) {
-			MBUF_RAW_ALLOC_CHECK(mbufs[idx]);
-			rte_pktmbuf_reset(mbufs[idx]);
-			idx++;
-			/* fall-through */
-	case 3:
-			MBUF_RAW_ALLOC_CHECK(mbufs[idx]);
-			rte_pktmbuf_reset(mbufs[idx]);
-			idx++;
-			/* fall-through */
-	case 2:
-			MBUF_RAW_ALLOC_CHECK(mbufs[idx]);
-			rte_pktmbuf_reset(mbufs[idx]);
-			idx++;
-			/* fall-through */
-	case 1:
-			MBUF_RAW_ALLOC_CHECK(mbufs[idx]);
-			rte_pktmbuf_reset(mbufs[idx]);
-			idx++;
-			/* fall-through */
-		}
-	}
+	for (idx = 0; idx != count; idx++)
+		MBUF_RAW_ALLOC_CHECK(mbufs[idx]);
+
+	__rte_pktmbuf_reset_bulk(mbufs, count);
 	return 0;
 }
 
@@ -1564,7 +1767,8 @@ __rte_pktmbuf_free_direct(struct rte_mbuf *m)
  *  - restore original mbuf address and length values.
  *  - reset pktmbuf data and data_len to their default values.
  *
- * All other fields of the given packet mbuf will be left intact.
+ * All other fields of the given packet mbuf will be left intact. The
+ * mbufs of a pool with pinned external buffers are not detached.
  *
  * @param m
  *   The indirect attached packet mbuf.
@@ -1575,10 +1779,14 @@ static inline void rte_pktmbuf_detach(struct rte_mbuf *m)
 	uint32_t mbuf_size, buf_len;
 	uint16_t priv_size;
 
-	if (RTE_MBUF_HAS_EXTBUF(m))
+	if (RTE_MBUF_HAS_EXTBUF(m)) {
+		/* a pinned external buffer stays attached to its mbuf */
+		if (RTE_MBUF_HAS_PINNED_EXTBUF(m))
+			return;
 		__rte_pktmbuf_free_extbuf(m);
-	else
+	} else {
 		__rte_pktmbuf_free_direct(m);
+	}
 
 	priv_size = rte_pktmbuf_priv_size(mp);
 	mbuf_size = (uint32_t)(sizeof(struct rte_mbuf) + priv_size);
@@ -1593,6 +1801,38 @@ static inline void rte_pktmbuf_detach(struct rte_mbuf *m)
 	m->ol_flags = 0;
 }
 
+/**
+ * @internal used by rte_pktmbuf_prefree_seg().
+ *
+ * Release the reference of a mbuf on its pinned external buffer, which
+ * is shared with other mbufs when its reference counter is not 1.
+ *
+ * @return
+ *   - 0 if the mbuf can be returned to its pool.
+ *   - 1 if the buffer is still used by other mbufs: the mbuf is returned
+ *     to its pool by the free callback of the buffer when the last of
+ *     them is freed.
+ */
+static inline int
+__rte_pktmbuf_pinned_extbuf_decref(struct rte_mbuf *m)
+{
+	struct rte_mbuf_ext_shared_info *shinfo = m->shinfo;
+
+	/* clear the offload flags, the mbuf is being freed */
+	m->ol_flags = EXT_ATTACHED_MBUF;
+
+	/* the buffer is not shared, no atomic operation */
+	if (likely(rte_mbuf_ext_refcnt_read(shinfo) == 1))
+		return 0;
+
+	if (rte_atomic16_add_return(&shinfo->refcnt_atomic, -1) != 0)
+		return 1;
+
+	/* last reference, reinitialize the counter before freeing */
+	rte_mbuf_ext_refcnt_set(shinfo, 1);
+	return 0;
+}
+
 /**
  * Decrease reference counter and unlink a mbuf segment
  *
@@ -1614,8 +1854,13 @@ rte_pktmbuf_prefree_seg(struct rte_mbuf *m)
 
 	if (likely(rte_mbuf_refcnt_read(m) == 1)) {
 
-		if (!RTE_MBUF_DIRECT(m))
+		if (!RTE_MBUF_DIRECT(m)) {
 			rte_pktmbuf_detach(m);
+			if (RTE_MBUF_HAS_EXTBUF(m) &&
+					RTE_MBUF_HAS_PINNED_EXTBUF(m) &&
+					__rte_pktmbuf_pinned_extbuf_decref(m))
+				return NULL;
+		}
 
 		if (m->next != NULL) {
 			m->next = NULL;
@@ -1626,8 +1871,13 @@ rte_pktmbuf_prefree_seg(struct rte_mbuf *m)
 
 	} else if (__rte_mbuf_refcnt_update(m, -1) == 0) {
 
-		if (!RTE_MBUF_DIRECT(m))
+		if (!RTE_MBUF_DIRECT(m)) {
 			rte_pktmbuf_detach(m);
+			if (RTE_MBUF_HAS_EXTBUF(m) &&
+					RTE_MBUF_HAS_PINNED_EXTBUF(m) &&
+					__rte_pktmbuf_pinned_extbuf_decref(m))
+				return NULL;
+		}
 
 		if (m->next != NULL) {
 			m->next = NULL;
@@ -1688,6 +1938,25 @@ static inline void rte_pktmbuf_free(struct rte_mbuf *m)
 	}
 }
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Free a bulk of packet mbufs back into their original mempools.
+ *
+ * Free a number of mbufs, and all their segments in case of chained
+ * buffers, like rte_pktmbuf_free() does for each of them. The segments
+ * returning to the same mempool one after the other are put back with
+ * one rte_mempool_put_bulk() call.
+ *
+ * @param mbufs
+ *   Array of pointers to packet mbufs. The array may contain NULL pointers.
+ * @param count
+ *   Array size.
+ */
+void __rte_experimental
+rte_pktmbuf_free_bulk(struct rte_mbuf **mbufs, unsigned int count);
+
 /**
  * Creates a "clone" of the given packet mbuf.
  *
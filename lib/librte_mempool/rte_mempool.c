@@ -11,6 +11,7 @@
 #include <unistd.h>
 #include <inttypes.h>
 #include <errno.h>
+#include <pthread.h>
 #include <sys/queue.h>
 #include <sys/mman.h>
 
@@ -44,6 +45,15 @@ EAL_REGISTER_TAILQ(rte_mempool_tailq)
 #define CALC_CACHE_FLUSHTHRESH(c)	\
 	((typeof(c))((c) * CACHE_FLUSHTHRESH_MULTIPLIER))
 
+/*
+ * An adaptive cache grows when it goes to the common pool at least once
+ * every CACHE_GROW_CALLS get/put calls, and shrinks when it goes there
+ * less than once every CACHE_SHRINK_CALLS calls.
+ */
+#define CACHE_GROW_CALLS	8
+#define CACHE_SHRINK_CALLS	256
+#define CACHE_MIN_SIZE_DIVISOR	8
+
 /*
  * return the greatest common divisor between a and b (fast algorithm)
  *
@@ -839,11 +849,81 @@ rte_mempool_free(struct rte_mempool *mp)
 }
 
 static void
-mempool_cache_init(struct rte_mempool_cache *cache, uint32_t size)
+mempool_cache_init(struct rte_mempool_cache *cache, uint32_t size,
+	int adaptive)
 {
 	cache->size = size;
 	cache->flushthresh = CALC_CACHE_FLUSHTHRESH(size);
 	cache->len = 0;
+	cache->min_size = adaptive ?
+		RTE_MAX(size / CACHE_MIN_SIZE_DIVISOR, 1U) : 0;
+	cache->max_size = size;
+	cache->adapt_ops = 0;
+	memset(&cache->stats, 0, sizeof(cache->stats));
+}
+
+/*
+ * Double or halve the size of an adaptive cache, depending on the number
+ * of get/put calls since the previous access to the common pool.
+ * The excess objects are flushed by the caller.
+ */
+void
+rte_mempool_cache_adapt(struct rte_mempool_cache *cache)
+{
+	uint64_t calls, ops;
+	uint32_t size;
+
+	ops = cache->stats.get_hit + cache->stats.get_miss +
+		cache->stats.put_hit + cache->stats.put_flush;
+	calls = ops - cache->adapt_ops;
+	cache->adapt_ops = ops;
+
+	if (calls <= CACHE_GROW_CALLS && cache->size < cache->max_size) {
+		size = RTE_MIN(cache->size * 2, cache->max_size);
+		cache->stats.grow++;
+	} else if (calls > CACHE_SHRINK_CALLS &&
+			cache->size > cache->min_size) {
+		size = RTE_MAX(cache->size / 2, cache->min_size);
+		cache->stats.shrink++;
+	} else
+		return;
+
+	cache->size = size;
+	cache->flushthresh = CALC_CACHE_FLUSHTHRESH(size);
+}
+
+/* get the statistics of one or all per-lcore caches */
+int __rte_experimental
+rte_mempool_cache_stats_get(const struct rte_mempool *mp,
+	unsigned int lcore_id, struct rte_mempool_cache_stats *stats)
+{
+	const struct rte_mempool_cache_stats *cs;
+	unsigned int i;
+
+	if (mp == NULL || stats == NULL ||
+			(lcore_id >= RTE_MAX_LCORE && lcore_id != LCORE_ID_ANY))
+		return -EINVAL;
+
+	if (mp->cache_size == 0)
+		return -ENOENT;
+
+	if (lcore_id != LCORE_ID_ANY) {
+		*stats = mp->local_cache[lcore_id].stats;
+		return 0;
+	}
+
+	memset(stats, 0, sizeof(*stats));
+	for (i = 0; i != RTE_MAX_LCORE; i++) {
+		cs = &mp->local_cache[i].stats;
+		stats->get_hit += cs->get_hit;
+		stats->get_miss += cs->get_miss;
+		stats->put_hit += cs->put_hit;
+		stats->put_flush += cs->put_flush;
+		stats->grow += cs->grow;
+		stats->shrink += cs->shrink;
+	}
+
+	return 0;
 }
 
 /*
@@ -869,7 +949,7 @@ rte_mempool_cache_create(uint32_t size, int socket_id)
 		return NULL;
 	}
 
-	mempool_cache_init(cache, size);
+	mempool_cache_init(cache, size, 0);
 
 	return cache;
 }
@@ -885,6 +965,107 @@ rte_mempool_cache_free(struct rte_mempool_cache *cache)
 	rte_free(cache);
 }
 
+RTE_DEFINE_PER_LCORE(struct rte_mempool_thread_caches, _mempool_thread_caches);
+
+/* key whose destructor flushes the caches of an exiting thread */
+static pthread_key_t mempool_thread_key;
+static pthread_once_t mempool_thread_once = PTHREAD_ONCE_INIT;
+static int mempool_thread_key_ret;
+
+/* flush, release and remove a registered cache */
+static void
+mempool_thread_cache_remove(struct rte_mempool_thread_caches *tc, uint32_t i)
+{
+	rte_mempool_cache_flush(tc->ent[i].cache, tc->ent[i].mp);
+	if (tc->ent[i].owned)
+		rte_mempool_cache_free(tc->ent[i].cache);
+
+	tc->ent[i] = tc->ent[--tc->num];
+}
+
+/* called at the exit of a thread having registered caches */
+static void
+mempool_thread_exit(void *arg)
+{
+	struct rte_mempool_thread_caches *tc = arg;
+
+	while (tc->num != 0)
+		mempool_thread_cache_remove(tc, tc->num - 1);
+}
+
+static void
+mempool_thread_key_create(void)
+{
+	mempool_thread_key_ret = pthread_key_create(&mempool_thread_key,
+		mempool_thread_exit);
+}
+
+/* register a cache for the calling non-EAL thread */
+int __rte_experimental
+rte_mempool_thread_cache_register(struct rte_mempool *mp,
+	struct rte_mempool_cache *cache)
+{
+	struct rte_mempool_thread_caches *tc;
+	uint32_t i, size;
+	int owned;
+
+	if (mp == NULL || rte_lcore_id() < RTE_MAX_LCORE)
+		return -EINVAL;
+
+	tc = &RTE_PER_LCORE(_mempool_thread_caches);
+	for (i = 0; i != tc->num; i++) {
+		if (tc->ent[i].mp == mp)
+			return -EEXIST;
+	}
+	if (tc->num == RTE_DIM(tc->ent))
+		return -ENOSPC;
+
+	/* the key value is not NULL, so the destructor runs at thread exit */
+	pthread_once(&mempool_thread_once, mempool_thread_key_create);
+	if (mempool_thread_key_ret != 0 ||
+			pthread_setspecific(mempool_thread_key, tc) != 0)
+		return -ENOMEM;
+
+	owned = 0;
+	if (cache == NULL) {
+		size = mp->cache_size;
+		if (size == 0)
+			size = RTE_MEMPOOL_CACHE_MAX_SIZE;
+		cache = rte_mempool_cache_create(size, mp->socket_id);
+		if (cache == NULL)
+			return -ENOMEM;
+		owned = 1;
+	}
+
+	tc->ent[tc->num].mp = mp;
+	tc->ent[tc->num].cache = cache;
+	tc->ent[tc->num].owned = owned;
+	tc->num++;
+
+	return 0;
+}
+
+/* flush and unregister the cache of the calling thread */
+int __rte_experimental
+rte_mempool_thread_cache_unregister(struct rte_mempool *mp)
+{
+	struct rte_mempool_thread_caches *tc;
+	uint32_t i;
+
+	if (mp == NULL)
+		return -EINVAL;
+
+	tc = &RTE_PER_LCORE(_mempool_thread_caches);
+	for (i = 0; i != tc->num; i++) {
+		if (tc->ent[i].mp == mp) {
+			mempool_thread_cache_remove(tc, i);
+			return 0;
+		}
+	}
+
+	return -ENOENT;
+}
+
 /* create an empty mempool */
 struct rte_mempool *
 rte_mempool_create_empty(const char *name, unsigned n, unsigned elt_size,
@@ -996,7 +1177,7 @@ rte_mempool_create_empty(const char *name, unsigned n, unsigned elt_size,
 	if (cache_size != 0) {
 		for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++)
 			mempool_cache_init(&mp->local_cache[lcore_id],
-					   cache_size);
+				cache_size, flags & MEMPOOL_F_CACHE_ADAPTIVE);
 	}
 
 	te->data = mp;
@@ -1160,21 +1341,38 @@ rte_mempool_in_use_count(const struct rte_mempool *mp)
 static unsigned
 rte_mempool_dump_cache(FILE *f, const struct rte_mempool *mp)
 {
+	const struct rte_mempool_cache *cache;
+	const struct rte_mempool_cache_stats *cs;
 	unsigned lcore_id;
 	unsigned count = 0;
 	unsigned cache_count;
 
 	fprintf(f, "  internal cache infos:\n");
 	fprintf(f, "    cache_size=%"PRIu32"\n", mp->cache_size);
+	if (mp->flags & MEMPOOL_F_CACHE_ADAPTIVE)
+		fprintf(f, "    cache_adaptive\n");
 
 	if (mp->cache_size == 0)
 		return count;
 
 	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
-		cache_count = mp->local_cache[lcore_id].len;
+		cache = &mp->local_cache[lcore_id];
+		cache_count = cache->len;
 		fprintf(f, "    cache_count[%u]=%"PRIu32"\n",
 			lcore_id, cache_count);
 		count += cache_count;
+
+		/* only dump the caches in use */
+		cs = &cache->stats;
+		if (cs->get_hit + cs->get_miss + cs->put_hit +
+				cs->put_flush == 0)
+			continue;
+		fprintf(f, "    cache_stats[%u]: size=%"PRIu32
+			" get_hit=%"PRIu64" get_miss=%"PRIu64
+			" put_hit=%"PRIu64" put_flush=%"PRIu64
+			" grow=%"PRIu64" shrink=%"PRIu64"\n",
+			lcore_id, cache->size, cs->get_hit, cs->get_miss,
+			cs->put_hit, cs->put_flush, cs->grow, cs->shrink);
 	}
 	fprintf(f, "    total_cache_count=%u\n", count);
 	return count;
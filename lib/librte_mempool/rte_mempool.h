@@ -30,7 +30,9 @@
  * rte_mempool_get() or rte_mempool_put() performance will suffer when called
  * by non-EAL threads. Instead, non-EAL threads should call
  * rte_mempool_generic_get() or rte_mempool_generic_put() with a user cache
- * created with rte_mempool_cache_create().
+ * created with rte_mempool_cache_create(), or register such a cache with
+ * rte_mempool_thread_cache_register() so that it is used by the usual
+ * mempool functions.
  */
 
 #include <stdio.h>
@@ -77,6 +79,23 @@ struct rte_mempool_debug_stats {
 } __rte_cache_aligned;
 #endif
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Statistics of a mempool cache, counted per get or put call. They are
+ * only counted for adaptive caches, or for all the caches when
+ * RTE_LIBRTE_MEMPOOL_DEBUG is enabled.
+ */
+struct rte_mempool_cache_stats {
+	uint64_t get_hit;   /**< Gets served from the cache. */
+	uint64_t get_miss;  /**< Gets going to the common pool. */
+	uint64_t put_hit;   /**< Puts kept in the cache. */
+	uint64_t put_flush; /**< Puts flushing objects to the common pool. */
+	uint64_t grow;      /**< Size increases of an adaptive cache. */
+	uint64_t shrink;    /**< Size decreases of an adaptive cache. */
+};
+
 /**
  * A structure that stores a per-core object cache.
  */
@@ -84,6 +103,10 @@ struct rte_mempool_cache {
 	uint32_t size;	      /**< Size of the cache */
 	uint32_t flushthresh; /**< Threshold before we flush excess elements */
 	uint32_t len;	      /**< Current cache count */
+	uint32_t min_size;    /**< Min size of an adaptive cache, 0 if fixed */
+	uint32_t max_size;    /**< Max size of an adaptive cache */
+	uint64_t adapt_ops;   /**< Number of calls at the last size update */
+	struct rte_mempool_cache_stats stats; /**< Cache statistics */
 	/*
 	 * Cache is allocated to this size to allow it to overflow in certain
 	 * cases to avoid needless emptying of cache.
@@ -91,6 +114,24 @@ struct rte_mempool_cache {
 	void *objs[RTE_MEMPOOL_CACHE_MAX_SIZE * 3]; /**< Cache objects */
 } __rte_cache_aligned;
 
+/** Maximum number of caches registered by a non-EAL thread. */
+#define RTE_MEMPOOL_THREAD_CACHE_MAX 8
+
+/**
+ * @internal The caches registered by a non-EAL thread, one per mempool.
+ */
+struct rte_mempool_thread_caches {
+	uint32_t num; /**< Number of registered caches */
+	struct {
+		struct rte_mempool *mp;          /**< Mempool of the cache */
+		struct rte_mempool_cache *cache; /**< Registered cache */
+		int owned;                       /**< Cache created at register */
+	} ent[RTE_MEMPOOL_THREAD_CACHE_MAX];
+};
+
+/** @internal The caches registered by the calling thread. */
+RTE_DECLARE_PER_LCORE(struct rte_mempool_thread_caches, _mempool_thread_caches);
+
 /**
  * A structure that stores the size of mempool elements.
  */
@@ -264,6 +305,7 @@ struct rte_mempool {
 #define MEMPOOL_F_POOL_CREATED   0x0010 /**< Internal: pool is created. */
 #define MEMPOOL_F_NO_IOVA_CONTIG 0x0020 /**< Don't need IOVA contiguous objs. */
 #define MEMPOOL_F_NO_PHYS_CONTIG MEMPOOL_F_NO_IOVA_CONTIG /* deprecated */
+#define MEMPOOL_F_CACHE_ADAPTIVE 0x0040 /**< Adapt per-lcore cache sizes. */
 
 /**
  * @internal When debug is enabled, store some statistics.
@@ -295,6 +337,27 @@ struct rte_mempool {
 #define __MEMPOOL_CONTIG_BLOCKS_STAT_ADD(mp, name, n) do {} while (0)
 #endif
 
+/**
+ * @internal Increment a statistics counter of a mempool cache. Outside of
+ * debug builds, only adaptive caches, which size themselves from these
+ * counters, update them.
+ *
+ * @param cache
+ *   Pointer to the mempool cache.
+ * @param name
+ *   Name of the statistics counter
+ */
+#ifdef RTE_LIBRTE_MEMPOOL_DEBUG
+#define __MEMPOOL_CACHE_STAT_INC(cache, name) do {              \
+		(cache)->stats.name++;                          \
+	} while (0)
+#else
+#define __MEMPOOL_CACHE_STAT_INC(cache, name) do {              \
+		if ((cache)->min_size != 0)                     \
+			(cache)->stats.name++;                  \
+	} while (0)
+#endif
+
 /**
  * Calculate the size of the mempool header.
  *
@@ -956,6 +1019,11 @@ typedef void (rte_mempool_ctor_t)(struct rte_mempool *, void *);
  *     "single-consumer". Otherwise, it is "multi-consumers".
  *   - MEMPOOL_F_NO_IOVA_CONTIG: If set, allocated objects won't
  *     necessarily be contiguous in IO memory.
+ *   - MEMPOOL_F_CACHE_ADAPTIVE: If set, the size of each per-lcore cache
+ *     varies between cache_size / 8 and cache_size, growing when the
+ *     lcore often gets or puts objects from or to the common pool, and
+ *     shrinking when it seldom does, so that less objects are kept idle
+ *     in the caches.
  * @return
  *   The pointer to the new allocated mempool, on success. NULL on error
  *   with rte_errno set appropriately. Possible rte_errno values include:
@@ -1296,28 +1364,132 @@ rte_mempool_cache_create(uint32_t size, int socket_id);
 void
 rte_mempool_cache_free(struct rte_mempool_cache *cache);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Register a mempool cache for the calling non-EAL thread.
+ *
+ * Once registered, the cache is returned by rte_mempool_default_cache()
+ * in this thread, so that rte_mempool_get(), rte_mempool_put() and the
+ * functions built on them, like rte_pktmbuf_alloc() or rte_pktmbuf_free()
+ * in PMD Tx completion paths, use it like the per-lcore cache of an EAL
+ * thread. The cache is flushed to the mempool, and freed if it was
+ * created by this function, when the thread exits or calls
+ * rte_mempool_thread_cache_unregister().
+ *
+ * A cache must be registered for one mempool only, and the mempool must
+ * not be freed before the cache is unregistered.
+ *
+ * @param mp
+ *   A pointer to the mempool structure.
+ * @param cache
+ *   A pointer to a cache created with rte_mempool_cache_create(), or NULL
+ *   to create one of the mempool cache size, or of
+ *   RTE_MEMPOOL_CACHE_MAX_SIZE if the mempool has no per-lcore caches.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: Invalid parameters, or the calling thread is an EAL thread.
+ *   - -EEXIST: A cache is already registered for this mempool.
+ *   - -ENOSPC: RTE_MEMPOOL_THREAD_CACHE_MAX caches are already registered.
+ *   - -ENOMEM: Not enough memory to create the cache.
+ */
+int __rte_experimental
+rte_mempool_thread_cache_register(struct rte_mempool *mp,
+	struct rte_mempool_cache *cache);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Flush and unregister the mempool cache of the calling non-EAL thread.
+ *
+ * The cache is freed if it was created by
+ * rte_mempool_thread_cache_register().
+ *
+ * @param mp
+ *   A pointer to the mempool structure.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: Invalid parameters.
+ *   - -ENOENT: No cache is registered for this mempool.
+ */
+int __rte_experimental
+rte_mempool_thread_cache_unregister(struct rte_mempool *mp);
+
+/**
+ * @internal Get the cache registered for a mempool by the calling thread.
+ */
+static __rte_always_inline struct rte_mempool_cache *
+__mempool_thread_cache(const struct rte_mempool *mp)
+{
+	struct rte_mempool_thread_caches *tc;
+	uint32_t i;
+
+	tc = &RTE_PER_LCORE(_mempool_thread_caches);
+	for (i = 0; i != tc->num; i++) {
+		if (tc->ent[i].mp == mp)
+			return tc->ent[i].cache;
+	}
+
+	return NULL;
+}
+
 /**
  * Get a pointer to the per-lcore default mempool cache.
  *
  * @param mp
  *   A pointer to the mempool structure.
  * @param lcore_id
- *   The logical core id.
+ *   The logical core id, or LCORE_ID_ANY for the cache registered by the
+ *   calling non-EAL thread with rte_mempool_thread_cache_register().
  * @return
- *   A pointer to the mempool cache or NULL if disabled or non-EAL thread.
+ *   A pointer to the mempool cache or NULL if disabled or non-EAL thread
+ *   without registered cache.
  */
 static __rte_always_inline struct rte_mempool_cache *
 rte_mempool_default_cache(struct rte_mempool *mp, unsigned lcore_id)
 {
-	if (mp->cache_size == 0)
-		return NULL;
+	if (unlikely(lcore_id >= RTE_MAX_LCORE))
+		return __mempool_thread_cache(mp);
 
-	if (lcore_id >= RTE_MAX_LCORE)
+	if (mp->cache_size == 0)
 		return NULL;
 
 	return &mp->local_cache[lcore_id];
 }
 
+/**
+ * @internal Update the size of an adaptive cache on a cache miss or flush,
+ * depending on the number of calls since the previous one.
+ *
+ * @param cache
+ *   A pointer to the mempool cache.
+ */
+void
+rte_mempool_cache_adapt(struct rte_mempool_cache *cache);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Get the statistics of a per-lcore default mempool cache.
+ *
+ * @param mp
+ *   A pointer to the mempool structure.
+ * @param lcore_id
+ *   The logical core id, LCORE_ID_ANY for the sum of all the caches.
+ * @param stats
+ *   A pointer to the structure to fill with the statistics.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: Invalid parameters.
+ *   - -ENOENT: The mempool has no per-lcore caches.
+ */
+int __rte_experimental
+rte_mempool_cache_stats_get(const struct rte_mempool *mp,
+	unsigned int lcore_id, struct rte_mempool_cache_stats *stats);
+
 /**
  * Flush a user-owned mempool cache to the specified mempool.
  *
@@ -1359,9 +1531,15 @@ __mempool_generic_put(struct rte_mempool *mp, void * const *obj_table,
 	/* increment stat now, adding in mempool always success */
 	__MEMPOOL_STAT_ADD(mp, put, n);
 
-	/* No cache provided or if put would overflow mem allocated for cache */
-	if (unlikely(cache == NULL || n > RTE_MEMPOOL_CACHE_MAX_SIZE))
+	/* No cache provided */
+	if (unlikely(cache == NULL))
+		goto ring_enqueue;
+
+	/* Put would overflow mem allocated for cache */
+	if (unlikely(n > RTE_MEMPOOL_CACHE_MAX_SIZE)) {
+		__MEMPOOL_CACHE_STAT_INC(cache, put_flush);
 		goto ring_enqueue;
+	}
 
 	cache_objs = &cache->objs[cache->len];
 
@@ -1377,7 +1555,16 @@ __mempool_generic_put(struct rte_mempool *mp, void * const *obj_table,
 
 	cache->len += n;
 
-	if (cache->len >= cache->flushthresh) {
+	if (cache->len < cache->flushthresh) {
+		__MEMPOOL_CACHE_STAT_INC(cache, put_hit);
+		return;
+	}
+
+	__MEMPOOL_CACHE_STAT_INC(cache, put_flush);
+	if (cache->min_size != 0)
+		rte_mempool_cache_adapt(cache);
+
+	if (cache->len > cache->size) {
 		rte_mempool_ops_enqueue_bulk(mp, &cache->objs[cache->size],
 				cache->len - cache->size);
 		cache->len = cache->size;
@@ -1480,16 +1667,30 @@ __mempool_generic_get(struct rte_mempool *mp, void **obj_table,
 	uint32_t index, len;
 	void **cache_objs;
 
-	/* No cache provided or cannot be satisfied from cache */
-	if (unlikely(cache == NULL || n >= cache->size))
+	/* No cache provided */
+	if (unlikely(cache == NULL))
 		goto ring_dequeue;
 
+	/* Cannot be satisfied from cache */
+	if (unlikely(n >= cache->size)) {
+		__MEMPOOL_CACHE_STAT_INC(cache, get_miss);
+		if (cache->min_size != 0)
+			rte_mempool_cache_adapt(cache);
+		goto ring_dequeue;
+	}
+
 	cache_objs = cache->objs;
 
 	/* Can this be satisfied from the cache? */
 	if (cache->len < n) {
+		uint32_t req;
+
+		__MEMPOOL_CACHE_STAT_INC(cache, get_miss);
+		if (cache->min_size != 0)
+			rte_mempool_cache_adapt(cache);
+
 		/* No. Backfill the cache first, and then fill from it */
-		uint32_t req = n + (cache->size - cache->len);
+		req = n + (cache->size - cache->len);
 
 		/* How many do we require i.e. number to fill the cache + the request */
 		ret = rte_mempool_ops_dequeue_bulk(mp,
@@ -1505,7 +1706,8 @@ __mempool_generic_get(struct rte_mempool *mp, void **obj_table,
 		}
 
 		cache->len += req;
-	}
+	} else
+		__MEMPOOL_CACHE_STAT_INC(cache, get_hit);
 
 	/* Now fill in the response ... */
 	for (index = 0, len = cache->len - 1; index < n; ++index, len--, obj_table++)
@@ -0,0 +1,555 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2018 Intel Corporation
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/queue.h>
+
+#include <rte_eal.h>
+#include <rte_eal_memconfig.h>
+#include <rte_errno.h>
+#include <rte_log.h>
+#include <rte_malloc.h>
+#include <rte_mempool.h>
+#include <rte_rwlock.h>
+#include <rte_string_fns.h>
+#include <rte_tailq.h>
+
+#include "rte_rib.h"
+
+TAILQ_HEAD(rte_rib_list, rte_tailq_entry);
+static struct rte_tailq_elem rte_rib_tailq = {
+	.name = "RTE_RIB",
+};
+EAL_REGISTER_TAILQ(rte_rib_tailq)
+
+#define RTE_RIB_VALID_NODE	1
+
+/** Node of the compressed binary trie, either a route or a branch */
+struct rte_rib_node {
+	struct rte_rib_node *left;
+	struct rte_rib_node *right;
+	struct rte_rib_node *parent;
+	uint32_t ip;
+	uint8_t depth;
+	uint8_t flag;
+	uint64_t nh;
+	__extension__ uint64_t ext[0];
+};
+
+struct rte_rib {
+	char name[RTE_RIB_NAMESIZE];
+	struct rte_rib_node *tree;
+	struct rte_mempool *node_pool;
+	uint32_t cur_nodes;
+	uint32_t cur_routes;
+	uint32_t max_nodes;
+	uint32_t ext_sz;
+};
+
+static inline bool
+is_valid_node(const struct rte_rib_node *node)
+{
+	return (node->flag & RTE_RIB_VALID_NODE) == RTE_RIB_VALID_NODE;
+}
+
+static inline bool
+is_right_node(const struct rte_rib_node *node)
+{
+	return node->parent->right == node;
+}
+
+/* Check if ip1 is covered by the ip2/depth prefix */
+static inline bool
+is_covered(uint32_t ip1, uint32_t ip2, uint8_t depth)
+{
+	return ((ip1 ^ ip2) & rte_rib_depth_to_mask(depth)) == 0;
+}
+
+/* Child of a node on the path to ip */
+static inline struct rte_rib_node *
+get_nxt_node(struct rte_rib_node *node, uint32_t ip)
+{
+	if (node->depth == RTE_RIB_MAXDEPTH)
+		return NULL;
+	return (ip & (1U << (31 - node->depth))) ? node->right : node->left;
+}
+
+static struct rte_rib_node *
+node_alloc(struct rte_rib *rib)
+{
+	struct rte_rib_node *ent;
+
+	if (rte_mempool_get(rib->node_pool, (void **)&ent) != 0)
+		return NULL;
+	memset(ent, 0, sizeof(*ent) + rib->ext_sz);
+	rib->cur_nodes++;
+	return ent;
+}
+
+static void
+node_free(struct rte_rib *rib, struct rte_rib_node *ent)
+{
+	rib->cur_nodes--;
+	rte_mempool_put(rib->node_pool, ent);
+}
+
+struct rte_rib_node * __rte_experimental
+rte_rib_lookup(struct rte_rib *rib, uint32_t ip)
+{
+	struct rte_rib_node *cur, *prev = NULL;
+
+	if (rib == NULL) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	cur = rib->tree;
+	while ((cur != NULL) && is_covered(ip, cur->ip, cur->depth)) {
+		if (is_valid_node(cur))
+			prev = cur;
+		cur = get_nxt_node(cur, ip);
+	}
+	return prev;
+}
+
+struct rte_rib_node * __rte_experimental
+rte_rib_lookup_shortest(struct rte_rib *rib, uint32_t ip)
+{
+	struct rte_rib_node *cur;
+
+	if (rib == NULL) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	cur = rib->tree;
+	while ((cur != NULL) && is_covered(ip, cur->ip, cur->depth)) {
+		if (is_valid_node(cur))
+			return cur;
+		cur = get_nxt_node(cur, ip);
+	}
+	return NULL;
+}
+
+struct rte_rib_node * __rte_experimental
+rte_rib_lookup_parent(struct rte_rib_node *ent)
+{
+	struct rte_rib_node *tmp;
+
+	if (ent == NULL)
+		return NULL;
+	tmp = ent->parent;
+	while ((tmp != NULL) && !is_valid_node(tmp))
+		tmp = tmp->parent;
+	return tmp;
+}
+
+/* Node of ip/depth, either a route or a branch */
+static struct rte_rib_node *
+find_node(struct rte_rib *rib, uint32_t ip, uint8_t depth)
+{
+	struct rte_rib_node *cur = rib->tree;
+
+	while (cur != NULL) {
+		if ((cur->ip == ip) && (cur->depth == depth))
+			return cur;
+		if ((cur->depth > depth) || !is_covered(ip, cur->ip, cur->depth))
+			break;
+		cur = get_nxt_node(cur, ip);
+	}
+	return NULL;
+}
+
+struct rte_rib_node * __rte_experimental
+rte_rib_lookup_exact(struct rte_rib *rib, uint32_t ip, uint8_t depth)
+{
+	struct rte_rib_node *cur;
+
+	if ((rib == NULL) || (depth > RTE_RIB_MAXDEPTH)) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	cur = find_node(rib, ip & rte_rib_depth_to_mask(depth), depth);
+	if ((cur != NULL) && is_valid_node(cur))
+		return cur;
+	return NULL;
+}
+
+/*
+ * Walk the subtree of ip/depth in depth first order, starting after
+ * last, and return the next route more specific than ip/depth.
+ * With RTE_RIB_GET_NXT_COVER, the subtree of a returned route is skipped.
+ */
+struct rte_rib_node * __rte_experimental
+rte_rib_get_nxt(struct rte_rib *rib, uint32_t ip, uint8_t depth,
+	struct rte_rib_node *last, int flag)
+{
+	struct rte_rib_node *root, *tmp;
+	bool skip;
+
+	if ((rib == NULL) || (depth > RTE_RIB_MAXDEPTH)) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	ip &= rte_rib_depth_to_mask(depth);
+
+	/* First node of the path which is covered by ip/depth */
+	root = rib->tree;
+	while ((root != NULL) && (root->depth < depth))
+		root = get_nxt_node(root, ip);
+	if ((root == NULL) || !is_covered(root->ip, ip, depth))
+		return NULL;
+
+	if (last == NULL) {
+		if (is_valid_node(root) && (root->depth > depth))
+			return root;
+		tmp = root;
+		skip = false;
+	} else {
+		tmp = last;
+		skip = (flag == RTE_RIB_GET_NXT_COVER);
+	}
+
+	for (;;) {
+		if (!skip && (tmp->left != NULL))
+			tmp = tmp->left;
+		else if (!skip && (tmp->right != NULL))
+			tmp = tmp->right;
+		else {
+			/* Climb up to the first right sibling not visited */
+			while ((tmp != root) && (is_right_node(tmp) ||
+					(tmp->parent->right == NULL)))
+				tmp = tmp->parent;
+			if (tmp == root)
+				return NULL;
+			tmp = tmp->parent->right;
+		}
+		if (is_valid_node(tmp))
+			return tmp;
+		skip = false;
+	}
+}
+
+void __rte_experimental
+rte_rib_remove(struct rte_rib *rib, uint32_t ip, uint8_t depth)
+{
+	struct rte_rib_node *cur, *prev, *child;
+
+	cur = rte_rib_lookup_exact(rib, ip, depth);
+	if (cur == NULL)
+		return;
+
+	rib->cur_routes--;
+	cur->flag &= ~RTE_RIB_VALID_NODE;
+	/* Remove the branches which are no longer needed */
+	while (!is_valid_node(cur)) {
+		if ((cur->left != NULL) && (cur->right != NULL))
+			return;
+		child = (cur->left == NULL) ? cur->right : cur->left;
+		if (child != NULL)
+			child->parent = cur->parent;
+		if (cur->parent == NULL) {
+			rib->tree = child;
+			node_free(rib, cur);
+			return;
+		}
+		if (cur->parent->left == cur)
+			cur->parent->left = child;
+		else
+			cur->parent->right = child;
+		prev = cur;
+		cur = cur->parent;
+		node_free(rib, prev);
+	}
+}
+
+struct rte_rib_node * __rte_experimental
+rte_rib_insert(struct rte_rib *rib, uint32_t ip, uint8_t depth)
+{
+	struct rte_rib_node **tmp;
+	struct rte_rib_node *prev = NULL;
+	struct rte_rib_node *new_node, *common_node;
+	uint32_t common_prefix;
+	uint8_t common_depth;
+
+	if ((rib == NULL) || (depth > RTE_RIB_MAXDEPTH)) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	ip &= rte_rib_depth_to_mask(depth);
+	tmp = &rib->tree;
+
+	/* A branch may already exist for this prefix */
+	new_node = find_node(rib, ip, depth);
+	if (new_node != NULL) {
+		if (is_valid_node(new_node)) {
+			rte_errno = EEXIST;
+			return NULL;
+		}
+		new_node->nh = 0;
+		memset(new_node->ext, 0, rib->ext_sz);
+		new_node->flag |= RTE_RIB_VALID_NODE;
+		rib->cur_routes++;
+		return new_node;
+	}
+
+	new_node = node_alloc(rib);
+	if (new_node == NULL) {
+		rte_errno = ENOSPC;
+		return NULL;
+	}
+	new_node->ip = ip;
+	new_node->depth = depth;
+	new_node->flag = RTE_RIB_VALID_NODE;
+
+	/* Go down while the nodes of the path cover the new prefix */
+	while ((*tmp != NULL) && ((*tmp)->depth < depth) &&
+			is_covered(ip, (*tmp)->ip, (*tmp)->depth)) {
+		prev = *tmp;
+		tmp = (ip & (1U << (31 - prev->depth))) ?
+			&prev->right : &prev->left;
+	}
+
+	if (*tmp == NULL) {
+		new_node->parent = prev;
+		*tmp = new_node;
+		rib->cur_routes++;
+		return new_node;
+	}
+
+	/* Longest common prefix of the new prefix and the current node */
+	common_prefix = ip ^ (*tmp)->ip;
+	common_depth = RTE_MIN(depth, (*tmp)->depth);
+	if (common_prefix != 0)
+		common_depth = RTE_MIN(common_depth,
+			(uint8_t)__builtin_clz(common_prefix));
+
+	if (common_depth == depth) {
+		/* The new route covers the current node, insert it above */
+		if ((*tmp)->ip & (1U << (31 - depth)))
+			new_node->right = *tmp;
+		else
+			new_node->left = *tmp;
+		new_node->parent = (*tmp)->parent;
+		(*tmp)->parent = new_node;
+		*tmp = new_node;
+	} else {
+		/* Both diverge, insert a branch above them */
+		common_node = node_alloc(rib);
+		if (common_node == NULL) {
+			node_free(rib, new_node);
+			rte_errno = ENOSPC;
+			return NULL;
+		}
+		common_node->ip = ip & rte_rib_depth_to_mask(common_depth);
+		common_node->depth = common_depth;
+		common_node->parent = (*tmp)->parent;
+		new_node->parent = common_node;
+		(*tmp)->parent = common_node;
+		if (ip & (1U << (31 - common_depth))) {
+			common_node->left = *tmp;
+			common_node->right = new_node;
+		} else {
+			common_node->left = new_node;
+			common_node->right = *tmp;
+		}
+		*tmp = common_node;
+	}
+	rib->cur_routes++;
+	return new_node;
+}
+
+int __rte_experimental
+rte_rib_get_ip(const struct rte_rib_node *node, uint32_t *ip)
+{
+	if ((node == NULL) || (ip == NULL)) {
+		rte_errno = EINVAL;
+		return -EINVAL;
+	}
+	*ip = node->ip;
+	return 0;
+}
+
+int __rte_experimental
+rte_rib_get_depth(const struct rte_rib_node *node, uint8_t *depth)
+{
+	if ((node == NULL) || (depth == NULL)) {
+		rte_errno = EINVAL;
+		return -EINVAL;
+	}
+	*depth = node->depth;
+	return 0;
+}
+
+int __rte_experimental
+rte_rib_get_nh(const struct rte_rib_node *node, uint64_t *nh)
+{
+	if ((node == NULL) || (nh == NULL)) {
+		rte_errno = EINVAL;
+		return -EINVAL;
+	}
+	*nh = node->nh;
+	return 0;
+}
+
+int __rte_experimental
+rte_rib_set_nh(struct rte_rib_node *node, uint64_t nh)
+{
+	if (node == NULL) {
+		rte_errno = EINVAL;
+		return -EINVAL;
+	}
+	node->nh = nh;
+	return 0;
+}
+
+void * __rte_experimental
+rte_rib_get_ext(struct rte_rib_node *node)
+{
+	if (node == NULL) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+	return node->ext;
+}
+
+struct rte_rib * __rte_experimental
+rte_rib_create(const char *name, int socket_id,
+	const struct rte_rib_conf *conf)
+{
+	char mem_name[RTE_RIB_NAMESIZE];
+	struct rte_rib *rib = NULL;
+	struct rte_tailq_entry *te;
+	struct rte_rib_list *rib_list;
+	struct rte_mempool *node_pool;
+
+	/* Check user arguments. */
+	if ((name == NULL) || (conf == NULL) || (conf->max_nodes <= 0)) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	snprintf(mem_name, sizeof(mem_name), "RIB_%s", name);
+	node_pool = rte_mempool_create(mem_name, conf->max_nodes,
+		sizeof(struct rte_rib_node) + conf->ext_sz, 0, 0, NULL, NULL,
+		NULL, NULL, socket_id, 0);
+	if (node_pool == NULL) {
+		RTE_LOG(ERR, LPM,
+			"Can not allocate mempool for RIB %s\n", name);
+		return NULL;
+	}
+
+	snprintf(mem_name, sizeof(mem_name), "RIB_%s", name);
+	rib_list = RTE_TAILQ_CAST(rte_rib_tailq.head, rte_rib_list);
+
+	rte_rwlock_write_lock(RTE_EAL_TAILQ_RWLOCK);
+
+	/* guarantee there's no existing */
+	TAILQ_FOREACH(te, rib_list, next) {
+		rib = (struct rte_rib *)te->data;
+		if (strncmp(name, rib->name, RTE_RIB_NAMESIZE) == 0)
+			break;
+	}
+	rib = NULL;
+	if (te != NULL) {
+		rte_errno = EEXIST;
+		goto exit;
+	}
+
+	/* allocate tailq entry */
+	te = rte_zmalloc("RIB_TAILQ_ENTRY", sizeof(*te), 0);
+	if (te == NULL) {
+		RTE_LOG(ERR, LPM,
+			"Can not allocate tailq entry for RIB %s\n", name);
+		rte_errno = ENOMEM;
+		goto exit;
+	}
+
+	/* Allocate memory to store the RIB data structures. */
+	rib = rte_zmalloc_socket(mem_name,
+		sizeof(struct rte_rib), RTE_CACHE_LINE_SIZE, socket_id);
+	if (rib == NULL) {
+		RTE_LOG(ERR, LPM, "RIB %s memory allocation failed\n", name);
+		rte_free(te);
+		rte_errno = ENOMEM;
+		goto exit;
+	}
+
+	snprintf(rib->name, sizeof(rib->name), "%s", name);
+	rib->tree = NULL;
+	rib->max_nodes = conf->max_nodes;
+	rib->ext_sz = conf->ext_sz;
+	rib->node_pool = node_pool;
+
+	te->data = (void *)rib;
+	TAILQ_INSERT_TAIL(rib_list, te, next);
+
+exit:
+	rte_rwlock_write_unlock(RTE_EAL_TAILQ_RWLOCK);
+
+	if (rib == NULL)
+		rte_mempool_free(node_pool);
+
+	return rib;
+}
+
+struct rte_rib * __rte_experimental
+rte_rib_find_existing(const char *name)
+{
+	struct rte_rib *rib = NULL;
+	struct rte_tailq_entry *te;
+	struct rte_rib_list *rib_list;
+
+	rib_list = RTE_TAILQ_CAST(rte_rib_tailq.head, rte_rib_list);
+
+	rte_rwlock_read_lock(RTE_EAL_TAILQ_RWLOCK);
+	TAILQ_FOREACH(te, rib_list, next) {
+		rib = (struct rte_rib *) te->data;
+		if (strncmp(name, rib->name, RTE_RIB_NAMESIZE) == 0)
+			break;
+	}
+	rte_rwlock_read_unlock(RTE_EAL_TAILQ_RWLOCK);
+
+	if (te == NULL) {
+		rte_errno = ENOENT;
+		return NULL;
+	}
+
+	return rib;
+}
+
+void __rte_experimental
+rte_rib_free(struct rte_rib *rib)
+{
+	struct rte_tailq_entry *te;
+	struct rte_rib_list *rib_list;
+
+	if (rib == NULL)
+		return;
+
+	rib_list = RTE_TAILQ_CAST(rte_rib_tailq.head, rte_rib_list);
+
+	rte_rwlock_write_lock(RTE_EAL_TAILQ_RWLOCK);
+
+	/* find our tailq entry */
+	TAILQ_FOREACH(te, rib_list, next) {
+		if (te->data == (void *)rib)
+			break;
+	}
+	if (te != NULL)
+		TAILQ_REMOVE(rib_list, te, next);
+
+	rte_rwlock_write_unlock(RTE_EAL_TAILQ_RWLOCK);
+
+	/* All the nodes come from the pool */
+	rte_mempool_free(rib->node_pool);
+	rte_free(rib);
+	rte_free(te);
+}
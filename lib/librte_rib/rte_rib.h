@@ -0,0 +1,283 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2018 Intel Corporation
+ */
+
+#ifndef _RTE_RIB_H_
+#define _RTE_RIB_H_
+
+/**
+ * @file
+ * RTE RIB library: IPv4 Routing Information Base.
+ *
+ * The RIB stores the routes in a compressed binary trie, in which every
+ * node is either a route or a branching point between routes. It is the
+ * control plane structure from which dataplane structures, such as the
+ * FIB library ones, are built and updated incrementally.
+ *
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ */
+
+#include <stdint.h>
+
+#include <rte_compat.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Max number of characters in RIB name. */
+#define RTE_RIB_NAMESIZE	64
+
+/** Maximum depth value possible for IPv4 RIB. */
+#define RTE_RIB_MAXDEPTH	32
+
+/**
+ * rte_rib_get_nxt() flags
+ */
+enum {
+	/** Return all more specific routes, in depth first order */
+	RTE_RIB_GET_NXT_ALL,
+	/** Return only the more specific routes not covered by another one */
+	RTE_RIB_GET_NXT_COVER
+};
+
+struct rte_rib;
+struct rte_rib_node;
+
+/** RIB configuration structure */
+struct rte_rib_conf {
+	int max_nodes; /**< Maximum number of nodes, routes or branches */
+	/** Size of the user extension space of each node, in bytes */
+	unsigned int ext_sz;
+};
+
+/**
+ * Get an IPv4 mask from a prefix length.
+ *
+ * @param depth
+ *   Prefix length, 0 to 32
+ * @return
+ *   IPv4 mask in host byte order
+ */
+static inline uint32_t
+rte_rib_depth_to_mask(uint8_t depth)
+{
+	return (uint32_t)(UINT64_MAX << (32 - depth));
+}
+
+/**
+ * Lookup the longest prefix match of an IP address.
+ *
+ * @param rib
+ *   RIB object handle
+ * @param ip
+ *   IP address to look up, in host byte order
+ * @return
+ *   Node of the longest matching route, NULL if there is none
+ */
+struct rte_rib_node * __rte_experimental
+rte_rib_lookup(struct rte_rib *rib, uint32_t ip);
+
+/**
+ * Lookup the shortest prefix match of an IP address, that is the least
+ * specific route covering it.
+ *
+ * @param rib
+ *   RIB object handle
+ * @param ip
+ *   IP address to look up, in host byte order
+ * @return
+ *   Node of the shortest matching route, NULL if there is none
+ */
+struct rte_rib_node * __rte_experimental
+rte_rib_lookup_shortest(struct rte_rib *rib, uint32_t ip);
+
+/**
+ * Lookup the closest less specific route covering a route.
+ *
+ * @param ent
+ *   Node of a route
+ * @return
+ *   Node of the covering route, NULL if there is none
+ */
+struct rte_rib_node * __rte_experimental
+rte_rib_lookup_parent(struct rte_rib_node *ent);
+
+/**
+ * Lookup a route.
+ *
+ * @param rib
+ *   RIB object handle
+ * @param ip
+ *   Prefix of the route, in host byte order
+ * @param depth
+ *   Prefix length of the route
+ * @return
+ *   Node of the route, NULL if it does not exist
+ */
+struct rte_rib_node * __rte_experimental
+rte_rib_lookup_exact(struct rte_rib *rib, uint32_t ip, uint8_t depth);
+
+/**
+ * Iterate over the routes more specific than a given prefix.
+ * Starting with last set to NULL, each call returns the next route,
+ * until NULL is returned.
+ *
+ * @param rib
+ *   RIB object handle
+ * @param ip
+ *   Prefix of the subtree to iterate, in host byte order
+ * @param depth
+ *   Prefix length of the subtree to iterate
+ * @param last
+ *   Node returned by the previous call, NULL to start iterating
+ * @param flag
+ *   RTE_RIB_GET_NXT_ALL to return all the routes of the subtree,
+ *   RTE_RIB_GET_NXT_COVER to skip the routes covered by a returned one
+ * @return
+ *   Node of the next route, NULL at the end of the iteration
+ */
+struct rte_rib_node * __rte_experimental
+rte_rib_get_nxt(struct rte_rib *rib, uint32_t ip, uint8_t depth,
+	struct rte_rib_node *last, int flag);
+
+/**
+ * Remove a route.
+ *
+ * @param rib
+ *   RIB object handle
+ * @param ip
+ *   Prefix of the route, in host byte order
+ * @param depth
+ *   Prefix length of the route
+ */
+void __rte_experimental
+rte_rib_remove(struct rte_rib *rib, uint32_t ip, uint8_t depth);
+
+/**
+ * Insert a route. Its next hop is zero until set with rte_rib_set_nh().
+ *
+ * @param rib
+ *   RIB object handle
+ * @param ip
+ *   Prefix of the route, in host byte order
+ * @param depth
+ *   Prefix length of the route
+ * @return
+ *   Node of the new route, NULL on error, with rte_errno set to:
+ *    - EINVAL - invalid parameter passed to function
+ *    - EEXIST - the route already exists
+ *    - ENOSPC - no more nodes available
+ */
+struct rte_rib_node * __rte_experimental
+rte_rib_insert(struct rte_rib *rib, uint32_t ip, uint8_t depth);
+
+/**
+ * Get the prefix of a route.
+ *
+ * @param node
+ *   Node of a route
+ * @param ip
+ *   Output containing the prefix, in host byte order
+ * @return
+ *   0 on success, -EINVAL on invalid parameters
+ */
+int __rte_experimental
+rte_rib_get_ip(const struct rte_rib_node *node, uint32_t *ip);
+
+/**
+ * Get the prefix length of a route.
+ *
+ * @param node
+ *   Node of a route
+ * @param depth
+ *   Output containing the prefix length
+ * @return
+ *   0 on success, -EINVAL on invalid parameters
+ */
+int __rte_experimental
+rte_rib_get_depth(const struct rte_rib_node *node, uint8_t *depth);
+
+/**
+ * Get the next hop of a route.
+ *
+ * @param node
+ *   Node of a route
+ * @param nh
+ *   Output containing the next hop
+ * @return
+ *   0 on success, -EINVAL on invalid parameters
+ */
+int __rte_experimental
+rte_rib_get_nh(const struct rte_rib_node *node, uint64_t *nh);
+
+/**
+ * Set the next hop of a route.
+ *
+ * @param node
+ *   Node of a route
+ * @param nh
+ *   Next hop
+ * @return
+ *   0 on success, -EINVAL on invalid parameters
+ */
+int __rte_experimental
+rte_rib_set_nh(struct rte_rib_node *node, uint64_t nh);
+
+/**
+ * Get the user extension space of a route.
+ *
+ * @param node
+ *   Node of a route
+ * @return
+ *   Pointer to the ext_sz bytes set at RIB creation, zeroed when the
+ *   route is inserted, NULL on invalid parameters
+ */
+void * __rte_experimental
+rte_rib_get_ext(struct rte_rib_node *node);
+
+/**
+ * Create a RIB.
+ *
+ * @param name
+ *   RIB name
+ * @param socket_id
+ *   NUMA socket ID for RIB memory allocation
+ * @param conf
+ *   Structure containing the configuration
+ * @return
+ *   Handle to RIB object on success, NULL otherwise with rte_errno set to:
+ *    - EINVAL - invalid parameter passed to function
+ *    - EEXIST - a RIB with the same name already exists
+ *    - ENOMEM - no appropriate memory area found
+ */
+struct rte_rib * __rte_experimental
+rte_rib_create(const char *name, int socket_id,
+	const struct rte_rib_conf *conf);
+
+/**
+ * Find an existing RIB object and return a pointer to it.
+ *
+ * @param name
+ *   Name of the RIB object as passed to rte_rib_create()
+ * @return
+ *   Pointer to RIB object, NULL otherwise with rte_errno set to ENOENT
+ */
+struct rte_rib * __rte_experimental
+rte_rib_find_existing(const char *name);
+
+/**
+ * Free a RIB object.
+ *
+ * @param rib
+ *   RIB object handle
+ */
+void __rte_experimental
+rte_rib_free(struct rte_rib *rib);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_RIB_H_ */
@@ -0,0 +1,613 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2018 Intel Corporation
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/queue.h>
+
+#include <rte_eal.h>
+#include <rte_eal_memconfig.h>
+#include <rte_errno.h>
+#include <rte_log.h>
+#include <rte_malloc.h>
+#include <rte_mempool.h>
+#include <rte_rwlock.h>
+#include <rte_string_fns.h>
+#include <rte_tailq.h>
+
+#include "rte_rib6.h"
+
+TAILQ_HEAD(rte_rib6_list, rte_tailq_entry);
+static struct rte_tailq_elem rte_rib6_tailq = {
+	.name = "RTE_RIB6",
+};
+EAL_REGISTER_TAILQ(rte_rib6_tailq)
+
+#define RTE_RIB6_VALID_NODE	1
+
+/** Node of the compressed binary trie, either a route or a branch */
+struct rte_rib6_node {
+	struct rte_rib6_node *left;
+	struct rte_rib6_node *right;
+	struct rte_rib6_node *parent;
+	uint64_t nh;
+	uint8_t ip[RTE_RIB6_IPV6_ADDR_SIZE];
+	uint8_t depth;
+	uint8_t flag;
+	__extension__ uint64_t ext[0];
+};
+
+struct rte_rib6 {
+	char name[RTE_RIB6_NAMESIZE];
+	struct rte_rib6_node *tree;
+	struct rte_mempool *node_pool;
+	uint32_t cur_nodes;
+	uint32_t cur_routes;
+	uint32_t max_nodes;
+	uint32_t ext_sz;
+};
+
+static inline bool
+is_valid_node(const struct rte_rib6_node *node)
+{
+	return (node->flag & RTE_RIB6_VALID_NODE) == RTE_RIB6_VALID_NODE;
+}
+
+static inline bool
+is_right_node(const struct rte_rib6_node *node)
+{
+	return node->parent->right == node;
+}
+
+/* Bit of an address at position depth, from the most significant one */
+static inline int
+get_dir(const uint8_t ip[RTE_RIB6_IPV6_ADDR_SIZE], uint8_t depth)
+{
+	return (ip[depth / 8] >> (7 - depth % 8)) & 1;
+}
+
+static inline uint8_t
+depth_to_byte_mask(uint8_t depth, int byte)
+{
+	int bits = (int)depth - byte * 8;
+
+	if (bits >= 8)
+		return UINT8_MAX;
+	if (bits <= 0)
+		return 0;
+	return (uint8_t)(UINT8_MAX << (8 - bits));
+}
+
+/* Check if ip1 is covered by the ip2/depth prefix */
+static inline bool
+is_covered(const uint8_t ip1[RTE_RIB6_IPV6_ADDR_SIZE],
+	const uint8_t ip2[RTE_RIB6_IPV6_ADDR_SIZE], uint8_t depth)
+{
+	int i;
+
+	for (i = 0; i < RTE_RIB6_IPV6_ADDR_SIZE; i++)
+		if ((ip1[i] ^ ip2[i]) & depth_to_byte_mask(depth, i))
+			return false;
+	return true;
+}
+
+static inline void
+mask_ip(uint8_t ip[RTE_RIB6_IPV6_ADDR_SIZE], uint8_t depth)
+{
+	int i;
+
+	for (i = 0; i < RTE_RIB6_IPV6_ADDR_SIZE; i++)
+		ip[i] &= depth_to_byte_mask(depth, i);
+}
+
+/* Length of the longest common prefix of two addresses */
+static inline uint8_t
+common_prefix_len(const uint8_t ip1[RTE_RIB6_IPV6_ADDR_SIZE],
+	const uint8_t ip2[RTE_RIB6_IPV6_ADDR_SIZE])
+{
+	int i;
+
+	for (i = 0; i < RTE_RIB6_IPV6_ADDR_SIZE; i++)
+		if (ip1[i] != ip2[i])
+			return i * 8 +
+				__builtin_clz((uint32_t)(ip1[i] ^ ip2[i])) - 24;
+	return RTE_RIB6_MAXDEPTH;
+}
+
+/* Child of a node on the path to ip */
+static inline struct rte_rib6_node *
+get_nxt_node(struct rte_rib6_node *node,
+	const uint8_t ip[RTE_RIB6_IPV6_ADDR_SIZE])
+{
+	if (node->depth == RTE_RIB6_MAXDEPTH)
+		return NULL;
+	return get_dir(ip, node->depth) ? node->right : node->left;
+}
+
+static struct rte_rib6_node *
+node_alloc(struct rte_rib6 *rib)
+{
+	struct rte_rib6_node *ent;
+
+	if (rte_mempool_get(rib->node_pool, (void **)&ent) != 0)
+		return NULL;
+	memset(ent, 0, sizeof(*ent) + rib->ext_sz);
+	rib->cur_nodes++;
+	return ent;
+}
+
+static void
+node_free(struct rte_rib6 *rib, struct rte_rib6_node *ent)
+{
+	rib->cur_nodes--;
+	rte_mempool_put(rib->node_pool, ent);
+}
+
+struct rte_rib6_node * __rte_experimental
+rte_rib6_lookup(struct rte_rib6 *rib,
+	const uint8_t ip[RTE_RIB6_IPV6_ADDR_SIZE])
+{
+	struct rte_rib6_node *cur, *prev = NULL;
+
+	if ((rib == NULL) || (ip == NULL)) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	cur = rib->tree;
+	while ((cur != NULL) && is_covered(ip, cur->ip, cur->depth)) {
+		if (is_valid_node(cur))
+			prev = cur;
+		cur = get_nxt_node(cur, ip);
+	}
+	return prev;
+}
+
+struct rte_rib6_node * __rte_experimental
+rte_rib6_lookup_shortest(struct rte_rib6 *rib,
+	const uint8_t ip[RTE_RIB6_IPV6_ADDR_SIZE])
+{
+	struct rte_rib6_node *cur;
+
+	if ((rib == NULL) || (ip == NULL)) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	cur = rib->tree;
+	while ((cur != NULL) && is_covered(ip, cur->ip, cur->depth)) {
+		if (is_valid_node(cur))
+			return cur;
+		cur = get_nxt_node(cur, ip);
+	}
+	return NULL;
+}
+
+struct rte_rib6_node * __rte_experimental
+rte_rib6_lookup_parent(struct rte_rib6_node *ent)
+{
+	struct rte_rib6_node *tmp;
+
+	if (ent == NULL)
+		return NULL;
+	tmp = ent->parent;
+	while ((tmp != NULL) && !is_valid_node(tmp))
+		tmp = tmp->parent;
+	return tmp;
+}
+
+/* Node of ip/depth, either a route or a branch, ip being masked */
+static struct rte_rib6_node *
+find_node(struct rte_rib6 *rib, const uint8_t ip[RTE_RIB6_IPV6_ADDR_SIZE],
+	uint8_t depth)
+{
+	struct rte_rib6_node *cur = rib->tree;
+
+	while (cur != NULL) {
+		if ((cur->depth == depth) &&
+				(memcmp(cur->ip, ip, RTE_RIB6_IPV6_ADDR_SIZE) == 0))
+			return cur;
+		if ((cur->depth > depth) || !is_covered(ip, cur->ip, cur->depth))
+			break;
+		cur = get_nxt_node(cur, ip);
+	}
+	return NULL;
+}
+
+struct rte_rib6_node * __rte_experimental
+rte_rib6_lookup_exact(struct rte_rib6 *rib,
+	const uint8_t ip[RTE_RIB6_IPV6_ADDR_SIZE], uint8_t depth)
+{
+	uint8_t tmp_ip[RTE_RIB6_IPV6_ADDR_SIZE];
+	struct rte_rib6_node *cur;
+
+	if ((rib == NULL) || (ip == NULL) || (depth > RTE_RIB6_MAXDEPTH)) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	memcpy(tmp_ip, ip, RTE_RIB6_IPV6_ADDR_SIZE);
+	mask_ip(tmp_ip, depth);
+	cur = find_node(rib, tmp_ip, depth);
+	if ((cur != NULL) && is_valid_node(cur))
+		return cur;
+	return NULL;
+}
+
+/*
+ * Walk the subtree of ip/depth in depth first order, starting after
+ * last, and return the next route more specific than ip/depth.
+ * With RTE_RIB6_GET_NXT_COVER, the subtree of a returned route is skipped.
+ */
+struct rte_rib6_node * __rte_experimental
+rte_rib6_get_nxt(struct rte_rib6 *rib,
+	const uint8_t ip[RTE_RIB6_IPV6_ADDR_SIZE], uint8_t depth,
+	struct rte_rib6_node *last, int flag)
+{
+	struct rte_rib6_node *root, *tmp;
+	bool skip;
+
+	if ((rib == NULL) || (ip == NULL) || (depth > RTE_RIB6_MAXDEPTH)) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	/* First node of the path which is covered by ip/depth */
+	root = rib->tree;
+	while ((root != NULL) && (root->depth < depth))
+		root = get_nxt_node(root, ip);
+	if ((root == NULL) || !is_covered(root->ip, ip, depth))
+		return NULL;
+
+	if (last == NULL) {
+		if (is_valid_node(root) && (root->depth > depth))
+			return root;
+		tmp = root;
+		skip = false;
+	} else {
+		tmp = last;
+		skip = (flag == RTE_RIB6_GET_NXT_COVER);
+	}
+
+	for (;;) {
+		if (!skip && (tmp->left != NULL))
+			tmp = tmp->left;
+		else if (!skip && (tmp->right != NULL))
+			tmp = tmp->right;
+		else {
+			/* Climb up to the first right sibling not visited */
+			while ((tmp != root) && (is_right_node(tmp) ||
+					(tmp->parent->right == NULL)))
+				tmp = tmp->parent;
+			if (tmp == root)
+				return NULL;
+			tmp = tmp->parent->right;
+		}
+		if (is_valid_node(tmp))
+			return tmp;
+		skip = false;
+	}
+}
+
+void __rte_experimental
+rte_rib6_remove(struct rte_rib6 *rib,
+	const uint8_t ip[RTE_RIB6_IPV6_ADDR_SIZE], uint8_t depth)
+{
+	struct rte_rib6_node *cur, *prev, *child;
+
+	cur = rte_rib6_lookup_exact(rib, ip, depth);
+	if (cur == NULL)
+		return;
+
+	rib->cur_routes--;
+	cur->flag &= ~RTE_RIB6_VALID_NODE;
+	/* Remove the branches which are no longer needed */
+	while (!is_valid_node(cur)) {
+		if ((cur->left != NULL) && (cur->right != NULL))
+			return;
+		child = (cur->left == NULL) ? cur->right : cur->left;
+		if (child != NULL)
+			child->parent = cur->parent;
+		if (cur->parent == NULL) {
+			rib->tree = child;
+			node_free(rib, cur);
+			return;
+		}
+		if (cur->parent->left == cur)
+			cur->parent->left = child;
+		else
+			cur->parent->right = child;
+		prev = cur;
+		cur = cur->parent;
+		node_free(rib, prev);
+	}
+}
+
+struct rte_rib6_node * __rte_experimental
+rte_rib6_insert(struct rte_rib6 *rib,
+	const uint8_t ip[RTE_RIB6_IPV6_ADDR_SIZE], uint8_t depth)
+{
+	struct rte_rib6_node **tmp;
+	struct rte_rib6_node *prev = NULL;
+	struct rte_rib6_node *new_node, *common_node;
+	uint8_t tmp_ip[RTE_RIB6_IPV6_ADDR_SIZE];
+	uint8_t common_depth;
+
+	if ((rib == NULL) || (ip == NULL) || (depth > RTE_RIB6_MAXDEPTH)) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	memcpy(tmp_ip, ip, RTE_RIB6_IPV6_ADDR_SIZE);
+	mask_ip(tmp_ip, depth);
+	tmp = &rib->tree;
+
+	/* A branch may already exist for this prefix */
+	new_node = find_node(rib, tmp_ip, depth);
+	if (new_node != NULL) {
+		if (is_valid_node(new_node)) {
+			rte_errno = EEXIST;
+			return NULL;
+		}
+		new_node->nh = 0;
+		memset(new_node->ext, 0, rib->ext_sz);
+		new_node->flag |= RTE_RIB6_VALID_NODE;
+		rib->cur_routes++;
+		return new_node;
+	}
+
+	new_node = node_alloc(rib);
+	if (new_node == NULL) {
+		rte_errno = ENOSPC;
+		return NULL;
+	}
+	memcpy(new_node->ip, tmp_ip, RTE_RIB6_IPV6_ADDR_SIZE);
+	new_node->depth = depth;
+	new_node->flag = RTE_RIB6_VALID_NODE;
+
+	/* Go down while the nodes of the path cover the new prefix */
+	while ((*tmp != NULL) && ((*tmp)->depth < depth) &&
+			is_covered(tmp_ip, (*tmp)->ip, (*tmp)->depth)) {
+		prev = *tmp;
+		tmp = get_dir(tmp_ip, prev->depth) ? &prev->right : &prev->left;
+	}
+
+	if (*tmp == NULL) {
+		new_node->parent = prev;
+		*tmp = new_node;
+		rib->cur_routes++;
+		return new_node;
+	}
+
+	/* Longest common prefix of the new prefix and the current node */
+	common_depth = RTE_MIN(depth, (*tmp)->depth);
+	common_depth = RTE_MIN(common_depth,
+		common_prefix_len(tmp_ip, (*tmp)->ip));
+
+	if (common_depth == depth) {
+		/* The new route covers the current node, insert it above */
+		if (get_dir((*tmp)->ip, depth))
+			new_node->right = *tmp;
+		else
+			new_node->left = *tmp;
+		new_node->parent = (*tmp)->parent;
+		(*tmp)->parent = new_node;
+		*tmp = new_node;
+	} else {
+		/* Both diverge, insert a branch above them */
+		common_node = node_alloc(rib);
+		if (common_node == NULL) {
+			node_free(rib, new_node);
+			rte_errno = ENOSPC;
+			return NULL;
+		}
+		memcpy(common_node->ip, tmp_ip, RTE_RIB6_IPV6_ADDR_SIZE);
+		mask_ip(common_node->ip, common_depth);
+		common_node->depth = common_depth;
+		common_node->parent = (*tmp)->parent;
+		new_node->parent = common_node;
+		(*tmp)->parent = common_node;
+		if (get_dir(tmp_ip, common_depth)) {
+			common_node->left = *tmp;
+			common_node->right = new_node;
+		} else {
+			common_node->left = new_node;
+			common_node->right = *tmp;
+		}
+		*tmp = common_node;
+	}
+	rib->cur_routes++;
+	return new_node;
+}
+
+int __rte_experimental
+rte_rib6_get_ip(const struct rte_rib6_node *node,
+	uint8_t ip[RTE_RIB6_IPV6_ADDR_SIZE])
+{
+	if ((node == NULL) || (ip == NULL)) {
+		rte_errno = EINVAL;
+		return -EINVAL;
+	}
+	memcpy(ip, node->ip, RTE_RIB6_IPV6_ADDR_SIZE);
+	return 0;
+}
+
+int __rte_experimental
+rte_rib6_get_depth(const struct rte_rib6_node *node, uint8_t *depth)
+{
+	if ((node == NULL) || (depth == NULL)) {
+		rte_errno = EINVAL;
+		return -EINVAL;
+	}
+	*depth = node->depth;
+	return 0;
+}
+
+int __rte_experimental
+rte_rib6_get_nh(const struct rte_rib6_node *node, uint64_t *nh)
+{
+	if ((node == NULL) || (nh == NULL)) {
+		rte_errno = EINVAL;
+		return -EINVAL;
+	}
+	*nh = node->nh;
+	return 0;
+}
+
+int __rte_experimental
+rte_rib6_set_nh(struct rte_rib6_node *node, uint64_t nh)
+{
+	if (node == NULL) {
+		rte_errno = EINVAL;
+		return -EINVAL;
+	}
+	node->nh = nh;
+	return 0;
+}
+
+void * __rte_experimental
+rte_rib6_get_ext(struct rte_rib6_node *node)
+{
+	if (node == NULL) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+	return node->ext;
+}
+
+struct rte_rib6 * __rte_experimental
+rte_rib6_create(const char *name, int socket_id,
+	const struct rte_rib6_conf *conf)
+{
+	char mem_name[RTE_RIB6_NAMESIZE];
+	struct rte_rib6 *rib = NULL;
+	struct rte_tailq_entry *te;
+	struct rte_rib6_list *rib6_list;
+	struct rte_mempool *node_pool;
+
+	/* Check user arguments. */
+	if ((name == NULL) || (conf == NULL) || (conf->max_nodes <= 0)) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	snprintf(mem_name, sizeof(mem_name), "RIB6_%s", name);
+	node_pool = rte_mempool_create(mem_name, conf->max_nodes,
+		sizeof(struct rte_rib6_node) + conf->ext_sz, 0, 0, NULL, NULL,
+		NULL, NULL, socket_id, 0);
+	if (node_pool == NULL) {
+		RTE_LOG(ERR, LPM,
+			"Can not allocate mempool for RIB6 %s\n", name);
+		return NULL;
+	}
+
+	snprintf(mem_name, sizeof(mem_name), "RIB6_%s", name);
+	rib6_list = RTE_TAILQ_CAST(rte_rib6_tailq.head, rte_rib6_list);
+
+	rte_rwlock_write_lock(RTE_EAL_TAILQ_RWLOCK);
+
+	/* guarantee there's no existing */
+	TAILQ_FOREACH(te, rib6_list, next) {
+		rib = (struct rte_rib6 *)te->data;
+		if (strncmp(name, rib->name, RTE_RIB6_NAMESIZE) == 0)
+			break;
+	}
+	rib = NULL;
+	if (te != NULL) {
+		rte_errno = EEXIST;
+		goto exit;
+	}
+
+	/* allocate tailq entry */
+	te = rte_zmalloc("RIB6_TAILQ_ENTRY", sizeof(*te), 0);
+	if (te == NULL) {
+		RTE_LOG(ERR, LPM,
+			"Can not allocate tailq entry for RIB6 %s\n", name);
+		rte_errno = ENOMEM;
+		goto exit;
+	}
+
+	/* Allocate memory to store the RIB6 data structures. */
+	rib = rte_zmalloc_socket(mem_name,
+		sizeof(struct rte_rib6), RTE_CACHE_LINE_SIZE, socket_id);
+	if (rib == NULL) {
+		RTE_LOG(ERR, LPM, "RIB6 %s memory allocation failed\n", name);
+		rte_free(te);
+		rte_errno = ENOMEM;
+		goto exit;
+	}
+
+	snprintf(rib->name, sizeof(rib->name), "%s", name);
+	rib->tree = NULL;
+	rib->max_nodes = conf->max_nodes;
+	rib->ext_sz = conf->ext_sz;
+	rib->node_pool = node_pool;
+
+	te->data = (void *)rib;
+	TAILQ_INSERT_TAIL(rib6_list, te, next);
+
+exit:
+	rte_rwlock_write_unlock(RTE_EAL_TAILQ_RWLOCK);
+
+	if (rib == NULL)
+		rte_mempool_free(node_pool);
+
+	return rib;
+}
+
+struct rte_rib6 * __rte_experimental
+rte_rib6_find_existing(const char *name)
+{
+	struct rte_rib6 *rib = NULL;
+	struct rte_tailq_entry *te;
+	struct rte_rib6_list *rib6_list;
+
+	rib6_list = RTE_TAILQ_CAST(rte_rib6_tailq.head, rte_rib6_list);
+
+	rte_rwlock_read_lock(RTE_EAL_TAILQ_RWLOCK);
+	TAILQ_FOREACH(te, rib6_list, next) {
+		rib = (struct rte_rib6 *) te->data;
+		if (strncmp(name, rib->name, RTE_RIB6_NAMESIZE) == 0)
+			break;
+	}
+	rte_rwlock_read_unlock(RTE_EAL_TAILQ_RWLOCK);
+
+	if (te == NULL) {
+		rte_errno = ENOENT;
+		return NULL;
+	}
+
+	return rib;
+}
+
+void __rte_experimental
+rte_rib6_free(struct rte_rib6 *rib)
+{
+	struct rte_tailq_entry *te;
+	struct rte_rib6_list *rib6_list;
+
+	if (rib == NULL)
+		return;
+
+	rib6_list = RTE_TAILQ_CAST(rte_rib6_tailq.head, rte_rib6_list);
+
+	rte_rwlock_write_lock(RTE_EAL_TAILQ_RWLOCK);
+
+	/* find our tailq entry */
+	TAILQ_FOREACH(te, rib6_list, next) {
+		if (te->data == (void *)rib)
+			break;
+	}
+	if (te != NULL)
+		TAILQ_REMOVE(rib6_list, te, next);
+
+	rte_rwlock_write_unlock(RTE_EAL_TAILQ_RWLOCK);
+
+	/* All the nodes come from the pool */
+	rte_mempool_free(rib->node_pool);
+	rte_free(rib);
+	rte_free(te);
+}
@@ -43,12 +43,22 @@ EAL_REGISTER_TAILQ(rte_ring_tailq)
 /* true if x is a power of 2 */
 #define POWEROF2(x) ((((x)-1) & (x)) == 0)
 
+/* by default set head/tail distance as 1/8 of ring capacity */
+#define HTD_MAX_DEF	8
+
 /* return the size of memory occupied by a ring */
 ssize_t
-rte_ring_get_memsize(unsigned count)
+rte_ring_get_memsize_elem(unsigned int esize, unsigned int count)
 {
 	ssize_t sz;
 
+	/* Check if element size is a multiple of 4B */
+	if (esize % 4 != 0) {
+		RTE_LOG(ERR, RING, "element size is not a multiple of 4\n");
+
+		return -EINVAL;
+	}
+
 	/* count must be a power of 2 */
 	if ((!POWEROF2(count)) || (count > RTE_RING_SZ_MASK )) {
 		RTE_LOG(ERR, RING,
@@ -57,15 +67,66 @@ rte_ring_get_memsize(unsigned count)
 		return -EINVAL;
 	}
 
-	sz = sizeof(struct rte_ring) + count * sizeof(void *);
+	sz = sizeof(struct rte_ring) + (ssize_t)count * esize;
 	sz = RTE_ALIGN(sz, RTE_CACHE_LINE_SIZE);
 	return sz;
 }
 
+/* return the size of memory occupied by a ring of pointers */
+ssize_t
+rte_ring_get_memsize(unsigned count)
+{
+	return rte_ring_get_memsize_elem(sizeof(void *), count);
+}
+
+/*
+ * Select the sync type of one side of the ring from the creation flags.
+ * At most one of the single, RTS and HTS flags can be requested.
+ */
+static int
+get_sync_type(uint32_t flags, uint32_t st_flag, uint32_t rts_flag,
+		uint32_t hts_flag, enum rte_ring_sync_type *sync_type)
+{
+	uint32_t sync_flags = flags & (st_flag | rts_flag | hts_flag);
+
+	if (sync_flags == 0)
+		*sync_type = RTE_RING_SYNC_MT;
+	else if (sync_flags == st_flag)
+		*sync_type = RTE_RING_SYNC_ST;
+	else if (sync_flags == rts_flag)
+		*sync_type = RTE_RING_SYNC_MT_RTS;
+	else if (sync_flags == hts_flag)
+		*sync_type = RTE_RING_SYNC_MT_HTS;
+	else
+		return -EINVAL;
+
+	return 0;
+}
+
+/* check the creation flags and fill in prod/cons sync types,
+ * unknown flags are ignored
+ */
+static int
+ring_check_flags(uint32_t flags, enum rte_ring_sync_type *prod_st,
+		enum rte_ring_sync_type *cons_st)
+{
+	if (get_sync_type(flags, RING_F_SP_ENQ, RING_F_MP_RTS_ENQ,
+			RING_F_MP_HTS_ENQ, prod_st) != 0 ||
+			get_sync_type(flags, RING_F_SC_DEQ, RING_F_MC_RTS_DEQ,
+				RING_F_MC_HTS_DEQ, cons_st) != 0) {
+		RTE_LOG(ERR, RING,
+			"Conflicting producer/consumer sync flags %#x\n",
+			flags);
+		return -EINVAL;
+	}
+	return 0;
+}
+
 int
 rte_ring_init(struct rte_ring *r, const char *name, unsigned count,
 	unsigned flags)
 {
+	enum rte_ring_sync_type prod_st, cons_st;
 	int ret;
 
 	/* compilation-time checks */
@@ -76,14 +137,32 @@ rte_ring_init(struct rte_ring *r, const char *name, unsigned count,
 	RTE_BUILD_BUG_ON((offsetof(struct rte_ring, prod) &
 			  RTE_CACHE_LINE_MASK) != 0);
 
+	/* the sync type and the tail must overlay for all head/tail flavours */
+	RTE_BUILD_BUG_ON(offsetof(struct rte_ring_headtail, sync_type) !=
+		offsetof(struct rte_ring_hts_headtail, sync_type));
+	RTE_BUILD_BUG_ON(offsetof(struct rte_ring_headtail, tail) !=
+		offsetof(struct rte_ring_hts_headtail, ht.pos.tail));
+	RTE_BUILD_BUG_ON(offsetof(struct rte_ring_headtail, sync_type) !=
+		offsetof(struct rte_ring_rts_headtail, sync_type));
+	RTE_BUILD_BUG_ON(offsetof(struct rte_ring_headtail, tail) !=
+		offsetof(struct rte_ring_rts_headtail, tail.val.pos));
+
+	/* legacy single prod/cons values must match the new sync types */
+	RTE_BUILD_BUG_ON(__IS_SP != RTE_RING_SYNC_ST);
+	RTE_BUILD_BUG_ON(__IS_MP != RTE_RING_SYNC_MT);
+
+	ret = ring_check_flags(flags, &prod_st, &cons_st);
+	if (ret != 0)
+		return ret;
+
 	/* init the ring structure */
 	memset(r, 0, sizeof(*r));
 	ret = snprintf(r->name, sizeof(r->name), "%s", name);
 	if (ret < 0 || ret >= (int)sizeof(r->name))
 		return -ENAMETOOLONG;
 	r->flags = flags;
-	r->prod.single = (flags & RING_F_SP_ENQ) ? __IS_SP : __IS_MP;
-	r->cons.single = (flags & RING_F_SC_DEQ) ? __IS_SC : __IS_MC;
+	r->prod.sync_type = prod_st;
+	r->cons.sync_type = cons_st;
 
 	if (flags & RING_F_EXACT_SZ) {
 		r->size = rte_align32pow2(count + 1);
@@ -100,16 +179,20 @@ rte_ring_init(struct rte_ring *r, const char *name, unsigned count,
 		r->mask = count - 1;
 		r->capacity = r->mask;
 	}
-	r->prod.head = r->cons.head = 0;
-	r->prod.tail = r->cons.tail = 0;
+
+	/* set default values for head-tail distance */
+	if (flags & RING_F_MP_RTS_ENQ)
+		rte_ring_set_prod_htd_max(r, r->capacity / HTD_MAX_DEF);
+	if (flags & RING_F_MC_RTS_DEQ)
+		rte_ring_set_cons_htd_max(r, r->capacity / HTD_MAX_DEF);
 
 	return 0;
 }
 
-/* create the ring */
+/* create the ring for a given element size */
 struct rte_ring *
-rte_ring_create(const char *name, unsigned count, int socket_id,
-		unsigned flags)
+rte_ring_create_elem(const char *name, unsigned int esize, unsigned int count,
+		int socket_id, unsigned int flags)
 {
 	char mz_name[RTE_MEMZONE_NAMESIZE];
 	struct rte_ring *r;
@@ -121,15 +204,24 @@ rte_ring_create(const char *name, unsigned count, int socket_id,
 	const unsigned int requested_count = count;
 	int ret;
 
+	enum rte_ring_sync_type prod_st, cons_st;
+
 	ring_list = RTE_TAILQ_CAST(rte_ring_tailq.head, rte_ring_list);
 
+	/* check the flags before reserving any memory */
+	ret = ring_check_flags(flags, &prod_st, &cons_st);
+	if (ret != 0) {
+		rte_errno = -ret;
+		return NULL;
+	}
+
 	/* for an exact size ring, round up from count to a power of two */
 	if (flags & RING_F_EXACT_SZ)
 		count = rte_align32pow2(count + 1);
 
-	ring_size = rte_ring_get_memsize(count);
+	ring_size = rte_ring_get_memsize_elem(esize, count);
 	if (ring_size < 0) {
-		rte_errno = ring_size;
+		rte_errno = -ring_size;
 		return NULL;
 	}
 
@@ -174,6 +266,15 @@ rte_ring_create(const char *name, unsigned count, int socket_id,
 	return r;
 }
 
+/* create the ring */
+struct rte_ring *
+rte_ring_create(const char *name, unsigned count, int socket_id,
+		unsigned flags)
+{
+	return rte_ring_create_elem(name, sizeof(void *), count, socket_id,
+		flags);
+}
+
 /* free the ring */
 void
 rte_ring_free(struct rte_ring *r)
@@ -219,6 +320,36 @@ rte_ring_free(struct rte_ring *r)
 	rte_free(te);
 }
 
+static const char *
+ring_get_sync_type_name(enum rte_ring_sync_type st)
+{
+	switch (st) {
+	case RTE_RING_SYNC_ST:
+		return "single thread";
+	case RTE_RING_SYNC_MT:
+		return "multi thread";
+	case RTE_RING_SYNC_MT_RTS:
+		return "multi thread - RTS";
+	case RTE_RING_SYNC_MT_HTS:
+		return "multi thread - HTS";
+	}
+	return "unknown";
+}
+
+/* return the head of one side of the ring, whatever its sync type */
+static uint32_t
+ring_get_head(const struct rte_ring_headtail *ht)
+{
+	switch (ht->sync_type) {
+	case RTE_RING_SYNC_MT_RTS:
+		return ((const struct rte_ring_rts_headtail *)ht)->head.val.pos;
+	case RTE_RING_SYNC_MT_HTS:
+		return ((const struct rte_ring_hts_headtail *)ht)->ht.pos.head;
+	default:
+		return ht->head;
+	}
+}
+
 /* dump the status of the ring on the console */
 void
 rte_ring_dump(FILE *f, const struct rte_ring *r)
@@ -227,10 +358,20 @@ rte_ring_dump(FILE *f, const struct rte_ring *r)
 	fprintf(f, "  flags=%x\n", r->flags);
 	fprintf(f, "  size=%"PRIu32"\n", r->size);
 	fprintf(f, "  capacity=%"PRIu32"\n", r->capacity);
+	fprintf(f, "  prod sync=%s\n",
+		ring_get_sync_type_name(r->prod.sync_type));
+	fprintf(f, "  cons sync=%s\n",
+		ring_get_sync_type_name(r->cons.sync_type));
 	fprintf(f, "  ct=%"PRIu32"\n", r->cons.tail);
-	fprintf(f, "  ch=%"PRIu32"\n", r->cons.head);
+	fprintf(f, "  ch=%"PRIu32"\n", ring_get_head(&r->cons));
 	fprintf(f, "  pt=%"PRIu32"\n", r->prod.tail);
-	fprintf(f, "  ph=%"PRIu32"\n", r->prod.head);
+	fprintf(f, "  ph=%"PRIu32"\n", ring_get_head(&r->prod));
+	if (r->prod.sync_type == RTE_RING_SYNC_MT_RTS)
+		fprintf(f, "  prod htd_max=%"PRIu32"\n",
+			rte_ring_get_prod_htd_max(r));
+	if (r->cons.sync_type == RTE_RING_SYNC_MT_RTS)
+		fprintf(f, "  cons htd_max=%"PRIu32"\n",
+			rte_ring_get_cons_htd_max(r));
 	fprintf(f, "  used=%u\n", rte_ring_count(r));
 	fprintf(f, "  avail=%u\n", rte_ring_free_count(r));
 }
@@ -6,6 +6,7 @@
 #include <string.h>
 
 #include <rte_common.h>
+#include <rte_atomic.h>
 #include <rte_log.h>
 #include <rte_memory.h>
 #include <rte_malloc.h>
@@ -38,6 +39,7 @@
 #define RTE_SCHED_TB_RATE_CONFIG_ERR          (1e-7)
 #define RTE_SCHED_WRR_SHIFT                   3
 #define RTE_SCHED_GRINDER_PCACHE_SIZE         (64 / RTE_SCHED_QUEUES_PER_PIPE)
+#define RTE_SCHED_LOG_BUF_SIZE                256
 #define RTE_SCHED_PIPE_INVALID                UINT32_MAX
 #define RTE_SCHED_BMP_POS_INVALID             UINT32_MAX
 
@@ -56,8 +58,8 @@ struct rte_sched_subport {
 
 	/* Traffic classes (TCs) */
 	uint64_t tc_time; /* time of next update */
-	uint32_t tc_credits_per_period[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
-	uint32_t tc_credits[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
+	uint32_t tc_credits_per_period[RTE_SCHED_TRAFFIC_CLASSES_MAX];
+	uint32_t tc_credits[RTE_SCHED_TRAFFIC_CLASSES_MAX];
 	uint32_t tc_period;
 
 	/* TC oversubscription */
@@ -81,11 +83,11 @@ struct rte_sched_pipe_profile {
 
 	/* Pipe traffic classes */
 	uint32_t tc_period;
-	uint32_t tc_credits_per_period[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
+	uint32_t tc_credits_per_period[RTE_SCHED_TRAFFIC_CLASSES_MAX];
 	uint8_t tc_ov_weight;
 
 	/* Pipe queues */
-	uint8_t  wrr_cost[RTE_SCHED_QUEUES_PER_PIPE];
+	uint8_t  wrr_cost[RTE_SCHED_QUEUES_PER_PIPE_MAX];
 };
 
 struct rte_sched_pipe {
@@ -98,15 +100,17 @@ struct rte_sched_pipe {
 
 	/* Traffic classes (TCs) */
 	uint64_t tc_time; /* time of next update */
-	uint32_t tc_credits[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
-
-	/* Weighted Round Robin (WRR) */
-	uint8_t wrr_tokens[RTE_SCHED_QUEUES_PER_PIPE];
 
 	/* TC oversubscription */
 	uint32_t tc_ov_credits;
 	uint8_t tc_ov_period_id;
 	uint8_t reserved[3];
+
+	/* Weighted Round Robin (WRR) tokens, one per queue of the pipe, then
+	 * the TC credits, one per TC. The pipe fits in one cache line for the
+	 * default layout, two for the larger ones.
+	 */
+	uint8_t wrr_tokens[0];
 } __rte_cache_aligned;
 
 struct rte_sched_queue {
@@ -136,17 +140,17 @@ enum grinder_state {
  * by scheduler enqueue.
  */
 struct rte_sched_port_hierarchy {
-	uint16_t queue:2;                /**< Queue ID (0 .. 3) */
-	uint16_t traffic_class:2;        /**< Traffic class ID (0 .. 3)*/
+	uint16_t queue:3;                /**< Queue ID (0 .. 7) */
+	uint16_t traffic_class:4;        /**< Traffic class ID (0 .. 15)*/
 	uint32_t color:2;                /**< Color */
-	uint16_t unused:10;
+	uint16_t unused:7;
 	uint16_t subport;                /**< Subport ID */
 	uint32_t pipe;		         /**< Pipe ID */
 };
 
 struct rte_sched_grinder {
 	/* Pipe cache */
-	uint16_t pcache_qmask[RTE_SCHED_GRINDER_PCACHE_SIZE];
+	uint32_t pcache_qmask[RTE_SCHED_GRINDER_PCACHE_SIZE];
 	uint32_t pcache_qindex[RTE_SCHED_GRINDER_PCACHE_SIZE];
 	uint32_t pcache_w;
 	uint32_t pcache_r;
@@ -160,25 +164,26 @@ struct rte_sched_grinder {
 	struct rte_sched_pipe_profile *pipe_params;
 
 	/* TC cache */
-	uint8_t tccache_qmask[4];
-	uint32_t tccache_qindex[4];
+	uint8_t tccache_qmask[RTE_SCHED_TRAFFIC_CLASSES_MAX];
+	uint32_t tccache_qindex[RTE_SCHED_TRAFFIC_CLASSES_MAX];
 	uint32_t tccache_w;
 	uint32_t tccache_r;
 
 	/* Current TC */
 	uint32_t tc_index;
-	struct rte_sched_queue *queue[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
-	struct rte_mbuf **qbase[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
-	uint32_t qindex[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
+	uint32_t n_queues;
+	struct rte_sched_queue *queue[RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS_MAX];
+	struct rte_mbuf **qbase[RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS_MAX];
+	uint32_t qindex[RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS_MAX];
 	uint16_t qsize;
 	uint32_t qmask;
 	uint32_t qpos;
 	struct rte_mbuf *pkt;
 
 	/* WRR */
-	uint16_t wrr_tokens[RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS];
-	uint16_t wrr_mask[RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS];
-	uint8_t wrr_cost[RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS];
+	uint16_t wrr_tokens[RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS_MAX];
+	uint16_t wrr_mask[RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS_MAX];
+	uint8_t wrr_cost[RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS_MAX];
 };
 
 struct rte_sched_port {
@@ -188,18 +193,32 @@ struct rte_sched_port {
 	uint32_t rate;
 	uint32_t mtu;
 	uint32_t frame_overhead;
-	uint16_t qsize[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
+	uint32_t n_traffic_classes;
+	uint16_t qsize[RTE_SCHED_TRAFFIC_CLASSES_MAX];
 	uint32_t n_pipe_profiles;
-	uint32_t pipe_tc3_rate_max;
+	uint32_t pipe_tc_be_rate_max;
 #ifdef RTE_SCHED_RED
-	struct rte_red_config red_config[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE][e_RTE_METER_COLORS];
+	struct rte_red_config red_config[RTE_SCHED_TRAFFIC_CLASSES_MAX][e_RTE_METER_COLORS];
 #endif
 
+	/* Pipe queue layout */
+	uint32_t default_layout; /* default TCs and queues per TC */
+	uint32_t tc_be; /* best effort (lowest priority) traffic class */
+	uint32_t n_queues_per_pipe; /* power of 2, padding queues included */
+	uint32_t n_queues_per_pipe_log2;
+	uint32_t pipe_qmask;
+	uint8_t tc_n_queues[RTE_SCHED_TRAFFIC_CLASSES_MAX];
+	uint8_t tc_qmask[RTE_SCHED_TRAFFIC_CLASSES_MAX];
+	uint8_t tc_qpos[RTE_SCHED_TRAFFIC_CLASSES_MAX]; /* first queue of TC */
+	uint8_t qpos_tc[RTE_SCHED_QUEUES_PER_PIPE_MAX];
+	uint32_t pipe_size_log2; /* pipe run-time context, in bytes */
+
 	/* Timing */
 	uint64_t time_cpu_cycles;     /* Current CPU time measured in CPU cyles */
 	uint64_t time_cpu_bytes;      /* Current CPU time measured in bytes */
 	uint64_t time;                /* Current NIC TX time measured in bytes */
 	struct rte_reciprocal inv_cycles_per_byte; /* CPU cycles per byte */
+	struct rte_sched_shard_group *shard_group; /* Output port rate, if shard */
 
 	/* Scheduling loop detection */
 	uint32_t pipe_loop;
@@ -216,7 +235,7 @@ struct rte_sched_port {
 	uint32_t n_pkts_out;
 
 	/* Queue base calculation */
-	uint32_t qsize_add[RTE_SCHED_QUEUES_PER_PIPE];
+	uint32_t qsize_add[RTE_SCHED_QUEUES_PER_PIPE_MAX];
 	uint32_t qsize_sum;
 
 	/* Large data structures */
@@ -230,6 +249,22 @@ struct rte_sched_port {
 	uint8_t memory[0] __rte_cache_aligned;
 } __rte_cache_aligned;
 
+struct rte_sched_shard_group {
+	/* User parameters */
+	uint32_t rate;
+	uint32_t tb_size;
+
+	/* Timing */
+	uint64_t time_cpu_cycles;     /* CPU time of group creation in CPU cycles */
+	uint64_t cpu_hz;
+	struct rte_reciprocal_u64 inv_cpu_hz;
+
+	/* Output port token bucket, shared by the shards. Time up to which the
+	 * output port is booked, measured in bytes since group creation.
+	 */
+	rte_atomic64_t tb_time __rte_cache_aligned;
+} __rte_cache_aligned;
+
 enum rte_sched_port_array {
 	e_RTE_SCHED_PORT_ARRAY_SUBPORT = 0,
 	e_RTE_SCHED_PORT_ARRAY_PIPE,
@@ -246,7 +281,7 @@ enum rte_sched_port_array {
 static inline uint32_t
 rte_sched_port_queues_per_subport(struct rte_sched_port *port)
 {
-	return RTE_SCHED_QUEUES_PER_PIPE * port->n_pipes_per_subport;
+	return port->n_queues_per_pipe * port->n_pipes_per_subport;
 }
 
 #endif
@@ -254,32 +289,175 @@ rte_sched_port_queues_per_subport(struct rte_sched_port *port)
 static inline uint32_t
 rte_sched_port_queues_per_port(struct rte_sched_port *port)
 {
-	return RTE_SCHED_QUEUES_PER_PIPE * port->n_pipes_per_subport * port->n_subports_per_port;
+	return port->n_queues_per_pipe * port->n_pipes_per_subport * port->n_subports_per_port;
+}
+
+/*
+ * Pipe queue layout. The grinder code passes the default_layout argument as
+ * a constant (see grinder_handle()), so that it is specialized for the
+ * default layout of RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE traffic classes with
+ * RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS queues each.
+ */
+static __rte_always_inline uint32_t
+rte_sched_port_n_tc(struct rte_sched_port *port, const int default_layout)
+{
+	return default_layout ? RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE :
+		port->n_traffic_classes;
 }
 
-static inline struct rte_mbuf **
-rte_sched_port_qbase(struct rte_sched_port *port, uint32_t qindex)
+static __rte_always_inline uint32_t
+rte_sched_port_n_queues_per_pipe(struct rte_sched_port *port,
+	const int default_layout)
 {
-	uint32_t pindex = qindex >> 4;
-	uint32_t qpos = qindex & 0xF;
+	return default_layout ? RTE_SCHED_QUEUES_PER_PIPE :
+		port->n_queues_per_pipe;
+}
+
+static __rte_always_inline uint32_t
+rte_sched_port_tc_n_queues(struct rte_sched_port *port, uint32_t tc,
+	const int default_layout)
+{
+	return default_layout ? RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS :
+		port->tc_n_queues[tc];
+}
+
+static __rte_always_inline uint32_t
+rte_sched_port_tc_qpos(struct rte_sched_port *port, uint32_t tc,
+	const int default_layout)
+{
+	return default_layout ? tc * RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS :
+		port->tc_qpos[tc];
+}
+
+static __rte_always_inline struct rte_sched_pipe *
+rte_sched_port_pipe(struct rte_sched_port *port, uint32_t pindex,
+	const int default_layout)
+{
+	if (default_layout)
+		return port->pipe + pindex;
+
+	return (struct rte_sched_pipe *) ((uint8_t *) port->pipe +
+		((size_t) pindex << port->pipe_size_log2));
+}
+
+static __rte_always_inline uint32_t *
+rte_sched_pipe_tc_credits(struct rte_sched_port *port,
+	struct rte_sched_pipe *pipe, const int default_layout)
+{
+	return (uint32_t *) (pipe->wrr_tokens +
+		rte_sched_port_n_queues_per_pipe(port, default_layout));
+}
+
+static __rte_always_inline uint32_t
+rte_sched_port_qindex_pipe(struct rte_sched_port *port, uint32_t qindex,
+	const int default_layout)
+{
+	return qindex >> (default_layout ? rte_bsf32(RTE_SCHED_QUEUES_PER_PIPE) :
+		port->n_queues_per_pipe_log2);
+}
+
+static __rte_always_inline uint32_t
+rte_sched_port_qindex_qpos(struct rte_sched_port *port, uint32_t qindex,
+	const int default_layout)
+{
+	return qindex &
+		(rte_sched_port_n_queues_per_pipe(port, default_layout) - 1);
+}
+
+static __rte_always_inline struct rte_mbuf **
+rte_sched_port_qbase(struct rte_sched_port *port, uint32_t qindex,
+	const int default_layout)
+{
+	uint32_t pindex = rte_sched_port_qindex_pipe(port, qindex,
+		default_layout);
+	uint32_t qpos = rte_sched_port_qindex_qpos(port, qindex,
+		default_layout);
 
 	return (port->queue_array + pindex *
 		port->qsize_sum + port->qsize_add[qpos]);
 }
 
-static inline uint16_t
-rte_sched_port_qsize(struct rte_sched_port *port, uint32_t qindex)
+static __rte_always_inline uint32_t
+rte_sched_port_qindex_tc(struct rte_sched_port *port, uint32_t qindex,
+	const int default_layout)
+{
+	if (default_layout)
+		return (qindex / RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS) &
+			(RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE - 1);
+
+	return port->qpos_tc[rte_sched_port_qindex_qpos(port, qindex, 0)];
+}
+
+static __rte_always_inline uint16_t
+rte_sched_port_qsize(struct rte_sched_port *port, uint32_t qindex,
+	const int default_layout)
 {
-	uint32_t tc = (qindex >> 2) & 0x3;
+	uint32_t tc = rte_sched_port_qindex_tc(port, qindex, default_layout);
 
 	return port->qsize[tc];
 }
 
+static inline uint32_t
+rte_sched_params_n_tc(struct rte_sched_port_params *params)
+{
+	if (params->n_traffic_classes == 0)
+		return RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE;
+
+	return params->n_traffic_classes;
+}
+
+static inline uint32_t
+rte_sched_params_tc_n_queues(struct rte_sched_port_params *params,
+	uint32_t tc)
+{
+	if (params->n_traffic_classes == 0)
+		return RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS;
+
+	return params->n_queues_per_tc[tc];
+}
+
+/* Number of queue IDs reserved for each pipe, i.e. the number of queues of
+ * all the traffic classes rounded up to a power of 2, so that the pipe
+ * index and the queue position within the pipe are obtained from the queue
+ * index with a shift and a mask.
+ */
+static uint32_t
+rte_sched_params_queues_per_pipe(struct rte_sched_port_params *params)
+{
+	uint32_t n_tc = rte_sched_params_n_tc(params);
+	uint32_t n_queues = 0;
+	uint32_t i;
+
+	for (i = 0; i < n_tc; i++)
+		n_queues += rte_sched_params_tc_n_queues(params, i);
+
+	if (n_queues < RTE_SCHED_QUEUES_PER_PIPE)
+		n_queues = RTE_SCHED_QUEUES_PER_PIPE;
+
+	return rte_align32pow2(n_queues);
+}
+
+/* Size of the pipe run-time context, i.e. the pipe structure followed by
+ * the WRR tokens and the TC credits, rounded up to a power of 2 of cache
+ * lines. One cache line for the default layout.
+ */
+static uint32_t
+rte_sched_params_pipe_size(struct rte_sched_port_params *params)
+{
+	uint32_t size = offsetof(struct rte_sched_pipe, wrr_tokens) +
+		rte_sched_params_queues_per_pipe(params) * sizeof(uint8_t) +
+		rte_sched_params_n_tc(params) * sizeof(uint32_t);
+
+	return rte_align32pow2(RTE_CACHE_LINE_ROUNDUP(size));
+}
+
 static int
 pipe_profile_check(struct rte_sched_pipe_params *params,
-	uint32_t rate)
+	uint32_t rate,
+	uint32_t n_tc,
+	const uint8_t *tc_n_queues)
 {
-	uint32_t i;
+	uint32_t i, j, qpos;
 
 	/* Pipe parameters */
 	if (params == NULL)
@@ -295,7 +473,7 @@ pipe_profile_check(struct rte_sched_pipe_params *params,
 		return -12;
 
 	/* TC rate: non-zero, less than pipe rate */
-	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i++) {
+	for (i = 0; i < n_tc; i++) {
 		if (params->tc_rate[i] == 0 ||
 			params->tc_rate[i] > params->tb_rate)
 			return -13;
@@ -306,15 +484,19 @@ pipe_profile_check(struct rte_sched_pipe_params *params,
 		return -14;
 
 #ifdef RTE_SCHED_SUBPORT_TC_OV
-	/* TC3 oversubscription weight: non-zero */
+	/* Best effort TC oversubscription weight: non-zero */
 	if (params->tc_ov_weight == 0)
 		return -15;
 #endif
 
-	/* Queue WRR weights: non-zero */
-	for (i = 0; i < RTE_SCHED_QUEUES_PER_PIPE; i++) {
-		if (params->wrr_weights[i] == 0)
-			return -16;
+	/* Queue WRR weights: non-zero for TCs with more than one queue */
+	for (i = 0, qpos = 0; i < n_tc; qpos += tc_n_queues[i], i++) {
+		if (tc_n_queues[i] == 1)
+			continue;
+
+		for (j = 0; j < tc_n_queues[i]; j++)
+			if (params->wrr_weights[qpos + j] == 0)
+				return -16;
 	}
 
 	return 0;
@@ -323,7 +505,8 @@ pipe_profile_check(struct rte_sched_pipe_params *params,
 static int
 rte_sched_port_check_params(struct rte_sched_port_params *params)
 {
-	uint32_t i;
+	uint8_t tc_n_queues[RTE_SCHED_TRAFFIC_CLASSES_MAX];
+	uint32_t n_tc, n_queues, i;
 
 	if (params == NULL)
 		return -1;
@@ -351,10 +534,34 @@ rte_sched_port_check_params(struct rte_sched_port_params *params)
 	    !rte_is_power_of_2(params->n_pipes_per_subport))
 		return -7;
 
+	/* n_traffic_classes: up to RTE_SCHED_TRAFFIC_CLASSES_MAX (0 for the
+	 * default layout), queues per TC: 1, 2, 4 or 8,
+	 * queues per pipe: up to RTE_SCHED_QUEUES_PER_PIPE_MAX
+	 */
+	if (params->n_traffic_classes > RTE_SCHED_TRAFFIC_CLASSES_MAX)
+		return -17;
+
+	n_tc = rte_sched_params_n_tc(params);
+	n_queues = 0;
+	for (i = 0; i < n_tc; i++) {
+		uint32_t n = rte_sched_params_tc_n_queues(params, i);
+
+		if (n == 0 ||
+		    n > RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS_MAX ||
+		    !rte_is_power_of_2(n))
+			return -17;
+
+		tc_n_queues[i] = n;
+		n_queues += n;
+	}
+
+	if (n_queues > RTE_SCHED_QUEUES_PER_PIPE_MAX)
+		return -17;
+
 	/* qsize: non-zero, power of 2,
 	 * no bigger than 32K (due to 16-bit read/write pointers)
 	 */
-	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i++) {
+	for (i = 0; i < n_tc; i++) {
 		uint16_t qsize = params->qsize[i];
 
 		if (qsize == 0 || !rte_is_power_of_2(qsize))
@@ -371,7 +578,7 @@ rte_sched_port_check_params(struct rte_sched_port_params *params)
 		struct rte_sched_pipe_params *p = params->pipe_profiles + i;
 		int status;
 
-		status = pipe_profile_check(p, params->rate);
+		status = pipe_profile_check(p, params->rate, n_tc, tc_n_queues);
 		if (status != 0)
 			return status;
 	}
@@ -385,10 +592,11 @@ rte_sched_port_get_array_base(struct rte_sched_port_params *params, enum rte_sch
 	uint32_t n_subports_per_port = params->n_subports_per_port;
 	uint32_t n_pipes_per_subport = params->n_pipes_per_subport;
 	uint32_t n_pipes_per_port = n_pipes_per_subport * n_subports_per_port;
-	uint32_t n_queues_per_port = RTE_SCHED_QUEUES_PER_PIPE * n_pipes_per_subport * n_subports_per_port;
+	uint32_t n_queues_per_port = rte_sched_params_queues_per_pipe(params) *
+		n_pipes_per_subport * n_subports_per_port;
 
 	uint32_t size_subport = n_subports_per_port * sizeof(struct rte_sched_subport);
-	uint32_t size_pipe = n_pipes_per_port * sizeof(struct rte_sched_pipe);
+	uint32_t size_pipe = n_pipes_per_port * rte_sched_params_pipe_size(params);
 	uint32_t size_queue = n_queues_per_port * sizeof(struct rte_sched_queue);
 	uint32_t size_queue_extra
 		= n_queues_per_port * sizeof(struct rte_sched_queue_extra);
@@ -400,8 +608,8 @@ rte_sched_port_get_array_base(struct rte_sched_port_params *params, enum rte_sch
 	uint32_t base, i;
 
 	size_per_pipe_queue_array = 0;
-	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i++) {
-		size_per_pipe_queue_array += RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS
+	for (i = 0; i < rte_sched_params_n_tc(params); i++) {
+		size_per_pipe_queue_array += rte_sched_params_tc_n_queues(params, i)
 			* params->qsize[i] * sizeof(struct rte_mbuf *);
 	}
 	size_queue_array = n_pipes_per_port * size_per_pipe_queue_array;
@@ -459,46 +667,107 @@ rte_sched_port_get_memory_footprint(struct rte_sched_port_params *params)
 	return size0 + size1;
 }
 
+static void
+rte_sched_port_config_layout(struct rte_sched_port *port,
+	struct rte_sched_port_params *params)
+{
+	uint32_t i, j, qpos;
+
+	port->n_traffic_classes = rte_sched_params_n_tc(params);
+	port->tc_be = port->n_traffic_classes - 1;
+	port->n_queues_per_pipe = rte_sched_params_queues_per_pipe(params);
+	port->n_queues_per_pipe_log2 = rte_bsf32(port->n_queues_per_pipe);
+	port->pipe_qmask = (uint32_t) ((1ULL << port->n_queues_per_pipe) - 1);
+	port->pipe_size_log2 = rte_bsf32(rte_sched_params_pipe_size(params));
+	port->default_layout =
+		(port->n_traffic_classes == RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE);
+
+	for (i = 0, qpos = 0; i < port->n_traffic_classes; i++) {
+		uint32_t n_queues = rte_sched_params_tc_n_queues(params, i);
+
+		port->tc_n_queues[i] = n_queues;
+		port->tc_qmask[i] = (1 << n_queues) - 1;
+		port->tc_qpos[i] = qpos;
+
+		for (j = 0; j < n_queues; j++)
+			port->qpos_tc[qpos++] = i;
+
+		if (n_queues != RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS)
+			port->default_layout = 0;
+	}
+
+	/* Padding queues: never enabled, no packet storage */
+	for ( ; qpos < port->n_queues_per_pipe; qpos++)
+		port->qpos_tc[qpos] = port->tc_be;
+
+	/* Packets of a traffic class out of the layout go to the best effort
+	 * one, see rte_sched_port_qindex()
+	 */
+	for ( ; i < RTE_SCHED_TRAFFIC_CLASSES_MAX; i++) {
+		port->tc_qmask[i] = port->tc_qmask[port->tc_be];
+		port->tc_qpos[i] = port->tc_qpos[port->tc_be];
+	}
+}
+
 static void
 rte_sched_port_config_qsize(struct rte_sched_port *port)
 {
-	/* TC 0 */
-	port->qsize_add[0] = 0;
-	port->qsize_add[1] = port->qsize_add[0] + port->qsize[0];
-	port->qsize_add[2] = port->qsize_add[1] + port->qsize[0];
-	port->qsize_add[3] = port->qsize_add[2] + port->qsize[0];
+	uint32_t qsize_sum, i, j;
 
-	/* TC 1 */
-	port->qsize_add[4] = port->qsize_add[3] + port->qsize[0];
-	port->qsize_add[5] = port->qsize_add[4] + port->qsize[1];
-	port->qsize_add[6] = port->qsize_add[5] + port->qsize[1];
-	port->qsize_add[7] = port->qsize_add[6] + port->qsize[1];
+	qsize_sum = 0;
+	for (i = 0; i < port->n_traffic_classes; i++)
+		for (j = 0; j < port->tc_n_queues[i]; j++) {
+			port->qsize_add[port->tc_qpos[i] + j] = qsize_sum;
+			qsize_sum += port->qsize[i];
+		}
 
-	/* TC 2 */
-	port->qsize_add[8] = port->qsize_add[7] + port->qsize[1];
-	port->qsize_add[9] = port->qsize_add[8] + port->qsize[2];
-	port->qsize_add[10] = port->qsize_add[9] + port->qsize[2];
-	port->qsize_add[11] = port->qsize_add[10] + port->qsize[2];
+	for (i = port->tc_qpos[port->tc_be] + port->tc_n_queues[port->tc_be];
+	     i < port->n_queues_per_pipe; i++)
+		port->qsize_add[i] = qsize_sum;
 
-	/* TC 3 */
-	port->qsize_add[12] = port->qsize_add[11] + port->qsize[2];
-	port->qsize_add[13] = port->qsize_add[12] + port->qsize[3];
-	port->qsize_add[14] = port->qsize_add[13] + port->qsize[3];
-	port->qsize_add[15] = port->qsize_add[14] + port->qsize[3];
+	port->qsize_sum = qsize_sum;
+}
 
-	port->qsize_sum = port->qsize_add[15] + port->qsize[3];
+static void
+rte_sched_log_tc_credits(char *buf, const uint32_t *tc_credits,
+	uint32_t n_tc)
+{
+	uint32_t i;
+	int len = 0;
+
+	buf[0] = '\0';
+	for (i = 0; i < n_tc; i++)
+		len += snprintf(buf + len, RTE_SCHED_LOG_BUF_SIZE - len,
+			i ? ", %u" : "%u", tc_credits[i]);
 }
 
 static void
 rte_sched_port_log_pipe_profile(struct rte_sched_port *port, uint32_t i)
 {
 	struct rte_sched_pipe_profile *p = port->pipe_profiles + i;
+	char tc_buf[RTE_SCHED_LOG_BUF_SIZE];
+	char wrr_buf[RTE_SCHED_LOG_BUF_SIZE];
+	uint32_t tc, j;
+	int len = 0;
+
+	rte_sched_log_tc_credits(tc_buf, p->tc_credits_per_period,
+		port->n_traffic_classes);
+
+	wrr_buf[0] = '\0';
+	for (tc = 0; tc < port->n_traffic_classes; tc++)
+		for (j = 0; j < port->tc_n_queues[tc]; j++)
+			len += snprintf(wrr_buf + len,
+				RTE_SCHED_LOG_BUF_SIZE - len, "%s%s%hhu%s",
+				(tc && j == 0) ? ", " : "",
+				j ? ", " : "[",
+				p->wrr_cost[port->tc_qpos[tc] + j],
+				(j == port->tc_n_queues[tc] - 1u) ? "]" : "");
 
 	RTE_LOG(DEBUG, SCHED, "Low level config for pipe profile %u:\n"
 		"    Token bucket: period = %u, credits per period = %u, size = %u\n"
-		"    Traffic classes: period = %u, credits per period = [%u, %u, %u, %u]\n"
-		"    Traffic class 3 oversubscription: weight = %hhu\n"
-		"    WRR cost: [%hhu, %hhu, %hhu, %hhu], [%hhu, %hhu, %hhu, %hhu], [%hhu, %hhu, %hhu, %hhu], [%hhu, %hhu, %hhu, %hhu]\n",
+		"    Traffic classes: period = %u, credits per period = [%s]\n"
+		"    Best effort traffic class oversubscription: weight = %hhu\n"
+		"    WRR cost: %s\n",
 		i,
 
 		/* Token bucket */
@@ -508,19 +777,13 @@ rte_sched_port_log_pipe_profile(struct rte_sched_port *port, uint32_t i)
 
 		/* Traffic classes */
 		p->tc_period,
-		p->tc_credits_per_period[0],
-		p->tc_credits_per_period[1],
-		p->tc_credits_per_period[2],
-		p->tc_credits_per_period[3],
+		tc_buf,
 
-		/* Traffic class 3 oversubscription */
+		/* Best effort traffic class oversubscription */
 		p->tc_ov_weight,
 
 		/* WRR */
-		p->wrr_cost[ 0], p->wrr_cost[ 1], p->wrr_cost[ 2], p->wrr_cost[ 3],
-		p->wrr_cost[ 4], p->wrr_cost[ 5], p->wrr_cost[ 6], p->wrr_cost[ 7],
-		p->wrr_cost[ 8], p->wrr_cost[ 9], p->wrr_cost[10], p->wrr_cost[11],
-		p->wrr_cost[12], p->wrr_cost[13], p->wrr_cost[14], p->wrr_cost[15]);
+		wrr_buf);
 }
 
 static inline uint64_t
@@ -534,11 +797,12 @@ rte_sched_time_ms_to_bytes(uint32_t time_ms, uint32_t rate)
 }
 
 static void
-rte_sched_pipe_profile_convert(struct rte_sched_pipe_params *src,
-	struct rte_sched_pipe_profile *dst,
-	uint32_t rate)
+rte_sched_pipe_profile_convert(struct rte_sched_port *port,
+	struct rte_sched_pipe_params *src,
+	struct rte_sched_pipe_profile *dst)
 {
-	uint32_t i;
+	uint32_t rate = port->rate;
+	uint32_t i, j;
 
 	/* Token Bucket */
 	if (src->tb_rate == rate) {
@@ -559,7 +823,7 @@ rte_sched_pipe_profile_convert(struct rte_sched_pipe_params *src,
 	dst->tc_period = rte_sched_time_ms_to_bytes(src->tc_period,
 						rate);
 
-	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i++)
+	for (i = 0; i < port->n_traffic_classes; i++)
 		dst->tc_credits_per_period[i]
 			= rte_sched_time_ms_to_bytes(src->tc_period,
 				src->tc_rate[i]);
@@ -569,31 +833,23 @@ rte_sched_pipe_profile_convert(struct rte_sched_pipe_params *src,
 #endif
 
 	/* WRR */
-	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i++) {
-		uint32_t wrr_cost[RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS];
-		uint32_t lcd, lcd1, lcd2;
-		uint32_t qindex;
-
-		qindex = i * RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS;
-
-		wrr_cost[0] = src->wrr_weights[qindex];
-		wrr_cost[1] = src->wrr_weights[qindex + 1];
-		wrr_cost[2] = src->wrr_weights[qindex + 2];
-		wrr_cost[3] = src->wrr_weights[qindex + 3];
-
-		lcd1 = rte_get_lcd(wrr_cost[0], wrr_cost[1]);
-		lcd2 = rte_get_lcd(wrr_cost[2], wrr_cost[3]);
-		lcd = rte_get_lcd(lcd1, lcd2);
-
-		wrr_cost[0] = lcd / wrr_cost[0];
-		wrr_cost[1] = lcd / wrr_cost[1];
-		wrr_cost[2] = lcd / wrr_cost[2];
-		wrr_cost[3] = lcd / wrr_cost[3];
-
-		dst->wrr_cost[qindex] = (uint8_t) wrr_cost[0];
-		dst->wrr_cost[qindex + 1] = (uint8_t) wrr_cost[1];
-		dst->wrr_cost[qindex + 2] = (uint8_t) wrr_cost[2];
-		dst->wrr_cost[qindex + 3] = (uint8_t) wrr_cost[3];
+	for (i = 0; i < port->n_traffic_classes; i++) {
+		uint32_t n_queues = port->tc_n_queues[i];
+		uint32_t qindex = port->tc_qpos[i];
+		uint32_t lcd;
+
+		if (n_queues == 1) {
+			dst->wrr_cost[qindex] = 1;
+			continue;
+		}
+
+		lcd = src->wrr_weights[qindex];
+		for (j = 1; j < n_queues; j++)
+			lcd = rte_get_lcd(lcd, src->wrr_weights[qindex + j]);
+
+		for (j = 0; j < n_queues; j++)
+			dst->wrr_cost[qindex + j] =
+				(uint8_t) (lcd / src->wrr_weights[qindex + j]);
 	}
 }
 
@@ -607,17 +863,17 @@ rte_sched_port_config_pipe_profile_table(struct rte_sched_port *port,
 		struct rte_sched_pipe_params *src = params->pipe_profiles + i;
 		struct rte_sched_pipe_profile *dst = port->pipe_profiles + i;
 
-		rte_sched_pipe_profile_convert(src, dst, params->rate);
+		rte_sched_pipe_profile_convert(port, src, dst);
 		rte_sched_port_log_pipe_profile(port, i);
 	}
 
-	port->pipe_tc3_rate_max = 0;
+	port->pipe_tc_be_rate_max = 0;
 	for (i = 0; i < port->n_pipe_profiles; i++) {
 		struct rte_sched_pipe_params *src = params->pipe_profiles + i;
-		uint32_t pipe_tc3_rate = src->tc_rate[3];
+		uint32_t pipe_tc_be_rate = src->tc_rate[port->tc_be];
 
-		if (port->pipe_tc3_rate_max < pipe_tc3_rate)
-			port->pipe_tc3_rate_max = pipe_tc3_rate;
+		if (port->pipe_tc_be_rate_max < pipe_tc_be_rate)
+			port->pipe_tc_be_rate_max = pipe_tc_be_rate;
 	}
 }
 
@@ -650,8 +906,11 @@ rte_sched_port_config(struct rte_sched_port_params *params)
 	memcpy(port->qsize, params->qsize, sizeof(params->qsize));
 	port->n_pipe_profiles = params->n_pipe_profiles;
 
+	/* Pipe queue layout */
+	rte_sched_port_config_layout(port, params);
+
 #ifdef RTE_SCHED_RED
-	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i++) {
+	for (i = 0; i < port->n_traffic_classes; i++) {
 		uint32_t j;
 
 		for (j = 0; j < e_RTE_METER_COLORS; j++) {
@@ -749,8 +1008,8 @@ rte_sched_port_free(struct rte_sched_port *port)
 
 	/* Free enqueued mbufs */
 	for (qindex = 0; qindex < n_queues_per_port; qindex++) {
-		struct rte_mbuf **mbufs = rte_sched_port_qbase(port, qindex);
-		uint16_t qsize = rte_sched_port_qsize(port, qindex);
+		struct rte_mbuf **mbufs = rte_sched_port_qbase(port, qindex, 0);
+		uint16_t qsize = rte_sched_port_qsize(port, qindex, 0);
 		struct rte_sched_queue *queue = port->queue + qindex;
 		uint16_t qr = queue->qr & (qsize - 1);
 		uint16_t qw = queue->qw & (qsize - 1);
@@ -763,15 +1022,77 @@ rte_sched_port_free(struct rte_sched_port *port)
 	rte_free(port);
 }
 
+struct rte_sched_shard_group * __rte_experimental
+rte_sched_shard_group_create(struct rte_sched_shard_group_params *params)
+{
+	struct rte_sched_shard_group *group;
+
+	/* Check user parameters */
+	if (params == NULL ||
+	    params->rate == 0 ||
+	    params->tb_size == 0)
+		return NULL;
+
+	group = rte_zmalloc_socket(params->name, sizeof(*group),
+		RTE_CACHE_LINE_SIZE, params->socket);
+	if (group == NULL)
+		return NULL;
+
+	/* User parameters */
+	group->rate = params->rate;
+	group->tb_size = params->tb_size;
+
+	/* Timing */
+	group->time_cpu_cycles = rte_get_tsc_cycles();
+	group->cpu_hz = rte_get_tsc_hz();
+	group->inv_cpu_hz = rte_reciprocal_value_u64(group->cpu_hz);
+
+	rte_atomic64_init(&group->tb_time);
+
+	return group;
+}
+
+void __rte_experimental
+rte_sched_shard_group_free(struct rte_sched_shard_group *group)
+{
+	rte_free(group);
+}
+
+int __rte_experimental
+rte_sched_port_shard_attach(struct rte_sched_port *port,
+	struct rte_sched_shard_group *group)
+{
+	/* Check user parameters */
+	if (port == NULL || group == NULL)
+		return -1;
+
+	if (port->rate != group->rate)
+		return -2;
+
+	/* A single packet can overshoot the credits of a dequeue operation,
+	 * by up to the MTU plus the frame overhead (both in port->mtu)
+	 */
+	if (group->tb_size < port->mtu)
+		return -3;
+
+	port->shard_group = group;
+
+	return 0;
+}
+
 static void
 rte_sched_port_log_subport_config(struct rte_sched_port *port, uint32_t i)
 {
 	struct rte_sched_subport *s = port->subport + i;
+	char tc_buf[RTE_SCHED_LOG_BUF_SIZE];
+
+	rte_sched_log_tc_credits(tc_buf, s->tc_credits_per_period,
+		port->n_traffic_classes);
 
 	RTE_LOG(DEBUG, SCHED, "Low level config for subport %u:\n"
 		"    Token bucket: period = %u, credits per period = %u, size = %u\n"
-		"    Traffic classes: period = %u, credits per period = [%u, %u, %u, %u]\n"
-		"    Traffic class 3 oversubscription: wm min = %u, wm max = %u\n",
+		"    Traffic classes: period = %u, credits per period = [%s]\n"
+		"    Best effort traffic class oversubscription: wm min = %u, wm max = %u\n",
 		i,
 
 		/* Token bucket */
@@ -781,12 +1102,9 @@ rte_sched_port_log_subport_config(struct rte_sched_port *port, uint32_t i)
 
 		/* Traffic classes */
 		s->tc_period,
-		s->tc_credits_per_period[0],
-		s->tc_credits_per_period[1],
-		s->tc_credits_per_period[2],
-		s->tc_credits_per_period[3],
+		tc_buf,
 
-		/* Traffic class 3 oversubscription */
+		/* Best effort traffic class oversubscription */
 		s->tc_ov_wm_min,
 		s->tc_ov_wm_max);
 }
@@ -811,7 +1129,7 @@ rte_sched_subport_config(struct rte_sched_port *port,
 	if (params->tb_size == 0)
 		return -3;
 
-	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i++) {
+	for (i = 0; i < port->n_traffic_classes; i++) {
 		if (params->tc_rate[i] == 0 ||
 		    params->tc_rate[i] > params->tb_rate)
 			return -4;
@@ -839,20 +1157,20 @@ rte_sched_subport_config(struct rte_sched_port *port,
 
 	/* Traffic Classes (TCs) */
 	s->tc_period = rte_sched_time_ms_to_bytes(params->tc_period, port->rate);
-	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i++) {
+	for (i = 0; i < port->n_traffic_classes; i++) {
 		s->tc_credits_per_period[i]
 			= rte_sched_time_ms_to_bytes(params->tc_period,
 						     params->tc_rate[i]);
 	}
 	s->tc_time = port->time + s->tc_period;
-	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i++)
+	for (i = 0; i < port->n_traffic_classes; i++)
 		s->tc_credits[i] = s->tc_credits_per_period[i];
 
 #ifdef RTE_SCHED_SUBPORT_TC_OV
 	/* TC oversubscription */
 	s->tc_ov_wm_min = port->mtu;
 	s->tc_ov_wm_max = rte_sched_time_ms_to_bytes(params->tc_period,
-						     port->pipe_tc3_rate_max);
+						     port->pipe_tc_be_rate_max);
 	s->tc_ov_wm = s->tc_ov_wm_max;
 	s->tc_ov_period_id = 0;
 	s->tc_ov = 0;
@@ -874,6 +1192,7 @@ rte_sched_pipe_config(struct rte_sched_port *port,
 	struct rte_sched_subport *s;
 	struct rte_sched_pipe *p;
 	struct rte_sched_pipe_profile *params;
+	uint32_t *tc_credits;
 	uint32_t deactivate, profile, i;
 
 	/* Check user parameters */
@@ -892,33 +1211,36 @@ rte_sched_pipe_config(struct rte_sched_port *port,
 	if (s->tb_period == 0)
 		return -2;
 
-	p = port->pipe + (subport_id * port->n_pipes_per_subport + pipe_id);
+	p = rte_sched_port_pipe(port,
+		subport_id * port->n_pipes_per_subport + pipe_id, 0);
 
 	/* Handle the case when pipe already has a valid configuration */
 	if (p->tb_time) {
 		params = port->pipe_profiles + p->profile;
 
 #ifdef RTE_SCHED_SUBPORT_TC_OV
-		double subport_tc3_rate = (double) s->tc_credits_per_period[3]
+		double subport_tc_be_rate =
+			(double) s->tc_credits_per_period[port->tc_be]
 			/ (double) s->tc_period;
-		double pipe_tc3_rate = (double) params->tc_credits_per_period[3]
+		double pipe_tc_be_rate =
+			(double) params->tc_credits_per_period[port->tc_be]
 			/ (double) params->tc_period;
-		uint32_t tc3_ov = s->tc_ov;
+		uint32_t tc_be_ov = s->tc_ov;
 
 		/* Unplug pipe from its subport */
 		s->tc_ov_n -= params->tc_ov_weight;
-		s->tc_ov_rate -= pipe_tc3_rate;
-		s->tc_ov = s->tc_ov_rate > subport_tc3_rate;
+		s->tc_ov_rate -= pipe_tc_be_rate;
+		s->tc_ov = s->tc_ov_rate > subport_tc_be_rate;
 
-		if (s->tc_ov != tc3_ov) {
+		if (s->tc_ov != tc_be_ov) {
 			RTE_LOG(DEBUG, SCHED,
-				"Subport %u TC3 oversubscription is OFF (%.4lf >= %.4lf)\n",
-				subport_id, subport_tc3_rate, s->tc_ov_rate);
+				"Subport %u best effort TC oversubscription is OFF (%.4lf >= %.4lf)\n",
+				subport_id, subport_tc_be_rate, s->tc_ov_rate);
 		}
 #endif
 
 		/* Reset the pipe */
-		memset(p, 0, sizeof(struct rte_sched_pipe));
+		memset(p, 0, 1 << port->pipe_size_log2);
 	}
 
 	if (deactivate)
@@ -934,26 +1256,29 @@ rte_sched_pipe_config(struct rte_sched_port *port,
 
 	/* Traffic Classes (TCs) */
 	p->tc_time = port->time + params->tc_period;
-	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i++)
-		p->tc_credits[i] = params->tc_credits_per_period[i];
+	tc_credits = rte_sched_pipe_tc_credits(port, p, 0);
+	for (i = 0; i < port->n_traffic_classes; i++)
+		tc_credits[i] = params->tc_credits_per_period[i];
 
 #ifdef RTE_SCHED_SUBPORT_TC_OV
 	{
-		/* Subport TC3 oversubscription */
-		double subport_tc3_rate = (double) s->tc_credits_per_period[3]
+		/* Subport best effort TC oversubscription */
+		double subport_tc_be_rate =
+			(double) s->tc_credits_per_period[port->tc_be]
 			/ (double) s->tc_period;
-		double pipe_tc3_rate = (double) params->tc_credits_per_period[3]
+		double pipe_tc_be_rate =
+			(double) params->tc_credits_per_period[port->tc_be]
 			/ (double) params->tc_period;
-		uint32_t tc3_ov = s->tc_ov;
+		uint32_t tc_be_ov = s->tc_ov;
 
 		s->tc_ov_n += params->tc_ov_weight;
-		s->tc_ov_rate += pipe_tc3_rate;
-		s->tc_ov = s->tc_ov_rate > subport_tc3_rate;
+		s->tc_ov_rate += pipe_tc_be_rate;
+		s->tc_ov = s->tc_ov_rate > subport_tc_be_rate;
 
-		if (s->tc_ov != tc3_ov) {
+		if (s->tc_ov != tc_be_ov) {
 			RTE_LOG(DEBUG, SCHED,
-				"Subport %u TC3 oversubscription is ON (%.4lf < %.4lf)\n",
-				subport_id, subport_tc3_rate, s->tc_ov_rate);
+				"Subport %u best effort TC oversubscription is ON (%.4lf < %.4lf)\n",
+				subport_id, subport_tc_be_rate, s->tc_ov_rate);
 		}
 		p->tc_ov_period_id = s->tc_ov_period_id;
 		p->tc_ov_credits = s->tc_ov_wm;
@@ -981,12 +1306,13 @@ rte_sched_port_pipe_profile_add(struct rte_sched_port *port,
 		return -2;
 
 	/* Pipe params */
-	status = pipe_profile_check(params, port->rate);
+	status = pipe_profile_check(params, port->rate,
+		port->n_traffic_classes, port->tc_n_queues);
 	if (status != 0)
 		return status;
 
 	pp = &port->pipe_profiles[port->n_pipe_profiles];
-	rte_sched_pipe_profile_convert(params, pp, port->rate);
+	rte_sched_pipe_profile_convert(port, params, pp);
 
 	/* Pipe profile not exists */
 	for (i = 0; i < port->n_pipe_profiles; i++)
@@ -997,8 +1323,8 @@ rte_sched_port_pipe_profile_add(struct rte_sched_port *port,
 	*pipe_profile_id = port->n_pipe_profiles;
 	port->n_pipe_profiles++;
 
-	if (port->pipe_tc3_rate_max < params->tc_rate[3])
-		port->pipe_tc3_rate_max = params->tc_rate[3];
+	if (port->pipe_tc_be_rate_max < params->tc_rate[port->tc_be])
+		port->pipe_tc_be_rate_max = params->tc_rate[port->tc_be];
 
 	rte_sched_port_log_pipe_profile(port, *pipe_profile_id);
 
@@ -1099,18 +1425,46 @@ rte_sched_queue_read_stats(struct rte_sched_port *port,
 	return 0;
 }
 
-static inline uint32_t
-rte_sched_port_qindex(struct rte_sched_port *port, uint32_t subport, uint32_t pipe, uint32_t traffic_class, uint32_t queue)
+static __rte_always_inline uint32_t
+rte_sched_port_qindex(struct rte_sched_port *port, uint32_t subport,
+	uint32_t pipe, uint32_t traffic_class, uint32_t queue,
+	const int default_layout)
 {
-	uint32_t result;
+	uint32_t result, tc_qmask;
 
 	result = subport * port->n_pipes_per_subport + pipe;
-	result = result * RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE + traffic_class;
-	result = result * RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS + queue;
+
+	/* Keep the queue within its traffic class, a queue of another traffic
+	 * class or a padding queue (no packet storage) would be corrupted
+	 */
+	tc_qmask = default_layout ? RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS - 1 :
+		port->tc_qmask[traffic_class];
+	result = (result << (default_layout ?
+			rte_bsf32(RTE_SCHED_QUEUES_PER_PIPE) :
+			port->n_queues_per_pipe_log2)) +
+		port->tc_qpos[traffic_class] + (queue & tc_qmask);
 
 	return result;
 }
 
+uint32_t __rte_experimental
+rte_sched_port_queue_id(struct rte_sched_port *port,
+	uint32_t subport,
+	uint32_t pipe,
+	uint32_t traffic_class,
+	uint32_t queue)
+{
+	if (port == NULL ||
+	    subport >= port->n_subports_per_port ||
+	    pipe >= port->n_pipes_per_subport ||
+	    traffic_class >= port->n_traffic_classes ||
+	    queue >= port->tc_n_queues[traffic_class])
+		return UINT32_MAX;
+
+	return rte_sched_port_qindex(port, subport, pipe, traffic_class, queue,
+		port->default_layout);
+}
+
 #ifdef RTE_SCHED_DEBUG
 
 static inline int
@@ -1129,7 +1483,7 @@ static inline void
 rte_sched_port_update_subport_stats(struct rte_sched_port *port, uint32_t qindex, struct rte_mbuf *pkt)
 {
 	struct rte_sched_subport *s = port->subport + (qindex / rte_sched_port_queues_per_subport(port));
-	uint32_t tc_index = (qindex >> 2) & 0x3;
+	uint32_t tc_index = rte_sched_port_qindex_tc(port, qindex, 0);
 	uint32_t pkt_len = pkt->pkt_len;
 
 	s->stats.n_pkts_tc[tc_index] += 1;
@@ -1149,7 +1503,7 @@ rte_sched_port_update_subport_stats_on_drop(struct rte_sched_port *port,
 #endif
 {
 	struct rte_sched_subport *s = port->subport + (qindex / rte_sched_port_queues_per_subport(port));
-	uint32_t tc_index = (qindex >> 2) & 0x3;
+	uint32_t tc_index = rte_sched_port_qindex_tc(port, qindex, 0);
 	uint32_t pkt_len = pkt->pkt_len;
 
 	s->stats.n_pkts_tc_dropped[tc_index] += 1;
@@ -1204,7 +1558,7 @@ rte_sched_port_red_drop(struct rte_sched_port *port, struct rte_mbuf *pkt, uint3
 	uint32_t tc_index;
 	enum rte_meter_color color;
 
-	tc_index = (qindex >> 2) & 0x3;
+	tc_index = rte_sched_port_qindex_tc(port, qindex, 0);
 	color = rte_sched_port_pkt_read_color(pkt);
 	red_cfg = &port->red_config[tc_index][color];
 
@@ -1263,9 +1617,10 @@ debug_check_queue_slab(struct rte_sched_port *port, uint32_t bmp_pos,
 
 #endif /* RTE_SCHED_DEBUG */
 
-static inline uint32_t
+static __rte_always_inline uint32_t
 rte_sched_port_enqueue_qptrs_prefetch0(struct rte_sched_port *port,
-				       struct rte_mbuf *pkt)
+				       struct rte_mbuf *pkt,
+				       const int default_layout)
 {
 	struct rte_sched_queue *q;
 #ifdef RTE_SCHED_COLLECT_STATS
@@ -1275,7 +1630,8 @@ rte_sched_port_enqueue_qptrs_prefetch0(struct rte_sched_port *port,
 
 	rte_sched_port_pkt_read_tree_path(pkt, &subport, &pipe, &traffic_class, &queue);
 
-	qindex = rte_sched_port_qindex(port, subport, pipe, traffic_class, queue);
+	qindex = rte_sched_port_qindex(port, subport, pipe, traffic_class, queue,
+		default_layout);
 	q = port->queue + qindex;
 	rte_prefetch0(q);
 #ifdef RTE_SCHED_COLLECT_STATS
@@ -1286,32 +1642,34 @@ rte_sched_port_enqueue_qptrs_prefetch0(struct rte_sched_port *port,
 	return qindex;
 }
 
-static inline void
+static __rte_always_inline void
 rte_sched_port_enqueue_qwa_prefetch0(struct rte_sched_port *port,
-				     uint32_t qindex, struct rte_mbuf **qbase)
+				     uint32_t qindex, struct rte_mbuf **qbase,
+				     const int default_layout)
 {
 	struct rte_sched_queue *q;
 	struct rte_mbuf **q_qw;
 	uint16_t qsize;
 
 	q = port->queue + qindex;
-	qsize = rte_sched_port_qsize(port, qindex);
+	qsize = rte_sched_port_qsize(port, qindex, default_layout);
 	q_qw = qbase + (q->qw & (qsize - 1));
 
 	rte_prefetch0(q_qw);
 	rte_bitmap_prefetch0(port->bmp, qindex);
 }
 
-static inline int
+static __rte_always_inline int
 rte_sched_port_enqueue_qwa(struct rte_sched_port *port, uint32_t qindex,
-			   struct rte_mbuf **qbase, struct rte_mbuf *pkt)
+			   struct rte_mbuf **qbase, struct rte_mbuf *pkt,
+			   const int default_layout)
 {
 	struct rte_sched_queue *q;
 	uint16_t qsize;
 	uint16_t qlen;
 
 	q = port->queue + qindex;
-	qsize = rte_sched_port_qsize(port, qindex);
+	qsize = rte_sched_port_qsize(port, qindex, default_layout);
 	qlen = q->qw - q->qr;
 
 	/* Drop the packet (and update drop stats) when queue is full */
@@ -1357,9 +1715,9 @@ rte_sched_port_enqueue_qwa(struct rte_sched_port *port, uint32_t qindex,
  *   p01            p11            p21            p31
  *
  */
-int
-rte_sched_port_enqueue(struct rte_sched_port *port, struct rte_mbuf **pkts,
-		       uint32_t n_pkts)
+static __rte_always_inline int
+rte_sched_port_enqueue_layout(struct rte_sched_port *port,
+	struct rte_mbuf **pkts, uint32_t n_pkts, const int default_layout)
 {
 	struct rte_mbuf *pkt00, *pkt01, *pkt10, *pkt11, *pkt20, *pkt21,
 		*pkt30, *pkt31, *pkt_last;
@@ -1386,19 +1744,20 @@ rte_sched_port_enqueue(struct rte_sched_port *port, struct rte_mbuf **pkts,
 		/* Prefetch the queue structure for each queue */
 		for (i = 0; i < n_pkts; i++)
 			q[i] = rte_sched_port_enqueue_qptrs_prefetch0(port,
-								      pkts[i]);
+				pkts[i], default_layout);
 
 		/* Prefetch the write pointer location of each queue */
 		for (i = 0; i < n_pkts; i++) {
-			q_base[i] = rte_sched_port_qbase(port, q[i]);
+			q_base[i] = rte_sched_port_qbase(port, q[i],
+				default_layout);
 			rte_sched_port_enqueue_qwa_prefetch0(port, q[i],
-							     q_base[i]);
+				q_base[i], default_layout);
 		}
 
 		/* Write each packet to its queue */
 		for (i = 0; i < n_pkts; i++)
 			result += rte_sched_port_enqueue_qwa(port, q[i],
-							     q_base[i], pkts[i]);
+				q_base[i], pkts[i], default_layout);
 
 		return result;
 	}
@@ -1414,21 +1773,27 @@ rte_sched_port_enqueue(struct rte_sched_port *port, struct rte_mbuf **pkts,
 	rte_prefetch0(pkt10);
 	rte_prefetch0(pkt11);
 
-	q20 = rte_sched_port_enqueue_qptrs_prefetch0(port, pkt20);
-	q21 = rte_sched_port_enqueue_qptrs_prefetch0(port, pkt21);
+	q20 = rte_sched_port_enqueue_qptrs_prefetch0(port, pkt20,
+		default_layout);
+	q21 = rte_sched_port_enqueue_qptrs_prefetch0(port, pkt21,
+		default_layout);
 
 	pkt00 = pkts[4];
 	pkt01 = pkts[5];
 	rte_prefetch0(pkt00);
 	rte_prefetch0(pkt01);
 
-	q10 = rte_sched_port_enqueue_qptrs_prefetch0(port, pkt10);
-	q11 = rte_sched_port_enqueue_qptrs_prefetch0(port, pkt11);
+	q10 = rte_sched_port_enqueue_qptrs_prefetch0(port, pkt10,
+		default_layout);
+	q11 = rte_sched_port_enqueue_qptrs_prefetch0(port, pkt11,
+		default_layout);
 
-	q20_base = rte_sched_port_qbase(port, q20);
-	q21_base = rte_sched_port_qbase(port, q21);
-	rte_sched_port_enqueue_qwa_prefetch0(port, q20, q20_base);
-	rte_sched_port_enqueue_qwa_prefetch0(port, q21, q21_base);
+	q20_base = rte_sched_port_qbase(port, q20, default_layout);
+	q21_base = rte_sched_port_qbase(port, q21, default_layout);
+	rte_sched_port_enqueue_qwa_prefetch0(port, q20, q20_base,
+		default_layout);
+	rte_sched_port_enqueue_qwa_prefetch0(port, q21, q21_base,
+		default_layout);
 
 	/* Run the pipeline */
 	for (i = 6; i < (n_pkts & (~1)); i += 2) {
@@ -1453,18 +1818,24 @@ rte_sched_port_enqueue(struct rte_sched_port *port, struct rte_mbuf **pkts,
 		rte_prefetch0(pkt01);
 
 		/* Stage 1: Prefetch queue structure storing queue pointers */
-		q10 = rte_sched_port_enqueue_qptrs_prefetch0(port, pkt10);
-		q11 = rte_sched_port_enqueue_qptrs_prefetch0(port, pkt11);
+		q10 = rte_sched_port_enqueue_qptrs_prefetch0(port, pkt10,
+			default_layout);
+		q11 = rte_sched_port_enqueue_qptrs_prefetch0(port, pkt11,
+			default_layout);
 
 		/* Stage 2: Prefetch queue write location */
-		q20_base = rte_sched_port_qbase(port, q20);
-		q21_base = rte_sched_port_qbase(port, q21);
-		rte_sched_port_enqueue_qwa_prefetch0(port, q20, q20_base);
-		rte_sched_port_enqueue_qwa_prefetch0(port, q21, q21_base);
+		q20_base = rte_sched_port_qbase(port, q20, default_layout);
+		q21_base = rte_sched_port_qbase(port, q21, default_layout);
+		rte_sched_port_enqueue_qwa_prefetch0(port, q20, q20_base,
+			default_layout);
+		rte_sched_port_enqueue_qwa_prefetch0(port, q21, q21_base,
+			default_layout);
 
 		/* Stage 3: Write packet to queue and activate queue */
-		r30 = rte_sched_port_enqueue_qwa(port, q30, q30_base, pkt30);
-		r31 = rte_sched_port_enqueue_qwa(port, q31, q31_base, pkt31);
+		r30 = rte_sched_port_enqueue_qwa(port, q30, q30_base, pkt30,
+			default_layout);
+		r31 = rte_sched_port_enqueue_qwa(port, q31, q31_base, pkt31,
+			default_layout);
 		result += r30 + r31;
 	}
 
@@ -1476,54 +1847,82 @@ rte_sched_port_enqueue(struct rte_sched_port *port, struct rte_mbuf **pkts,
 	pkt_last = pkts[n_pkts - 1];
 	rte_prefetch0(pkt_last);
 
-	q00 = rte_sched_port_enqueue_qptrs_prefetch0(port, pkt00);
-	q01 = rte_sched_port_enqueue_qptrs_prefetch0(port, pkt01);
-
-	q10_base = rte_sched_port_qbase(port, q10);
-	q11_base = rte_sched_port_qbase(port, q11);
-	rte_sched_port_enqueue_qwa_prefetch0(port, q10, q10_base);
-	rte_sched_port_enqueue_qwa_prefetch0(port, q11, q11_base);
-
-	r20 = rte_sched_port_enqueue_qwa(port, q20, q20_base, pkt20);
-	r21 = rte_sched_port_enqueue_qwa(port, q21, q21_base, pkt21);
+	q00 = rte_sched_port_enqueue_qptrs_prefetch0(port, pkt00,
+		default_layout);
+	q01 = rte_sched_port_enqueue_qptrs_prefetch0(port, pkt01,
+		default_layout);
+
+	q10_base = rte_sched_port_qbase(port, q10, default_layout);
+	q11_base = rte_sched_port_qbase(port, q11, default_layout);
+	rte_sched_port_enqueue_qwa_prefetch0(port, q10, q10_base,
+		default_layout);
+	rte_sched_port_enqueue_qwa_prefetch0(port, q11, q11_base,
+		default_layout);
+
+	r20 = rte_sched_port_enqueue_qwa(port, q20, q20_base, pkt20,
+		default_layout);
+	r21 = rte_sched_port_enqueue_qwa(port, q21, q21_base, pkt21,
+		default_layout);
 	result += r20 + r21;
 
-	q_last = rte_sched_port_enqueue_qptrs_prefetch0(port, pkt_last);
+	q_last = rte_sched_port_enqueue_qptrs_prefetch0(port, pkt_last,
+		default_layout);
 
-	q00_base = rte_sched_port_qbase(port, q00);
-	q01_base = rte_sched_port_qbase(port, q01);
-	rte_sched_port_enqueue_qwa_prefetch0(port, q00, q00_base);
-	rte_sched_port_enqueue_qwa_prefetch0(port, q01, q01_base);
+	q00_base = rte_sched_port_qbase(port, q00, default_layout);
+	q01_base = rte_sched_port_qbase(port, q01, default_layout);
+	rte_sched_port_enqueue_qwa_prefetch0(port, q00, q00_base,
+		default_layout);
+	rte_sched_port_enqueue_qwa_prefetch0(port, q01, q01_base,
+		default_layout);
 
-	r10 = rte_sched_port_enqueue_qwa(port, q10, q10_base, pkt10);
-	r11 = rte_sched_port_enqueue_qwa(port, q11, q11_base, pkt11);
+	r10 = rte_sched_port_enqueue_qwa(port, q10, q10_base, pkt10,
+		default_layout);
+	r11 = rte_sched_port_enqueue_qwa(port, q11, q11_base, pkt11,
+		default_layout);
 	result += r10 + r11;
 
-	q_last_base = rte_sched_port_qbase(port, q_last);
-	rte_sched_port_enqueue_qwa_prefetch0(port, q_last, q_last_base);
+	q_last_base = rte_sched_port_qbase(port, q_last, default_layout);
+	rte_sched_port_enqueue_qwa_prefetch0(port, q_last, q_last_base,
+		default_layout);
 
-	r00 = rte_sched_port_enqueue_qwa(port, q00, q00_base, pkt00);
-	r01 = rte_sched_port_enqueue_qwa(port, q01, q01_base, pkt01);
+	r00 = rte_sched_port_enqueue_qwa(port, q00, q00_base, pkt00,
+		default_layout);
+	r01 = rte_sched_port_enqueue_qwa(port, q01, q01_base, pkt01,
+		default_layout);
 	result += r00 + r01;
 
 	if (n_pkts & 1) {
-		r_last = rte_sched_port_enqueue_qwa(port, q_last, q_last_base, pkt_last);
+		r_last = rte_sched_port_enqueue_qwa(port, q_last, q_last_base,
+			pkt_last, default_layout);
 		result += r_last;
 	}
 
 	return result;
 }
 
+int
+rte_sched_port_enqueue(struct rte_sched_port *port, struct rte_mbuf **pkts,
+		       uint32_t n_pkts)
+{
+	if (port->default_layout)
+		return rte_sched_port_enqueue_layout(port, pkts, n_pkts, 1);
+
+	return rte_sched_port_enqueue_layout(port, pkts, n_pkts, 0);
+}
+
 #ifndef RTE_SCHED_SUBPORT_TC_OV
 
-static inline void
-grinder_credits_update(struct rte_sched_port *port, uint32_t pos)
+static __rte_always_inline void
+grinder_credits_update(struct rte_sched_port *port, uint32_t pos,
+	const int default_layout)
 {
 	struct rte_sched_grinder *grinder = port->grinder + pos;
 	struct rte_sched_subport *subport = grinder->subport;
 	struct rte_sched_pipe *pipe = grinder->pipe;
 	struct rte_sched_pipe_profile *params = grinder->pipe_params;
+	uint32_t n_tc = rte_sched_port_n_tc(port, default_layout);
 	uint64_t n_periods;
+	uint32_t i;
 
 	/* Subport TB */
 	n_periods = (port->time - subport->tb_time) / subport->tb_period;
@@ -1539,46 +1938,48 @@ grinder_credits_update(struct rte_sched_port *port, uint32_t pos)
 
 	/* Subport TCs */
 	if (unlikely(port->time >= subport->tc_time)) {
-		subport->tc_credits[0] = subport->tc_credits_per_period[0];
-		subport->tc_credits[1] = subport->tc_credits_per_period[1];
-		subport->tc_credits[2] = subport->tc_credits_per_period[2];
-		subport->tc_credits[3] = subport->tc_credits_per_period[3];
+		for (i = 0; i < n_tc; i++)
+			subport->tc_credits[i] = subport->tc_credits_per_period[i];
+
 		subport->tc_time = port->time + subport->tc_period;
 	}
 
 	/* Pipe TCs */
 	if (unlikely(port->time >= pipe->tc_time)) {
-		pipe->tc_credits[0] = params->tc_credits_per_period[0];
-		pipe->tc_credits[1] = params->tc_credits_per_period[1];
-		pipe->tc_credits[2] = params->tc_credits_per_period[2];
-		pipe->tc_credits[3] = params->tc_credits_per_period[3];
+		uint32_t *tc_credits =
+			rte_sched_pipe_tc_credits(port, pipe, default_layout);
+
+		for (i = 0; i < n_tc; i++)
+			tc_credits[i] = params->tc_credits_per_period[i];
+
 		pipe->tc_time = port->time + params->tc_period;
 	}
 }
 
 #else
 
-static inline uint32_t
-grinder_tc_ov_credits_update(struct rte_sched_port *port, uint32_t pos)
+static __rte_always_inline uint32_t
+grinder_tc_ov_credits_update(struct rte_sched_port *port, uint32_t pos,
+	const int default_layout)
 {
 	struct rte_sched_grinder *grinder = port->grinder + pos;
 	struct rte_sched_subport *subport = grinder->subport;
-	uint32_t tc_ov_consumption[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
-	uint32_t tc_ov_consumption_max;
+	uint32_t tc_be = rte_sched_port_n_tc(port, default_layout) - 1;
+	uint32_t tc_consumption, tc_ov_consumption, tc_ov_consumption_max;
 	uint32_t tc_ov_wm = subport->tc_ov_wm;
+	uint32_t i;
 
 	if (subport->tc_ov == 0)
 		return subport->tc_ov_wm_max;
 
-	tc_ov_consumption[0] = subport->tc_credits_per_period[0] - subport->tc_credits[0];
-	tc_ov_consumption[1] = subport->tc_credits_per_period[1] - subport->tc_credits[1];
-	tc_ov_consumption[2] = subport->tc_credits_per_period[2] - subport->tc_credits[2];
-	tc_ov_consumption[3] = subport->tc_credits_per_period[3] - subport->tc_credits[3];
+	tc_consumption = 0;
+	for (i = 0; i < tc_be; i++)
+		tc_consumption += subport->tc_credits_per_period[i] - subport->tc_credits[i];
 
-	tc_ov_consumption_max = subport->tc_credits_per_period[3] -
-		(tc_ov_consumption[0] + tc_ov_consumption[1] + tc_ov_consumption[2]);
+	tc_ov_consumption = subport->tc_credits_per_period[tc_be] - subport->tc_credits[tc_be];
+	tc_ov_consumption_max = subport->tc_credits_per_period[tc_be] - tc_consumption;
 
-	if (tc_ov_consumption[3] > (tc_ov_consumption_max - port->mtu)) {
+	if (tc_ov_consumption > (tc_ov_consumption_max - port->mtu)) {
 		tc_ov_wm  -= tc_ov_wm >> 7;
 		if (tc_ov_wm < subport->tc_ov_wm_min)
 			tc_ov_wm = subport->tc_ov_wm_min;
@@ -1593,14 +1994,17 @@ grinder_tc_ov_credits_update(struct rte_sched_port *port, uint32_t pos)
 	return tc_ov_wm;
 }
 
-static inline void
-grinder_credits_update(struct rte_sched_port *port, uint32_t pos)
+static __rte_always_inline void
+grinder_credits_update(struct rte_sched_port *port, uint32_t pos,
+	const int default_layout)
 {
 	struct rte_sched_grinder *grinder = port->grinder + pos;
 	struct rte_sched_subport *subport = grinder->subport;
 	struct rte_sched_pipe *pipe = grinder->pipe;
 	struct rte_sched_pipe_profile *params = grinder->pipe_params;
+	uint32_t n_tc = rte_sched_port_n_tc(port, default_layout);
 	uint64_t n_periods;
+	uint32_t i;
 
 	/* Subport TB */
 	n_periods = (port->time - subport->tb_time) / subport->tb_period;
@@ -1616,12 +2020,11 @@ grinder_credits_update(struct rte_sched_port *port, uint32_t pos)
 
 	/* Subport TCs */
 	if (unlikely(port->time >= subport->tc_time)) {
-		subport->tc_ov_wm = grinder_tc_ov_credits_update(port, pos);
+		subport->tc_ov_wm =
+			grinder_tc_ov_credits_update(port, pos, default_layout);
 
-		subport->tc_credits[0] = subport->tc_credits_per_period[0];
-		subport->tc_credits[1] = subport->tc_credits_per_period[1];
-		subport->tc_credits[2] = subport->tc_credits_per_period[2];
-		subport->tc_credits[3] = subport->tc_credits_per_period[3];
+		for (i = 0; i < n_tc; i++)
+			subport->tc_credits[i] = subport->tc_credits_per_period[i];
 
 		subport->tc_time = port->time + subport->tc_period;
 		subport->tc_ov_period_id++;
@@ -1629,10 +2032,12 @@ grinder_credits_update(struct rte_sched_port *port, uint32_t pos)
 
 	/* Pipe TCs */
 	if (unlikely(port->time >= pipe->tc_time)) {
-		pipe->tc_credits[0] = params->tc_credits_per_period[0];
-		pipe->tc_credits[1] = params->tc_credits_per_period[1];
-		pipe->tc_credits[2] = params->tc_credits_per_period[2];
-		pipe->tc_credits[3] = params->tc_credits_per_period[3];
+		uint32_t *tc_credits =
+			rte_sched_pipe_tc_credits(port, pipe, default_layout);
+
+		for (i = 0; i < n_tc; i++)
+			tc_credits[i] = params->tc_credits_per_period[i];
+
 		pipe->tc_time = port->time + params->tc_period;
 	}
 
@@ -1649,19 +2054,22 @@ grinder_credits_update(struct rte_sched_port *port, uint32_t pos)
 
 #ifndef RTE_SCHED_SUBPORT_TC_OV
 
-static inline int
-grinder_credits_check(struct rte_sched_port *port, uint32_t pos)
+static __rte_always_inline int
+grinder_credits_check(struct rte_sched_port *port, uint32_t pos,
+	const int default_layout)
 {
 	struct rte_sched_grinder *grinder = port->grinder + pos;
 	struct rte_sched_subport *subport = grinder->subport;
 	struct rte_sched_pipe *pipe = grinder->pipe;
+	uint32_t *pipe_tc_credits_array =
+		rte_sched_pipe_tc_credits(port, pipe, default_layout);
 	struct rte_mbuf *pkt = grinder->pkt;
 	uint32_t tc_index = grinder->tc_index;
 	uint32_t pkt_len = pkt->pkt_len + port->frame_overhead;
 	uint32_t subport_tb_credits = subport->tb_credits;
 	uint32_t subport_tc_credits = subport->tc_credits[tc_index];
 	uint32_t pipe_tb_credits = pipe->tb_credits;
-	uint32_t pipe_tc_credits = pipe->tc_credits[tc_index];
+	uint32_t pipe_tc_credits = pipe_tc_credits_array[tc_index];
 	int enough_credits;
 
 	/* Check queue credits */
@@ -1677,29 +2085,32 @@ grinder_credits_check(struct rte_sched_port *port, uint32_t pos)
 	subport->tb_credits -= pkt_len;
 	subport->tc_credits[tc_index] -= pkt_len;
 	pipe->tb_credits -= pkt_len;
-	pipe->tc_credits[tc_index] -= pkt_len;
+	pipe_tc_credits_array[tc_index] -= pkt_len;
 
 	return 1;
 }
 
 #else
 
-static inline int
-grinder_credits_check(struct rte_sched_port *port, uint32_t pos)
+static __rte_always_inline int
+grinder_credits_check(struct rte_sched_port *port, uint32_t pos,
+	const int default_layout)
 {
 	struct rte_sched_grinder *grinder = port->grinder + pos;
 	struct rte_sched_subport *subport = grinder->subport;
 	struct rte_sched_pipe *pipe = grinder->pipe;
+	uint32_t *pipe_tc_credits_array =
+		rte_sched_pipe_tc_credits(port, pipe, default_layout);
 	struct rte_mbuf *pkt = grinder->pkt;
 	uint32_t tc_index = grinder->tc_index;
+	uint32_t tc_be = rte_sched_port_n_tc(port, default_layout) - 1;
 	uint32_t pkt_len = pkt->pkt_len + port->frame_overhead;
 	uint32_t subport_tb_credits = subport->tb_credits;
 	uint32_t subport_tc_credits = subport->tc_credits[tc_index];
 	uint32_t pipe_tb_credits = pipe->tb_credits;
-	uint32_t pipe_tc_credits = pipe->tc_credits[tc_index];
-	uint32_t pipe_tc_ov_mask1[] = {UINT32_MAX, UINT32_MAX, UINT32_MAX, pipe->tc_ov_credits};
-	uint32_t pipe_tc_ov_mask2[] = {0, 0, 0, UINT32_MAX};
-	uint32_t pipe_tc_ov_credits = pipe_tc_ov_mask1[tc_index];
+	uint32_t pipe_tc_credits = pipe_tc_credits_array[tc_index];
+	uint32_t pipe_tc_ov_mask = (tc_index == tc_be) ? UINT32_MAX : 0;
+	uint32_t pipe_tc_ov_credits = pipe->tc_ov_credits | ~pipe_tc_ov_mask;
 	int enough_credits;
 
 	/* Check pipe and subport credits */
@@ -1716,8 +2127,8 @@ grinder_credits_check(struct rte_sched_port *port, uint32_t pos)
 	subport->tb_credits -= pkt_len;
 	subport->tc_credits[tc_index] -= pkt_len;
 	pipe->tb_credits -= pkt_len;
-	pipe->tc_credits[tc_index] -= pkt_len;
-	pipe->tc_ov_credits -= pipe_tc_ov_mask2[tc_index] & pkt_len;
+	pipe_tc_credits_array[tc_index] -= pkt_len;
+	pipe->tc_ov_credits -= pipe_tc_ov_mask & pkt_len;
 
 	return 1;
 }
@@ -1725,15 +2136,16 @@ grinder_credits_check(struct rte_sched_port *port, uint32_t pos)
 #endif /* RTE_SCHED_SUBPORT_TC_OV */
 
 
-static inline int
-grinder_schedule(struct rte_sched_port *port, uint32_t pos)
+static __rte_always_inline int
+grinder_schedule(struct rte_sched_port *port, uint32_t pos,
+	const int default_layout)
 {
 	struct rte_sched_grinder *grinder = port->grinder + pos;
 	struct rte_sched_queue *queue = grinder->queue[grinder->qpos];
 	struct rte_mbuf *pkt = grinder->pkt;
 	uint32_t pkt_len = pkt->pkt_len + port->frame_overhead;
 
-	if (!grinder_credits_check(port, pos))
+	if (!grinder_credits_check(port, pos, default_layout))
 		return 0;
 
 	/* Advance port time */
@@ -1815,112 +2227,92 @@ grinder_pipe_exists(struct rte_sched_port *port, uint32_t base_pipe)
 
 #endif /* RTE_SCHED_OPTIMIZATIONS */
 
-static inline void
-grinder_pcache_populate(struct rte_sched_port *port, uint32_t pos, uint32_t bmp_pos, uint64_t bmp_slab)
+static __rte_always_inline void
+grinder_pcache_populate(struct rte_sched_port *port, uint32_t pos,
+	uint32_t bmp_pos, uint64_t bmp_slab, const int default_layout)
 {
 	struct rte_sched_grinder *grinder = port->grinder + pos;
-	uint16_t w[4];
+	uint32_t n_queues_per_pipe =
+		rte_sched_port_n_queues_per_pipe(port, default_layout);
+	uint32_t pipe_qmask = default_layout ? UINT16_MAX : port->pipe_qmask;
+	uint32_t i;
 
 	grinder->pcache_w = 0;
 	grinder->pcache_r = 0;
 
-	w[0] = (uint16_t) bmp_slab;
-	w[1] = (uint16_t) (bmp_slab >> 16);
-	w[2] = (uint16_t) (bmp_slab >> 32);
-	w[3] = (uint16_t) (bmp_slab >> 48);
-
-	grinder->pcache_qmask[grinder->pcache_w] = w[0];
-	grinder->pcache_qindex[grinder->pcache_w] = bmp_pos;
-	grinder->pcache_w += (w[0] != 0);
-
-	grinder->pcache_qmask[grinder->pcache_w] = w[1];
-	grinder->pcache_qindex[grinder->pcache_w] = bmp_pos + 16;
-	grinder->pcache_w += (w[1] != 0);
-
-	grinder->pcache_qmask[grinder->pcache_w] = w[2];
-	grinder->pcache_qindex[grinder->pcache_w] = bmp_pos + 32;
-	grinder->pcache_w += (w[2] != 0);
+	for (i = 0; i < 64; i += n_queues_per_pipe) {
+		uint32_t w = (uint32_t) (bmp_slab >> i) & pipe_qmask;
 
-	grinder->pcache_qmask[grinder->pcache_w] = w[3];
-	grinder->pcache_qindex[grinder->pcache_w] = bmp_pos + 48;
-	grinder->pcache_w += (w[3] != 0);
+		grinder->pcache_qmask[grinder->pcache_w] = w;
+		grinder->pcache_qindex[grinder->pcache_w] = bmp_pos + i;
+		grinder->pcache_w += (w != 0);
+	}
 }
 
-static inline void
-grinder_tccache_populate(struct rte_sched_port *port, uint32_t pos, uint32_t qindex, uint16_t qmask)
+static __rte_always_inline void
+grinder_tccache_populate(struct rte_sched_port *port, uint32_t pos,
+	uint32_t qindex, uint32_t qmask, const int default_layout)
 {
 	struct rte_sched_grinder *grinder = port->grinder + pos;
-	uint8_t b[4];
+	uint32_t n_tc = rte_sched_port_n_tc(port, default_layout);
+	uint32_t i;
 
 	grinder->tccache_w = 0;
 	grinder->tccache_r = 0;
 
-	b[0] = (uint8_t) (qmask & 0xF);
-	b[1] = (uint8_t) ((qmask >> 4) & 0xF);
-	b[2] = (uint8_t) ((qmask >> 8) & 0xF);
-	b[3] = (uint8_t) ((qmask >> 12) & 0xF);
-
-	grinder->tccache_qmask[grinder->tccache_w] = b[0];
-	grinder->tccache_qindex[grinder->tccache_w] = qindex;
-	grinder->tccache_w += (b[0] != 0);
+	for (i = 0; i < n_tc; i++) {
+		uint32_t qpos = rte_sched_port_tc_qpos(port, i, default_layout);
+		uint32_t tc_qmask = default_layout ?
+			(1 << RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS) - 1 :
+			port->tc_qmask[i];
+		uint8_t b = (uint8_t) ((qmask >> qpos) & tc_qmask);
 
-	grinder->tccache_qmask[grinder->tccache_w] = b[1];
-	grinder->tccache_qindex[grinder->tccache_w] = qindex + 4;
-	grinder->tccache_w += (b[1] != 0);
-
-	grinder->tccache_qmask[grinder->tccache_w] = b[2];
-	grinder->tccache_qindex[grinder->tccache_w] = qindex + 8;
-	grinder->tccache_w += (b[2] != 0);
-
-	grinder->tccache_qmask[grinder->tccache_w] = b[3];
-	grinder->tccache_qindex[grinder->tccache_w] = qindex + 12;
-	grinder->tccache_w += (b[3] != 0);
+		grinder->tccache_qmask[grinder->tccache_w] = b;
+		grinder->tccache_qindex[grinder->tccache_w] = qindex + qpos;
+		grinder->tccache_w += (b != 0);
+	}
 }
 
-static inline int
-grinder_next_tc(struct rte_sched_port *port, uint32_t pos)
+static __rte_always_inline int
+grinder_next_tc(struct rte_sched_port *port, uint32_t pos,
+	const int default_layout)
 {
 	struct rte_sched_grinder *grinder = port->grinder + pos;
 	struct rte_mbuf **qbase;
-	uint32_t qindex;
+	uint32_t qindex, tc_index, n_queues, i;
 	uint16_t qsize;
 
 	if (grinder->tccache_r == grinder->tccache_w)
 		return 0;
 
 	qindex = grinder->tccache_qindex[grinder->tccache_r];
-	qbase = rte_sched_port_qbase(port, qindex);
-	qsize = rte_sched_port_qsize(port, qindex);
+	qbase = rte_sched_port_qbase(port, qindex, default_layout);
+	tc_index = rte_sched_port_qindex_tc(port, qindex, default_layout);
+	n_queues = rte_sched_port_tc_n_queues(port, tc_index, default_layout);
+	qsize = port->qsize[tc_index];
 
-	grinder->tc_index = (qindex >> 2) & 0x3;
+	grinder->tc_index = tc_index;
+	grinder->n_queues = n_queues;
 	grinder->qmask = grinder->tccache_qmask[grinder->tccache_r];
 	grinder->qsize = qsize;
 
-	grinder->qindex[0] = qindex;
-	grinder->qindex[1] = qindex + 1;
-	grinder->qindex[2] = qindex + 2;
-	grinder->qindex[3] = qindex + 3;
-
-	grinder->queue[0] = port->queue + qindex;
-	grinder->queue[1] = port->queue + qindex + 1;
-	grinder->queue[2] = port->queue + qindex + 2;
-	grinder->queue[3] = port->queue + qindex + 3;
-
-	grinder->qbase[0] = qbase;
-	grinder->qbase[1] = qbase + qsize;
-	grinder->qbase[2] = qbase + 2 * qsize;
-	grinder->qbase[3] = qbase + 3 * qsize;
+	for (i = 0; i < n_queues; i++) {
+		grinder->qindex[i] = qindex + i;
+		grinder->queue[i] = port->queue + qindex + i;
+		grinder->qbase[i] = qbase + i * qsize;
+	}
 
 	grinder->tccache_r++;
 	return 1;
 }
 
-static inline int
-grinder_next_pipe(struct rte_sched_port *port, uint32_t pos)
+static __rte_always_inline int
+grinder_next_pipe(struct rte_sched_port *port, uint32_t pos,
+	const int default_layout)
 {
 	struct rte_sched_grinder *grinder = port->grinder + pos;
 	uint32_t pipe_qindex;
-	uint16_t pipe_qmask;
+	uint32_t pipe_qmask;
 
 	if (grinder->pcache_r < grinder->pcache_w) {
 		pipe_qmask = grinder->pcache_qmask[grinder->pcache_r];
@@ -1946,7 +2338,8 @@ grinder_next_pipe(struct rte_sched_port *port, uint32_t pos)
 		port->grinder_base_bmp_pos[pos] = bmp_pos;
 
 		/* Install new pipe group into grinder's pipe cache */
-		grinder_pcache_populate(port, pos, bmp_pos, bmp_slab);
+		grinder_pcache_populate(port, pos, bmp_pos, bmp_slab,
+			default_layout);
 
 		pipe_qmask = grinder->pcache_qmask[0];
 		pipe_qindex = grinder->pcache_qindex[0];
@@ -1954,14 +2347,17 @@ grinder_next_pipe(struct rte_sched_port *port, uint32_t pos)
 	}
 
 	/* Install new pipe in the grinder */
-	grinder->pindex = pipe_qindex >> 4;
+	grinder->pindex = rte_sched_port_qindex_pipe(port, pipe_qindex,
+		default_layout);
 	grinder->subport = port->subport + (grinder->pindex / port->n_pipes_per_subport);
-	grinder->pipe = port->pipe + grinder->pindex;
+	grinder->pipe = rte_sched_port_pipe(port, grinder->pindex,
+		default_layout);
 	grinder->pipe_params = NULL; /* to be set after the pipe structure is prefetched */
 	grinder->productive = 0;
 
-	grinder_tccache_populate(port, pos, pipe_qindex, pipe_qmask);
-	grinder_next_tc(port, pos);
+	grinder_tccache_populate(port, pos, pipe_qindex, pipe_qmask,
+		default_layout);
+	grinder_next_tc(port, pos, default_layout);
 
 	/* Check for pipe exhaustion */
 	if (grinder->pindex == port->pipe_loop) {
@@ -1973,106 +2369,115 @@ grinder_next_pipe(struct rte_sched_port *port, uint32_t pos)
 }
 
 
-static inline void
-grinder_wrr_load(struct rte_sched_port *port, uint32_t pos)
+static __rte_always_inline void
+grinder_wrr_load(struct rte_sched_port *port, uint32_t pos,
+	const int default_layout)
 {
 	struct rte_sched_grinder *grinder = port->grinder + pos;
 	struct rte_sched_pipe *pipe = grinder->pipe;
 	struct rte_sched_pipe_profile *pipe_params = grinder->pipe_params;
 	uint32_t tc_index = grinder->tc_index;
+	uint32_t qindex = rte_sched_port_tc_qpos(port, tc_index, default_layout);
+	uint32_t n_queues =
+		rte_sched_port_tc_n_queues(port, tc_index, default_layout);
 	uint32_t qmask = grinder->qmask;
-	uint32_t qindex;
-
-	qindex = tc_index * 4;
-
-	grinder->wrr_tokens[0] = ((uint16_t) pipe->wrr_tokens[qindex]) << RTE_SCHED_WRR_SHIFT;
-	grinder->wrr_tokens[1] = ((uint16_t) pipe->wrr_tokens[qindex + 1]) << RTE_SCHED_WRR_SHIFT;
-	grinder->wrr_tokens[2] = ((uint16_t) pipe->wrr_tokens[qindex + 2]) << RTE_SCHED_WRR_SHIFT;
-	grinder->wrr_tokens[3] = ((uint16_t) pipe->wrr_tokens[qindex + 3]) << RTE_SCHED_WRR_SHIFT;
-
-	grinder->wrr_mask[0] = (qmask & 0x1) * 0xFFFF;
-	grinder->wrr_mask[1] = ((qmask >> 1) & 0x1) * 0xFFFF;
-	grinder->wrr_mask[2] = ((qmask >> 2) & 0x1) * 0xFFFF;
-	grinder->wrr_mask[3] = ((qmask >> 3) & 0x1) * 0xFFFF;
+	uint32_t i;
 
-	grinder->wrr_cost[0] = pipe_params->wrr_cost[qindex];
-	grinder->wrr_cost[1] = pipe_params->wrr_cost[qindex + 1];
-	grinder->wrr_cost[2] = pipe_params->wrr_cost[qindex + 2];
-	grinder->wrr_cost[3] = pipe_params->wrr_cost[qindex + 3];
+	for (i = 0; i < n_queues; i++) {
+		grinder->wrr_tokens[i] =
+			((uint16_t) pipe->wrr_tokens[qindex + i]) << RTE_SCHED_WRR_SHIFT;
+		grinder->wrr_mask[i] = ((qmask >> i) & 0x1) * 0xFFFF;
+		grinder->wrr_cost[i] = pipe_params->wrr_cost[qindex + i];
+	}
 }
 
-static inline void
-grinder_wrr_store(struct rte_sched_port *port, uint32_t pos)
+static __rte_always_inline void
+grinder_wrr_store(struct rte_sched_port *port, uint32_t pos,
+	const int default_layout)
 {
 	struct rte_sched_grinder *grinder = port->grinder + pos;
 	struct rte_sched_pipe *pipe = grinder->pipe;
 	uint32_t tc_index = grinder->tc_index;
-	uint32_t qindex;
-
-	qindex = tc_index * 4;
+	uint32_t qindex = rte_sched_port_tc_qpos(port, tc_index, default_layout);
+	uint32_t n_queues =
+		rte_sched_port_tc_n_queues(port, tc_index, default_layout);
+	uint32_t i;
 
-	pipe->wrr_tokens[qindex] = (grinder->wrr_tokens[0] & grinder->wrr_mask[0])
-		>> RTE_SCHED_WRR_SHIFT;
-	pipe->wrr_tokens[qindex + 1] = (grinder->wrr_tokens[1] & grinder->wrr_mask[1])
-		>> RTE_SCHED_WRR_SHIFT;
-	pipe->wrr_tokens[qindex + 2] = (grinder->wrr_tokens[2] & grinder->wrr_mask[2])
-		>> RTE_SCHED_WRR_SHIFT;
-	pipe->wrr_tokens[qindex + 3] = (grinder->wrr_tokens[3] & grinder->wrr_mask[3])
-		>> RTE_SCHED_WRR_SHIFT;
+	for (i = 0; i < n_queues; i++)
+		pipe->wrr_tokens[qindex + i] =
+			(grinder->wrr_tokens[i] & grinder->wrr_mask[i])
+			>> RTE_SCHED_WRR_SHIFT;
 }
 
-static inline void
-grinder_wrr(struct rte_sched_port *port, uint32_t pos)
+static __rte_always_inline void
+grinder_wrr(struct rte_sched_port *port, uint32_t pos,
+	const int default_layout)
 {
 	struct rte_sched_grinder *grinder = port->grinder + pos;
+	uint32_t n_queues = default_layout ?
+		RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS : grinder->n_queues;
 	uint16_t wrr_tokens_min;
+	uint32_t i;
+
+	/* Single queue traffic class: no WRR */
+	if (n_queues == 1) {
+		grinder->qpos = 0;
+		return;
+	}
 
-	grinder->wrr_tokens[0] |= ~grinder->wrr_mask[0];
-	grinder->wrr_tokens[1] |= ~grinder->wrr_mask[1];
-	grinder->wrr_tokens[2] |= ~grinder->wrr_mask[2];
-	grinder->wrr_tokens[3] |= ~grinder->wrr_mask[3];
+	for (i = 0; i < n_queues; i++)
+		grinder->wrr_tokens[i] |= ~grinder->wrr_mask[i];
 
-	grinder->qpos = rte_min_pos_4_u16(grinder->wrr_tokens);
+	if (n_queues == 4)
+		grinder->qpos = rte_min_pos_4_u16(grinder->wrr_tokens);
+	else
+		grinder->qpos = rte_min_pos_n_u16(grinder->wrr_tokens,
+						  n_queues);
 	wrr_tokens_min = grinder->wrr_tokens[grinder->qpos];
 
-	grinder->wrr_tokens[0] -= wrr_tokens_min;
-	grinder->wrr_tokens[1] -= wrr_tokens_min;
-	grinder->wrr_tokens[2] -= wrr_tokens_min;
-	grinder->wrr_tokens[3] -= wrr_tokens_min;
+	for (i = 0; i < n_queues; i++)
+		grinder->wrr_tokens[i] -= wrr_tokens_min;
 }
 
 
 #define grinder_evict(port, pos)
 
-static inline void
-grinder_prefetch_pipe(struct rte_sched_port *port, uint32_t pos)
+static __rte_always_inline void
+grinder_prefetch_pipe(struct rte_sched_port *port, uint32_t pos,
+	const int default_layout)
 {
 	struct rte_sched_grinder *grinder = port->grinder + pos;
 
 	rte_prefetch0(grinder->pipe);
+	if (!default_layout &&
+	    (1u << port->pipe_size_log2) > RTE_CACHE_LINE_SIZE)
+		rte_prefetch0((uint8_t *) grinder->pipe + RTE_CACHE_LINE_SIZE);
 	rte_prefetch0(grinder->queue[0]);
 }
 
-static inline void
-grinder_prefetch_tc_queue_arrays(struct rte_sched_port *port, uint32_t pos)
+static __rte_always_inline void
+grinder_prefetch_tc_queue_arrays(struct rte_sched_port *port, uint32_t pos,
+	const int default_layout)
 {
 	struct rte_sched_grinder *grinder = port->grinder + pos;
-	uint16_t qsize, qr[4];
+	uint32_t n_queues = default_layout ?
+		RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS : grinder->n_queues;
+	uint16_t qsize, qr[RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS_MAX];
+	uint32_t i;
 
 	qsize = grinder->qsize;
-	qr[0] = grinder->queue[0]->qr & (qsize - 1);
-	qr[1] = grinder->queue[1]->qr & (qsize - 1);
-	qr[2] = grinder->queue[2]->qr & (qsize - 1);
-	qr[3] = grinder->queue[3]->qr & (qsize - 1);
+	for (i = 0; i < n_queues; i++)
+		qr[i] = grinder->queue[i]->qr & (qsize - 1);
 
-	rte_prefetch0(grinder->qbase[0] + qr[0]);
-	rte_prefetch0(grinder->qbase[1] + qr[1]);
+	/* Hide the WRR setup behind the first half of the prefetches */
+	for (i = 0; i < (n_queues + 1) / 2; i++)
+		rte_prefetch0(grinder->qbase[i] + qr[i]);
 
-	grinder_wrr_load(port, pos);
-	grinder_wrr(port, pos);
+	grinder_wrr_load(port, pos, default_layout);
+	grinder_wrr(port, pos, default_layout);
 
-	rte_prefetch0(grinder->qbase[2] + qr[2]);
-	rte_prefetch0(grinder->qbase[3] + qr[3]);
+	for ( ; i < n_queues; i++)
+		rte_prefetch0(grinder->qbase[i] + qr[i]);
 }
 
 static inline void
@@ -2094,16 +2499,17 @@ grinder_prefetch_mbuf(struct rte_sched_port *port, uint32_t pos)
 	}
 }
 
-static inline uint32_t
-grinder_handle(struct rte_sched_port *port, uint32_t pos)
+static __rte_always_inline uint32_t
+grinder_handle_layout(struct rte_sched_port *port, uint32_t pos,
+	const int default_layout)
 {
 	struct rte_sched_grinder *grinder = port->grinder + pos;
 
 	switch (grinder->state) {
 	case e_GRINDER_PREFETCH_PIPE:
 	{
-		if (grinder_next_pipe(port, pos)) {
-			grinder_prefetch_pipe(port, pos);
+		if (grinder_next_pipe(port, pos, default_layout)) {
+			grinder_prefetch_pipe(port, pos, default_layout);
 			port->busy_grinders++;
 
 			grinder->state = e_GRINDER_PREFETCH_TC_QUEUE_ARRAYS;
@@ -2118,8 +2524,8 @@ grinder_handle(struct rte_sched_port *port, uint32_t pos)
 		struct rte_sched_pipe *pipe = grinder->pipe;
 
 		grinder->pipe_params = port->pipe_profiles + pipe->profile;
-		grinder_prefetch_tc_queue_arrays(port, pos);
-		grinder_credits_update(port, pos);
+		grinder_prefetch_tc_queue_arrays(port, pos, default_layout);
+		grinder_credits_update(port, pos, default_layout);
 
 		grinder->state = e_GRINDER_PREFETCH_MBUF;
 		return 0;
@@ -2137,20 +2543,21 @@ grinder_handle(struct rte_sched_port *port, uint32_t pos)
 	{
 		uint32_t result = 0;
 
-		result = grinder_schedule(port, pos);
+		result = grinder_schedule(port, pos, default_layout);
 
 		/* Look for next packet within the same TC */
 		if (result && grinder->qmask) {
-			grinder_wrr(port, pos);
+			grinder_wrr(port, pos, default_layout);
 			grinder_prefetch_mbuf(port, pos);
 
 			return 1;
 		}
-		grinder_wrr_store(port, pos);
+		grinder_wrr_store(port, pos, default_layout);
 
 		/* Look for another active TC within same pipe */
-		if (grinder_next_tc(port, pos)) {
-			grinder_prefetch_tc_queue_arrays(port, pos);
+		if (grinder_next_tc(port, pos, default_layout)) {
+			grinder_prefetch_tc_queue_arrays(port, pos,
+				default_layout);
 
 			grinder->state = e_GRINDER_PREFETCH_MBUF;
 			return result;
@@ -2163,8 +2570,8 @@ grinder_handle(struct rte_sched_port *port, uint32_t pos)
 		grinder_evict(port, pos);
 
 		/* Look for another active pipe */
-		if (grinder_next_pipe(port, pos)) {
-			grinder_prefetch_pipe(port, pos);
+		if (grinder_next_pipe(port, pos, default_layout)) {
+			grinder_prefetch_pipe(port, pos, default_layout);
 
 			grinder->state = e_GRINDER_PREFETCH_TC_QUEUE_ARRAYS;
 			return result;
@@ -2183,6 +2590,15 @@ grinder_handle(struct rte_sched_port *port, uint32_t pos)
 	}
 }
 
+static inline uint32_t
+grinder_handle(struct rte_sched_port *port, uint32_t pos)
+{
+	if (port->default_layout)
+		return grinder_handle_layout(port, pos, 1);
+
+	return grinder_handle_layout(port, pos, 0);
+}
+
 static inline void
 rte_sched_port_time_resync(struct rte_sched_port *port)
 {
@@ -2219,24 +2635,126 @@ rte_sched_port_exceptions(struct rte_sched_port *port, int second_pass)
 	return exceptions;
 }
 
-int
-rte_sched_port_dequeue(struct rte_sched_port *port, struct rte_mbuf **pkts, uint32_t n_pkts)
+/* Current time of the shard group, measured in bytes since its creation.
+ * Computed from whole seconds and remainder, so that the cycle count to
+ * byte conversion does not overflow.
+ */
+static inline uint64_t
+rte_sched_shard_group_time(struct rte_sched_shard_group *group)
 {
-	uint32_t i, count;
+	uint64_t cycles = rte_get_tsc_cycles() - group->time_cpu_cycles;
+	uint64_t seconds = rte_reciprocal_divide_u64(cycles, &group->inv_cpu_hz);
+	uint64_t cycles_rem = cycles - seconds * group->cpu_hz;
 
-	port->pkts_out = pkts;
-	port->n_pkts_out = 0;
+	return seconds * group->rate +
+		rte_reciprocal_divide_u64(cycles_rem * group->rate,
+					  &group->inv_cpu_hz);
+}
 
-	rte_sched_port_time_resync(port);
+/* Take up to n_bytes credits from the output port token bucket. The bucket
+ * is refilled at the output port rate and holds up to tb_size credits.
+ */
+static inline uint64_t
+rte_sched_shard_group_credits_get(struct rte_sched_shard_group *group,
+	uint64_t n_bytes)
+{
+	uint64_t time = rte_sched_shard_group_time(group);
+	uint64_t tb_time, tb_time_start, credits;
+
+	do {
+		tb_time = (uint64_t) rte_atomic64_read(&group->tb_time);
+
+		/* Credits unused while idle are capped by the bucket size */
+		tb_time_start = ((int64_t)(tb_time - time) < 0) ? time : tb_time;
+		if ((int64_t)(tb_time_start - time) >= group->tb_size)
+			return 0;
+
+		credits = time + group->tb_size - tb_time_start;
+		if (credits > n_bytes)
+			credits = n_bytes;
+	} while (rte_atomic64_cmpset((volatile uint64_t *)&group->tb_time.cnt,
+				     tb_time, tb_time_start + credits) == 0);
+
+	return credits;
+}
+
+/* Give back the credits left unused by a dequeue operation, or take the
+ * bytes sent above them by its last packet.
+ */
+static inline void
+rte_sched_shard_group_credits_put(struct rte_sched_shard_group *group,
+	uint64_t credits, uint64_t n_bytes)
+{
+	if (n_bytes != credits)
+		rte_atomic64_add(&group->tb_time, (int64_t)(n_bytes - credits));
+}
+
+static __rte_always_inline uint32_t
+rte_sched_port_grinders_run(struct rte_sched_port *port, uint32_t n_pkts,
+	const int default_layout)
+{
+	uint32_t i, count;
 
 	/* Take each queue in the grinder one step further */
+	for (i = 0, count = 0; ; i++)  {
+		count += grinder_handle_layout(port,
+			i & (RTE_SCHED_PORT_N_GRINDERS - 1), default_layout);
+		if ((count == n_pkts) ||
+		    rte_sched_port_exceptions(port, i >= RTE_SCHED_PORT_N_GRINDERS)) {
+			break;
+		}
+	}
+
+	return count;
+}
+
+static int
+rte_sched_port_shard_dequeue(struct rte_sched_port *port, uint32_t n_pkts)
+{
+	uint64_t credits, time;
+	uint32_t i, count;
+
+	credits = rte_sched_shard_group_credits_get(port->shard_group,
+		(uint64_t) n_pkts * port->mtu);
+	if (credits == 0)
+		return 0;
+
+	/* Take each queue in the grinder one step further, until the credits
+	 * of the output port are exhausted
+	 */
+	time = port->time;
 	for (i = 0, count = 0; ; i++)  {
 		count += grinder_handle(port, i & (RTE_SCHED_PORT_N_GRINDERS - 1));
 		if ((count == n_pkts) ||
+		    (port->time - time >= credits) ||
 		    rte_sched_port_exceptions(port, i >= RTE_SCHED_PORT_N_GRINDERS)) {
 			break;
 		}
 	}
 
+	rte_sched_shard_group_credits_put(port->shard_group, credits,
+		port->time - time);
+
 	return count;
 }
+
+int
+rte_sched_port_dequeue(struct rte_sched_port *port, struct rte_mbuf **pkts, uint32_t n_pkts)
+{
+	port->pkts_out = pkts;
+	port->n_pkts_out = 0;
+
+	rte_sched_port_time_resync(port);
+
+	if (port->shard_group != NULL)
+		return rte_sched_port_shard_dequeue(port, n_pkts);
+
+	/* The grinder code is specialized for the default layout, which is
+	 * the common case and is kept as fast as with the layout fixed at
+	 * build time
+	 */
+	if (port->default_layout)
+		return rte_sched_port_grinders_run(port, n_pkts, 1);
+
+	return rte_sched_port_grinders_run(port, n_pkts, 0);
+}
@@ -43,6 +43,8 @@ extern "C" {
  *     4. Traffic class:
  *           - Traffic classes of the same pipe handled in strict
  *	    priority order;
+ *           - Number of traffic classes and number of queues per
+ *	    traffic class configurable per port;
  *           - Upper limit enforced per traffic class at the pipe level;
  *           - Lower priority traffic classes able to reuse pipe
  *	    bandwidth currently unused by higher priority traffic
@@ -66,15 +68,27 @@ extern "C" {
 #include "rte_red.h"
 #endif
 
-/** Number of traffic classes per pipe (as well as subport).
- * Cannot be changed.
+/** Maximum number of traffic classes per pipe (as well as subport). */
+#define RTE_SCHED_TRAFFIC_CLASSES_MAX         16
+
+/** Maximum number of queues per pipe traffic class. */
+#define RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS_MAX 8
+
+/** Maximum number of queues per pipe. */
+#define RTE_SCHED_QUEUES_PER_PIPE_MAX         32
+
+/** Default number of traffic classes per pipe (as well as subport), used
+ * when the port configuration does not specify the traffic class layout.
  */
 #define RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE    4
 
-/** Number of queues per pipe traffic class. Cannot be changed. */
+/** Default number of queues per pipe traffic class. */
 #define RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS    4
 
-/** Number of queues per pipe. */
+/** Default number of queues per pipe. This is also the minimum number of
+ * queue IDs reserved for each pipe: the pipe queue count is rounded up to
+ * a power of 2 no smaller than this value.
+ */
 #define RTE_SCHED_QUEUES_PER_PIPE             \
 	(RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE *     \
 	RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS)
@@ -115,8 +129,9 @@ struct rte_sched_subport_params {
 	uint32_t tb_size;                /**< Size (measured in credits) */
 
 	/* Subport traffic classes */
-	uint32_t tc_rate[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
-	/**< Traffic class rates (measured in bytes per second) */
+	uint32_t tc_rate[RTE_SCHED_TRAFFIC_CLASSES_MAX];
+	/**< Traffic class rates (measured in bytes per second). Only the
+	 * first n_traffic_classes entries of the port are used. */
 	uint32_t tc_period;
 	/**< Enforcement period for rates (measured in milliseconds) */
 };
@@ -124,19 +139,19 @@ struct rte_sched_subport_params {
 /** Subport statistics */
 struct rte_sched_subport_stats {
 	/* Packets */
-	uint32_t n_pkts_tc[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
+	uint32_t n_pkts_tc[RTE_SCHED_TRAFFIC_CLASSES_MAX];
 	/**< Number of packets successfully written */
-	uint32_t n_pkts_tc_dropped[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
+	uint32_t n_pkts_tc_dropped[RTE_SCHED_TRAFFIC_CLASSES_MAX];
 	/**< Number of packets dropped */
 
 	/* Bytes */
-	uint32_t n_bytes_tc[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
+	uint32_t n_bytes_tc[RTE_SCHED_TRAFFIC_CLASSES_MAX];
 	/**< Number of bytes successfully written for each traffic class */
-	uint32_t n_bytes_tc_dropped[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
+	uint32_t n_bytes_tc_dropped[RTE_SCHED_TRAFFIC_CLASSES_MAX];
 	/**< Number of bytes dropped for each traffic class */
 
 #ifdef RTE_SCHED_RED
-	uint32_t n_pkts_red_dropped[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
+	uint32_t n_pkts_red_dropped[RTE_SCHED_TRAFFIC_CLASSES_MAX];
 	/**< Number of packets dropped by red */
 #endif
 };
@@ -156,16 +171,23 @@ struct rte_sched_pipe_params {
 	uint32_t tb_size;                /**< Size (measured in credits) */
 
 	/* Pipe traffic classes */
-	uint32_t tc_rate[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
-	/**< Traffic class rates (measured in bytes per second) */
+	uint32_t tc_rate[RTE_SCHED_TRAFFIC_CLASSES_MAX];
+	/**< Traffic class rates (measured in bytes per second). Only the
+	 * first n_traffic_classes entries of the port are used. */
 	uint32_t tc_period;
 	/**< Enforcement period (measured in milliseconds) */
 #ifdef RTE_SCHED_SUBPORT_TC_OV
-	uint8_t tc_ov_weight;		 /**< Weight Traffic class 3 oversubscription */
+	uint8_t tc_ov_weight;
+	/**< Weight for the oversubscription of the lowest priority (best
+	 * effort) traffic class */
 #endif
 
 	/* Pipe queues */
-	uint8_t  wrr_weights[RTE_SCHED_QUEUES_PER_PIPE]; /**< WRR weights */
+	uint8_t  wrr_weights[RTE_SCHED_QUEUES_PER_PIPE_MAX];
+	/**< WRR weights, indexed by queue position within the pipe: the
+	 * queues of each traffic class follow the queues of all the higher
+	 * priority traffic classes. The weights of the traffic classes with
+	 * a single queue are ignored. */
 };
 
 /** Queue statistics */
@@ -195,7 +217,18 @@ struct rte_sched_port_params {
 					  * (measured in bytes) */
 	uint32_t n_subports_per_port;    /**< Number of subports */
 	uint32_t n_pipes_per_subport;    /**< Number of pipes per subport */
-	uint16_t qsize[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
+	uint32_t n_traffic_classes;
+	/**< Number of traffic classes per pipe (as well as subport), up to
+	 * RTE_SCHED_TRAFFIC_CLASSES_MAX. Traffic class 0 has the highest
+	 * priority, the last traffic class is the best effort one. When set
+	 * to 0, the default layout of RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE
+	 * traffic classes with RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS queues each
+	 * is used and n_queues_per_tc is ignored. */
+	uint8_t n_queues_per_tc[RTE_SCHED_TRAFFIC_CLASSES_MAX];
+	/**< Number of queues for each traffic class: 1, 2, 4 or 8. The total
+	 * number of queues per pipe cannot exceed
+	 * RTE_SCHED_QUEUES_PER_PIPE_MAX. */
+	uint16_t qsize[RTE_SCHED_TRAFFIC_CLASSES_MAX];
 	/**< Packet queue size for each traffic class.
 	 * All queues within the same pipe traffic class have the same
 	 * size. Queues from different pipes serving the same traffic
@@ -205,10 +238,33 @@ struct rte_sched_port_params {
 	 * Every pipe is configured using one of the profiles from this table. */
 	uint32_t n_pipe_profiles;        /**< Profiles in the pipe profile table */
 #ifdef RTE_SCHED_RED
-	struct rte_red_params red_params[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE][e_RTE_METER_COLORS]; /**< RED parameters */
+	struct rte_red_params red_params[RTE_SCHED_TRAFFIC_CLASSES_MAX][e_RTE_METER_COLORS]; /**< RED parameters */
 #endif
 };
 
+/**
+ * Shard group configuration parameters.
+ *
+ * The subports of an output port can be split into shards run by different
+ * cores: each shard is a port scheduler instance of its own, configured with
+ * the rate of the output port and owning a part of its subports. The shards
+ * of the same output port are attached to a shard group, which enforces the
+ * output port rate across all of them.
+ */
+struct rte_sched_shard_group_params {
+	const char *name;                /**< String to be associated */
+	int socket;                      /**< CPU socket ID */
+	uint32_t rate;                   /**< Output port rate
+					  * (measured in bytes per second) */
+	uint32_t tb_size;                /**< Output port token bucket size,
+					  * i.e. the burst the shards can send
+					  * above the port rate
+					  * (measured in bytes) */
+};
+
+/** Shard group, shared by the port scheduler instances of an output port. */
+struct rte_sched_shard_group;
+
 /*
  * Configuration
  *
@@ -302,6 +358,56 @@ rte_sched_pipe_config(struct rte_sched_port *port,
 uint32_t
 rte_sched_port_get_memory_footprint(struct rte_sched_port_params *params);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Hierarchical scheduler shard group create
+ *
+ * @param params
+ *   Shard group configuration parameter structure
+ * @return
+ *   Handle to shard group instance upon success or NULL otherwise.
+ */
+struct rte_sched_shard_group * __rte_experimental
+rte_sched_shard_group_create(struct rte_sched_shard_group_params *params);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Hierarchical scheduler shard group free. All the port scheduler instances
+ * attached to the group must be freed first.
+ *
+ * @param group
+ *   Handle to shard group instance
+ */
+void __rte_experimental
+rte_sched_shard_group_free(struct rte_sched_shard_group *group);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Hierarchical scheduler port attach to a shard group. The port has to be
+ * configured with the rate of the group and attached before its first
+ * dequeue operation. The token bucket of the group has to hold at least the
+ * MTU plus the frame overhead of the port, the most a dequeue operation can
+ * send above its credits. Afterwards, each dequeue operation draws the bytes it
+ * sends from the token bucket of the group, which is safe to do
+ * concurrently from the cores running the different ports of the group.
+ *
+ * @param port
+ *   Handle to port scheduler instance
+ * @param group
+ *   Handle to shard group instance
+ * @return
+ *   0 upon success, error code otherwise
+ */
+int __rte_experimental
+rte_sched_port_shard_attach(struct rte_sched_port *port,
+	struct rte_sched_shard_group *group);
+
 /*
  * Statistics
  *
@@ -318,8 +424,8 @@ rte_sched_port_get_memory_footprint(struct rte_sched_port_params *params);
  *   Pointer to pre-allocated subport statistics structure where the statistics
  *   counters should be stored
  * @param tc_ov
- *   Pointer to pre-allocated 4-entry array where the oversubscription status for
- *   each of the 4 subport traffic classes should be stored.
+ *   Pointer to pre-allocated variable where the oversubscription status of
+ *   the subport best effort traffic class should be stored.
  * @return
  *   0 upon success, error code otherwise
  */
@@ -335,7 +441,7 @@ rte_sched_subport_read_stats(struct rte_sched_port *port,
  * @param port
  *   Handle to port scheduler instance
  * @param queue_id
- *   Queue ID within port scheduler
+ *   Queue ID within port scheduler, see rte_sched_port_queue_id()
  * @param stats
  *   Pointer to pre-allocated subport statistics structure where the statistics
  *   counters should be stored
@@ -351,6 +457,36 @@ rte_sched_queue_read_stats(struct rte_sched_port *port,
 	struct rte_sched_queue_stats *stats,
 	uint16_t *qlen);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Hierarchical scheduler queue ID of a given queue, as used by
+ * rte_sched_queue_read_stats(). The queue IDs of a pipe are contiguous,
+ * but their number depends on the traffic class layout of the port.
+ *
+ * @param port
+ *   Handle to port scheduler instance
+ * @param subport
+ *   Subport ID
+ * @param pipe
+ *   Pipe ID within subport
+ * @param traffic_class
+ *   Traffic class ID within pipe
+ * @param queue
+ *   Queue ID within pipe traffic class, less than the number of queues of
+ *   the traffic class
+ * @return
+ *   Queue ID within port scheduler, UINT32_MAX when any of the parameters
+ *   is out of range
+ */
+uint32_t __rte_experimental
+rte_sched_port_queue_id(struct rte_sched_port *port,
+	uint32_t subport,
+	uint32_t pipe,
+	uint32_t traffic_class,
+	uint32_t queue);
+
 /**
  * Scheduler hierarchy path write to packet descriptor. Typically
  * called by the packet classification stage.
@@ -362,9 +498,13 @@ rte_sched_queue_read_stats(struct rte_sched_port *port,
  * @param pipe
  *   Pipe ID within subport
  * @param traffic_class
- *   Traffic class ID within pipe (0 .. 3)
+ *   Traffic class ID within pipe, less than the number of traffic classes of
+ *   the port (0 .. 15). Higher values are scheduled in the best effort
+ *   traffic class.
  * @param queue
- *   Queue ID within pipe traffic class (0 .. 3)
+ *   Queue ID within pipe traffic class, less than the number of queues of
+ *   the traffic class, i.e. n_queues_per_tc[traffic_class] (0 .. 7). Higher
+ *   values are wrapped around within the traffic class.
  * @param color
  *   Packet color set
  */
@@ -386,9 +526,9 @@ rte_sched_port_pkt_write(struct rte_mbuf *pkt,
  * @param pipe
  *   Pipe ID within subport
  * @param traffic_class
- *   Traffic class ID within pipe (0 .. 3)
+ *   Traffic class ID within pipe (0 .. 15)
  * @param queue
- *   Queue ID within pipe traffic class (0 .. 3)
+ *   Queue ID within pipe traffic class (0 .. 7)
  *
  */
 void
@@ -424,7 +564,9 @@ rte_sched_port_enqueue(struct rte_sched_port *port, struct rte_mbuf **pkts, uint
  * Hierarchical scheduler port dequeue. Reads up to n_pkts from the
  * port scheduler and stores them in the pkts array and returns the
  * number of packets actually read.  The pkts array needs to be
- * pre-allocated by the caller with at least n_pkts entries.
+ * pre-allocated by the caller with at least n_pkts entries. When the
+ * port is attached to a shard group, fewer packets are read once the
+ * output port rate is reached.
  *
  * @param port
  *   Handle to port scheduler instance
@@ -6,6 +6,7 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <inttypes.h>
+#include <limits.h>
 #include <assert.h>
 #include <sys/queue.h>
 
@@ -21,11 +22,49 @@
 #include <rte_spinlock.h>
 #include <rte_random.h>
 #include <rte_pause.h>
+#include <rte_malloc.h>
+#include <rte_errno.h>
 
 #include "rte_timer.h"
 
 LIST_HEAD(rte_timer_list, rte_timer);
 
+/*
+ * Timing wheel backend: WHEEL_LEVELS levels of WHEEL_SLOTS slots, level n
+ * covering expiries WHEEL_SLOTS^n to WHEEL_SLOTS^(n+1) granules ahead of
+ * the current granule. The timers further ahead wait in an overflow list.
+ * A timer is linked in its slot through sl_next[0], sl_next[1] holds the
+ * address of the pointer to it, and sl_next[2] the index of its slot, so
+ * that it is added and removed in constant time.
+ */
+#define WHEEL_SLOT_BITS 8
+#define WHEEL_SLOTS (1 << WHEEL_SLOT_BITS)
+#define WHEEL_SLOT_MASK (WHEEL_SLOTS - 1)
+#define WHEEL_LEVELS 4
+#define WHEEL_IDX_OVERFLOW (WHEEL_LEVELS * WHEEL_SLOTS)
+#define WHEEL_IDX_NONE (WHEEL_IDX_OVERFLOW + 1)
+
+/* granule of the wheels, i.e. the resolution of their timers, in Hz */
+#define WHEEL_GRANULE_HZ 1000000
+
+#define WHEEL_NEXT(t) ((t)->sl_next[0])
+#define WHEEL_PPREV(t) ((struct rte_timer **)(uintptr_t)(t)->sl_next[1])
+#define WHEEL_SET_PPREV(t, p) \
+	((t)->sl_next[1] = (struct rte_timer *)(uintptr_t)(p))
+#define WHEEL_IDX(t) ((uintptr_t)(t)->sl_next[2])
+#define WHEEL_SET_IDX(t, i) \
+	((t)->sl_next[2] = (struct rte_timer *)(uintptr_t)(i))
+
+struct timer_wheel {
+	uint64_t cur;             /**< next granule to process */
+	unsigned int shift;       /**< log2 of the granule in timer cycles */
+	uint32_t count;           /**< number of timers in the wheel */
+	struct rte_timer *overflow; /**< timers beyond the last level */
+	/** non-empty slots of the first level */
+	uint64_t bitmap[WHEEL_SLOTS / 64];
+	struct rte_timer *slot[WHEEL_LEVELS][WHEEL_SLOTS];
+} __rte_cache_aligned;
+
 struct priv_timer {
 	struct rte_timer pending_head;  /**< dummy timer instance to head up list */
 	rte_spinlock_t list_lock;       /**< lock to protect list access */
@@ -42,39 +81,194 @@ struct priv_timer {
 	/** running timer on this lcore now */
 	struct rte_timer *running_tim;
 
+	/** timing wheel of this lcore, NULL for the skiplist backend */
+	struct timer_wheel *wheel;
+
 #ifdef RTE_LIBRTE_TIMER_DEBUG
 	/** per-lcore statistics */
 	struct rte_timer_debug_stats stats;
 #endif
 } __rte_cache_aligned;
 
-/** per-lcore private info for timers */
-static struct priv_timer priv_timer[RTE_MAX_LCORE];
+#define FL_ALLOCATED (1 << 0)
+
+/** a set of per-lcore timer lists, with their backend */
+struct rte_timer_data {
+	struct priv_timer priv_timer[RTE_MAX_LCORE];
+	enum rte_timer_backend backend;
+	uint8_t internal_flags;
+};
+
+/* the first instance is the default one, used by the legacy API */
+#define DEFAULT_DATA_ID 0
+
+/** timer data instances; since they are static, they are zeroed by default */
+static struct rte_timer_data rte_timer_data_arr[RTE_TIMER_DATA_MAX];
+static rte_spinlock_t rte_timer_data_lock = RTE_SPINLOCK_INITIALIZER;
+
+#define TIMER_DATA_VALID_GET_OR_ERR_RET(id, timer_data, retval) do {	\
+	if ((id) >= RTE_TIMER_DATA_MAX ||				\
+	    ((id) != DEFAULT_DATA_ID &&					\
+	     !(rte_timer_data_arr[id].internal_flags & FL_ALLOCATED)))	\
+		return retval;						\
+	timer_data = &rte_timer_data_arr[id];				\
+} while (0)
 
 /* when debug is enabled, store some statistics */
 #ifdef RTE_LIBRTE_TIMER_DEBUG
-#define __TIMER_STAT_ADD(name, n) do {					\
+#define __TIMER_STAT_ADD(priv_timer, name, n) do {			\
 		unsigned __lcore_id = rte_lcore_id();			\
 		if (__lcore_id < RTE_MAX_LCORE)				\
 			priv_timer[__lcore_id].stats.name += (n);	\
 	} while(0)
 #else
-#define __TIMER_STAT_ADD(name, n) do {} while(0)
+#define __TIMER_STAT_ADD(priv_timer, name, n) do {} while(0)
 #endif
 
-/* Init the timer library. */
-void
-rte_timer_subsystem_init(void)
+static void
+timer_wheel_free(struct rte_timer_data *timer_data)
+{
+	unsigned int lcore_id;
+
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		rte_free(timer_data->priv_timer[lcore_id].wheel);
+		timer_data->priv_timer[lcore_id].wheel = NULL;
+	}
+}
+
+/*
+ * Allocate the wheels of the lcores which may run timers. The timers of
+ * the other lcores, if they are given a role later, stay in a skiplist.
+ */
+static int
+timer_wheel_alloc(struct rte_timer_data *timer_data)
+{
+	struct timer_wheel *wheel;
+	uint64_t cycles, now;
+	unsigned int lcore_id, shift = 0;
+
+	/* the largest power of 2 of cycles not above one granule */
+	cycles = rte_get_timer_hz() / WHEEL_GRANULE_HZ;
+	while ((2ULL << shift) <= cycles)
+		shift++;
+
+	now = rte_get_timer_cycles();
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		if (rte_eal_lcore_role(lcore_id) == ROLE_OFF)
+			continue;
+
+		wheel = rte_zmalloc_socket("timer_wheel", sizeof(*wheel),
+				RTE_CACHE_LINE_SIZE,
+				rte_lcore_to_socket_id(lcore_id));
+		if (wheel == NULL) {
+			timer_wheel_free(timer_data);
+			return -ENOMEM;
+		}
+		wheel->shift = shift;
+		wheel->cur = now >> shift;
+		timer_data->priv_timer[lcore_id].wheel = wheel;
+	}
+
+	return 0;
+}
+
+static int
+timer_data_init(struct rte_timer_data *timer_data,
+		enum rte_timer_backend backend)
 {
 	unsigned lcore_id;
 
-	/* since priv_timer is static, it's zeroed by default, so only init some
+	if (backend != RTE_TIMER_BACKEND_SKIPLIST &&
+	    backend != RTE_TIMER_BACKEND_WHEEL)
+		return -EINVAL;
+
+	/* the lists are static or zeroed on allocation, so only init some
 	 * fields.
 	 */
 	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id ++) {
-		rte_spinlock_init(&priv_timer[lcore_id].list_lock);
-		priv_timer[lcore_id].prev_lcore = lcore_id;
+		rte_spinlock_init(&timer_data->priv_timer[lcore_id].list_lock);
+		timer_data->priv_timer[lcore_id].prev_lcore = lcore_id;
 	}
+
+	if (backend == timer_data->backend)
+		return 0;
+
+	if (backend == RTE_TIMER_BACKEND_WHEEL) {
+		if (timer_wheel_alloc(timer_data) < 0)
+			return -ENOMEM;
+	} else
+		timer_wheel_free(timer_data);
+	timer_data->backend = backend;
+
+	return 0;
+}
+
+/* Init the timer library. */
+void
+rte_timer_subsystem_init(void)
+{
+	struct rte_timer_data *timer_data = &rte_timer_data_arr[DEFAULT_DATA_ID];
+
+	/* keep the backend selected by rte_timer_subsystem_init_backend() */
+	timer_data_init(timer_data, timer_data->backend);
+}
+
+/* Init the timer library, with the given backend for the default timers */
+int __rte_experimental
+rte_timer_subsystem_init_backend(enum rte_timer_backend backend)
+{
+	return timer_data_init(&rte_timer_data_arr[DEFAULT_DATA_ID], backend);
+}
+
+/* Allocate a timer data instance */
+int __rte_experimental
+rte_timer_data_alloc(uint32_t *id_ptr, enum rte_timer_backend backend)
+{
+	struct rte_timer_data *timer_data;
+	uint32_t id;
+	int ret;
+
+	if (id_ptr == NULL)
+		return -EINVAL;
+
+	rte_spinlock_lock(&rte_timer_data_lock);
+	for (id = DEFAULT_DATA_ID + 1; id < RTE_TIMER_DATA_MAX; id++) {
+		timer_data = &rte_timer_data_arr[id];
+		if (!(timer_data->internal_flags & FL_ALLOCATED))
+			break;
+	}
+	if (id == RTE_TIMER_DATA_MAX) {
+		rte_spinlock_unlock(&rte_timer_data_lock);
+		return -ENOSPC;
+	}
+
+	memset(timer_data, 0, sizeof(*timer_data));
+	ret = timer_data_init(timer_data, backend);
+	if (ret == 0) {
+		timer_data->internal_flags |= FL_ALLOCATED;
+		*id_ptr = id;
+	}
+	rte_spinlock_unlock(&rte_timer_data_lock);
+
+	return ret;
+}
+
+/* Free a timer data instance */
+int __rte_experimental
+rte_timer_data_dealloc(uint32_t id)
+{
+	struct rte_timer_data *timer_data;
+
+	if (id == DEFAULT_DATA_ID)
+		return -EINVAL;
+	TIMER_DATA_VALID_GET_OR_ERR_RET(id, timer_data, -EINVAL);
+
+	rte_spinlock_lock(&rte_timer_data_lock);
+	timer_wheel_free(timer_data);
+	timer_data->internal_flags &= ~(FL_ALLOCATED);
+	rte_spinlock_unlock(&rte_timer_data_lock);
+
+	return 0;
 }
 
 /* Initialize the timer handle tim for use */
@@ -88,6 +282,7 @@ rte_timer_init(struct rte_timer *tim)
 	tim->status.u32 = status.u32;
 }
 
+
 /*
  * if timer is pending or stopped (or running on the same core than
  * us), mark timer as configuring, and on success return the previous
@@ -95,7 +290,8 @@ rte_timer_init(struct rte_timer *tim)
  */
 static int
 timer_set_config_state(struct rte_timer *tim,
-		       union rte_timer_status *ret_prev_status)
+		       union rte_timer_status *ret_prev_status,
+		       struct priv_timer *priv_timer)
 {
 	union rte_timer_status prev_status, status;
 	int success = 0;
@@ -207,7 +403,7 @@ timer_get_skiplist_level(unsigned curr_depth)
  */
 static void
 timer_get_prev_entries(uint64_t time_val, unsigned tim_lcore,
-		struct rte_timer **prev)
+		struct rte_timer **prev, struct priv_timer *priv_timer)
 {
 	unsigned lvl = priv_timer[tim_lcore].curr_skiplist_depth;
 	prev[lvl] = &priv_timer[tim_lcore].pending_head;
@@ -226,13 +422,13 @@ timer_get_prev_entries(uint64_t time_val, unsigned tim_lcore,
  */
 static void
 timer_get_prev_entries_for_node(struct rte_timer *tim, unsigned tim_lcore,
-		struct rte_timer **prev)
+		struct rte_timer **prev, struct priv_timer *priv_timer)
 {
 	int i;
 	/* to get a specific entry in the list, look for just lower than the time
 	 * values, and then increment on each level individually if necessary
 	 */
-	timer_get_prev_entries(tim->expire - 1, tim_lcore, prev);
+	timer_get_prev_entries(tim->expire - 1, tim_lcore, prev, priv_timer);
 	for (i = priv_timer[tim_lcore].curr_skiplist_depth - 1; i >= 0; i--) {
 		while (prev[i]->sl_next[i] != NULL &&
 				prev[i]->sl_next[i] != tim &&
@@ -241,27 +437,17 @@ timer_get_prev_entries_for_node(struct rte_timer *tim, unsigned tim_lcore,
 	}
 }
 
-/*
- * add in list, lock if needed
- * timer must be in config state
- * timer must not be in a list
- */
+/* add in the skiplist of tim_lcore, which must be locked */
 static void
-timer_add(struct rte_timer *tim, unsigned tim_lcore, int local_is_locked)
+timer_skiplist_add(struct rte_timer *tim, unsigned tim_lcore,
+		struct priv_timer *priv_timer)
 {
-	unsigned lcore_id = rte_lcore_id();
 	unsigned lvl;
 	struct rte_timer *prev[MAX_SKIPLIST_DEPTH+1];
 
-	/* if timer needs to be scheduled on another core, we need to
-	 * lock the list; if it is on local core, we need to lock if
-	 * we are not called from rte_timer_manage() */
-	if (tim_lcore != lcore_id || !local_is_locked)
-		rte_spinlock_lock(&priv_timer[tim_lcore].list_lock);
-
 	/* find where exactly this element goes in the list of elements
 	 * for each depth. */
-	timer_get_prev_entries(tim->expire, tim_lcore, prev);
+	timer_get_prev_entries(tim->expire, tim_lcore, prev, priv_timer);
 
 	/* now assign it a new level and add at that level */
 	const unsigned tim_level = timer_get_skiplist_level(
@@ -282,31 +468,16 @@ timer_add(struct rte_timer *tim, unsigned tim_lcore, int local_is_locked)
 	 * NOTE: this is not atomic on 32-bit*/
 	priv_timer[tim_lcore].pending_head.expire = priv_timer[tim_lcore].\
 			pending_head.sl_next[0]->expire;
-
-	if (tim_lcore != lcore_id || !local_is_locked)
-		rte_spinlock_unlock(&priv_timer[tim_lcore].list_lock);
 }
 
-/*
- * del from list, lock if needed
- * timer must be in config state
- * timer must be in a list
- */
+/* del from the skiplist of prev_owner, which must be locked */
 static void
-timer_del(struct rte_timer *tim, union rte_timer_status prev_status,
-		int local_is_locked)
+timer_skiplist_del(struct rte_timer *tim, unsigned prev_owner,
+		struct priv_timer *priv_timer)
 {
-	unsigned lcore_id = rte_lcore_id();
-	unsigned prev_owner = prev_status.owner;
 	int i;
 	struct rte_timer *prev[MAX_SKIPLIST_DEPTH+1];
 
-	/* if timer needs is pending another core, we need to lock the
-	 * list; if it is on local core, we need to lock if we are not
-	 * called from rte_timer_manage() */
-	if (prev_owner != lcore_id || !local_is_locked)
-		rte_spinlock_lock(&priv_timer[prev_owner].list_lock);
-
 	/* save the lowest list entry into the expire field of the dummy hdr.
 	 * NOTE: this is not atomic on 32-bit */
 	if (tim == priv_timer[prev_owner].pending_head.sl_next[0])
@@ -314,7 +485,7 @@ timer_del(struct rte_timer *tim, union rte_timer_status prev_status,
 				((tim->sl_next[0] == NULL) ? 0 : tim->sl_next[0]->expire);
 
 	/* adjust pointers from previous entries to point past this */
-	timer_get_prev_entries_for_node(tim, prev_owner, prev);
+	timer_get_prev_entries_for_node(tim, prev_owner, prev, priv_timer);
 	for (i = priv_timer[prev_owner].curr_skiplist_depth - 1; i >= 0; i--) {
 		if (prev[i]->sl_next[i] == tim)
 			prev[i]->sl_next[i] = tim->sl_next[i];
@@ -326,6 +497,184 @@ timer_del(struct rte_timer *tim, union rte_timer_status prev_status,
 			priv_timer[prev_owner].curr_skiplist_depth --;
 		else
 			break;
+}
+
+/* link tim at the head of a wheel slot list */
+static inline void
+timer_wheel_link(struct rte_timer **head, struct rte_timer *tim,
+		unsigned int idx)
+{
+	WHEEL_NEXT(tim) = *head;
+	if (*head != NULL)
+		WHEEL_SET_PPREV(*head, &WHEEL_NEXT(tim));
+	WHEEL_SET_PPREV(tim, head);
+	WHEEL_SET_IDX(tim, idx);
+	*head = tim;
+}
+
+/* insert in the slot matching the expiry of the timer */
+static void
+timer_wheel_insert(struct timer_wheel *wheel, struct rte_timer *tim)
+{
+	uint64_t expire, delta;
+	unsigned int lvl, idx;
+
+	/* round up, so that the timer never expires early */
+	expire = (tim->expire + (1ULL << wheel->shift) - 1) >> wheel->shift;
+	if (expire < wheel->cur)
+		expire = wheel->cur;
+	delta = expire - wheel->cur;
+
+	for (lvl = 0; lvl < WHEEL_LEVELS; lvl++)
+		if (delta < 1ULL << (WHEEL_SLOT_BITS * (lvl + 1)))
+			break;
+
+	if (lvl == WHEEL_LEVELS) {
+		timer_wheel_link(&wheel->overflow, tim, WHEEL_IDX_OVERFLOW);
+		return;
+	}
+
+	idx = (expire >> (WHEEL_SLOT_BITS * lvl)) & WHEEL_SLOT_MASK;
+	if (lvl == 0)
+		wheel->bitmap[idx / 64] |= 1ULL << (idx % 64);
+	timer_wheel_link(&wheel->slot[lvl][idx], tim, lvl * WHEEL_SLOTS + idx);
+}
+
+/* add in the wheel of an lcore, which must be locked */
+static void
+timer_wheel_add(struct timer_wheel *wheel, struct rte_timer *tim)
+{
+	/* the current granule of an empty wheel is not kept up to date
+	 * by rte_timer_manage(), catch up with the time */
+	if (wheel->count == 0)
+		wheel->cur = rte_get_timer_cycles() >> wheel->shift;
+
+	timer_wheel_insert(wheel, tim);
+	wheel->count++;
+}
+
+/* del from the wheel of an lcore, which must be locked */
+static void
+timer_wheel_del(struct timer_wheel *wheel, struct rte_timer *tim)
+{
+	unsigned int idx = WHEEL_IDX(tim);
+	struct rte_timer *next = WHEEL_NEXT(tim);
+
+	/* already unlinked by rte_timer_manage() */
+	if (idx == WHEEL_IDX_NONE)
+		return;
+
+	*WHEEL_PPREV(tim) = next;
+	if (next != NULL)
+		WHEEL_SET_PPREV(next, WHEEL_PPREV(tim));
+	if (idx < WHEEL_SLOTS && wheel->slot[0][idx] == NULL)
+		wheel->bitmap[idx / 64] &= ~(1ULL << (idx % 64));
+
+	WHEEL_SET_IDX(tim, WHEEL_IDX_NONE);
+	wheel->count--;
+}
+
+/* move all the timers of a slot list to the slots they now belong to */
+static void
+timer_wheel_reinsert(struct timer_wheel *wheel, struct rte_timer **head)
+{
+	struct rte_timer *tim, *next_tim;
+
+	tim = *head;
+	*head = NULL;
+	for (; tim != NULL; tim = next_tim) {
+		next_tim = WHEEL_NEXT(tim);
+		timer_wheel_insert(wheel, tim);
+	}
+}
+
+/*
+ * The current granule wrapped the first level: bring down the timers
+ * of the next slot of the upper levels, and of the overflow list when
+ * all the levels wrapped.
+ */
+static void
+timer_wheel_cascade(struct timer_wheel *wheel)
+{
+	unsigned int lvl, idx;
+
+	for (lvl = 1; lvl < WHEEL_LEVELS; lvl++) {
+		idx = (wheel->cur >> (WHEEL_SLOT_BITS * lvl)) & WHEEL_SLOT_MASK;
+		timer_wheel_reinsert(wheel, &wheel->slot[lvl][idx]);
+		if (idx != 0)
+			return;
+	}
+	timer_wheel_reinsert(wheel, &wheel->overflow);
+}
+
+/* index of the first non-empty slot of the first level from idx */
+static inline unsigned int
+timer_wheel_next_slot(const struct timer_wheel *wheel, unsigned int idx)
+{
+	unsigned int i = idx / 64;
+	uint64_t word;
+
+	if (idx >= WHEEL_SLOTS)
+		return WHEEL_SLOTS;
+
+	word = wheel->bitmap[i] & (UINT64_MAX << (idx % 64));
+	while (word == 0) {
+		if (++i == RTE_DIM(wheel->bitmap))
+			return WHEEL_SLOTS;
+		word = wheel->bitmap[i];
+	}
+
+	return i * 64 + __builtin_ctzll(word);
+}
+
+/*
+ * add in list, lock if needed
+ * timer must be in config state
+ * timer must not be in a list
+ */
+static void
+timer_add(struct rte_timer *tim, unsigned int tim_lcore,
+	  int local_is_locked, struct priv_timer *priv_timer)
+{
+	unsigned lcore_id = rte_lcore_id();
+
+	/* if timer needs to be scheduled on another core, we need to
+	 * lock the list; if it is on local core, we need to lock if
+	 * we are not called from rte_timer_manage() */
+	if (tim_lcore != lcore_id || !local_is_locked)
+		rte_spinlock_lock(&priv_timer[tim_lcore].list_lock);
+
+	if (priv_timer[tim_lcore].wheel != NULL)
+		timer_wheel_add(priv_timer[tim_lcore].wheel, tim);
+	else
+		timer_skiplist_add(tim, tim_lcore, priv_timer);
+
+	if (tim_lcore != lcore_id || !local_is_locked)
+		rte_spinlock_unlock(&priv_timer[tim_lcore].list_lock);
+}
+
+/*
+ * del from list, lock if needed
+ * timer must be in config state
+ * timer must be in a list
+ */
+static void
+timer_del(struct rte_timer *tim, union rte_timer_status prev_status,
+	  int local_is_locked, struct priv_timer *priv_timer)
+{
+	unsigned lcore_id = rte_lcore_id();
+	unsigned prev_owner = prev_status.owner;
+
+	/* if timer needs is pending another core, we need to lock the
+	 * list; if it is on local core, we need to lock if we are not
+	 * called from rte_timer_manage() */
+	if (prev_owner != lcore_id || !local_is_locked)
+		rte_spinlock_lock(&priv_timer[prev_owner].list_lock);
+
+	if (priv_timer[prev_owner].wheel != NULL)
+		timer_wheel_del(priv_timer[prev_owner].wheel, tim);
+	else
+		timer_skiplist_del(tim, prev_owner, priv_timer);
 
 	if (prev_owner != lcore_id || !local_is_locked)
 		rte_spinlock_unlock(&priv_timer[prev_owner].list_lock);
@@ -336,11 +685,13 @@ static int
 __rte_timer_reset(struct rte_timer *tim, uint64_t expire,
 		  uint64_t period, unsigned tim_lcore,
 		  rte_timer_cb_t fct, void *arg,
-		  int local_is_locked)
+		  int local_is_locked,
+		  struct rte_timer_data *timer_data)
 {
 	union rte_timer_status prev_status, status;
 	int ret;
 	unsigned lcore_id = rte_lcore_id();
+	struct priv_timer *priv_timer = timer_data->priv_timer;
 
 	/* round robin for tim_lcore */
 	if (tim_lcore == (unsigned)LCORE_ID_ANY) {
@@ -358,11 +709,11 @@ __rte_timer_reset(struct rte_timer *tim, uint64_t expire,
 
 	/* wait that the timer is in correct status before update,
 	 * and mark it as being configured */
-	ret = timer_set_config_state(tim, &prev_status);
+	ret = timer_set_config_state(tim, &prev_status, priv_timer);
 	if (ret < 0)
 		return -1;
 
-	__TIMER_STAT_ADD(reset, 1);
+	__TIMER_STAT_ADD(priv_timer, reset, 1);
 	if (prev_status.state == RTE_TIMER_RUNNING &&
 	    lcore_id < RTE_MAX_LCORE) {
 		priv_timer[lcore_id].updated = 1;
@@ -370,8 +721,8 @@ __rte_timer_reset(struct rte_timer *tim, uint64_t expire,
 
 	/* remove it from list */
 	if (prev_status.state == RTE_TIMER_PENDING) {
-		timer_del(tim, prev_status, local_is_locked);
-		__TIMER_STAT_ADD(pending, -1);
+		timer_del(tim, prev_status, local_is_locked, priv_timer);
+		__TIMER_STAT_ADD(priv_timer, pending, -1);
 	}
 
 	tim->period = period;
@@ -379,8 +730,8 @@ __rte_timer_reset(struct rte_timer *tim, uint64_t expire,
 	tim->f = fct;
 	tim->arg = arg;
 
-	__TIMER_STAT_ADD(pending, 1);
-	timer_add(tim, tim_lcore, local_is_locked);
+	__TIMER_STAT_ADD(priv_timer, pending, 1);
+	timer_add(tim, tim_lcore, local_is_locked, priv_timer);
 
 	/* update state: as we are in CONFIG state, only us can modify
 	 * the state so we don't need to use cmpset() here */
@@ -392,11 +743,11 @@ __rte_timer_reset(struct rte_timer *tim, uint64_t expire,
 	return 0;
 }
 
-/* Reset and start the timer associated with the timer handle tim */
-int
-rte_timer_reset(struct rte_timer *tim, uint64_t ticks,
-		enum rte_timer_type type, unsigned tim_lcore,
-		rte_timer_cb_t fct, void *arg)
+static int
+timer_reset(struct rte_timer *tim, uint64_t ticks,
+	    enum rte_timer_type type, unsigned int tim_lcore,
+	    rte_timer_cb_t fct, void *arg,
+	    struct rte_timer_data *timer_data)
 {
 	uint64_t cur_time = rte_get_timer_cycles();
 	uint64_t period;
@@ -412,7 +763,30 @@ rte_timer_reset(struct rte_timer *tim, uint64_t ticks,
 		period = 0;
 
 	return __rte_timer_reset(tim,  cur_time + ticks, period, tim_lcore,
-			  fct, arg, 0);
+			  fct, arg, 0, timer_data);
+}
+
+/* Reset and start the timer associated with the timer handle tim */
+int
+rte_timer_reset(struct rte_timer *tim, uint64_t ticks,
+		enum rte_timer_type type, unsigned tim_lcore,
+		rte_timer_cb_t fct, void *arg)
+{
+	return timer_reset(tim, ticks, type, tim_lcore, fct, arg,
+			   &rte_timer_data_arr[DEFAULT_DATA_ID]);
+}
+
+/* Reset and start a timer of the timer data instance timer_data_id */
+int __rte_experimental
+rte_timer_alt_reset(uint32_t timer_data_id, struct rte_timer *tim,
+		    uint64_t ticks, enum rte_timer_type type,
+		    unsigned int tim_lcore, rte_timer_cb_t fct, void *arg)
+{
+	struct rte_timer_data *timer_data;
+
+	TIMER_DATA_VALID_GET_OR_ERR_RET(timer_data_id, timer_data, -EINVAL);
+
+	return timer_reset(tim, ticks, type, tim_lcore, fct, arg, timer_data);
 }
 
 /* loop until rte_timer_reset() succeed */
@@ -426,21 +800,21 @@ rte_timer_reset_sync(struct rte_timer *tim, uint64_t ticks,
 		rte_pause();
 }
 
-/* Stop the timer associated with the timer handle tim */
-int
-rte_timer_stop(struct rte_timer *tim)
+static int
+__rte_timer_stop(struct rte_timer *tim, struct rte_timer_data *timer_data)
 {
 	union rte_timer_status prev_status, status;
 	unsigned lcore_id = rte_lcore_id();
 	int ret;
+	struct priv_timer *priv_timer = timer_data->priv_timer;
 
 	/* wait that the timer is in correct status before update,
 	 * and mark it as being configured */
-	ret = timer_set_config_state(tim, &prev_status);
+	ret = timer_set_config_state(tim, &prev_status, priv_timer);
 	if (ret < 0)
 		return -1;
 
-	__TIMER_STAT_ADD(stop, 1);
+	__TIMER_STAT_ADD(priv_timer, stop, 1);
 	if (prev_status.state == RTE_TIMER_RUNNING &&
 	    lcore_id < RTE_MAX_LCORE) {
 		priv_timer[lcore_id].updated = 1;
@@ -448,8 +822,8 @@ rte_timer_stop(struct rte_timer *tim)
 
 	/* remove it from list */
 	if (prev_status.state == RTE_TIMER_PENDING) {
-		timer_del(tim, prev_status, 0);
-		__TIMER_STAT_ADD(pending, -1);
+		timer_del(tim, prev_status, 0, priv_timer);
+		__TIMER_STAT_ADD(priv_timer, pending, -1);
 	}
 
 	/* mark timer as stopped */
@@ -461,6 +835,24 @@ rte_timer_stop(struct rte_timer *tim)
 	return 0;
 }
 
+/* Stop the timer associated with the timer handle tim */
+int
+rte_timer_stop(struct rte_timer *tim)
+{
+	return __rte_timer_stop(tim, &rte_timer_data_arr[DEFAULT_DATA_ID]);
+}
+
+/* Stop a timer of the timer data instance timer_data_id */
+int __rte_experimental
+rte_timer_alt_stop(uint32_t timer_data_id, struct rte_timer *tim)
+{
+	struct rte_timer_data *timer_data;
+
+	TIMER_DATA_VALID_GET_OR_ERR_RET(timer_data_id, timer_data, -EINVAL);
+
+	return __rte_timer_stop(tim, timer_data);
+}
+
 /* loop until rte_timer_stop() succeed */
 void
 rte_timer_stop_sync(struct rte_timer *tim)
@@ -476,24 +868,56 @@ rte_timer_pending(struct rte_timer *tim)
 	return tim->status.state == RTE_TIMER_PENDING;
 }
 
-/* must be called periodically, run all timer that expired */
-void rte_timer_manage(void)
+/*
+ * transition a run-list from PENDING to RUNNING, removing the timers
+ * which are being reconfigured by another core
+ */
+static struct rte_timer *
+timer_set_running_list(struct rte_timer *tim)
+{
+	struct rte_timer *run_first_tim, **pprev, *next_tim;
+	int ret;
+
+	run_first_tim = tim;
+	pprev = &run_first_tim;
+
+	for ( ; tim != NULL; tim = next_tim) {
+		next_tim = tim->sl_next[0];
+
+		ret = timer_set_running_state(tim);
+		if (likely(ret == 0)) {
+			pprev = &tim->sl_next[0];
+		} else {
+			/* another core is trying to re-config this one,
+			 * remove it from local expired list
+			 */
+			*pprev = next_tim;
+		}
+	}
+
+	return run_first_tim;
+}
+
+/* no bound on the number of expired timers processed by a manage call */
+#define TIMER_MANAGE_ALL UINT_MAX
+
+/* size of the arrays of expired timers given to a batch callback */
+#define TIMER_BATCH_SIZE 32
+
+/* remove up to max_timers expired timers from the skiplist of the lcore */
+static struct rte_timer *
+timer_skiplist_get_expired(struct priv_timer *priv_timer, unsigned lcore_id,
+			   unsigned int max_timers)
 {
-	union rte_timer_status status;
 	struct rte_timer *tim, *next_tim;
-	struct rte_timer *run_first_tim, **pprev;
-	unsigned lcore_id = rte_lcore_id();
 	struct rte_timer *prev[MAX_SKIPLIST_DEPTH + 1];
 	uint64_t cur_time;
-	int i, ret;
-
-	/* timer manager only runs on EAL thread with valid lcore_id */
-	assert(lcore_id < RTE_MAX_LCORE);
+	unsigned int n, depth;
+	int i;
 
-	__TIMER_STAT_ADD(manage, 1);
 	/* optimize for the case where per-cpu list is empty */
 	if (priv_timer[lcore_id].pending_head.sl_next[0] == NULL)
-		return;
+		return NULL;
 	cur_time = rte_get_timer_cycles();
 
 #ifdef RTE_ARCH_64
@@ -501,7 +925,7 @@ void rte_timer_manage(void)
 	 * updated atomically, so we can consult that for a quick check here
 	 * outside the lock */
 	if (likely(priv_timer[lcore_id].pending_head.expire > cur_time))
-		return;
+		return NULL;
 #endif
 
 	/* browse ordered list, add expired timers in 'expired' list */
@@ -511,14 +935,32 @@ void rte_timer_manage(void)
 	if (priv_timer[lcore_id].pending_head.sl_next[0] == NULL ||
 	    priv_timer[lcore_id].pending_head.sl_next[0]->expire > cur_time) {
 		rte_spinlock_unlock(&priv_timer[lcore_id].list_lock);
-		return;
+		return NULL;
 	}
 
 	/* save start of list of expired timers */
 	tim = priv_timer[lcore_id].pending_head.sl_next[0];
 
-	/* break the existing list at current time point */
-	timer_get_prev_entries(cur_time, lcore_id, prev);
+	if (max_timers == TIMER_MANAGE_ALL) {
+		timer_get_prev_entries(cur_time, lcore_id, prev, priv_timer);
+	} else {
+		/* walk the first max_timers expired timers, keeping the
+		 * last one met at each level: the next entry of a level
+		 * is the next timer iff the timer is in this level */
+		depth = priv_timer[lcore_id].curr_skiplist_depth;
+		for (i = 0; i < (int)depth; i++)
+			prev[i] = &priv_timer[lcore_id].pending_head;
+		for (n = 0; n < max_timers; n++) {
+			next_tim = prev[0]->sl_next[0];
+			if (next_tim == NULL || next_tim->expire > cur_time)
+				break;
+			for (i = 0; i < (int)depth &&
+					prev[i]->sl_next[i] == next_tim; i++)
+				prev[i] = next_tim;
+		}
+	}
+
+	/* break the existing list after the last expired timer taken */
 	for (i = priv_timer[lcore_id].curr_skiplist_depth -1; i >= 0; i--) {
 		if (prev[i] == &priv_timer[lcore_id].pending_head)
 			continue;
@@ -530,22 +972,7 @@ void rte_timer_manage(void)
 	}
 
 	/* transition run-list from PENDING to RUNNING */
-	run_first_tim = tim;
-	pprev = &run_first_tim;
-
-	for ( ; tim != NULL; tim = next_tim) {
-		next_tim = tim->sl_next[0];
-
-		ret = timer_set_running_state(tim);
-		if (likely(ret == 0)) {
-			pprev = &tim->sl_next[0];
-		} else {
-			/* another core is trying to re-config this one,
-			 * remove it from local expired list
-			 */
-			*pprev = next_tim;
-		}
-	}
+	tim = timer_set_running_list(tim);
 
 	/* update the next to expire timer value */
 	priv_timer[lcore_id].pending_head.expire =
@@ -554,50 +981,240 @@ void rte_timer_manage(void)
 
 	rte_spinlock_unlock(&priv_timer[lcore_id].list_lock);
 
+	return tim;
+}
+
+/* remove up to max_timers expired timers from the wheel of the lcore */
+static struct rte_timer *
+timer_wheel_get_expired(struct priv_timer *priv_timer, unsigned lcore_id,
+			unsigned int max_timers)
+{
+	struct timer_wheel *wheel = priv_timer[lcore_id].wheel;
+	struct rte_timer *run_first_tim = NULL, **plast = &run_first_tim;
+	struct rte_timer *tim;
+	unsigned int idx, n = 0;
+	uint64_t now;
+
+	/* optimize for the case where per-cpu wheel is empty */
+	if (wheel->count == 0)
+		return NULL;
+	now = rte_get_timer_cycles() >> wheel->shift;
+
+#ifdef RTE_ARCH_64
+	/* nothing to do before the next granule */
+	if (likely(now < wheel->cur))
+		return NULL;
+#endif
+
+	rte_spinlock_lock(&priv_timer[lcore_id].list_lock);
+
+	/* walk the granules elapsed since the last call, skipping the
+	 * empty slots of the first level up to its next wrap */
+	while (wheel->cur <= now && wheel->count != 0 && n < max_timers) {
+		idx = wheel->cur & WHEEL_SLOT_MASK;
+		if (idx == 0)
+			timer_wheel_cascade(wheel);
+
+		for (tim = wheel->slot[0][idx]; tim != NULL && n < max_timers;
+				tim = WHEEL_NEXT(tim)) {
+			WHEEL_SET_IDX(tim, WHEEL_IDX_NONE);
+			wheel->count--;
+			*plast = tim;
+			plast = &WHEEL_NEXT(tim);
+			n++;
+		}
+
+		/* keep the current granule for the timers left in its slot */
+		wheel->slot[0][idx] = tim;
+		if (tim != NULL) {
+			WHEEL_SET_PPREV(tim, &wheel->slot[0][idx]);
+			break;
+		}
+		wheel->bitmap[idx / 64] &= ~(1ULL << (idx % 64));
+
+		wheel->cur += timer_wheel_next_slot(wheel, idx + 1) - idx;
+	}
+	*plast = NULL;
+
+	/* the timers added from now on must not land in a skipped slot */
+	if (wheel->count == 0 || wheel->cur > now)
+		wheel->cur = now + 1;
+
+	/* transition run-list from PENDING to RUNNING */
+	run_first_tim = timer_set_running_list(run_first_tim);
+
+	rte_spinlock_unlock(&priv_timer[lcore_id].list_lock);
+
+	return run_first_tim;
+}
+
+/* stop an expired timer, or reload it if it is periodic */
+static void
+timer_expired_done(struct rte_timer *tim, unsigned int lcore_id,
+		   struct rte_timer_data *timer_data)
+{
+	union rte_timer_status status;
+	struct priv_timer *priv_timer = timer_data->priv_timer;
+
+	if (tim->period == 0) {
+		/* remove from done list and mark timer as stopped */
+		status.state = RTE_TIMER_STOP;
+		status.owner = RTE_TIMER_NO_OWNER;
+		rte_wmb();
+		tim->status.u32 = status.u32;
+	}
+	else {
+		/* keep it in list and mark timer as pending */
+		rte_spinlock_lock(&priv_timer[lcore_id].list_lock);
+		status.state = RTE_TIMER_PENDING;
+		__TIMER_STAT_ADD(priv_timer, pending, 1);
+		status.owner = (int16_t)lcore_id;
+		rte_wmb();
+		tim->status.u32 = status.u32;
+		__rte_timer_reset(tim, tim->expire + tim->period,
+			tim->period, lcore_id, tim->f, tim->arg, 1,
+			timer_data);
+		rte_spinlock_unlock(&priv_timer[lcore_id].list_lock);
+	}
+}
+
+static unsigned int
+__rte_timer_manage(struct rte_timer_data *timer_data, unsigned int max_timers,
+		   rte_timer_batch_cb_t batch_f, void *batch_arg)
+{
+	struct rte_timer *tim, *next_tim;
+	struct rte_timer *batch[TIMER_BATCH_SIZE];
+	unsigned lcore_id = rte_lcore_id();
+	unsigned int n = 0, nb_batch = 0;
+	struct priv_timer *priv_timer = timer_data->priv_timer;
+
+	/* timer manager only runs on EAL thread with valid lcore_id */
+	assert(lcore_id < RTE_MAX_LCORE);
+
+	__TIMER_STAT_ADD(priv_timer, manage, 1);
+	if (unlikely(max_timers == 0))
+		return 0;
+	if (priv_timer[lcore_id].wheel != NULL)
+		tim = timer_wheel_get_expired(priv_timer, lcore_id,
+					      max_timers);
+	else
+		tim = timer_skiplist_get_expired(priv_timer, lcore_id,
+						 max_timers);
+
+	/* give the expired timers to the batch callback once they are
+	 * stopped or reloaded, so that it can reset, stop or free them */
+	if (batch_f != NULL) {
+		for ( ; tim != NULL; tim = next_tim) {
+			next_tim = tim->sl_next[0];
+			__TIMER_STAT_ADD(priv_timer, pending, -1);
+			timer_expired_done(tim, lcore_id, timer_data);
+			batch[nb_batch++] = tim;
+			if (nb_batch == TIMER_BATCH_SIZE) {
+				batch_f(batch, nb_batch, batch_arg);
+				n += nb_batch;
+				nb_batch = 0;
+			}
+		}
+		if (nb_batch != 0)
+			batch_f(batch, nb_batch, batch_arg);
+		return n + nb_batch;
+	}
+
 	/* now scan expired list and call callbacks */
-	for (tim = run_first_tim; tim != NULL; tim = next_tim) {
+	for ( ; tim != NULL; tim = next_tim) {
 		next_tim = tim->sl_next[0];
 		priv_timer[lcore_id].updated = 0;
 		priv_timer[lcore_id].running_tim = tim;
 
 		/* execute callback function with list unlocked */
 		tim->f(tim, tim->arg);
+		n++;
 
-		__TIMER_STAT_ADD(pending, -1);
+		__TIMER_STAT_ADD(priv_timer, pending, -1);
 		/* the timer was stopped or reloaded by the callback
 		 * function, we have nothing to do here */
 		if (priv_timer[lcore_id].updated == 1)
 			continue;
 
-		if (tim->period == 0) {
-			/* remove from done list and mark timer as stopped */
-			status.state = RTE_TIMER_STOP;
-			status.owner = RTE_TIMER_NO_OWNER;
-			rte_wmb();
-			tim->status.u32 = status.u32;
-		}
-		else {
-			/* keep it in list and mark timer as pending */
-			rte_spinlock_lock(&priv_timer[lcore_id].list_lock);
-			status.state = RTE_TIMER_PENDING;
-			__TIMER_STAT_ADD(pending, 1);
-			status.owner = (int16_t)lcore_id;
-			rte_wmb();
-			tim->status.u32 = status.u32;
-			__rte_timer_reset(tim, tim->expire + tim->period,
-				tim->period, lcore_id, tim->f, tim->arg, 1);
-			rte_spinlock_unlock(&priv_timer[lcore_id].list_lock);
-		}
+		timer_expired_done(tim, lcore_id, timer_data);
 	}
 	priv_timer[lcore_id].running_tim = NULL;
+
+	return n;
 }
 
-/* dump statistics about timers */
-void rte_timer_dump_stats(FILE *f)
+/* must be called periodically, run all timer that expired */
+void rte_timer_manage(void)
+{
+	__rte_timer_manage(&rte_timer_data_arr[DEFAULT_DATA_ID],
+			   TIMER_MANAGE_ALL, NULL, NULL);
+}
+
+/* run the expired timers of the timer data instance timer_data_id */
+int __rte_experimental
+rte_timer_alt_manage(uint32_t timer_data_id)
+{
+	struct rte_timer_data *timer_data;
+
+	TIMER_DATA_VALID_GET_OR_ERR_RET(timer_data_id, timer_data, -EINVAL);
+
+	__rte_timer_manage(timer_data, TIMER_MANAGE_ALL, NULL, NULL);
+
+	return 0;
+}
+
+/* run at most max_timers expired timers */
+int __rte_experimental
+rte_timer_manage_burst(unsigned int max_timers)
+{
+	return __rte_timer_manage(&rte_timer_data_arr[DEFAULT_DATA_ID],
+				  max_timers, NULL, NULL);
+}
+
+/* run at most max_timers expired timers of the instance timer_data_id */
+int __rte_experimental
+rte_timer_alt_manage_burst(uint32_t timer_data_id, unsigned int max_timers)
+{
+	struct rte_timer_data *timer_data;
+
+	TIMER_DATA_VALID_GET_OR_ERR_RET(timer_data_id, timer_data, -EINVAL);
+
+	return __rte_timer_manage(timer_data, max_timers, NULL, NULL);
+}
+
+/* give at most max_timers expired timers to a batch callback */
+int __rte_experimental
+rte_timer_manage_batch(unsigned int max_timers, rte_timer_batch_cb_t f,
+		       void *arg)
+{
+	if (f == NULL)
+		return -EINVAL;
+
+	return __rte_timer_manage(&rte_timer_data_arr[DEFAULT_DATA_ID],
+				  max_timers, f, arg);
+}
+
+/* give at most max_timers expired timers of an instance to a callback */
+int __rte_experimental
+rte_timer_alt_manage_batch(uint32_t timer_data_id, unsigned int max_timers,
+			   rte_timer_batch_cb_t f, void *arg)
+{
+	struct rte_timer_data *timer_data;
+
+	TIMER_DATA_VALID_GET_OR_ERR_RET(timer_data_id, timer_data, -EINVAL);
+	if (f == NULL)
+		return -EINVAL;
+
+	return __rte_timer_manage(timer_data, max_timers, f, arg);
+}
+
+static void
+__rte_timer_dump_stats(struct rte_timer_data *timer_data __rte_unused, FILE *f)
 {
 #ifdef RTE_LIBRTE_TIMER_DEBUG
 	struct rte_timer_debug_stats sum;
 	unsigned lcore_id;
+	struct priv_timer *priv_timer = timer_data->priv_timer;
 
 	memset(&sum, 0, sizeof(sum));
 	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
@@ -615,3 +1232,22 @@ void rte_timer_dump_stats(FILE *f)
 	fprintf(f, "No timer statistics, RTE_LIBRTE_TIMER_DEBUG is disabled\n");
 #endif
 }
+
+/* dump statistics about timers */
+void rte_timer_dump_stats(FILE *f)
+{
+	__rte_timer_dump_stats(&rte_timer_data_arr[DEFAULT_DATA_ID], f);
+}
+
+/* dump statistics about the timers of the instance timer_data_id */
+int __rte_experimental
+rte_timer_alt_dump_stats(uint32_t timer_data_id, FILE *f)
+{
+	struct rte_timer_data *timer_data;
+
+	TIMER_DATA_VALID_GET_OR_ERR_RET(timer_data_id, timer_data, -EINVAL);
+
+	__rte_timer_dump_stats(timer_data, f);
+
+	return 0;
+}
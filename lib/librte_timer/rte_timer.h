@@ -39,6 +39,7 @@
 #include <stddef.h>
 #include <rte_common.h>
 #include <rte_config.h>
+#include <rte_compat.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -51,6 +52,9 @@ extern "C" {
 
 #define RTE_TIMER_NO_OWNER -2 /**< Timer has no owner. */
 
+/** Maximum number of timer data instances, including the default one. */
+#define RTE_TIMER_DATA_MAX 64
+
 /**
  * Timer type: Periodic or single (one-shot).
  */
@@ -59,6 +63,20 @@ enum rte_timer_type {
 	PERIODICAL
 };
 
+/**
+ * Backend keeping the pending timers of each lcore in a timer data
+ * instance.
+ */
+enum rte_timer_backend {
+	/** Skiplist sorted by expiry time; O(log n) arm and cancel. */
+	RTE_TIMER_BACKEND_SKIPLIST,
+	/**
+	 * Hierarchical timing wheel; O(1) arm and cancel. Timers expire on
+	 * a granule of about one microsecond, never before their expiry time.
+	 */
+	RTE_TIMER_BACKEND_WHEEL,
+};
+
 /**
  * Timer status: A union of the state (stopped, pending, running,
  * config) and an owner (the id of the lcore that owns the timer).
@@ -91,6 +109,13 @@ struct rte_timer;
  */
 typedef void (*rte_timer_cb_t)(struct rte_timer *, void *);
 
+/**
+ * Callback function type for a batch of expired timers, see
+ * rte_timer_manage_batch().
+ */
+typedef void (*rte_timer_batch_cb_t)(struct rte_timer **tims,
+		unsigned int nb_tims, void *arg);
+
 #define MAX_SKIPLIST_DEPTH 10
 
 /**
@@ -139,6 +164,70 @@ struct rte_timer
  */
 void rte_timer_subsystem_init(void);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Initialize the timer library with a given backend.
+ *
+ * Same as rte_timer_subsystem_init(), also selecting the backend of the
+ * default timer data instance, used by rte_timer_reset(),
+ * rte_timer_stop() and rte_timer_manage(). It must be called before any
+ * timer is started. A later call to rte_timer_subsystem_init() keeps the
+ * selected backend.
+ *
+ * @param backend
+ *   The backend of the default timer lists.
+ * @return
+ *   - 0: Success.
+ *   - (-EINVAL): Invalid backend.
+ *   - (-ENOMEM): Cannot allocate the timing wheels.
+ */
+int __rte_experimental
+rte_timer_subsystem_init_backend(enum rte_timer_backend backend);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Allocate a timer data instance.
+ *
+ * A timer data instance is a set of per-lcore timer lists, independent
+ * from the default one, so that the timers of a library or of an
+ * application are not managed along with the timers of another one. Its
+ * timers are started with rte_timer_alt_reset(), stopped with
+ * rte_timer_alt_stop() and run by rte_timer_alt_manage().
+ *
+ * @param id_ptr
+ *   Pointer filled with the identifier of the new instance.
+ * @param backend
+ *   The backend of the timer lists of the instance.
+ * @return
+ *   - 0: Success.
+ *   - (-EINVAL): Invalid parameters.
+ *   - (-ENOSPC): No more instances available.
+ *   - (-ENOMEM): Cannot allocate the timing wheels.
+ */
+int __rte_experimental
+rte_timer_data_alloc(uint32_t *id_ptr, enum rte_timer_backend backend);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Free a timer data instance.
+ *
+ * All the timers of the instance must have been stopped.
+ *
+ * @param id
+ *   The identifier of the instance.
+ * @return
+ *   - 0: Success.
+ *   - (-EINVAL): Invalid identifier.
+ */
+int __rte_experimental
+rte_timer_data_dealloc(uint32_t id);
+
 /**
  * Initialize a timer handle.
  *
@@ -198,6 +287,42 @@ int rte_timer_reset(struct rte_timer *tim, uint64_t ticks,
 		    rte_timer_cb_t fct, void *arg);
 
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Reset and start a timer of a timer data instance.
+ *
+ * Same as rte_timer_reset(), the timer being added to the lists of the
+ * instance *timer_data_id*. A timer must only be used with one instance
+ * at a time.
+ *
+ * @param timer_data_id
+ *   The identifier of the timer data instance.
+ * @param tim
+ *   The timer handle.
+ * @param ticks
+ *   The number of cycles (see rte_get_hpet_hz()) before the callback
+ *   function is called.
+ * @param type
+ *   PERIODICAL or SINGLE, see rte_timer_reset().
+ * @param tim_lcore
+ *   The ID of the lcore where the timer callback function has to be
+ *   executed, or LCORE_ID_ANY for round-robin.
+ * @param fct
+ *   The callback function of the timer.
+ * @param arg
+ *   The user argument of the callback function.
+ * @return
+ *   - 0: Success; the timer is scheduled.
+ *   - (-1): Timer is in the RUNNING or CONFIG state.
+ *   - (-EINVAL): Invalid timer data instance.
+ */
+int __rte_experimental
+rte_timer_alt_reset(uint32_t timer_data_id, struct rte_timer *tim,
+		    uint64_t ticks, enum rte_timer_type type,
+		    unsigned int tim_lcore, rte_timer_cb_t fct, void *arg);
+
 /**
  * Loop until rte_timer_reset() succeeds.
  *
@@ -255,6 +380,27 @@ rte_timer_reset_sync(struct rte_timer *tim, uint64_t ticks,
 int rte_timer_stop(struct rte_timer *tim);
 
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Stop a timer of a timer data instance.
+ *
+ * Same as rte_timer_stop(), for a timer started with
+ * rte_timer_alt_reset() on the instance *timer_data_id*.
+ *
+ * @param timer_data_id
+ *   The identifier of the timer data instance.
+ * @param tim
+ *   The timer handle.
+ * @return
+ *   - 0: Success; the timer is stopped.
+ *   - (-1): The timer is in the RUNNING or CONFIG state.
+ *   - (-EINVAL): Invalid timer data instance.
+ */
+int __rte_experimental
+rte_timer_alt_stop(uint32_t timer_data_id, struct rte_timer *tim);
+
 /**
  * Loop until rte_timer_stop() succeeds.
  *
@@ -294,6 +440,121 @@ int rte_timer_pending(struct rte_timer *tim);
  */
 void rte_timer_manage(void);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Manage the timer list of a timer data instance.
+ *
+ * Same as rte_timer_manage(), running the expired timers of the calling
+ * lcore in the instance *timer_data_id*.
+ *
+ * @param timer_data_id
+ *   The identifier of the timer data instance.
+ * @return
+ *   - 0: Success.
+ *   - (-EINVAL): Invalid timer data instance.
+ */
+int __rte_experimental
+rte_timer_alt_manage(uint32_t timer_data_id);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Manage the timer list and execute a bounded number of callbacks.
+ *
+ * Same as rte_timer_manage(), running at most *max_timers* expired
+ * timers, the earliest ones first. The other expired timers stay pending
+ * until the next call, so that they can still be reset or stopped, and
+ * the time spent in one call is bounded even when many timers expire at
+ * the same time.
+ *
+ * @param max_timers
+ *   The maximum number of expired timers to run.
+ * @return
+ *   The number of expired timers run. When equal to *max_timers*, more
+ *   timers may have expired.
+ */
+int __rte_experimental
+rte_timer_manage_burst(unsigned int max_timers);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Manage the timer list of a timer data instance and execute a bounded
+ * number of callbacks.
+ *
+ * Same as rte_timer_manage_burst(), for the timers of the calling lcore
+ * in the instance *timer_data_id*.
+ *
+ * @param timer_data_id
+ *   The identifier of the timer data instance.
+ * @param max_timers
+ *   The maximum number of expired timers to run.
+ * @return
+ *   - The number of expired timers run.
+ *   - (-EINVAL): Invalid timer data instance.
+ */
+int __rte_experimental
+rte_timer_alt_manage_burst(uint32_t timer_data_id, unsigned int max_timers);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Manage the timer list and give the expired timers to a batch callback.
+ *
+ * Like rte_timer_manage_burst(), takes at most *max_timers* expired
+ * timers, the earliest ones first. Instead of calling the callback
+ * function of each timer, the timers are given to *f* in arrays of up to
+ * 32 timers, letting it amortize its processing, such as a bulk delete
+ * of the matching flows. Before being given to *f*, single timers are
+ * stopped and periodic ones are reloaded, so that *f* can reset, stop or
+ * free them.
+ *
+ * @param max_timers
+ *   The maximum number of expired timers to process.
+ * @param f
+ *   The function called with the arrays of expired timers.
+ * @param arg
+ *   The user argument of *f*.
+ * @return
+ *   - The number of expired timers given to *f*. When equal to
+ *     *max_timers*, more timers may have expired.
+ *   - (-EINVAL): Invalid parameters.
+ */
+int __rte_experimental
+rte_timer_manage_batch(unsigned int max_timers, rte_timer_batch_cb_t f,
+		       void *arg);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Manage the timer list of a timer data instance and give the expired
+ * timers to a batch callback.
+ *
+ * Same as rte_timer_manage_batch(), for the timers of the calling lcore
+ * in the instance *timer_data_id*.
+ *
+ * @param timer_data_id
+ *   The identifier of the timer data instance.
+ * @param max_timers
+ *   The maximum number of expired timers to process.
+ * @param f
+ *   The function called with the arrays of expired timers.
+ * @param arg
+ *   The user argument of *f*.
+ * @return
+ *   - The number of expired timers given to *f*.
+ *   - (-EINVAL): Invalid parameters.
+ */
+int __rte_experimental
+rte_timer_alt_manage_batch(uint32_t timer_data_id, unsigned int max_timers,
+			   rte_timer_batch_cb_t f, void *arg);
+
 /**
  * Dump statistics about timers.
  *
@@ -302,6 +563,23 @@ void rte_timer_manage(void);
  */
 void rte_timer_dump_stats(FILE *f);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Dump statistics about the timers of a timer data instance.
+ *
+ * @param timer_data_id
+ *   The identifier of the timer data instance.
+ * @param f
+ *   A pointer to a file for output
+ * @return
+ *   - 0: Success.
+ *   - (-EINVAL): Invalid timer data instance.
+ */
+int __rte_experimental
+rte_timer_alt_dump_stats(uint32_t timer_data_id, FILE *f);
+
 #ifdef __cplusplus
 }
 #endif
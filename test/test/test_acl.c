@@ -12,7 +12,9 @@
 #include <rte_byteorder.h>
 #include <rte_ip.h>
 #include <rte_acl.h>
+#include <rte_acl_incr.h>
 #include <rte_common.h>
+#include <rte_cpuflags.h>
 
 #include "test_acl.h"
 
@@ -20,6 +22,9 @@
 
 #define LEN RTE_ACL_MAX_CATEGORIES
 
+/* number of flows classified to check the vector classify methods */
+#define TEST_CLASSIFY_ALG_NUM	100
+
 RTE_ACL_RULE_DEF(acl_ipv4vlan_rule, RTE_ACL_IPV4VLAN_NUM_FIELDS);
 
 struct rte_acl_param acl_param = {
@@ -265,6 +270,78 @@ rte_acl_ipv4vlan_build(struct rte_acl_ctx *ctx,
 	return rte_acl_build(ctx, &cfg);
 }
 
+#ifdef RTE_ARCH_X86
+/*
+ * Compare the results of the vector classify methods, run over
+ * enough flows to fill all their slots, with the scalar ones.
+ */
+static int
+test_classify_alg(struct rte_acl_ctx *acx, const uint8_t **data,
+	uint32_t num)
+{
+	static const struct {
+		enum rte_acl_classify_alg alg;
+		enum rte_cpu_flag_t flag[2];
+	} algs[] = {
+		{
+			.alg = RTE_ACL_CLASSIFY_AVX2,
+			.flag = {RTE_CPUFLAG_AVX2, RTE_CPUFLAG_AVX2},
+		},
+		{
+			.alg = RTE_ACL_CLASSIFY_AVX512X16,
+			.flag = {RTE_CPUFLAG_AVX512F, RTE_CPUFLAG_AVX512BW},
+		},
+		{
+			.alg = RTE_ACL_CLASSIFY_AVX512X32,
+			.flag = {RTE_CPUFLAG_AVX512F, RTE_CPUFLAG_AVX512BW},
+		},
+	};
+	uint32_t i, k, count;
+	int ret;
+	uint32_t results[TEST_CLASSIFY_ALG_NUM * RTE_ACL_MAX_CATEGORIES];
+	uint32_t expect[TEST_CLASSIFY_ALG_NUM * RTE_ACL_MAX_CATEGORIES];
+
+	ret = rte_acl_classify_alg(acx, data, expect, num,
+		RTE_ACL_MAX_CATEGORIES, RTE_ACL_CLASSIFY_SCALAR);
+	if (ret != 0) {
+		printf("Line %i: scalar classify failed!\n", __LINE__);
+		return ret;
+	}
+
+	for (k = 0; k != RTE_DIM(algs); k++) {
+		if (!rte_cpu_get_flag_enabled(algs[k].flag[0]) ||
+				!rte_cpu_get_flag_enabled(algs[k].flag[1]))
+			continue;
+
+		/* from num=0 to num larger than all the parallel slots */
+		for (count = 0; count <= num; count += 7) {
+			ret = rte_acl_classify_alg(acx, data, results, count,
+				RTE_ACL_MAX_CATEGORIES, algs[k].alg);
+			if (ret == -ENOTSUP)
+				break;
+			if (ret != 0) {
+				printf("Line %i: classify alg %d failed!\n",
+					__LINE__, algs[k].alg);
+				return ret;
+			}
+
+			for (i = 0; i != count * RTE_ACL_MAX_CATEGORIES; i++) {
+				if (results[i] != expect[i]) {
+					printf("Line %i: Error in alg %d "
+						"results at %u (expected %"
+						PRIu32" got %"PRIu32")!\n",
+						__LINE__, algs[k].alg, i,
+						expect[i], results[i]);
+					return -EINVAL;
+				}
+			}
+		}
+	}
+
+	return 0;
+}
+#endif
+
 /*
  * Test scalar and SSE ACL lookup.
  */
@@ -274,14 +351,14 @@ test_classify_run(struct rte_acl_ctx *acx)
 	int ret, i;
 	uint32_t result, count;
 	uint32_t results[RTE_DIM(acl_test_data) * RTE_ACL_MAX_CATEGORIES];
-	const uint8_t *data[RTE_DIM(acl_test_data)];
+	const uint8_t *data[TEST_CLASSIFY_ALG_NUM];
 
 	/* swap all bytes in the data to network order */
 	bswap_test_data(acl_test_data, RTE_DIM(acl_test_data), 1);
 
-	/* store pointers to test data */
-	for (i = 0; i < (int) RTE_DIM(acl_test_data); i++)
-		data[i] = (uint8_t *)&acl_test_data[i];
+	/* store pointers to test data, repeated for the vector methods */
+	for (i = 0; i < (int) RTE_DIM(data); i++)
+		data[i] = (uint8_t *)&acl_test_data[i % RTE_DIM(acl_test_data)];
 
 	/**
 	 * these will run quite a few times, it's necessary to test code paths
@@ -358,7 +435,11 @@ test_classify_run(struct rte_acl_ctx *acx)
 		}
 	}
 
+#ifdef RTE_ARCH_X86
+	ret = test_classify_alg(acx, data, RTE_DIM(data));
+#else
 	ret = 0;
+#endif
 
 err:
 	/* swap data back to cpu order so that next time tests don't fail */
@@ -1569,6 +1650,348 @@ test_invalid_parameters(void)
 	return 0;
 }
 
+/*
+ * Compare the results of an incremental ACL with the ones of an ACL
+ * context built from the rules not deleted yet.
+ */
+static int
+test_incr_check(const struct rte_acl_incr *incr, const uint8_t *del)
+{
+	int ret;
+	uint32_t i, n;
+	struct rte_acl_ctx *acx;
+	struct rte_acl_ipv4vlan_rule rules[RTE_DIM(acl_test_rules)];
+	uint32_t results[RTE_DIM(acl_test_data) * RTE_ACL_MAX_CATEGORIES];
+	uint32_t expect[RTE_DIM(acl_test_data) * RTE_ACL_MAX_CATEGORIES];
+	const uint8_t *data[RTE_DIM(acl_test_data)];
+
+	n = 0;
+	for (i = 0; i != RTE_DIM(acl_test_rules); i++) {
+		if (del[i] == 0)
+			rules[n++] = acl_test_rules[i];
+	}
+
+	memset(expect, 0, sizeof(expect));
+	if (n != 0) {
+		acx = rte_acl_create(&acl_param);
+		if (acx == NULL) {
+			printf("Line %i: Error creating ACL context!\n",
+				__LINE__);
+			return -1;
+		}
+		ret = test_classify_buid(acx, rules, n);
+		if (ret != 0) {
+			rte_acl_free(acx);
+			return -1;
+		}
+	} else
+		acx = NULL;
+
+	bswap_test_data(acl_test_data, RTE_DIM(acl_test_data), 1);
+	for (i = 0; i != RTE_DIM(acl_test_data); i++)
+		data[i] = (uint8_t *)&acl_test_data[i];
+
+	ret = 0;
+	if (acx != NULL)
+		ret = rte_acl_classify(acx, data, expect,
+			RTE_DIM(acl_test_data), RTE_ACL_MAX_CATEGORIES);
+	if (ret == 0)
+		ret = rte_acl_incr_classify(incr, data, results,
+			RTE_DIM(acl_test_data), RTE_ACL_MAX_CATEGORIES);
+
+	bswap_test_data(acl_test_data, RTE_DIM(acl_test_data), 0);
+	rte_acl_free(acx);
+
+	if (ret != 0) {
+		printf("Line %i: classify failed!\n", __LINE__);
+		return -1;
+	}
+
+	for (i = 0; i != RTE_DIM(results); i++) {
+		if (results[i] != expect[i]) {
+			printf("Line %i: Error in results at %u "
+				"(expected %"PRIu32" got %"PRIu32")!\n",
+				__LINE__, i, expect[i], results[i]);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * Test incremental ACL updates: rules added in small batches spread over
+ * several tries, deleted from small and large tries, and merged.
+ */
+static int
+test_incr(void)
+{
+	int ret;
+	uint32_t i, n;
+	struct rte_acl_config cfg;
+	struct rte_acl_incr *incr;
+	struct rte_acl_incr_param param;
+	struct acl_ipv4vlan_rule rules[RTE_DIM(acl_test_rules)];
+	uint32_t ids[RTE_DIM(acl_test_rules)];
+	uint8_t del[RTE_DIM(acl_test_rules)];
+
+	memset(&cfg, 0, sizeof(cfg));
+	acl_ipv4vlan_config(&cfg, ipv4_7tuple_layout, RTE_ACL_MAX_CATEGORIES);
+
+	param.name = "acl_incr";
+	param.socket_id = SOCKET_ID_ANY;
+	param.rule_size = RTE_ACL_IPV4VLAN_RULE_SZ;
+	param.max_rule_num = RTE_DIM(acl_test_rules);
+	param.delta_rule_num = 4;
+
+	incr = rte_acl_incr_create(&param, &cfg);
+	if (incr == NULL) {
+		printf("Line %i: Error creating incremental ACL!\n", __LINE__);
+		return -1;
+	}
+
+	for (i = 0; i != RTE_DIM(acl_test_rules); i++)
+		acl_ipv4vlan_convert_rule(acl_test_rules + i, rules + i);
+	memset(del, 1, sizeof(del));
+
+	ret = test_incr_check(incr, del);
+	if (ret != 0)
+		goto err;
+
+	/* add the rules by batches of 3, deleting some from the delta */
+	for (i = 0; i < RTE_DIM(rules); i += n) {
+		n = RTE_MIN(3U, RTE_DIM(rules) - i);
+		ret = rte_acl_incr_add_rules(incr,
+			(struct rte_acl_rule *)(rules + i), n, ids + i);
+		if (ret != 0) {
+			printf("Line %i: Error adding rules: %d!\n",
+				__LINE__, ret);
+			goto err;
+		}
+		memset(del + i, 0, n);
+
+		ret = test_incr_check(incr, del);
+		if (ret != 0)
+			goto err;
+	}
+
+	ret = rte_acl_incr_add_rules(incr, (struct rte_acl_rule *)rules, 1,
+		ids);
+	if (ret != -ENOMEM) {
+		printf("Line %i: Adding rule to full ACL should fail!\n",
+			__LINE__);
+		ret = -1;
+		goto err;
+	}
+
+	/* merge the sealed tries */
+	ret = rte_acl_incr_merge(incr);
+	if (ret == 0)
+		ret = test_incr_check(incr, del);
+	if (ret != 0)
+		goto err;
+	rte_acl_incr_dump(incr);
+
+	/* delete every other rule, mostly from the merged trie */
+	for (i = 0; i < RTE_DIM(rules); i += 2) {
+		ret = rte_acl_incr_del_rule(incr, ids[i]);
+		if (ret != 0) {
+			printf("Line %i: Error deleting rule %u: %d!\n",
+				__LINE__, i, ret);
+			goto err;
+		}
+		del[i] = 1;
+
+		ret = test_incr_check(incr, del);
+		if (ret != 0)
+			goto err;
+	}
+	rte_acl_incr_dump(incr);
+
+	ret = rte_acl_incr_del_rule(incr, ids[0]);
+	if (ret != -ENOENT) {
+		printf("Line %i: Deleting a deleted rule should fail!\n",
+			__LINE__);
+		ret = -1;
+		goto err;
+	}
+
+	/* compact the merged trie and reuse the deleted rule slots */
+	ret = rte_acl_incr_merge(incr);
+	if (ret == 0)
+		ret = test_incr_check(incr, del);
+	if (ret != 0)
+		goto err;
+	rte_acl_incr_reclaim(incr);
+
+	for (i = 0; i < RTE_DIM(rules); i += 2) {
+		ret = rte_acl_incr_add_rules(incr,
+			(struct rte_acl_rule *)(rules + i), 1, ids + i);
+		if (ret != 0) {
+			printf("Line %i: Error adding rule %u: %d!\n",
+				__LINE__, i, ret);
+			goto err;
+		}
+		del[i] = 0;
+	}
+
+	ret = test_incr_check(incr, del);
+	if (ret != 0)
+		goto err;
+
+	/* delete all the rules */
+	for (i = 0; i != RTE_DIM(rules); i++) {
+		ret = rte_acl_incr_del_rule(incr, ids[i]);
+		if (ret != 0) {
+			printf("Line %i: Error deleting rule %u: %d!\n",
+				__LINE__, i, ret);
+			goto err;
+		}
+		del[i] = 1;
+	}
+
+	ret = rte_acl_incr_merge(incr);
+	if (ret == 0)
+		ret = test_incr_check(incr, del);
+
+err:
+	rte_acl_incr_free(incr);
+	return ret == 0 ? 0 : -1;
+}
+
+/*
+ * Check the build report against the rules of the context.
+ */
+static int
+test_build_report_check(const struct rte_acl_build_report *rpt,
+	uint32_t max_tries)
+{
+	uint32_t i, n;
+
+	if (rpt->num_builds == 0 || rpt->num_tries == 0 ||
+			rpt->num_tries > max_tries ||
+			rpt->num_rules != RTE_DIM(acl_test_rules) ||
+			rpt->fail_rule != 0 || rpt->mem_sz == 0) {
+		printf("Line %i: invalid build report: builds: %u, "
+			"tries: %u, rules: %u, fail rule: %u, mem: %zu\n",
+			__LINE__, rpt->num_builds, rpt->num_tries,
+			rpt->num_rules, rpt->fail_rule, rpt->mem_sz);
+		return -1;
+	}
+
+	n = 0;
+	for (i = 0; i != rpt->num_tries; i++) {
+		if (rpt->trie[i].num_nodes == 0 ||
+				rpt->trie[i].mem_sz == 0 ||
+				rpt->trie[i].num_fields == 0 ||
+				rpt->trie[i].num_transitions == 0) {
+			printf("Line %i: invalid report for trie %u\n",
+				__LINE__, i);
+			return -1;
+		}
+		n += rpt->trie[i].num_rules;
+	}
+
+	if (n != rpt->num_rules) {
+		printf("Line %i: %u rules in tries, %u expected\n",
+			__LINE__, n, rpt->num_rules);
+		return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * Test budgeted build, with and without rules grouping.
+ */
+static int
+test_build_budget(void)
+{
+	static const struct rte_acl_build_param params[] = {
+		{.max_tries = 0, .flags = 0,},
+		{.max_tries = 1, .flags = 0,},
+		{.max_tries = 0, .flags = RTE_ACL_BUILD_F_GROUP_WILDCARD,},
+		{.max_tries = 1, .flags = RTE_ACL_BUILD_F_GROUP_WILDCARD,},
+		{.max_tries = 2, .flags = RTE_ACL_BUILD_F_GROUP_WILDCARD,},
+	};
+
+	int ret;
+	uint32_t i;
+	struct rte_acl_ctx *acx;
+	struct rte_acl_config cfg;
+	struct rte_acl_build_param prm;
+	struct rte_acl_build_report rpt;
+
+	acx = rte_acl_create(&acl_param);
+	if (acx == NULL) {
+		printf("Line %i: Error creating ACL context!\n", __LINE__);
+		return -1;
+	}
+
+	ret = rte_acl_ipv4vlan_add_rules(acx, acl_test_rules,
+		RTE_DIM(acl_test_rules));
+	if (ret != 0) {
+		printf("Line %i: Adding rules to ACL context failed!\n",
+			__LINE__);
+		goto err;
+	}
+
+	memset(&cfg, 0, sizeof(cfg));
+	acl_ipv4vlan_config(&cfg, ipv4_7tuple_layout, RTE_ACL_MAX_CATEGORIES);
+
+	for (i = 0; i != RTE_DIM(params); i++) {
+
+		ret = rte_acl_build_budget(acx, &cfg, params + i, &rpt);
+		if (ret != 0) {
+			printf("Line %i: budgeted build %u failed: %d\n",
+				__LINE__, i, ret);
+			goto err;
+		}
+
+		ret = test_build_report_check(&rpt,
+			params[i].max_tries == 0 ?
+			RTE_ACL_MAX_TRIES : params[i].max_tries);
+		if (ret != 0)
+			goto err;
+
+		ret = test_classify_run(acx);
+		if (ret != 0) {
+			printf("Line %i: classify after budgeted build %u "
+				"failed!\n", __LINE__, i);
+			goto err;
+		}
+	}
+
+	/* too many tries */
+	prm.max_tries = RTE_ACL_MAX_TRIES + 1;
+	prm.flags = 0;
+	ret = rte_acl_build_budget(acx, &cfg, &prm, &rpt);
+	if (ret != -EINVAL) {
+		printf("Line %i: budgeted build with %u tries "
+			"should have failed!\n", __LINE__, prm.max_tries);
+		ret = -1;
+		goto err;
+	}
+
+	/* memory budget too small */
+	cfg.max_size = 1;
+	prm.max_tries = 0;
+	ret = rte_acl_build_budget(acx, &cfg, &prm, &rpt);
+	if ((ret != -ERANGE && ret != -ENOMEM) || rpt.num_builds < 2 ||
+			rpt.mem_sz <= cfg.max_size) {
+		printf("Line %i: budgeted build with %zu bytes "
+			"should have failed, ret: %d!\n",
+			__LINE__, cfg.max_size, ret);
+		ret = -1;
+		goto err;
+	}
+	ret = 0;
+
+err:
+	rte_acl_free(acx);
+	return ret;
+}
+
 /**
  * Various tests that don't test much but improve coverage
  */
@@ -1616,6 +2039,10 @@ test_acl(void)
 		return -1;
 	if (test_convert() < 0)
 		return -1;
+	if (test_incr() < 0)
+		return -1;
+	if (test_build_budget() < 0)
+		return -1;
 
 	return 0;
 }
@@ -2,12 +2,23 @@
  * Copyright(c) 2017 Intel Corporation
  */
 #include <string.h>
+#include <inttypes.h>
+#ifdef RTE_EXEC_ENV_LINUXAPP
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
 #include <rte_common.h>
 #include <rte_mempool.h>
 #include <rte_mbuf.h>
 #include <rte_ethdev.h>
+#include <rte_ethdev_driver.h>
 #include <rte_eventdev.h>
 #include <rte_bus_vdev.h>
+#include <rte_atomic.h>
+#include <rte_cycles.h>
+#include <rte_malloc.h>
+#include <rte_ring.h>
+#include <rte_service.h>
 
 #include <rte_event_eth_rx_adapter.h>
 
@@ -452,6 +463,362 @@ adapter_start_stop(void)
 	return TEST_SUCCESS;
 }
 
+static int
+adapter_intr_queue_add_del(void)
+{
+	int err;
+	struct rte_event ev;
+	uint32_t service_id;
+	struct rte_event_eth_rx_adapter_queue_conf queue_config;
+
+	if (default_params.caps & RTE_EVENT_ETH_RX_ADAPTER_CAP_INTERNAL_PORT)
+		return TEST_SUCCESS;
+
+	ev.queue_id = 0;
+	ev.sched_type = RTE_SCHED_TYPE_ATOMIC;
+	ev.priority = 0;
+
+	queue_config.rx_queue_flags = 0;
+	queue_config.ev = ev;
+	/* Rx interrupts aren't enabled for the port, so the queues added
+	 * with a zero servicing weight are polled
+	 */
+	queue_config.servicing_weight = 0;
+
+	err = rte_event_eth_rx_adapter_queue_add(TEST_INST_ID, TEST_ETHDEV_ID,
+					-1, &queue_config);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	err = rte_event_eth_rx_adapter_service_id_get(TEST_INST_ID,
+						&service_id);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	err = rte_event_eth_rx_adapter_start(TEST_INST_ID);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	/* Re-add with a non zero servicing weight */
+	queue_config.servicing_weight = 2;
+	err = rte_event_eth_rx_adapter_queue_add(TEST_INST_ID, TEST_ETHDEV_ID,
+					-1, &queue_config);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	err = rte_event_eth_rx_adapter_stop(TEST_INST_ID);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	err = rte_event_eth_rx_adapter_queue_del(TEST_INST_ID, TEST_ETHDEV_ID,
+						-1);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	return TEST_SUCCESS;
+}
+
+#ifdef RTE_EXEC_ENV_LINUXAPP
+/*
+ * Ethernet device with a single Rx queue whose interrupt is an eventfd,
+ * packets are received from a ring filled by the test
+ */
+#define INTR_DEV_NAME		"net_rxa_intr"
+#define INTR_NB_PKTS		8
+#define INTR_WAIT_MS		1000
+#define INTR_IDLE_ITERS		64
+
+static struct {
+	struct rte_eth_dev *dev;
+	struct rte_ring *rx_ring;
+	struct rte_intr_handle intr_handle;
+	int intr_vec[1];
+	rte_atomic32_t nb_intr_enable;
+	rte_atomic32_t nb_intr_disable;
+} intr_dev;
+
+static struct rte_driver intr_dev_driver = {
+	.name = INTR_DEV_NAME,
+};
+
+static struct rte_device intr_dev_device = {
+	.name = INTR_DEV_NAME,
+	.driver = &intr_dev_driver,
+	.numa_node = SOCKET_ID_ANY,
+};
+
+static int
+intr_dev_configure(struct rte_eth_dev *dev __rte_unused)
+{
+	return 0;
+}
+
+static int
+intr_dev_start(struct rte_eth_dev *dev)
+{
+	dev->data->dev_link.link_status = ETH_LINK_UP;
+	return 0;
+}
+
+static void
+intr_dev_stop(struct rte_eth_dev *dev)
+{
+	dev->data->dev_link.link_status = ETH_LINK_DOWN;
+}
+
+static void
+intr_dev_close(struct rte_eth_dev *dev __rte_unused)
+{
+}
+
+static int
+intr_dev_link_update(struct rte_eth_dev *dev __rte_unused,
+		int wait_to_complete __rte_unused)
+{
+	return 0;
+}
+
+static void
+intr_dev_info_get(struct rte_eth_dev *dev __rte_unused,
+		struct rte_eth_dev_info *dev_info)
+{
+	dev_info->max_mac_addrs = 1;
+	dev_info->max_rx_pktlen = ETHER_MAX_LEN;
+	dev_info->max_rx_queues = 1;
+	dev_info->max_tx_queues = 1;
+}
+
+static int
+intr_dev_rx_queue_setup(struct rte_eth_dev *dev, uint16_t rx_queue_id,
+		uint16_t nb_rx_desc __rte_unused,
+		unsigned int socket_id __rte_unused,
+		const struct rte_eth_rxconf *rx_conf __rte_unused,
+		struct rte_mempool *mb_pool __rte_unused)
+{
+	dev->data->rx_queues[rx_queue_id] = intr_dev.rx_ring;
+	return 0;
+}
+
+static void
+intr_dev_queue_release(void *queue __rte_unused)
+{
+}
+
+static int
+intr_dev_rx_intr_enable(struct rte_eth_dev *dev __rte_unused,
+		uint16_t rx_queue_id __rte_unused)
+{
+	rte_atomic32_inc(&intr_dev.nb_intr_enable);
+	return 0;
+}
+
+static int
+intr_dev_rx_intr_disable(struct rte_eth_dev *dev __rte_unused,
+		uint16_t rx_queue_id __rte_unused)
+{
+	rte_atomic32_inc(&intr_dev.nb_intr_disable);
+	return 0;
+}
+
+static const struct eth_dev_ops intr_dev_ops = {
+	.dev_configure = intr_dev_configure,
+	.dev_start = intr_dev_start,
+	.dev_stop = intr_dev_stop,
+	.dev_close = intr_dev_close,
+	.link_update = intr_dev_link_update,
+	.dev_infos_get = intr_dev_info_get,
+	.rx_queue_setup = intr_dev_rx_queue_setup,
+	.rx_queue_release = intr_dev_queue_release,
+	.rx_queue_intr_enable = intr_dev_rx_intr_enable,
+	.rx_queue_intr_disable = intr_dev_rx_intr_disable,
+};
+
+static uint16_t
+intr_dev_rx_burst(void *queue, struct rte_mbuf **bufs, uint16_t nb_bufs)
+{
+	return rte_ring_sc_dequeue_burst(queue, (void **)bufs, nb_bufs, NULL);
+}
+
+static int
+intr_dev_create(void)
+{
+	struct rte_eth_conf port_conf;
+	struct rte_eth_dev *dev;
+	int err;
+
+	memset(&intr_dev, 0, sizeof(intr_dev));
+	intr_dev.intr_handle.efds[0] = -1;
+	intr_dev.rx_ring = rte_ring_create("rxa_intr_dev_ring", 64,
+					rte_socket_id(),
+					RING_F_SP_ENQ | RING_F_SC_DEQ);
+	TEST_ASSERT_NOT_NULL(intr_dev.rx_ring, "Failed to create ring");
+
+	intr_dev.intr_handle.fd = -1;
+	intr_dev.intr_handle.type = RTE_INTR_HANDLE_VDEV;
+	intr_dev.intr_handle.efds[0] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	TEST_ASSERT(intr_dev.intr_handle.efds[0] >= 0,
+		"Failed to create eventfd");
+	intr_dev.intr_handle.nb_efd = 1;
+	intr_dev.intr_handle.max_intr = 2;
+	intr_dev.intr_handle.efd_counter_size = sizeof(uint64_t);
+	intr_dev.intr_vec[0] = RTE_INTR_VEC_RXTX_OFFSET;
+	intr_dev.intr_handle.intr_vec = intr_dev.intr_vec;
+
+	dev = rte_eth_dev_allocate(INTR_DEV_NAME);
+	TEST_ASSERT_NOT_NULL(dev, "Failed to allocate %s", INTR_DEV_NAME);
+	intr_dev.dev = dev;
+
+	dev->data->mac_addrs = rte_zmalloc(INTR_DEV_NAME,
+					sizeof(*dev->data->mac_addrs), 0);
+	TEST_ASSERT_NOT_NULL(dev->data->mac_addrs,
+			"Failed to allocate mac address");
+	dev->device = &intr_dev_device;
+	dev->dev_ops = &intr_dev_ops;
+	dev->intr_handle = &intr_dev.intr_handle;
+	dev->rx_pkt_burst = intr_dev_rx_burst;
+	rte_eth_dev_probing_finish(dev);
+
+	memset(&port_conf, 0, sizeof(port_conf));
+	port_conf.intr_conf.rxq = 1;
+	err = rte_eth_dev_configure(dev->data->port_id, 1, 0, &port_conf);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	err = rte_eth_rx_queue_setup(dev->data->port_id, 0, 64,
+				rte_socket_id(), NULL, default_params.mp);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	err = rte_eth_dev_start(dev->data->port_id);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	/* The adapter sizes its device array when it is created */
+	return adapter_create();
+}
+
+static void
+intr_dev_free(void)
+{
+	struct rte_eth_dev *dev = intr_dev.dev;
+
+	adapter_free();
+
+	if (dev != NULL) {
+		rte_eth_dev_stop(dev->data->port_id);
+		rte_eth_dev_close(dev->data->port_id);
+		rte_free(dev->data->mac_addrs);
+		dev->data->mac_addrs = NULL;
+		rte_eth_dev_release_port(dev);
+	}
+	if (intr_dev.intr_handle.efds[0] >= 0)
+		close(intr_dev.intr_handle.efds[0]);
+	rte_ring_free(intr_dev.rx_ring);
+	memset(&intr_dev, 0, sizeof(intr_dev));
+	intr_dev.intr_handle.efds[0] = -1;
+}
+
+/* Queue packets on the device, signal its Rx interrupt and wait for the
+ * adapter interrupt thread to disable the queue interrupt
+ */
+static int
+intr_dev_rx(unsigned int nb_pkts)
+{
+	struct rte_mbuf *pkts[INTR_NB_PKTS];
+	int32_t nb_disable;
+	uint64_t val = 1;
+	unsigned int i;
+	int err;
+
+	err = rte_pktmbuf_alloc_bulk(default_params.mp, pkts, nb_pkts);
+	TEST_ASSERT(err == 0, "Failed to allocate mbufs");
+	for (i = 0; i < nb_pkts; i++)
+		pkts[i]->port = intr_dev.dev->data->port_id;
+	TEST_ASSERT(rte_ring_enqueue_bulk(intr_dev.rx_ring, (void **)pkts,
+					nb_pkts, NULL) == nb_pkts,
+		"Failed to enqueue mbufs");
+
+	nb_disable = rte_atomic32_read(&intr_dev.nb_intr_disable);
+	TEST_ASSERT(write(intr_dev.intr_handle.efds[0], &val, sizeof(val)) ==
+			sizeof(val), "Failed to write eventfd");
+
+	for (i = 0; i < INTR_WAIT_MS; i++) {
+		if (rte_atomic32_read(&intr_dev.nb_intr_disable) != nb_disable)
+			return TEST_SUCCESS;
+		rte_delay_ms(1);
+	}
+
+	printf("Rx queue interrupt not received by the adapter\n");
+	return TEST_FAILED;
+}
+
+static int
+adapter_intr_rx(void)
+{
+	struct rte_event_eth_rx_adapter_queue_conf queue_config;
+	struct rte_event_eth_rx_adapter_stats stats;
+	uint16_t port_id = intr_dev.dev->data->port_id;
+	uint32_t service_id;
+	uint32_t cap;
+	unsigned int round;
+	unsigned int i;
+	int32_t nb_enable;
+	int err;
+
+	err = rte_event_eth_rx_adapter_caps_get(TEST_DEV_ID, port_id, &cap);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+	if (cap & RTE_EVENT_ETH_RX_ADAPTER_CAP_INTERNAL_PORT)
+		return TEST_SUCCESS;
+
+	memset(&queue_config, 0, sizeof(queue_config));
+	queue_config.ev.queue_id = 0;
+	queue_config.ev.sched_type = RTE_SCHED_TYPE_ATOMIC;
+	queue_config.servicing_weight = 0;
+
+	err = rte_event_eth_rx_adapter_queue_add(TEST_INST_ID, port_id, 0,
+						&queue_config);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+	TEST_ASSERT(rte_atomic32_read(&intr_dev.nb_intr_enable) == 1,
+		"Rx queue interrupt not enabled");
+
+	err = rte_event_eth_rx_adapter_service_id_get(TEST_INST_ID,
+						&service_id);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	err = rte_event_eth_rx_adapter_start(TEST_INST_ID);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	for (round = 1; round <= 2; round++) {
+		err = intr_dev_rx(INTR_NB_PKTS);
+		TEST_ASSERT(err == TEST_SUCCESS, "Rx interrupt failed");
+
+		/* The queue is polled until it has been idle long enough and
+		 * its interrupt is then rearmed
+		 */
+		nb_enable = rte_atomic32_read(&intr_dev.nb_intr_enable);
+		for (i = 0; i < INTR_IDLE_ITERS; i++) {
+			err = rte_service_run_iter_on_app_lcore(service_id, 1);
+			TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+			if (rte_atomic32_read(&intr_dev.nb_intr_enable) !=
+					nb_enable)
+				break;
+		}
+		TEST_ASSERT(i < INTR_IDLE_ITERS,
+			"Rx queue interrupt not rearmed");
+
+		err = rte_event_eth_rx_adapter_stats_get(TEST_INST_ID, &stats);
+		TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+		TEST_ASSERT(stats.rx_intr_packets == round * INTR_NB_PKTS,
+			"Expected %u interrupt mode packets got %" PRIu64,
+			round * INTR_NB_PKTS, stats.rx_intr_packets);
+		TEST_ASSERT(stats.rx_packets == stats.rx_intr_packets,
+			"Expected %" PRIu64 " packets got %" PRIu64,
+			stats.rx_intr_packets, stats.rx_packets);
+	}
+
+	err = rte_event_eth_rx_adapter_stop(TEST_INST_ID);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	err = rte_event_eth_rx_adapter_queue_del(TEST_INST_ID, port_id, 0);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+	TEST_ASSERT(rte_atomic32_read(&intr_dev.nb_intr_disable) == 3,
+		"Rx queue interrupt not disabled");
+
+	return TEST_SUCCESS;
+}
+#endif /* RTE_EXEC_ENV_LINUXAPP */
+
 static int
 adapter_stats(void)
 {
@@ -478,8 +845,13 @@ static struct unit_test_suite service_tests  = {
 		TEST_CASE_ST(NULL, NULL, adapter_create_free),
 		TEST_CASE_ST(adapter_create, adapter_free,
 					adapter_queue_add_del),
+#ifdef RTE_EXEC_ENV_LINUXAPP
+		TEST_CASE_ST(intr_dev_create, intr_dev_free, adapter_intr_rx),
+#endif
 		TEST_CASE_ST(NULL, NULL, adapter_multi_eth_add_del),
 		TEST_CASE_ST(adapter_create, adapter_free, adapter_start_stop),
+		TEST_CASE_ST(adapter_create, adapter_free,
+					adapter_intr_queue_add_del),
 		TEST_CASE_ST(adapter_create, adapter_free, adapter_stats),
 		TEST_CASES_END() /**< NULL terminate unit test array */
 	}
@@ -0,0 +1,435 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2018 Intel Corporation
+ */
+#include <string.h>
+#include <rte_common.h>
+#include <rte_mempool.h>
+#include <rte_mbuf.h>
+#include <rte_ethdev.h>
+#include <rte_eventdev.h>
+#include <rte_bus_vdev.h>
+#include <rte_eth_ring.h>
+#include <rte_service.h>
+
+#include <rte_event_eth_tx_adapter.h>
+
+#include "test.h"
+
+#define TEST_INST_ID		0
+#define TEST_DEV_NAME		"event_sw_txa"
+#define TEST_RING_NAME		"txa_ring"
+#define TEST_ETHDEV_NAME	"net_ring_" TEST_RING_NAME
+#define NB_MBUFS		4096
+#define MBUF_CACHE_SIZE		32
+#define RING_SIZE		1024
+#define NUM_PKTS		256
+#define MAX_SERVICE_ITER	(NUM_PKTS * 16)
+
+struct event_eth_tx_adapter_test_params {
+	struct rte_mempool *mp;
+	struct rte_ring *r;
+	uint16_t port_id;
+	uint8_t dev_id;
+	uint32_t caps;
+};
+
+static struct event_eth_tx_adapter_test_params default_params;
+
+static int
+port_init(uint16_t port, struct rte_mempool *mp)
+{
+	struct rte_eth_conf port_conf;
+	int retval;
+
+	memset(&port_conf, 0, sizeof(port_conf));
+	retval = rte_eth_dev_configure(port, 1, 1, &port_conf);
+	if (retval != 0)
+		return retval;
+
+	retval = rte_eth_rx_queue_setup(port, 0, RING_SIZE,
+			rte_eth_dev_socket_id(port), NULL, mp);
+	if (retval < 0)
+		return retval;
+
+	retval = rte_eth_tx_queue_setup(port, 0, RING_SIZE,
+			rte_eth_dev_socket_id(port), NULL);
+	if (retval < 0)
+		return retval;
+
+	return rte_eth_dev_start(port);
+}
+
+static int
+testsuite_setup(void)
+{
+	struct event_eth_tx_adapter_test_params *p = &default_params;
+	int ret;
+
+	p->mp = rte_pktmbuf_pool_create("txa_pool", NB_MBUFS, MBUF_CACHE_SIZE,
+					0, RTE_MBUF_DEFAULT_BUF_SIZE,
+					rte_socket_id());
+	TEST_ASSERT_NOT_NULL(p->mp, "Failed to create mbuf pool");
+
+	/* Packets transmitted on the ring port are received back on it */
+	p->r = rte_ring_create(TEST_RING_NAME, RING_SIZE, rte_socket_id(),
+			RING_F_SP_ENQ | RING_F_SC_DEQ);
+	TEST_ASSERT_NOT_NULL(p->r, "Failed to create ring");
+
+	ret = rte_eth_from_ring(p->r);
+	TEST_ASSERT(ret >= 0, "Failed to create ring ethdev");
+	p->port_id = ret;
+
+	ret = port_init(p->port_id, p->mp);
+	TEST_ASSERT(ret == 0, "Port initialization failed err %d", ret);
+
+	ret = rte_vdev_init(TEST_DEV_NAME, NULL);
+	TEST_ASSERT(ret == 0, "Failed to create eventdev %s", TEST_DEV_NAME);
+
+	ret = rte_event_dev_get_dev_id(TEST_DEV_NAME);
+	TEST_ASSERT(ret >= 0, "Failed to get eventdev id");
+	p->dev_id = ret;
+
+	ret = rte_event_eth_tx_adapter_caps_get(p->dev_id, p->port_id,
+						&p->caps);
+	TEST_ASSERT(ret == 0, "Failed to get adapter caps err %d", ret);
+
+	return TEST_SUCCESS;
+}
+
+static void
+testsuite_teardown(void)
+{
+	struct event_eth_tx_adapter_test_params *p = &default_params;
+
+	rte_event_dev_stop(p->dev_id);
+	rte_event_dev_close(p->dev_id);
+	rte_vdev_uninit(TEST_DEV_NAME);
+	rte_eth_dev_stop(p->port_id);
+	rte_eth_dev_close(p->port_id);
+	rte_vdev_uninit(TEST_ETHDEV_NAME);
+	rte_ring_free(p->r);
+	rte_mempool_free(p->mp);
+}
+
+static int
+eventdev_configure(void)
+{
+	struct event_eth_tx_adapter_test_params *p = &default_params;
+	struct rte_event_dev_info dev_info;
+	int ret;
+
+	rte_event_dev_stop(p->dev_id);
+	rte_event_dev_info_get(p->dev_id, &dev_info);
+
+	struct rte_event_dev_config config = {
+			.nb_event_queues = 1,
+			.nb_event_ports = 1,
+			.nb_event_queue_flows = dev_info.max_event_queue_flows,
+			.nb_event_port_dequeue_depth =
+				dev_info.max_event_port_dequeue_depth,
+			.nb_event_port_enqueue_depth =
+				dev_info.max_event_port_enqueue_depth,
+			.nb_events_limit = dev_info.max_num_events,
+	};
+
+	ret = rte_event_dev_configure(p->dev_id, &config);
+	TEST_ASSERT(ret == 0, "Event device configure failed err %d", ret);
+
+	ret = rte_event_queue_setup(p->dev_id, 0, NULL);
+	TEST_ASSERT(ret == 0, "Event queue setup failed err %d", ret);
+
+	ret = rte_event_port_setup(p->dev_id, 0, NULL);
+	TEST_ASSERT(ret == 0, "Event port setup failed err %d", ret);
+
+	return TEST_SUCCESS;
+}
+
+static int
+adapter_create(void)
+{
+	struct event_eth_tx_adapter_test_params *p = &default_params;
+	struct rte_event_dev_info dev_info;
+	struct rte_event_port_conf tx_p_conf;
+	int err;
+
+	err = eventdev_configure();
+	if (err)
+		return err;
+
+	rte_event_dev_info_get(p->dev_id, &dev_info);
+	memset(&tx_p_conf, 0, sizeof(tx_p_conf));
+	tx_p_conf.new_event_threshold = dev_info.max_num_events;
+	tx_p_conf.dequeue_depth = dev_info.max_event_port_dequeue_depth;
+	tx_p_conf.enqueue_depth = dev_info.max_event_port_enqueue_depth;
+	err = rte_event_eth_tx_adapter_create(TEST_INST_ID, p->dev_id,
+					&tx_p_conf);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	return err;
+}
+
+static void
+adapter_free(void)
+{
+	rte_event_eth_tx_adapter_free(TEST_INST_ID);
+}
+
+static int
+adapter_create_free(void)
+{
+	struct event_eth_tx_adapter_test_params *p = &default_params;
+	int err;
+
+	struct rte_event_port_conf tx_p_conf = {
+			.dequeue_depth = 8,
+			.enqueue_depth = 8,
+			.new_event_threshold = 1200,
+	};
+
+	err = rte_event_eth_tx_adapter_create(TEST_INST_ID, p->dev_id,
+					NULL);
+	TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
+
+	err = rte_event_eth_tx_adapter_create(TEST_INST_ID, p->dev_id,
+					&tx_p_conf);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	err = rte_event_eth_tx_adapter_create(TEST_INST_ID,
+					p->dev_id, &tx_p_conf);
+	TEST_ASSERT(err == -EEXIST, "Expected -EEXIST %d got %d", -EEXIST, err);
+
+	err = rte_event_eth_tx_adapter_free(TEST_INST_ID);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	err = rte_event_eth_tx_adapter_free(TEST_INST_ID);
+	TEST_ASSERT(err == -EINVAL, "Expected -EINVAL %d got %d", -EINVAL, err);
+
+	err = rte_event_eth_tx_adapter_free(1);
+	TEST_ASSERT(err == -EINVAL, "Expected -EINVAL %d got %d", -EINVAL, err);
+
+	return TEST_SUCCESS;
+}
+
+static int
+adapter_queue_add_del(void)
+{
+	struct event_eth_tx_adapter_test_params *p = &default_params;
+	uint32_t service_id;
+	uint8_t port;
+	int err;
+
+	err = rte_event_eth_tx_adapter_queue_add(TEST_INST_ID,
+						RTE_MAX_ETHPORTS, -1);
+	TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
+
+	err = rte_event_eth_tx_adapter_queue_add(TEST_INST_ID, p->port_id,
+						1);
+	TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
+
+	err = rte_event_eth_tx_adapter_queue_add(TEST_INST_ID, p->port_id, 0);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	err = rte_event_eth_tx_adapter_queue_del(TEST_INST_ID, p->port_id, 0);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	err = rte_event_eth_tx_adapter_queue_add(TEST_INST_ID, p->port_id, -1);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	if (!(p->caps & RTE_EVENT_ETH_TX_ADAPTER_CAP_INTERNAL_PORT)) {
+		err = rte_event_eth_tx_adapter_event_port_get(TEST_INST_ID,
+							&port);
+		TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+		err = rte_event_eth_tx_adapter_service_id_get(TEST_INST_ID,
+							&service_id);
+		TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+	}
+
+	err = rte_event_eth_tx_adapter_free(TEST_INST_ID);
+	TEST_ASSERT(err == -EBUSY, "Expected -EBUSY got %d", err);
+
+	err = rte_event_eth_tx_adapter_queue_del(TEST_INST_ID, p->port_id, -1);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	err = rte_event_eth_tx_adapter_queue_del(TEST_INST_ID, p->port_id, -1);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	err = rte_event_eth_tx_adapter_queue_add(1, p->port_id, -1);
+	TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
+
+	err = rte_event_eth_tx_adapter_queue_del(1, p->port_id, -1);
+	TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
+
+	return TEST_SUCCESS;
+}
+
+static int
+adapter_start_stop(void)
+{
+	struct event_eth_tx_adapter_test_params *p = &default_params;
+	int err;
+
+	err = rte_event_eth_tx_adapter_queue_add(TEST_INST_ID, p->port_id, -1);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	err = rte_event_eth_tx_adapter_start(TEST_INST_ID);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	err = rte_event_eth_tx_adapter_stop(TEST_INST_ID);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	err = rte_event_eth_tx_adapter_queue_del(TEST_INST_ID, p->port_id, -1);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	err = rte_event_eth_tx_adapter_start(TEST_INST_ID);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	err = rte_event_eth_tx_adapter_stop(TEST_INST_ID);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	err = rte_event_eth_tx_adapter_start(1);
+	TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
+
+	err = rte_event_eth_tx_adapter_stop(1);
+	TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
+
+	return TEST_SUCCESS;
+}
+
+static int
+adapter_stats(void)
+{
+	struct rte_event_eth_tx_adapter_stats stats;
+	int err;
+
+	err = rte_event_eth_tx_adapter_stats_get(TEST_INST_ID, NULL);
+	TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
+
+	err = rte_event_eth_tx_adapter_stats_get(TEST_INST_ID, &stats);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	err = rte_event_eth_tx_adapter_stats_reset(TEST_INST_ID);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	err = rte_event_eth_tx_adapter_stats_get(1, &stats);
+	TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
+
+	return TEST_SUCCESS;
+}
+
+static int
+adapter_service(void)
+{
+	struct event_eth_tx_adapter_test_params *p = &default_params;
+	struct rte_event_eth_tx_adapter_stats stats;
+	struct rte_mbuf *pkts[NUM_PKTS];
+	struct rte_event ev[NUM_PKTS];
+	uint32_t txa_service_id;
+	uint32_t dev_service_id;
+	uint16_t nb_rx = 0;
+	uint8_t queue_id = 0;
+	uint8_t txa_port;
+	uint16_t enq;
+	int err;
+	int i;
+
+	if (p->caps & RTE_EVENT_ETH_TX_ADAPTER_CAP_INTERNAL_PORT)
+		return TEST_SUCCESS;
+
+	err = rte_event_eth_tx_adapter_queue_add(TEST_INST_ID, p->port_id, 0);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	err = rte_event_eth_tx_adapter_event_port_get(TEST_INST_ID, &txa_port);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	err = rte_event_port_link(p->dev_id, txa_port, &queue_id, NULL, 1);
+	TEST_ASSERT(err == 1, "Failed to link adapter port err %d", err);
+
+	err = rte_event_eth_tx_adapter_service_id_get(TEST_INST_ID,
+						&txa_service_id);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	err = rte_event_dev_service_id_get(p->dev_id, &dev_service_id);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+	rte_service_runstate_set(dev_service_id, 1);
+	rte_service_set_runstate_mapped_check(dev_service_id, 0);
+	rte_service_set_runstate_mapped_check(txa_service_id, 0);
+
+	err = rte_event_dev_start(p->dev_id);
+	TEST_ASSERT(err == 0, "Failed to start eventdev err %d", err);
+
+	err = rte_event_eth_tx_adapter_start(TEST_INST_ID);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	err = rte_pktmbuf_alloc_bulk(p->mp, pkts, NUM_PKTS);
+	TEST_ASSERT(err == 0, "Failed to allocate mbufs");
+
+	memset(ev, 0, sizeof(ev));
+	for (i = 0; i < NUM_PKTS; i++) {
+		pkts[i]->port = p->port_id;
+		rte_event_eth_tx_adapter_txq_set(pkts[i], 0);
+		ev[i].op = RTE_EVENT_OP_NEW;
+		ev[i].queue_id = queue_id;
+		ev[i].sched_type = RTE_SCHED_TYPE_ATOMIC;
+		ev[i].flow_id = i;
+		ev[i].mbuf = pkts[i];
+	}
+	/* The last mbuf carries a Tx queue that was not added */
+	rte_event_eth_tx_adapter_txq_set(pkts[NUM_PKTS - 1], 1);
+
+	enq = 0;
+	for (i = 0; i < MAX_SERVICE_ITER && nb_rx < NUM_PKTS - 1; i++) {
+		enq += rte_event_enqueue_burst(p->dev_id, 0, &ev[enq],
+					NUM_PKTS - enq);
+		rte_service_run_iter_on_app_lcore(dev_service_id, 1);
+		rte_service_run_iter_on_app_lcore(txa_service_id, 1);
+		nb_rx += rte_eth_rx_burst(p->port_id, 0, &pkts[nb_rx],
+					NUM_PKTS - nb_rx);
+	}
+	TEST_ASSERT_EQUAL(nb_rx, NUM_PKTS - 1, "Expected %d packets got %d",
+			NUM_PKTS - 1, nb_rx);
+	rte_pktmbuf_free_bulk(pkts, nb_rx);
+
+	err = rte_event_eth_tx_adapter_stats_get(TEST_INST_ID, &stats);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+	TEST_ASSERT_EQUAL(stats.tx_packets, NUM_PKTS - 1,
+			"Expected %d tx packets got %" PRIu64, NUM_PKTS - 1,
+			stats.tx_packets);
+	TEST_ASSERT_EQUAL(stats.tx_dropped, 1,
+			"Expected 1 dropped packet got %" PRIu64,
+			stats.tx_dropped);
+
+	err = rte_event_eth_tx_adapter_stop(TEST_INST_ID);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	rte_event_dev_stop(p->dev_id);
+
+	err = rte_event_eth_tx_adapter_queue_del(TEST_INST_ID, p->port_id, 0);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	return TEST_SUCCESS;
+}
+
+static struct unit_test_suite service_tests  = {
+	.suite_name = "tx event eth adapter test suite",
+	.setup = testsuite_setup,
+	.teardown = testsuite_teardown,
+	.unit_test_cases = {
+		TEST_CASE_ST(eventdev_configure, NULL, adapter_create_free),
+		TEST_CASE_ST(adapter_create, adapter_free,
+					adapter_queue_add_del),
+		TEST_CASE_ST(adapter_create, adapter_free, adapter_start_stop),
+		TEST_CASE_ST(adapter_create, adapter_free, adapter_stats),
+		TEST_CASE_ST(adapter_create, adapter_free, adapter_service),
+		TEST_CASES_END() /**< NULL terminate unit test array */
+	}
+};
+
+static int
+test_event_eth_tx_adapter_common(void)
+{
+	return unit_test_suite_runner(&service_tests);
+}
+
+REGISTER_TEST_COMMAND(event_eth_tx_adapter_autotest,
+		test_event_eth_tx_adapter_common);
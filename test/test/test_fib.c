@@ -0,0 +1,682 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2018 Intel Corporation
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include <rte_cycles.h>
+#include <rte_errno.h>
+#include <rte_ip.h>
+#include <rte_random.h>
+#include <rte_rib.h>
+#include <rte_fib.h>
+
+#include "test.h"
+
+#define MAX_ROUTES	(1 << 16)
+#define MAX_TBL8	(1 << 12)
+#define NUM_RND_ROUTES	2000
+#define NUM_RND_LOOKUPS	(1 << 15)
+
+static const enum rte_fib_dir24_8_nh_sz nh_sizes[] = {
+	RTE_FIB_DIR24_8_1B, RTE_FIB_DIR24_8_2B,
+	RTE_FIB_DIR24_8_4B, RTE_FIB_DIR24_8_8B
+};
+
+static const enum rte_fib_lookup_type lookup_types[] = {
+	RTE_FIB_LOOKUP_DIR24_8_SCALAR, RTE_FIB_LOOKUP_DIR24_8_VECTOR_AVX512
+};
+
+static void
+fill_conf(struct rte_fib_conf *config, enum rte_fib_dir24_8_nh_sz nh_sz)
+{
+	config->type = RTE_FIB_DIR24_8;
+	config->max_routes = MAX_ROUTES;
+	config->default_nh = 7;
+	config->dir24_8.nh_sz = nh_sz;
+	config->dir24_8.num_tbl8 = MAX_TBL8;
+}
+
+/*
+ * Check that rte_fib_create fails gracefully for incorrect user input
+ * arguments
+ */
+static int32_t
+test_create_invalid(void)
+{
+	struct rte_fib *fib = NULL;
+	struct rte_fib_conf config;
+
+	fill_conf(&config, RTE_FIB_DIR24_8_1B);
+
+	/* rte_fib_create: fib name == NULL */
+	fib = rte_fib_create(NULL, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	/* rte_fib_create: config == NULL */
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, NULL);
+	RTE_TEST_ASSERT(fib == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	/* socket_id < -1 is invalid */
+	fib = rte_fib_create(__func__, -2, &config);
+	RTE_TEST_ASSERT(fib == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	/* rte_fib_create: max_routes = 0 */
+	config.max_routes = 0;
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib == NULL,
+		"Call succeeded with invalid parameters\n");
+	config.max_routes = MAX_ROUTES;
+
+	config.type = RTE_FIB_TYPE_MAX;
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	config.type = RTE_FIB_DIR24_8;
+	config.dir24_8.num_tbl8 = 0;
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	/* 1 byte next hops leave room for 127 tbl8 groups only */
+	config.dir24_8.num_tbl8 = 128;
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib == NULL,
+		"Call succeeded with invalid parameters\n");
+	config.dir24_8.num_tbl8 = MAX_TBL8;
+
+	config.dir24_8.nh_sz = RTE_FIB_DIR24_8_8B + 1;
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	/* default next hop larger than the next hop size allows */
+	config.dir24_8.nh_sz = RTE_FIB_DIR24_8_1B;
+	config.dir24_8.num_tbl8 = 127;
+	config.default_nh = 128;
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	return TEST_SUCCESS;
+}
+
+/*
+ * Create fib table then delete fib table 10 times
+ * Use a slightly different rules size each time
+ */
+static int32_t
+test_multiple_create(void)
+{
+	struct rte_fib *fib = NULL;
+	struct rte_fib_conf config;
+	int32_t i;
+
+	fill_conf(&config, RTE_FIB_DIR24_8_2B);
+	config.type = RTE_FIB_DUMMY;
+
+	for (i = 0; i < 10; i++) {
+		config.max_routes = MAX_ROUTES - i;
+		config.type = (i & 1) ? RTE_FIB_DIR24_8 : RTE_FIB_DUMMY;
+		fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+		RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+		RTE_TEST_ASSERT(rte_fib_find_existing(__func__) == fib,
+			"Failed to find FIB\n");
+		rte_fib_free(fib);
+	}
+	RTE_TEST_ASSERT(rte_fib_find_existing(__func__) == NULL,
+		"Found a freed FIB\n");
+
+	/* Can not test free so return success */
+	return TEST_SUCCESS;
+}
+
+/*
+ * Call rte_fib_free for NULL pointer user input. Note: free has no return and
+ * therefore it is impossible to check for failure but this test is added to
+ * increase function coverage metrics and to validate that freeing null does
+ * not crash.
+ */
+static int32_t
+test_free_null(void)
+{
+	struct rte_fib *fib = NULL;
+	struct rte_fib_conf config;
+
+	fill_conf(&config, RTE_FIB_DIR24_8_1B);
+	config.dir24_8.num_tbl8 = 127;
+
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+
+	rte_fib_free(fib);
+	rte_fib_free(NULL);
+	return TEST_SUCCESS;
+}
+
+/*
+ * Check that rte_fib_add and rte_fib_delete fails gracefully
+ * for incorrect user input arguments
+ */
+static int32_t
+test_add_del_invalid(void)
+{
+	struct rte_fib *fib = NULL;
+	struct rte_fib_conf config;
+	uint64_t nh = 100;
+	uint32_t ip = IPv4(0, 0, 0, 0);
+	int ret;
+	uint8_t depth = 24;
+
+	fill_conf(&config, RTE_FIB_DIR24_8_1B);
+	config.dir24_8.num_tbl8 = 127;
+
+	/* rte_fib_add: fib == NULL */
+	ret = rte_fib_add(NULL, ip, depth, nh);
+	RTE_TEST_ASSERT(ret < 0,
+		"Call succeeded with invalid parameters\n");
+
+	/* rte_fib_delete: fib == NULL */
+	ret = rte_fib_delete(NULL, ip, depth);
+	RTE_TEST_ASSERT(ret < 0,
+		"Call succeeded with invalid parameters\n");
+
+	/*Create valid fib to use in rest of test. */
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+
+	/* rte_fib_add: depth > RTE_FIB_MAXDEPTH */
+	ret = rte_fib_add(fib, ip, RTE_FIB_MAXDEPTH + 1, nh);
+	RTE_TEST_ASSERT(ret < 0,
+		"Call succeeded with invalid parameters\n");
+
+	/* rte_fib_delete: depth > RTE_FIB_MAXDEPTH */
+	ret = rte_fib_delete(fib, ip, RTE_FIB_MAXDEPTH + 1);
+	RTE_TEST_ASSERT(ret < 0,
+		"Call succeeded with invalid parameters\n");
+
+	/* rte_fib_add: next hop larger than the next hop size allows */
+	ret = rte_fib_add(fib, ip, depth, 128);
+	RTE_TEST_ASSERT(ret < 0,
+		"Call succeeded with invalid parameters\n");
+
+	/* rte_fib_delete: route does not exist */
+	ret = rte_fib_delete(fib, ip, depth);
+	RTE_TEST_ASSERT(ret == -ENOENT,
+		"Deleted a route which does not exist\n");
+
+	rte_fib_free(fib);
+
+	return TEST_SUCCESS;
+}
+
+/*
+ * Check that rte_fib_get_dp and rte_fib_get_rib fails gracefully
+ * for incorrect user input arguments
+ */
+static int32_t
+test_get_invalid(void)
+{
+	void *p;
+
+	p = rte_fib_get_dp(NULL);
+	RTE_TEST_ASSERT(p == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	p = rte_fib_get_rib(NULL);
+	RTE_TEST_ASSERT(p == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	RTE_TEST_ASSERT(rte_fib_get_lookup_fn(NULL) == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	return TEST_SUCCESS;
+}
+
+/*
+ * Lookup the addresses with every lookup function of the FIB
+ * and compare the results against the expected next hops.
+ */
+static int
+check_lookup(struct rte_fib *fib, uint32_t *ips, uint64_t *expected,
+	unsigned int n)
+{
+	uint64_t *nhs;
+	unsigned int i, j;
+	int ret = TEST_SUCCESS;
+
+	nhs = malloc(n * sizeof(uint64_t));
+	if (nhs == NULL)
+		return TEST_FAILED;
+
+	for (i = 0; i < RTE_DIM(lookup_types); i++) {
+		if (rte_fib_select_lookup(fib, lookup_types[i]) != 0) {
+			/* only the vector lookup may be unsupported */
+			if (lookup_types[i] ==
+					RTE_FIB_LOOKUP_DIR24_8_SCALAR) {
+				ret = TEST_FAILED;
+				break;
+			}
+			continue;
+		}
+		memset(nhs, 0xff, n * sizeof(uint64_t));
+		rte_fib_lookup_bulk(fib, ips, nhs, n);
+		for (j = 0; j < n; j++) {
+			if (nhs[j] != expected[j]) {
+				printf("Lookup type %d: IP %08x returned "
+					"%"PRIu64", expected %"PRIu64"\n",
+					lookup_types[i], ips[j], nhs[j],
+					expected[j]);
+				ret = TEST_FAILED;
+				break;
+			}
+		}
+		if (ret != TEST_SUCCESS)
+			break;
+	}
+
+	rte_fib_select_lookup(fib, RTE_FIB_LOOKUP_DEFAULT);
+	free(nhs);
+	return ret;
+}
+
+#define NUM_CHECKS	17
+
+/*
+ * Add nested routes, some longer than /24, and check the lookup
+ * results after each addition and deletion.
+ */
+static int
+check_nested(enum rte_fib_dir24_8_nh_sz nh_sz)
+{
+	struct rte_fib *fib;
+	struct rte_fib_conf config;
+	uint64_t def = 7;
+	uint64_t nh_a = 10, nh_b = 20, nh_c = 30, nh_d = 40;
+	uint32_t ips[NUM_CHECKS] = {
+		IPv4(10, 0, 0, 0), IPv4(10, 255, 255, 255),
+		IPv4(10, 1, 0, 0), IPv4(10, 1, 255, 255),
+		IPv4(10, 1, 1, 0), IPv4(10, 1, 1, 127),
+		IPv4(10, 1, 1, 128), IPv4(10, 1, 1, 255),
+		IPv4(10, 1, 1, 129), IPv4(10, 1, 1, 130),
+		IPv4(10, 1, 1, 131), IPv4(10, 1, 1, 132),
+		IPv4(9, 255, 255, 255), IPv4(11, 0, 0, 0),
+		IPv4(0, 0, 0, 0), IPv4(255, 255, 255, 255),
+		IPv4(10, 1, 2, 0)
+	};
+	uint64_t exp[NUM_CHECKS];
+	unsigned int i;
+	int ret;
+
+	fill_conf(&config, nh_sz);
+	config.dir24_8.num_tbl8 = 127;
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+
+	for (i = 0; i < NUM_CHECKS; i++)
+		exp[i] = def;
+	ret = check_lookup(fib, ips, exp, NUM_CHECKS);
+	RTE_TEST_ASSERT(ret == TEST_SUCCESS, "Empty FIB lookup failed\n");
+
+	/* 10.0.0.0/8 -> a */
+	ret = rte_fib_add(fib, IPv4(10, 0, 0, 0), 8, nh_a);
+	RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+	for (i = 0; i < 12; i++)
+		exp[i] = nh_a;
+	exp[16] = nh_a;
+	ret = check_lookup(fib, ips, exp, NUM_CHECKS);
+	RTE_TEST_ASSERT(ret == TEST_SUCCESS, "Lookup failed\n");
+
+	/* 10.1.1.128/25 -> c, before its covering route */
+	ret = rte_fib_add(fib, IPv4(10, 1, 1, 128), 25, nh_c);
+	RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+	for (i = 6; i < 12; i++)
+		exp[i] = nh_c;
+	ret = check_lookup(fib, ips, exp, NUM_CHECKS);
+	RTE_TEST_ASSERT(ret == TEST_SUCCESS, "Lookup failed\n");
+
+	/* 10.1.0.0/16 -> b, does not override the /25 */
+	ret = rte_fib_add(fib, IPv4(10, 1, 0, 0), 16, nh_b);
+	RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+	for (i = 2; i < 6; i++)
+		exp[i] = nh_b;
+	exp[16] = nh_b;
+	ret = check_lookup(fib, ips, exp, NUM_CHECKS);
+	RTE_TEST_ASSERT(ret == TEST_SUCCESS, "Lookup failed\n");
+
+	/* 10.1.1.130/31 -> d, inside the /25 */
+	ret = rte_fib_add(fib, IPv4(10, 1, 1, 130), 31, nh_d);
+	RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+	exp[9] = nh_d;
+	exp[10] = nh_d;
+	ret = check_lookup(fib, ips, exp, NUM_CHECKS);
+	RTE_TEST_ASSERT(ret == TEST_SUCCESS, "Lookup failed\n");
+
+	/* default route -> d, then update it to b */
+	ret = rte_fib_add(fib, 0, 0, nh_d);
+	RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+	for (i = 12; i < 16; i++)
+		exp[i] = nh_d;
+	ret = check_lookup(fib, ips, exp, NUM_CHECKS);
+	RTE_TEST_ASSERT(ret == TEST_SUCCESS, "Lookup failed\n");
+	ret = rte_fib_add(fib, 0, 0, nh_b);
+	RTE_TEST_ASSERT(ret == 0, "Failed to update a route\n");
+	for (i = 12; i < 16; i++)
+		exp[i] = nh_b;
+	ret = check_lookup(fib, ips, exp, NUM_CHECKS);
+	RTE_TEST_ASSERT(ret == TEST_SUCCESS, "Lookup failed\n");
+
+	/* delete the /25, its addresses fall back to the /16 */
+	ret = rte_fib_delete(fib, IPv4(10, 1, 1, 128), 25);
+	RTE_TEST_ASSERT(ret == 0, "Failed to delete a route\n");
+	exp[6] = exp[7] = exp[8] = exp[11] = nh_b;
+	ret = check_lookup(fib, ips, exp, NUM_CHECKS);
+	RTE_TEST_ASSERT(ret == TEST_SUCCESS, "Lookup failed\n");
+
+	/* delete the /16 and the /8, only the /31 remains */
+	ret = rte_fib_delete(fib, IPv4(10, 1, 0, 0), 16);
+	RTE_TEST_ASSERT(ret == 0, "Failed to delete a route\n");
+	ret = rte_fib_delete(fib, IPv4(10, 0, 0, 0), 8);
+	RTE_TEST_ASSERT(ret == 0, "Failed to delete a route\n");
+	for (i = 0; i < NUM_CHECKS; i++)
+		exp[i] = nh_b;
+	exp[9] = exp[10] = nh_d;
+	ret = check_lookup(fib, ips, exp, NUM_CHECKS);
+	RTE_TEST_ASSERT(ret == TEST_SUCCESS, "Lookup failed\n");
+
+	ret = rte_fib_delete(fib, IPv4(10, 1, 1, 130), 31);
+	RTE_TEST_ASSERT(ret == 0, "Failed to delete a route\n");
+	ret = rte_fib_delete(fib, 0, 0);
+	RTE_TEST_ASSERT(ret == 0, "Failed to delete a route\n");
+	for (i = 0; i < NUM_CHECKS; i++)
+		exp[i] = def;
+	ret = check_lookup(fib, ips, exp, NUM_CHECKS);
+	RTE_TEST_ASSERT(ret == TEST_SUCCESS, "Lookup failed\n");
+
+	rte_fib_free(fib);
+	return TEST_SUCCESS;
+}
+
+static int32_t
+test_nested(void)
+{
+	unsigned int i;
+	int ret;
+
+	for (i = 0; i < RTE_DIM(nh_sizes); i++) {
+		ret = check_nested(nh_sizes[i]);
+		if (ret != TEST_SUCCESS)
+			return ret;
+	}
+	return TEST_SUCCESS;
+}
+
+/* Check that the tbl8 groups are reserved by /24 prefix */
+static int32_t
+test_tbl8_reserve(void)
+{
+	struct rte_fib *fib;
+	struct rte_fib_conf config;
+	uint32_t i;
+	int ret;
+
+	fill_conf(&config, RTE_FIB_DIR24_8_1B);
+	config.dir24_8.num_tbl8 = 4;
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+
+	/* routes longer than /24 in 4 different /24 prefixes */
+	for (i = 0; i < 4; i++) {
+		ret = rte_fib_add(fib, IPv4(1, 1, i, 0), 25, i + 1);
+		RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+		ret = rte_fib_add(fib, IPv4(1, 1, i, 200), 32, i + 1);
+		RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+	}
+	ret = rte_fib_add(fib, IPv4(1, 1, 4, 0), 26, 1);
+	RTE_TEST_ASSERT(ret == -ENOSPC,
+		"Added a route without any tbl8 group left\n");
+	/* shorter routes do not need any */
+	ret = rte_fib_add(fib, IPv4(1, 1, 4, 0), 24, 1);
+	RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+
+	/* the group is released with the last long route of its /24 */
+	ret = rte_fib_delete(fib, IPv4(1, 1, 0, 0), 25);
+	RTE_TEST_ASSERT(ret == 0, "Failed to delete a route\n");
+	ret = rte_fib_add(fib, IPv4(1, 1, 4, 0), 26, 1);
+	RTE_TEST_ASSERT(ret == -ENOSPC,
+		"Added a route without any tbl8 group left\n");
+	ret = rte_fib_delete(fib, IPv4(1, 1, 0, 200), 32);
+	RTE_TEST_ASSERT(ret == 0, "Failed to delete a route\n");
+	ret = rte_fib_add(fib, IPv4(1, 1, 4, 0), 26, 1);
+	RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+
+	rte_fib_free(fib);
+	return TEST_SUCCESS;
+}
+
+static uint32_t
+rnd_prefix(uint8_t *depth)
+{
+	/* favour the depths around 24 where both tables are involved */
+	static const uint8_t depths[] = {
+		8, 12, 16, 20, 22, 23, 24, 24, 25, 26, 28, 30, 31, 32
+	};
+	/* a small address space to get nested routes */
+	uint32_t ip = IPv4(10, 0, 0, 0) |
+		((uint32_t)rte_rand() & 0x000f0fff);
+
+	*depth = depths[rte_rand() % RTE_DIM(depths)];
+	return ip & rte_rib_depth_to_mask(*depth);
+}
+
+/* Compare FIB lookups with the longest prefix match of its RIB */
+static int
+check_against_rib(struct rte_fib *fib, uint64_t def_nh)
+{
+	struct rte_rib *rib = rte_fib_get_rib(fib);
+	struct rte_rib_node *node;
+	uint32_t *ips;
+	uint64_t *exp;
+	unsigned int i;
+	int ret;
+
+	ips = malloc(NUM_RND_LOOKUPS * sizeof(uint32_t));
+	exp = malloc(NUM_RND_LOOKUPS * sizeof(uint64_t));
+	if ((ips == NULL) || (exp == NULL)) {
+		free(ips);
+		free(exp);
+		return TEST_FAILED;
+	}
+
+	for (i = 0; i < NUM_RND_LOOKUPS; i++) {
+		ips[i] = IPv4(10, 0, 0, 0) |
+			((uint32_t)rte_rand() & 0x000f0fff);
+		/* also hit the addresses around the route edges */
+		if (i & 1)
+			ips[i] ^= (uint32_t)rte_rand() & 0x00f00000;
+		node = rte_rib_lookup(rib, ips[i]);
+		if (node != NULL)
+			rte_rib_get_nh(node, &exp[i]);
+		else
+			exp[i] = def_nh;
+	}
+
+	/* an odd count to exercise the vector lookup tail */
+	ret = check_lookup(fib, ips, exp, NUM_RND_LOOKUPS - 5);
+
+	free(ips);
+	free(exp);
+	return ret;
+}
+
+static int
+check_random(enum rte_fib_dir24_8_nh_sz nh_sz)
+{
+	struct rte_fib *fib;
+	struct rte_fib_conf config;
+	uint32_t ips[NUM_RND_ROUTES];
+	uint8_t depths[NUM_RND_ROUTES];
+	uint64_t max_nh;
+	unsigned int i;
+	int ret;
+
+	fill_conf(&config, nh_sz);
+	if (nh_sz == RTE_FIB_DIR24_8_1B)
+		config.dir24_8.num_tbl8 = 127;
+	max_nh = (nh_sz == RTE_FIB_DIR24_8_1B) ? 127 : 1000;
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+
+	ret = rte_fib_add(fib, 0, 0, 1);
+	RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+	for (i = 0; i < NUM_RND_ROUTES; i++) {
+		ips[i] = rnd_prefix(&depths[i]);
+		ret = rte_fib_add(fib, ips[i], depths[i],
+			rte_rand() % (max_nh + 1));
+		RTE_TEST_ASSERT((ret == 0) || (ret == -ENOSPC),
+			"Failed to add a route\n");
+	}
+	ret = check_against_rib(fib, config.default_nh);
+	RTE_TEST_ASSERT(ret == TEST_SUCCESS, "Lookup failed after adds\n");
+
+	/* delete one half, update the other one */
+	for (i = 0; i < NUM_RND_ROUTES; i++) {
+		if (i & 1)
+			rte_fib_delete(fib, ips[i], depths[i]);
+		else
+			rte_fib_add(fib, ips[i], depths[i],
+				rte_rand() % (max_nh + 1));
+	}
+	ret = check_against_rib(fib, config.default_nh);
+	RTE_TEST_ASSERT(ret == TEST_SUCCESS, "Lookup failed after updates\n");
+
+	for (i = 0; i < NUM_RND_ROUTES; i++)
+		rte_fib_delete(fib, ips[i], depths[i]);
+	ret = rte_fib_delete(fib, 0, 0);
+	RTE_TEST_ASSERT(ret == 0, "Failed to delete a route\n");
+	RTE_TEST_ASSERT(rte_rib_get_nxt(rte_fib_get_rib(fib), 0, 0, NULL,
+		RTE_RIB_GET_NXT_ALL) == NULL, "Routes left in the RIB\n");
+	ret = check_against_rib(fib, config.default_nh);
+	RTE_TEST_ASSERT(ret == TEST_SUCCESS, "Lookup failed after deletes\n");
+
+	/* every tbl8 group has been given back */
+	for (i = 0; i < config.dir24_8.num_tbl8; i++) {
+		ret = rte_fib_add(fib, IPv4(20, i >> 8, i & UINT8_MAX, 0), 25, 1);
+		RTE_TEST_ASSERT(ret == 0, "tbl8 group leaked\n");
+	}
+
+	rte_fib_free(fib);
+	return TEST_SUCCESS;
+}
+
+static int32_t
+test_random(void)
+{
+	unsigned int i;
+	int ret;
+
+	rte_srand(rte_rdtsc());
+	for (i = 0; i < RTE_DIM(nh_sizes); i++) {
+		ret = check_random(nh_sizes[i]);
+		if (ret != TEST_SUCCESS)
+			return ret;
+	}
+	return TEST_SUCCESS;
+}
+
+/*
+ * Check that routes added in bulk, in random order, resolve as in their
+ * RIB, the last next hop of a route given twice being kept
+ */
+static int32_t
+test_add_bulk(void)
+{
+	struct rte_fib *fib;
+	struct rte_fib_conf config;
+	struct rte_rib_node *node;
+	uint32_t ips[NUM_RND_ROUTES + 1];
+	uint8_t depths[NUM_RND_ROUTES + 1];
+	uint64_t next_hops[NUM_RND_ROUTES + 1];
+	uint64_t nh;
+	uint8_t depth;
+	unsigned int i;
+	int ret;
+
+	fill_conf(&config, RTE_FIB_DIR24_8_4B);
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+
+	for (i = 0; i < NUM_RND_ROUTES; i++) {
+		ips[i] = rnd_prefix(&depths[i]);
+		/* host bits are ignored */
+		ips[i] |= (uint32_t)rte_rand() &
+			~rte_rib_depth_to_mask(depths[i]);
+		next_hops[i] = rte_rand() % 1000;
+	}
+	ips[NUM_RND_ROUTES] = ips[0];
+	depths[NUM_RND_ROUTES] = depths[0];
+	next_hops[NUM_RND_ROUTES] = next_hops[0] + 1;
+
+	ret = rte_fib_add_bulk(NULL, ips, depths, next_hops, 1);
+	RTE_TEST_ASSERT(ret < 0, "Call succeeded with invalid parameters\n");
+	depth = depths[1];
+	depths[1] = RTE_FIB_MAXDEPTH + 1;
+	ret = rte_fib_add_bulk(fib, ips, depths, next_hops, 2);
+	RTE_TEST_ASSERT(ret < 0, "Call succeeded with invalid parameters\n");
+	RTE_TEST_ASSERT(rte_rib_get_nxt(rte_fib_get_rib(fib), 0, 0, NULL,
+		RTE_RIB_GET_NXT_ALL) == NULL, "Route added on invalid call\n");
+	depths[1] = depth;
+
+	ret = rte_fib_add_bulk(fib, ips, depths, next_hops,
+		NUM_RND_ROUTES + 1);
+	RTE_TEST_ASSERT(ret == 0, "Failed to add routes\n");
+	ret = check_against_rib(fib, config.default_nh);
+	RTE_TEST_ASSERT(ret == TEST_SUCCESS, "Lookup failed after adds\n");
+
+	node = rte_rib_lookup_exact(rte_fib_get_rib(fib), ips[0] &
+		rte_rib_depth_to_mask(depths[0]), depths[0]);
+	RTE_TEST_ASSERT(node != NULL, "Route not added\n");
+	rte_rib_get_nh(node, &nh);
+	RTE_TEST_ASSERT(nh == next_hops[NUM_RND_ROUTES],
+		"Wrong next hop of a route given twice\n");
+
+	rte_fib_free(fib);
+	return TEST_SUCCESS;
+}
+
+static struct unit_test_suite fib_tests = {
+	.suite_name = "fib autotest",
+	.setup = NULL,
+	.teardown = NULL,
+	.unit_test_cases = {
+	TEST_CASE(test_create_invalid),
+	TEST_CASE(test_multiple_create),
+	TEST_CASE(test_free_null),
+	TEST_CASE(test_add_del_invalid),
+	TEST_CASE(test_get_invalid),
+	TEST_CASE(test_nested),
+	TEST_CASE(test_tbl8_reserve),
+	TEST_CASE(test_random),
+	TEST_CASE(test_add_bulk),
+	TEST_CASES_END()
+	}
+};
+
+/*
+ * Do all unit tests.
+ */
+static int
+test_fib(void)
+{
+	return unit_test_suite_runner(&fib_tests);
+}
+
+REGISTER_TEST_COMMAND(fib_autotest, test_fib);
@@ -0,0 +1,690 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2018 Intel Corporation
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include <rte_cycles.h>
+#include <rte_errno.h>
+#include <rte_memory.h>
+#include <rte_random.h>
+#include <rte_rib6.h>
+#include <rte_fib6.h>
+
+#include "test.h"
+
+#define MAX_ROUTES	(1 << 16)
+#define MAX_TBL8	30000
+#define NUM_RND_ROUTES	2000
+#define NUM_RND_LOOKUPS	(1 << 14)
+
+static const enum rte_fib_trie_nh_sz nh_sizes[] = {
+	RTE_FIB6_TRIE_2B, RTE_FIB6_TRIE_4B, RTE_FIB6_TRIE_8B
+};
+
+static void
+fill_conf(struct rte_fib6_conf *config, enum rte_fib_trie_nh_sz nh_sz)
+{
+	config->type = RTE_FIB6_TRIE;
+	config->max_routes = MAX_ROUTES;
+	config->default_nh = 7;
+	config->trie.nh_sz = nh_sz;
+	config->trie.num_tbl8 = MAX_TBL8;
+}
+
+/* Build an IPv6 address from its eight 16-bit words */
+static void
+set_ip6(uint8_t ip[RTE_FIB6_IPV6_ADDR_SIZE], const uint16_t *words)
+{
+	int i;
+
+	for (i = 0; i < RTE_FIB6_IPV6_ADDR_SIZE / 2; i++) {
+		ip[2 * i] = words[i] >> 8;
+		ip[2 * i + 1] = (uint8_t)words[i];
+	}
+}
+
+/*
+ * Check that rte_fib6_create fails gracefully for incorrect user input
+ * arguments
+ */
+static int32_t
+test_create_invalid(void)
+{
+	struct rte_fib6 *fib = NULL;
+	struct rte_fib6_conf config;
+
+	fill_conf(&config, RTE_FIB6_TRIE_2B);
+
+	/* rte_fib6_create: fib name == NULL */
+	fib = rte_fib6_create(NULL, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	/* rte_fib6_create: config == NULL */
+	fib = rte_fib6_create(__func__, SOCKET_ID_ANY, NULL);
+	RTE_TEST_ASSERT(fib == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	/* socket_id < -1 is invalid */
+	fib = rte_fib6_create(__func__, -2, &config);
+	RTE_TEST_ASSERT(fib == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	/* rte_fib6_create: max_routes = 0 */
+	config.max_routes = 0;
+	fib = rte_fib6_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib == NULL,
+		"Call succeeded with invalid parameters\n");
+	config.max_routes = MAX_ROUTES;
+
+	config.type = RTE_FIB6_TYPE_MAX;
+	fib = rte_fib6_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	config.type = RTE_FIB6_TRIE;
+	config.trie.num_tbl8 = 0;
+	fib = rte_fib6_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	/* 2 bytes next hops leave room for 2^15 - 1 tbl8 groups only */
+	config.trie.num_tbl8 = 1 << 15;
+	fib = rte_fib6_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib == NULL,
+		"Call succeeded with invalid parameters\n");
+	config.trie.num_tbl8 = MAX_TBL8;
+
+	config.trie.nh_sz = RTE_FIB6_TRIE_8B + 1;
+	fib = rte_fib6_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	config.trie.nh_sz = RTE_FIB6_TRIE_2B - 1;
+	fib = rte_fib6_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	/* default next hop larger than the next hop size allows */
+	config.trie.nh_sz = RTE_FIB6_TRIE_2B;
+	config.default_nh = 1 << 15;
+	fib = rte_fib6_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	return TEST_SUCCESS;
+}
+
+/*
+ * Create fib table then delete fib table 10 times
+ * Use a slightly different rules size each time
+ */
+static int32_t
+test_multiple_create(void)
+{
+	struct rte_fib6 *fib = NULL;
+	struct rte_fib6_conf config;
+	int32_t i;
+
+	fill_conf(&config, RTE_FIB6_TRIE_2B);
+
+	for (i = 0; i < 10; i++) {
+		config.max_routes = MAX_ROUTES - i;
+		config.type = (i & 1) ? RTE_FIB6_TRIE : RTE_FIB6_DUMMY;
+		fib = rte_fib6_create(__func__, SOCKET_ID_ANY, &config);
+		RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+		RTE_TEST_ASSERT(rte_fib6_find_existing(__func__) == fib,
+			"Failed to find FIB\n");
+		rte_fib6_free(fib);
+	}
+	RTE_TEST_ASSERT(rte_fib6_find_existing(__func__) == NULL,
+		"Found a freed FIB\n");
+
+	/* Can not test free so return success */
+	return TEST_SUCCESS;
+}
+
+/*
+ * Call rte_fib6_free for NULL pointer user input. Note: free has no return and
+ * therefore it is impossible to check for failure but this test is added to
+ * increase function coverage metrics and to validate that freeing null does
+ * not crash.
+ */
+static int32_t
+test_free_null(void)
+{
+	struct rte_fib6 *fib = NULL;
+	struct rte_fib6_conf config;
+
+	fill_conf(&config, RTE_FIB6_TRIE_2B);
+
+	fib = rte_fib6_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+
+	rte_fib6_free(fib);
+	rte_fib6_free(NULL);
+
+	return TEST_SUCCESS;
+}
+
+/*
+ * Check that rte_fib6_add and rte_fib6_delete fails gracefully
+ * for incorrect user input arguments
+ */
+static int32_t
+test_add_del_invalid(void)
+{
+	struct rte_fib6 *fib = NULL;
+	struct rte_fib6_conf config;
+	uint64_t nh = 100;
+	uint8_t ip[RTE_FIB6_IPV6_ADDR_SIZE] = {0};
+	int ret;
+	uint8_t depth = 24;
+
+	fill_conf(&config, RTE_FIB6_TRIE_2B);
+
+	/* rte_fib6_add: fib == NULL */
+	ret = rte_fib6_add(NULL, ip, depth, nh);
+	RTE_TEST_ASSERT(ret < 0,
+		"Call succeeded with invalid parameters\n");
+
+	/* rte_fib6_delete: fib == NULL */
+	ret = rte_fib6_delete(NULL, ip, depth);
+	RTE_TEST_ASSERT(ret < 0,
+		"Call succeeded with invalid parameters\n");
+
+	/*Create valid fib to use in rest of test. */
+	fib = rte_fib6_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+
+	/* rte_fib6_add: depth > RTE_FIB6_MAXDEPTH */
+	ret = rte_fib6_add(fib, ip, RTE_FIB6_MAXDEPTH + 1, nh);
+	RTE_TEST_ASSERT(ret < 0,
+		"Call succeeded with invalid parameters\n");
+
+	/* rte_fib6_delete: depth > RTE_FIB6_MAXDEPTH */
+	ret = rte_fib6_delete(fib, ip, RTE_FIB6_MAXDEPTH + 1);
+	RTE_TEST_ASSERT(ret < 0,
+		"Call succeeded with invalid parameters\n");
+
+	/* rte_fib6_add: next hop larger than the next hop size allows */
+	ret = rte_fib6_add(fib, ip, depth, 1 << 15);
+	RTE_TEST_ASSERT(ret < 0,
+		"Call succeeded with invalid parameters\n");
+
+	/* rte_fib6_delete: route does not exist */
+	ret = rte_fib6_delete(fib, ip, depth);
+	RTE_TEST_ASSERT(ret == -ENOENT,
+		"Deleted a route which does not exist\n");
+
+	rte_fib6_free(fib);
+
+	return TEST_SUCCESS;
+}
+
+/*
+ * Check that rte_fib6_get_dp and rte_fib6_get_rib fails gracefully
+ * for incorrect user input arguments
+ */
+static int32_t
+test_get_invalid(void)
+{
+	void *p;
+
+	p = rte_fib6_get_dp(NULL);
+	RTE_TEST_ASSERT(p == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	p = rte_fib6_get_rib(NULL);
+	RTE_TEST_ASSERT(p == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	RTE_TEST_ASSERT(rte_fib6_get_lookup_fn(NULL) == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	return TEST_SUCCESS;
+}
+
+/* Lookup the addresses and compare the results with the expected ones */
+static int
+check_lookup(struct rte_fib6 *fib, uint8_t ips[][RTE_FIB6_IPV6_ADDR_SIZE],
+	uint64_t *expected, unsigned int n)
+{
+	uint64_t *nhs;
+	unsigned int i;
+	int ret = TEST_SUCCESS;
+
+	nhs = malloc(n * sizeof(uint64_t));
+	if (nhs == NULL)
+		return TEST_FAILED;
+
+	memset(nhs, 0xff, n * sizeof(uint64_t));
+	rte_fib6_lookup_bulk(fib, ips, nhs, n);
+	for (i = 0; i < n; i++) {
+		if (nhs[i] != expected[i]) {
+			printf("Address %u returned %"PRIu64
+				", expected %"PRIu64"\n",
+				i, nhs[i], expected[i]);
+			ret = TEST_FAILED;
+			break;
+		}
+	}
+
+	free(nhs);
+	return ret;
+}
+
+#define NUM_CHECKS	13
+
+static const uint16_t check_ips[NUM_CHECKS][8] = {
+	{0x2001, 0xdb8, 0, 0, 0, 0, 0, 0},
+	{0x2001, 0xdb8, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff},
+	{0x2001, 0xdb8, 0, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff},
+	{0x2001, 0xdb8, 0, 0, 0x8000, 0, 0, 0},
+	{0x2001, 0xdb8, 0, 0, 0xffff, 0xffff, 0xffff, 0xffff},
+	{0x2001, 0xdb8, 0, 0, 0x7fff, 0xffff, 0xffff, 0xffff},
+	{0x2001, 0xdb8, 0, 0, 0x8000, 0, 0, 2},
+	{0x2001, 0xdb8, 0, 0, 0x8000, 0, 0, 3},
+	{0x2001, 0xdb8, 0, 0, 0x8000, 0, 0, 4},
+	{0x2001, 0xdb7, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff},
+	{0x2001, 0xdb9, 0, 0, 0, 0, 0, 0},
+	{0, 0, 0, 0, 0, 0, 0, 0},
+	{0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff},
+};
+
+/*
+ * Add nested routes, at depths not multiple of 8 and up to /127,
+ * and check the lookup results after each addition and deletion.
+ */
+static int
+check_nested(enum rte_fib_trie_nh_sz nh_sz)
+{
+	struct rte_fib6 *fib;
+	struct rte_fib6_conf config;
+	uint64_t def = 7;
+	uint64_t nh_a = 10, nh_b = 20, nh_c = 30, nh_d = 40;
+	uint8_t ips[NUM_CHECKS][RTE_FIB6_IPV6_ADDR_SIZE];
+	uint8_t r32[RTE_FIB6_IPV6_ADDR_SIZE], r48[RTE_FIB6_IPV6_ADDR_SIZE];
+	uint8_t r65[RTE_FIB6_IPV6_ADDR_SIZE], r127[RTE_FIB6_IPV6_ADDR_SIZE];
+	uint8_t r0[RTE_FIB6_IPV6_ADDR_SIZE] = {0};
+	uint64_t exp[NUM_CHECKS];
+	unsigned int i;
+	int ret;
+
+	for (i = 0; i < NUM_CHECKS; i++)
+		set_ip6(ips[i], check_ips[i]);
+	set_ip6(r32, check_ips[0]);
+	set_ip6(r48, check_ips[0]);
+	set_ip6(r65, check_ips[3]);
+	set_ip6(r127, check_ips[6]);
+
+	fill_conf(&config, nh_sz);
+	fib = rte_fib6_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+
+	for (i = 0; i < NUM_CHECKS; i++)
+		exp[i] = def;
+	ret = check_lookup(fib, ips, exp, NUM_CHECKS);
+	RTE_TEST_ASSERT(ret == TEST_SUCCESS, "Empty FIB lookup failed\n");
+
+	ret = rte_fib6_add(fib, r32, 32, nh_a);
+	RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+	for (i = 0; i < 9; i++)
+		exp[i] = nh_a;
+	ret = check_lookup(fib, ips, exp, NUM_CHECKS);
+	RTE_TEST_ASSERT(ret == TEST_SUCCESS, "Lookup failed\n");
+
+	/* the /65 before its covering /48 */
+	ret = rte_fib6_add(fib, r65, 65, nh_c);
+	RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+	exp[3] = exp[4] = exp[6] = exp[7] = exp[8] = nh_c;
+	ret = check_lookup(fib, ips, exp, NUM_CHECKS);
+	RTE_TEST_ASSERT(ret == TEST_SUCCESS, "Lookup failed\n");
+
+	ret = rte_fib6_add(fib, r48, 48, nh_b);
+	RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+	exp[0] = exp[2] = exp[5] = nh_b;
+	ret = check_lookup(fib, ips, exp, NUM_CHECKS);
+	RTE_TEST_ASSERT(ret == TEST_SUCCESS, "Lookup failed\n");
+
+	ret = rte_fib6_add(fib, r127, 127, nh_d);
+	RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+	exp[6] = exp[7] = nh_d;
+	ret = check_lookup(fib, ips, exp, NUM_CHECKS);
+	RTE_TEST_ASSERT(ret == TEST_SUCCESS, "Lookup failed\n");
+
+	/* default route -> d, then update it to b */
+	ret = rte_fib6_add(fib, r0, 0, nh_d);
+	RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+	for (i = 9; i < NUM_CHECKS; i++)
+		exp[i] = nh_d;
+	ret = check_lookup(fib, ips, exp, NUM_CHECKS);
+	RTE_TEST_ASSERT(ret == TEST_SUCCESS, "Lookup failed\n");
+	ret = rte_fib6_add(fib, r0, 0, nh_b);
+	RTE_TEST_ASSERT(ret == 0, "Failed to update a route\n");
+	for (i = 9; i < NUM_CHECKS; i++)
+		exp[i] = nh_b;
+	ret = check_lookup(fib, ips, exp, NUM_CHECKS);
+	RTE_TEST_ASSERT(ret == TEST_SUCCESS, "Lookup failed\n");
+
+	/* delete the /65, its addresses fall back to the /48 */
+	ret = rte_fib6_delete(fib, r65, 65);
+	RTE_TEST_ASSERT(ret == 0, "Failed to delete a route\n");
+	exp[3] = exp[4] = exp[8] = nh_b;
+	ret = check_lookup(fib, ips, exp, NUM_CHECKS);
+	RTE_TEST_ASSERT(ret == TEST_SUCCESS, "Lookup failed\n");
+
+	/* delete the /48 and the /32, only the /127 remains */
+	ret = rte_fib6_delete(fib, r48, 48);
+	RTE_TEST_ASSERT(ret == 0, "Failed to delete a route\n");
+	ret = rte_fib6_delete(fib, r32, 32);
+	RTE_TEST_ASSERT(ret == 0, "Failed to delete a route\n");
+	for (i = 0; i < NUM_CHECKS; i++)
+		exp[i] = nh_b;
+	exp[6] = exp[7] = nh_d;
+	ret = check_lookup(fib, ips, exp, NUM_CHECKS);
+	RTE_TEST_ASSERT(ret == TEST_SUCCESS, "Lookup failed\n");
+
+	ret = rte_fib6_delete(fib, r127, 127);
+	RTE_TEST_ASSERT(ret == 0, "Failed to delete a route\n");
+	ret = rte_fib6_delete(fib, r0, 0);
+	RTE_TEST_ASSERT(ret == 0, "Failed to delete a route\n");
+	for (i = 0; i < NUM_CHECKS; i++)
+		exp[i] = def;
+	ret = check_lookup(fib, ips, exp, NUM_CHECKS);
+	RTE_TEST_ASSERT(ret == TEST_SUCCESS, "Lookup failed\n");
+
+	rte_fib6_free(fib);
+	return TEST_SUCCESS;
+}
+
+static int32_t
+test_nested(void)
+{
+	unsigned int i;
+	int ret;
+
+	for (i = 0; i < RTE_DIM(nh_sizes); i++) {
+		ret = check_nested(nh_sizes[i]);
+		if (ret != TEST_SUCCESS)
+			return ret;
+	}
+	return TEST_SUCCESS;
+}
+
+/* Check that the tbl8 groups are reserved by route depth */
+static int32_t
+test_tbl8_reserve(void)
+{
+	struct rte_fib6 *fib;
+	struct rte_fib6_conf config;
+	uint8_t ip[RTE_FIB6_IPV6_ADDR_SIZE] = {0x20, 0x01, 0x0d, 0xb8};
+	int ret;
+
+	fill_conf(&config, RTE_FIB6_TRIE_2B);
+	config.trie.num_tbl8 = 5;
+	fib = rte_fib6_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+
+	/* 3 groups for a /48, 2 for a /40 */
+	ret = rte_fib6_add(fib, ip, 48, 1);
+	RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+	ret = rte_fib6_add(fib, ip, 40, 2);
+	RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+	ret = rte_fib6_add(fib, ip, 25, 3);
+	RTE_TEST_ASSERT(ret == -ENOSPC,
+		"Added a route without any tbl8 group left\n");
+	/* shorter routes do not need any */
+	ret = rte_fib6_add(fib, ip, 24, 3);
+	RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+
+	ret = rte_fib6_delete(fib, ip, 40);
+	RTE_TEST_ASSERT(ret == 0, "Failed to delete a route\n");
+	ret = rte_fib6_add(fib, ip, 128, 3);
+	RTE_TEST_ASSERT(ret == -ENOSPC,
+		"Added a route without enough tbl8 groups left\n");
+	ret = rte_fib6_add(fib, ip, 32, 3);
+	RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+
+	rte_fib6_free(fib);
+	return TEST_SUCCESS;
+}
+
+static void
+rnd_prefix(uint8_t ip[RTE_FIB6_IPV6_ADDR_SIZE], uint8_t *depth)
+{
+	static const uint8_t depths[] = {
+		24, 32, 40, 44, 48, 48, 56, 60, 64, 64, 65, 72, 96, 112,
+		120, 127, 128
+	};
+	unsigned int i;
+
+	/* a small address space to get nested routes */
+	ip[0] = 0x20;
+	ip[1] = 0x01;
+	ip[2] = 0x0d;
+	ip[3] = 0xb8 | (rte_rand() & 1);
+	for (i = 4; i < RTE_FIB6_IPV6_ADDR_SIZE; i++)
+		ip[i] = (i & 1) ? rte_rand() : rte_rand() & 0x3;
+
+	*depth = depths[rte_rand() % RTE_DIM(depths)];
+	for (i = 0; i < RTE_FIB6_IPV6_ADDR_SIZE; i++) {
+		if (*depth <= i * 8)
+			ip[i] = 0;
+		else if (*depth < (i + 1) * 8)
+			ip[i] &= (uint8_t)(UINT8_MAX << ((i + 1) * 8 - *depth));
+	}
+}
+
+/* Compare FIB lookups with the longest prefix match of its RIB */
+static int
+check_against_rib(struct rte_fib6 *fib, uint8_t routes[][16],
+	unsigned int nb_routes, uint64_t def_nh)
+{
+	struct rte_rib6 *rib = rte_fib6_get_rib(fib);
+	struct rte_rib6_node *node;
+	uint8_t (*ips)[RTE_FIB6_IPV6_ADDR_SIZE];
+	uint64_t *exp;
+	unsigned int i, j;
+	int ret;
+
+	ips = malloc(NUM_RND_LOOKUPS * RTE_FIB6_IPV6_ADDR_SIZE);
+	exp = malloc(NUM_RND_LOOKUPS * sizeof(uint64_t));
+	if ((ips == NULL) || (exp == NULL)) {
+		free(ips);
+		free(exp);
+		return TEST_FAILED;
+	}
+
+	for (i = 0; i < NUM_RND_LOOKUPS; i++) {
+		/* addresses of a route with random low bits */
+		memcpy(ips[i], routes[rte_rand() % nb_routes],
+			RTE_FIB6_IPV6_ADDR_SIZE);
+		for (j = 1 + rte_rand() % (RTE_FIB6_IPV6_ADDR_SIZE - 1);
+				j < RTE_FIB6_IPV6_ADDR_SIZE; j++)
+			ips[i][j] = rte_rand();
+		node = rte_rib6_lookup(rib, ips[i]);
+		if (node != NULL)
+			rte_rib6_get_nh(node, &exp[i]);
+		else
+			exp[i] = def_nh;
+	}
+
+	ret = check_lookup(fib, ips, exp, NUM_RND_LOOKUPS);
+
+	free(ips);
+	free(exp);
+	return ret;
+}
+
+static int
+check_random(enum rte_fib_trie_nh_sz nh_sz)
+{
+	struct rte_fib6 *fib;
+	struct rte_fib6_conf config;
+	uint8_t ips[NUM_RND_ROUTES][RTE_FIB6_IPV6_ADDR_SIZE];
+	uint8_t depths[NUM_RND_ROUTES];
+	uint8_t ip[RTE_FIB6_IPV6_ADDR_SIZE] = {0};
+	unsigned int i;
+	int ret;
+
+	fill_conf(&config, nh_sz);
+	fib = rte_fib6_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+
+	ret = rte_fib6_add(fib, ip, 0, 1);
+	RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+	for (i = 0; i < NUM_RND_ROUTES; i++) {
+		rnd_prefix(ips[i], &depths[i]);
+		ret = rte_fib6_add(fib, ips[i], depths[i], rte_rand() % 1000);
+		RTE_TEST_ASSERT((ret == 0) || (ret == -ENOSPC),
+			"Failed to add a route\n");
+	}
+	ret = check_against_rib(fib, ips, NUM_RND_ROUTES, config.default_nh);
+	RTE_TEST_ASSERT(ret == TEST_SUCCESS, "Lookup failed after adds\n");
+
+	/* delete one half, update the other one */
+	for (i = 0; i < NUM_RND_ROUTES; i++) {
+		if (i & 1)
+			rte_fib6_delete(fib, ips[i], depths[i]);
+		else
+			rte_fib6_add(fib, ips[i], depths[i],
+				rte_rand() % 1000);
+	}
+	ret = check_against_rib(fib, ips, NUM_RND_ROUTES, config.default_nh);
+	RTE_TEST_ASSERT(ret == TEST_SUCCESS, "Lookup failed after updates\n");
+
+	for (i = 0; i < NUM_RND_ROUTES; i++)
+		rte_fib6_delete(fib, ips[i], depths[i]);
+	ret = rte_fib6_delete(fib, ip, 0);
+	RTE_TEST_ASSERT(ret == 0, "Failed to delete a route\n");
+	RTE_TEST_ASSERT(rte_rib6_get_nxt(rte_fib6_get_rib(fib), ip, 0, NULL,
+		RTE_RIB6_GET_NXT_ALL) == NULL, "Routes left in the RIB\n");
+	ret = check_against_rib(fib, ips, NUM_RND_ROUTES, config.default_nh);
+	RTE_TEST_ASSERT(ret == TEST_SUCCESS, "Lookup failed after deletes\n");
+
+	/*
+	 * every tbl8 group has been given back: /128 routes in distinct
+	 * /24 prefixes use 13 groups each
+	 */
+	for (i = 0; i < MAX_TBL8 / 13; i++) {
+		memset(ip, 0xff, sizeof(ip));
+		ip[0] = 0x30;
+		ip[1] = i >> 8;
+		ip[2] = i;
+		ret = rte_fib6_add(fib, ip, 128, 1);
+		RTE_TEST_ASSERT(ret == 0, "tbl8 group leaked\n");
+	}
+
+	rte_fib6_free(fib);
+	return TEST_SUCCESS;
+}
+
+static int32_t
+test_random(void)
+{
+	unsigned int i;
+	int ret;
+
+	rte_srand(rte_rdtsc());
+	for (i = 0; i < RTE_DIM(nh_sizes); i++) {
+		ret = check_random(nh_sizes[i]);
+		if (ret != TEST_SUCCESS)
+			return ret;
+	}
+	return TEST_SUCCESS;
+}
+
+/*
+ * Check that routes added in bulk, in random order, resolve as in their
+ * RIB6, the last next hop of a route given twice being kept
+ */
+static int32_t
+test_add_bulk(void)
+{
+	struct rte_fib6 *fib;
+	struct rte_fib6_conf config;
+	struct rte_rib6_node *node;
+	uint8_t ips[NUM_RND_ROUTES + 1][RTE_FIB6_IPV6_ADDR_SIZE];
+	uint8_t depths[NUM_RND_ROUTES + 1];
+	uint64_t next_hops[NUM_RND_ROUTES + 1];
+	uint8_t ip[RTE_FIB6_IPV6_ADDR_SIZE] = {0};
+	uint64_t nh;
+	uint8_t depth;
+	unsigned int i;
+	int ret;
+
+	fill_conf(&config, RTE_FIB6_TRIE_4B);
+	fib = rte_fib6_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+
+	for (i = 0; i < NUM_RND_ROUTES; i++) {
+		rnd_prefix(ips[i], &depths[i]);
+		next_hops[i] = rte_rand() % 1000;
+	}
+	memcpy(ips[NUM_RND_ROUTES], ips[0], RTE_FIB6_IPV6_ADDR_SIZE);
+	depths[NUM_RND_ROUTES] = depths[0];
+	next_hops[NUM_RND_ROUTES] = next_hops[0] + 1;
+	/* host bits are ignored */
+	if (depths[NUM_RND_ROUTES] < RTE_FIB6_MAXDEPTH)
+		ips[NUM_RND_ROUTES][RTE_FIB6_IPV6_ADDR_SIZE - 1] |= 1;
+
+	ret = rte_fib6_add_bulk(NULL, ips, depths, next_hops, 1);
+	RTE_TEST_ASSERT(ret < 0, "Call succeeded with invalid parameters\n");
+	depth = depths[1];
+	depths[1] = RTE_FIB6_MAXDEPTH + 1;
+	ret = rte_fib6_add_bulk(fib, ips, depths, next_hops, 2);
+	RTE_TEST_ASSERT(ret < 0, "Call succeeded with invalid parameters\n");
+	RTE_TEST_ASSERT(rte_rib6_get_nxt(rte_fib6_get_rib(fib), ip, 0, NULL,
+		RTE_RIB6_GET_NXT_ALL) == NULL, "Route added on invalid call\n");
+	depths[1] = depth;
+
+	ret = rte_fib6_add_bulk(fib, ips, depths, next_hops,
+		NUM_RND_ROUTES + 1);
+	RTE_TEST_ASSERT(ret == 0, "Failed to add routes\n");
+	ret = check_against_rib(fib, ips, NUM_RND_ROUTES, config.default_nh);
+	RTE_TEST_ASSERT(ret == TEST_SUCCESS, "Lookup failed after adds\n");
+
+	node = rte_rib6_lookup_exact(rte_fib6_get_rib(fib), ips[0], depths[0]);
+	RTE_TEST_ASSERT(node != NULL, "Route not added\n");
+	rte_rib6_get_nh(node, &nh);
+	RTE_TEST_ASSERT(nh == next_hops[NUM_RND_ROUTES],
+		"Wrong next hop of a route given twice\n");
+
+	rte_fib6_free(fib);
+	return TEST_SUCCESS;
+}
+
+static struct unit_test_suite fib6_tests = {
+	.suite_name = "fib6 autotest",
+	.setup = NULL,
+	.teardown = NULL,
+	.unit_test_cases = {
+	TEST_CASE(test_create_invalid),
+	TEST_CASE(test_multiple_create),
+	TEST_CASE(test_free_null),
+	TEST_CASE(test_add_del_invalid),
+	TEST_CASE(test_get_invalid),
+	TEST_CASE(test_nested),
+	TEST_CASE(test_tbl8_reserve),
+	TEST_CASE(test_random),
+	TEST_CASE(test_add_bulk),
+	TEST_CASES_END()
+	}
+};
+
+/*
+ * Do all unit tests.
+ */
+static int
+test_fib6(void)
+{
+	return unit_test_suite_runner(&fib6_tests);
+}
+
+REGISTER_TEST_COMMAND(fib6_autotest, test_fib6);
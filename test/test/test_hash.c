@@ -1148,6 +1148,228 @@ static int test_average_table_utilization(void)
 	return 0;
 }
 
+/*
+ * Extendable buckets test:
+ *	- add keys which all have the same hash, so that most of them only
+ *	  fit in the chain of extendable buckets: all OK
+ *	- lookup and bulk lookup the keys: all hits
+ *	- delete half of the keys, check the others are still found
+ *	- add them back, delete all the keys and check the table is empty
+ *	- fill a table with random keys up to its configured size: all OK
+ */
+#define EXT_TABLE_ENTRIES 64
+static int test_hash_ext_table(void)
+{
+	struct rte_hash_parameters params = {
+		.name = "test_ext_table",
+		.entries = EXT_TABLE_ENTRIES,
+		.key_len = sizeof(uint32_t),
+		.hash_func = pseudo_hash,
+		.hash_func_init_val = 0,
+		.socket_id = 0,
+		.extra_flag = RTE_HASH_EXTRA_FLAGS_EXT_TABLE,
+	};
+	struct rte_hash *handle;
+	uint32_t ext_keys[EXT_TABLE_ENTRIES];
+	const void *key_ptrs[EXT_TABLE_ENTRIES];
+	int32_t pos[EXT_TABLE_ENTRIES];
+	int32_t expected_pos[EXT_TABLE_ENTRIES];
+	uint8_t simple_key[MAX_KEYSIZE];
+	const void *next_key;
+	void *next_data;
+	uint32_t iter = 0;
+	unsigned int i, j;
+	int ret;
+
+	handle = rte_hash_create(&params);
+	RETURN_IF_ERROR(handle == NULL, "hash creation failed");
+
+	for (i = 0; i < EXT_TABLE_ENTRIES; i++) {
+		ext_keys[i] = i;
+		key_ptrs[i] = &ext_keys[i];
+		expected_pos[i] = rte_hash_add_key(handle, &ext_keys[i]);
+		RETURN_IF_ERROR(expected_pos[i] < 0,
+			"failed to add key %u (pos=%d)", i, expected_pos[i]);
+	}
+
+	for (i = 0; i < EXT_TABLE_ENTRIES; i++) {
+		pos[i] = rte_hash_lookup(handle, &ext_keys[i]);
+		RETURN_IF_ERROR(pos[i] != expected_pos[i],
+			"failed to find key %u (pos=%d)", i, pos[i]);
+	}
+
+	ret = rte_hash_lookup_bulk(handle, key_ptrs, EXT_TABLE_ENTRIES, pos);
+	RETURN_IF_ERROR(ret != 0, "bulk lookup failed");
+	for (i = 0; i < EXT_TABLE_ENTRIES; i++)
+		RETURN_IF_ERROR(pos[i] != expected_pos[i],
+			"failed to bulk find key %u (pos=%d)", i, pos[i]);
+
+	/* Delete every other key, emptying slots all along the chain */
+	for (i = 0; i < EXT_TABLE_ENTRIES; i += 2) {
+		pos[i] = rte_hash_del_key(handle, &ext_keys[i]);
+		RETURN_IF_ERROR(pos[i] != expected_pos[i],
+			"failed to delete key %u (pos=%d)", i, pos[i]);
+	}
+
+	for (i = 0; i < EXT_TABLE_ENTRIES; i++) {
+		pos[i] = rte_hash_lookup(handle, &ext_keys[i]);
+		RETURN_IF_ERROR(pos[i] != ((i & 1) ? expected_pos[i] : -ENOENT),
+			"wrong lookup of key %u after deletes (pos=%d)",
+			i, pos[i]);
+	}
+
+	for (i = 0; i < EXT_TABLE_ENTRIES; i += 2) {
+		expected_pos[i] = rte_hash_add_key(handle, &ext_keys[i]);
+		RETURN_IF_ERROR(expected_pos[i] < 0,
+			"failed to add back key %u (pos=%d)",
+			i, expected_pos[i]);
+	}
+
+	for (i = 0; i < EXT_TABLE_ENTRIES; i++) {
+		pos[i] = rte_hash_del_key(handle, &ext_keys[i]);
+		RETURN_IF_ERROR(pos[i] != expected_pos[i],
+			"failed to delete key %u (pos=%d)", i, pos[i]);
+	}
+
+	RETURN_IF_ERROR(rte_hash_iterate(handle, &next_key, &next_data,
+				&iter) != -ENOENT,
+			"table not empty after deleting all keys");
+
+	rte_hash_free(handle);
+
+	/* All the configured entries fit, whatever the collisions */
+	params.name = "test_ext_table_full";
+	params.entries = 1 << 16;
+	params.key_len = 16;
+	params.hash_func = rte_jhash;
+	handle = rte_hash_create(&params);
+	RETURN_IF_ERROR(handle == NULL, "hash creation failed");
+
+	for (j = 0; j < 2; j++) {
+		for (i = 0; i < params.entries; i++) {
+			memset(simple_key, 0, params.key_len);
+			memcpy(simple_key, &i, sizeof(i));
+			simple_key[sizeof(i)] = rte_rand() % 255;
+			ret = rte_hash_add_key(handle, simple_key);
+			RETURN_IF_ERROR(ret < 0,
+				"failed to add key %u of %u (ret=%d)",
+				i, params.entries, ret);
+		}
+		rte_hash_reset(handle);
+	}
+
+	rte_hash_free(handle);
+
+	return 0;
+}
+
+/*
+ * Aging test:
+ *	- add keys, then look up every odd one with lookup and bulk lookup
+ *	- expire the keys not accessed since the lookups began, a few
+ *	  entries at a time: only the even keys are deleted
+ *	- expire the keys not accessed until now: the table is empty
+ *	- expire on a table without aging: error
+ * It runs on a single writer table, then on a multi-writer one.
+ */
+#define AGING_ENTRIES 64
+#define AGING_KEY_LEN 5
+static int test_hash_aging(uint32_t extra_flag)
+{
+	struct rte_hash_parameters params = {
+		.name = "test_aging",
+		.entries = AGING_ENTRIES,
+		.key_len = AGING_KEY_LEN,
+		.hash_func = rte_jhash,
+		.hash_func_init_val = 0,
+		.socket_id = 0,
+		.extra_flag = RTE_HASH_EXTRA_FLAGS_AGING |
+				RTE_HASH_EXTRA_FLAGS_EXT_TABLE | extra_flag,
+	};
+	struct rte_hash *handle;
+	uint8_t keys[AGING_ENTRIES][AGING_KEY_LEN];
+	const void *key_ptrs[AGING_ENTRIES / 4];
+	void *bulk_data[AGING_ENTRIES / 4];
+	int32_t pos[AGING_ENTRIES];
+	void *data[AGING_ENTRIES];
+	const void *next_key;
+	void *next_data;
+	uint64_t hit_mask;
+	uint64_t start;
+	uint32_t iter = 0;
+	unsigned int expired = 0;
+	unsigned int i, n;
+	int ret;
+
+	handle = rte_hash_create(&params);
+	RETURN_IF_ERROR(handle == NULL, "hash creation failed");
+
+	memset(keys, 0, sizeof(keys));
+	for (i = 0; i < AGING_ENTRIES; i++) {
+		memcpy(keys[i], &i, sizeof(i));
+		ret = rte_hash_add_key_data(handle, keys[i],
+				(void *)((uintptr_t)i + 1));
+		RETURN_IF_ERROR(ret < 0, "failed to add key %u (ret=%d)",
+				i, ret);
+	}
+
+	start = rte_rdtsc();
+	for (i = 1, n = 0; i < AGING_ENTRIES; i += 2) {
+		if (i & 2)
+			key_ptrs[n++] = keys[i];
+		else
+			RETURN_IF_ERROR(rte_hash_lookup(handle, keys[i]) < 0,
+				"failed to find key %u", i);
+	}
+	ret = rte_hash_lookup_bulk_data(handle, key_ptrs, n, &hit_mask,
+			bulk_data);
+	RETURN_IF_ERROR(ret != (int)n, "bulk lookup failed (ret=%d)", ret);
+
+	/* Enough small steps to cover the table several times */
+	for (i = 0; i < 64; i++) {
+		ret = rte_hash_expire(handle, start, &iter, 16, pos, data, 8);
+		RETURN_IF_ERROR(ret < 0, "expire failed (ret=%d)", ret);
+		for (n = 0; n < (unsigned int)ret; n++)
+			RETURN_IF_ERROR((((uintptr_t)data[n] - 1) & 1) != 0,
+				"accessed key %u expired",
+				(unsigned int)((uintptr_t)data[n] - 1));
+		expired += ret;
+	}
+	RETURN_IF_ERROR(expired != AGING_ENTRIES / 2,
+			"expired %u keys instead of %u", expired,
+			AGING_ENTRIES / 2);
+
+	for (i = 0; i < AGING_ENTRIES; i++) {
+		ret = rte_hash_lookup(handle, keys[i]);
+		RETURN_IF_ERROR((i & 1) ? ret < 0 : ret != -ENOENT,
+			"wrong lookup of key %u after expiry (ret=%d)", i, ret);
+	}
+
+	ret = rte_hash_expire(handle, rte_rdtsc(), &iter, UINT32_MAX,
+			pos, data, AGING_ENTRIES);
+	RETURN_IF_ERROR(ret != AGING_ENTRIES / 2,
+			"expired %d keys instead of %u", ret,
+			AGING_ENTRIES / 2);
+	iter = 0;
+	RETURN_IF_ERROR(rte_hash_iterate(handle, &next_key, &next_data,
+				&iter) != -ENOENT,
+			"table not empty after expiring all keys");
+
+	rte_hash_free(handle);
+
+	params.name = "test_no_aging";
+	params.extra_flag = 0;
+	handle = rte_hash_create(&params);
+	RETURN_IF_ERROR(handle == NULL, "hash creation failed");
+	iter = 0;
+	RETURN_IF_ERROR(rte_hash_expire(handle, rte_rdtsc(), &iter, 1,
+				pos, data, 1) != -EINVAL,
+			"expire should fail without aging");
+	rte_hash_free(handle);
+
+	return 0;
+}
+
 #define NUM_ENTRIES 256
 static int test_hash_iteration(void)
 {
@@ -1475,6 +1697,12 @@ test_hash(void)
 		return -1;
 	if (test_hash_iteration() < 0)
 		return -1;
+	if (test_hash_ext_table() < 0)
+		return -1;
+	if (test_hash_aging(0) < 0)
+		return -1;
+	if (test_hash_aging(RTE_HASH_EXTRA_FLAGS_MULTI_WRITER_ADD) < 0)
+		return -1;
 
 	run_hash_func_tests();
 
@@ -47,6 +47,23 @@ static rte_atomic64_t ginsertions;
 
 static int use_htm;
 
+/* Lock free reader/writer concurrency test */
+#define RWLF_ENTRIES		(64 * 1024)
+#define RWLF_NB_STABLE_KEYS	(48 * 1024)
+#define RWLF_NB_CHURN_KEYS	(12 * 1024)
+#define RWLF_NB_ROUNDS		16
+#define RWLF_BULK		32
+
+struct {
+	uint32_t *keys;
+	struct rte_hash *h;
+	volatile int writer_done;
+} tbl_rwlf_test_params;
+
+static rte_atomic64_t glookups;
+static rte_atomic64_t glookup_cycles;
+static rte_atomic64_t gmisses;
+
 static int
 test_hash_multiwriter_worker(__attribute__((unused)) void *arg)
 {
@@ -215,6 +232,176 @@ test_hash_multiwriter(void)
 	rte_hash_free(handle);
 	return -1;
 }
+/*
+ * Readers look up the keys which stay in the table during the whole test,
+ * none of them may be missed while the writer moves entries around.
+ */
+static int
+test_hash_rwlf_reader(__attribute__((unused)) void *arg)
+{
+	const void *key_ptrs[RWLF_BULK];
+	int32_t positions[RWLF_BULK];
+	uint64_t lookups = 0, misses = 0;
+	uint64_t begin, cycles;
+	uint32_t i, j;
+
+	begin = rte_rdtsc_precise();
+
+	do {
+		for (i = 0; i < RWLF_NB_STABLE_KEYS; i += RWLF_BULK) {
+			for (j = 0; j < RWLF_BULK; j++) {
+				key_ptrs[j] = &tbl_rwlf_test_params.keys[i + j];
+				if (rte_hash_lookup(tbl_rwlf_test_params.h,
+						key_ptrs[j]) < 0)
+					misses++;
+			}
+
+			rte_hash_lookup_bulk(tbl_rwlf_test_params.h, key_ptrs,
+					RWLF_BULK, positions);
+			for (j = 0; j < RWLF_BULK; j++)
+				if (positions[j] < 0)
+					misses++;
+
+			lookups += 2 * RWLF_BULK;
+		}
+	} while (!tbl_rwlf_test_params.writer_done);
+
+	cycles = rte_rdtsc_precise() - begin;
+	rte_atomic64_add(&glookup_cycles, cycles);
+	rte_atomic64_add(&glookups, lookups);
+	rte_atomic64_add(&gmisses, misses);
+
+	return 0;
+}
+
+/*
+ * The writer fills the table up with extra keys, which forces cuckoo moves
+ * of the stable keys, and removes them again.
+ */
+static int
+test_hash_rwlf_writer(void)
+{
+	const uint32_t *churn = tbl_rwlf_test_params.keys + RWLF_NB_STABLE_KEYS;
+	int32_t pos[RWLF_NB_CHURN_KEYS];
+	uint64_t begin, cycles = 0, ops = 0;
+	uint32_t round, i;
+	int32_t ret;
+
+	for (round = 0; round < RWLF_NB_ROUNDS; round++) {
+		begin = rte_rdtsc_precise();
+		for (i = 0; i < RWLF_NB_CHURN_KEYS; i++)
+			pos[i] = rte_hash_add_key(tbl_rwlf_test_params.h,
+					churn + i);
+
+		for (i = 0; i < RWLF_NB_CHURN_KEYS; i++) {
+			if (pos[i] < 0)
+				continue;
+			ret = rte_hash_del_key(tbl_rwlf_test_params.h,
+					churn + i);
+			if (ret != pos[i]) {
+				printf("deleted key %u at %d, expected %d\n",
+					churn[i], ret, pos[i]);
+				return -1;
+			}
+			/*
+			 * Readers never look up the churn keys, so the slot
+			 * can be reused without waiting for them.
+			 */
+			rte_hash_free_key_with_position(tbl_rwlf_test_params.h,
+					pos[i]);
+		}
+		cycles += rte_rdtsc_precise() - begin;
+		ops += 2 * RWLF_NB_CHURN_KEYS;
+	}
+
+	printf(" cycles per insertion/deletion: %"PRIu64"\n", cycles / ops);
+
+	return 0;
+}
+
+static int
+test_hash_readwrite_lf(void)
+{
+	static unsigned int calledCount = 1;
+	struct rte_hash_parameters hash_params = {
+		.entries = RWLF_ENTRIES,
+		.key_len = sizeof(uint32_t),
+		.hash_func = rte_hash_crc,
+		.hash_func_init_val = 0,
+		.socket_id = rte_socket_id(),
+		.extra_flag = RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY_LF,
+	};
+	struct rte_hash *handle = NULL;
+	char name[RTE_HASH_NAMESIZE];
+	const void *next_key;
+	void *next_data;
+	uint32_t iter = 0, nb_keys = 0;
+	uint32_t *keys;
+	uint32_t i;
+	int ret;
+
+	snprintf(name, sizeof(name), "test_rwlf%u", calledCount++);
+	hash_params.name = name;
+
+	keys = rte_malloc(NULL, sizeof(uint32_t) *
+			(RWLF_NB_STABLE_KEYS + RWLF_NB_CHURN_KEYS), 0);
+	RETURN_IF_ERROR(keys == NULL, "RTE_MALLOC failed");
+
+	handle = rte_hash_create(&hash_params);
+	if (handle == NULL)
+		rte_free(keys);
+	RETURN_IF_ERROR(handle == NULL, "hash creation failed");
+
+	for (i = 0; i < RWLF_NB_STABLE_KEYS + RWLF_NB_CHURN_KEYS; i++)
+		keys[i] = rte_rand();
+	/* Random keys may collide, make them unique */
+	for (i = 0; i < RWLF_NB_STABLE_KEYS + RWLF_NB_CHURN_KEYS; i++)
+		keys[i] = (keys[i] & ~(RWLF_ENTRIES * 2 - 1)) | i;
+
+	for (i = 0; i < RWLF_NB_STABLE_KEYS; i++) {
+		ret = rte_hash_add_key(handle, keys + i);
+		if (ret < 0)
+			rte_free(keys);
+		RETURN_IF_ERROR(ret < 0, "failed to add key %u", i);
+	}
+
+	tbl_rwlf_test_params.keys = keys;
+	tbl_rwlf_test_params.h = handle;
+	tbl_rwlf_test_params.writer_done = 0;
+
+	rte_atomic64_init(&glookups);
+	rte_atomic64_clear(&glookups);
+	rte_atomic64_init(&glookup_cycles);
+	rte_atomic64_clear(&glookup_cycles);
+	rte_atomic64_init(&gmisses);
+	rte_atomic64_clear(&gmisses);
+
+	/* Readers on the slave lcores, writer on the master */
+	rte_eal_mp_remote_launch(test_hash_rwlf_reader, NULL, SKIP_MASTER);
+	ret = test_hash_rwlf_writer();
+	tbl_rwlf_test_params.writer_done = 1;
+	rte_eal_mp_wait_lcore();
+
+	rte_free(keys);
+	RETURN_IF_ERROR(ret < 0, "writer failed");
+	RETURN_IF_ERROR(rte_atomic64_read(&gmisses) != 0,
+			"%"PRId64" lookups of present keys missed",
+			rte_atomic64_read(&gmisses));
+
+	while (rte_hash_iterate(handle, &next_key, &next_data, &iter) >= 0)
+		nb_keys++;
+	RETURN_IF_ERROR(nb_keys != RWLF_NB_STABLE_KEYS,
+			"%u keys in table, expected %u",
+			nb_keys, RWLF_NB_STABLE_KEYS);
+
+	printf("No key missed during lock free concurrent lookups.\n");
+	printf(" cycles per lookup: %"PRId64"\n",
+		rte_atomic64_read(&glookup_cycles) /
+		rte_atomic64_read(&glookups));
+
+	rte_hash_free(handle);
+	return 0;
+}
 
 static int
 test_hash_multiwriter_main(void)
@@ -247,6 +434,10 @@ test_hash_multiwriter_main(void)
 	if (test_hash_multiwriter() < 0)
 		return -1;
 
+	printf("Test lock free reader/writer concurrency\n");
+	if (test_hash_readwrite_lf() < 0)
+		return -1;
+
 	return 0;
 }
 
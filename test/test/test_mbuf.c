@@ -27,6 +27,8 @@
 #include <rte_mbuf.h>
 #include <rte_random.h>
 #include <rte_cycles.h>
+#include <rte_malloc.h>
+#include <rte_errno.h>
 
 #include "test.h"
 
@@ -501,6 +503,146 @@ test_attach_from_different_pool(struct rte_mempool *pktmbuf_pool,
 		rte_pktmbuf_free(clone2);
 	return -1;
 }
+/*
+ * test a pool whose mbufs have pinned external buffers
+ */
+static int
+test_pktmbuf_pinned_extbuf(struct rte_mempool *pktmbuf_pool2)
+{
+	struct rte_pktmbuf_extmem ext_mem, ext_mems[2];
+	struct rte_mempool *pinned_pool = NULL;
+	struct rte_mbuf *m[NB_MBUF];
+	struct rte_mbuf *clone;
+	void *bufs[NB_MBUF];
+	unsigned int i, j;
+	rte_iova_t iova;
+	char *data;
+	int ret = -1;
+
+	ext_mem.elt_size = MBUF_DATA_SIZE;
+	ext_mem.buf_len = NB_MBUF * MBUF_DATA_SIZE;
+	ext_mem.buf_ptr = rte_malloc("test_extmem", ext_mem.buf_len, 0);
+	if (ext_mem.buf_ptr == NULL) {
+		printf("cannot allocate external memory\n");
+		return -1;
+	}
+	ext_mem.buf_iova = rte_malloc_virt2iova(ext_mem.buf_ptr);
+
+	/* the memory must be large enough for all the mbufs */
+	if (rte_pktmbuf_pool_create_extbuf("test_pinned_pool", NB_MBUF + 1,
+			0, 0, MBUF_DATA_SIZE, SOCKET_ID_ANY,
+			&ext_mem, 1) != NULL || rte_errno != EINVAL)
+		GOTO_FAIL("pool with too small external memory created");
+
+	/* an area which can't hold one buffer is rejected, even when the
+	 * next ones are large enough
+	 */
+	ext_mems[0] = ext_mem;
+	ext_mems[0].buf_len = MBUF_DATA_SIZE - 1;
+	ext_mems[1] = ext_mem;
+	if (rte_pktmbuf_pool_create_extbuf("test_pinned_pool", NB_MBUF,
+			0, 0, MBUF_DATA_SIZE, SOCKET_ID_ANY,
+			ext_mems, 2) != NULL || rte_errno != EINVAL)
+		GOTO_FAIL("pool with undersized external memory created");
+	ext_mems[0].buf_len = ext_mem.buf_len;
+	ext_mems[0].buf_ptr = NULL;
+	if (rte_pktmbuf_pool_create_extbuf("test_pinned_pool", NB_MBUF,
+			0, 0, MBUF_DATA_SIZE, SOCKET_ID_ANY,
+			ext_mems, 2) != NULL || rte_errno != EINVAL)
+		GOTO_FAIL("pool with NULL external memory created");
+
+	pinned_pool = rte_pktmbuf_pool_create_extbuf("test_pinned_pool",
+		NB_MBUF, 32, 0, MBUF_DATA_SIZE, SOCKET_ID_ANY, &ext_mem, 1);
+	if (pinned_pool == NULL)
+		GOTO_FAIL("cannot create pool with pinned external buffers");
+	if (!(rte_pktmbuf_priv_flags(pinned_pool) &
+			RTE_PKTMBUF_POOL_F_PINNED_EXT_BUF))
+		GOTO_FAIL("pinned external buffer flag not set");
+
+	/* the buffers are in the external memory, and stay pinned */
+	for (i = 0; i != NB_MBUF; i++) {
+		m[i] = rte_pktmbuf_alloc(pinned_pool);
+		if (m[i] == NULL)
+			GOTO_FAIL("rte_pktmbuf_alloc() failed (%u)", i);
+		bufs[i] = m[i]->buf_addr;
+		iova = ext_mem.buf_iova;
+		if (iova != RTE_BAD_IOVA)
+			iova += RTE_PTR_DIFF(m[i]->buf_addr, ext_mem.buf_ptr);
+		if (!RTE_MBUF_HAS_EXTBUF(m[i]) ||
+				!RTE_MBUF_HAS_PINNED_EXTBUF(m[i]) ||
+				m[i]->buf_addr < ext_mem.buf_ptr ||
+				RTE_PTR_DIFF(m[i]->buf_addr, ext_mem.buf_ptr) >=
+					ext_mem.buf_len ||
+				m[i]->buf_iova != iova ||
+				m[i]->buf_len != MBUF_DATA_SIZE ||
+				m[i]->data_off != RTE_PKTMBUF_HEADROOM)
+			GOTO_FAIL("bad pinned external buffer (%u)", i);
+
+		data = rte_pktmbuf_append(m[i], MBUF_TEST_DATA_LEN);
+		if (data == NULL)
+			GOTO_FAIL("cannot append data");
+		memset(data, 0x66, MBUF_TEST_DATA_LEN);
+		m[i]->ol_flags |= PKT_RX_VLAN;
+	}
+	rte_pktmbuf_free_bulk(m, NB_MBUF);
+	if (rte_mempool_avail_count(pinned_pool) != NB_MBUF)
+		GOTO_FAIL("pinned mbufs not freed");
+
+	rte_mempool_cache_flush(NULL, pinned_pool);
+	if (rte_pktmbuf_alloc_bulk(pinned_pool, m, NB_MBUF) != 0)
+		GOTO_FAIL("rte_pktmbuf_alloc_bulk() failed");
+	for (i = 0; i != NB_MBUF; i++) {
+		if (m[i]->ol_flags != EXT_ATTACHED_MBUF ||
+				m[i]->data_len != 0 ||
+				m[i]->data_off != RTE_PKTMBUF_HEADROOM ||
+				RTE_PTR_DIFF(m[i]->buf_addr, ext_mem.buf_ptr) %
+					MBUF_DATA_SIZE != 0)
+			GOTO_FAIL("pinned mbuf not reset (%u)", i);
+	}
+	rte_pktmbuf_free_bulk(m, NB_MBUF);
+
+	/* a shared buffer returns to the pool with its last reference */
+	m[0] = rte_pktmbuf_alloc(pinned_pool);
+	if (m[0] == NULL)
+		GOTO_FAIL("rte_pktmbuf_alloc() failed");
+	if (rte_pktmbuf_append(m[0], MBUF_TEST_DATA_LEN) == NULL)
+		GOTO_FAIL("cannot append data");
+	clone = rte_pktmbuf_clone(m[0], pktmbuf_pool2);
+	if (clone == NULL)
+		GOTO_FAIL("cannot clone pinned mbuf");
+	if (clone->buf_addr != m[0]->buf_addr ||
+			rte_mbuf_ext_refcnt_read(m[0]->shinfo) != 2)
+		GOTO_FAIL("bad clone of pinned mbuf");
+
+	rte_pktmbuf_free(m[0]);
+	if (rte_mempool_avail_count(pinned_pool) != NB_MBUF - 1)
+		GOTO_FAIL("shared pinned mbuf freed");
+	rte_pktmbuf_free(clone);
+	if (rte_mempool_avail_count(pinned_pool) != NB_MBUF ||
+			rte_mempool_avail_count(pktmbuf_pool2) != NB_MBUF)
+		GOTO_FAIL("shared pinned mbuf not freed");
+
+	/* the buffers are still the same */
+	rte_mempool_cache_flush(NULL, pinned_pool);
+	if (rte_pktmbuf_alloc_bulk(pinned_pool, m, NB_MBUF) != 0)
+		GOTO_FAIL("rte_pktmbuf_alloc_bulk() failed (2)");
+	for (i = 0; i != NB_MBUF; i++) {
+		for (j = 0; j != NB_MBUF && bufs[j] != m[i]->buf_addr; j++)
+			;
+		if (j == NB_MBUF ||
+				rte_mbuf_ext_refcnt_read(m[i]->shinfo) != 1 ||
+				m[i]->shinfo->fcb_opaque != m[i])
+			GOTO_FAIL("bad pinned external buffer (%u)", i);
+	}
+	rte_pktmbuf_free_bulk(m, NB_MBUF);
+
+	ret = 0;
+fail:
+	rte_mempool_free(pinned_pool);
+	rte_free(ext_mem.buf_ptr);
+	return ret;
+}
+
 #undef GOTO_FAIL
 
 /*
@@ -600,6 +742,90 @@ test_pktmbuf_pool_ptr(struct rte_mempool *pktmbuf_pool)
 	return ret;
 }
 
+/*
+ * test that bulk allocation resets the mbufs and that bulk free returns
+ * all the segments to their pools
+ */
+static int
+test_pktmbuf_bulk(struct rte_mempool *pktmbuf_pool,
+	struct rte_mempool *pktmbuf_pool2)
+{
+	struct rte_mbuf *m[NB_MBUF];
+	struct rte_mbuf *extra[2];
+	struct rte_mbuf *mb;
+	unsigned int i;
+
+	/* alloc all the mbufs and write in the fields reset on alloc */
+	rte_mempool_cache_flush(NULL, pktmbuf_pool);
+	if (rte_pktmbuf_alloc_bulk(pktmbuf_pool, m, NB_MBUF) != 0) {
+		printf("rte_pktmbuf_alloc_bulk() failed\n");
+		return -1;
+	}
+	for (i = 0; i != NB_MBUF; i++) {
+		mb = m[i];
+		mb->data_off = 0;
+		mb->port = 1;
+		mb->ol_flags = PKT_RX_VLAN;
+		mb->packet_type = RTE_PTYPE_L2_ETHER;
+		mb->pkt_len = MBUF_TEST_DATA_LEN;
+		mb->data_len = MBUF_TEST_DATA_LEN;
+		mb->vlan_tci = 1;
+		mb->vlan_tci_outer = 1;
+		mb->tx_offload = UINT64_MAX;
+	}
+	rte_pktmbuf_free_bulk(m, NB_MBUF);
+	if (rte_mempool_avail_count(pktmbuf_pool) != NB_MBUF) {
+		printf("rte_pktmbuf_free_bulk() did not free all mbufs\n");
+		return -1;
+	}
+
+	/* the same mbufs are allocated again, with default values */
+	rte_mempool_cache_flush(NULL, pktmbuf_pool);
+	if (rte_pktmbuf_alloc_bulk(pktmbuf_pool, m, NB_MBUF) != 0) {
+		printf("rte_pktmbuf_alloc_bulk() failed (2)\n");
+		return -1;
+	}
+	for (i = 0; i != NB_MBUF; i++) {
+		mb = m[i];
+		if (mb->data_off != RTE_PKTMBUF_HEADROOM ||
+				rte_mbuf_refcnt_read(mb) != 1 ||
+				mb->nb_segs != 1 || mb->next != NULL ||
+				mb->port != MBUF_INVALID_PORT ||
+				mb->ol_flags != 0 || mb->packet_type != 0 ||
+				mb->pkt_len != 0 || mb->data_len != 0 ||
+				mb->vlan_tci != 0 || mb->vlan_tci_outer != 0 ||
+				mb->tx_offload != 0) {
+			printf("mbuf %u not reset by rte_pktmbuf_alloc_bulk()\n",
+				i);
+			rte_pktmbuf_free_bulk(m, NB_MBUF);
+			return -1;
+		}
+	}
+
+	/* chained segments, indirect mbufs of another pool and NULL */
+	if (rte_pktmbuf_chain(m[0], m[1]) != 0) {
+		printf("rte_pktmbuf_chain() failed\n");
+		rte_pktmbuf_free_bulk(m, NB_MBUF);
+		return -1;
+	}
+	m[1] = rte_pktmbuf_clone(m[2], pktmbuf_pool2);
+	extra[0] = m[3];
+	extra[1] = m[4];
+	m[3] = NULL;
+	m[4] = rte_pktmbuf_clone(m[0], pktmbuf_pool2);
+	rte_pktmbuf_free_bulk(m, NB_MBUF);
+
+	if (rte_mempool_avail_count(pktmbuf_pool) != NB_MBUF - 2 ||
+			rte_mempool_avail_count(pktmbuf_pool2) != NB_MBUF) {
+		printf("rte_pktmbuf_free_bulk() did not free all segments\n");
+		rte_pktmbuf_free_bulk(extra, RTE_DIM(extra));
+		return -1;
+	}
+	rte_pktmbuf_free_bulk(extra, RTE_DIM(extra));
+
+	return 0;
+}
+
 static int
 test_pktmbuf_free_segment(struct rte_mempool *pktmbuf_pool)
 {
@@ -1096,6 +1322,18 @@ test_mbuf(void)
 		goto err;
 	}
 
+	/* test bulk alloc reset and bulk free */
+	if (test_pktmbuf_bulk(pktmbuf_pool, pktmbuf_pool2) < 0) {
+		printf("test_pktmbuf_bulk() failed\n");
+		goto err;
+	}
+
+	/* test pool with pinned external buffers */
+	if (test_pktmbuf_pinned_extbuf(pktmbuf_pool2) < 0) {
+		printf("test_pktmbuf_pinned_extbuf() failed\n");
+		goto err;
+	}
+
 	/* test free pktmbuf segment one by one */
 	if (test_pktmbuf_free_segment(pktmbuf_pool) < 0) {
 		printf("test_pktmbuf_free_segment() failed.\n");
@@ -9,6 +9,7 @@
 #include <inttypes.h>
 #include <stdarg.h>
 #include <errno.h>
+#include <pthread.h>
 #include <sys/queue.h>
 
 #include <rte_common.h>
@@ -447,6 +448,191 @@ test_mempool_same_name_twice_creation(void)
 	return 0;
 }
 
+#define ADAPTIVE_POOL_SIZE	4096
+#define ADAPTIVE_PUT_BURST	RTE_MEMPOOL_CACHE_MAX_SIZE
+#define ADAPTIVE_GET_BURST	64
+
+/*
+ * Check that an adaptive cache shrinks when it seldom goes to the common
+ * pool, and grows back when it often does.
+ */
+static int
+test_mempool_cache_adaptive(struct rte_mempool *mp_nocache)
+{
+	static void *objs[ADAPTIVE_PUT_BURST];
+	struct rte_mempool_cache_stats stats, sum;
+	struct rte_mempool_cache *cache;
+	struct rte_mempool *mp;
+	unsigned int i, j, lcore_id;
+	void *obj;
+	int ret = 0;
+
+	mp = rte_mempool_create("test_cache_adaptive", ADAPTIVE_POOL_SIZE,
+		MEMPOOL_ELT_SIZE, RTE_MEMPOOL_CACHE_MAX_SIZE, 0,
+		NULL, NULL, NULL, NULL,
+		SOCKET_ID_ANY, MEMPOOL_F_CACHE_ADAPTIVE);
+	if (mp == NULL)
+		RET_ERR();
+
+	lcore_id = rte_lcore_id();
+	cache = rte_mempool_default_cache(mp, lcore_id);
+	if (cache == NULL || cache->size != RTE_MEMPOOL_CACHE_MAX_SIZE ||
+			cache->min_size == 0 ||
+			cache->min_size > cache->max_size)
+		GOTO_ERR(ret, out);
+
+	/*
+	 * Mostly served from the cache, with a flush from time to time:
+	 * the cache shrinks down to its min size.
+	 */
+	for (i = 0; cache->size != cache->min_size; i++) {
+		if (i == 8)
+			GOTO_ERR(ret, out);
+
+		for (j = 0; j != 300; j++) {
+			if (rte_mempool_get(mp, &obj) < 0)
+				GOTO_ERR(ret, out);
+			rte_mempool_put(mp, obj);
+		}
+
+		if (rte_mempool_generic_get(mp, objs, RTE_DIM(objs),
+				NULL) < 0)
+			GOTO_ERR(ret, out);
+		rte_mempool_generic_put(mp, objs, RTE_DIM(objs), cache);
+	}
+
+	if (cache->stats.shrink != i || cache->len > cache->flushthresh)
+		GOTO_ERR(ret, out);
+
+	/* Gets bigger than the cache: the cache grows up to its max size. */
+	for (i = 0; cache->size != cache->max_size; i++) {
+		if (i == 16)
+			GOTO_ERR(ret, out);
+
+		if (rte_mempool_get_bulk(mp, objs, ADAPTIVE_GET_BURST) < 0)
+			GOTO_ERR(ret, out);
+		rte_mempool_generic_put(mp, objs, ADAPTIVE_GET_BURST, NULL);
+	}
+
+	if (cache->stats.grow == 0)
+		GOTO_ERR(ret, out);
+
+	/* per-lcore and total statistics */
+	if (rte_mempool_cache_stats_get(mp, lcore_id, &stats) != 0 ||
+			rte_mempool_cache_stats_get(mp, LCORE_ID_ANY,
+				&sum) != 0 ||
+			memcmp(&stats, &cache->stats, sizeof(stats)) != 0 ||
+			memcmp(&stats, &sum, sizeof(stats)) != 0 ||
+			stats.get_hit == 0 || stats.get_miss == 0 ||
+			stats.put_hit == 0 || stats.put_flush == 0)
+		GOTO_ERR(ret, out);
+
+	if (rte_mempool_cache_stats_get(mp, RTE_MAX_LCORE, &stats) !=
+			-EINVAL ||
+			rte_mempool_cache_stats_get(mp_nocache, lcore_id,
+				&stats) != -ENOENT)
+		GOTO_ERR(ret, out);
+
+	rte_mempool_dump(stdout, mp);
+
+out:
+	rte_mempool_free(mp);
+	return ret;
+}
+
+#define THREAD_CACHE_BURST 32
+
+struct thread_cache_arg {
+	struct rte_mempool *mp;
+	struct rte_mempool_cache *cache; /* NULL to let the library create it */
+};
+
+/*
+ * Non-EAL thread registering a cache: the usual get/put functions use it,
+ * and it is flushed either on unregister or on thread exit.
+ */
+static void *
+thread_cache_test(void *arg)
+{
+	struct thread_cache_arg *tca = arg;
+	struct rte_mempool *mp = tca->mp;
+	struct rte_mempool_cache *cache;
+	void *objs[THREAD_CACHE_BURST];
+	unsigned int i;
+	intptr_t ret = 0;
+
+	if (rte_mempool_default_cache(mp, rte_lcore_id()) != NULL)
+		GOTO_ERR(ret, out);
+
+	if (rte_mempool_thread_cache_register(mp, tca->cache) != 0 ||
+			rte_mempool_thread_cache_register(mp, tca->cache) !=
+				-EEXIST)
+		GOTO_ERR(ret, out);
+
+	cache = rte_mempool_default_cache(mp, rte_lcore_id());
+	if (cache == NULL || (tca->cache != NULL && cache != tca->cache))
+		GOTO_ERR(ret, out);
+
+	if (rte_mempool_get_bulk(mp, objs, RTE_DIM(objs)) < 0)
+		GOTO_ERR(ret, out);
+	for (i = 0; i != RTE_DIM(objs); i++)
+		rte_mempool_put(mp, objs[i]);
+
+	/* the objects put back stay in the thread cache */
+	if (cache->len == 0 ||
+			rte_mempool_ops_get_count(mp) + cache->len != mp->size)
+		GOTO_ERR(ret, out);
+
+	/* a library created cache is flushed when the thread exits */
+	if (tca->cache == NULL)
+		goto out;
+
+	if (rte_mempool_thread_cache_unregister(mp) != 0 ||
+			rte_mempool_thread_cache_unregister(mp) != -ENOENT ||
+			cache->len != 0 ||
+			rte_mempool_ops_get_count(mp) != mp->size ||
+			rte_mempool_default_cache(mp, rte_lcore_id()) != NULL)
+		GOTO_ERR(ret, out);
+
+out:
+	return (void *)ret;
+}
+
+static int
+test_mempool_thread_cache(struct rte_mempool *mp)
+{
+	struct thread_cache_arg tca;
+	pthread_t thread;
+	void *thread_ret;
+	int ret = 0;
+
+	/* EAL threads have per-lcore caches */
+	if (rte_mempool_thread_cache_register(mp, NULL) != -EINVAL)
+		RET_ERR();
+
+	tca.mp = mp;
+	tca.cache = NULL;
+	if (pthread_create(&thread, NULL, thread_cache_test, &tca) != 0 ||
+			pthread_join(thread, &thread_ret) != 0 ||
+			thread_ret != NULL ||
+			rte_mempool_ops_get_count(mp) != mp->size)
+		RET_ERR();
+
+	tca.cache = rte_mempool_cache_create(RTE_MEMPOOL_CACHE_MAX_SIZE,
+		SOCKET_ID_ANY);
+	if (tca.cache == NULL)
+		RET_ERR();
+
+	if (pthread_create(&thread, NULL, thread_cache_test, &tca) != 0 ||
+			pthread_join(thread, &thread_ret) != 0 ||
+			thread_ret != NULL)
+		GOTO_ERR(ret, out);
+
+out:
+	rte_mempool_cache_free(tca.cache);
+	return ret;
+}
+
 static void
 walk_cb(struct rte_mempool *mp, void *userdata __rte_unused)
 {
@@ -460,6 +646,7 @@ test_mempool(void)
 	struct rte_mempool *mp_cache = NULL;
 	struct rte_mempool *mp_nocache = NULL;
 	struct rte_mempool *mp_stack = NULL;
+	struct rte_mempool *mp_lf_stack = NULL;
 	struct rte_mempool *default_pool = NULL;
 	const char *default_pool_ops = rte_mbuf_best_mempool_ops();
 
@@ -511,6 +698,29 @@ test_mempool(void)
 	}
 	rte_mempool_obj_iter(mp_stack, my_obj_init, NULL);
 
+#ifdef RTE_ARCH_X86_64
+	/* create a mempool with the lock-free stack handler */
+	mp_lf_stack = rte_mempool_create_empty("test_lf_stack",
+		MEMPOOL_SIZE,
+		MEMPOOL_ELT_SIZE,
+		RTE_MEMPOOL_CACHE_MAX_SIZE, 0,
+		SOCKET_ID_ANY, 0);
+
+	if (mp_lf_stack == NULL) {
+		printf("cannot allocate mp_lf_stack mempool\n");
+		goto err;
+	}
+	if (rte_mempool_set_ops_byname(mp_lf_stack, "lf_stack", NULL) < 0) {
+		printf("cannot set lf_stack handler\n");
+		goto err;
+	}
+	if (rte_mempool_populate_default(mp_lf_stack) < 0) {
+		printf("cannot populate mp_lf_stack mempool\n");
+		goto err;
+	}
+	rte_mempool_obj_iter(mp_lf_stack, my_obj_init, NULL);
+#endif
+
 	/* Create a mempool based on Default handler */
 	printf("Testing %s mempool handler\n", default_pool_ops);
 	default_pool = rte_mempool_create_empty("default_pool",
@@ -571,10 +781,24 @@ test_mempool(void)
 	if (test_mempool_same_name_twice_creation() < 0)
 		goto err;
 
+	/* adaptive per-lcore cache */
+	if (test_mempool_cache_adaptive(mp_nocache) < 0)
+		goto err;
+
+	/* cache registered by a non-EAL thread */
+	if (test_mempool_thread_cache(mp_nocache) < 0)
+		goto err;
+
 	/* test the stack handler */
 	if (test_mempool_basic(mp_stack, 1) < 0)
 		goto err;
 
+#ifdef RTE_ARCH_X86_64
+	/* test the lock-free stack handler */
+	if (test_mempool_basic(mp_lf_stack, 1) < 0)
+		goto err;
+#endif
+
 	if (test_mempool_basic(default_pool, 1) < 0)
 		goto err;
 
@@ -586,6 +810,7 @@ test_mempool(void)
 	rte_mempool_free(mp_nocache);
 	rte_mempool_free(mp_cache);
 	rte_mempool_free(mp_stack);
+	rte_mempool_free(mp_lf_stack);
 	rte_mempool_free(default_pool);
 
 	return ret;
@@ -9,6 +9,7 @@
 #include <inttypes.h>
 #include <stdarg.h>
 #include <errno.h>
+#include <pthread.h>
 #include <sys/queue.h>
 
 #include <rte_common.h>
@@ -51,6 +52,8 @@
  *      - One core with user-owned cache
  *      - Two cores with user-owned cache
  *      - Max. cores with user-owned cache
+ *      - One, two and max. non-EAL threads, without cache, for the
+ *        ring, stack and lock-free stack handlers
  *
  *    - Bulk size (*n_get_bulk*, *n_put_bulk*)
  *
@@ -81,6 +84,7 @@
 	} while (0)
 
 static int use_external_cache;
+static int use_non_eal_threads;
 static unsigned external_cache_size = RTE_MEMPOOL_CACHE_MAX_SIZE;
 
 static rte_atomic32_t synchro;
@@ -112,12 +116,15 @@ my_obj_init(struct rte_mempool *mp, __attribute__((unused)) void *arg,
 	*objnum = i;
 }
 
+/*
+ * Run the test loop, counting the enqueues into stats[id].
+ * Non-EAL threads have no default cache.
+ */
 static int
-per_lcore_mempool_test(void *arg)
+mempool_perf_loop(struct rte_mempool *mp, unsigned int id, int wait)
 {
 	void *obj_table[MAX_KEEP];
 	unsigned i, idx;
-	struct rte_mempool *mp = arg;
 	unsigned lcore_id = rte_lcore_id();
 	int ret = 0;
 	uint64_t start_cycles, end_cycles;
@@ -141,10 +148,10 @@ per_lcore_mempool_test(void *arg)
 	if (((n_keep / n_put_bulk) * n_put_bulk) != n_keep)
 		GOTO_ERR(ret, out);
 
-	stats[lcore_id].enq_count = 0;
+	stats[id].enq_count = 0;
 
 	/* wait synchro for slaves */
-	if (lcore_id != rte_get_master_lcore())
+	if (wait)
 		while (rte_atomic32_read(&synchro) == 0);
 
 	start_cycles = rte_get_timer_cycles();
@@ -177,7 +184,7 @@ per_lcore_mempool_test(void *arg)
 		}
 		end_cycles = rte_get_timer_cycles();
 		time_diff = end_cycles - start_cycles;
-		stats[lcore_id].enq_count += N;
+		stats[id].enq_count += N;
 	}
 
 out:
@@ -189,6 +196,63 @@ per_lcore_mempool_test(void *arg)
 	return ret;
 }
 
+static int
+per_lcore_mempool_test(void *arg)
+{
+	unsigned int lcore_id = rte_lcore_id();
+
+	return mempool_perf_loop(arg, lcore_id,
+		lcore_id != rte_get_master_lcore());
+}
+
+struct non_eal_thread_arg {
+	struct rte_mempool *mp;
+	unsigned int id;
+	int ret;
+};
+
+static void *
+non_eal_thread_test(void *arg)
+{
+	struct non_eal_thread_arg *ta = arg;
+
+	ta->ret = mempool_perf_loop(ta->mp, ta->id, 1);
+	return NULL;
+}
+
+/* launch the test on non-EAL threads, waiting for their completion */
+static int
+launch_non_eal_threads(struct rte_mempool *mp, unsigned int threads)
+{
+	pthread_t tid[RTE_MAX_LCORE];
+	struct non_eal_thread_arg args[RTE_MAX_LCORE];
+	unsigned int i, n;
+	int ret = 0;
+
+	for (n = 0; n != threads; n++) {
+		args[n].mp = mp;
+		args[n].id = n;
+		args[n].ret = 0;
+		if (pthread_create(&tid[n], NULL, non_eal_thread_test,
+				&args[n]) != 0) {
+			printf("cannot create non-EAL thread\n");
+			ret = -1;
+			break;
+		}
+	}
+
+	/* start synchro, even on failure so that threads complete */
+	rte_atomic32_set(&synchro, 1);
+
+	for (i = 0; i != n; i++) {
+		pthread_join(tid[i], NULL);
+		if (args[i].ret < 0)
+			ret = -1;
+	}
+
+	return ret;
+}
+
 /* launch all the per-lcore test, and display the result */
 static int
 launch_cores(struct rte_mempool *mp, unsigned int cores)
@@ -203,10 +267,11 @@ launch_cores(struct rte_mempool *mp, unsigned int cores)
 	/* reset stats */
 	memset(stats, 0, sizeof(stats));
 
-	printf("mempool_autotest cache=%u cores=%u n_get_bulk=%u "
+	printf("mempool_autotest cache=%u %s=%u n_get_bulk=%u "
 	       "n_put_bulk=%u n_keep=%u ",
 	       use_external_cache ?
 		   external_cache_size : (unsigned) mp->cache_size,
+	       use_non_eal_threads ? "threads" : "cores",
 	       cores, n_get_bulk, n_put_bulk, n_keep);
 
 	if (rte_mempool_avail_count(mp) != MEMPOOL_SIZE) {
@@ -214,26 +279,30 @@ launch_cores(struct rte_mempool *mp, unsigned int cores)
 		return -1;
 	}
 
-	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
-		if (cores == 1)
-			break;
-		cores--;
-		rte_eal_remote_launch(per_lcore_mempool_test,
-				      mp, lcore_id);
-	}
+	if (use_non_eal_threads) {
+		ret = launch_non_eal_threads(mp, cores);
+	} else {
+		RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+			if (cores == 1)
+				break;
+			cores--;
+			rte_eal_remote_launch(per_lcore_mempool_test,
+					      mp, lcore_id);
+		}
 
-	/* start synchro and launch test on master */
-	rte_atomic32_set(&synchro, 1);
+		/* start synchro and launch test on master */
+		rte_atomic32_set(&synchro, 1);
 
-	ret = per_lcore_mempool_test(mp);
+		ret = per_lcore_mempool_test(mp);
 
-	cores = cores_save;
-	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
-		if (cores == 1)
-			break;
-		cores--;
-		if (rte_eal_wait_lcore(lcore_id) < 0)
-			ret = -1;
+		cores = cores_save;
+		RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+			if (cores == 1)
+				break;
+			cores--;
+			if (rte_eal_wait_lcore(lcore_id) < 0)
+				ret = -1;
+		}
 	}
 
 	if (ret < 0) {
@@ -279,12 +348,64 @@ do_one_mempool_test(struct rte_mempool *mp, unsigned int cores)
 	return 0;
 }
 
+/* create a mempool without cache, using the given handler */
+static struct rte_mempool *
+create_ops_mempool(const char *name, const char *ops)
+{
+	struct rte_mempool *mp;
+
+	mp = rte_mempool_create_empty(name, MEMPOOL_SIZE, MEMPOOL_ELT_SIZE,
+		0, 0, SOCKET_ID_ANY, 0);
+	if (mp == NULL) {
+		printf("cannot allocate %s mempool\n", ops);
+		return NULL;
+	}
+
+	if (rte_mempool_set_ops_byname(mp, ops, NULL) < 0) {
+		printf("cannot set %s handler\n", ops);
+		rte_mempool_free(mp);
+		return NULL;
+	}
+
+	if (rte_mempool_populate_default(mp) < 0) {
+		printf("cannot populate %s mempool\n", ops);
+		rte_mempool_free(mp);
+		return NULL;
+	}
+
+	rte_mempool_obj_iter(mp, my_obj_init, NULL);
+	return mp;
+}
+
+/* performance test with 1, 2 and max non-EAL threads, without cache */
+static int
+do_non_eal_mempool_test(struct rte_mempool *mp, const char *ops)
+{
+	int ret;
+
+	printf("start performance test for %s (non-EAL threads)\n", ops);
+
+	use_external_cache = 0;
+	use_non_eal_threads = 1;
+
+	ret = do_one_mempool_test(mp, 1);
+	if (ret == 0)
+		ret = do_one_mempool_test(mp, 2);
+	if (ret == 0)
+		ret = do_one_mempool_test(mp, rte_lcore_count());
+
+	use_non_eal_threads = 0;
+	return ret;
+}
+
 static int
 test_mempool_perf(void)
 {
 	struct rte_mempool *mp_cache = NULL;
 	struct rte_mempool *mp_nocache = NULL;
 	struct rte_mempool *default_pool = NULL;
+	struct rte_mempool *stack_pool = NULL;
+	struct rte_mempool *lf_stack_pool = NULL;
 	const char *default_pool_ops;
 	int ret = -1;
 
@@ -385,6 +506,29 @@ test_mempool_perf(void)
 	if (do_one_mempool_test(mp_nocache, rte_lcore_count()) < 0)
 		goto err;
 
+	/*
+	 * Non-EAL threads have no default cache, so they contend on the
+	 * common pool: compare the ring, stack and lock-free stack handlers.
+	 */
+	stack_pool = create_ops_mempool("perf_test_stack", "stack");
+	if (stack_pool == NULL)
+		goto err;
+
+	if (do_non_eal_mempool_test(mp_nocache, "ring_mp_mc") < 0)
+		goto err;
+
+	if (do_non_eal_mempool_test(stack_pool, "stack") < 0)
+		goto err;
+
+#ifdef RTE_ARCH_X86_64
+	lf_stack_pool = create_ops_mempool("perf_test_lf_stack", "lf_stack");
+	if (lf_stack_pool == NULL)
+		goto err;
+
+	if (do_non_eal_mempool_test(lf_stack_pool, "lf_stack") < 0)
+		goto err;
+#endif
+
 	rte_mempool_list_dump(stdout);
 
 	ret = 0;
@@ -393,6 +537,8 @@ test_mempool_perf(void)
 	rte_mempool_free(mp_cache);
 	rte_mempool_free(mp_nocache);
 	rte_mempool_free(default_pool);
+	rte_mempool_free(stack_pool);
+	rte_mempool_free(lf_stack_pool);
 	return ret;
 }
 
@@ -0,0 +1,511 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2018 Intel Corporation
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <rte_cycles.h>
+#include <rte_errno.h>
+#include <rte_ip.h>
+#include <rte_random.h>
+#include <rte_rib.h>
+
+#include "test.h"
+
+#define MAX_NODES	(1 << 16)
+#define NUM_RND_ROUTES	1000
+#define NUM_RND_LOOKUPS	(1 << 14)
+
+struct route {
+	uint32_t ip;
+	uint8_t depth;
+	uint64_t nh;
+	int present;
+};
+
+/* Per route user data stored in the node extension space */
+struct route_ext {
+	uint64_t cookie;
+	uint32_t flags;
+};
+
+/*
+ * Check that rte_rib_create fails gracefully for incorrect user input
+ * arguments
+ */
+static int32_t
+test_create_invalid(void)
+{
+	struct rte_rib *rib = NULL;
+	struct rte_rib_conf config;
+
+	config.max_nodes = MAX_NODES;
+	config.ext_sz = 0;
+
+	/* rte_rib_create: rib name == NULL */
+	rib = rte_rib_create(NULL, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(rib == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	/* rte_rib_create: config == NULL */
+	rib = rte_rib_create(__func__, SOCKET_ID_ANY, NULL);
+	RTE_TEST_ASSERT(rib == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	/* rte_rib_create: max_nodes = 0 */
+	config.max_nodes = 0;
+	rib = rte_rib_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(rib == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	return TEST_SUCCESS;
+}
+
+/*
+ * Create rib table then delete rib table 10 times
+ * Use a slightly different rules size each time
+ */
+static int32_t
+test_multiple_create(void)
+{
+	struct rte_rib *rib = NULL;
+	struct rte_rib_conf config;
+	int32_t i;
+
+	config.ext_sz = 0;
+
+	for (i = 0; i < 10; i++) {
+		config.max_nodes = MAX_NODES - i;
+		rib = rte_rib_create(__func__, SOCKET_ID_ANY, &config);
+		RTE_TEST_ASSERT(rib != NULL, "Failed to create RIB\n");
+		RTE_TEST_ASSERT(rte_rib_find_existing(__func__) == rib,
+			"Failed to find RIB\n");
+		RTE_TEST_ASSERT(rte_rib_create(__func__, SOCKET_ID_ANY,
+			&config) == NULL, "Created a RIB twice\n");
+		rte_rib_free(rib);
+	}
+	RTE_TEST_ASSERT(rte_rib_find_existing(__func__) == NULL,
+		"Found a freed RIB\n");
+
+	/* Can not test free so return success */
+	return TEST_SUCCESS;
+}
+
+/*
+ * Check that insert, remove and the node accessors fail gracefully
+ * for incorrect user input arguments
+ */
+static int32_t
+test_insert_invalid(void)
+{
+	struct rte_rib *rib = NULL;
+	struct rte_rib_node *node;
+	struct rte_rib_conf config;
+	uint32_t ip = IPv4(10, 0, 0, 0);
+	uint64_t nh = 0;
+	uint8_t depth = 24;
+
+	config.max_nodes = MAX_NODES;
+	config.ext_sz = 0;
+
+	/* rte_rib_insert: rib == NULL */
+	node = rte_rib_insert(NULL, ip, depth);
+	RTE_TEST_ASSERT(node == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	/*Create valid rib to use in rest of test. */
+	rib = rte_rib_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(rib != NULL, "Failed to create RIB\n");
+
+	/* rte_rib_insert: depth > RTE_RIB_MAXDEPTH */
+	node = rte_rib_insert(rib, ip, RTE_RIB_MAXDEPTH + 1);
+	RTE_TEST_ASSERT(node == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	/* rte_rib_insert: route already exists */
+	node = rte_rib_insert(rib, ip, depth);
+	RTE_TEST_ASSERT(node != NULL, "Failed to insert a route\n");
+	node = rte_rib_insert(rib, ip, depth);
+	RTE_TEST_ASSERT((node == NULL) && (rte_errno == EEXIST),
+		"Inserted a route twice\n");
+
+	/* rte_rib_remove does not crash for invalid parameters */
+	rte_rib_remove(NULL, ip, depth);
+	rte_rib_remove(rib, ip, RTE_RIB_MAXDEPTH + 1);
+
+	RTE_TEST_ASSERT(rte_rib_get_nh(NULL, &nh) < 0,
+		"Call succeeded with invalid parameters\n");
+	RTE_TEST_ASSERT(rte_rib_set_nh(NULL, nh) < 0,
+		"Call succeeded with invalid parameters\n");
+	RTE_TEST_ASSERT(rte_rib_get_ip(NULL, &ip) < 0,
+		"Call succeeded with invalid parameters\n");
+	RTE_TEST_ASSERT(rte_rib_get_depth(NULL, &depth) < 0,
+		"Call succeeded with invalid parameters\n");
+	RTE_TEST_ASSERT(rte_rib_get_ext(NULL) == NULL,
+		"Call succeeded with invalid parameters\n");
+	RTE_TEST_ASSERT(rte_rib_lookup(NULL, ip) == NULL,
+		"Call succeeded with invalid parameters\n");
+	RTE_TEST_ASSERT(rte_rib_lookup_shortest(NULL, ip) == NULL,
+		"Call succeeded with invalid parameters\n");
+	RTE_TEST_ASSERT(rte_rib_lookup_parent(NULL) == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	rte_rib_free(rib);
+
+	return TEST_SUCCESS;
+}
+
+/* Check the node pool bounds the number of routes */
+static int32_t
+test_max_nodes(void)
+{
+	struct rte_rib *rib;
+	struct rte_rib_conf config;
+	struct rte_rib_node *node;
+	uint32_t i;
+
+	config.max_nodes = 8;
+	config.ext_sz = 0;
+	rib = rte_rib_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(rib != NULL, "Failed to create RIB\n");
+
+	/* nested routes need no branch */
+	for (i = 0; i < 8; i++) {
+		node = rte_rib_insert(rib, IPv4(10, 0, 0, 0), 8 + i);
+		RTE_TEST_ASSERT(node != NULL, "Failed to insert a route\n");
+	}
+	node = rte_rib_insert(rib, IPv4(10, 0, 0, 0), 24);
+	RTE_TEST_ASSERT((node == NULL) && (rte_errno == ENOSPC),
+		"Inserted more routes than nodes\n");
+
+	/* the nodes are given back on removal */
+	for (i = 0; i < 8; i++)
+		rte_rib_remove(rib, IPv4(10, 0, 0, 0), 8 + i);
+	for (i = 0; i < 4; i++) {
+		node = rte_rib_insert(rib, IPv4(10, i, 0, 0), 16);
+		RTE_TEST_ASSERT(node != NULL, "Failed to insert a route\n");
+	}
+
+	rte_rib_free(rib);
+	return TEST_SUCCESS;
+}
+
+/*
+ * Check the accessors and the per node extension space, which is zeroed
+ * when a route is inserted, even over a former branch node.
+ */
+static int32_t
+test_get_set(void)
+{
+	struct rte_rib *rib;
+	struct rte_rib_conf config;
+	struct rte_rib_node *node;
+	struct route_ext *ext;
+	uint32_t ip;
+	uint64_t nh;
+	uint8_t depth;
+
+	config.max_nodes = MAX_NODES;
+	config.ext_sz = sizeof(struct route_ext);
+	rib = rte_rib_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(rib != NULL, "Failed to create RIB\n");
+
+	/* the prefix is masked with its length */
+	node = rte_rib_insert(rib, IPv4(10, 1, 2, 3), 16);
+	RTE_TEST_ASSERT(node != NULL, "Failed to insert a route\n");
+	RTE_TEST_ASSERT((rte_rib_get_ip(node, &ip) == 0) &&
+		(ip == IPv4(10, 1, 0, 0)), "Wrong prefix\n");
+	RTE_TEST_ASSERT((rte_rib_get_depth(node, &depth) == 0) &&
+		(depth == 16), "Wrong prefix length\n");
+	RTE_TEST_ASSERT((rte_rib_get_nh(node, &nh) == 0) && (nh == 0),
+		"Wrong next hop\n");
+	RTE_TEST_ASSERT((rte_rib_set_nh(node, 100) == 0) &&
+		(rte_rib_get_nh(node, &nh) == 0) && (nh == 100),
+		"Wrong next hop\n");
+
+	ext = rte_rib_get_ext(node);
+	RTE_TEST_ASSERT((ext != NULL) && (ext->cookie == 0) &&
+		(ext->flags == 0), "Extension space not zeroed\n");
+	ext->cookie = 0xdeadbeef;
+	ext->flags = 1;
+	node = rte_rib_lookup_exact(rib, IPv4(10, 1, 0, 0), 16);
+	ext = rte_rib_get_ext(node);
+	RTE_TEST_ASSERT((ext != NULL) && (ext->cookie == 0xdeadbeef) &&
+		(ext->flags == 1), "Extension space not kept\n");
+
+	/* 10.0/16 and 10.1/16 make 10.0/15 a branch */
+	node = rte_rib_insert(rib, IPv4(10, 0, 0, 0), 16);
+	RTE_TEST_ASSERT(node != NULL, "Failed to insert a route\n");
+	node = rte_rib_insert(rib, IPv4(10, 0, 0, 0), 15);
+	RTE_TEST_ASSERT(node != NULL, "Failed to insert a route\n");
+	ext = rte_rib_get_ext(node);
+	ext->cookie = 1;
+	rte_rib_set_nh(node, 200);
+	rte_rib_remove(rib, IPv4(10, 0, 0, 0), 15);
+	RTE_TEST_ASSERT(rte_rib_lookup_exact(rib, IPv4(10, 0, 0, 0), 15) ==
+		NULL, "Found a removed route\n");
+	node = rte_rib_insert(rib, IPv4(10, 0, 0, 0), 15);
+	RTE_TEST_ASSERT(node != NULL, "Failed to insert a route\n");
+	ext = rte_rib_get_ext(node);
+	RTE_TEST_ASSERT((ext->cookie == 0) && (rte_rib_get_nh(node, &nh) == 0)
+		&& (nh == 0), "Reused branch node not reset\n");
+
+	rte_rib_free(rib);
+	return TEST_SUCCESS;
+}
+
+/*
+ * Check the longest, shortest and covering prefix queries, and the
+ * subtree iteration, on a set of nested routes.
+ */
+static int32_t
+test_tree_walk(void)
+{
+	static const struct {
+		uint32_t ip;
+		uint8_t depth;
+	} routes[] = {
+		{IPv4(10, 0, 0, 0), 8},
+		{IPv4(10, 0, 0, 0), 16},
+		{IPv4(10, 0, 0, 0), 24},
+		{IPv4(10, 0, 1, 0), 24},
+		{IPv4(10, 128, 0, 0), 9},
+		{IPv4(10, 200, 0, 1), 32},
+		{IPv4(11, 0, 0, 0), 8},
+	};
+	struct rte_rib *rib;
+	struct rte_rib_conf config;
+	struct rte_rib_node *node, *parent;
+	uint32_t ip;
+	uint8_t depth;
+	unsigned int i, n;
+
+	config.max_nodes = MAX_NODES;
+	config.ext_sz = 0;
+	rib = rte_rib_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(rib != NULL, "Failed to create RIB\n");
+
+	for (i = 0; i < RTE_DIM(routes); i++) {
+		node = rte_rib_insert(rib, routes[i].ip, routes[i].depth);
+		RTE_TEST_ASSERT(node != NULL, "Failed to insert a route\n");
+		rte_rib_set_nh(node, i);
+	}
+
+	/* longest and shortest prefix match */
+	node = rte_rib_lookup(rib, IPv4(10, 0, 1, 5));
+	rte_rib_get_depth(node, &depth);
+	RTE_TEST_ASSERT((node != NULL) && (depth == 24), "Wrong LPM\n");
+	node = rte_rib_lookup_shortest(rib, IPv4(10, 0, 1, 5));
+	rte_rib_get_depth(node, &depth);
+	RTE_TEST_ASSERT((node != NULL) && (depth == 8), "Wrong SPM\n");
+	node = rte_rib_lookup(rib, IPv4(10, 200, 0, 1));
+	rte_rib_get_depth(node, &depth);
+	RTE_TEST_ASSERT((node != NULL) && (depth == 32), "Wrong LPM\n");
+	RTE_TEST_ASSERT(rte_rib_lookup(rib, IPv4(12, 0, 0, 0)) == NULL,
+		"Found a route for an unrouted address\n");
+	RTE_TEST_ASSERT(rte_rib_lookup_shortest(rib, IPv4(12, 0, 0, 0)) ==
+		NULL, "Found a route for an unrouted address\n");
+
+	/* covering routes */
+	node = rte_rib_lookup_exact(rib, IPv4(10, 200, 0, 1), 32);
+	parent = rte_rib_lookup_parent(node);
+	rte_rib_get_depth(parent, &depth);
+	RTE_TEST_ASSERT((parent != NULL) && (depth == 9), "Wrong parent\n");
+	parent = rte_rib_lookup_parent(parent);
+	rte_rib_get_depth(parent, &depth);
+	RTE_TEST_ASSERT((parent != NULL) && (depth == 8), "Wrong parent\n");
+	RTE_TEST_ASSERT(rte_rib_lookup_parent(parent) == NULL,
+		"Wrong parent\n");
+
+	/* withdrawing a route leaves its subroutes to the parent */
+	rte_rib_remove(rib, IPv4(10, 0, 0, 0), 16);
+	node = rte_rib_lookup_exact(rib, IPv4(10, 0, 1, 0), 24);
+	parent = rte_rib_lookup_parent(node);
+	rte_rib_get_depth(parent, &depth);
+	RTE_TEST_ASSERT((parent != NULL) && (depth == 8), "Wrong parent\n");
+	node = rte_rib_lookup(rib, IPv4(10, 0, 2, 0));
+	rte_rib_get_depth(node, &depth);
+	RTE_TEST_ASSERT((node != NULL) && (depth == 8), "Wrong LPM\n");
+
+	/* all the routes more specific than 10/8 */
+	n = 0;
+	node = NULL;
+	while ((node = rte_rib_get_nxt(rib, IPv4(10, 0, 0, 0), 8, node,
+			RTE_RIB_GET_NXT_ALL)) != NULL) {
+		rte_rib_get_ip(node, &ip);
+		rte_rib_get_depth(node, &depth);
+		RTE_TEST_ASSERT((depth > 8) &&
+			((ip & 0xff000000) == IPv4(10, 0, 0, 0)),
+			"Route out of the subtree\n");
+		n++;
+	}
+	RTE_TEST_ASSERT(n == 4, "Wrong number of subroutes: %u\n", n);
+
+	/* only the ones not covered by another one */
+	n = 0;
+	node = NULL;
+	while ((node = rte_rib_get_nxt(rib, IPv4(10, 0, 0, 0), 8, node,
+			RTE_RIB_GET_NXT_COVER)) != NULL) {
+		rte_rib_get_depth(node, &depth);
+		RTE_TEST_ASSERT(depth != 32, "Returned a covered route\n");
+		n++;
+	}
+	RTE_TEST_ASSERT(n == 3, "Wrong number of covering subroutes: %u\n",
+		n);
+
+	/* the whole table */
+	n = 0;
+	node = NULL;
+	while ((node = rte_rib_get_nxt(rib, 0, 0, node,
+			RTE_RIB_GET_NXT_ALL)) != NULL)
+		n++;
+	RTE_TEST_ASSERT(n == RTE_DIM(routes) - 1,
+		"Wrong number of routes: %u\n", n);
+
+	rte_rib_free(rib);
+	return TEST_SUCCESS;
+}
+
+/* Compare the RIB queries with a linear scan of the routes */
+static int
+check_against_scan(struct rte_rib *rib, struct route *routes,
+	unsigned int nb_routes)
+{
+	struct rte_rib_node *node, *shortest, *parent;
+	struct route *lpm, *spm;
+	uint32_t ip, mask;
+	uint8_t depth;
+	uint64_t nh;
+	unsigned int i, j;
+
+	for (i = 0; i < NUM_RND_LOOKUPS; i++) {
+		ip = routes[rte_rand() % nb_routes].ip |
+			(rte_rand() & (UINT32_MAX >> (rte_rand() % 32)));
+		lpm = spm = NULL;
+		for (j = 0; j < nb_routes; j++) {
+			if (!routes[j].present)
+				continue;
+			mask = rte_rib_depth_to_mask(routes[j].depth);
+			if ((ip & mask) != routes[j].ip)
+				continue;
+			if ((lpm == NULL) || (routes[j].depth > lpm->depth))
+				lpm = &routes[j];
+			if ((spm == NULL) || (routes[j].depth < spm->depth))
+				spm = &routes[j];
+		}
+
+		node = rte_rib_lookup(rib, ip);
+		shortest = rte_rib_lookup_shortest(rib, ip);
+		if (lpm == NULL) {
+			RTE_TEST_ASSERT((node == NULL) && (shortest == NULL),
+				"Found a route for an unrouted address\n");
+			continue;
+		}
+		RTE_TEST_ASSERT((node != NULL) && (shortest != NULL),
+			"No route found\n");
+		rte_rib_get_depth(node, &depth);
+		rte_rib_get_nh(node, &nh);
+		RTE_TEST_ASSERT((depth == lpm->depth) && (nh == lpm->nh),
+			"Wrong longest prefix match\n");
+		rte_rib_get_depth(shortest, &depth);
+		RTE_TEST_ASSERT(depth == spm->depth,
+			"Wrong shortest prefix match\n");
+
+		/* the parents of the LPM are all the other matching routes */
+		for (parent = rte_rib_lookup_parent(node); parent != NULL;
+				parent = rte_rib_lookup_parent(parent))
+			node = parent;
+		RTE_TEST_ASSERT(node == shortest, "Wrong parent chain\n");
+	}
+	return TEST_SUCCESS;
+}
+
+static int32_t
+test_random(void)
+{
+	struct rte_rib *rib;
+	struct rte_rib_conf config;
+	struct rte_rib_node *node;
+	struct route *routes;
+	unsigned int i, j;
+	int ret;
+
+	routes = calloc(NUM_RND_ROUTES, sizeof(*routes));
+	RTE_TEST_ASSERT(routes != NULL, "Failed to allocate routes\n");
+
+	config.max_nodes = 2 * NUM_RND_ROUTES;
+	config.ext_sz = 0;
+	rib = rte_rib_create(__func__, SOCKET_ID_ANY, &config);
+	if (rib == NULL) {
+		free(routes);
+		RTE_TEST_ASSERT(0, "Failed to create RIB\n");
+	}
+
+	rte_srand(rte_rdtsc());
+	for (i = 0; i < NUM_RND_ROUTES; i++) {
+		/* a small address space to get nested routes */
+		routes[i].depth = 8 + rte_rand() % 25;
+		routes[i].ip = (IPv4(10, 0, 0, 0) | (rte_rand() & 0xf0f0ff)) &
+			rte_rib_depth_to_mask(routes[i].depth);
+		routes[i].nh = rte_rand();
+		for (j = 0; j < i; j++)
+			if (routes[j].present &&
+					(routes[j].ip == routes[i].ip) &&
+					(routes[j].depth == routes[i].depth))
+				break;
+		if (j != i)
+			continue;
+		node = rte_rib_insert(rib, routes[i].ip, routes[i].depth);
+		if (node == NULL)
+			break;
+		rte_rib_set_nh(node, routes[i].nh);
+		routes[i].present = 1;
+	}
+	ret = (i == NUM_RND_ROUTES) ? TEST_SUCCESS : TEST_FAILED;
+	if (ret == TEST_SUCCESS)
+		ret = check_against_scan(rib, routes, NUM_RND_ROUTES);
+
+	/* withdraw one half of the routes */
+	for (i = 0; (ret == TEST_SUCCESS) && (i < NUM_RND_ROUTES); i += 2) {
+		if (!routes[i].present)
+			continue;
+		rte_rib_remove(rib, routes[i].ip, routes[i].depth);
+		routes[i].present = 0;
+	}
+	if (ret == TEST_SUCCESS)
+		ret = check_against_scan(rib, routes, NUM_RND_ROUTES);
+
+	rte_rib_free(rib);
+	free(routes);
+	return ret;
+}
+
+static struct unit_test_suite rib_tests = {
+	.suite_name = "rib autotest",
+	.setup = NULL,
+	.teardown = NULL,
+	.unit_test_cases = {
+	TEST_CASE(test_create_invalid),
+	TEST_CASE(test_multiple_create),
+	TEST_CASE(test_insert_invalid),
+	TEST_CASE(test_max_nodes),
+	TEST_CASE(test_get_set),
+	TEST_CASE(test_tree_walk),
+	TEST_CASE(test_random),
+	TEST_CASES_END()
+	}
+};
+
+/*
+ * Do all unit tests.
+ */
+static int
+test_rib(void)
+{
+	return unit_test_suite_runner(&rib_tests);
+}
+
+REGISTER_TEST_COMMAND(rib_autotest, test_rib);
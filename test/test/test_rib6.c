@@ -0,0 +1,540 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2018 Intel Corporation
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <rte_cycles.h>
+#include <rte_errno.h>
+#include <rte_memory.h>
+#include <rte_random.h>
+#include <rte_rib6.h>
+
+#include "test.h"
+
+#define MAX_NODES	(1 << 16)
+#define NUM_RND_ROUTES	1000
+#define NUM_RND_LOOKUPS	(1 << 13)
+
+struct route6 {
+	uint8_t ip[RTE_RIB6_IPV6_ADDR_SIZE];
+	uint8_t depth;
+	uint64_t nh;
+	int present;
+};
+
+/* Per route user data stored in the node extension space */
+struct route_ext {
+	uint64_t cookie;
+	uint32_t flags;
+};
+
+/* Build an IPv6 address from its eight 16-bit words */
+static void
+set_ip6(uint8_t ip[RTE_RIB6_IPV6_ADDR_SIZE], uint16_t w0, uint16_t w1,
+	uint16_t w2, uint16_t w3, uint16_t w7)
+{
+	memset(ip, 0, RTE_RIB6_IPV6_ADDR_SIZE);
+	ip[0] = w0 >> 8;
+	ip[1] = (uint8_t)w0;
+	ip[2] = w1 >> 8;
+	ip[3] = (uint8_t)w1;
+	ip[4] = w2 >> 8;
+	ip[5] = (uint8_t)w2;
+	ip[6] = w3 >> 8;
+	ip[7] = (uint8_t)w3;
+	ip[14] = w7 >> 8;
+	ip[15] = (uint8_t)w7;
+}
+
+static void
+mask_ip6(uint8_t ip[RTE_RIB6_IPV6_ADDR_SIZE], uint8_t depth)
+{
+	int i;
+
+	for (i = 0; i < RTE_RIB6_IPV6_ADDR_SIZE; i++) {
+		if (depth <= i * 8)
+			ip[i] = 0;
+		else if (depth < (i + 1) * 8)
+			ip[i] &= (uint8_t)(UINT8_MAX << ((i + 1) * 8 - depth));
+	}
+}
+
+/* Check if ip is covered by the pfx/depth prefix */
+static int
+is_covered6(const uint8_t ip[RTE_RIB6_IPV6_ADDR_SIZE],
+	const uint8_t pfx[RTE_RIB6_IPV6_ADDR_SIZE], uint8_t depth)
+{
+	uint8_t tmp[RTE_RIB6_IPV6_ADDR_SIZE];
+
+	memcpy(tmp, ip, sizeof(tmp));
+	mask_ip6(tmp, depth);
+	return memcmp(tmp, pfx, sizeof(tmp)) == 0;
+}
+
+/*
+ * Check that rte_rib6_create fails gracefully for incorrect user input
+ * arguments
+ */
+static int32_t
+test_create_invalid(void)
+{
+	struct rte_rib6 *rib = NULL;
+	struct rte_rib6_conf config;
+
+	config.max_nodes = MAX_NODES;
+	config.ext_sz = 0;
+
+	/* rte_rib6_create: rib name == NULL */
+	rib = rte_rib6_create(NULL, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(rib == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	/* rte_rib6_create: config == NULL */
+	rib = rte_rib6_create(__func__, SOCKET_ID_ANY, NULL);
+	RTE_TEST_ASSERT(rib == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	/* rte_rib6_create: max_nodes = 0 */
+	config.max_nodes = 0;
+	rib = rte_rib6_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(rib == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	return TEST_SUCCESS;
+}
+
+/*
+ * Create rib table then delete rib table 10 times
+ * Use a slightly different rules size each time
+ */
+static int32_t
+test_multiple_create(void)
+{
+	struct rte_rib6 *rib = NULL;
+	struct rte_rib6_conf config;
+	int32_t i;
+
+	config.ext_sz = 0;
+
+	for (i = 0; i < 10; i++) {
+		config.max_nodes = MAX_NODES - i;
+		rib = rte_rib6_create(__func__, SOCKET_ID_ANY, &config);
+		RTE_TEST_ASSERT(rib != NULL, "Failed to create RIB\n");
+		RTE_TEST_ASSERT(rte_rib6_find_existing(__func__) == rib,
+			"Failed to find RIB\n");
+		rte_rib6_free(rib);
+	}
+	RTE_TEST_ASSERT(rte_rib6_find_existing(__func__) == NULL,
+		"Found a freed RIB\n");
+
+	/* Can not test free so return success */
+	return TEST_SUCCESS;
+}
+
+/*
+ * Check that insert, remove and the node accessors fail gracefully
+ * for incorrect user input arguments
+ */
+static int32_t
+test_insert_invalid(void)
+{
+	struct rte_rib6 *rib = NULL;
+	struct rte_rib6_node *node;
+	struct rte_rib6_conf config;
+	uint8_t ip[RTE_RIB6_IPV6_ADDR_SIZE] = {0};
+	uint64_t nh = 0;
+	uint8_t depth = 24;
+
+	config.max_nodes = MAX_NODES;
+	config.ext_sz = 0;
+
+	/* rte_rib6_insert: rib == NULL */
+	node = rte_rib6_insert(NULL, ip, depth);
+	RTE_TEST_ASSERT(node == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	/*Create valid rib to use in rest of test. */
+	rib = rte_rib6_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(rib != NULL, "Failed to create RIB\n");
+
+	/* rte_rib6_insert: ip == NULL */
+	node = rte_rib6_insert(rib, NULL, depth);
+	RTE_TEST_ASSERT(node == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	/* rte_rib6_insert: depth > RTE_RIB6_MAXDEPTH */
+	node = rte_rib6_insert(rib, ip, RTE_RIB6_MAXDEPTH + 1);
+	RTE_TEST_ASSERT(node == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	/* rte_rib6_insert: route already exists */
+	node = rte_rib6_insert(rib, ip, depth);
+	RTE_TEST_ASSERT(node != NULL, "Failed to insert a route\n");
+	node = rte_rib6_insert(rib, ip, depth);
+	RTE_TEST_ASSERT((node == NULL) && (rte_errno == EEXIST),
+		"Inserted a route twice\n");
+
+	/* rte_rib6_remove does not crash for invalid parameters */
+	rte_rib6_remove(NULL, ip, depth);
+	rte_rib6_remove(rib, NULL, depth);
+	rte_rib6_remove(rib, ip, RTE_RIB6_MAXDEPTH + 1);
+
+	RTE_TEST_ASSERT(rte_rib6_get_nh(NULL, &nh) < 0,
+		"Call succeeded with invalid parameters\n");
+	RTE_TEST_ASSERT(rte_rib6_set_nh(NULL, nh) < 0,
+		"Call succeeded with invalid parameters\n");
+	RTE_TEST_ASSERT(rte_rib6_get_ip(NULL, ip) < 0,
+		"Call succeeded with invalid parameters\n");
+	RTE_TEST_ASSERT(rte_rib6_get_depth(NULL, &depth) < 0,
+		"Call succeeded with invalid parameters\n");
+	RTE_TEST_ASSERT(rte_rib6_get_ext(NULL) == NULL,
+		"Call succeeded with invalid parameters\n");
+	RTE_TEST_ASSERT(rte_rib6_lookup(rib, NULL) == NULL,
+		"Call succeeded with invalid parameters\n");
+	RTE_TEST_ASSERT(rte_rib6_lookup_shortest(rib, NULL) == NULL,
+		"Call succeeded with invalid parameters\n");
+	RTE_TEST_ASSERT(rte_rib6_lookup_parent(NULL) == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	rte_rib6_free(rib);
+
+	return TEST_SUCCESS;
+}
+
+/*
+ * Check the accessors and the per node extension space, which is zeroed
+ * when a route is inserted, even over a former branch node.
+ */
+static int32_t
+test_get_set(void)
+{
+	struct rte_rib6 *rib;
+	struct rte_rib6_conf config;
+	struct rte_rib6_node *node;
+	struct route_ext *ext;
+	uint8_t ip[RTE_RIB6_IPV6_ADDR_SIZE], exp[RTE_RIB6_IPV6_ADDR_SIZE];
+	uint64_t nh;
+	uint8_t depth;
+
+	config.max_nodes = MAX_NODES;
+	config.ext_sz = sizeof(struct route_ext);
+	rib = rte_rib6_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(rib != NULL, "Failed to create RIB\n");
+
+	/* the prefix is masked with its length */
+	set_ip6(ip, 0x2001, 0xdb8, 0x1234, 0x5678, 1);
+	set_ip6(exp, 0x2001, 0xdb8, 0x1200, 0, 0);
+	node = rte_rib6_insert(rib, ip, 40);
+	RTE_TEST_ASSERT(node != NULL, "Failed to insert a route\n");
+	RTE_TEST_ASSERT((rte_rib6_get_ip(node, ip) == 0) &&
+		(memcmp(ip, exp, sizeof(ip)) == 0), "Wrong prefix\n");
+	RTE_TEST_ASSERT((rte_rib6_get_depth(node, &depth) == 0) &&
+		(depth == 40), "Wrong prefix length\n");
+	RTE_TEST_ASSERT((rte_rib6_get_nh(node, &nh) == 0) && (nh == 0),
+		"Wrong next hop\n");
+	RTE_TEST_ASSERT((rte_rib6_set_nh(node, 100) == 0) &&
+		(rte_rib6_get_nh(node, &nh) == 0) && (nh == 100),
+		"Wrong next hop\n");
+
+	ext = rte_rib6_get_ext(node);
+	RTE_TEST_ASSERT((ext != NULL) && (ext->cookie == 0) &&
+		(ext->flags == 0), "Extension space not zeroed\n");
+	ext->cookie = 0xdeadbeef;
+	ext->flags = 1;
+	node = rte_rib6_lookup_exact(rib, exp, 40);
+	ext = rte_rib6_get_ext(node);
+	RTE_TEST_ASSERT((ext != NULL) && (ext->cookie == 0xdeadbeef) &&
+		(ext->flags == 1), "Extension space not kept\n");
+
+	/* 2001:db8:1200::/40 and 2001:db8:1300::/40 make a /39 branch */
+	set_ip6(ip, 0x2001, 0xdb8, 0x1300, 0, 0);
+	node = rte_rib6_insert(rib, ip, 40);
+	RTE_TEST_ASSERT(node != NULL, "Failed to insert a route\n");
+	node = rte_rib6_insert(rib, exp, 39);
+	RTE_TEST_ASSERT(node != NULL, "Failed to insert a route\n");
+	ext = rte_rib6_get_ext(node);
+	ext->cookie = 1;
+	rte_rib6_set_nh(node, 200);
+	rte_rib6_remove(rib, exp, 39);
+	RTE_TEST_ASSERT(rte_rib6_lookup_exact(rib, exp, 39) == NULL,
+		"Found a removed route\n");
+	node = rte_rib6_insert(rib, exp, 39);
+	RTE_TEST_ASSERT(node != NULL, "Failed to insert a route\n");
+	ext = rte_rib6_get_ext(node);
+	RTE_TEST_ASSERT((ext->cookie == 0) &&
+		(rte_rib6_get_nh(node, &nh) == 0) && (nh == 0),
+		"Reused branch node not reset\n");
+
+	rte_rib6_free(rib);
+	return TEST_SUCCESS;
+}
+
+/*
+ * Check the longest, shortest and covering prefix queries, and the
+ * subtree iteration, on a set of nested routes.
+ */
+static int32_t
+test_tree_walk(void)
+{
+	static const struct {
+		uint16_t w[5];
+		uint8_t depth;
+	} routes[] = {
+		{{0x2001, 0xdb8, 0, 0, 0}, 32},
+		{{0x2001, 0xdb8, 0, 0, 0}, 48},
+		{{0x2001, 0xdb8, 0, 0, 0}, 64},
+		{{0x2001, 0xdb8, 0, 1, 0}, 64},
+		{{0x2001, 0xdb8, 0x8000, 0, 0}, 33},
+		{{0x2001, 0xdb8, 0xc800, 0, 1}, 128},
+		{{0x2001, 0xdb9, 0, 0, 0}, 32},
+	};
+	struct rte_rib6 *rib;
+	struct rte_rib6_conf config;
+	struct rte_rib6_node *node, *parent;
+	uint8_t ip[RTE_RIB6_IPV6_ADDR_SIZE], pfx[RTE_RIB6_IPV6_ADDR_SIZE];
+	uint8_t depth;
+	unsigned int i, n;
+
+	config.max_nodes = MAX_NODES;
+	config.ext_sz = 0;
+	rib = rte_rib6_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(rib != NULL, "Failed to create RIB\n");
+
+	for (i = 0; i < RTE_DIM(routes); i++) {
+		set_ip6(ip, routes[i].w[0], routes[i].w[1], routes[i].w[2],
+			routes[i].w[3], routes[i].w[4]);
+		node = rte_rib6_insert(rib, ip, routes[i].depth);
+		RTE_TEST_ASSERT(node != NULL, "Failed to insert a route\n");
+		rte_rib6_set_nh(node, i);
+	}
+
+	/* longest and shortest prefix match */
+	set_ip6(ip, 0x2001, 0xdb8, 0, 1, 5);
+	node = rte_rib6_lookup(rib, ip);
+	rte_rib6_get_depth(node, &depth);
+	RTE_TEST_ASSERT((node != NULL) && (depth == 64), "Wrong LPM\n");
+	node = rte_rib6_lookup_shortest(rib, ip);
+	rte_rib6_get_depth(node, &depth);
+	RTE_TEST_ASSERT((node != NULL) && (depth == 32), "Wrong SPM\n");
+	set_ip6(ip, 0x2001, 0xdb8, 0xc800, 0, 1);
+	node = rte_rib6_lookup(rib, ip);
+	rte_rib6_get_depth(node, &depth);
+	RTE_TEST_ASSERT((node != NULL) && (depth == 128), "Wrong LPM\n");
+	set_ip6(ip, 0x2001, 0xdba, 0, 0, 0);
+	RTE_TEST_ASSERT(rte_rib6_lookup(rib, ip) == NULL,
+		"Found a route for an unrouted address\n");
+	RTE_TEST_ASSERT(rte_rib6_lookup_shortest(rib, ip) == NULL,
+		"Found a route for an unrouted address\n");
+
+	/* covering routes */
+	set_ip6(ip, 0x2001, 0xdb8, 0xc800, 0, 1);
+	node = rte_rib6_lookup_exact(rib, ip, 128);
+	parent = rte_rib6_lookup_parent(node);
+	rte_rib6_get_depth(parent, &depth);
+	RTE_TEST_ASSERT((parent != NULL) && (depth == 33), "Wrong parent\n");
+	parent = rte_rib6_lookup_parent(parent);
+	rte_rib6_get_depth(parent, &depth);
+	RTE_TEST_ASSERT((parent != NULL) && (depth == 32), "Wrong parent\n");
+	RTE_TEST_ASSERT(rte_rib6_lookup_parent(parent) == NULL,
+		"Wrong parent\n");
+
+	/* withdrawing a route leaves its subroutes to the parent */
+	set_ip6(pfx, 0x2001, 0xdb8, 0, 0, 0);
+	rte_rib6_remove(rib, pfx, 48);
+	set_ip6(ip, 0x2001, 0xdb8, 0, 1, 0);
+	node = rte_rib6_lookup_exact(rib, ip, 64);
+	parent = rte_rib6_lookup_parent(node);
+	rte_rib6_get_depth(parent, &depth);
+	RTE_TEST_ASSERT((parent != NULL) && (depth == 32), "Wrong parent\n");
+	set_ip6(ip, 0x2001, 0xdb8, 0, 2, 0);
+	node = rte_rib6_lookup(rib, ip);
+	rte_rib6_get_depth(node, &depth);
+	RTE_TEST_ASSERT((node != NULL) && (depth == 32), "Wrong LPM\n");
+
+	/* all the routes more specific than 2001:db8::/32 */
+	n = 0;
+	node = NULL;
+	while ((node = rte_rib6_get_nxt(rib, pfx, 32, node,
+			RTE_RIB6_GET_NXT_ALL)) != NULL) {
+		rte_rib6_get_ip(node, ip);
+		rte_rib6_get_depth(node, &depth);
+		RTE_TEST_ASSERT((depth > 32) && is_covered6(ip, pfx, 32),
+			"Route out of the subtree\n");
+		n++;
+	}
+	RTE_TEST_ASSERT(n == 4, "Wrong number of subroutes: %u\n", n);
+
+	/* only the ones not covered by another one */
+	n = 0;
+	node = NULL;
+	while ((node = rte_rib6_get_nxt(rib, pfx, 32, node,
+			RTE_RIB6_GET_NXT_COVER)) != NULL) {
+		rte_rib6_get_depth(node, &depth);
+		RTE_TEST_ASSERT(depth != 128, "Returned a covered route\n");
+		n++;
+	}
+	RTE_TEST_ASSERT(n == 3, "Wrong number of covering subroutes: %u\n",
+		n);
+
+	/* the whole table */
+	n = 0;
+	node = NULL;
+	memset(pfx, 0, sizeof(pfx));
+	while ((node = rte_rib6_get_nxt(rib, pfx, 0, node,
+			RTE_RIB6_GET_NXT_ALL)) != NULL)
+		n++;
+	RTE_TEST_ASSERT(n == RTE_DIM(routes) - 1,
+		"Wrong number of routes: %u\n", n);
+
+	rte_rib6_free(rib);
+	return TEST_SUCCESS;
+}
+
+/* Compare the RIB queries with a linear scan of the routes */
+static int
+check_against_scan(struct rte_rib6 *rib, struct route6 *routes,
+	unsigned int nb_routes)
+{
+	struct rte_rib6_node *node, *shortest, *parent;
+	struct route6 *lpm, *spm;
+	uint8_t ip[RTE_RIB6_IPV6_ADDR_SIZE];
+	uint8_t depth;
+	uint64_t nh;
+	unsigned int i, j;
+
+	for (i = 0; i < NUM_RND_LOOKUPS; i++) {
+		/* addresses of a route with random low bits */
+		memcpy(ip, routes[rte_rand() % nb_routes].ip, sizeof(ip));
+		for (j = 4 + rte_rand() % (RTE_RIB6_IPV6_ADDR_SIZE - 4);
+				j < RTE_RIB6_IPV6_ADDR_SIZE; j++)
+			ip[j] = rte_rand();
+
+		lpm = spm = NULL;
+		for (j = 0; j < nb_routes; j++) {
+			if (!routes[j].present ||
+					!is_covered6(ip, routes[j].ip,
+						routes[j].depth))
+				continue;
+			if ((lpm == NULL) || (routes[j].depth > lpm->depth))
+				lpm = &routes[j];
+			if ((spm == NULL) || (routes[j].depth < spm->depth))
+				spm = &routes[j];
+		}
+
+		node = rte_rib6_lookup(rib, ip);
+		shortest = rte_rib6_lookup_shortest(rib, ip);
+		if (lpm == NULL) {
+			RTE_TEST_ASSERT((node == NULL) && (shortest == NULL),
+				"Found a route for an unrouted address\n");
+			continue;
+		}
+		RTE_TEST_ASSERT((node != NULL) && (shortest != NULL),
+			"No route found\n");
+		rte_rib6_get_depth(node, &depth);
+		rte_rib6_get_nh(node, &nh);
+		RTE_TEST_ASSERT((depth == lpm->depth) && (nh == lpm->nh),
+			"Wrong longest prefix match\n");
+		rte_rib6_get_depth(shortest, &depth);
+		RTE_TEST_ASSERT(depth == spm->depth,
+			"Wrong shortest prefix match\n");
+
+		/* the parents of the LPM are all the other matching routes */
+		for (parent = rte_rib6_lookup_parent(node); parent != NULL;
+				parent = rte_rib6_lookup_parent(parent))
+			node = parent;
+		RTE_TEST_ASSERT(node == shortest, "Wrong parent chain\n");
+	}
+	return TEST_SUCCESS;
+}
+
+static int32_t
+test_random(void)
+{
+	struct rte_rib6 *rib;
+	struct rte_rib6_conf config;
+	struct rte_rib6_node *node;
+	struct route6 *routes;
+	unsigned int i, j;
+	int ret;
+
+	routes = calloc(NUM_RND_ROUTES, sizeof(*routes));
+	RTE_TEST_ASSERT(routes != NULL, "Failed to allocate routes\n");
+
+	config.max_nodes = 2 * NUM_RND_ROUTES;
+	config.ext_sz = 0;
+	rib = rte_rib6_create(__func__, SOCKET_ID_ANY, &config);
+	if (rib == NULL) {
+		free(routes);
+		RTE_TEST_ASSERT(0, "Failed to create RIB\n");
+	}
+
+	rte_srand(rte_rdtsc());
+	for (i = 0; i < NUM_RND_ROUTES; i++) {
+		/* a small address space to get nested routes */
+		set_ip6(routes[i].ip, 0x2001, 0xdb8, rte_rand() & 0xf0f,
+			rte_rand(), rte_rand());
+		routes[i].depth = 32 + rte_rand() % 97;
+		mask_ip6(routes[i].ip, routes[i].depth);
+		routes[i].nh = rte_rand();
+		for (j = 0; j < i; j++)
+			if (routes[j].present &&
+					(routes[j].depth == routes[i].depth) &&
+					(memcmp(routes[j].ip, routes[i].ip,
+						RTE_RIB6_IPV6_ADDR_SIZE) == 0))
+				break;
+		if (j != i)
+			continue;
+		node = rte_rib6_insert(rib, routes[i].ip, routes[i].depth);
+		if (node == NULL)
+			break;
+		rte_rib6_set_nh(node, routes[i].nh);
+		routes[i].present = 1;
+	}
+	ret = (i == NUM_RND_ROUTES) ? TEST_SUCCESS : TEST_FAILED;
+	if (ret == TEST_SUCCESS)
+		ret = check_against_scan(rib, routes, NUM_RND_ROUTES);
+
+	/* withdraw one half of the routes */
+	for (i = 0; (ret == TEST_SUCCESS) && (i < NUM_RND_ROUTES); i += 2) {
+		if (!routes[i].present)
+			continue;
+		rte_rib6_remove(rib, routes[i].ip, routes[i].depth);
+		routes[i].present = 0;
+	}
+	if (ret == TEST_SUCCESS)
+		ret = check_against_scan(rib, routes, NUM_RND_ROUTES);
+
+	rte_rib6_free(rib);
+	free(routes);
+	return ret;
+}
+
+static struct unit_test_suite rib6_tests = {
+	.suite_name = "rib6 autotest",
+	.setup = NULL,
+	.teardown = NULL,
+	.unit_test_cases = {
+	TEST_CASE(test_create_invalid),
+	TEST_CASE(test_multiple_create),
+	TEST_CASE(test_insert_invalid),
+	TEST_CASE(test_get_set),
+	TEST_CASE(test_tree_walk),
+	TEST_CASE(test_random),
+	TEST_CASES_END()
+	}
+};
+
+/*
+ * Do all unit tests.
+ */
+static int
+test_rib6(void)
+{
+	return unit_test_suite_runner(&rib6_tests);
+}
+
+REGISTER_TEST_COMMAND(rib6_autotest, test_rib6);
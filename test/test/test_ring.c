@@ -47,6 +47,17 @@
  *      - Dequeue one object, two objects, MAX_BULK objects
  *      - Check that dequeued pointers are correct
  *
+ *    - Using rings created in RTS and HTS sync modes:
+ *
+ *      - Fill and drain the ring through the default enqueue/dequeue API
+ *      - Check that dequeued pointers are correct
+ *      - Check that conflicting sync mode flags are rejected
+ *
+ *    - Using the peek and zero-copy APIs on SP/SC and HTS rings:
+ *
+ *      - Reserve, fill and commit objects, partially consume them
+ *      - Check wrap-around of the zero-copy areas
+ *
  * #. Performance tests.
  *
  * Tests done in test_ring_perf.c
@@ -807,6 +818,315 @@ test_ring_with_exact_size(void)
 	return ret;
 }
 
+/*
+ * Fill and drain rings created with each of the MP/MC sync modes through
+ * the generic API, which dispatches on the sync type given at creation.
+ */
+static int
+test_ring_sync_modes(void)
+{
+	static const struct {
+		const char *name;
+		unsigned int flags;
+	} modes[] = {
+		{ "MP/MC", 0 },
+		{ "MP_RTS/MC_RTS", RING_F_MP_RTS_ENQ | RING_F_MC_RTS_DEQ },
+		{ "MP_HTS/MC_HTS", RING_F_MP_HTS_ENQ | RING_F_MC_HTS_DEQ },
+		{ "MP_RTS/MC_HTS", RING_F_MP_RTS_ENQ | RING_F_MC_HTS_DEQ },
+		{ "MP_HTS/SC", RING_F_MP_HTS_ENQ | RING_F_SC_DEQ },
+	};
+	void *src[MAX_BULK], *dst[MAX_BULK];
+	struct rte_ring *r = NULL;
+	unsigned int i, j, k, n;
+
+	for (i = 0; i < RTE_DIM(src); i++)
+		src[i] = (void *)(uintptr_t)(i + 1);
+
+	for (i = 0; i < RTE_DIM(modes); i++) {
+		printf("Sync mode %s test\n", modes[i].name);
+
+		r = rte_ring_create("test_sync", RING_SIZE, SOCKET_ID_ANY,
+				modes[i].flags);
+		if (r == NULL) {
+			printf("%s: cannot create %s ring\n", __func__,
+				modes[i].name);
+			return -1;
+		}
+
+		/* fill the ring with bulk enqueues, drain with bursts */
+		for (j = 0; j != (RING_SIZE - 1) / MAX_BULK; j++)
+			TEST_RING_VERIFY(rte_ring_enqueue_bulk(r, src,
+					MAX_BULK, NULL) == MAX_BULK);
+		/* only the remainder of the ring capacity can be filled */
+		n = rte_ring_enqueue_burst(r, src, MAX_BULK, NULL);
+		TEST_RING_VERIFY(n == rte_ring_get_capacity(r) -
+				j * MAX_BULK);
+		TEST_RING_VERIFY(rte_ring_full(r));
+		TEST_RING_VERIFY(rte_ring_enqueue(r, src[0]) == -ENOBUFS);
+
+		for (j = 0; j != (RING_SIZE - 1) / MAX_BULK; j++) {
+			TEST_RING_VERIFY(rte_ring_dequeue_burst(r, dst,
+					MAX_BULK, NULL) == MAX_BULK);
+			for (k = 0; k != MAX_BULK; k++)
+				TEST_RING_VERIFY(dst[k] == src[k]);
+		}
+		TEST_RING_VERIFY(rte_ring_dequeue_bulk(r, dst, MAX_BULK,
+				NULL) == 0);
+		TEST_RING_VERIFY(rte_ring_dequeue_bulk(r, dst, n, NULL) == n);
+		TEST_RING_VERIFY(rte_ring_empty(r));
+		TEST_RING_VERIFY(rte_ring_dequeue(r, &dst[0]) == -ENOENT);
+
+		rte_ring_free(r);
+		r = NULL;
+	}
+
+	/* only one sync mode can be selected for each side of the ring */
+	if (rte_ring_create("test_sync", RING_SIZE, SOCKET_ID_ANY,
+			RING_F_SP_ENQ | RING_F_MP_HTS_ENQ) != NULL ||
+			rte_errno != EINVAL ||
+			rte_ring_create("test_sync", RING_SIZE, SOCKET_ID_ANY,
+			RING_F_MC_RTS_DEQ | RING_F_MC_HTS_DEQ) != NULL ||
+			rte_errno != EINVAL) {
+		printf("%s: conflicting sync flags not detected\n", __func__);
+		return -1;
+	}
+
+	/* the head/tail distance can only be changed on an RTS ring */
+	r = rte_ring_create("test_sync", RING_SIZE, SOCKET_ID_ANY,
+			RING_F_MP_RTS_ENQ | RING_F_MC_HTS_DEQ);
+	if (r == NULL) {
+		printf("%s: cannot create MP_RTS/MC_HTS ring\n", __func__);
+		return -1;
+	}
+	TEST_RING_VERIFY(rte_ring_get_prod_htd_max(r) ==
+			rte_ring_get_capacity(r) / 8);
+	TEST_RING_VERIFY(rte_ring_set_prod_htd_max(r, 0) == 0);
+	TEST_RING_VERIFY(rte_ring_set_cons_htd_max(r, 0) == -ENOTSUP);
+	TEST_RING_VERIFY(rte_ring_enqueue_bulk(r, src, MAX_BULK, NULL) ==
+			MAX_BULK);
+	TEST_RING_VERIFY(rte_ring_dequeue_bulk(r, dst, MAX_BULK, NULL) ==
+			MAX_BULK);
+	rte_ring_free(r);
+
+	return 0;
+}
+
+/*
+ * Two-phase and zero-copy enqueue/dequeue on the sync modes supporting them.
+ */
+static int
+test_ring_peek_zc(void)
+{
+	static const struct {
+		const char *name;
+		unsigned int flags;
+	} modes[] = {
+		{ "SP/SC", RING_F_SP_ENQ | RING_F_SC_DEQ },
+		{ "MP_HTS/MC_HTS", RING_F_MP_HTS_ENQ | RING_F_MC_HTS_DEQ },
+	};
+	static const unsigned int zc_ring_sz = 2 * MAX_BULK;
+	void *src[MAX_BULK], *dst[MAX_BULK];
+	struct rte_ring_zc_data zcd;
+	struct rte_ring *r = NULL;
+	unsigned int i, j, n;
+	void **objs;
+
+	for (i = 0; i < RTE_DIM(src); i++)
+		src[i] = (void *)(uintptr_t)(i + 1);
+
+	for (i = 0; i < RTE_DIM(modes); i++) {
+		printf("Peek/zero-copy %s test\n", modes[i].name);
+
+		r = rte_ring_create("test_peek", zc_ring_sz, SOCKET_ID_ANY,
+				modes[i].flags);
+		if (r == NULL) {
+			printf("%s: cannot create %s ring\n", __func__,
+				modes[i].name);
+			return -1;
+		}
+
+		/* reserve and commit a bulk of objects */
+		TEST_RING_VERIFY(rte_ring_enqueue_bulk_start(r, MAX_BULK,
+				NULL) == MAX_BULK);
+		rte_ring_enqueue_finish(r, src, MAX_BULK);
+		TEST_RING_VERIFY(rte_ring_count(r) == MAX_BULK);
+
+		/* peek at all of them, but only remove the first two */
+		TEST_RING_VERIFY(rte_ring_dequeue_bulk_start(r, dst, MAX_BULK,
+				NULL) == MAX_BULK);
+		for (j = 0; j != MAX_BULK; j++)
+			TEST_RING_VERIFY(dst[j] == src[j]);
+		rte_ring_dequeue_finish(r, 2);
+		TEST_RING_VERIFY(rte_ring_count(r) == MAX_BULK - 2);
+
+		n = rte_ring_dequeue_burst_start(r, dst, MAX_BULK, NULL);
+		TEST_RING_VERIFY(n == MAX_BULK - 2);
+		for (j = 0; j != n; j++)
+			TEST_RING_VERIFY(dst[j] == src[j + 2]);
+		rte_ring_dequeue_finish(r, n);
+		TEST_RING_VERIFY(rte_ring_empty(r));
+
+		/* cancelled reservations leave the ring untouched */
+		TEST_RING_VERIFY(rte_ring_enqueue_burst_start(r, MAX_BULK,
+				NULL) == MAX_BULK);
+		rte_ring_enqueue_finish(r, src, 0);
+		TEST_RING_VERIFY(rte_ring_empty(r));
+
+		/*
+		 * the ring head is now at MAX_BULK, a zero-copy reservation
+		 * of MAX_BULK + 2 objects wraps around the end of the ring
+		 */
+		TEST_RING_VERIFY(rte_ring_enqueue_zc_bulk_start(r,
+				MAX_BULK + 2, &zcd, NULL) == MAX_BULK + 2);
+		TEST_RING_VERIFY(zcd.n1 == MAX_BULK);
+		TEST_RING_VERIFY(zcd.ptr2 != NULL);
+		objs = zcd.ptr1;
+		for (j = 0; j != zcd.n1; j++)
+			objs[j] = src[j];
+		objs = zcd.ptr2;
+		objs[0] = src[0];
+		objs[1] = src[1];
+		rte_ring_enqueue_zc_finish(r, MAX_BULK + 2);
+		TEST_RING_VERIFY(rte_ring_count(r) == MAX_BULK + 2);
+
+		/* inspect objects in place, then consume them */
+		TEST_RING_VERIFY(rte_ring_dequeue_zc_burst_start(r,
+				2 * MAX_BULK, &zcd, NULL) == MAX_BULK + 2);
+		TEST_RING_VERIFY(zcd.n1 == MAX_BULK);
+		objs = zcd.ptr1;
+		for (j = 0; j != zcd.n1; j++)
+			TEST_RING_VERIFY(objs[j] == src[j]);
+		rte_ring_dequeue_zc_finish(r, MAX_BULK);
+		TEST_RING_VERIFY(rte_ring_dequeue_zc_bulk_start(r, 2, &zcd,
+				NULL) == 2);
+		TEST_RING_VERIFY(zcd.n1 == 2 && zcd.ptr2 == NULL);
+		objs = zcd.ptr1;
+		TEST_RING_VERIFY(objs[0] == src[0] && objs[1] == src[1]);
+		rte_ring_dequeue_zc_finish(r, 2);
+		TEST_RING_VERIFY(rte_ring_empty(r));
+
+		rte_ring_free(r);
+		r = NULL;
+	}
+
+	return 0;
+}
+
+/*
+ * Enqueue and dequeue elements of various sizes, in bursts chosen so that
+ * the copies wrap around the end of the ring storage.
+ */
+static int
+test_ring_elem(void)
+{
+	static const unsigned int esizes[] = { 4, 8, 16, 20 };
+	static const unsigned int flags[] = {
+		0,
+		RING_F_SP_ENQ | RING_F_SC_DEQ,
+		RING_F_MP_RTS_ENQ | RING_F_MC_RTS_DEQ,
+		RING_F_MP_HTS_ENQ | RING_F_MC_HTS_DEQ,
+	};
+	static const unsigned int burst = MAX_BULK - 3;
+	uint32_t src[2 * MAX_BULK * 5], dst[2 * MAX_BULK * 5];
+	struct rte_ring_zc_data zcd;
+	struct rte_ring *r = NULL;
+	unsigned int i, j, k, n, esize;
+
+	for (i = 0; i != RTE_DIM(src); i++)
+		src[i] = rte_rand();
+
+	/* element size has to be a multiple of 4 bytes */
+	r = rte_ring_create_elem("test_ring_elem", 6, 2 * MAX_BULK,
+			SOCKET_ID_ANY, 0);
+	if (r != NULL || rte_errno != EINVAL) {
+		printf("%s: ring with invalid element size created\n",
+			__func__);
+		rte_ring_free(r);
+		return -1;
+	}
+	if (rte_ring_get_memsize_elem(20, 2 * MAX_BULK) <
+			(ssize_t)(sizeof(*r) + 2 * MAX_BULK * 20)) {
+		printf("%s: wrong memory size\n", __func__);
+		return -1;
+	}
+
+	for (i = 0; i != RTE_DIM(esizes); i++) {
+		esize = esizes[i];
+
+		for (j = 0; j != RTE_DIM(flags); j++) {
+			r = rte_ring_create_elem("test_ring_elem", esize,
+					2 * MAX_BULK, SOCKET_ID_ANY, flags[j]);
+			if (r == NULL) {
+				printf("%s: cannot create ring, esize %u\n",
+					__func__, esize);
+				return -1;
+			}
+
+			for (k = 0; k != 8; k++) {
+				memset(dst, 0, sizeof(dst));
+				TEST_RING_VERIFY(rte_ring_enqueue_bulk_elem(r,
+					src, esize, burst, NULL) == burst);
+				TEST_RING_VERIFY(rte_ring_count(r) == burst);
+				n = rte_ring_dequeue_burst_elem(r, dst, esize,
+					MAX_BULK, NULL);
+				TEST_RING_VERIFY(n == burst);
+				TEST_RING_VERIFY(memcmp(src, dst,
+					burst * esize) == 0);
+			}
+
+			/* single element API */
+			TEST_RING_VERIFY(rte_ring_enqueue_elem(r, src,
+					esize) == 0);
+			TEST_RING_VERIFY(rte_ring_dequeue_elem(r, dst,
+					esize) == 0);
+			TEST_RING_VERIFY(memcmp(src, dst, esize) == 0);
+			TEST_RING_VERIFY(rte_ring_dequeue_elem(r, dst,
+					esize) == -ENOENT);
+
+			rte_ring_free(r);
+			r = NULL;
+		}
+
+		/* peek and zero-copy API, the ring head is left at 2 */
+		r = rte_ring_create_elem("test_ring_elem", esize, 2 * MAX_BULK,
+				SOCKET_ID_ANY,
+				RING_F_MP_HTS_ENQ | RING_F_MC_HTS_DEQ);
+		if (r == NULL) {
+			printf("%s: cannot create HTS ring, esize %u\n",
+				__func__, esize);
+			return -1;
+		}
+
+		TEST_RING_VERIFY(rte_ring_enqueue_burst_start(r, 2,
+				NULL) == 2);
+		rte_ring_enqueue_elem_finish(r, src, esize, 2);
+		TEST_RING_VERIFY(rte_ring_dequeue_bulk_elem_start(r, dst,
+				esize, 2, NULL) == 2);
+		TEST_RING_VERIFY(memcmp(src, dst, 2 * esize) == 0);
+		rte_ring_dequeue_finish(r, 2);
+
+		n = 2 * MAX_BULK - 1;
+		TEST_RING_VERIFY(rte_ring_enqueue_zc_bulk_elem_start(r, esize,
+				n, &zcd, NULL) == n);
+		TEST_RING_VERIFY(zcd.n1 == n - 1 && zcd.ptr2 != NULL);
+		memcpy(zcd.ptr1, src, zcd.n1 * esize);
+		memcpy(zcd.ptr2, (uint8_t *)src + zcd.n1 * esize, esize);
+		rte_ring_enqueue_zc_finish(r, n);
+
+		memset(dst, 0, sizeof(dst));
+		for (k = 0; k != n; k++)
+			TEST_RING_VERIFY(rte_ring_dequeue_elem(r,
+				(uint8_t *)dst + k * esize, esize) == 0);
+		TEST_RING_VERIFY(memcmp(src, dst, n * esize) == 0);
+		TEST_RING_VERIFY(rte_ring_empty(r));
+
+		rte_ring_free(r);
+		r = NULL;
+	}
+
+	return 0;
+}
+
 static int
 test_ring(void)
 {
@@ -860,6 +1180,15 @@ test_ring(void)
 	if (test_ring_with_exact_size() < 0)
 		goto test_fail;
 
+	if (test_ring_sync_modes() < 0)
+		goto test_fail;
+
+	if (test_ring_peek_zc() < 0)
+		goto test_fail;
+
+	if (test_ring_elem() < 0)
+		goto test_fail;
+
 	/* dump the ring status */
 	rte_ring_list_dump(stdout);
 
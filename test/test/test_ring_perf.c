@@ -20,6 +20,7 @@
  *  * Empty ring dequeue
  *  * Enqueue/dequeue of bursts in 1 threads
  *  * Enqueue/dequeue of bursts in 2 threads
+ *  * Enqueue/dequeue of bursts on all lcores, for each MP/MC sync mode
  */
 
 #define RING_NAME "RING_PERF"
@@ -362,6 +363,109 @@ test_bulk_enqueue_dequeue(struct rte_ring *r)
 	}
 }
 
+/*
+ * Parameters of the all-lcores stress test. The ring is shared by every
+ * lcore, each of them dequeuing a burst and enqueuing it back.
+ */
+struct stress_params {
+	struct rte_ring *r;
+	unsigned size;        /* input value, the burst size */
+	uint64_t cycles;      /* output value, cycles spent by this lcore */
+} __rte_cache_aligned;
+
+static struct stress_params stress_params[RTE_MAX_LCORE];
+
+static int
+dequeue_enqueue_bulk(void *p)
+{
+	const unsigned iter_shift = 20;
+	const unsigned iterations = 1<<iter_shift;
+	struct stress_params *params = p;
+	struct rte_ring *r = params->r;
+	const unsigned size = params->size;
+	const unsigned nb_lcores = rte_lcore_count();
+	unsigned i;
+	void *burst[MAX_BURST];
+
+	if (__sync_add_and_fetch(&lcore_count, 1) != nb_lcores)
+		while (lcore_count != nb_lcores)
+			rte_pause();
+
+	const uint64_t start = rte_rdtsc();
+	for (i = 0; i < iterations; i++) {
+		while (rte_ring_dequeue_bulk(r, burst, size, NULL) == 0)
+			rte_pause();
+		while (rte_ring_enqueue_bulk(r, burst, size, NULL) == 0)
+			rte_pause();
+	}
+	const uint64_t end = rte_rdtsc();
+
+	params->cycles = end - start;
+	return 0;
+}
+
+/*
+ * Runs the dequeue/enqueue loop on every enabled lcore against rings created
+ * in each MP/MC sync mode. To measure an overcommitted setup, give the test
+ * application more lcores than physical cores, e.g. --lcores='(0-7)@(0-3)':
+ * the classic MP/MC mode then stalls whenever a thread is preempted between
+ * its head and tail updates, while RTS and HTS modes limit that effect.
+ */
+static int
+test_all_lcores_sync_modes(void)
+{
+	static const struct {
+		const char *name;
+		unsigned int flags;
+	} modes[] = {
+		{ "MP/MC", 0 },
+		{ "MP_RTS/MC_RTS", RING_F_MP_RTS_ENQ | RING_F_MC_RTS_DEQ },
+		{ "MP_HTS/MC_HTS", RING_F_MP_HTS_ENQ | RING_F_MC_HTS_DEQ },
+	};
+	const unsigned iterations = 1<<20;
+	void *burst[MAX_BURST] = {0};
+	struct rte_ring *r;
+	unsigned i, m, sz, lcore_id;
+	uint64_t cycles;
+
+	for (m = 0; m < RTE_DIM(modes); m++) {
+		r = rte_ring_create(RING_NAME "_SYNC", RING_SIZE,
+				rte_socket_id(), modes[m].flags);
+		if (r == NULL)
+			return -1;
+
+		/* half-fill the ring so every lcore always finds a burst */
+		for (i = 0; i < RING_SIZE / 2 / MAX_BURST; i++)
+			rte_ring_enqueue_bulk(r, burst, MAX_BURST, NULL);
+
+		for (sz = 0; sz < RTE_DIM(bulk_sizes); sz++) {
+			lcore_count = 0;
+			RTE_LCORE_FOREACH(lcore_id) {
+				stress_params[lcore_id].r = r;
+				stress_params[lcore_id].size = bulk_sizes[sz];
+			}
+			RTE_LCORE_FOREACH_SLAVE(lcore_id)
+				rte_eal_remote_launch(dequeue_enqueue_bulk,
+					&stress_params[lcore_id], lcore_id);
+			dequeue_enqueue_bulk(
+				&stress_params[rte_get_master_lcore()]);
+			rte_eal_mp_wait_lcore();
+
+			cycles = 0;
+			RTE_LCORE_FOREACH(lcore_id)
+				cycles += stress_params[lcore_id].cycles;
+
+			printf("%s bulk deq/enqueue on %u lcores (size: %u): %.2F\n",
+				modes[m].name, rte_lcore_count(),
+				bulk_sizes[sz], (double)cycles /
+				((double)iterations * bulk_sizes[sz] *
+				 rte_lcore_count()));
+		}
+		rte_ring_free(r);
+	}
+	return 0;
+}
+
 static int
 test_ring_perf(void)
 {
@@ -395,6 +499,12 @@ test_ring_perf(void)
 		run_on_core_pair(&cores, r, enqueue_bulk, dequeue_bulk);
 	}
 	rte_ring_free(r);
+
+	if (rte_lcore_count() > 1) {
+		printf("\n### Testing sync modes using all lcores ###\n");
+		if (test_all_lcores_sync_modes() < 0)
+			return -1;
+	}
 	return 0;
 }
 
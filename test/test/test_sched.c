@@ -6,11 +6,15 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdint.h>
+#include <inttypes.h>
 #include <unistd.h>
 
 #include "test.h"
 
 #include <rte_cycles.h>
+#include <rte_launch.h>
+#include <rte_lcore.h>
+#include <rte_pause.h>
 #include <rte_ether.h>
 #include <rte_ip.h>
 #include <rte_byteorder.h>
@@ -39,6 +43,9 @@ static struct rte_sched_pipe_params pipe_profile[] = {
 
 		.tc_rate = {305175, 305175, 305175, 305175},
 		.tc_period = 40,
+#ifdef RTE_SCHED_SUBPORT_TC_OV
+		.tc_ov_weight = 1,
+#endif
 
 		.wrr_weights = {1, 1, 1, 1,  1, 1, 1, 1,  1, 1, 1, 1,  1, 1, 1, 1},
 	},
@@ -56,7 +63,98 @@ static struct rte_sched_port_params port_param = {
 	.n_pipe_profiles = 1,
 };
 
-#define NB_MBUF          32
+/* Broadband layout: 15 strict priority TCs with one queue each, plus a best
+ * effort TC with 8 WRR queues.
+ */
+#define LAYOUT_N_TC      16
+#define LAYOUT_TC_BE     (LAYOUT_N_TC - 1)
+#define LAYOUT_N_BE_Q    8
+
+static struct rte_sched_subport_params layout_subport_param[] = {
+	{
+		.tb_rate = 1250000000,
+		.tb_size = 1000000,
+
+		.tc_rate = {1250000000, 1250000000, 1250000000, 1250000000,
+			1250000000, 1250000000, 1250000000, 1250000000,
+			1250000000, 1250000000, 1250000000, 1250000000,
+			1250000000, 1250000000, 1250000000, 1250000000},
+		.tc_period = 10,
+	},
+};
+
+static struct rte_sched_pipe_params layout_pipe_profile[] = {
+	{ /* Profile #0 */
+		.tb_rate = 305175,
+		.tb_size = 1000000,
+
+		.tc_rate = {305175, 305175, 305175, 305175,
+			305175, 305175, 305175, 305175,
+			305175, 305175, 305175, 305175,
+			305175, 305175, 305175, 305175},
+		.tc_period = 40,
+#ifdef RTE_SCHED_SUBPORT_TC_OV
+		.tc_ov_weight = 1,
+#endif
+
+		/* Single queue TCs need no WRR weight, the best effort queues
+		 * follow the 15 single queue TCs
+		 */
+		.wrr_weights = {[LAYOUT_TC_BE] = 1, 2, 4, 8, 1, 2, 4, 8},
+	},
+};
+
+static struct rte_sched_port_params layout_port_param = {
+	.socket = 0, /* computed */
+	.rate = 0, /* computed */
+	.mtu = 1522,
+	.frame_overhead = RTE_SCHED_FRAME_OVERHEAD_DEFAULT,
+	.n_subports_per_port = 1,
+	.n_pipes_per_subport = 1024,
+	.n_traffic_classes = LAYOUT_N_TC,
+	.n_queues_per_tc = {1, 1, 1, 1, 1, 1, 1, 1,
+		1, 1, 1, 1, 1, 1, 1, LAYOUT_N_BE_Q},
+	.qsize = {32, 32, 32, 32, 32, 32, 32, 32,
+		32, 32, 32, 32, 32, 32, 32, 64},
+	.pipe_profiles = layout_pipe_profile,
+	.n_pipe_profiles = 1,
+};
+
+/* Shards of a 10 Mbps output port, each able to send at the port rate */
+#define SHARD_RATE       1250000
+#define SHARD_TB_SIZE    4096
+#define SHARD_N_SHARDS   2
+#define SHARD_NB_PKTS    10
+#define SHARD_PKT_LEN    1000
+#define SHARD_MT_NB_PKTS 32
+#define SHARD_MT_TIMEOUT_S 2
+
+static struct rte_sched_subport_params shard_subport_param[] = {
+	{
+		.tb_rate = SHARD_RATE,
+		.tb_size = 1000000,
+
+		.tc_rate = {SHARD_RATE, SHARD_RATE, SHARD_RATE, SHARD_RATE},
+		.tc_period = 10,
+	},
+};
+
+static struct rte_sched_pipe_params shard_pipe_profile[] = {
+	{ /* Profile #0 */
+		.tb_rate = SHARD_RATE,
+		.tb_size = 1000000,
+
+		.tc_rate = {SHARD_RATE, SHARD_RATE, SHARD_RATE, SHARD_RATE},
+		.tc_period = 10,
+#ifdef RTE_SCHED_SUBPORT_TC_OV
+		.tc_ov_weight = 1,
+#endif
+
+		.wrr_weights = {1, 1, 1, 1,  1, 1, 1, 1,  1, 1, 1, 1,  1, 1, 1, 1},
+	},
+};
+
+#define NB_MBUF          128
 #define MBUF_DATA_SZ     (2048 + RTE_PKTMBUF_HEADROOM)
 #define MEMPOOL_CACHE_SZ 0
 #define SOCKET           0
@@ -103,6 +201,409 @@ prepare_pkt(struct rte_mbuf *mbuf)
 }
 
 
+/* Packets of the same pipe leave in strict traffic class priority order,
+ * the out of range queue 3 of TC 10 is wrapped around to its queue 0
+ */
+static const uint32_t layout_pkt_tc[] = {
+	LAYOUT_TC_BE, LAYOUT_TC_BE, 10, 10, 0, 0, LAYOUT_TC_BE, LAYOUT_TC_BE,
+	10,
+};
+static const uint32_t layout_pkt_queue[] = {
+	3, 3, 0, 0, 0, 0, 6, 6,
+	3,
+};
+
+#define LAYOUT_NB_PKTS   RTE_DIM(layout_pkt_tc)
+
+static int
+test_sched_layout(struct rte_mempool *mp)
+{
+	struct rte_sched_port_params params;
+	struct rte_sched_port *port;
+	struct rte_mbuf *in_mbufs[LAYOUT_NB_PKTS];
+	struct rte_mbuf *out_mbufs[LAYOUT_NB_PKTS];
+	struct rte_sched_queue_stats queue_stats;
+	uint32_t pipe, tc_prev, i;
+	uint16_t qlen;
+	int err;
+
+	/* Invalid layouts: queues per TC not a power of 2, too many TCs,
+	 * too many queues per pipe
+	 */
+	params = layout_port_param;
+	params.rate = (uint64_t) 10000 * 1000 * 1000 / 8;
+	params.n_queues_per_tc[LAYOUT_TC_BE] = 3;
+	port = rte_sched_port_config(&params);
+	TEST_ASSERT_NULL(port, "Invalid queues per TC accepted\n");
+
+	params = layout_port_param;
+	params.rate = (uint64_t) 10000 * 1000 * 1000 / 8;
+	params.n_traffic_classes = RTE_SCHED_TRAFFIC_CLASSES_MAX + 1;
+	port = rte_sched_port_config(&params);
+	TEST_ASSERT_NULL(port, "Invalid number of TCs accepted\n");
+
+	params = layout_port_param;
+	params.rate = (uint64_t) 10000 * 1000 * 1000 / 8;
+	for (i = 0; i < LAYOUT_N_TC; i++)
+		params.n_queues_per_tc[i] = 4;
+	port = rte_sched_port_config(&params);
+	TEST_ASSERT_NULL(port, "Invalid number of queues per pipe accepted\n");
+
+	layout_port_param.socket = 0;
+	layout_port_param.rate = (uint64_t) 10000 * 1000 * 1000 / 8;
+
+	port = rte_sched_port_config(&layout_port_param);
+	TEST_ASSERT_NOT_NULL(port, "Error config sched port\n");
+
+	err = rte_sched_subport_config(port, SUBPORT, layout_subport_param);
+	TEST_ASSERT_SUCCESS(err, "Error config sched, err=%d\n", err);
+
+	for (pipe = 0; pipe < layout_port_param.n_pipes_per_subport; pipe++) {
+		err = rte_sched_pipe_config(port, SUBPORT, pipe, 0);
+		TEST_ASSERT_SUCCESS(err, "Error config sched pipe %u, err=%d\n", pipe, err);
+	}
+
+	/* 15 + 8 queues per pipe, rounded up to 32 queue IDs */
+	TEST_ASSERT_EQUAL(rte_sched_port_queue_id(port, SUBPORT, PIPE, 0, 0),
+		PIPE * 32, "Wrong queue ID\n");
+	TEST_ASSERT_EQUAL(rte_sched_port_queue_id(port, SUBPORT, PIPE,
+		LAYOUT_TC_BE, 7), PIPE * 32 + LAYOUT_TC_BE + 7,
+		"Wrong queue ID\n");
+	TEST_ASSERT_EQUAL(rte_sched_port_queue_id(port, SUBPORT, PIPE, 0, 1),
+		UINT32_MAX, "Out of range queue accepted\n");
+	TEST_ASSERT_EQUAL(rte_sched_port_queue_id(port, SUBPORT, PIPE,
+		LAYOUT_N_TC, 0), UINT32_MAX, "Out of range TC accepted\n");
+	TEST_ASSERT_EQUAL(rte_sched_port_queue_id(port, SUBPORT,
+		layout_port_param.n_pipes_per_subport, 0, 0), UINT32_MAX,
+		"Out of range pipe accepted\n");
+
+	for (i = 0; i < LAYOUT_NB_PKTS; i++) {
+		in_mbufs[i] = rte_pktmbuf_alloc(mp);
+		TEST_ASSERT_NOT_NULL(in_mbufs[i], "Packet allocation failed\n");
+
+		rte_sched_port_pkt_write(in_mbufs[i], SUBPORT, PIPE,
+			layout_pkt_tc[i], layout_pkt_queue[i],
+			e_RTE_METER_GREEN);
+		in_mbufs[i]->pkt_len = 60;
+		in_mbufs[i]->data_len = 60;
+	}
+
+	err = rte_sched_port_enqueue(port, in_mbufs, LAYOUT_NB_PKTS);
+	TEST_ASSERT_EQUAL(err, (int) LAYOUT_NB_PKTS, "Wrong enqueue, err=%d\n", err);
+
+	err = rte_sched_port_dequeue(port, out_mbufs, LAYOUT_NB_PKTS);
+	TEST_ASSERT_EQUAL(err, (int) LAYOUT_NB_PKTS, "Wrong dequeue, err=%d\n", err);
+
+	tc_prev = 0;
+	for (i = 0; i < LAYOUT_NB_PKTS; i++) {
+		uint32_t subport, traffic_class, queue;
+
+		rte_sched_port_pkt_read_tree_path(out_mbufs[i],
+				&subport, &pipe, &traffic_class, &queue);
+
+		TEST_ASSERT_EQUAL(subport, SUBPORT, "Wrong subport\n");
+		TEST_ASSERT_EQUAL(pipe, PIPE, "Wrong pipe\n");
+		TEST_ASSERT(traffic_class >= tc_prev,
+			"Traffic class %u scheduled after %u\n",
+			traffic_class, tc_prev);
+		tc_prev = traffic_class;
+	}
+
+	err = rte_sched_queue_read_stats(port,
+		rte_sched_port_queue_id(port, SUBPORT, PIPE, LAYOUT_TC_BE, 6),
+		&queue_stats, &qlen);
+	TEST_ASSERT_SUCCESS(err, "Error reading queue stats, err=%d\n", err);
+#ifdef RTE_SCHED_COLLECT_STATS
+	TEST_ASSERT_EQUAL(queue_stats.n_pkts, 2, "Wrong queue stats\n");
+#endif
+	TEST_ASSERT_EQUAL(qlen, 0, "Wrong queue length\n");
+
+	err = rte_sched_queue_read_stats(port,
+		rte_sched_port_queue_id(port, SUBPORT, PIPE, 10, 0),
+		&queue_stats, &qlen);
+	TEST_ASSERT_SUCCESS(err, "Error reading queue stats, err=%d\n", err);
+#ifdef RTE_SCHED_COLLECT_STATS
+	TEST_ASSERT_EQUAL(queue_stats.n_pkts, 3, "Wrong queue stats\n");
+#endif
+	TEST_ASSERT_EQUAL(qlen, 0, "Wrong queue length\n");
+
+	for (i = 0; i < LAYOUT_NB_PKTS; i++)
+		rte_pktmbuf_free(out_mbufs[i]);
+
+	rte_sched_port_free(port);
+
+	return 0;
+}
+
+/* Create a shard of the output port, with nb_pkts packets enqueued */
+static struct rte_sched_port *
+shard_create(struct rte_mempool *mp, struct rte_sched_port_params *params,
+	uint32_t nb_pkts)
+{
+	struct rte_sched_port *port;
+	struct rte_mbuf *mbufs[SHARD_MT_NB_PKTS];
+	uint32_t pipe, i;
+
+	port = rte_sched_port_config(params);
+	if (port == NULL)
+		return NULL;
+
+	if (rte_sched_subport_config(port, SUBPORT, shard_subport_param) != 0)
+		goto err;
+
+	for (pipe = 0; pipe < params->n_pipes_per_subport; pipe++) {
+		if (rte_sched_pipe_config(port, SUBPORT, pipe, 0) != 0)
+			goto err;
+	}
+
+	if (rte_pktmbuf_alloc_bulk(mp, mbufs, nb_pkts) != 0)
+		goto err;
+
+	for (i = 0; i < nb_pkts; i++) {
+		rte_sched_port_pkt_write(mbufs[i], SUBPORT, PIPE, TC, QUEUE,
+			e_RTE_METER_GREEN);
+		mbufs[i]->pkt_len = SHARD_PKT_LEN;
+		mbufs[i]->data_len = SHARD_PKT_LEN;
+	}
+
+	if (rte_sched_port_enqueue(port, mbufs, nb_pkts) != (int) nb_pkts)
+		goto err;
+
+	return port;
+
+err:
+	rte_sched_port_free(port);
+	return NULL;
+}
+
+/* Minimum time to send nb_bytes at the output port rate, given the bucket
+ * size and the packet each shard can send above the credits of its last
+ * dequeue
+ */
+static uint64_t
+shard_min_ms(struct rte_sched_port_params *params, uint64_t nb_bytes)
+{
+	uint64_t burst = SHARD_TB_SIZE +
+		SHARD_N_SHARDS * (params->mtu + params->frame_overhead);
+
+	return nb_bytes > burst ? (nb_bytes - burst) * 1000 / SHARD_RATE : 0;
+}
+
+static int
+test_sched_shards(struct rte_mempool *mp)
+{
+	struct rte_sched_shard_group_params group_params = {
+		.name = "test_sched_shards",
+		.socket = 0,
+		.rate = SHARD_RATE,
+		.tb_size = SHARD_TB_SIZE,
+	};
+	struct rte_sched_shard_group *group;
+	struct rte_sched_port_params params;
+	struct rte_sched_port *port[SHARD_N_SHARDS], *bad_port;
+	struct rte_mbuf *mbufs[SHARD_NB_PKTS];
+	uint32_t n_pkts[SHARD_N_SHARDS];
+	uint64_t start, elapsed_ms;
+	uint32_t shard, n, i;
+	int err;
+
+	params = port_param;
+	params.rate = SHARD_RATE;
+	params.pipe_profiles = shard_pipe_profile;
+
+	for (shard = 0; shard < SHARD_N_SHARDS; shard++) {
+		port[shard] = shard_create(mp, &params, SHARD_NB_PKTS);
+		TEST_ASSERT_NOT_NULL(port[shard], "Error creating shard\n");
+		n_pkts[shard] = 0;
+	}
+
+	group = rte_sched_shard_group_create(&group_params);
+	TEST_ASSERT_NOT_NULL(group, "Error creating shard group\n");
+
+	/* The shards have the rate of the output port */
+	params.rate = SHARD_RATE * 2;
+	bad_port = rte_sched_port_config(&params);
+	TEST_ASSERT_NOT_NULL(bad_port, "Error config sched port\n");
+	err = rte_sched_port_shard_attach(bad_port, group);
+	TEST_ASSERT_FAIL(err, "Shard with wrong rate attached\n");
+	rte_sched_port_free(bad_port);
+	params.rate = SHARD_RATE;
+
+	/* The bucket has to hold a frame of MTU size and its overhead */
+	params.mtu = SHARD_TB_SIZE - params.frame_overhead + 1;
+	bad_port = rte_sched_port_config(&params);
+	TEST_ASSERT_NOT_NULL(bad_port, "Error config sched port\n");
+	err = rte_sched_port_shard_attach(bad_port, group);
+	TEST_ASSERT_FAIL(err, "Shard with frames above bucket size attached\n");
+	rte_sched_port_free(bad_port);
+	params.mtu = port_param.mtu;
+
+	for (shard = 0; shard < SHARD_N_SHARDS; shard++) {
+		err = rte_sched_port_shard_attach(port[shard], group);
+		TEST_ASSERT_SUCCESS(err, "Error attaching shard, err=%d\n", err);
+	}
+
+	/* The first shard gets the token bucket of the output port, leaving
+	 * (almost) nothing to the second one
+	 */
+	start = rte_get_tsc_cycles();
+	for (shard = 0; shard < SHARD_N_SHARDS; shard++) {
+		n = rte_sched_port_dequeue(port[shard], mbufs, SHARD_NB_PKTS);
+		for (i = 0; i < n; i++)
+			rte_pktmbuf_free(mbufs[i]);
+		n_pkts[shard] += n;
+	}
+	TEST_ASSERT(n_pkts[0] >=
+		SHARD_TB_SIZE / (SHARD_PKT_LEN + params.frame_overhead),
+		"Shard dequeued %u packets out of a full bucket\n", n_pkts[0]);
+	TEST_ASSERT(n_pkts[0] + n_pkts[1] < SHARD_N_SHARDS * SHARD_NB_PKTS,
+		"Output port rate not enforced\n");
+
+	/* Then the shards share the output port rate */
+	for (i = 0; i < 1000; i++) {
+		uint32_t j;
+
+		if (n_pkts[0] + n_pkts[1] == SHARD_N_SHARDS * SHARD_NB_PKTS)
+			break;
+
+		rte_delay_ms(1);
+		for (shard = 0; shard < SHARD_N_SHARDS; shard++) {
+			n = rte_sched_port_dequeue(port[shard], mbufs,
+				SHARD_NB_PKTS);
+			for (j = 0; j < n; j++)
+				rte_pktmbuf_free(mbufs[j]);
+			n_pkts[shard] += n;
+		}
+	}
+	elapsed_ms = (rte_get_tsc_cycles() - start) * 1000 / rte_get_tsc_hz();
+
+	TEST_ASSERT_EQUAL(n_pkts[0], SHARD_NB_PKTS, "Wrong dequeue\n");
+	TEST_ASSERT_EQUAL(n_pkts[1], SHARD_NB_PKTS, "Wrong dequeue\n");
+
+	TEST_ASSERT(elapsed_ms >= shard_min_ms(&params,
+		SHARD_N_SHARDS * SHARD_NB_PKTS *
+		(SHARD_PKT_LEN + params.frame_overhead)),
+		"Output port rate exceeded, %" PRIu64 " ms\n", elapsed_ms);
+
+	for (shard = 0; shard < SHARD_N_SHARDS; shard++)
+		rte_sched_port_free(port[shard]);
+	rte_sched_shard_group_free(group);
+
+	return 0;
+}
+
+struct shard_worker {
+	struct rte_sched_port *port;
+	uint32_t n_pkts;
+	uint64_t end;
+};
+
+static volatile int shard_workers_start;
+
+/* Dequeue all the packets of a shard, as fast as the group allows */
+static int
+shard_worker_main(void *arg)
+{
+	struct shard_worker *worker = arg;
+	struct rte_mbuf *mbufs[SHARD_MT_NB_PKTS];
+	uint64_t timeout;
+	uint32_t n, i;
+
+	while (shard_workers_start == 0)
+		rte_pause();
+
+	timeout = rte_get_tsc_cycles() + SHARD_MT_TIMEOUT_S * rte_get_tsc_hz();
+	while (worker->n_pkts < SHARD_MT_NB_PKTS &&
+	       rte_get_tsc_cycles() < timeout) {
+		n = rte_sched_port_dequeue(worker->port, mbufs,
+			SHARD_MT_NB_PKTS);
+		for (i = 0; i < n; i++)
+			rte_pktmbuf_free(mbufs[i]);
+		worker->n_pkts += n;
+	}
+	worker->end = rte_get_tsc_cycles();
+
+	return 0;
+}
+
+/* The shards dequeue concurrently from their own lcores */
+static int
+test_sched_shards_mt(struct rte_mempool *mp)
+{
+	struct rte_sched_shard_group_params group_params = {
+		.name = "test_sched_shards_mt",
+		.socket = 0,
+		.rate = SHARD_RATE,
+		.tb_size = SHARD_TB_SIZE,
+	};
+	struct shard_worker worker[SHARD_N_SHARDS];
+	struct rte_sched_shard_group *group;
+	struct rte_sched_port_params params;
+	unsigned int lcore_id[SHARD_N_SHARDS];
+	uint64_t start, end, elapsed_ms;
+	uint32_t shard;
+	int err;
+
+	if (rte_lcore_count() < SHARD_N_SHARDS + 1) {
+		printf("Not enough lcores, skipping multi-core shard test\n");
+		return 0;
+	}
+
+	params = port_param;
+	params.rate = SHARD_RATE;
+	params.pipe_profiles = shard_pipe_profile;
+
+	group = rte_sched_shard_group_create(&group_params);
+	TEST_ASSERT_NOT_NULL(group, "Error creating shard group\n");
+
+	memset(worker, 0, sizeof(worker));
+	for (shard = 0; shard < SHARD_N_SHARDS; shard++) {
+		worker[shard].port = shard_create(mp, &params, SHARD_MT_NB_PKTS);
+		TEST_ASSERT_NOT_NULL(worker[shard].port, "Error creating shard\n");
+
+		err = rte_sched_port_shard_attach(worker[shard].port, group);
+		TEST_ASSERT_SUCCESS(err, "Error attaching shard, err=%d\n", err);
+	}
+
+	shard_workers_start = 0;
+	lcore_id[0] = rte_get_next_lcore(-1, 1, 0);
+	for (shard = 0; shard < SHARD_N_SHARDS; shard++) {
+		if (shard > 0)
+			lcore_id[shard] =
+				rte_get_next_lcore(lcore_id[shard - 1], 1, 0);
+		err = rte_eal_remote_launch(shard_worker_main, &worker[shard],
+			lcore_id[shard]);
+		TEST_ASSERT_SUCCESS(err, "Error launching shard, err=%d\n", err);
+	}
+
+	start = rte_get_tsc_cycles();
+	shard_workers_start = 1;
+
+	end = start;
+	for (shard = 0; shard < SHARD_N_SHARDS; shard++) {
+		rte_eal_wait_lcore(lcore_id[shard]);
+		if (worker[shard].end > end)
+			end = worker[shard].end;
+	}
+	elapsed_ms = (end - start) * 1000 / rte_get_tsc_hz();
+
+	for (shard = 0; shard < SHARD_N_SHARDS; shard++)
+		TEST_ASSERT_EQUAL(worker[shard].n_pkts, SHARD_MT_NB_PKTS,
+			"Wrong dequeue on shard %u\n", shard);
+
+	/* The aggregate rate of the shards is the output port rate */
+	TEST_ASSERT(elapsed_ms >= shard_min_ms(&params,
+		SHARD_N_SHARDS * SHARD_MT_NB_PKTS *
+		(SHARD_PKT_LEN + params.frame_overhead)),
+		"Output port rate exceeded, %" PRIu64 " ms\n", elapsed_ms);
+
+	for (shard = 0; shard < SHARD_N_SHARDS; shard++)
+		rte_sched_port_free(worker[shard].port);
+	rte_sched_shard_group_free(group);
+
+	return 0;
+}
+
 /**
  * test main entrance for library sched
  */
@@ -181,7 +682,15 @@ test_sched(void)
 
 	rte_sched_port_free(port);
 
-	return 0;
+	err = test_sched_layout(mp);
+	if (err != 0)
+		return err;
+
+	err = test_sched_shards(mp);
+	if (err != 0)
+		return err;
+
+	return test_sched_shards_mt(mp);
 }
 
 REGISTER_TEST_COMMAND(sched_autotest, test_sched);
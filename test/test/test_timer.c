@@ -83,6 +83,32 @@
  *      - At initialization, timer3 is loaded by the master core, on
  *        another core in "periodical" mode (time = 1 second).
  *      - It is stopped at t=25s by timer2.
+ *
+ * #. Timer data instance test.
+ *
+ *    This test checks the timers of a separate timer data instance, for
+ *    each backend.
+ *
+ *    - Single timers spread over 50 milliseconds, a periodic timer and a
+ *      timer one hour later are started on the master lcore, then one
+ *      single timer in four and the one hour timer are stopped.
+ *    - rte_timer_manage() must not run any of them.
+ *    - rte_timer_alt_manage() must run each remaining single timer exactly
+ *      once and not before its expiry time, and the periodic timer several
+ *      times.
+ *
+ * #. Burst and batch expiry test.
+ *
+ *    This test checks the bounded number of expired timers processed by
+ *    rte_timer_alt_manage_burst() and rte_timer_alt_manage_batch(), for
+ *    each backend.
+ *
+ *    - Timers expiring at the same time are started on the master lcore,
+ *      and some of them stopped after they expired.
+ *    - Each burst call must run exactly the requested number of timers,
+ *      until the remaining ones, and the stopped timers are not run.
+ *    - The batch callback must get the timers in arrays, single timers
+ *      stopped and periodic ones pending again.
  */
 
 #include <stdio.h>
@@ -107,6 +133,7 @@
 #include <rte_random.h>
 #include <rte_malloc.h>
 #include <rte_pause.h>
+#include <rte_errno.h>
 
 #define TEST_DURATION_S 1 /* in seconds */
 #define NB_TIMER 4
@@ -494,6 +521,207 @@ timer_basic_main_loop(__attribute__((unused)) void *arg)
 	return 0;
 }
 
+#define NB_DATA_TIMERS 4096
+
+static struct rte_timer data_timers[NB_DATA_TIMERS + 2];
+static unsigned int data_cb_count;
+static unsigned int data_cb_early;
+static unsigned int data_cb_periodic;
+
+static void
+timer_data_cb(struct rte_timer *tim, void *arg)
+{
+	if (rte_get_timer_cycles() < tim->expire)
+		data_cb_early++;
+	if (arg != NULL)
+		data_cb_periodic++;
+	else
+		data_cb_count++;
+}
+
+static int
+timer_data_test(enum rte_timer_backend backend)
+{
+	struct rte_timer *periodic = &data_timers[NB_DATA_TIMERS];
+	struct rte_timer *far = &data_timers[NB_DATA_TIMERS + 1];
+	unsigned int i, lcore_id = rte_lcore_id();
+	uint64_t hz = rte_get_timer_hz();
+	uint64_t end;
+	uint32_t id;
+	int ret;
+
+	ret = rte_timer_data_alloc(&id, backend);
+	if (ret != 0) {
+		printf("- Cannot allocate timer data instance: %d\n", ret);
+		return -1;
+	}
+
+	data_cb_count = 0;
+	data_cb_early = 0;
+	data_cb_periodic = 0;
+
+	for (i = 0; i < RTE_DIM(data_timers); i++)
+		rte_timer_init(&data_timers[i]);
+	for (i = 0; i < NB_DATA_TIMERS; i++)
+		rte_timer_alt_reset(id, &data_timers[i],
+				hz / 20 * i / NB_DATA_TIMERS, SINGLE,
+				lcore_id, timer_data_cb, NULL);
+	rte_timer_alt_reset(id, periodic, hz / 100, PERIODICAL, lcore_id,
+			timer_data_cb, periodic);
+	rte_timer_alt_reset(id, far, hz * 3600, SINGLE, lcore_id,
+			timer_data_cb, NULL);
+
+	for (i = 0; i < NB_DATA_TIMERS; i += 4)
+		rte_timer_alt_stop(id, &data_timers[i]);
+	rte_timer_alt_stop(id, far);
+
+	/* the default timer lists must not see the instance timers */
+	end = rte_get_timer_cycles() + hz / 10;
+	while (rte_get_timer_cycles() < end)
+		rte_timer_manage();
+	if (data_cb_count != 0 || data_cb_periodic != 0) {
+		printf("- Instance timers run by rte_timer_manage()\n");
+		ret = -1;
+	}
+
+	end = rte_get_timer_cycles() + hz / 10;
+	while (rte_get_timer_cycles() < end)
+		rte_timer_alt_manage(id);
+	rte_timer_alt_stop(id, periodic);
+
+	if (data_cb_count != NB_DATA_TIMERS - NB_DATA_TIMERS / 4) {
+		printf("- Expected %d callbacks, got %u\n",
+			NB_DATA_TIMERS - NB_DATA_TIMERS / 4, data_cb_count);
+		ret = -1;
+	}
+	if (data_cb_early != 0) {
+		printf("- %u timers expired early\n", data_cb_early);
+		ret = -1;
+	}
+	if (data_cb_periodic < 5) {
+		printf("- Periodic timer run %u times\n", data_cb_periodic);
+		ret = -1;
+	}
+
+	rte_timer_alt_dump_stats(id, stdout);
+	rte_timer_data_dealloc(id);
+
+	if (rte_timer_alt_reset(id, far, hz, SINGLE, lcore_id,
+			timer_data_cb, NULL) != -EINVAL) {
+		printf("- Freed timer data instance still usable\n");
+		ret = -1;
+	}
+
+	return ret;
+}
+
+static unsigned int batch_cb_calls;
+static unsigned int batch_cb_errors;
+
+static void
+timer_batch_cb(struct rte_timer **tims, unsigned int nb_tims, void *arg)
+{
+	struct rte_timer *periodic = arg;
+	unsigned int i;
+
+	batch_cb_calls++;
+	for (i = 0; i < nb_tims; i++) {
+		/* only the periodic timer must still be pending */
+		if (rte_timer_pending(tims[i]) != (tims[i] == periodic))
+			batch_cb_errors++;
+		if (tims[i] == periodic)
+			data_cb_periodic++;
+		else
+			data_cb_count++;
+	}
+}
+
+#define NB_BURST_TIMERS 1000
+#define BURST_SIZE 64
+
+static int
+timer_burst_test(enum rte_timer_backend backend)
+{
+	struct rte_timer *periodic = &data_timers[NB_BURST_TIMERS];
+	unsigned int i, nb_run, lcore_id = rte_lcore_id();
+	uint64_t hz = rte_get_timer_hz();
+	uint32_t id;
+	int ret, n;
+
+	ret = rte_timer_data_alloc(&id, backend);
+	if (ret != 0) {
+		printf("- Cannot allocate timer data instance: %d\n", ret);
+		return -1;
+	}
+
+	data_cb_count = 0;
+	data_cb_early = 0;
+	data_cb_periodic = 0;
+	for (i = 0; i < NB_BURST_TIMERS; i++) {
+		rte_timer_init(&data_timers[i]);
+		rte_timer_alt_reset(id, &data_timers[i], hz / 1000, SINGLE,
+				lcore_id, timer_data_cb, NULL);
+	}
+	rte_delay_ms(2);
+
+	/* run the timers by bursts, stopping one expired timer in ten */
+	for (i = 0; i < NB_BURST_TIMERS; i += 10)
+		rte_timer_alt_stop(id, &data_timers[i]);
+
+	nb_run = 0;
+	do {
+		n = rte_timer_alt_manage_burst(id, BURST_SIZE);
+		if (n < 0 || (n != BURST_SIZE &&
+			      nb_run + n != NB_BURST_TIMERS * 9 / 10)) {
+			printf("- Burst of %d timers after %u\n", n, nb_run);
+			ret = -1;
+			break;
+		}
+		nb_run += n;
+	} while (n == BURST_SIZE);
+	if (data_cb_count != NB_BURST_TIMERS * 9 / 10 ||
+	    nb_run != data_cb_count) {
+		printf("- Expected %d callbacks, got %u\n",
+			NB_BURST_TIMERS * 9 / 10, data_cb_count);
+		ret = -1;
+	}
+
+	/* give the timers and a periodic one to a batch callback */
+	data_cb_count = 0;
+	batch_cb_calls = 0;
+	batch_cb_errors = 0;
+	for (i = 0; i < NB_BURST_TIMERS; i++)
+		rte_timer_alt_reset(id, &data_timers[i], hz / 1000, SINGLE,
+				lcore_id, timer_data_cb, NULL);
+	rte_timer_init(periodic);
+	rte_timer_alt_reset(id, periodic, hz / 1000, PERIODICAL, lcore_id,
+			timer_data_cb, NULL);
+	rte_delay_ms(2);
+
+	n = rte_timer_alt_manage_batch(id, NB_BURST_TIMERS / 2,
+			timer_batch_cb, periodic);
+	if (n != NB_BURST_TIMERS / 2 ||
+	    batch_cb_calls != (NB_BURST_TIMERS / 2 + 31) / 32) {
+		printf("- Batch of %d timers in %u calls\n", n,
+			batch_cb_calls);
+		ret = -1;
+	}
+	while (rte_timer_alt_manage_batch(id, NB_BURST_TIMERS,
+			timer_batch_cb, periodic) != 0)
+		;
+	if (data_cb_count != NB_BURST_TIMERS || data_cb_periodic == 0 ||
+	    batch_cb_errors != 0) {
+		printf("- Batches got %u timers, %u periodic, %u errors\n",
+			data_cb_count, data_cb_periodic, batch_cb_errors);
+		ret = -1;
+	}
+	rte_timer_alt_stop(id, periodic);
+
+	rte_timer_data_dealloc(id);
+
+	return ret;
+}
+
 static int
 timer_sanity_check(void)
 {
@@ -592,6 +820,20 @@ test_timer(void)
 		rte_timer_stop_sync(&mytiminfo[i].tim);
 	}
 
+	printf("\nStart timer data instance tests\n");
+	if (timer_data_test(RTE_TIMER_BACKEND_SKIPLIST) < 0 ||
+	    timer_data_test(RTE_TIMER_BACKEND_WHEEL) < 0) {
+		printf("Timer data instance tests failed\n");
+		return TEST_FAILED;
+	}
+
+	printf("\nStart timer burst and batch expiry tests\n");
+	if (timer_burst_test(RTE_TIMER_BACKEND_SKIPLIST) < 0 ||
+	    timer_burst_test(RTE_TIMER_BACKEND_WHEEL) < 0) {
+		printf("Timer burst and batch expiry tests failed\n");
+		return TEST_FAILED;
+	}
+
 	rte_timer_dump_stats(stdout);
 
 	return TEST_SUCCESS;